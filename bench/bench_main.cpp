@@ -0,0 +1,576 @@
+#include "benchmark.h"
+#include "elf_generator.h"
+#include "debugger_engine.h"
+#include "disassembler.h"
+#include "elf_parser.h"
+#include "process_maps.h"
+#include "symbol_table.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+using namespace debugger;
+
+namespace {
+
+// Memory the traced child fills and the read benchmarks read back
+constexpr size_t kChildMemorySize = 4 * 1024 * 1024;
+alignas(4096) uint8_t child_memory[kChildMemorySize];
+
+constexpr auto kStopTimeout = std::chrono::seconds(5);
+
+// Set on the child's side of the breakpoint round trip, so it must stay a
+// real call the compiler can neither inline nor drop
+extern "C" __attribute__((noinline)) void debugger_bench_child_target(uint64_t iteration) {
+    asm volatile("" : : "r"(iteration) : "memory");
+}
+
+int run_child() {
+    // Don't outlive a bench that crashed or was interrupted
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    for (size_t i = 0; i < kChildMemorySize; ++i) {
+        child_memory[i] = static_cast<uint8_t>(i * 31 + (i >> 12));
+    }
+    for (uint64_t iteration = 0;; ++iteration) {
+        debugger_bench_child_target(iteration);
+    }
+}
+
+std::string get_self_path() {
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0) {
+        return std::string();
+    }
+    return std::string(path, static_cast<size_t>(length));
+}
+
+// Where path's first mapping would put file offset 0 in pid
+uint64_t get_module_base(pid_t pid, const std::string& path) {
+    ProcessMaps maps;
+    maps.attach(pid);
+    for (const auto& module : maps.get_modules()) {
+        if (module.path == path) {
+            return module.first_mapping - module.first_offset;
+        }
+    }
+    return 0;
+}
+
+// The binary the analysis benchmarks run on, plus the results of earlier
+// stages, each computed once on first use outside any timed loop
+struct Corpus {
+    std::string path;
+    ElfParser parser;
+    ByteView text;
+    uint64_t text_address = 0;
+    ByteView rodata;
+    std::vector<uint64_t> entry_points;
+    DisassemblyBuffer instructions;
+    std::vector<Function> functions;
+    bool disassembled = false;
+    bool analyzed = false;
+
+    bool load(const std::string& file, std::string& error) {
+        path = file;
+        if (!parser.load_file(path)) {
+            error = parser.get_last_error();
+            return false;
+        }
+        for (const auto& section : parser.get_sections()) {
+            if (section.name == ".text") {
+                text = section.data;
+                text_address = section.address;
+            } else if (section.name == ".rodata") {
+                rodata = section.data;
+            }
+        }
+        if (text.empty()) {
+            error = "No .text section in " + path;
+            return false;
+        }
+        if (rodata.empty()) {
+            rodata = parser.get_file_view();
+        }
+        entry_points.push_back(parser.get_entry_point());
+        for (const auto& symbol : parser.get_symbols()) {
+            if (symbol.is_function && symbol.address >= text_address &&
+                symbol.address < text_address + text.size()) {
+                entry_points.push_back(symbol.address);
+            }
+        }
+        return true;
+    }
+
+    const DisassemblyBuffer& get_instructions() {
+        if (!disassembled) {
+            Disassembler disassembler(Architecture::X86_64);
+            disassembler.disassemble_into(text.data(), text.size(), text_address, instructions);
+            disassembled = true;
+        }
+        return instructions;
+    }
+
+    const std::vector<Function>& get_functions(ThreadPool& pool) {
+        if (!analyzed) {
+            Disassembler disassembler(Architecture::X86_64);
+            functions = disassembler.analyze_functions(get_instructions(), entry_points, &pool);
+            analyzed = true;
+        }
+        return functions;
+    }
+};
+
+// A copy of this binary running run_child() under the engine, paused on
+// the breakpoint in debugger_bench_child_target()
+class TracedChild {
+public:
+    bool start(std::string& error) {
+        std::string self = get_self_path();
+        engine.set_event_notifier([this]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            events_pending = true;
+            events_ready.notify_one();
+        });
+        engine.set_breakpoint_callback([this](uint64_t) { ++stops; });
+
+        if (!engine.load_executable(self, {"--bench-child"}) || !engine.start_process()) {
+            error = engine.get_last_error();
+            return false;
+        }
+
+        // The child is stopped at exec with its image mapped, at the same
+        // offsets from the base as ours
+        uint64_t own_base = get_module_base(getpid(), self);
+        uint64_t child_base = get_module_base(engine.get_process_id(), self);
+        if (own_base == 0 || child_base == 0) {
+            error = "Cannot find " + self + " in the process maps";
+            return false;
+        }
+        target_address = child_base + (reinterpret_cast<uint64_t>(&debugger_bench_child_target) - own_base);
+        memory_address = child_base + (reinterpret_cast<uint64_t>(child_memory) - own_base);
+
+        if (!engine.add_breakpoint(target_address)) {
+            error = engine.get_last_error();
+            return false;
+        }
+        return run_to_breakpoint(error);
+    }
+
+    // Continues and waits for the next breakpoint stop
+    bool run_to_breakpoint(std::string& error) {
+        uint64_t previous = stops;
+        if (!engine.continue_execution()) {
+            error = engine.get_last_error();
+            return false;
+        }
+        auto deadline = std::chrono::steady_clock::now() + kStopTimeout;
+        while (stops == previous) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!events_ready.wait_until(lock, deadline, [this]() { return events_pending; })) {
+                    error = "Timed out waiting for the breakpoint";
+                    return false;
+                }
+                events_pending = false;
+            }
+            engine.process_pending_events();
+            if (engine.get_state() != DebuggerState::PAUSED && engine.get_state() != DebuggerState::RUNNING) {
+                error = "The child exited";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ~TracedChild() {
+        if (engine.get_process_id() > 0) {
+            engine.stop_execution();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable events_ready;
+    bool events_pending = false;
+    uint64_t stops = 0;
+
+public:
+    // Declared last so the tracer thread, which runs the notifier, is gone
+    // before the state the notifier touches
+    DebuggerEngine engine;
+    uint64_t target_address = 0;
+    uint64_t memory_address = 0;
+};
+
+struct Options {
+    size_t size_mb = 16;
+    uint64_t seed = 1;
+    std::string corpus;
+    std::string generate;
+    std::string filter;
+    std::string json;
+    double min_time = 0.5;
+};
+
+void print_usage(const char* program) {
+    std::printf("Usage: %s [options]\n"
+                "  --size-mb N       size of the generated .text (default 16)\n"
+                "  --seed N          generator seed (default 1)\n"
+                "  --corpus FILE     benchmark an existing ELF instead of a generated one\n"
+                "  --generate FILE   write the synthetic ELF to FILE and exit\n"
+                "  --filter TEXT     only run benchmarks whose name contains TEXT\n"
+                "  --json FILE       also write the results as JSON\n"
+                "  --min-time SEC    minimum timed duration per benchmark (default 0.5)\n",
+                program);
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--size-mb") {
+            options.size_mb = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 0);
+        } else if (arg == "--corpus") {
+            options.corpus = value;
+        } else if (arg == "--generate") {
+            options.generate = value;
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--json") {
+            options.json = value;
+        } else if (arg == "--min-time") {
+            options.min_time = std::strtod(value, nullptr);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return options.size_mb > 0;
+}
+
+void add_analysis_benchmarks(bench::Runner& runner, Corpus& corpus, ThreadPool& pool) {
+    runner.add("ElfParser/load_file", [&corpus](bench::State& state) {
+        ElfParser parser;
+        while (state.keep_running()) {
+            if (!parser.load_file(corpus.path)) {
+                state.skip_with_error(parser.get_last_error());
+                return;
+            }
+        }
+        state.set_bytes_processed(state.iterations() * parser.get_file_view().size());
+        state.set_items_processed(state.iterations() * parser.get_symbols().size());
+    });
+
+    // The legacy API builds a std::string pair per instruction; a slice
+    // keeps its footprint bounded on large corpora
+    runner.add("Disassembler/disassemble/4MiB", [&corpus](bench::State& state) {
+        size_t size = std::min<size_t>(corpus.text.size(), 4 * 1024 * 1024);
+        Disassembler disassembler(Architecture::X86_64);
+        size_t count = 0;
+        while (state.keep_running()) {
+            count = disassembler.disassemble(corpus.text.data(), size, corpus.text_address).size();
+        }
+        state.set_bytes_processed(state.iterations() * size);
+        state.set_items_processed(state.iterations() * count);
+    });
+
+    runner.add("Disassembler/disassemble_into", [&corpus](bench::State& state) {
+        Disassembler disassembler(Architecture::X86_64);
+        DisassemblyBuffer buffer;
+        while (state.keep_running()) {
+            buffer.clear();
+            disassembler.disassemble_into(corpus.text.data(), corpus.text.size(), corpus.text_address, buffer);
+        }
+        state.set_bytes_processed(state.iterations() * corpus.text.size());
+        state.set_items_processed(state.iterations() * buffer.size());
+    });
+
+    runner.add("Disassembler/disassemble_parallel", [&corpus, &pool](bench::State& state) {
+        Disassembler disassembler(Architecture::X86_64);
+        DisassemblyBuffer buffer;
+        while (state.keep_running()) {
+            buffer.clear();
+            disassembler.disassemble_parallel(corpus.text.data(), corpus.text.size(), corpus.text_address,
+                                              corpus.entry_points, pool, buffer);
+        }
+        state.set_bytes_processed(state.iterations() * corpus.text.size());
+        state.set_items_processed(state.iterations() * buffer.size());
+    });
+
+    runner.add("Disassembler/analyze_functions", [&corpus](bench::State& state) {
+        const DisassemblyBuffer& instructions = corpus.get_instructions();
+        Disassembler disassembler(Architecture::X86_64);
+        size_t count = 0;
+        while (state.keep_running()) {
+            count = disassembler.analyze_functions(instructions, corpus.entry_points).size();
+        }
+        state.set_items_processed(state.iterations() * instructions.size());
+        state.set_counter("functions", static_cast<double>(count));
+    });
+
+    runner.add("Disassembler/analyze_functions/pool", [&corpus, &pool](bench::State& state) {
+        const DisassemblyBuffer& instructions = corpus.get_instructions();
+        Disassembler disassembler(Architecture::X86_64);
+        size_t count = 0;
+        while (state.keep_running()) {
+            count = disassembler.analyze_functions(instructions, corpus.entry_points, &pool).size();
+        }
+        state.set_items_processed(state.iterations() * instructions.size());
+        state.set_counter("functions", static_cast<double>(count));
+    });
+
+    runner.add("Disassembler/extract_strings", [&corpus](bench::State& state) {
+        Disassembler disassembler(Architecture::X86_64);
+        size_t count = 0;
+        while (state.keep_running()) {
+            count = disassembler.extract_strings(corpus.rodata.data(), corpus.rodata.size()).size();
+        }
+        state.set_bytes_processed(state.iterations() * corpus.rodata.size());
+        state.set_items_processed(state.iterations() * count);
+    });
+
+    runner.add("Disassembler/find_cross_references", [&corpus, &pool](bench::State& state) {
+        const DisassemblyBuffer& instructions = corpus.get_instructions();
+        const std::vector<Function>& functions = corpus.get_functions(pool);
+        if (functions.empty()) {
+            state.skip_with_error("No functions found");
+            return;
+        }
+        uint64_t target = functions[functions.size() / 2].start_address;
+        Disassembler disassembler(Architecture::X86_64);
+        size_t count = 0;
+        while (state.keep_running()) {
+            count = disassembler.find_cross_references(target, instructions).size();
+        }
+        state.set_items_processed(state.iterations() * instructions.size());
+        state.set_counter("references", static_cast<double>(count));
+    });
+
+    runner.add("SymbolTable/lookup_symbol", [&corpus](bench::State& state) {
+        SymbolTable table;
+        table.add_elf_symbols(corpus.parser);
+        if (table.size() == 0) {
+            state.skip_with_error("No symbols in the corpus");
+            return;
+        }
+        // Fixed pseudo-random addresses across .text, so runs compare
+        std::vector<uint64_t> addresses(4096);
+        uint64_t seed = 0x2545f4914f6cdd1dull;
+        for (auto& address : addresses) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            address = corpus.text_address + seed % corpus.text.size();
+        }
+        size_t i = 0;
+        size_t found = 0;
+        while (state.keep_running()) {
+            found += !table.lookup_symbol(addresses[i]).empty();
+            i = (i + 1) % addresses.size();
+        }
+        state.set_items_processed(state.iterations());
+        state.set_counter("found", static_cast<double>(found) / static_cast<double>(state.iterations()));
+    });
+}
+
+void add_debugger_benchmarks(bench::Runner& runner, std::unique_ptr<TracedChild>& child,
+                             std::string& child_error) {
+    // Every benchmark here shares one child, started by whichever runs first
+    auto get_child = [&child, &child_error](bench::State& state) -> TracedChild* {
+        if (!child && child_error.empty()) {
+            auto started = std::make_unique<TracedChild>();
+            if (started->start(child_error)) {
+                child = std::move(started);
+            }
+        }
+        if (!child) {
+            state.skip_with_error("Cannot trace a child process: " + child_error);
+        }
+        return child.get();
+    };
+
+    // Continue from the breakpoint, run one loop iteration and stop on it
+    // again, through the same notifier path the GUI uses
+    runner.add("DebuggerEngine/breakpoint_round_trip", [get_child](bench::State& state) {
+        TracedChild* traced = get_child(state);
+        if (!traced) {
+            return;
+        }
+        std::string error;
+        auto start = std::chrono::steady_clock::now();
+        while (state.keep_running()) {
+            if (!traced->run_to_breakpoint(error)) {
+                state.skip_with_error(error);
+                return;
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        state.set_items_processed(state.iterations());
+        state.set_counter("us_per_stop", seconds * 1e6 / static_cast<double>(state.iterations()));
+    });
+
+    // Cached reads repeat within one stop; cold ones are the first read
+    // after a stop, which is what refreshing the views costs on every step
+    struct ReadCase {
+        const char* name;
+        size_t size;
+        bool cold;
+    };
+    static const ReadCase kReadCases[] = {
+        {"DebuggerEngine/read_memory/16B_cached", 16, false},
+        {"DebuggerEngine/read_memory/4KiB_cached", 4096, false},
+        {"DebuggerEngine/read_memory/4KiB_cold", 4096, true},
+        {"DebuggerEngine/read_memory/64KiB_cold", 64 * 1024, true},
+        {"DebuggerEngine/read_memory/1MiB_cold", 1024 * 1024, true},
+    };
+    for (const ReadCase& read_case : kReadCases) {
+        runner.add(read_case.name, [get_child, read_case](bench::State& state) {
+            TracedChild* traced = get_child(state);
+            if (!traced) {
+                return;
+            }
+            std::vector<uint8_t> buffer(read_case.size);
+            std::string error;
+            traced->engine.reset_memory_cache_stats();
+            while (state.keep_running()) {
+                if (read_case.cold) {
+                    state.pause_timing();
+                    if (!traced->run_to_breakpoint(error)) {
+                        state.skip_with_error(error);
+                        return;
+                    }
+                    state.resume_timing();
+                }
+                if (traced->engine.read_memory_into(traced->memory_address, buffer.data(), buffer.size()) !=
+                    buffer.size()) {
+                    state.skip_with_error("Short read of the child's buffer");
+                    return;
+                }
+            }
+            state.set_bytes_processed(state.iterations() * read_case.size);
+            // Bulk reads bypass the cache, so it has nothing to report for them
+            if (read_case.size <= MemoryCache::MAX_CACHED_READ) {
+                MemoryCacheStats stats = traced->engine.get_memory_cache_stats();
+                uint64_t pages = stats.hits + stats.misses;
+                state.set_counter("cache_hit_rate", pages ? static_cast<double>(stats.hits) / pages : 0.0);
+                state.set_counter("transfers_per_read",
+                                  static_cast<double>(stats.transfers) / static_cast<double>(state.iterations()));
+            }
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc == 2 && std::strcmp(argv[1], "--bench-child") == 0) {
+        return run_child();
+    }
+
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bench::SyntheticElfOptions elf_options;
+    elf_options.text_size = options.size_mb * 1024 * 1024;
+    elf_options.seed = options.seed;
+
+    if (!options.generate.empty()) {
+        bench::SyntheticElfInfo info;
+        std::string error;
+        if (!bench::write_synthetic_elf(options.generate, elf_options, info, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        std::printf("Wrote %s: %zu bytes, %zu functions, %zu strings\n", options.generate.c_str(),
+                    info.file_size, info.function_count, info.string_count);
+        return 0;
+    }
+
+    // Without a corpus, generate one into a temporary file for this run
+    std::string corpus_path = options.corpus;
+    bool remove_corpus = false;
+    if (corpus_path.empty()) {
+        char temp_path[] = "/tmp/debugger_bench_XXXXXX";
+        int fd = mkstemp(temp_path);
+        if (fd < 0) {
+            std::perror("mkstemp");
+            return 1;
+        }
+        close(fd);
+        corpus_path = temp_path;
+        remove_corpus = true;
+
+        bench::SyntheticElfInfo info;
+        std::string error;
+        if (!bench::write_synthetic_elf(corpus_path, elf_options, info, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            unlink(corpus_path.c_str());
+            return 1;
+        }
+    }
+
+    int status = 0;
+    {
+        Corpus corpus;
+        std::string error;
+        if (!corpus.load(corpus_path, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            if (remove_corpus) unlink(corpus_path.c_str());
+            return 1;
+        }
+
+        ThreadPool pool;
+        std::unique_ptr<TracedChild> child;
+        std::string child_error;
+
+        bench::Runner runner;
+        runner.set_min_time(options.min_time);
+        runner.set_filter(options.filter);
+        runner.set_context("executable", argv[0]);
+        runner.set_context("corpus", options.corpus.empty() ? "synthetic" : options.corpus);
+        runner.set_context("corpus_bytes", std::to_string(corpus.parser.get_file_view().size()));
+        runner.set_context("text_bytes", std::to_string(corpus.text.size()));
+        runner.set_context("seed", std::to_string(options.seed));
+        runner.set_context("threads", std::to_string(pool.get_thread_count()));
+
+        add_analysis_benchmarks(runner, corpus, pool);
+        add_debugger_benchmarks(runner, child, child_error);
+
+        std::vector<bench::Result> results = runner.run();
+        child.reset();
+
+        if (!options.json.empty() && !runner.write_json(options.json, results)) {
+            std::fprintf(stderr, "Cannot write %s\n", options.json.c_str());
+            status = 1;
+        }
+    }
+
+    if (remove_corpus) {
+        unlink(corpus_path.c_str());
+    }
+    return status;
+}
@@ -0,0 +1,252 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace debugger {
+namespace bench {
+
+namespace {
+
+constexpr size_t kMaxIterations = 1000000000;
+
+std::string escape_json(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size() + 2);
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+std::string format_rate(double per_second, const char* unit) {
+    char buffer[64];
+    if (per_second >= 1e9) {
+        std::snprintf(buffer, sizeof(buffer), "%.2fG %s/s", per_second / 1e9, unit);
+    } else if (per_second >= 1e6) {
+        std::snprintf(buffer, sizeof(buffer), "%.2fM %s/s", per_second / 1e6, unit);
+    } else if (per_second >= 1e3) {
+        std::snprintf(buffer, sizeof(buffer), "%.2fk %s/s", per_second / 1e3, unit);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.2f %s/s", per_second, unit);
+    }
+    return buffer;
+}
+
+} // namespace
+
+State::State(size_t max_iterations)
+    : max_iterations(max_iterations)
+    , completed(0)
+    , started(false)
+    , finished(false)
+    , cpu_start(0)
+    , cpu_end(0)
+    , pause_cpu_start(0)
+    , paused(0)
+    , paused_cpu(0)
+    , bytes_processed(0)
+    , items_processed(0)
+{
+}
+
+bool State::keep_running() {
+    if (!started) {
+        started = true;
+        cpu_start = std::clock();
+        wall_start = std::chrono::steady_clock::now();
+    } else {
+        ++completed;
+    }
+    if (completed < max_iterations && error.empty()) {
+        return true;
+    }
+    stop_timer();
+    return false;
+}
+
+void State::pause_timing() {
+    pause_cpu_start = std::clock();
+    pause_start = std::chrono::steady_clock::now();
+}
+
+void State::resume_timing() {
+    paused += std::chrono::steady_clock::now() - pause_start;
+    paused_cpu += std::clock() - pause_cpu_start;
+}
+
+void State::skip_with_error(const std::string& message) {
+    error = message;
+    if (started) {
+        stop_timer();
+    }
+}
+
+void State::stop_timer() {
+    if (finished) {
+        return;
+    }
+    wall_end = std::chrono::steady_clock::now();
+    cpu_end = std::clock();
+    finished = true;
+}
+
+void Runner::add(const std::string& name, Body body) {
+    entries.push_back({name, std::move(body)});
+}
+
+std::vector<Result> Runner::run() {
+    std::vector<Result> results;
+    std::printf("%-48s %14s %14s %12s  %s\n", "Benchmark", "Time", "CPU", "Iterations", "Throughput");
+    for (const auto& entry : entries) {
+        if (!filter.empty() && entry.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        Result result = run_one(entry);
+        if (!result.error.empty()) {
+            std::printf("%-48s ERROR: %s\n", result.name.c_str(), result.error.c_str());
+        } else {
+            std::string throughput;
+            if (result.bytes_per_second > 0) throughput += format_rate(result.bytes_per_second, "B");
+            if (result.items_per_second > 0) {
+                if (!throughput.empty()) throughput += "  ";
+                throughput += format_rate(result.items_per_second, "items");
+            }
+            for (const auto& counter : result.counters) {
+                char buffer[96];
+                std::snprintf(buffer, sizeof(buffer), "  %s=%.3g", counter.first.c_str(), counter.second);
+                throughput += buffer;
+            }
+            std::printf("%-48s %11.0f ns %11.0f ns %12zu  %s\n", result.name.c_str(), result.real_time_ns,
+                        result.cpu_time_ns, result.iterations, throughput.c_str());
+        }
+        std::fflush(stdout);
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+Result Runner::run_one(const Entry& entry) const {
+    Result result;
+    result.name = entry.name;
+
+    size_t iterations = 1;
+    for (;;) {
+        State state(iterations);
+        entry.body(state);
+        if (!state.error.empty()) {
+            result.error = state.error;
+            return result;
+        }
+        if (!state.finished) {
+            result.error = "benchmark body did not run its keep_running() loop";
+            return result;
+        }
+
+        double seconds = std::chrono::duration<double>(state.wall_end - state.wall_start - state.paused).count();
+        if (seconds >= min_time || iterations >= kMaxIterations) {
+            double cpu_seconds = static_cast<double>(state.cpu_end - state.cpu_start - state.paused_cpu) / CLOCKS_PER_SEC;
+            result.iterations = state.completed;
+            result.real_time_ns = seconds * 1e9 / static_cast<double>(state.completed);
+            result.cpu_time_ns = cpu_seconds * 1e9 / static_cast<double>(state.completed);
+            if (seconds > 0) {
+                result.bytes_per_second = static_cast<double>(state.bytes_processed) / seconds;
+                result.items_per_second = static_cast<double>(state.items_processed) / seconds;
+            }
+            result.counters = state.counters;
+            result.label = state.label;
+            return result;
+        }
+
+        // Aim 40% past min_time so the next run usually is the last; a run
+        // much shorter than min_time is too noisy to extrapolate from
+        double multiplier = min_time * 1.4 / std::max(seconds, 1e-9);
+        if (seconds / min_time <= 0.1) {
+            multiplier = std::min(multiplier, 10.0);
+        }
+        size_t next = static_cast<size_t>(static_cast<double>(iterations) * multiplier);
+        iterations = std::min(std::max(next, iterations + 1), kMaxIterations);
+    }
+}
+
+bool Runner::write_json(const std::string& path, const std::vector<Result>& results) const {
+    std::ostringstream out;
+    out.precision(10);
+
+    char host[256] = {};
+    gethostname(host, sizeof(host) - 1);
+    char date[64] = {};
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"host_name\": \"" << escape_json(host) << "\",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+    out << "    \"library_build_type\": \"release\"";
+#else
+    out << "    \"library_build_type\": \"debug\"";
+#endif
+    for (const auto& entry : context) {
+        out << ",\n    \"" << escape_json(entry.first) << "\": \"" << escape_json(entry.second) << "\"";
+    }
+    out << "\n  },\n  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\n";
+        out << "      \"name\": \"" << escape_json(result.name) << "\",\n";
+        out << "      \"run_name\": \"" << escape_json(result.name) << "\",\n";
+        out << "      \"run_type\": \"iteration\",\n";
+        if (!result.error.empty()) {
+            out << "      \"error_occurred\": true,\n";
+            out << "      \"error_message\": \"" << escape_json(result.error) << "\"\n    }";
+            continue;
+        }
+        out << "      \"iterations\": " << result.iterations << ",\n";
+        out << "      \"real_time\": " << result.real_time_ns << ",\n";
+        out << "      \"cpu_time\": " << result.cpu_time_ns << ",\n";
+        out << "      \"time_unit\": \"ns\"";
+        if (result.bytes_per_second > 0) {
+            out << ",\n      \"bytes_per_second\": " << result.bytes_per_second;
+        }
+        if (result.items_per_second > 0) {
+            out << ",\n      \"items_per_second\": " << result.items_per_second;
+        }
+        for (const auto& counter : result.counters) {
+            out << ",\n      \"" << escape_json(counter.first) << "\": " << counter.second;
+        }
+        if (!result.label.empty()) {
+            out << ",\n      \"label\": \"" << escape_json(result.label) << "\"";
+        }
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << out.str();
+    return static_cast<bool>(file);
+}
+
+} // namespace bench
+} // namespace debugger
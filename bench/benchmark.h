@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace debugger {
+namespace bench {
+
+// Per-run state handed to a benchmark body. The body times its hot loop
+// with keep_running() and reports what it processed:
+//
+//     while (state.keep_running()) { work(); }
+//     state.set_bytes_processed(state.iterations() * bytes_per_call);
+//
+// Anything before the loop is setup and is not timed.
+class State {
+public:
+    explicit State(size_t max_iterations);
+
+    bool keep_running();
+    size_t iterations() const { return completed; }
+    // Excludes per-iteration setup inside the loop from the timings
+    void pause_timing();
+    void resume_timing();
+
+    void set_bytes_processed(uint64_t bytes) { bytes_processed = bytes; }
+    void set_items_processed(uint64_t items) { items_processed = items; }
+    void set_counter(const std::string& name, double value) { counters[name] = value; }
+    void set_label(const std::string& text) { label = text; }
+    // Marks the run as failed; the body should return straight away
+    void skip_with_error(const std::string& message);
+
+private:
+    friend class Runner;
+
+    size_t max_iterations;
+    size_t completed;
+    bool started;
+    bool finished;
+    std::chrono::steady_clock::time_point wall_start;
+    std::chrono::steady_clock::time_point wall_end;
+    std::clock_t cpu_start;
+    std::clock_t cpu_end;
+    std::chrono::steady_clock::time_point pause_start;
+    std::clock_t pause_cpu_start;
+    std::chrono::steady_clock::duration paused;
+    std::clock_t paused_cpu;
+    uint64_t bytes_processed;
+    uint64_t items_processed;
+    std::map<std::string, double> counters;
+    std::string label;
+    std::string error;
+
+    void stop_timer();
+};
+
+struct Result {
+    std::string name;
+    size_t iterations = 0;
+    double real_time_ns = 0;  // per iteration
+    double cpu_time_ns = 0;   // per iteration, this process
+    double bytes_per_second = 0;
+    double items_per_second = 0;
+    std::map<std::string, double> counters;
+    std::string label;
+    std::string error;
+};
+
+// Runs each registered benchmark with a growing iteration count until one
+// run takes at least min_time, the same way Google Benchmark does, and
+// writes results in its JSON layout so existing comparison tools apply.
+class Runner {
+public:
+    using Body = std::function<void(State& state)>;
+
+    void add(const std::string& name, Body body);
+    void set_min_time(double seconds) { min_time = seconds; }
+    void set_filter(const std::string& substring) { filter = substring; }
+    // Free-form key/value pairs recorded under "context"
+    void set_context(const std::string& key, const std::string& value) { context[key] = value; }
+
+    // Prints a line per benchmark as it completes
+    std::vector<Result> run();
+    bool write_json(const std::string& path, const std::vector<Result>& results) const;
+
+private:
+    struct Entry {
+        std::string name;
+        Body body;
+    };
+
+    std::vector<Entry> entries;
+    double min_time = 0.5;
+    std::string filter;
+    std::map<std::string, std::string> context;
+
+    Result run_one(const Entry& entry) const;
+};
+
+} // namespace bench
+} // namespace debugger
@@ -0,0 +1,328 @@
+#include "elf_generator.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace debugger {
+namespace bench {
+
+namespace {
+
+constexpr uint64_t kImageBase = 0x400000;
+constexpr uint64_t kPageSize = 0x1000;
+constexpr size_t kElfHeaderSize = 64;
+constexpr size_t kProgramHeaderSize = 56;
+constexpr size_t kSectionHeaderSize = 64;
+constexpr size_t kSymbolSize = 24;
+
+enum SectionIndex : uint16_t {
+    SECTION_NULL,
+    SECTION_TEXT,
+    SECTION_RODATA,
+    SECTION_SYMTAB,
+    SECTION_STRTAB,
+    SECTION_SHSTRTAB,
+    SECTION_COUNT
+};
+
+// splitmix64: small, fast and identical everywhere, which is what keeps
+// generated files comparable across machines
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    uint32_t below(uint32_t bound) { return static_cast<uint32_t>(next() % bound); }
+
+private:
+    uint64_t state;
+};
+
+// A rel32 in .text that points at a function or a string once both are placed
+struct Fixup {
+    size_t position;  // of the rel32 field, from the start of .text
+    size_t target;    // function or string index
+    bool is_string;
+};
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void put_u16(std::vector<uint8_t>& out, size_t offset, uint16_t value) { std::memcpy(&out[offset], &value, 2); }
+void put_u32(std::vector<uint8_t>& out, size_t offset, uint32_t value) { std::memcpy(&out[offset], &value, 4); }
+void put_u64(std::vector<uint8_t>& out, size_t offset, uint64_t value) { std::memcpy(&out[offset], &value, 8); }
+
+void emit(std::vector<uint8_t>& text, std::initializer_list<uint8_t> bytes) {
+    text.insert(text.end(), bytes);
+}
+
+void emit_rel32(std::vector<uint8_t>& text, std::vector<Fixup>& fixups, size_t target, bool is_string) {
+    fixups.push_back({text.size(), target, is_string});
+    emit(text, {0, 0, 0, 0});
+}
+
+const char* const kWords[] = {
+    "failed", "to", "open", "read", "write", "buffer", "config", "value", "invalid", "argument",
+    "socket", "timeout", "error", "warning", "connection", "file", "memory", "allocation", "index",
+    "out", "of", "range", "expected", "got", "unable", "parse", "header", "section", "symbol", "%s", "%d"
+};
+
+std::string make_string(Random& random) {
+    std::string text;
+    size_t words = 2 + random.below(8);
+    for (size_t i = 0; i < words; ++i) {
+        if (i != 0) text += random.below(6) == 0 ? ": " : " ";
+        text += kWords[random.below(sizeof(kWords) / sizeof(kWords[0]))];
+    }
+    return text;
+}
+
+// One function of the shapes -O0/-O1 compilers emit. Each function
+// that owns a string loads it into rdi before a call, like a printf.
+void emit_function(std::vector<uint8_t>& text, std::vector<Fixup>& fixups, Random& random,
+                   size_t function_count, size_t string_index, bool has_string) {
+    static const uint8_t kSlots[] = {0xfc, 0xf8, 0xf4, 0xf0, 0xec, 0xe8};
+
+    bool has_frame = random.below(4) != 0;
+    emit(text, {0x55, 0x48, 0x89, 0xe5});                                   // push rbp; mov rbp, rsp
+    if (has_frame) {
+        emit(text, {0x48, 0x83, 0xec, static_cast<uint8_t>(0x10 * (1 + random.below(4)))});  // sub rsp, n
+        emit(text, {0x89, 0x7d, 0xfc});                                     // mov [rbp-4], edi
+    }
+
+    size_t operations = 3 + random.below(24);
+    for (size_t i = 0; i < operations; ++i) {
+        uint8_t slot = kSlots[random.below(sizeof(kSlots))];
+        switch (random.below(10)) {
+            case 0: emit(text, {0x8b, 0x45, slot}); break;                  // mov eax, [rbp-n]
+            case 1: emit(text, {0x89, 0x45, slot}); break;                  // mov [rbp-n], eax
+            case 2: emit(text, {0x83, 0xc0, static_cast<uint8_t>(random.below(128))}); break;  // add eax, imm8
+            case 3: emit(text, {0x01, 0xd0}); break;                        // add eax, edx
+            case 4: emit(text, {0x0f, 0xaf, 0xc2}); break;                  // imul eax, edx
+            case 5: emit(text, {0x89, 0xc2}); break;                        // mov edx, eax
+            case 6:
+                // cmp eax, imm8; jle over the add; add eax, imm8
+                emit(text, {0x83, 0xf8, static_cast<uint8_t>(random.below(100))});
+                emit(text, {static_cast<uint8_t>(0x7c + random.below(4)), 0x03});
+                emit(text, {0x83, 0xc0, 0x01});
+                break;
+            case 7:
+                // mov edi, eax; call fn
+                emit(text, {0x89, 0xc7});
+                emit(text, {0xe8});
+                emit_rel32(text, fixups, random.below(static_cast<uint32_t>(function_count)), false);
+                break;
+            case 8: emit(text, {0x48, 0x8b, 0x45, static_cast<uint8_t>(slot - 4)}); break;  // mov rax, [rbp-n]
+            default: emit(text, {0x31, 0xd2}); break;                       // xor edx, edx
+        }
+    }
+
+    if (has_string) {
+        emit(text, {0x48, 0x8d, 0x3d});                                     // lea rdi, [rip+str]
+        emit_rel32(text, fixups, string_index, true);
+        emit(text, {0xe8});
+        emit_rel32(text, fixups, random.below(static_cast<uint32_t>(function_count)), false);
+    }
+
+    emit(text, {0x8b, 0x45, 0xfc});                                         // mov eax, [rbp-4]
+    if (has_frame) {
+        emit(text, {0xc9, 0xc3});                                           // leave; ret
+    } else {
+        emit(text, {0x5d, 0xc3});                                           // pop rbp; ret
+    }
+    while (text.size() % 16 != 0) {
+        text.push_back(0xcc);
+    }
+}
+
+} // namespace
+
+std::vector<uint8_t> build_synthetic_elf(const SyntheticElfOptions& options, SyntheticElfInfo& info) {
+    info = SyntheticElfInfo{};
+    Random random(options.seed);
+    size_t functions_per_string = options.functions_per_string == 0 ? 1 : options.functions_per_string;
+
+    // Functions average about 80 bytes; calls may target any of them, so the
+    // count is fixed up front and the last few may overshoot text_size
+    size_t function_count = options.text_size / 80 + 1;
+    size_t string_count = function_count / functions_per_string + 1;
+
+    std::vector<std::string> strings;
+    strings.reserve(string_count);
+    std::vector<size_t> string_offsets;
+    string_offsets.reserve(string_count);
+    size_t rodata_size = 0;
+    for (size_t i = 0; i < string_count; ++i) {
+        strings.push_back(make_string(random));
+        string_offsets.push_back(rodata_size);
+        rodata_size += strings.back().size() + 1;
+    }
+
+    std::vector<uint8_t> text;
+    text.reserve(options.text_size + 4096);
+    std::vector<Fixup> fixups;
+    std::vector<size_t> function_offsets;
+    function_offsets.reserve(function_count);
+    for (size_t i = 0; i < function_count; ++i) {
+        function_offsets.push_back(text.size());
+        bool has_string = i % functions_per_string == 0;
+        emit_function(text, fixups, random, function_count, i / functions_per_string, has_string);
+    }
+
+    // Layout: headers, .text on its own page in an R+X segment that also
+    // covers the headers, .rodata in an R segment, then the unloaded tables
+    size_t text_offset = kPageSize;
+    size_t rodata_offset = align_up(text_offset + text.size(), kPageSize);
+    uint64_t text_address = kImageBase + text_offset;
+    uint64_t rodata_address = kImageBase + rodata_offset;
+
+    for (const Fixup& fixup : fixups) {
+        uint64_t target = fixup.is_string ? rodata_address + string_offsets[fixup.target]
+                                          : text_address + function_offsets[fixup.target];
+        uint64_t next = text_address + fixup.position + 4;
+        int32_t rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(next));
+        std::memcpy(&text[fixup.position], &rel, 4);
+    }
+
+    std::string strtab(1, '\0');
+    std::vector<uint32_t> name_offsets;
+    name_offsets.reserve(function_count);
+    for (size_t i = 0; i < function_count; ++i) {
+        char name[32];
+        if (i == 0) {
+            std::snprintf(name, sizeof(name), "_start");
+        } else {
+            std::snprintf(name, sizeof(name), "fn_%06zu", i);
+        }
+        name_offsets.push_back(static_cast<uint32_t>(strtab.size()));
+        strtab += name;
+        strtab += '\0';
+    }
+
+    static const char* const kSectionNames[] = {"", ".text", ".rodata", ".symtab", ".strtab", ".shstrtab"};
+    std::string shstrtab;
+    uint32_t section_name_offsets[SECTION_COUNT];
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        section_name_offsets[i] = static_cast<uint32_t>(shstrtab.size());
+        shstrtab += kSectionNames[i];
+        shstrtab += '\0';
+    }
+
+    size_t symtab_offset = align_up(rodata_offset + rodata_size, 8);
+    size_t symtab_size = (function_count + 1) * kSymbolSize;
+    size_t strtab_offset = symtab_offset + symtab_size;
+    size_t shstrtab_offset = strtab_offset + strtab.size();
+    size_t section_headers_offset = align_up(shstrtab_offset + shstrtab.size(), 8);
+    size_t file_size = section_headers_offset + SECTION_COUNT * kSectionHeaderSize;
+
+    std::vector<uint8_t> image(file_size, 0);
+
+    // ELF header
+    const uint8_t ident[16] = {0x7f, 'E', 'L', 'F', 2 /* 64-bit */, 1 /* LSB */, 1 /* version */};
+    std::memcpy(&image[0], ident, sizeof(ident));
+    put_u16(image, 16, 2);        // ET_EXEC
+    put_u16(image, 18, 62);       // EM_X86_64
+    put_u32(image, 20, 1);
+    put_u64(image, 24, text_address);
+    put_u64(image, 32, kElfHeaderSize);
+    put_u64(image, 40, section_headers_offset);
+    put_u16(image, 52, kElfHeaderSize);
+    put_u16(image, 54, kProgramHeaderSize);
+    put_u16(image, 56, 2);
+    put_u16(image, 58, kSectionHeaderSize);
+    put_u16(image, 60, SECTION_COUNT);
+    put_u16(image, 62, SECTION_SHSTRTAB);
+
+    auto put_segment = [&](size_t index, uint32_t flags, size_t offset, uint64_t address, size_t size) {
+        size_t entry = kElfHeaderSize + index * kProgramHeaderSize;
+        put_u32(image, entry, 1);  // PT_LOAD
+        put_u32(image, entry + 4, flags);
+        put_u64(image, entry + 8, offset);
+        put_u64(image, entry + 16, address);
+        put_u64(image, entry + 24, address);
+        put_u64(image, entry + 32, size);
+        put_u64(image, entry + 40, size);
+        put_u64(image, entry + 48, kPageSize);
+    };
+    put_segment(0, 4 | 1, 0, kImageBase, text_offset + text.size());  // PF_R | PF_X
+    put_segment(1, 4, rodata_offset, rodata_address, rodata_size);     // PF_R
+
+    std::memcpy(&image[text_offset], text.data(), text.size());
+    for (size_t i = 0; i < string_count; ++i) {
+        std::memcpy(&image[rodata_offset + string_offsets[i]], strings[i].c_str(), strings[i].size() + 1);
+    }
+
+    // Entry 0 stays the null symbol
+    for (size_t i = 0; i < function_count; ++i) {
+        size_t entry = symtab_offset + (i + 1) * kSymbolSize;
+        size_t end = i + 1 < function_count ? function_offsets[i + 1] : text.size();
+        put_u32(image, entry, name_offsets[i]);
+        image[entry + 4] = (1 << 4) | 2;  // STB_GLOBAL, STT_FUNC
+        put_u16(image, entry + 6, SECTION_TEXT);
+        put_u64(image, entry + 8, text_address + function_offsets[i]);
+        put_u64(image, entry + 16, end - function_offsets[i]);
+    }
+    std::memcpy(&image[strtab_offset], strtab.data(), strtab.size());
+    std::memcpy(&image[shstrtab_offset], shstrtab.data(), shstrtab.size());
+
+    auto put_section = [&](SectionIndex index, uint32_t type, uint64_t flags, uint64_t address, size_t offset,
+                           size_t size, uint32_t link, uint32_t section_info, uint64_t alignment, uint64_t entry_size) {
+        size_t entry = section_headers_offset + index * kSectionHeaderSize;
+        put_u32(image, entry, section_name_offsets[index]);
+        put_u32(image, entry + 4, type);
+        put_u64(image, entry + 8, flags);
+        put_u64(image, entry + 16, address);
+        put_u64(image, entry + 24, offset);
+        put_u64(image, entry + 32, size);
+        put_u32(image, entry + 40, link);
+        put_u32(image, entry + 44, section_info);
+        put_u64(image, entry + 48, alignment);
+        put_u64(image, entry + 56, entry_size);
+    };
+    // SHT_PROGBITS = 1, SHT_SYMTAB = 2, SHT_STRTAB = 3; SHF_ALLOC = 2, SHF_EXECINSTR = 4
+    put_section(SECTION_TEXT, 1, 2 | 4, text_address, text_offset, text.size(), 0, 0, 16, 0);
+    put_section(SECTION_RODATA, 1, 2, rodata_address, rodata_offset, rodata_size, 0, 0, 1, 0);
+    put_section(SECTION_SYMTAB, 2, 0, 0, symtab_offset, symtab_size, SECTION_STRTAB, 1, 8, kSymbolSize);
+    put_section(SECTION_STRTAB, 3, 0, 0, strtab_offset, strtab.size(), 0, 0, 1, 0);
+    put_section(SECTION_SHSTRTAB, 3, 0, 0, shstrtab_offset, shstrtab.size(), 0, 0, 1, 0);
+
+    info.text_address = text_address;
+    info.entry_point = text_address;
+    info.text_size = text.size();
+    info.rodata_size = rodata_size;
+    info.file_size = file_size;
+    info.function_count = function_count;
+    info.string_count = string_count;
+    info.function_addresses.reserve(function_count);
+    for (size_t offset : function_offsets) {
+        info.function_addresses.push_back(text_address + offset);
+    }
+    return image;
+}
+
+bool write_synthetic_elf(const std::string& path, const SyntheticElfOptions& options,
+                         SyntheticElfInfo& info, std::string& error) {
+    std::vector<uint8_t> image = build_synthetic_elf(options, info);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "Cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        error = "Cannot write " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+} // namespace bench
+} // namespace debugger
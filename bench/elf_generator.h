@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace debugger {
+namespace bench {
+
+struct SyntheticElfOptions {
+    size_t text_size = 16 * 1024 * 1024;  // Approximate; .text holds whole functions
+    uint64_t seed = 1;                    // Same seed and sizes give byte-identical files
+    size_t functions_per_string = 4;      // One .rodata string referenced per this many functions
+};
+
+struct SyntheticElfInfo {
+    uint64_t text_address = 0;
+    uint64_t entry_point = 0;
+    size_t text_size = 0;
+    size_t rodata_size = 0;
+    size_t file_size = 0;
+    size_t function_count = 0;
+    size_t string_count = 0;
+    std::vector<uint64_t> function_addresses;  // Ascending; .symtab names them _start, fn_000001, ...
+};
+
+// Builds a statically linked looking x86-64 executable: a .text of
+// compiler-shaped functions (frame setup, arithmetic, compares with short
+// branches, direct calls to other functions, RIP-relative loads of .rodata
+// strings), plus .rodata, .symtab and .strtab. It never runs; it only gives
+// the parser, disassembler and analysis realistic input at any size.
+std::vector<uint8_t> build_synthetic_elf(const SyntheticElfOptions& options, SyntheticElfInfo& info);
+
+// Returns false and fills error if the file can't be written
+bool write_synthetic_elf(const std::string& path, const SyntheticElfOptions& options,
+                         SyntheticElfInfo& info, std::string& error);
+
+} // namespace bench
+} // namespace debugger
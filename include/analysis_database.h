@@ -0,0 +1,109 @@
+#pragma once
+
+#include "disassembler.h"
+#include "mapped_file.h"
+#include "string_scanner.h"
+#include "xref_index.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace debugger {
+
+class ThreadPool;
+
+// One table in the database file; several make up each kind of result
+enum class DatabaseChunk : uint32_t {
+    INSTRUCTIONS,        // PackedInstruction records
+    OPERAND_TEXT,        // operand arena the records point into
+    MNEMONICS,           // NUL-terminated names in mnemonic id order
+    FUNCTIONS,
+    FUNCTION_BLOCKS,
+    BLOCK_SUCCESSORS,
+    FUNCTION_NAMES,
+    XREFS,
+    XREF_DATA_RANGES,
+    STRINGS,
+    STRING_SECTIONS,
+    STRING_SECTION_NAMES,
+    COUNT
+};
+
+// Binary cache of analysis results for one binary, stored in a file named
+// after the hash of the binary's contents. A fixed header holds the table
+// of contents; every chunk starts on a page boundary in its own slot with
+// some room to grow.
+//
+// open() maps the file and reads only the header, so reopening is cheap
+// however large the binary; each load_*() touches just the chunks it needs.
+// save() compares every stored chunk with the checksum on disk and rewrites
+// only the ones that changed, in place when they still fit their slot.
+class AnalysisDatabase {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 3;  // 2: sub_<hex> function names, 3: 64-bit operand offsets
+
+    AnalysisDatabase();
+
+    AnalysisDatabase(const AnalysisDatabase&) = delete;
+    AnalysisDatabase& operator=(const AnalysisDatabase&) = delete;
+
+    // 64-bit hash of the whole file; blocks are hashed on the pool when one is given
+    static uint64_t compute_content_hash(ByteView data, ThreadPool* pool = nullptr,
+                                         const CancelCheck& cancelled = nullptr);
+    static std::string get_database_path(const std::string& directory, uint64_t content_hash);
+
+    // Fails (and leaves the database empty) unless the file exists and was
+    // written by this format version for a binary with this hash and size
+    bool open(const std::string& path, uint64_t content_hash, uint64_t source_size);
+    void close();
+    bool is_open() const;
+    bool has_chunk(DatabaseChunk chunk) const;
+
+    // Each returns false, leaving the output untouched, when a chunk is
+    // missing or does not hold together
+    bool load_disassembly(DisassemblyBuffer& buffer) const;
+    bool load_functions(std::vector<Function>& functions) const;
+    bool load_xref_index(XrefIndex& index) const;
+    bool load_strings(std::vector<SectionStrings>& strings) const;
+
+    // Serialize into pending chunks for the next save()
+    void store_disassembly(const DisassemblyBuffer& buffer);
+    void store_functions(const std::vector<Function>& functions);
+    void store_xref_index(const XrefIndex& index);
+    void store_strings(const std::vector<SectionStrings>& strings);
+
+    // Writes pending chunks whose contents differ from the file and then the
+    // table of contents. A missing or mismatched file is written from
+    // scratch. The database is reopened on path afterwards.
+    bool save(const std::string& path, uint64_t content_hash, uint64_t source_size);
+
+    size_t get_last_written_chunks() const;
+    std::string get_last_error() const;
+
+private:
+    struct ChunkEntry {
+        uint64_t offset;    // 0 when the chunk is absent
+        uint64_t size;
+        uint64_t capacity;  // bytes reserved at offset
+        uint64_t checksum;
+    };
+
+    static constexpr size_t CHUNK_COUNT = static_cast<size_t>(DatabaseChunk::COUNT);
+    using ChunkTable = std::array<ChunkEntry, CHUNK_COUNT>;
+
+    MappedFile file;
+    ChunkTable table;
+    std::array<std::vector<uint8_t>, CHUNK_COUNT> pending;
+    std::array<bool, CHUNK_COUNT> has_pending;
+    size_t last_written_chunks;
+    std::string last_error;
+
+    ByteView get_chunk(DatabaseChunk chunk) const;
+    void set_pending(DatabaseChunk chunk, std::vector<uint8_t> bytes);
+    bool write_full(const std::string& path, uint64_t content_hash, uint64_t source_size);
+    bool write_changed(int fd, ChunkTable& on_disk);
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analysis_database.h"
+#include "decompiler.h"
+#include "disassembler.h"
+#include "elf_parser.h"
+#include "string_scanner.h"
+#include "thread_pool.h"
+#include "xref_index.h"
+
+namespace debugger {
+
+// In execution order
+enum class AnalysisStage {
+    LOAD,
+    DISASSEMBLE,
+    FUNCTIONS,
+    XREFS,
+    STRINGS,
+    DECOMPILE,
+    DECOMPILE_ALL
+};
+
+// Everything published for the current file. Each member is set when its
+// stage finishes and never changes afterwards, so views can keep the
+// pointers while later stages are still running.
+struct AnalysisResults {
+    std::shared_ptr<const ElfParser> elf_parser;
+    Architecture architecture = Architecture::UNKNOWN;
+    std::shared_ptr<const DisassemblyBuffer> disassembly;
+    std::shared_ptr<const std::vector<Function>> functions;
+    std::shared_ptr<const XrefIndex> xref_index;
+    std::shared_ptr<const std::vector<SectionStrings>> strings;
+    std::shared_ptr<const DecompiledFunction> entry_function;  // main, or the ELF entry point
+    std::shared_ptr<const Decompiler> decompiler;              // Configured for this file; keys the cache
+    std::shared_ptr<DecompilationCache> decompilations;        // Filled by DECOMPILE_ALL and views, thread-safe
+    uint32_t cached_stages = 0;  // bit per AnalysisStage restored from the analysis database
+};
+
+// Runs load -> disassemble -> function discovery -> xrefs -> strings ->
+// decompile entry -> decompile everything on a driver thread, with the heavy stages fanned out on the
+// pool. Notifications are queued to the GUI thread and dropped there if the
+// run they belong to has been cancelled or replaced in the meantime.
+class AnalysisPipeline : public QObject {
+    Q_OBJECT
+public:
+    explicit AnalysisPipeline(ThreadPool& pool, QObject* parent = nullptr);
+    ~AnalysisPipeline() override;
+
+    // Cancels any current run, drops its results and starts on filename
+    void start(const QString& filename);
+    // Stops the run at its next checkpoint; stages already published stay
+    void cancel();
+    // cancel() plus forgetting every published result
+    void clear();
+    bool is_running() const;
+
+    // Where analysis databases are kept; empty disables caching. Takes
+    // effect from the next start().
+    void set_cache_directory(const QString& directory);
+    // Whether DECOMPILE_ALL decompiles every function up front or is
+    // skipped, leaving views to decompile on demand. Off by default; takes
+    // effect from the next start().
+    void set_decompile_all(bool enable);
+
+    // GUI thread only
+    const AnalysisResults& get_results() const;
+    bool is_stage_complete(AnalysisStage stage) const;
+
+    static QString get_stage_name(AnalysisStage stage);
+
+signals:
+    void stage_started(AnalysisStage stage);
+    void stage_progress(AnalysisStage stage, int percent);
+    void stage_finished(AnalysisStage stage);
+    // Streamed disassembly rows, in address order, ahead of DISASSEMBLE finishing
+    void instructions_decoded(std::shared_ptr<const DisassemblyBuffer> batch);
+    void analysis_failed(const QString& message);
+    void analysis_finished(bool cancelled);
+
+private:
+    ThreadPool& pool;
+    std::thread driver;
+    std::atomic<bool> cancel_requested;
+    std::string cache_directory;  // GUI thread; copied into each run
+    bool decompile_all;           // Likewise
+    // Outlives runs, so reopening a binary finds its functions decompiled
+    std::shared_ptr<DecompilationCache> decompilations;
+    uint64_t stage_start_ns;      // Driver thread; when the current stage began
+    
+    // Touched on the GUI thread only
+    uint64_t current_run;
+    bool running;
+    uint32_t completed_stages;
+    AnalysisResults results;
+
+    void join_driver();
+    void run(uint64_t run_id, std::string filename, std::string database_directory, bool decompile_everything);
+    bool is_cancelled() const;
+    
+    // Called from the driver thread; the action runs later on the GUI thread
+    void post(uint64_t run_id, std::function<void()> action);
+    void begin_stage(uint64_t run_id, AnalysisStage stage);
+    void report_progress(uint64_t run_id, AnalysisStage stage, int percent);
+    void publish(uint64_t run_id, AnalysisStage stage, std::function<void(AnalysisResults&)> store);
+    void fail(uint64_t run_id, const QString& message);
+    void finish(uint64_t run_id, bool cancelled);
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct user_regs_struct;
+
+namespace debugger {
+
+class MemoryManager;
+
+// A breakpoint condition: a C-like expression over registers and memory,
+// e.g. "rdi == 0x10 && *(u32*)(rsi+8) > 5". It is compiled once into a
+// small stack bytecode and evaluated on the tracer thread against the
+// registers of the thread that hit, so a hit that doesn't match never
+// leaves that thread.
+//
+// Values are 64-bit and comparisons are signed. Loads are written
+// *(T*)expr with T one of u8/u16/u32/u64/i8/i16/i32/i64 (a bare *expr
+// reads a u64). A load from unreadable memory or a division by zero makes
+// the condition false.
+class BreakpointCondition {
+public:
+    BreakpointCondition();
+
+    bool compile(const std::string& expression);
+    bool evaluate(const user_regs_struct& regs, MemoryManager& memory) const;
+
+    const std::string& get_expression() const;
+    std::string get_last_error() const;
+    size_t get_instruction_count() const;
+
+private:
+    enum class Op : uint8_t {
+        PUSH_CONST,
+        PUSH_REGISTER,  // operand: byte offset into user_regs_struct
+        LOAD,           // pops an address, pushes the value stored there
+        NEGATE,
+        LOGICAL_NOT,
+        BITWISE_NOT,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        MODULO,
+        SHIFT_LEFT,
+        SHIFT_RIGHT,
+        BITWISE_AND,
+        BITWISE_OR,
+        BITWISE_XOR,
+        EQUAL,
+        NOT_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        TO_BOOL,
+        AND_JUMP,  // top is 0: leave it and jump to operand; otherwise pop
+        OR_JUMP    // top is not 0: make it 1 and jump to operand; otherwise pop
+    };
+
+    struct Instruction {
+        Op op;
+        uint8_t width;      // bytes, for PUSH_REGISTER and LOAD
+        bool sign_extend;   // for LOAD
+        uint64_t operand;
+    };
+
+    friend class ConditionParser;
+
+    std::string expression;
+    std::vector<Instruction> code;
+    std::string last_error;
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -1,6 +1,13 @@
 #pragma once
 
+#include "breakpoint_condition.h"
 #include "disassembler.h"
+#include "memory_manager.h"
+#include "process_maps.h"
+#include "register_cache.h"
+#include "sampling_profiler.h"
+#include "stack_unwinder.h"
+#include "tracer.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -13,7 +20,8 @@ namespace debugger {
 enum class BreakpointType {
     SOFTWARE,
     HARDWARE,
-    CONDITIONAL
+    CONDITIONAL,
+    WATCHPOINT
 };
 
 enum class DebuggerState {
@@ -24,13 +32,6 @@ enum class DebuggerState {
     ERROR
 };
 
-struct Register {
-    std::string name;
-    uint64_t value;
-    size_t size;  // in bytes
-    bool modified;
-};
-
 struct MemoryRegion {
     uint64_t start_address;
     uint64_t end_address;
@@ -44,14 +45,18 @@ struct Breakpoint {
     BreakpointType type;
     bool enabled;
     std::string condition;
-    std::function<bool()> condition_func;
+    std::shared_ptr<const BreakpointCondition> compiled_condition;  // Evaluated on the tracer thread
     uint8_t original_byte;  // For software breakpoints
     std::string name;
     size_t hit_count;
+    bool tracing;                  // Counted and resumed without stopping
+    LatencyHistogram hit_latency;  // Trap to handled, measured on the tracer thread
+    WatchKind watch_kind;          // For hardware breakpoints and watchpoints
+    size_t watch_length;
 };
 
 struct StackFrame {
-    uint64_t return_address;
+    uint64_t return_address;  // Where this frame is executing; the stop pc for the innermost one
     uint64_t frame_pointer;
     uint64_t stack_pointer;
     std::string function_name;
@@ -72,6 +77,15 @@ public:
     bool stop_execution();
     bool detach();
 
+    // Threads. In all-stop mode (the default) continuing resumes every
+    // thread; in non-stop mode it resumes only the current one. Stepping
+    // always moves just the current thread.
+    void set_stop_mode(StopMode mode);
+    StopMode get_stop_mode();
+    std::vector<ThreadInfo> get_threads();
+    bool select_thread(pid_t tid);
+    pid_t get_current_thread() const;
+
     // Stepping
     bool step_into();
     bool step_over();
@@ -80,57 +94,108 @@ public:
 
     // Breakpoints
     bool add_breakpoint(uint64_t address, BreakpointType type = BreakpointType::SOFTWARE);
+    // Sets or replaces the condition, adding the breakpoint if needed; an
+    // empty condition makes it unconditional again
     bool add_conditional_breakpoint(uint64_t address, const std::string& condition);
+    bool add_tracepoint(uint64_t address);  // Counts hits without stopping
+    size_t add_breakpoints(const std::vector<uint64_t>& addresses);  // Batched; returns how many were set
+    // Debug-register watchpoint on length (1, 2, 4 or 8) aligned bytes; the
+    // target runs at full speed until it is hit
+    bool add_watchpoint(uint64_t address, size_t length, WatchKind kind = WatchKind::WRITE);
     bool remove_breakpoint(uint64_t address);
+    size_t remove_breakpoints(const std::vector<uint64_t>& addresses);
     bool enable_breakpoint(uint64_t address);
     bool disable_breakpoint(uint64_t address);
-    std::vector<Breakpoint> get_breakpoints() const;
+    std::vector<Breakpoint> get_breakpoints();
     bool is_breakpoint_hit(uint64_t address) const;
+    void reset_breakpoint_stats();
 
     // Memory operations
     std::vector<uint8_t> read_memory(uint64_t address, size_t size);
+    size_t read_memory_into(uint64_t address, uint8_t* buffer, size_t size);
     bool write_memory(uint64_t address, const std::vector<uint8_t>& data);
+    bool write_memory(uint64_t address, const uint8_t* data, size_t size);
+    MemoryCacheStats get_memory_cache_stats() const;
+    void reset_memory_cache_stats();
     std::vector<MemoryRegion> get_memory_regions();
     bool set_memory_protection(uint64_t address, size_t size, const std::string& permissions);
 
-    // Register operations
+    // Register operations. These read the current thread's registers once
+    // per stop; writes are held back and applied together when it resumes.
     std::vector<Register> get_registers();
     bool set_register(const std::string& name, uint64_t value);
+    std::vector<uint8_t> get_vector_register(const std::string& name);
     uint64_t get_register_value(const std::string& name);
     uint64_t get_instruction_pointer();
     uint64_t get_stack_pointer();
     uint64_t get_frame_pointer();
 
-    // Stack operations
+    // Stack operations. Unwound from the current thread's registers with
+    // .eh_frame CFI, falling back to the frame-pointer chain.
     std::vector<StackFrame> get_stack_trace();
-    std::vector<uint64_t> get_stack_data(size_t frame_count = 20);
+    std::vector<uint64_t> get_stack_data(size_t frame_count = 20);  // Just the pcs, innermost first
+    UnwinderStats get_unwinder_stats();
+
+    // Profiling. Samples the running target's threads at frequency_hz with
+    // perf_event_open where the kernel allows it, otherwise by interrupting
+    // them on a timer. The profile survives stop_profiling() and is only
+    // cleared by the next start.
+    bool start_profiling(unsigned frequency_hz = 1000);
+    void stop_profiling();
+    bool is_profiling();
+    ProfileSummary get_profile();
+    bool export_folded_stacks(const std::string& path);
 
     // State management
     DebuggerState get_state() const;
     pid_t get_process_id() const;
     std::string get_last_error() const;
-
-    // Event handling
+    uint64_t get_last_stop_time() const;  // CLOCK_MONOTONIC ns the current stop was reaped at, 0 if none
+
+    // Event handling. Stops are detected on the tracer thread and queued;
+    // the notifier runs on that thread and should arrange for
+    // process_pending_events() to be called on the owning thread, which is
+    // where the callbacks fire.
+    void set_event_notifier(std::function<void()> notifier);
+    void process_pending_events();
     void set_breakpoint_callback(std::function<void(uint64_t)> callback);
+    void set_watchpoint_callback(std::function<void(uint64_t address, uint64_t pc)> callback);
+    void set_stop_callback(std::function<void(uint64_t)> callback);  // step finished or paused
     void set_signal_callback(std::function<void(int)> callback);
     void set_exit_callback(std::function<void(int)> callback);
 
-    // Utility functions
+    // Utility functions. Symbols and modules come from the target's
+    // mappings, reread only after the dynamic linker reports a change.
     bool is_process_running() const;
     std::string get_current_function_name(uint64_t address = 0);
-    uint64_t resolve_symbol(const std::string& symbol_name);
+    uint64_t resolve_symbol(const std::string& symbol_name);  // "libc.so.6!puts" limits it to one module
     std::vector<std::string> get_loaded_modules();
 
 private:
     pid_t target_pid;
+    pid_t current_thread;  // Thread whose stop is being shown; registers come from here
     DebuggerState current_state;
     std::string executable_path;
     std::vector<std::string> program_args;
     std::map<uint64_t, Breakpoint> breakpoints;
     std::string last_error;
+    MemoryManager memory;
+    MemoryCache memory_cache;  // Only consulted while the target is stopped
+    RegisterCache register_cache;  // current_thread's registers at this stop
+    bool owns_process;         // Started by us rather than attached to
+    Tracer tracer;             // Every ptrace request goes through here
+    ProcessMaps process_maps;  // Tracer thread only, like the unwinder that reads it
+    StackUnwinder unwinder;    // Driven on the tracer thread
+    uint64_t loader_breakpoint;  // Tracing breakpoint on the dynamic linker's r_brk hook, 0 if none
+    uint64_t loader_hits;        // Its hit count when the maps were last synced
+    bool regions_stale;          // The target has run since the region list was read
+    uint64_t last_stop_time;     // TraceEvent timestamp of the stop being shown
+    SamplingProfiler profiler;  // Fed and read on the tracer thread
     
     // Callbacks
     std::function<void(uint64_t)> breakpoint_callback;
+    std::function<void(uint64_t, uint64_t)> watchpoint_callback;
+    std::function<void(uint64_t)> stop_callback;
     std::function<void(int)> signal_callback;
     std::function<void(int)> exit_callback;
 
@@ -140,12 +205,17 @@ private:
     // Helper functions
     bool setup_debugging();
     bool cleanup_debugging();
-    bool wait_for_signal();
+    void handle_event(const TraceEvent& event);
     bool handle_breakpoint(uint64_t address);
-    bool insert_software_breakpoint(uint64_t address);
-    bool remove_software_breakpoint(uint64_t address);
-    bool evaluate_condition(const std::string& condition);
-    void update_register_cache();
+    size_t insert_software_breakpoints(const std::vector<uint64_t>& addresses, bool tracing);
+    size_t remove_software_breakpoints(const std::vector<uint64_t>& addresses);
+    bool set_hardware_breakpoint(Breakpoint& bp, bool insert);
+    bool is_hardware(const Breakpoint& bp) const;
+    bool update_register_cache();
+    bool flush_register_cache();
+    void resolve_profile_names();  // Tracer thread only
+    void attach_process_maps(pid_t pid);  // Tracer thread only, as is the next one
+    void sync_process_maps();
     bool is_valid_address(uint64_t address);
     std::string get_protection_string(int prot);
 };
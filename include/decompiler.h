@@ -1,10 +1,15 @@
 #pragma once
 
+#include "decompiler_ir.h"
 #include "disassembler.h"
+#include "xref_index.h"
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace debugger {
@@ -47,6 +52,16 @@ struct ControlFlow {
     std::vector<BasicBlock> blocks;
 };
 
+// Span of DecompiledFunction::full_code, so views can color the text
+// without lexing it again. Never crosses a line.
+struct CodeToken {
+    enum Kind : uint8_t { KEYWORD, TYPE, FUNCTION, VARIABLE, NUMBER, STRING, COMMENT, LABEL };
+
+    uint32_t offset;
+    uint32_t length;
+    Kind kind;
+};
+
 struct DecompiledFunction {
     std::string name;
     std::string return_type;
@@ -54,22 +69,31 @@ struct DecompiledFunction {
     std::vector<Variable> local_variables;
     std::vector<ControlFlow> control_flows;
     std::string full_code;
+    std::vector<CodeToken> tokens;  // In offset order
     uint64_t start_address;
     uint64_t end_address;
 };
 
+class ThreadPool;
+
 class Decompiler {
 public:
     explicit Decompiler(Architecture arch = Architecture::X86_64);
     ~Decompiler() = default;
 
-    // Main decompilation functions
-    DecompiledFunction decompile_function(const Function& function);
-    std::string decompile_instruction_block(const std::vector<Instruction>& instructions);
-    std::string decompile_single_instruction(const Instruction& instruction);
+    // Main decompilation functions. Lifts the function into SSA, removes
+    // dead code and structures the result; safe to call from several
+    // threads once configured.
+    DecompiledFunction decompile_function(const Function& function, const DisassemblyBuffer& instructions) const;
+    // For functions carrying their own instruction list
+    DecompiledFunction decompile_function(const Function& function) const;
+    // Identifies a decompilation result: the function's bytes plus
+    // everything else its output depends on (callee names, callers, options)
+    uint64_t hash_function(const Function& function, const DisassemblyBuffer& instructions) const;
 
     // Analysis functions
     std::vector<BasicBlock> analyze_basic_blocks(const Function& function);
+    std::vector<BasicBlock> analyze_basic_blocks(const Function& function, const DisassemblyBuffer& instructions);
     std::vector<ControlFlow> analyze_control_flow(const std::vector<BasicBlock>& blocks);
     std::vector<Variable> analyze_variables(const Function& function);
     
@@ -91,30 +115,62 @@ public:
     void set_architecture(Architecture arch);
     void enable_comments(bool enable);
     void set_variable_naming_style(const std::string& style);
+    void set_xref_index(std::shared_ptr<const XrefIndex> index);
+    // Names call targets; sorted by start address, as Disassembler::analyze_functions returns them
+    void set_functions(std::shared_ptr<const std::vector<Function>> functions);
 
 private:
     Architecture current_arch;
     bool comments_enabled;
     std::string variable_naming_style;
-    std::map<uint64_t, std::string> register_mappings;
     std::unordered_set<std::string> reserved_keywords;
+    std::shared_ptr<const XrefIndex> xref_index;
+    std::shared_ptr<const std::vector<Function>> functions;
     
     // Helper functions
-    void initialize_register_mappings();
+    void link_predecessors(std::vector<BasicBlock>& blocks);
     void initialize_reserved_keywords();
-    std::string sanitize_variable_name(const std::string& name);
-    std::string get_register_name(const std::string& reg);
-    std::string convert_operand_to_c(const std::string& operand);
-    std::string generate_unique_variable_name(const std::string& base);
-    bool is_arithmetic_instruction(const std::string& mnemonic);
-    bool is_comparison_instruction(const std::string& mnemonic);
-    bool is_memory_access(const std::string& mnemonic);
-    std::string convert_condition_to_c(const std::string& condition);
-    
-    // Instruction conversion helpers
-    std::string convert_mov_instruction(const std::string& operands);
-    std::string convert_arithmetic_instruction(const std::string& op, const std::string& operands);
-    std::string convert_call_instruction(const std::string& operands);
+    std::string sanitize_variable_name(const std::string& name) const;
+    std::string get_function_name(uint64_t address) const;
+    std::string get_caller_comment(uint64_t address) const;
+    std::vector<CodeToken> tokenize(const std::string& code, const std::unordered_set<std::string>& variables) const;
+    static VariableType type_of_width(uint8_t width);
+};
+
+// Decompiled functions keyed by Decompiler::hash_function(), shared by the
+// pipeline and the views. Holds about `capacity` functions: when the newer
+// generation fills up the older one is dropped, and hits in the older one
+// move forward. decompile_all() grows the capacity so that everything it
+// decompiles stays cached.
+class DecompilationCache {
+public:
+    using Entry = std::shared_ptr<const DecompiledFunction>;
+    // Completed and total functions; returning false stops decompile_all()
+    using ProgressCallback = std::function<bool(size_t done, size_t total)>;
+
+    explicit DecompilationCache(size_t capacity = 8192);
+
+    Entry find(uint64_t hash);
+    void insert(uint64_t hash, Entry function);
+    // Cached result, decompiling and inserting on a miss
+    Entry get(const Decompiler& decompiler, const Function& function, const DisassemblyBuffer& instructions);
+    // Decompiles every function not yet cached across the pool's workers;
+    // returns false when progress asked to stop. Must not be called from a
+    // pool task.
+    bool decompile_all(const Decompiler& decompiler, const std::vector<Function>& functions,
+                       const DisassemblyBuffer& instructions, ThreadPool& pool,
+                       const ProgressCallback& progress = nullptr);
+
+    size_t size() const;
+    void clear();
+
+private:
+    mutable std::mutex mutex;
+    size_t capacity;
+    std::unordered_map<uint64_t, Entry> current;
+    std::unordered_map<uint64_t, Entry> previous;
+
+    void insert_locked(uint64_t hash, Entry function);
 };
 
 } // namespace debugger 
\ No newline at end of file
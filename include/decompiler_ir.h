@@ -0,0 +1,191 @@
+#pragma once
+
+#include "disassembler.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace debugger {
+
+struct ControlFlow;
+
+enum class IrOp : uint8_t {
+    COPY,
+    ADD, SUB, MUL, DIV, UDIV, MOD, UMOD,
+    AND, OR, XOR, SHL, SHR, SAR,
+    NEG, NOT,
+    SEXT, ZEXT,      // operands[0] narrowed to source_width, then extended
+    CMP, TEST,       // flags of operands[0] - operands[1] / operands[0] & operands[1]
+    SETCC,           // condition over the flags in operands[0], as 0 or 1
+    SELECT,          // condition over operands[0] ? operands[1] : operands[2]
+    LOAD,            // *operands[0]
+    STORE,           // *operands[0] = operands[1]
+    CALL,            // operands[0] is the target; arguments are extra operands
+    PHI,             // one extra operand per predecessor, in predecessor order
+    UNDEF,           // clobbered by a call, or restored from the stack
+    ASM,             // not modelled; extra operands are everything it may read
+    BRANCH,          // condition over operands[0]: successors[0] if true, else successors[1]
+    JUMP,
+    INDIRECT_JUMP,   // to operands[0]; the targets are unknown
+    RETURN           // operands[0] when the function returns a value
+};
+
+// x86 condition codes, named after the comparison they stand for when the
+// flags come from CMP
+enum class IrCondition : uint8_t {
+    NONE,
+    EQ, NE,
+    LT, LE, GT, GE,
+    BELOW, BELOW_EQ, ABOVE, ABOVE_EQ,
+    SIGN, NOT_SIGN,
+    OVERFLOW, NOT_OVERFLOW,
+    PARITY, NOT_PARITY
+};
+
+IrCondition negate_condition(IrCondition condition);
+
+struct IrValue {
+    enum Kind : uint8_t {
+        NONE,
+        VAR,    // location before build_ssa(), SSA variable after
+        CONST,
+        FRAME,  // address of the stack at constant offset from the entry stack pointer
+        TLS     // address at constant offset in the thread segment (fs:/gs:)
+    };
+
+    Kind kind = NONE;
+    uint8_t width = 0;      // bytes read; narrower than the definition means a truncation
+    uint32_t var = 0;
+    uint64_t constant = 0;  // CONST value, or the FRAME/TLS offset
+
+    static IrValue make_var(uint32_t var, uint8_t width);
+    static IrValue make_const(uint64_t value, uint8_t width);
+    static IrValue make_frame(int64_t offset);
+    static IrValue make_tls(uint64_t offset);
+    bool is_var() const { return kind == VAR; }
+    bool is_const() const { return kind == CONST; }
+};
+
+struct IrInstruction {
+    static constexpr uint32_t NO_VAR = UINT32_MAX;
+
+    IrOp op;
+    IrCondition condition = IrCondition::NONE;
+    uint8_t width = 0;         // bytes of the result, or of the value stored/loaded
+    uint8_t source_width = 0;  // SEXT/ZEXT
+    uint8_t operand_count = 0;
+    uint32_t dest = NO_VAR;
+    IrValue operands[3];
+    uint32_t extra_first = 0;  // slice of IrFunction::extra_operands
+    uint32_t extra_count = 0;
+    uint32_t text = 0;         // ASM: index into IrFunction::asm_text
+    uint64_t address = 0;      // machine instruction it was lifted from
+};
+
+struct IrBlock {
+    uint64_t address;
+    std::vector<IrInstruction> instructions;  // phis first, terminator last
+    std::vector<uint32_t> successors;         // BRANCH: taken, then fall-through
+    std::vector<uint32_t> predecessors;
+    uint32_t immediate_dominator = UINT32_MAX;
+};
+
+// Something the lifter tracks through SSA: a general register, the flags,
+// a promoted stack slot or a temporary splitting one machine instruction
+struct IrLocation {
+    enum Kind : uint8_t { REGISTER, FLAGS, STACK, TEMPORARY };
+
+    Kind kind;
+    uint8_t width;
+    int8_t parameter;      // argument register index, -1 if none
+    int64_t frame_offset;  // STACK
+    std::string name;
+};
+
+struct IrVariable {
+    static constexpr uint32_t ENTRY = UINT32_MAX;
+
+    uint32_t location;
+    uint32_t block;  // defining block, ENTRY for the value on entry
+    uint32_t web;    // set by assign_names(); variables of one web share a name
+    uint8_t width;
+};
+
+struct IrWeb {
+    std::string name;
+    uint8_t width;
+    int8_t parameter;  // the web holds that argument's entry value
+    bool stack;
+};
+
+struct IrFunction {
+    uint64_t address = 0;
+    std::vector<IrBlock> blocks;  // blocks[0] is the entry
+    std::vector<IrLocation> locations;
+    std::vector<IrVariable> variables;  // after build_ssa()
+    std::vector<IrWeb> webs;            // after assign_names()
+    std::vector<IrValue> extra_operands;
+    std::vector<std::string> asm_text;
+    uint32_t return_location = UINT32_MAX;
+    bool in_ssa = false;
+
+    // The values an instruction reads, extra operands included
+    template <typename F>
+    void for_each_use(IrInstruction& instruction, F&& visit) {
+        for (uint8_t i = 0; i < instruction.operand_count; ++i) {
+            visit(instruction.operands[i]);
+        }
+        for (uint32_t i = 0; i < instruction.extra_count; ++i) {
+            visit(extra_operands[instruction.extra_first + i]);
+        }
+    }
+
+    template <typename F>
+    void for_each_use(const IrInstruction& instruction, F&& visit) const {
+        for (uint8_t i = 0; i < instruction.operand_count; ++i) {
+            visit(instruction.operands[i]);
+        }
+        for (uint32_t i = 0; i < instruction.extra_count; ++i) {
+            visit(extra_operands[instruction.extra_first + i]);
+        }
+    }
+};
+
+// Lifts the function's blocks (recursive-descent blocks when present, else
+// leaders over its instruction range) into IR. x86 and x86-64 are lifted
+// instruction by instruction; other architectures become ASM statements
+// over the same control flow.
+bool lift_function(const Function& function, const DisassemblyBuffer& instructions,
+                   Architecture arch, IrFunction& ir);
+
+// Dominators, phi placement at iterated dominance frontiers of the
+// locations live across blocks, and renaming
+void build_ssa(IrFunction& ir);
+// Folds and substitutes constants outside phis; returns the uses rewritten
+size_t propagate_constants(IrFunction& ir);
+// Removes pure definitions nothing reads; returns the instructions removed
+size_t eliminate_dead_code(IrFunction& ir);
+// Groups variables joined by phis into webs and names them: arguments a1..,
+// stack slots by offset, everything else prefix + number
+void assign_names(IrFunction& ir, const std::string& prefix);
+
+struct CodeGenOptions {
+    std::string name;
+    std::function<std::string(uint64_t)> function_name;  // call target -> callee name
+};
+
+struct GeneratedCode {
+    std::string signature;
+    std::string body;  // braces included
+    std::string return_type;
+    std::vector<ControlFlow> control_flows;
+};
+
+// Structures the CFG into if/else, while and do-while with gotos for what
+// doesn't fit, folding single-use definitions into the expressions that
+// read them
+GeneratedCode generate_code(const IrFunction& ir, const CodeGenOptions& options);
+
+} // namespace debugger 
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "thread_pool.h"
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
 #include <cstdint>
 #include <capstone/capstone.h>
 
@@ -26,6 +31,106 @@ struct Instruction {
     bool is_call;
     bool is_return;
     uint64_t target_address;  // For jumps/calls
+    uint64_t immediate;       // First non-target immediate, or a RIP-relative address
+    bool has_immediate;
+};
+
+// Flag bits for PackedInstruction::flags
+enum InstructionFlags : uint8_t {
+    INSN_JUMP = 1 << 0,
+    INSN_CALL = 1 << 1,
+    INSN_RETURN = 1 << 2,
+    INSN_HAS_TARGET = 1 << 3,
+    INSN_HAS_IMMEDIATE = 1 << 4
+};
+
+// Fixed-size, allocation-free instruction record. Text is owned by the
+// DisassemblyBuffer the record lives in: the mnemonic as an interned id and
+// the operands as a slice of a shared arena.
+struct PackedInstruction {
+    uint64_t address;
+    uint64_t target_address;  // For jumps/calls
+    uint64_t immediate;       // Valid when INSN_HAS_IMMEDIATE is set
+    uint64_t operands_offset; // Into the operand arena; 64-bit costs nothing, it fills padding
+    uint16_t operands_length;
+    uint16_t mnemonic_id;
+    uint8_t bytes[15];        // Longest x86 encoding; ARM uses the first 4
+    uint8_t size;
+    uint8_t flags;
+
+    bool is_jump() const { return (flags & INSN_JUMP) != 0; }
+    bool is_call() const { return (flags & INSN_CALL) != 0; }
+    bool is_return() const { return (flags & INSN_RETURN) != 0; }
+    bool has_target() const { return (flags & INSN_HAS_TARGET) != 0; }
+    bool has_immediate() const { return (flags & INSN_HAS_IMMEDIATE) != 0; }
+};
+
+static_assert(sizeof(PackedInstruction) <= 56, "PackedInstruction should stay compact");
+
+// Address-ordered array of packed instructions plus the text they refer to.
+// Operand text is one arena addressed by 64-bit offsets, so only memory
+// limits its size; each instruction keeps at most UINT16_MAX bytes of it.
+class DisassemblyBuffer {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void clear();
+    void reserve(size_t instruction_count, size_t operand_bytes = 0);
+
+    void append(uint64_t address, const uint8_t* bytes, size_t size,
+                std::string_view mnemonic, std::string_view operands,
+                uint8_t flags, uint64_t target_address, uint64_t immediate = 0);
+    void append(const Instruction& instruction);
+    // Copies records from another buffer, re-interning mnemonics and operands
+    void append_range(const DisassemblyBuffer& source, size_t first, size_t count);
+
+    size_t size() const { return instructions.size(); }
+    bool empty() const { return instructions.empty(); }
+    const PackedInstruction& operator[](size_t index) const { return instructions[index]; }
+    const PackedInstruction* begin() const { return instructions.data(); }
+    const PackedInstruction* end() const { return instructions.data() + instructions.size(); }
+    const PackedInstruction& back() const { return instructions.back(); }
+
+    std::string_view get_mnemonic(const PackedInstruction& insn) const;
+    std::string_view get_operands(const PackedInstruction& insn) const;
+    size_t get_mnemonic_count() const { return mnemonics.size(); }
+    std::string_view get_mnemonic_name(uint16_t id) const { return mnemonics[id]; }
+    std::string_view get_operand_text() const { return std::string_view(operand_text.data(), operand_text.size()); }
+
+    // Adopts tables produced by an earlier buffer (e.g. read back from the
+    // analysis database); records must index into operand_text and mnemonics
+    void assign(std::vector<PackedInstruction> records, std::vector<char> operand_text,
+                std::vector<std::string> mnemonics);
+
+    // Binary search; returns npos if no instruction starts at address
+    size_t find_index(uint64_t address) const;
+
+    // Conversions for code that still takes the legacy representation
+    Instruction to_instruction(size_t index) const;
+    std::vector<Instruction> to_instructions() const;
+
+    size_t memory_usage() const;
+
+private:
+    std::vector<PackedInstruction> instructions;
+    std::vector<char> operand_text;
+    std::vector<std::string> mnemonics;
+    std::unordered_map<std::string, uint16_t> mnemonic_ids;
+
+    uint16_t intern_mnemonic(std::string_view mnemonic);
+};
+
+// Called by Disassembler::disassemble_stream() after each batch is appended
+// to the output buffer; return false to stop the stream early
+using DisassemblyBatchCallback = std::function<bool(const DisassemblyBuffer& buffer, size_t first, size_t count)>;
+
+// Basic block recorded as an index range into a DisassemblyBuffer
+struct FunctionBlock {
+    uint64_t start_address;
+    uint64_t end_address;
+    size_t first_instruction;
+    size_t instruction_count;
+    std::vector<uint64_t> successors;  // Start addresses of successor blocks
 };
 
 struct Function {
@@ -34,6 +139,11 @@ struct Function {
     std::string name;
     std::vector<Instruction> instructions;
     std::vector<uint64_t> cross_references;
+    // Index range of the function in the DisassemblyBuffer it was found in
+    size_t first_instruction = 0;
+    size_t instruction_count = 0;
+    // Address-ordered basic blocks; only filled by recursive-descent analysis
+    std::vector<FunctionBlock> blocks;
 };
 
 class Disassembler {
@@ -46,9 +156,40 @@ public:
     std::vector<Instruction> disassemble(const uint8_t* data, size_t size, uint64_t base_address = 0);
     std::vector<Instruction> disassemble_range(const uint8_t* data, size_t size, 
                                              uint64_t start_addr, uint64_t end_addr);
+    size_t disassemble_into(const uint8_t* data, size_t size, uint64_t base_address,
+                            DisassemblyBuffer& buffer);
+    
+    // Streaming disassembly: decodes one instruction at a time into a reused
+    // cs_insn and hands fixed-size batches to on_batch as they are appended to
+    // buffer. Undecodable bytes become ".byte" entries so the sweep continues.
+    static constexpr size_t DEFAULT_BATCH_SIZE = 4096;
+    size_t disassemble_stream(const uint8_t* data, size_t size, uint64_t base_address,
+                              DisassemblyBuffer& buffer, const DisassemblyBatchCallback& on_batch,
+                              size_t batch_size = DEFAULT_BATCH_SIZE);
+    
+    // Parallel disassembly: splits the range into chunks, preferring the
+    // addresses in split_hints (function/symbol starts) as boundaries, and
+    // decodes each on its own Capstone handle. Boundaries without a hint are
+    // resynchronised on x86 by decoding past them until both chunks agree.
+    // Returns 0 and leaves buffer untouched once cancelled() reports true.
+    size_t disassemble_parallel(const uint8_t* data, size_t size, uint64_t base_address,
+                                const std::vector<uint64_t>& split_hints,
+                                ThreadPool& pool, DisassemblyBuffer& buffer,
+                                const CancelCheck& cancelled = nullptr);
     
     // Function analysis
     std::vector<Function> analyze_functions(const std::vector<Instruction>& instructions);
+    // Recursive descent over an already decoded buffer: starts at entry_points
+    // (entry point and symbols), follows branches to build basic blocks and
+    // queues every direct call target as a new function. Functions refer back
+    // to the buffer by index instead of copying instructions. With a pool the
+    // functions are traced in parallel; do not call this from a pool task.
+    // Without entry points, prologue heuristics provide the initial seeds.
+    // Once cancelled() reports true no further functions are traced.
+    std::vector<Function> analyze_functions(const DisassemblyBuffer& instructions,
+                                            const std::vector<uint64_t>& entry_points = {},
+                                            ThreadPool* pool = nullptr,
+                                            const CancelCheck& cancelled = nullptr);
     Function analyze_function(const std::vector<Instruction>& instructions, uint64_t start_address);
     
     // Utility functions
@@ -59,10 +200,12 @@ public:
     // Cross-reference analysis
     std::vector<uint64_t> find_cross_references(uint64_t address, 
                                                const std::vector<Instruction>& instructions);
+    std::vector<uint64_t> find_cross_references(uint64_t address, const DisassemblyBuffer& instructions);
     
     // String and constant detection
     std::vector<std::string> extract_strings(const uint8_t* data, size_t size);
     std::vector<uint64_t> find_constants(const std::vector<Instruction>& instructions);
+    std::vector<uint64_t> find_constants(const DisassemblyBuffer& instructions);
 
 private:
     csh cs_handle;
@@ -73,9 +216,17 @@ private:
     bool setup_capstone(Architecture arch);
     void cleanup_capstone();
     Instruction convert_cs_instruction(const cs_insn* insn) const;
+    uint8_t classify_cs_instruction(const cs_insn* insn, uint64_t& target_address, uint64_t& immediate) const;
+    size_t get_instruction_alignment() const;
     bool is_function_start(const Instruction& insn) const;
+    bool is_function_start(std::string_view mnemonic, std::string_view operands) const;
     bool is_function_end(const Instruction& insn) const;
+    bool has_fallthrough(const PackedInstruction& insn, std::string_view mnemonic) const;
+    Function trace_function(const DisassemblyBuffer& instructions, size_t start_index,
+                            const std::unordered_set<uint64_t>& known_starts,
+                            std::vector<uint64_t>& call_targets) const;
     uint64_t extract_target_address(const Instruction& insn) const;
+    uint64_t parse_target_address(std::string_view operands) const;
 };
 
 } // namespace debugger 
\ No newline at end of file
@@ -1,21 +1,26 @@
 #pragma once
 
 #include "disassembler.h"
+#include "mapped_file.h"
+#include "string_pool.h"
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 // #include <elfio/elfio.hpp>  // Commented out for now
 
 namespace debugger {
 
+// Symbol strings are interned in the owning ElfParser's string pool and stay
+// valid until the parser loads another file
 struct Symbol {
-    std::string name;
+    std::string_view name;
     uint64_t address;
     uint64_t size;
-    std::string type;
-    std::string binding;
-    std::string section_name;
+    std::string_view type;
+    std::string_view binding;
+    std::string_view section_name;
     bool is_function;
     bool is_imported;
     bool is_exported;
@@ -28,7 +33,7 @@ struct Section {
     uint64_t file_offset;
     std::string type;
     std::string flags;
-    std::vector<uint8_t> data;
+    ByteView data;  // Points into the parser's file mapping
     bool is_executable;
     bool is_writable;
     bool is_readable;
@@ -60,6 +65,7 @@ struct ElfInfo {
     std::vector<Symbol> symbols;
     std::vector<Import> imports;
     std::vector<Export> exports;
+    std::vector<std::string> libraries;  // DT_NEEDED entries, in load order
     std::map<std::string, std::string> metadata;
 };
 
@@ -68,28 +74,42 @@ public:
     ElfParser();
     ~ElfParser() = default;
 
-    // Main parsing functions
+    ElfParser(const ElfParser&) = delete;
+    ElfParser& operator=(const ElfParser&) = delete;
+
+    // Main parsing functions. Section views handed out below point into a
+    // single read-only mapping and are invalidated by the next load_file().
     bool load_file(const std::string& filename);
-    ElfInfo get_elf_info() const;
+    const ElfInfo& get_elf_info() const;
     
     // Section operations
-    std::vector<Section> get_sections() const;
+    const std::vector<Section>& get_sections() const;
     Section get_section(const std::string& name) const;
     std::vector<uint8_t> get_section_data(const std::string& name) const;
+    ByteView get_section_view(const std::string& name) const;
     bool has_section(const std::string& name) const;
     
-    // Symbol operations
-    std::vector<Symbol> get_symbols() const;
+    // Raw file access
+    ByteView get_file_view() const;
+    ByteView get_file_range(uint64_t file_offset, uint64_t size) const;
+    std::string_view get_string_at(uint64_t file_offset) const;
+    
+    // Symbol operations. get_symbols() is sorted by address; lookups by
+    // address or name are binary searches over it.
+    const std::vector<Symbol>& get_symbols() const;
     std::vector<Symbol> get_functions() const;
     Symbol find_symbol(const std::string& name) const;
     Symbol find_symbol_by_address(uint64_t address) const;
     std::string get_function_name(uint64_t address) const;
     
     // Import/Export operations
-    std::vector<Import> get_imports() const;
-    std::vector<Export> get_exports() const;
+    const std::vector<Import>& get_imports() const;
+    const std::vector<Export>& get_exports() const;
     
-    // Memory mapping
+    // Memory mapping through the PT_LOAD segments; ~0 when no segment
+    // covers the address. A segment is taken to start at its page, the
+    // way the loader maps it, so a mapping's page-aligned file offset from
+    // /proc/<pid>/maps translates too.
     uint64_t virtual_to_file_offset(uint64_t virtual_address) const;
     uint64_t file_to_virtual_offset(uint64_t file_offset) const;
     
@@ -102,6 +122,7 @@ public:
     bool is_valid_elf() const;
     std::string get_last_error() const;
     std::vector<uint8_t> get_code_section_data() const;
+    ByteView get_code_section_view() const;
     uint64_t get_entry_point() const;
     
     // Static analysis helpers
@@ -113,25 +134,70 @@ private:
     // ELFIO::elfio elf_reader;  // Commented out for now
     std::string filename;
     std::string last_error;
+    MappedFile file;
     bool loaded;
     ElfInfo cached_info;
     bool info_cached;
     
+    // Raw section header fields that Section does not carry
+    struct SectionHeader {
+        uint32_t name;
+        uint32_t type;
+        uint64_t flags;
+        uint64_t address;
+        uint64_t offset;
+        uint64_t size;
+        uint32_t link;
+        uint32_t info;
+        uint64_t entry_size;
+    };
+    
+    struct LoadSegment {
+        uint64_t offset;
+        uint64_t address;
+        uint64_t file_size;
+        uint32_t flags;
+    };
+    
+    struct RawSymbol {
+        uint32_t name;
+        uint8_t info;
+        uint8_t other;
+        uint16_t section_index;
+        uint64_t value;
+        uint64_t size;
+    };
+    
+    StringPool strings;
+    std::vector<SectionHeader> section_headers;
+    std::vector<LoadSegment> load_segments;
+    std::vector<uint32_t> symbols_by_name;  // indices into cached_info.symbols
+    
     // Helper functions
     void parse_sections();
     void parse_symbols();
+    void parse_symbol_table(size_t section_index, bool is_dynamic);
+    void parse_dynamic();
     void parse_imports_exports();
+    void build_symbol_index();
+    bool read_symbol(const SectionHeader& table, size_t index, RawSymbol& symbol) const;
+    std::string_view read_string(size_t strtab_index, uint32_t offset) const;
+    int find_section_index(const std::string& name) const;
+    std::string_view get_section_name(uint16_t section_index);
     void cache_elf_info();
     void parse_program_headers();
     void read_code_segment(uint64_t file_offset, uint64_t vaddr, uint64_t size);
+    uint16_t read_u16(uint64_t offset) const;
+    uint32_t read_u32(uint64_t offset) const;
+    uint64_t read_u64(uint64_t offset) const;
     std::string get_section_type_string(uint32_t type) const;
     std::string get_section_flags_string(uint64_t flags) const;
-    std::string get_symbol_type_string(unsigned char type) const;
-    std::string get_symbol_binding_string(unsigned char binding) const;
+    std::string_view get_symbol_type_string(unsigned char type) const;
+    std::string_view get_symbol_binding_string(unsigned char binding) const;
     Architecture elf_machine_to_architecture(uint16_t machine) const;
-    bool is_section_executable(uint32_t flags) const;
-    bool is_section_writable(uint32_t flags) const;
-    bool is_section_readable(uint32_t flags) const;
+    bool is_section_executable(uint64_t flags) const;
+    bool is_section_writable(uint64_t flags) const;
+    bool is_section_readable(uint64_t flags) const;
 };
 
 } // namespace debugger 
\ No newline at end of file
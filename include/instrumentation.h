@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace debugger {
+namespace perf {
+
+// Hot-path timers and counters. Each thread accumulates into its own block
+// of per-probe totals, written only by that thread with plain relaxed
+// stores, so recording never takes a lock or an atomic read-modify-write;
+// readers sum the blocks. Timers also leave their spans in a per-thread
+// ring that export_chrome_trace() writes out.
+//
+// The PERF_* macros below compile to nothing unless the build defines
+// DEBUGGER_INSTRUMENTATION (cmake -DENABLE_INSTRUMENTATION=ON). The
+// functions stay available either way, so views need no #ifdefs.
+
+enum class ProbeKind : uint8_t {
+    TIMER,    // durations in nanoseconds
+    COUNTER   // summed values
+};
+
+struct ProbeStats {
+    std::string name;
+    std::string category;
+    ProbeKind kind;
+    uint64_t count;     // TIMER: spans recorded; COUNTER: additions
+    uint64_t total;     // TIMER: nanoseconds; COUNTER: sum of the values
+    uint64_t max;       // TIMER: longest span in nanoseconds
+};
+
+constexpr bool is_compiled_in() {
+#ifdef DEBUGGER_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline uint64_t now_ns() {
+    // steady_clock is CLOCK_MONOTONIC, the clock TraceEvent stamps stops with
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Returns the id of the probe with this name, creating it on first use.
+// Ids are stable for the life of the process; past the probe limit every
+// new name shares one overflow probe.
+uint32_t register_probe(const std::string& name, const char* category, ProbeKind kind);
+
+void record_time(uint32_t probe, uint64_t start_ns, uint64_t duration_ns);
+void add_count(uint32_t probe, uint64_t value);
+// Names the calling thread in exported traces
+void set_thread_name(const std::string& name);
+
+// Totals since the start or the last reset(), in registration order
+std::vector<ProbeStats> snapshot();
+// Also clears maxima; a span being recorded at that moment may keep its old one
+void reset();
+
+// Writes the recent spans of every thread in the Chrome trace event format
+// (chrome://tracing, Perfetto). Returns false with error set on failure.
+bool export_chrome_trace(const std::string& path, std::string& error);
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(uint32_t probe) : probe(probe), start(now_ns()) {}
+    ~ScopedTimer() { record_time(probe, start, now_ns() - start); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    uint32_t probe;
+    uint64_t start;
+};
+
+} // namespace perf
+} // namespace debugger
+
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+
+#ifdef DEBUGGER_INSTRUMENTATION
+// Times the rest of the enclosing scope
+#define PERF_SCOPE(name, category)                                                              \
+    static const uint32_t PERF_CONCAT(perf_probe_, __LINE__) =                                  \
+        ::debugger::perf::register_probe(name, category, ::debugger::perf::ProbeKind::TIMER);   \
+    ::debugger::perf::ScopedTimer PERF_CONCAT(perf_timer_, __LINE__)(PERF_CONCAT(perf_probe_, __LINE__))
+// Times the rest of the scope against a probe id looked up elsewhere
+#define PERF_SCOPE_PROBE(probe) ::debugger::perf::ScopedTimer PERF_CONCAT(perf_timer_, __LINE__)(probe)
+#define PERF_COUNT(name, category, value)                                                          \
+    do {                                                                                           \
+        static const uint32_t perf_probe =                                                         \
+            ::debugger::perf::register_probe(name, category, ::debugger::perf::ProbeKind::COUNTER); \
+        ::debugger::perf::add_count(perf_probe, value);                                            \
+    } while (0)
+// Records a span that started elsewhere (another thread, an earlier event)
+#define PERF_RECORD_SINCE(name, category, start_ns)                                                \
+    do {                                                                                           \
+        static const uint32_t perf_probe =                                                         \
+            ::debugger::perf::register_probe(name, category, ::debugger::perf::ProbeKind::TIMER);  \
+        uint64_t perf_start = (start_ns);                                                          \
+        ::debugger::perf::record_time(perf_probe, perf_start, ::debugger::perf::now_ns() - perf_start); \
+    } while (0)
+#define PERF_THREAD_NAME(name) ::debugger::perf::set_thread_name(name)
+#else
+#define PERF_SCOPE(name, category) ((void)0)
+#define PERF_SCOPE_PROBE(probe) ((void)0)
+#define PERF_COUNT(name, category, value) ((void)0)
+#define PERF_RECORD_SINCE(name, category, start_ns) ((void)0)
+#define PERF_THREAD_NAME(name) ((void)0)
+#endif
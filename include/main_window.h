@@ -1,6 +1,12 @@
 #pragma once
 
 #include <QtWidgets/QMainWindow>
+#include <QtWidgets/QAction>
+#include <QtWidgets/QAbstractScrollArea>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QStyledItemDelegate>
 #include <QtWidgets/QTextEdit>
 #include <QtWidgets/QTreeWidget>
 #include <QtWidgets/QTableWidget>
@@ -8,31 +14,67 @@
 #include <QtWidgets/QSplitter>
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QLineEdit>
 #include <QtWidgets/QHeaderView>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QSpinBox>
 #include <QtGui/QTextCharFormat>
+#include <QtCore/QAbstractTableModel>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QTimer>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <functional>
 #include <memory>
 #include <map>
+#include <thread>
+#include <unordered_map>
 
+#include "analysis_pipeline.h"
 #include "disassembler.h"
 #include "decompiler.h"
 #include "debugger_engine.h"
 #include "elf_parser.h"
+#include "search_engine.h"
+#include "string_scanner.h"
+#include "symbol_table.h"
+#include "thread_pool.h"
+#include "xref_index.h"
 
 namespace debugger {
 
 // Forward declaration
 class LineNumberArea;
 
-class DisassemblyView : public QTextEdit {
+// Virtualized listing: rows are formatted and highlighted on demand straight
+// from the instruction buffer, so only the visible rows ever become text
+class DisassemblyView : public QAbstractScrollArea {
     Q_OBJECT
 public:
     explicit DisassemblyView(QWidget* parent = nullptr);
     
     void set_instructions(const std::vector<Instruction>& instructions);
+    void set_instructions(std::shared_ptr<const DisassemblyBuffer> instructions);
+    void set_xref_index(std::shared_ptr<const XrefIndex> index);
+    
+    // Incremental loading: begin with a (possibly still growing) buffer, append
+    // rows as batches arrive, then finish to update the header. Finishing with
+    // final_instructions swaps in a buffer holding the same rows, keeping the
+    // scroll position.
+    void begin_instructions(std::shared_ptr<const DisassemblyBuffer> instructions);
+    void append_instructions(size_t first, size_t count);
+    void end_instructions(std::shared_ptr<const DisassemblyBuffer> final_instructions = nullptr);
     void highlight_instruction(uint64_t address);
     void clear_highlight();
-    void clear() { QTextEdit::clear(); }
+    // Profile heat: rows are tinted by their share of the hottest address
+    // and annotated with their share of all samples
+    void set_heat(std::unordered_map<uint64_t, uint64_t> address_samples, uint64_t total_samples);
+    void clear_heat();
+    void clear();
+    
+    // Case-insensitive search from the row after the current one, wrapping around
+    bool find_text(const QString& text);
     
     // Line number area support
     void line_number_area_paint_event(QPaintEvent* event);
@@ -44,8 +86,12 @@ signals:
     void go_to_address_requested();
 
 protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
     void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
     void contextMenuEvent(QContextMenuEvent* event) override;
+    void changeEvent(QEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
 
 private slots:
@@ -54,18 +100,30 @@ private slots:
 
 private:
     void setup_syntax_highlighting();
-    void apply_syntax_highlighting();
-    void apply_format_to_matches(QTextCursor& cursor, const QString& text, 
-                               const QRegularExpression& regex, 
-                               const QTextCharFormat& format);
+    void update_scroll_range();
+    void draw_row(QPainter& painter, int row, int y, int x);
+    void scroll_to_row(int row);
     
-    std::vector<Instruction> current_instructions;
-    uint64_t highlighted_address;
-    int current_line;
+    int row_count() const;
+    int visible_row_count() const;
+    int row_at(const QPoint& pos) const;
+    int address_to_line(uint64_t address) const;      // -1 if not shown
+    bool line_to_address(int line, uint64_t& address) const;
+    QString format_row(int row) const;
+    QString format_header_line(int row) const;
+    QString format_instruction_line(const PackedInstruction& insn) const;
     
-    // Address-to-line mapping for fast navigation
-    std::map<uint64_t, int> address_to_line;
-    std::map<int, uint64_t> line_to_address;
+    std::shared_ptr<const DisassemblyBuffer> current_instructions;
+    std::shared_ptr<const XrefIndex> xref_index;
+    size_t loaded_count;   // rows appended so far; the buffer may be further ahead
+    bool loading;
+    uint64_t highlighted_address;
+    std::unordered_map<uint64_t, uint64_t> heat;  // address -> samples
+    uint64_t heat_total;
+    uint64_t heat_max;
+    int current_line;      // selected row, -1 for none
+    int row_height;
+    int char_width;
     
     // Line number area
     LineNumberArea* line_number_area;
@@ -93,14 +151,19 @@ private:
 };
 
 // Forward declaration for syntax highlighter
-class CppSyntaxHighlighter;
+class TokenHighlighter;
 
+// Shows one function at a time. Once given a source, functions are
+// decompiled on demand: the one in focus first, then its callees in the
+// background so following a call is a cache hit.
 class DecompilerView : public QTextEdit {
     Q_OBJECT
 public:
     explicit DecompilerView(QWidget* parent = nullptr);
     
     void set_decompiled_code(const std::string& code);
+    // Highlighted from the function's token stream
+    void set_decompiled_function(std::shared_ptr<const DecompiledFunction> function);
     void clear_code();
     void setup_syntax_highlighting();
     void append_decompiled_function(const std::string& function_code);
@@ -109,6 +172,14 @@ public:
     void add_analysis_comment(const std::string& comment);
     QString get_selected_text();
     void find_text(const QString& text);
+    
+    // Lazy decompilation. functions must be sorted by start address.
+    void set_source(std::shared_ptr<const Decompiler> decompiler, std::shared_ptr<DecompilationCache> cache,
+                    std::shared_ptr<const std::vector<Function>> functions,
+                    std::shared_ptr<const DisassemblyBuffer> instructions, ThreadPool* pool);
+    void clear_source();
+    // Shows the function starting at address; returns false if none does
+    bool show_function(uint64_t address);
 
 signals:
     void function_analysis_requested();
@@ -118,14 +189,101 @@ protected:
     void contextMenuEvent(QContextMenuEvent* event) override;
 
 private:
-    CppSyntaxHighlighter* syntax_highlighter;
+    TokenHighlighter* syntax_highlighter;
+    
+    std::shared_ptr<const Decompiler> decompiler;
+    std::shared_ptr<DecompilationCache> cache;
+    std::shared_ptr<const std::vector<Function>> functions;
+    std::shared_ptr<const DisassemblyBuffer> instructions;
+    ThreadPool* pool;
+    // Bumped on every focus change; background work for an older focus
+    // is dropped, and prefetches not yet started are skipped
+    std::shared_ptr<std::atomic<uint64_t>> focus_generation;
+    
+    const Function* find_function(uint64_t address) const;
+    void prefetch_callees(const Function& function, uint64_t generation);
+};
+
+// Reads tracee memory into buffer and returns the number of bytes read
+using MemoryReader = std::function<size_t(uint64_t address, uint8_t* buffer, size_t size)>;
+
+// Hex table over a window of tracee memory. Pages are fetched through the
+// reader the first time a row is displayed; refresh() re-reads only the pages
+// under the visible rows, diffs them against the previous snapshot and
+// reports just the rows whose bytes changed. Changed bytes stay highlighted
+// until the next refresh.
+class MemoryModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    static constexpr int BYTES_PER_ROW = 16;
+    static constexpr int ASCII_COLUMN = BYTES_PER_ROW + 1;
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    
+    explicit MemoryModel(QObject* parent = nullptr);
+    
+    void set_reader(MemoryReader reader);
+    void set_window(uint64_t address, uint64_t size);
+    // Static data instead of a reader; a snapshot at the same address is diffed
+    void set_snapshot(uint64_t address, const std::vector<uint8_t>& data);
+    void refresh(int first_row, int last_row);
+    void set_highlight_range(uint64_t start_addr, uint64_t end_addr);
+    
+    uint64_t get_base_address() const;
+    uint64_t get_window_size() const;
+    bool contains(uint64_t address) const;
+    uint64_t address_at(const QModelIndex& index) const;
+    QModelIndex index_of(uint64_t address) const;
+    bool read_byte(uint64_t address, uint8_t& value) const;
+    
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+
+signals:
+    void byte_edited(uint64_t address, uint8_t value);
+
+private:
+    struct Page {
+        std::array<uint8_t, PAGE_SIZE> bytes;
+        std::bitset<PAGE_SIZE> changed;  // differs from the previous refresh
+        std::bitset<PAGE_SIZE> edited;   // written from the view
+        uint32_t valid_bytes;            // readable prefix
+    };
+    
+    MemoryReader reader;
+    std::vector<uint8_t> snapshot;
+    uint64_t snapshot_address;
+    uint64_t base_address;
+    uint64_t window_size;
+    uint64_t highlight_start;  // inclusive; empty when end < start
+    uint64_t highlight_end;
+    mutable std::unordered_map<uint64_t, Page> pages;
+    
+    Page* find_page(uint64_t address) const;  // fetches on first use
+    size_t fetch(uint64_t address, uint8_t* buffer, size_t size) const;
+    QString format_ascii(int row) const;
+    void emit_rows_changed(const std::vector<int>& rows);
+};
+
+// Two-digit hex editor for byte cells
+class HexByteDelegate : public QStyledItemDelegate {
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option,
+                          const QModelIndex& index) const override;
 };
 
-class MemoryView : public QTableWidget {
+class MemoryView : public QTableView {
     Q_OBJECT
 public:
     explicit MemoryView(QWidget* parent = nullptr);
     
+    void set_memory_reader(MemoryReader reader);
+    void set_memory_window(uint64_t address, uint64_t size);
+    bool is_address_in_window(uint64_t address) const;
     void set_memory_data(uint64_t address, const std::vector<uint8_t>& data);
     void refresh_memory(uint64_t address, size_t size);
     void update_display();
@@ -142,16 +300,13 @@ protected:
     void contextMenuEvent(QContextMenuEvent* event) override;
 
 private slots:
-    void on_item_changed(QTableWidgetItem* item);
     void show_go_to_dialog();
 
 private:
     void setup_table();
-    void update_ascii_for_row(int row);
     
-    uint64_t base_address;
-    std::vector<uint8_t> memory_data;
-    int bytes_per_row;
+    MemoryModel* memory_model;
+    bool has_reader;
     QFont mono_font;
 };
 
@@ -194,6 +349,7 @@ public:
 signals:
     void breakpoint_toggle_requested(uint64_t address);
     void breakpoint_remove_requested(uint64_t address);
+    void breakpoint_condition_requested(uint64_t address, const QString& condition);
     void navigate_to_address_requested(uint64_t address);
 
 protected:
@@ -204,6 +360,140 @@ private:
     std::vector<Breakpoint> current_breakpoints;
 };
 
+// Sampling profiler controls and the per-function table of the last profile
+class ProfilerView : public QWidget {
+    Q_OBJECT
+public:
+    explicit ProfilerView(QWidget* parent = nullptr);
+    
+    void set_profile(const ProfileSummary& profile);
+    void set_profiling(bool active);
+    void clear();
+
+signals:
+    void profiling_toggled(bool enabled, unsigned frequency_hz);
+    void export_requested();
+    void navigate_to_address_requested(uint64_t address);
+
+private:
+    QPushButton* toggle_button;
+    QSpinBox* frequency_box;
+    QPushButton* export_button;
+    QLabel* status_label;
+    QTableWidget* functions_table;
+    bool profiling;
+};
+
+// Timers and counters from the instrumentation layer, refreshed while shown
+class PerformanceView : public QWidget {
+    Q_OBJECT
+public:
+    explicit PerformanceView(QWidget* parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    QPushButton* reset_button;
+    QPushButton* export_button;
+    QLabel* summary_label;
+    QTableWidget* probes_table;
+    QTimer* refresh_timer;
+    uint64_t last_refresh_ns;
+    std::unordered_map<std::string, uint64_t> last_counts;  // Per probe, for the rates
+    
+    void refresh();
+    void export_trace();
+};
+
+// Hits of one search; rows are appended as batches stream in and their
+// text is only produced for the rows on screen
+class SearchResultsModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    explicit SearchResultsModel(QObject* parent = nullptr);
+    
+    void reset(SearchKind kind, std::shared_ptr<const SearchEngine> engine);
+    void append_hits(const std::vector<SearchHit>& hits);
+    const SearchHit* hit_at(int row) const;
+    
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    SearchKind kind;
+    std::shared_ptr<const SearchEngine> engine;
+    std::vector<SearchHit> hits;
+};
+
+// Byte pattern, instruction and string search over the loaded binary.
+// Each search runs on its own thread, fanned out over the pool, and streams
+// hits into the table as chunks finish.
+class SearchView : public QWidget {
+    Q_OBJECT
+public:
+    explicit SearchView(QWidget* parent = nullptr);
+    ~SearchView() override;
+    
+    void set_thread_pool(ThreadPool* pool);
+    void set_image(std::shared_ptr<const ElfParser> parser);
+    void set_instructions(std::shared_ptr<const DisassemblyBuffer> instructions);
+    void set_strings(std::shared_ptr<const std::vector<SectionStrings>> strings);
+    // Stops any search and forgets the binary
+    void clear();
+    void focus_query(const QString& text = QString());
+
+signals:
+    void navigate_to_address_requested(uint64_t address);
+
+private:
+    QComboBox* kind_box;
+    QLineEdit* query_edit;
+    QCheckBox* case_box;
+    QPushButton* search_button;
+    QLabel* status_label;
+    QTableView* results_table;
+    SearchResultsModel* results_model;
+    
+    SearchEngine engine;
+    ThreadPool* pool;
+    std::thread search_thread;
+    std::atomic<bool> cancel_requested;
+    uint64_t current_search;  // GUI thread; stale notifications are dropped
+    bool searching;
+    
+    void start_search();
+    void stop_search();
+    void set_searching(bool active);
+};
+
+// Every scanned string, one row per record across all sections. Only the
+// records are held; a row's text is decoded from the mapped file when it
+// is drawn, so large binaries and core files load instantly.
+class StringsModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    explicit StringsModel(QObject* parent = nullptr);
+    
+    void reset(std::shared_ptr<const ElfParser> parser, std::shared_ptr<const std::vector<SectionStrings>> strings);
+    void clear();
+    
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    std::shared_ptr<const ElfParser> parser;  // Keeps the mapping the records point into alive
+    std::shared_ptr<const std::vector<SectionStrings>> strings;
+    std::vector<size_t> section_rows;         // First row of each section, then the total
+    
+    const StringRecord* record_at(int row, const SectionStrings** section) const;
+};
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
@@ -235,18 +525,36 @@ private slots:
     void on_action_go_to_address_triggered();
     void on_action_find_triggered();
     void on_action_toggle_breakpoint_triggered();
+    void on_action_add_watchpoint_triggered();
     
     // Analysis actions
     void on_action_analyze_functions_triggered();
     void on_action_show_strings_triggered();
     void on_action_show_imports_triggered();
     void on_action_show_exports_triggered();
+    void on_action_cancel_analysis_triggered();
+    
+    // Analysis pipeline
+    void on_analysis_stage_started(AnalysisStage stage);
+    void on_analysis_stage_progress(AnalysisStage stage, int percent);
+    void on_analysis_stage_finished(AnalysisStage stage);
+    void on_instructions_decoded(std::shared_ptr<const DisassemblyBuffer> batch);
+    void on_analysis_failed(const QString& message);
+    void on_analysis_finished(bool cancelled);
     
     // Internal slots
     void update_debug_state();
     void on_breakpoint_hit(uint64_t address);
+    void on_watchpoint_hit(uint64_t address, uint64_t pc);
+    void on_process_stopped(uint64_t address);
+    void on_process_signaled(int signal);
+    void on_process_exited(int status);
+    void on_breakpoint_condition_requested(uint64_t address, const QString& condition);
     void on_function_selected(uint64_t address);
     void on_address_double_clicked(uint64_t address);
+    void on_profiling_toggled(bool enabled, unsigned frequency_hz);
+    void on_profile_export_requested();
+    void refresh_profile();
     void refresh_views();
 
 private:
@@ -276,6 +584,7 @@ private:
     
     void populate_functions_tree();
     void populate_symbols_tree();
+    void filter_symbols_tree();
     void populate_sections_table();
     void populate_strings_view();
     void update_strings_view(const std::vector<std::string>& strings);
@@ -284,7 +593,13 @@ private:
     std::unique_ptr<Disassembler> disassembler;
     std::unique_ptr<Decompiler> decompiler;
     std::unique_ptr<DebuggerEngine> debugger_engine;
-    std::unique_ptr<ElfParser> elf_parser;
+    std::shared_ptr<const ElfParser> elf_parser;                // Published by the pipeline's load stage
+    std::shared_ptr<const DisassemblyBuffer> code_disassembly;  // Shared with disassembly_view
+    std::shared_ptr<DisassemblyBuffer> streamed_disassembly;    // Rows received before disassembly finished
+    std::unique_ptr<ThreadPool> thread_pool;                    // Background analysis workers
+    std::shared_ptr<const XrefIndex> xref_index;                // Built once per loaded binary
+    std::unique_ptr<SymbolTable> symbol_table;                  // Backs the symbols filter
+    AnalysisPipeline* analysis_pipeline;
     
     // UI Components
     QTabWidget* left_tabs;
@@ -295,8 +610,11 @@ private:
     // Left panel
     QTreeWidget* functions_tree;
     QTreeWidget* symbols_tree;
+    QLineEdit* symbols_filter;
+    QTimer* symbols_filter_timer;  // Coalesces keystrokes into one search
     QTableWidget* sections_table;
-    QTextEdit* strings_view;
+    QTableView* strings_view;
+    StringsModel* strings_model;
     
     // Center panel
     DisassemblyView* disassembly_view;
@@ -304,9 +622,13 @@ private:
     
     // Right panel
     RegistersView* registers_view;
+    PerformanceView* performance_view;
     MemoryView* memory_view;
     BreakpointView* breakpoint_view;
+    ProfilerView* profiler_view;
+    SearchView* search_view;
     QTextEdit* log_view;
+    QTimer* profile_refresh_timer;  // Runs while a profile is being taken
     
     // Debug controls
     QPushButton* continue_button;
@@ -319,6 +641,8 @@ private:
     QLabel* status_label;
     QLabel* architecture_label;
     QLabel* debug_state_label;
+    QProgressBar* analysis_progress;
+    QAction* cancel_analysis_action;
     
     // State
     QString current_filename;
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace debugger {
+
+// Non-owning view over a run of bytes, typically a slice of a MappedFile.
+// Views stay valid only as long as the mapping they point into.
+struct ByteView {
+    const uint8_t* ptr = nullptr;
+    size_t length = 0;
+
+    ByteView() = default;
+    ByteView(const uint8_t* ptr, size_t length) : ptr(ptr), length(length) {}
+
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    const uint8_t* begin() const { return ptr; }
+    const uint8_t* end() const { return ptr + length; }
+    uint8_t operator[](size_t index) const { return ptr[index]; }
+
+    // Clamped to the view, so out-of-range requests yield an empty view
+    ByteView subview(size_t offset, size_t count) const {
+        if (offset >= length) return ByteView();
+        return ByteView(ptr + offset, count < length - offset ? count : length - offset);
+    }
+
+    std::string_view as_string_view() const {
+        return std::string_view(reinterpret_cast<const char*>(ptr), length);
+    }
+};
+
+// Read-only private mapping of a whole file
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const;
+
+    ByteView view() const;
+    ByteView view(uint64_t offset, uint64_t size) const;
+    size_t size() const;
+    std::string get_last_error() const;
+
+private:
+    const uint8_t* mapping;
+    size_t mapping_size;
+    std::string last_error;
+};
+
+} // namespace debugger 
\ No newline at end of file
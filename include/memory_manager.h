@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <sys/types.h>
+
+namespace debugger {
+
+// Mechanism used to move bytes in and out of the tracee, fastest first
+enum class MemoryTransport {
+    PROCESS_VM,  // process_vm_readv / process_vm_writev
+    PROC_MEM,    // pread / pwrite on /proc/<pid>/mem
+    PTRACE       // PTRACE_PEEKDATA / PTRACE_POKEDATA, one word per syscall
+};
+
+class MemoryManager {
+public:
+    MemoryManager();
+    ~MemoryManager();
+
+    MemoryManager(const MemoryManager&) = delete;
+    MemoryManager& operator=(const MemoryManager&) = delete;
+
+    // Target binding
+    void attach(pid_t pid);
+    void detach();
+    bool is_attached() const;
+
+    // Bulk transfers straight to/from caller-owned storage. read() returns the
+    // number of bytes copied, which is short when the range runs into an
+    // unmapped page; write() succeeds only if every byte was written.
+    size_t read(uint64_t address, uint8_t* buffer, size_t size);
+    bool write(uint64_t address, const uint8_t* data, size_t size);
+    // For patching instructions: text is mapped read-only, which
+    // process_vm_writev refuses, so this starts at /proc/<pid>/mem
+    bool write_code(uint64_t address, const uint8_t* data, size_t size);
+
+    // Diagnostics
+    MemoryTransport get_read_transport() const;
+    MemoryTransport get_write_transport() const;
+    std::string get_transport_name(MemoryTransport transport) const;
+
+private:
+    pid_t target_pid;
+    int proc_mem_fd;
+    bool process_vm_read_available;
+    bool process_vm_write_available;
+    bool proc_mem_available;
+    bool proc_mem_writable;
+
+    // Transport implementations; each returns bytes transferred from the start
+    size_t read_process_vm(uint64_t address, uint8_t* buffer, size_t size);
+    size_t read_proc_mem(uint64_t address, uint8_t* buffer, size_t size);
+    size_t read_ptrace(uint64_t address, uint8_t* buffer, size_t size);
+    size_t write_process_vm(uint64_t address, const uint8_t* data, size_t size);
+    size_t write_proc_mem(uint64_t address, const uint8_t* data, size_t size);
+    size_t write_ptrace(uint64_t address, const uint8_t* data, size_t size);
+
+    bool open_proc_mem();
+    void close_proc_mem();
+};
+
+struct MemoryCacheStats {
+    uint64_t hits;         // pages served from the cache
+    uint64_t misses;       // pages that had to be fetched from the tracee
+    uint64_t transfers;    // transport calls issued to fill misses
+    uint64_t bytes_fetched;
+    uint64_t invalidations;
+    uint64_t evictions;    // pages dropped to stay within max_pages
+    size_t cached_pages;
+};
+
+// Page-granular cache of tracee memory, valid for one stop. Calling
+// invalidate() when the tracee resumes bumps the epoch, which retires every
+// cached page at once without touching them. Once max_pages is reached the
+// least recently used pages are evicted, whichever stop they belong to.
+class MemoryCache {
+public:
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    // Larger reads are bulk dumps that are rarely repeated; callers should
+    // send them straight to the transport rather than through the cache
+    static constexpr size_t MAX_CACHED_READ = 4 * PAGE_SIZE;
+
+    explicit MemoryCache(MemoryManager& transport, size_t max_pages = 4096);
+
+    size_t read(uint64_t address, uint8_t* buffer, size_t size);
+    // Serves the read only if every page it needs is already cached for
+    // this stop, never touching the transport; false leaves it to read()
+    bool read_cached(uint64_t address, uint8_t* buffer, size_t size, size_t& copied);
+    bool write(uint64_t address, const uint8_t* data, size_t size);
+    void invalidate();
+    void clear();
+
+    MemoryCacheStats get_stats() const;
+    void reset_stats();
+
+private:
+    struct Page {
+        uint64_t epoch;
+        uint32_t valid_bytes;  // readable prefix of the page for this epoch
+        uint64_t last_use;     // use_clock of the last read that touched it
+        std::array<uint8_t, PAGE_SIZE> bytes;
+    };
+
+    MemoryManager& transport;
+    std::unordered_map<uint64_t, Page> pages;
+    std::vector<uint8_t> fill_buffer;
+    size_t max_pages;
+    uint64_t current_epoch;
+    uint64_t use_clock;    // bumped once per read
+    MemoryCacheStats stats;
+
+    Page* find_fresh_page(uint64_t page_address);
+    void make_room(size_t page_count);
+    void fill_pages(uint64_t first_page, size_t page_count);
+    void store_page(uint64_t page_address, const uint8_t* data, size_t valid_bytes);
+    size_t copy_out(uint64_t address, uint8_t* buffer, size_t size);
+};
+
+} // namespace debugger 
\ No newline at end of file
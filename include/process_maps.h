@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sys/types.h>
+
+namespace debugger {
+
+class ElfParser;
+
+// One line of /proc/<pid>/maps
+struct MapEntry {
+    uint64_t start;
+    uint64_t end;
+    uint64_t offset;       // file offset of start
+    char permissions[5];   // "r-xp"
+    uint32_t module;       // index into get_modules(), or ProcessMaps::NO_MODULE
+    std::string path;      // file, [heap], [stack]..., empty for anonymous
+};
+
+// A file with at least one executable mapping, spanning all of its mappings
+struct LoadedModule {
+    std::string path;
+    uint64_t start;
+    uint64_t end;
+    uint64_t first_mapping;  // lowest mapping and its file offset, for the bias
+    uint64_t first_offset;
+    uint64_t bias;  // runtime address minus link-time address; valid once elf is set
+    std::shared_ptr<const ElfParser> elf;  // parsed on the first lookup that lands here
+};
+
+// Sorted interval index over the target's mappings, and the modules among
+// them. /proc/<pid>/maps is only reread when something says it may have
+// changed: the dynamic linker's r_brk hook firing, an exec, a lookup that
+// missed every module, or (for the region list, which anonymous mmaps can
+// change at any time) the target having run since the last read. Parsed
+// ELF images are kept by path and reused until the file itself changes.
+//
+// Not thread-safe; the engine and the unwinder use it on the tracer thread.
+class ProcessMaps {
+public:
+    static constexpr uint32_t NO_MODULE = ~0u;
+
+    ProcessMaps();
+    ~ProcessMaps();
+
+    ProcessMaps(const ProcessMaps&) = delete;
+    ProcessMaps& operator=(const ProcessMaps&) = delete;
+
+    void attach(pid_t pid);
+    void detach();
+    bool refresh();
+    // Libraries were (un)loaded or the image replaced
+    void invalidate_modules();
+    // The target ran; anonymous mappings may have come and gone
+    void invalidate_regions();
+    // Bumped whenever a refresh changes the set of modules
+    uint64_t get_generation() const;
+
+    const std::vector<MapEntry>& get_regions();
+    const std::vector<LoadedModule>& get_modules();
+    const MapEntry* find_region(uint64_t address);
+    // Rereads the maps when address is outside every known module, at most
+    // once per run of the target or every quarter second while it runs
+    const LoadedModule* find_module(uint64_t address);
+
+    // "" when no symbol covers the address
+    std::string get_function_name(uint64_t address);
+    // Runtime address of a symbol, searched in the main executable first;
+    // "libc.so.6!malloc" restricts the search to modules with that file name
+    uint64_t resolve_symbol(const std::string& name);
+
+private:
+    struct CachedImage {
+        dev_t device;
+        ino_t inode;
+        time_t modified;
+        bool parsed;
+        std::shared_ptr<const ElfParser> elf;  // null when the file isn't a loadable ELF
+    };
+
+    pid_t target_pid;
+    bool modules_stale;
+    bool regions_stale;
+    uint64_t generation;
+    std::chrono::steady_clock::time_point last_refresh;
+    std::string executable_path;
+    std::vector<MapEntry> regions;       // sorted by start
+    std::vector<LoadedModule> modules;   // sorted by start
+    std::unordered_map<std::string, CachedImage> images;
+
+    void ensure_current(bool need_regions);
+    bool load_module(size_t index);
+    const LoadedModule* lookup_module(uint64_t address) const;
+};
+
+} // namespace debugger 
\ No newline at end of file
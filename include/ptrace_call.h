@@ -0,0 +1,29 @@
+#pragma once
+
+#include "instrumentation.h"
+#include <cerrno>
+#include <cstdint>
+#include <sys/ptrace.h>
+
+namespace debugger {
+
+// Probe named after the request ("ptrace GETREGSET"), registered on first use
+uint32_t get_ptrace_probe(int request);
+
+// ptrace(2), timed per request when instrumentation is compiled in. errno
+// is left as the call set it.
+template <typename... Args>
+inline long timed_ptrace(__ptrace_request request, Args... args) {
+#ifdef DEBUGGER_INSTRUMENTATION
+    uint64_t start = perf::now_ns();
+    long result = ptrace(request, args...);
+    int saved_errno = errno;
+    perf::record_time(get_ptrace_probe(request), start, perf::now_ns() - start);
+    errno = saved_errno;
+    return result;
+#else
+    return ptrace(request, args...);
+#endif
+}
+
+} // namespace debugger
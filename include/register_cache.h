@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sys/types.h>
+
+struct user_regs_struct;
+
+namespace debugger {
+
+struct Register {
+    std::string name;
+    uint64_t value;
+    size_t size;  // in bytes
+    bool modified;
+};
+
+// Where a named register lives in user_regs_struct. Names match without
+// regard to case; aliases and sub-registers (pc, eax, w0...) have listed
+// unset so they only show up when asked for by name.
+struct RegisterLayout {
+    const char* name;
+    size_t offset;
+    uint8_t width;
+    bool listed;
+};
+
+const RegisterLayout* find_register_layout(const std::string& name);
+
+// Registers of one stopped thread, valid for one stop. The general set is
+// fetched with a single PTRACE_GETREGSET the first time anything asks for
+// it and the floating-point/vector set only when one of those is read.
+// Writes land in the cache and go back with one PTRACE_SETREGSET from
+// flush(), which must happen before the thread resumes.
+//
+// Everything that can issue a ptrace request must run on the tracer thread.
+class RegisterCache {
+public:
+    RegisterCache();
+    ~RegisterCache();
+
+    RegisterCache(const RegisterCache&) = delete;
+    RegisterCache& operator=(const RegisterCache&) = delete;
+
+    bool load(pid_t tid);
+    bool flush();
+    // The tracee is about to run: forget this stop, but keep its values so
+    // the next stop of the same thread can tell what changed
+    void invalidate();
+    void clear();
+
+    bool is_valid() const;
+    bool is_dirty() const;
+    pid_t get_thread() const;
+
+    bool read(const std::string& name, uint64_t& value) const;
+    bool write(const std::string& name, uint64_t value);
+    uint64_t get_program_counter() const;
+    uint64_t get_stack_pointer() const;
+    uint64_t get_frame_pointer() const;
+    // The listed registers, with modified set on those that differ from
+    // this thread's previous stop
+    std::vector<Register> get_registers() const;
+    // The raw snapshot; only meaningful while is_valid()
+    const user_regs_struct& get_general() const;
+
+    // Vector registers (xmm0-15, v0-31) as little-endian bytes; the first
+    // read in a stop fetches NT_PRFPREG
+    bool read_vector(const std::string& name, std::vector<uint8_t>& bytes);
+
+    const std::string& get_last_error() const;
+
+private:
+    pid_t thread;
+    bool valid;
+    bool dirty;
+    bool vector_valid;
+    std::unique_ptr<user_regs_struct> general;
+    std::vector<uint8_t> vector_state;  // NT_PRFPREG image
+    // General registers each thread had at its last stop
+    std::unordered_map<pid_t, std::vector<uint8_t>> previous;
+    std::string last_error;
+
+    uint64_t read_field(size_t offset, uint8_t width) const;
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "stack_unwinder.h"
+#include "tracer.h"
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace debugger {
+
+struct FunctionProfile {
+    std::string name;          // "[unknown]" when no symbol covers it
+    uint64_t hottest_address;  // the pc inside it sampled most often
+    uint64_t self_samples;     // samples with it as the leaf frame
+    uint64_t total_samples;    // samples with it anywhere on the stack
+};
+
+struct ProfileSummary {
+    uint64_t samples;
+    uint64_t lost_samples;
+    SamplingMode mode;
+    LatencyHistogram stop_time;
+    std::vector<FunctionProfile> functions;  // hottest (by self) first
+    std::unordered_map<uint64_t, uint64_t> address_samples;  // leaf pc -> samples
+};
+
+// Maps a pc to the name of the function containing it, "" when unknown
+using Symbolizer = std::function<std::string(uint64_t pc)>;
+
+// Aggregates unwound samples into per-address leaf counts and a table of
+// unique stacks. Samples are stored as raw pcs; names are looked up once
+// per distinct pc by resolve_names(), which has to run while the modules
+// are still mapped, i.e. before the target exits or execs.
+//
+// Not thread-safe; the engine feeds it from the tracer thread.
+class SamplingProfiler {
+public:
+    // Distinct stacks kept; past this only the leaf of new stacks is recorded
+    static constexpr size_t MAX_STACKS = 65536;
+
+    SamplingProfiler();
+
+    void clear();
+    // frames[0] is the leaf
+    void add_sample(const UnwindFrame* frames, size_t count);
+    uint64_t get_sample_count() const;
+
+    // Names every pc seen since the last call
+    void resolve_names(const Symbolizer& symbolize);
+    ProfileSummary summarize() const;
+    // Brendan Gregg's folded format: "root;...;leaf count" per line
+    bool export_folded(const std::string& path) const;
+
+private:
+    struct StackHash {
+        size_t operator()(const std::vector<uint64_t>& stack) const;
+    };
+
+    uint64_t samples;
+    std::unordered_map<uint64_t, uint64_t> address_samples;
+    // Callers are recorded as return address - 1, inside the call itself
+    std::unordered_map<std::vector<uint64_t>, uint64_t, StackHash> stacks;
+    std::unordered_map<uint64_t, std::string> names;
+    std::vector<uint64_t> scratch;  // reused lookup key
+
+    const std::string& get_name(uint64_t pc) const;
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "disassembler.h"
+#include "elf_parser.h"
+#include "string_scanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace debugger {
+
+class ThreadPool;
+
+enum class SearchKind : uint8_t {
+    BYTES,        // hex bytes, "??" for any byte and "?" for any nibble: "48 8b ?? 0?"
+    INSTRUCTION,  // mnemonic, "*" for any, then an operand substring: "call", "* [rip"
+    STRING        // substring of the strings found by analysis
+};
+
+struct SearchQuery {
+    SearchKind kind = SearchKind::BYTES;
+    std::string text;
+    bool case_sensitive = false;  // INSTRUCTION and STRING
+    size_t max_hits = 100000;
+};
+
+struct SearchHit {
+    uint64_t address;      // 0 when the match lies outside every loaded section
+    uint64_t file_offset;
+    uint32_t length;       // bytes
+    uint32_t section;      // BYTES: index in get_sections(); STRING: index in the strings
+    uint64_t index;        // INSTRUCTION: record in the buffer; STRING: record in its section
+};
+
+// Hex pattern with a mask per byte; a zero mask bit matches anything
+class BytePattern {
+public:
+    // Returns false and fills error on malformed input
+    bool parse(const std::string& text, std::string& error);
+
+    size_t size() const { return values.size(); }
+    bool matches(const uint8_t* data) const;
+    // Longest run of fully specified bytes, which candidates are found by
+    size_t get_anchor_offset() const { return anchor_offset; }
+    size_t get_anchor_length() const { return anchor_length; }
+    const uint8_t* get_anchor() const { return values.data() + anchor_offset; }
+
+private:
+    std::vector<uint8_t> values;
+    std::vector<uint8_t> masks;
+    size_t anchor_offset = 0;
+    size_t anchor_length = 0;
+};
+
+// Searches one binary's file image, instruction listing and string index.
+// Sources are shared with the analysis results and never modified, so a
+// copy of the engine can run on a background thread while the GUI keeps
+// the original.
+class SearchEngine {
+public:
+    // Receives hits in address order within each section, a batch at a
+    // time; returning false stops the search
+    using HitCallback = std::function<bool(const std::vector<SearchHit>& hits)>;
+
+    void set_image(std::shared_ptr<const ElfParser> parser);
+    void set_instructions(std::shared_ptr<const DisassemblyBuffer> instructions);
+    void set_strings(std::shared_ptr<const std::vector<SectionStrings>> strings);
+    bool has_source(SearchKind kind) const;
+
+    // Splits the sources into chunks searched across the pool's workers and
+    // delivers each chunk's hits as soon as it and those before it are done.
+    // Blocks until finished or stopped; must not be called from a pool task.
+    // Returns false with error set if the query can't be run.
+    bool search(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits, std::string& error) const;
+
+    // For showing a hit found by a query of that kind
+    std::string get_section_name(SearchKind kind, const SearchHit& hit) const;
+    std::string describe(SearchKind kind, const SearchHit& hit) const;
+
+private:
+    std::shared_ptr<const ElfParser> parser;
+    std::shared_ptr<const DisassemblyBuffer> instructions;
+    std::shared_ptr<const std::vector<SectionStrings>> strings;
+
+    // One unit of work: a slice of a section, the listing or a string table
+    struct Chunk {
+        uint32_t source;
+        size_t begin;
+        size_t end;
+    };
+    using ChunkSearch = std::function<void(const Chunk& chunk, std::vector<SearchHit>& hits)>;
+
+    void run_chunks(const std::vector<Chunk>& chunks, const ChunkSearch& search_chunk, size_t max_hits,
+                    ThreadPool& pool, const HitCallback& on_hits) const;
+    bool search_bytes(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits, std::string& error) const;
+    bool search_instructions(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits, std::string& error) const;
+    bool search_strings(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits, std::string& error) const;
+    const Section* find_section(uint64_t file_offset) const;
+};
+
+// Every start of pattern in [begin, end) of data, in order; matches may run
+// past end but not past size. SSE2 filters candidates 16 at a time on the
+// first and last anchor byte, with a Boyer-Moore-Horspool fallback.
+void find_pattern(const uint8_t* data, size_t size, size_t begin, size_t end,
+                  const BytePattern& pattern, std::vector<size_t>& matches, size_t max_matches);
+
+} // namespace debugger
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <sys/types.h>
+
+struct user_regs_struct;
+
+namespace debugger {
+
+// Stack memory comes through the caller: the memory cache while the target
+// is stopped, the bulk transport for samples of a running one. Returns
+// the number of bytes copied, like MemoryManager::read().
+using StackReader = std::function<size_t(uint64_t address, uint8_t* buffer, size_t size)>;
+
+// Registers an unwind starts from, indexed by DWARF register number
+struct UnwindRegisters {
+#if defined(__aarch64__)
+    static constexpr size_t COUNT = 33;  // x0-x30, sp, pc
+#else
+    static constexpr size_t COUNT = 17;  // rax..r15, return address
+#endif
+    uint64_t pc;
+    uint64_t values[COUNT];
+    uint64_t valid;  // bit n set when values[n] is known
+};
+
+struct UnwindFrame {
+    uint64_t pc;
+    uint64_t stack_pointer;
+    uint64_t frame_pointer;
+    bool from_cfi;  // false when recovered by following the frame-pointer chain
+};
+
+struct UnwinderStats {
+    uint64_t unwinds;
+    uint64_t cfi_frames;
+    uint64_t frame_pointer_frames;
+    uint64_t row_cache_hits;
+    uint64_t row_cache_misses;
+    size_t modules;
+};
+
+struct ModuleUnwindInfo;
+struct LoadedModule;
+class ElfParser;
+class ProcessMaps;
+
+// DWARF call-frame unwinder over .eh_frame. Each module of the target gets
+// an FDE index built once from .eh_frame_hdr (or a scan of .eh_frame when
+// there is none), and the CFA rules decoded for a pc are cached, so a
+// repeated unwind through the same code costs a hash lookup and a couple
+// of stack reads per frame. Code without CFI falls back to the
+// frame-pointer chain. Modules and their images come from ProcessMaps.
+//
+// Not thread-safe; the engine and the sampler both drive it from the
+// tracer thread.
+class StackUnwinder {
+public:
+    explicit StackUnwinder(ProcessMaps& maps);
+    ~StackUnwinder();
+
+    StackUnwinder(const StackUnwinder&) = delete;
+    StackUnwinder& operator=(const StackUnwinder&) = delete;
+
+    static UnwindRegisters registers_from(const user_regs_struct& regs);
+
+    size_t unwind(const UnwindRegisters& start, const StackReader& read, UnwindFrame* frames, size_t max_frames);
+    std::vector<UnwindFrame> unwind(const UnwindRegisters& start, const StackReader& read, size_t max_frames = 64);
+
+    UnwinderStats get_stats() const;
+    void reset_stats();
+
+private:
+    ProcessMaps& maps;
+    uint64_t maps_generation;
+    // Per parsed image, so it survives refreshes and process restarts for
+    // as long as the maps keep the image
+    std::unordered_map<const ElfParser*, std::shared_ptr<ModuleUnwindInfo>> unwind_info;
+    UnwinderStats stats;
+
+    ModuleUnwindInfo* get_unwind_info(const LoadedModule& module);
+};
+
+} // namespace debugger 
\ No newline at end of file
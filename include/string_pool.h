@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace debugger {
+
+// Arena of deduplicated, NUL-terminated strings. Views returned by intern()
+// stay valid until clear() or destruction, and equal strings share storage,
+// so interned names can be compared by pointer.
+class StringPool {
+public:
+    explicit StringPool(size_t chunk_size = 64 * 1024);
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    std::string_view intern(std::string_view str);
+    bool contains(std::string_view str) const;
+    void clear();
+
+    size_t size() const;          // number of distinct strings
+    size_t memory_usage() const;  // bytes reserved by the arena
+
+private:
+    std::vector<std::unique_ptr<char[]>> chunks;
+    std::unordered_set<std::string_view> index;
+    size_t chunk_size;
+    size_t chunk_used;
+    size_t chunk_capacity;
+    size_t reserved_bytes;
+
+    char* allocate(size_t size);
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace debugger {
+
+enum class StringEncoding : uint8_t {
+    ASCII,
+    UTF16LE   // ASCII-range characters each followed by a zero byte
+};
+
+// Location of a printable run; the text itself stays in the scanned data
+struct StringRecord {
+    uint64_t offset;   // base_offset + position of the first byte
+    uint32_t length;   // in characters
+    StringEncoding encoding;
+
+    size_t byte_size() const { return encoding == StringEncoding::UTF16LE ? length * 2u : length; }
+};
+
+// Strings found in one section of a binary
+struct SectionStrings {
+    std::string section_name;
+    std::vector<StringRecord> records;
+};
+
+struct ScanRegion {
+    ByteView data;
+    uint64_t base_offset;  // e.g. the region's offset in the mapped file
+};
+
+// Finds runs of printable ASCII (0x20-0x7e) and their UTF-16LE equivalent.
+// Bytes are classified 64 at a time with SSE2, AVX2 (picked at runtime) or
+// NEON where available, and runs are walked with bit scans over the masks.
+class StringScanner {
+public:
+    static constexpr size_t DEFAULT_MIN_LENGTH = 4;
+
+    explicit StringScanner(size_t min_length = DEFAULT_MIN_LENGTH, bool detect_utf16 = true);
+
+    // Appends records in offset order
+    void scan(const uint8_t* data, size_t size, uint64_t base_offset, std::vector<StringRecord>& out) const;
+    std::vector<StringRecord> scan(ByteView data, uint64_t base_offset = 0) const;
+
+    // Splits every region into chunks and scans them all on the pool; the
+    // result has one offset-ordered vector per region. Chunks not yet
+    // started are skipped once cancelled() reports true.
+    std::vector<std::vector<StringRecord>> scan_regions(const std::vector<ScanRegion>& regions,
+                                                        ThreadPool& pool,
+                                                        const CancelCheck& cancelled = nullptr) const;
+
+    // Copies a record out of data, which must start at the record's base_offset
+    static std::string to_string(ByteView data, uint64_t base_offset, const StringRecord& record);
+
+    static const char* get_implementation_name();
+
+private:
+    size_t min_length;
+    bool detect_utf16;
+
+    void scan_range(const uint8_t* data, size_t size, size_t begin, size_t end,
+                    uint64_t base_offset, std::vector<StringRecord>& out) const;
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "string_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace debugger {
+
+class ElfParser;
+
+// Flat symbol index for one or many modules. Symbols live in parallel
+// arrays sorted by address, with names interned in a StringPool; a
+// name-ordered permutation serves exact and prefix lookups, and a trigram
+// index over lowercased names narrows substring searches to the names
+// that can possibly match. Indexes are rebuilt on the first query after
+// symbols were added, so bulk loading stays a plain append.
+class SymbolTable {
+public:
+    struct SymbolInfo {
+        std::string name;
+        uint64_t address;
+        uint64_t size;
+        std::string type;
+        std::string section;
+        bool is_function;
+        bool is_global;
+    };
+
+    // Position in the address-ordered arrays; score is higher for better
+    // matches (exact, then prefix, then substring, then fuzzy)
+    struct SearchResult {
+        uint32_t index;
+        int score;
+    };
+
+    SymbolTable();
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    bool load_symbols(const std::string& filename);
+    // Defined symbols of a parsed image, relocated by bias
+    size_t add_elf_symbols(const ElfParser& elf, uint64_t bias = 0);
+    void add_symbol(const std::string& name, uint64_t address, uint64_t size = 0,
+                    const std::string& type = "", bool is_function = false);
+    void clear();
+    size_t size() const;
+
+    // Address -> covering symbol and the offset into it
+    bool find_symbol(uint64_t address, uint32_t& index, uint64_t& offset);
+    std::string lookup_symbol(uint64_t address);  // "name" or "name+offset"
+    uint64_t lookup_address(const std::string& symbol);
+    bool has_symbol(const std::string& name);
+    SymbolInfo get_symbol_info(const std::string& name);
+
+    // Per-index access; indexes are valid until symbols are added or cleared
+    std::string_view get_name(uint32_t index) const;
+    uint64_t get_address(uint32_t index) const;
+    uint64_t get_size(uint32_t index) const;
+    std::string_view get_type(uint32_t index) const;
+    bool is_function(uint32_t index) const;
+    SymbolInfo get_symbol(uint32_t index) const;
+
+    // Case-insensitive substring search, best first. Fuzzy also accepts the
+    // query's characters in order with gaps ("mlc" finds "malloc"), ranked
+    // below every substring hit. An empty query lists symbols by name.
+    std::vector<SearchResult> search(std::string_view query, size_t max_results, bool fuzzy = false);
+    std::vector<std::string> find_symbols_by_pattern(const std::string& pattern);
+    std::vector<std::string> get_function_symbols();
+    std::vector<SymbolInfo> get_symbols_in_range(uint64_t start_addr, uint64_t end_addr);
+
+    std::string get_symbol_file() const;
+    bool export_symbols(const std::string& filename);
+
+    // Symbol name storage plus every index
+    size_t memory_usage() const;
+
+private:
+    static constexpr uint8_t FUNCTION = 1;
+    static constexpr uint8_t GLOBAL = 2;
+
+    // Symbol columns, address order once built
+    std::vector<uint64_t> addresses;
+    std::vector<uint64_t> sizes;
+    std::vector<std::string_view> names;
+    std::vector<std::string_view> types;
+    std::vector<std::string_view> sections;
+    std::vector<uint8_t> flags;
+    std::vector<uint64_t> char_masks;  // which (folded) characters each name contains
+    StringPool strings;
+
+    bool built;
+    std::vector<uint32_t> by_name;           // symbol indexes in name order
+    std::vector<uint32_t> trigram_offsets;   // CSR over hashed trigram buckets
+    std::vector<uint32_t> trigram_postings;  // symbol indexes, ascending per bucket
+    std::string symbol_file;
+
+    void ensure_built();
+    void sort_by_address();
+    void build_name_index();
+    void build_trigram_index();
+    void append(std::string_view name, uint64_t address, uint64_t size, std::string_view type,
+                std::string_view section, uint8_t symbol_flags);
+    uint32_t find_by_name(std::string_view name);  // first symbol with that name, or UINT32_MAX
+
+    bool load_elf_symbols(const std::string& filename);
+    bool load_text_symbols(const std::string& filename);
+};
+
+} // namespace debugger 
\ No newline at end of file
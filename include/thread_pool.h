@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace debugger {
+
+// Polled by long-running analysis between units of work, possibly from pool
+// workers; returns true once the caller wants the work abandoned. The
+// partial result is then meaningless and should be discarded.
+using CancelCheck = std::function<bool()>;
+
+// Fixed-size pool of worker threads with work stealing. Tasks submitted from
+// outside the pool go to a shared FIFO; tasks submitted by a running task go
+// to the back of that worker's own deque and are popped LIFO, so recursive
+// work stays on a warm core while idle workers steal from the front.
+class ThreadPool {
+public:
+    // thread_count == 0 uses one thread per hardware thread
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        // std::function needs a copyable target, so share the packaged task
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return future;
+    }
+
+    size_t get_thread_count() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> worker_queues;
+    std::deque<std::function<void()>> tasks;  // shared queue for external submissions
+    std::mutex queue_mutex;
+    std::condition_variable queue_condition;
+    std::atomic<size_t> queued_tasks;
+    bool stopping;
+
+    void enqueue(std::function<void()> task);
+    bool take_task(size_t worker_index, std::function<void()>& task);
+    void worker_loop(size_t worker_index);
+};
+
+} // namespace debugger 
\ No newline at end of file
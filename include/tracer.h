@@ -0,0 +1,305 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <signal.h>
+#include <sys/types.h>
+
+#include "breakpoint_condition.h"
+#include "memory_manager.h"
+#include "stack_unwinder.h"
+
+namespace debugger {
+
+// Why a tracee stopped (or went away)
+enum class TraceEventType {
+    BREAKPOINT,  // software or hardware breakpoint trap
+    WATCHPOINT,  // hardware watchpoint; address is the watched address, value the pc
+    STEP,        // single step finished
+    INTERRUPT,   // stopped on request by Tracer::interrupt()
+    SIGNAL,      // signal-delivery or group stop; a delivered signal is passed on at resume
+    EXEC,        // the process replaced its image; every other thread is gone
+    EXITED,      // process exited normally, value is the exit status
+    KILLED       // process terminated by a signal, value is the signal number
+};
+
+// What a hardware debug register traps on
+enum class WatchKind {
+    EXECUTE,    // instruction fetch: a hardware breakpoint
+    WRITE,
+    READ_WRITE  // any access; x86 has no read-only watchpoints
+};
+
+struct HardwareBreakpointInfo {
+    uint64_t address;
+    WatchKind kind;
+    uint8_t length;  // bytes watched; 1 for EXECUTE
+    uint64_t hit_count;
+};
+
+// How a stop in one thread affects the rest of the thread group
+enum class StopMode {
+    ALL_STOP,  // any reported stop interrupts every other thread first
+    NON_STOP   // only the reporting thread stops; the others keep running
+};
+
+struct ThreadInfo {
+    pid_t tid;
+    bool stopped;
+    bool exiting;
+};
+
+// Log2-bucketed latency samples: bucket i counts samples in [2^i, 2^(i+1)) ns
+struct LatencyHistogram {
+    static constexpr size_t BUCKETS = 40;
+
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+
+    void record(uint64_t ns);
+    // Upper edge of the bucket holding the given fraction (0..1) of samples
+    uint64_t get_percentile_ns(double fraction) const;
+};
+
+struct BreakpointStats {
+    uint64_t address;
+    uint8_t original_byte;
+    bool tracing;
+    uint64_t hit_count;
+    LatencyHistogram latency;  // trap reaped -> reported, or -> resumed for tracing breakpoints
+};
+
+// Where profiling samples come from
+enum class SamplingMode {
+    PERF_EVENT,  // the kernel copies registers and the top of the stack; nothing stops
+    INTERRUPT    // every thread is interrupted on a timer, read and resumed; wall clock,
+                 // so blocked threads show up where they wait
+};
+
+struct SamplingStats {
+    SamplingMode mode;
+    uint64_t samples;
+    uint64_t lost;               // dropped by the kernel, or rounds skipped mid step-over
+    LatencyHistogram stop_time;  // INTERRUPT only: how long each round held the group
+};
+
+// Runs on the tracer thread for every sample. read serves stack memory:
+// from the kernel's copy where there is one, the live target otherwise.
+using SampleHandler = std::function<void(pid_t tid, const UnwindRegisters& regs, const StackReader& read)>;
+
+struct TraceEvent {
+    TraceEventType type;
+    pid_t pid;              // thread group
+    pid_t tid;
+    uint64_t address;       // program counter; the trap address for BREAKPOINT
+    int value;              // signal number or exit status, depending on type
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC when the stop was reaped
+};
+
+// Bounded single-producer/single-consumer ring. The tracer thread pushes,
+// the owning (GUI) thread pops; neither side ever takes a lock.
+class TraceEventQueue {
+public:
+    static constexpr size_t CAPACITY = 1024;
+
+    TraceEventQueue();
+
+    bool push(const TraceEvent& event);  // false when full
+    bool pop(TraceEvent& event);         // false when empty
+
+private:
+    std::array<TraceEvent, CAPACITY> slots;
+    alignas(64) std::atomic<size_t> head;  // next slot to pop
+    alignas(64) std::atomic<size_t> tail;  // next slot to push
+};
+
+// Owns the thread that issues every ptrace request. The kernel only accepts
+// requests from the thread that seized (or forked) a tracee, so all process
+// control runs here through execute(). Between commands the thread sleeps in
+// poll(): a SIGCHLD handler wakes it when a tracee changes state, it reaps
+// with waitid(__WALL), decodes the stop and queues a TraceEvent.
+//
+// Every thread of the target is seized with PTRACE_O_TRACECLONE, so new
+// threads join the per-TID table as they are created. In all-stop mode a
+// reported stop is held back while the remaining threads are interrupted in
+// one pass of PTRACE_INTERRUPT, and released once the whole group is down.
+class Tracer {
+public:
+    Tracer();
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // Runs task on the tracer thread and waits for it to return. Safe to
+    // call from the tracer thread itself, in which case task runs inline.
+    void execute(const std::function<void()>& task);
+    bool is_tracer_thread() const;
+
+    // Tracer-thread only. spawn() and attach() return with every thread of
+    // the process stopped; spawn() stops on the exec of path.
+    pid_t spawn(const char* path, char* const argv[]);
+    bool attach(pid_t pid);
+    bool detach(pid_t pid);
+    bool kill_process(pid_t pid);
+
+    void set_stop_mode(StopMode mode);
+    StopMode get_stop_mode() const;
+    std::vector<ThreadInfo> get_threads(pid_t pid) const;
+    bool is_stopped(pid_t tid) const;
+
+    // A thread parked on one of our breakpoints steps off it first with the
+    // original byte restored, then the int3 goes back and it carries on
+    bool resume(pid_t tid, int request);  // PTRACE_CONT or PTRACE_SINGLESTEP
+    bool resume_all(pid_t pid);
+    bool interrupt_all(pid_t pid);        // reported as one INTERRUPT event
+
+    // Software breakpoints. Nearby addresses are patched with one
+    // read-modify-write of the span covering them. Tracing breakpoints are
+    // counted and stepped over on this thread without reporting a stop.
+    size_t insert_breakpoints(const std::vector<uint64_t>& addresses, bool tracing);
+    size_t remove_breakpoints(const std::vector<uint64_t>& addresses);
+    // A breakpoint with a condition only counts and reports a hit when the
+    // condition holds for the thread that hit it; otherwise the thread is
+    // stepped over it like a tracing breakpoint. Null clears the condition.
+    bool set_breakpoint_condition(uint64_t address, std::shared_ptr<const BreakpointCondition> condition);
+    std::vector<BreakpointStats> get_breakpoint_stats() const;
+    uint64_t get_breakpoint_hits(uint64_t address) const;  // 0 when not inserted
+    void reset_breakpoint_stats();
+
+    // Hardware breakpoints and watchpoints live in each thread's debug
+    // registers: code is never patched and nothing single-steps, so the
+    // target runs at full speed until one fires. They are written to every
+    // thread of the process (new threads get them at their first stop).
+    // x86-64 has four slots shared by both kinds; lengths are 1, 2, 4 or 8
+    // and the address must be aligned to the length.
+    bool insert_hardware_breakpoint(pid_t pid, uint64_t address, WatchKind kind, size_t length);
+    bool remove_hardware_breakpoint(pid_t pid, uint64_t address, WatchKind kind);
+    std::vector<HardwareBreakpointInfo> get_hardware_breakpoints() const;
+
+    // Sampling profiler over every thread of pid at about frequency_hz.
+    // perf_event_open is used when the kernel allows it: the samples land in
+    // a ring per thread that is drained on a timer. Otherwise the same
+    // timer interrupts the group, reads each thread and resumes it. Either
+    // way nothing is sampled while the target is stopped.
+    bool start_sampling(pid_t pid, unsigned frequency_hz, SampleHandler handler);
+    void stop_sampling();
+    bool is_sampling() const;
+    SamplingStats get_sampling_stats() const;
+
+    // Consumer side. The notifier runs on the tracer thread whenever events
+    // become pending after the queue was drained, and should only schedule
+    // a pop_event() loop on the consuming thread.
+    void set_event_notifier(std::function<void()> notifier);
+    void acknowledge_events();
+    bool pop_event(TraceEvent& event);
+
+private:
+    struct TraceeState {
+        pid_t pid;           // thread group, 0 until the parent reports the clone
+        bool running;        // resumed and not reaped since; a pending initial stop counts
+        bool stepping;
+        bool interrupt_requested;
+        bool exiting;        // past PTRACE_EVENT_EXIT; will never stop again
+        int pending_signal;  // delivered with the next resume
+        uint64_t breakpoint_address;  // parked on this breakpoint, pc already rewound
+        uint64_t step_over_address;   // stepping off this breakpoint, its byte restored
+        int step_over_request;        // what the resume that started the step-over asked for
+        bool resume_deferred;         // waiting for sibling step-overs before continuing
+        bool debug_registers_stale = false;  // hardware slots changed since last written here
+        bool hardware_hit = false;           // parked on a hit that would fire again on resume
+        bool hardware_step = false;          // stepping past that hit with the slots disabled
+    };
+
+    struct SoftwareBreakpoint {
+        uint8_t original_byte;
+        bool tracing;
+        uint64_t hit_count;
+        LatencyHistogram latency;
+        unsigned threads_stepping;  // the int3 goes back when the last one is off
+        std::shared_ptr<const BreakpointCondition> condition;
+    };
+
+    // A perf_event_open sampling stream for one thread and its mapped ring
+    struct PerfStream {
+        pid_t tid;
+        int fd;
+        uint8_t* ring;
+        size_t ring_size;  // metadata page included
+    };
+
+    std::thread thread;
+    int command_fd;  // eventfd, bumped when commands are queued
+    int child_fd;    // eventfd, bumped by the SIGCHLD handler
+    int child_slot;  // registration with that handler; -1 if every slot was taken
+    int timer_fd;    // timerfd driving the sampler; disarmed when not sampling
+    std::mutex command_mutex;
+    std::deque<std::function<void()>> commands;
+    std::atomic<bool> stopping;
+
+    // Touched only on the tracer thread
+    std::unordered_map<pid_t, TraceeState> tracees;
+    StopMode stop_mode;
+    bool stopping_world;             // interrupts are out, waiting for the group to stop
+    pid_t pause_pid;                 // interrupt_all() in progress for this process, or 0
+    std::vector<TraceEvent> held_events;  // all-stop events waiting for the group to stop
+    std::unordered_map<uint64_t, SoftwareBreakpoint> breakpoints;
+    std::vector<HardwareBreakpointInfo> hardware_breakpoints;  // x86: index is the DR slot
+    size_t step_overs_in_flight;
+    MemoryManager memory;  // for patching breakpoints
+    std::function<void()> event_notifier;
+    uint64_t events_published;
+    
+    pid_t sampling_pid;  // 0 when not sampling
+    unsigned sampling_frequency;
+    SampleHandler sample_handler;
+    std::vector<PerfStream> perf_streams;
+    std::vector<uint8_t> perf_record;  // a record that wrapped around its ring, reassembled
+    bool sampling_round;                // interrupt round in progress
+    std::vector<pid_t> sampling_reported;  // threads that stopped for real during the round
+    SamplingStats sampling_stats;
+
+    TraceEventQueue events;
+    std::atomic<bool> notify_pending;
+
+    void thread_main();
+    void run_commands();
+    void reap_children();
+    bool reap_one(int flags, pid_t tid = 0);  // tid 0: any tracee
+    void handle_stop(pid_t tid, int status, uint64_t timestamp_ns);
+    void handle_exit(const siginfo_t& info, uint64_t timestamp_ns);
+    void report(const TraceEvent& event);
+    void resume_quietly(pid_t tid, TraceeState& tracee);
+    bool start_step_over(pid_t tid, TraceeState& tracee, int request);
+    bool finish_step_over(pid_t tid, TraceeState& tracee, int signal, int ptrace_event);
+    void await_step_over(pid_t tid);
+    void end_step_over(uint64_t address);
+    void resume_deferred();
+    bool handle_breakpoint_trap(pid_t tid, TraceeState& tracee, TraceEvent& event, uint64_t timestamp_ns);
+    size_t patch_breakpoints(std::vector<uint64_t> addresses, bool arm);
+    bool write_debug_registers(pid_t tid, bool suspended);
+    void update_debug_registers(pid_t pid);
+    void handle_hardware_trap(pid_t tid, TraceeState& tracee, TraceEvent& event, const siginfo_t& trap);
+    void stop_world();
+    void wait_for_world_stop();
+    void complete_world_stop();
+    void forget_process(pid_t pid);
+    void publish(const TraceEvent& event);
+    bool open_perf_stream(pid_t tid);
+    void close_perf_stream(pid_t tid);
+    void drain_perf_stream(PerfStream& stream);
+    void sample_by_interrupt();
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace debugger {
+
+class DisassemblyBuffer;
+
+enum class XrefType : uint8_t {
+    CALL,
+    JUMP,
+    DATA   // Immediate or RIP-relative operand pointing into a data range
+};
+
+struct Xref {
+    uint64_t target;
+    uint64_t source;  // Address of the referencing instruction
+    XrefType type;
+};
+
+// Contiguous run of references sharing one target; points into the index
+// and is invalidated by build(), update_range() and clear()
+struct XrefRange {
+    const Xref* first;
+    const Xref* last;
+
+    const Xref* begin() const { return first; }
+    const Xref* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+// Whole-binary cross-reference index built in one pass over the decoded
+// instructions. References are kept sorted by (target, source) with a CSR
+// style offset table over the distinct targets, so a query is one binary
+// search over the targets and never touches the instruction listing.
+class XrefIndex {
+public:
+    using AddressRange = std::pair<uint64_t, uint64_t>;  // [start, end)
+
+    // Immediates only count as data references when they land in one of
+    // data_ranges (typically the allocated sections of the binary). Returns
+    // false, leaving the index empty, once cancelled() reports true.
+    bool build(const DisassemblyBuffer& instructions,
+               const std::vector<AddressRange>& data_ranges = {},
+               const CancelCheck& cancelled = nullptr);
+
+    // Re-analysis of [start, end): drops every reference whose source lies in
+    // the range and re-collects them from instructions[first, first + count)
+    void update_range(uint64_t start, uint64_t end,
+                      const DisassemblyBuffer& instructions, size_t first, size_t count);
+    void clear();
+
+    // Serialization: references in index order, and adopting such a list
+    const std::vector<Xref>& get_references() const { return references; }
+    const std::vector<AddressRange>& get_data_ranges() const { return data_ranges; }
+    void assign(std::vector<Xref> sorted_references, std::vector<AddressRange> ranges);
+
+    XrefRange get_references_to(uint64_t target) const;
+    std::vector<uint64_t> get_callers(uint64_t target) const;  // sources of CALL references
+
+    size_t size() const;          // total references
+    size_t target_count() const;  // distinct targets
+    size_t memory_usage() const;
+
+private:
+    std::vector<Xref> references;     // sorted by (target, source)
+    std::vector<uint64_t> targets;    // distinct targets, ascending
+    std::vector<uint32_t> offsets;    // targets.size() + 1 entries into references
+    std::vector<AddressRange> data_ranges;
+
+    void collect(const DisassemblyBuffer& instructions, size_t first, size_t count,
+                 std::vector<Xref>& out) const;
+    bool is_data_address(uint64_t address) const;
+    void rebuild_offsets();
+};
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,734 @@
+#include "analysis_database.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <unistd.h>
+
+namespace debugger {
+
+namespace {
+
+constexpr char kMagic[8] = {'D', 'B', 'G', 'A', 'N', 'A', 'D', 'B'};
+constexpr uint64_t kPageSize = 4096;
+constexpr size_t kHashBlockSize = 4 * 1024 * 1024;
+
+// The first page: this header followed by the table of contents
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t instruction_record_size;  // sizeof(PackedInstruction) of the writer
+    uint64_t content_hash;
+    uint64_t source_size;
+    uint64_t chunk_count;
+};
+
+// On-disk records; all padding is explicit so equal results give equal bytes
+struct FunctionRecord {
+    uint64_t start_address;
+    uint64_t end_address;
+    uint64_t first_instruction;
+    uint64_t instruction_count;
+    uint32_t first_block;
+    uint32_t block_count;
+    uint32_t name_offset;
+    uint32_t name_length;
+};
+
+struct BlockRecord {
+    uint64_t start_address;
+    uint64_t end_address;
+    uint64_t first_instruction;
+    uint64_t instruction_count;
+    uint32_t first_successor;
+    uint32_t successor_count;
+};
+
+struct XrefRecord {
+    uint64_t target;
+    uint64_t source;
+    uint32_t type;
+    uint32_t reserved;
+};
+
+struct RangeRecord {
+    uint64_t start;
+    uint64_t end;
+};
+
+struct StringEntry {
+    uint64_t offset;
+    uint32_t length;
+    uint8_t encoding;
+    uint8_t reserved[3];
+};
+
+struct StringSectionRecord {
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t first_record;
+    uint32_t record_count;
+};
+
+// Bytes of PackedInstruction before its tail padding
+constexpr size_t kInstructionBytesUsed = offsetof(PackedInstruction, flags) + sizeof(uint8_t);
+
+constexpr uint64_t kPrime1 = 0x9e3779b97f4a7c15ULL;
+constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4fULL;
+
+inline uint64_t rotate_left(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t finalize(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+// Four independent lanes keep the multiplier busy; not cryptographic
+uint64_t hash_bytes(const uint8_t* data, size_t size, uint64_t seed) {
+    uint64_t lanes[4] = {seed + kPrime1, seed ^ kPrime2, seed - kPrime1, ~seed};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            lanes[lane] = rotate_left(lanes[lane] + word * kPrime2, 31) * kPrime1;
+        }
+    }
+    
+    uint64_t hash = size * kPrime1;
+    for (uint64_t lane : lanes) {
+        hash = rotate_left(hash ^ finalize(lane), 27) * kPrime1;
+    }
+    for (; i < size; ++i) {
+        hash = rotate_left(hash ^ (data[i] * kPrime2), 11) * kPrime1;
+    }
+    return finalize(hash);
+}
+
+uint64_t hash_bytes(const std::vector<uint8_t>& bytes) {
+    return hash_bytes(bytes.data(), bytes.size(), 0);
+}
+
+uint64_t align_to_page(uint64_t value) {
+    return (value + kPageSize - 1) & ~(kPageSize - 1);
+}
+
+// Room for the chunk to grow a little before it has to move
+uint64_t slot_capacity(uint64_t size) {
+    return size == 0 ? 0 : align_to_page(size + size / 8);
+}
+
+template <typename T>
+void append_record(std::vector<uint8_t>& out, const T& record) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void append_text(std::vector<uint8_t>& out, std::string_view text) {
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+template <typename T>
+bool read_records(ByteView view, std::vector<T>& out) {
+    if (view.size() % sizeof(T) != 0) {
+        return false;
+    }
+    out.resize(view.size() / sizeof(T));
+    if (!out.empty()) {
+        std::memcpy(out.data(), view.data(), view.size());
+    }
+    return true;
+}
+
+bool write_all(int fd, const void* data, size_t size, uint64_t offset) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t size, uint64_t offset) {
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t count = pread(fd, bytes, size, static_cast<off_t>(offset));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        bytes += count;
+        size -= static_cast<size_t>(count);
+        offset += static_cast<uint64_t>(count);
+    }
+    return true;
+}
+
+bool header_matches(const FileHeader& header, uint64_t content_hash, uint64_t source_size) {
+    return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+           header.version == AnalysisDatabase::FORMAT_VERSION &&
+           header.instruction_record_size == sizeof(PackedInstruction) &&
+           header.content_hash == content_hash &&
+           header.source_size == source_size &&
+           header.chunk_count == static_cast<uint64_t>(DatabaseChunk::COUNT);
+}
+
+} // namespace
+
+AnalysisDatabase::AnalysisDatabase() : table{}, has_pending{}, last_written_chunks(0) {
+    static_assert(sizeof(FileHeader) + CHUNK_COUNT * sizeof(ChunkEntry) <= kPageSize,
+                  "Header and table of contents must fit the first page");
+}
+
+uint64_t AnalysisDatabase::compute_content_hash(ByteView data, ThreadPool* pool, const CancelCheck& cancelled) {
+    PERF_SCOPE("AnalysisDatabase::compute_content_hash", "database");
+    size_t block_count = (data.size() + kHashBlockSize - 1) / kHashBlockSize;
+    std::vector<uint64_t> block_hashes(block_count);
+    
+    auto hash_block = [&data, &block_hashes, &cancelled](size_t block) {
+        if (cancelled && cancelled()) {
+            return;
+        }
+        ByteView slice = data.subview(block * kHashBlockSize, kHashBlockSize);
+        block_hashes[block] = hash_bytes(slice.data(), slice.size(), block);
+    };
+    
+    if (pool && block_count > 1) {
+        std::vector<std::future<void>> pending_blocks;
+        pending_blocks.reserve(block_count);
+        for (size_t block = 0; block < block_count; ++block) {
+            pending_blocks.push_back(pool->submit([&hash_block, block]() { hash_block(block); }));
+        }
+        for (auto& block : pending_blocks) {
+            block.get();
+        }
+    } else {
+        for (size_t block = 0; block < block_count; ++block) {
+            hash_block(block);
+        }
+    }
+    
+    return hash_bytes(reinterpret_cast<const uint8_t*>(block_hashes.data()),
+                      block_hashes.size() * sizeof(uint64_t), data.size());
+}
+
+std::string AnalysisDatabase::get_database_path(const std::string& directory, uint64_t content_hash) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.adb", static_cast<unsigned long long>(content_hash));
+    return directory.empty() ? std::string(name) : directory + "/" + name;
+}
+
+bool AnalysisDatabase::open(const std::string& path, uint64_t content_hash, uint64_t source_size) {
+    close();
+    
+    if (!file.open(path)) {
+        last_error = file.get_last_error();
+        return false;
+    }
+    
+    // Only the first page is read here; chunks stay unread until loaded
+    ByteView header_page = file.view(0, kPageSize);
+    FileHeader header;
+    if (header_page.size() < kPageSize) {
+        last_error = "Analysis database is truncated: " + path;
+        close();
+        return false;
+    }
+    std::memcpy(&header, header_page.data(), sizeof(header));
+    if (!header_matches(header, content_hash, source_size)) {
+        last_error = "Analysis database does not match the binary: " + path;
+        close();
+        return false;
+    }
+    
+    std::memcpy(table.data(), header_page.data() + sizeof(FileHeader), sizeof(ChunkTable));
+    for (auto& entry : table) {
+        if (entry.offset != 0 && (entry.offset < kPageSize || entry.offset + entry.size > file.size())) {
+            entry = ChunkEntry{};  // Points past the end; treat as missing
+        }
+    }
+    return true;
+}
+
+void AnalysisDatabase::close() {
+    file.close();
+    table.fill(ChunkEntry{});
+}
+
+bool AnalysisDatabase::is_open() const {
+    return file.is_open();
+}
+
+bool AnalysisDatabase::has_chunk(DatabaseChunk chunk) const {
+    return file.is_open() && table[static_cast<size_t>(chunk)].offset != 0;
+}
+
+ByteView AnalysisDatabase::get_chunk(DatabaseChunk chunk) const {
+    const ChunkEntry& entry = table[static_cast<size_t>(chunk)];
+    return entry.offset != 0 ? file.view(entry.offset, entry.size) : ByteView();
+}
+
+bool AnalysisDatabase::load_disassembly(DisassemblyBuffer& buffer) const {
+    if (!has_chunk(DatabaseChunk::INSTRUCTIONS) || !has_chunk(DatabaseChunk::OPERAND_TEXT) ||
+        !has_chunk(DatabaseChunk::MNEMONICS)) {
+        return false;
+    }
+    
+    std::vector<PackedInstruction> records;
+    if (!read_records(get_chunk(DatabaseChunk::INSTRUCTIONS), records)) {
+        return false;
+    }
+    
+    ByteView text = get_chunk(DatabaseChunk::OPERAND_TEXT);
+    std::vector<char> operand_text(text.begin(), text.end());
+    
+    std::vector<std::string> mnemonics;
+    std::string_view names = get_chunk(DatabaseChunk::MNEMONICS).as_string_view();
+    for (size_t start = 0; start < names.size();) {
+        size_t end = names.find('\0', start);
+        if (end == std::string_view::npos) {
+            return false;
+        }
+        mnemonics.emplace_back(names.substr(start, end - start));
+        start = end + 1;
+    }
+    
+    // Records index into the text tables; reject anything that would read past them
+    for (const auto& record : records) {
+        if (record.mnemonic_id >= mnemonics.size() || record.operands_offset > operand_text.size() ||
+            record.operands_length > operand_text.size() - record.operands_offset) {
+            return false;
+        }
+    }
+    
+    buffer.assign(std::move(records), std::move(operand_text), std::move(mnemonics));
+    return true;
+}
+
+bool AnalysisDatabase::load_functions(std::vector<Function>& functions) const {
+    if (!has_chunk(DatabaseChunk::FUNCTIONS) || !has_chunk(DatabaseChunk::FUNCTION_BLOCKS) ||
+        !has_chunk(DatabaseChunk::BLOCK_SUCCESSORS) || !has_chunk(DatabaseChunk::FUNCTION_NAMES)) {
+        return false;
+    }
+    
+    std::vector<FunctionRecord> function_records;
+    std::vector<BlockRecord> block_records;
+    std::vector<uint64_t> successors;
+    if (!read_records(get_chunk(DatabaseChunk::FUNCTIONS), function_records) ||
+        !read_records(get_chunk(DatabaseChunk::FUNCTION_BLOCKS), block_records) ||
+        !read_records(get_chunk(DatabaseChunk::BLOCK_SUCCESSORS), successors)) {
+        return false;
+    }
+    std::string_view names = get_chunk(DatabaseChunk::FUNCTION_NAMES).as_string_view();
+    
+    std::vector<Function> result;
+    result.reserve(function_records.size());
+    for (const auto& record : function_records) {
+        if (static_cast<uint64_t>(record.first_block) + record.block_count > block_records.size() ||
+            static_cast<uint64_t>(record.name_offset) + record.name_length > names.size()) {
+            return false;
+        }
+        
+        Function function;
+        function.start_address = record.start_address;
+        function.end_address = record.end_address;
+        function.name = std::string(names.substr(record.name_offset, record.name_length));
+        function.first_instruction = static_cast<size_t>(record.first_instruction);
+        function.instruction_count = static_cast<size_t>(record.instruction_count);
+        function.blocks.reserve(record.block_count);
+        
+        for (uint32_t b = 0; b < record.block_count; ++b) {
+            const BlockRecord& block_record = block_records[record.first_block + b];
+            if (static_cast<uint64_t>(block_record.first_successor) + block_record.successor_count > successors.size()) {
+                return false;
+            }
+            
+            FunctionBlock block;
+            block.start_address = block_record.start_address;
+            block.end_address = block_record.end_address;
+            block.first_instruction = static_cast<size_t>(block_record.first_instruction);
+            block.instruction_count = static_cast<size_t>(block_record.instruction_count);
+            block.successors.assign(successors.begin() + block_record.first_successor,
+                                    successors.begin() + block_record.first_successor + block_record.successor_count);
+            function.blocks.push_back(std::move(block));
+        }
+        result.push_back(std::move(function));
+    }
+    
+    functions = std::move(result);
+    return true;
+}
+
+bool AnalysisDatabase::load_xref_index(XrefIndex& index) const {
+    if (!has_chunk(DatabaseChunk::XREFS) || !has_chunk(DatabaseChunk::XREF_DATA_RANGES)) {
+        return false;
+    }
+    
+    std::vector<XrefRecord> records;
+    std::vector<RangeRecord> range_records;
+    if (!read_records(get_chunk(DatabaseChunk::XREFS), records) ||
+        !read_records(get_chunk(DatabaseChunk::XREF_DATA_RANGES), range_records)) {
+        return false;
+    }
+    
+    std::vector<Xref> references;
+    references.reserve(records.size());
+    for (const auto& record : records) {
+        if (record.type > static_cast<uint32_t>(XrefType::DATA)) {
+            return false;
+        }
+        references.push_back({record.target, record.source, static_cast<XrefType>(record.type)});
+    }
+    
+    std::vector<XrefIndex::AddressRange> ranges;
+    ranges.reserve(range_records.size());
+    for (const auto& range : range_records) {
+        ranges.emplace_back(range.start, range.end);
+    }
+    
+    index.assign(std::move(references), std::move(ranges));
+    return true;
+}
+
+bool AnalysisDatabase::load_strings(std::vector<SectionStrings>& strings) const {
+    if (!has_chunk(DatabaseChunk::STRINGS) || !has_chunk(DatabaseChunk::STRING_SECTIONS) ||
+        !has_chunk(DatabaseChunk::STRING_SECTION_NAMES)) {
+        return false;
+    }
+    
+    std::vector<StringEntry> entries;
+    std::vector<StringSectionRecord> sections;
+    if (!read_records(get_chunk(DatabaseChunk::STRINGS), entries) ||
+        !read_records(get_chunk(DatabaseChunk::STRING_SECTIONS), sections)) {
+        return false;
+    }
+    std::string_view names = get_chunk(DatabaseChunk::STRING_SECTION_NAMES).as_string_view();
+    
+    std::vector<SectionStrings> result;
+    result.reserve(sections.size());
+    for (const auto& section : sections) {
+        if (static_cast<uint64_t>(section.first_record) + section.record_count > entries.size() ||
+            static_cast<uint64_t>(section.name_offset) + section.name_length > names.size()) {
+            return false;
+        }
+        
+        SectionStrings section_strings;
+        section_strings.section_name = std::string(names.substr(section.name_offset, section.name_length));
+        section_strings.records.reserve(section.record_count);
+        for (uint32_t i = 0; i < section.record_count; ++i) {
+            const StringEntry& entry = entries[section.first_record + i];
+            if (entry.encoding > static_cast<uint8_t>(StringEncoding::UTF16LE)) {
+                return false;
+            }
+            section_strings.records.push_back({entry.offset, entry.length, static_cast<StringEncoding>(entry.encoding)});
+        }
+        result.push_back(std::move(section_strings));
+    }
+    
+    strings = std::move(result);
+    return true;
+}
+
+void AnalysisDatabase::set_pending(DatabaseChunk chunk, std::vector<uint8_t> bytes) {
+    size_t slot = static_cast<size_t>(chunk);
+    pending[slot] = std::move(bytes);
+    has_pending[slot] = true;
+}
+
+void AnalysisDatabase::store_disassembly(const DisassemblyBuffer& buffer) {
+    // Copy whole records, then clear the tail padding so equal listings
+    // serialize to equal bytes
+    std::vector<uint8_t> records(buffer.size() * sizeof(PackedInstruction));
+    uint8_t* out = records.data();
+    for (const auto& insn : buffer) {
+        std::memcpy(out, &insn, sizeof(PackedInstruction));
+        std::memset(out + kInstructionBytesUsed, 0, sizeof(PackedInstruction) - kInstructionBytesUsed);
+        out += sizeof(PackedInstruction);
+    }
+    set_pending(DatabaseChunk::INSTRUCTIONS, std::move(records));
+    
+    std::string_view text = buffer.get_operand_text();
+    set_pending(DatabaseChunk::OPERAND_TEXT, std::vector<uint8_t>(text.begin(), text.end()));
+    
+    std::vector<uint8_t> names;
+    for (size_t id = 0; id < buffer.get_mnemonic_count(); ++id) {
+        append_text(names, buffer.get_mnemonic_name(static_cast<uint16_t>(id)));
+        names.push_back(0);
+    }
+    set_pending(DatabaseChunk::MNEMONICS, std::move(names));
+}
+
+void AnalysisDatabase::store_functions(const std::vector<Function>& functions) {
+    std::vector<uint8_t> function_bytes;
+    std::vector<uint8_t> block_bytes;
+    std::vector<uint8_t> successor_bytes;
+    std::vector<uint8_t> names;
+    uint32_t block_count = 0;
+    uint32_t successor_count = 0;
+    
+    for (const auto& function : functions) {
+        FunctionRecord record{};
+        record.start_address = function.start_address;
+        record.end_address = function.end_address;
+        record.first_instruction = function.first_instruction;
+        record.instruction_count = function.instruction_count;
+        record.first_block = block_count;
+        record.block_count = static_cast<uint32_t>(function.blocks.size());
+        record.name_offset = static_cast<uint32_t>(names.size());
+        record.name_length = static_cast<uint32_t>(function.name.size());
+        append_record(function_bytes, record);
+        append_text(names, function.name);
+        
+        for (const auto& block : function.blocks) {
+            BlockRecord block_record{};
+            block_record.start_address = block.start_address;
+            block_record.end_address = block.end_address;
+            block_record.first_instruction = block.first_instruction;
+            block_record.instruction_count = block.instruction_count;
+            block_record.first_successor = successor_count;
+            block_record.successor_count = static_cast<uint32_t>(block.successors.size());
+            append_record(block_bytes, block_record);
+            
+            for (uint64_t successor : block.successors) {
+                append_record(successor_bytes, successor);
+            }
+            successor_count += block_record.successor_count;
+        }
+        block_count += record.block_count;
+    }
+    
+    set_pending(DatabaseChunk::FUNCTIONS, std::move(function_bytes));
+    set_pending(DatabaseChunk::FUNCTION_BLOCKS, std::move(block_bytes));
+    set_pending(DatabaseChunk::BLOCK_SUCCESSORS, std::move(successor_bytes));
+    set_pending(DatabaseChunk::FUNCTION_NAMES, std::move(names));
+}
+
+void AnalysisDatabase::store_xref_index(const XrefIndex& index) {
+    std::vector<uint8_t> reference_bytes;
+    reference_bytes.reserve(index.size() * sizeof(XrefRecord));
+    for (const auto& xref : index.get_references()) {
+        XrefRecord record{};
+        record.target = xref.target;
+        record.source = xref.source;
+        record.type = static_cast<uint32_t>(xref.type);
+        append_record(reference_bytes, record);
+    }
+    
+    std::vector<uint8_t> range_bytes;
+    for (const auto& range : index.get_data_ranges()) {
+        append_record(range_bytes, RangeRecord{range.first, range.second});
+    }
+    
+    set_pending(DatabaseChunk::XREFS, std::move(reference_bytes));
+    set_pending(DatabaseChunk::XREF_DATA_RANGES, std::move(range_bytes));
+}
+
+void AnalysisDatabase::store_strings(const std::vector<SectionStrings>& strings) {
+    std::vector<uint8_t> entry_bytes;
+    std::vector<uint8_t> section_bytes;
+    std::vector<uint8_t> names;
+    uint32_t record_count = 0;
+    
+    for (const auto& section : strings) {
+        StringSectionRecord section_record{};
+        section_record.name_offset = static_cast<uint32_t>(names.size());
+        section_record.name_length = static_cast<uint32_t>(section.section_name.size());
+        section_record.first_record = record_count;
+        section_record.record_count = static_cast<uint32_t>(section.records.size());
+        append_record(section_bytes, section_record);
+        append_text(names, section.section_name);
+        
+        for (const auto& record : section.records) {
+            StringEntry entry{};
+            entry.offset = record.offset;
+            entry.length = record.length;
+            entry.encoding = static_cast<uint8_t>(record.encoding);
+            append_record(entry_bytes, entry);
+        }
+        record_count += section_record.record_count;
+    }
+    
+    set_pending(DatabaseChunk::STRINGS, std::move(entry_bytes));
+    set_pending(DatabaseChunk::STRING_SECTIONS, std::move(section_bytes));
+    set_pending(DatabaseChunk::STRING_SECTION_NAMES, std::move(names));
+}
+
+bool AnalysisDatabase::save(const std::string& path, uint64_t content_hash, uint64_t source_size) {
+    PERF_SCOPE("AnalysisDatabase::save", "database");
+    // Drop our mapping first; the file is reopened once the writes are done
+    close();
+    last_written_chunks = 0;
+    last_error.clear();
+    
+    bool saved = false;
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd != -1) {
+        FileHeader header;
+        ChunkTable on_disk;
+        if (read_all(fd, &header, sizeof(header), 0) &&
+            header_matches(header, content_hash, source_size) &&
+            read_all(fd, on_disk.data(), sizeof(ChunkTable), sizeof(FileHeader))) {
+            saved = write_changed(fd, on_disk);
+            if (!saved) {
+                last_error = "Failed to update analysis database: " + path + " (" + std::strerror(errno) + ")";
+            }
+            ::close(fd);
+        } else {
+            ::close(fd);
+            saved = write_full(path, content_hash, source_size);
+        }
+    } else {
+        saved = write_full(path, content_hash, source_size);
+    }
+    
+    if (saved) {
+        for (size_t slot = 0; slot < CHUNK_COUNT; ++slot) {
+            pending[slot].clear();
+            pending[slot].shrink_to_fit();
+            has_pending[slot] = false;
+        }
+        open(path, content_hash, source_size);
+    }
+    return saved;
+}
+
+bool AnalysisDatabase::write_full(const std::string& path, uint64_t content_hash, uint64_t source_size) {
+    // Written beside the target and renamed over it, so readers never see a
+    // half-written file
+    std::string temporary_path = path + ".tmp";
+    int fd = ::open(temporary_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        last_error = "Failed to create analysis database: " + temporary_path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    
+    ChunkTable layout{};
+    uint64_t offset = kPageSize;
+    bool ok = true;
+    size_t written_chunks = 0;
+    for (size_t slot = 0; slot < CHUNK_COUNT && ok; ++slot) {
+        if (!has_pending[slot]) {
+            continue;
+        }
+        
+        const std::vector<uint8_t>& bytes = pending[slot];
+        layout[slot] = {offset, bytes.size(), slot_capacity(bytes.size()), hash_bytes(bytes)};
+        ok = write_all(fd, bytes.data(), bytes.size(), offset);
+        offset += layout[slot].capacity;
+        ++written_chunks;
+    }
+    
+    uint8_t header_page[kPageSize] = {};
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = FORMAT_VERSION;
+    header.instruction_record_size = sizeof(PackedInstruction);
+    header.content_hash = content_hash;
+    header.source_size = source_size;
+    header.chunk_count = CHUNK_COUNT;
+    std::memcpy(header_page, &header, sizeof(header));
+    std::memcpy(header_page + sizeof(header), layout.data(), sizeof(ChunkTable));
+    
+    ok = ok && write_all(fd, header_page, sizeof(header_page), 0) &&
+         ftruncate(fd, static_cast<off_t>(offset)) == 0 && fdatasync(fd) == 0;
+    ::close(fd);
+    
+    if (!ok || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        last_error = "Failed to write analysis database: " + path + " (" + std::strerror(errno) + ")";
+        std::remove(temporary_path.c_str());
+        return false;
+    }
+    
+    last_written_chunks = written_chunks;
+    return true;
+}
+
+bool AnalysisDatabase::write_changed(int fd, ChunkTable& on_disk) {
+    off_t file_end = lseek(fd, 0, SEEK_END);
+    if (file_end < 0) {
+        return false;
+    }
+    
+    // Decide where every changed chunk goes: its old slot when it still fits,
+    // otherwise a new slot at the end of the file
+    ChunkTable updated = on_disk;
+    uint64_t append_offset = align_to_page(static_cast<uint64_t>(file_end));
+    std::vector<size_t> changed;
+    for (size_t slot = 0; slot < CHUNK_COUNT; ++slot) {
+        if (!has_pending[slot]) {
+            continue;
+        }
+        
+        const std::vector<uint8_t>& bytes = pending[slot];
+        uint64_t checksum = hash_bytes(bytes);
+        ChunkEntry& entry = updated[slot];
+        if (entry.offset != 0 && entry.size == bytes.size() && entry.checksum == checksum) {
+            continue;
+        }
+        
+        if (entry.offset == 0 || bytes.size() > entry.capacity) {
+            entry.offset = append_offset;
+            entry.capacity = slot_capacity(bytes.size());
+            append_offset += entry.capacity;
+        }
+        entry.size = bytes.size();
+        entry.checksum = checksum;
+        changed.push_back(slot);
+    }
+    
+    if (changed.empty()) {
+        return true;
+    }
+    
+    // Retire the old entries before overwriting their bytes, so a crash in
+    // between leaves missing chunks rather than mismatched ones
+    ChunkTable retired = on_disk;
+    for (size_t slot : changed) {
+        retired[slot] = ChunkEntry{};
+    }
+    if (!write_all(fd, retired.data(), sizeof(ChunkTable), sizeof(FileHeader)) || fdatasync(fd) != 0) {
+        return false;
+    }
+    
+    for (size_t slot : changed) {
+        if (!write_all(fd, pending[slot].data(), pending[slot].size(), updated[slot].offset)) {
+            return false;
+        }
+    }
+    if (append_offset > static_cast<uint64_t>(file_end) && ftruncate(fd, static_cast<off_t>(append_offset)) != 0) {
+        return false;
+    }
+    if (fdatasync(fd) != 0 ||
+        !write_all(fd, updated.data(), sizeof(ChunkTable), sizeof(FileHeader)) || fdatasync(fd) != 0) {
+        return false;
+    }
+    
+    on_disk = updated;
+    last_written_chunks = changed.size();
+    return true;
+}
+
+size_t AnalysisDatabase::get_last_written_chunks() const {
+    return last_written_chunks;
+}
+
+std::string AnalysisDatabase::get_last_error() const {
+    return last_error;
+}
+
+} // namespace debugger 
\ No newline at end of file
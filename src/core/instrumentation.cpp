@@ -0,0 +1,311 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unistd.h>
+
+namespace debugger {
+namespace perf {
+
+namespace {
+
+constexpr size_t kMaxProbes = 256;
+constexpr size_t kTraceCapacity = 8192;         // spans kept per live thread
+constexpr size_t kRetiredTraceCapacity = 65536;  // and in total from exited ones
+
+struct ProbeInfo {
+    std::string name;
+    std::string category;
+    ProbeKind kind;
+};
+
+struct Span {
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint32_t probe;
+    uint32_t thread;
+};
+
+// Written only by its owner; atomics just make the readers' loads legal
+struct TraceSlot {
+    std::atomic<uint64_t> start_ns;
+    std::atomic<uint64_t> duration_ns;
+    std::atomic<uint32_t> probe;
+};
+
+struct ThreadBlock {
+    std::atomic<uint64_t> counts[kMaxProbes];
+    std::atomic<uint64_t> totals[kMaxProbes];
+    std::atomic<uint64_t> maxima[kMaxProbes];
+    TraceSlot trace[kTraceCapacity];
+    std::atomic<uint64_t> trace_head;  // spans ever written; the slot is head % capacity
+    uint32_t thread_index;
+    std::string thread_name;  // Registry mutex
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ProbeInfo> probes;
+    std::vector<ThreadBlock*> threads;
+    std::vector<std::pair<uint32_t, std::string>> thread_names;  // every thread ever named
+    uint32_t next_thread_index = 1;
+
+    // Totals of threads that have exited, and what reset() subtracts
+    uint64_t retired_counts[kMaxProbes] = {};
+    uint64_t retired_totals[kMaxProbes] = {};
+    uint64_t retired_maxima[kMaxProbes] = {};
+    uint64_t baseline_counts[kMaxProbes] = {};
+    uint64_t baseline_totals[kMaxProbes] = {};
+    std::deque<Span> retired_spans;
+};
+
+// Never destroyed: pool and tracer threads can still exit after statics are
+Registry& get_registry() {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Spans still in the ring, oldest first. The owner may be overwriting the
+// oldest slots while they are copied, so those are dropped afterwards.
+void copy_spans(const ThreadBlock& block, std::vector<Span>& out) {
+    uint64_t head = block.trace_head.load(std::memory_order_acquire);
+    uint64_t first = head > kTraceCapacity ? head - kTraceCapacity : 0;
+    size_t begin = out.size();
+    for (uint64_t i = first; i < head; ++i) {
+        const TraceSlot& slot = block.trace[i % kTraceCapacity];
+        out.push_back({slot.start_ns.load(std::memory_order_relaxed), slot.duration_ns.load(std::memory_order_relaxed),
+                       slot.probe.load(std::memory_order_relaxed), block.thread_index});
+    }
+    uint64_t head_after = block.trace_head.load(std::memory_order_acquire);
+    // The slot for index head_after may be half written as well
+    uint64_t valid_from = head_after + 1 > kTraceCapacity ? head_after + 1 - kTraceCapacity : 0;
+    if (valid_from > first) {
+        size_t stale = static_cast<size_t>(std::min<uint64_t>(valid_from - first, head - first));
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(begin),
+                  out.begin() + static_cast<std::ptrdiff_t>(begin + stale));
+    }
+}
+
+void retire_thread(ThreadBlock* block) {
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t i = 0; i < kMaxProbes; ++i) {
+        registry.retired_counts[i] += block->counts[i].load(std::memory_order_relaxed);
+        registry.retired_totals[i] += block->totals[i].load(std::memory_order_relaxed);
+        registry.retired_maxima[i] = std::max(registry.retired_maxima[i], block->maxima[i].load(std::memory_order_relaxed));
+    }
+    std::vector<Span> spans;
+    copy_spans(*block, spans);
+    registry.retired_spans.insert(registry.retired_spans.end(), spans.begin(), spans.end());
+    while (registry.retired_spans.size() > kRetiredTraceCapacity) {
+        registry.retired_spans.pop_front();
+    }
+    registry.threads.erase(std::remove(registry.threads.begin(), registry.threads.end(), block), registry.threads.end());
+    delete block;
+}
+
+// Created on a thread's first recording and folded into the retired totals
+// when the thread exits
+struct ThreadHandle {
+    ThreadBlock* block = nullptr;
+
+    ~ThreadHandle() {
+        if (block) {
+            retire_thread(block);
+        }
+    }
+};
+
+thread_local ThreadHandle current_thread;
+
+ThreadBlock& get_thread_block() {
+    if (!current_thread.block) {
+        // Value-initialised, so every counter and slot starts at zero
+        ThreadBlock* block = new ThreadBlock();
+        Registry& registry = get_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        block->thread_index = registry.next_thread_index++;
+        registry.threads.push_back(block);
+        current_thread.block = block;
+    }
+    return *current_thread.block;
+}
+
+void sum_totals(Registry& registry, uint64_t* counts, uint64_t* totals, uint64_t* maxima) {
+    for (size_t i = 0; i < kMaxProbes; ++i) {
+        counts[i] = registry.retired_counts[i];
+        totals[i] = registry.retired_totals[i];
+        maxima[i] = registry.retired_maxima[i];
+    }
+    for (const ThreadBlock* block : registry.threads) {
+        for (size_t i = 0; i < kMaxProbes; ++i) {
+            counts[i] += block->counts[i].load(std::memory_order_relaxed);
+            totals[i] += block->totals[i].load(std::memory_order_relaxed);
+            maxima[i] = std::max(maxima[i], block->maxima[i].load(std::memory_order_relaxed));
+        }
+    }
+}
+
+std::string escape_json(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            escaped += buffer;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+uint32_t register_probe(const std::string& name, const char* category, ProbeKind kind) {
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t i = 0; i < registry.probes.size(); ++i) {
+        if (registry.probes[i].name == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    if (registry.probes.size() + 1 >= kMaxProbes) {
+        if (registry.probes.size() + 1 == kMaxProbes) {
+            registry.probes.push_back({"(other probes)", "instrumentation", kind});
+        }
+        return static_cast<uint32_t>(kMaxProbes - 1);
+    }
+    registry.probes.push_back({name, category, kind});
+    return static_cast<uint32_t>(registry.probes.size() - 1);
+}
+
+void record_time(uint32_t probe, uint64_t start_ns, uint64_t duration_ns) {
+    ThreadBlock& block = get_thread_block();
+    bump(block.counts[probe], 1);
+    bump(block.totals[probe], duration_ns);
+    if (duration_ns > block.maxima[probe].load(std::memory_order_relaxed)) {
+        block.maxima[probe].store(duration_ns, std::memory_order_relaxed);
+    }
+
+    uint64_t head = block.trace_head.load(std::memory_order_relaxed);
+    TraceSlot& slot = block.trace[head % kTraceCapacity];
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.duration_ns.store(duration_ns, std::memory_order_relaxed);
+    slot.probe.store(probe, std::memory_order_relaxed);
+    block.trace_head.store(head + 1, std::memory_order_release);
+}
+
+void add_count(uint32_t probe, uint64_t value) {
+    ThreadBlock& block = get_thread_block();
+    bump(block.counts[probe], 1);
+    bump(block.totals[probe], value);
+}
+
+void set_thread_name(const std::string& name) {
+    ThreadBlock& block = get_thread_block();
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    block.thread_name = name;
+    registry.thread_names.emplace_back(block.thread_index, name);
+}
+
+std::vector<ProbeStats> snapshot() {
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint64_t counts[kMaxProbes];
+    uint64_t totals[kMaxProbes];
+    uint64_t maxima[kMaxProbes];
+    sum_totals(registry, counts, totals, maxima);
+
+    std::vector<ProbeStats> stats;
+    stats.reserve(registry.probes.size());
+    for (size_t i = 0; i < registry.probes.size(); ++i) {
+        const ProbeInfo& probe = registry.probes[i];
+        // A thread can be between its two stores; never show a negative delta
+        uint64_t count = counts[i] > registry.baseline_counts[i] ? counts[i] - registry.baseline_counts[i] : 0;
+        uint64_t total = totals[i] > registry.baseline_totals[i] ? totals[i] - registry.baseline_totals[i] : 0;
+        stats.push_back({probe.name, probe.category, probe.kind, count, total, maxima[i]});
+    }
+    return stats;
+}
+
+void reset() {
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint64_t maxima[kMaxProbes];
+    sum_totals(registry, registry.baseline_counts, registry.baseline_totals, maxima);
+    std::fill(std::begin(registry.retired_maxima), std::end(registry.retired_maxima), 0);
+    for (ThreadBlock* block : registry.threads) {
+        for (auto& maximum : block->maxima) {
+            maximum.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool export_chrome_trace(const std::string& path, std::string& error) {
+    std::vector<Span> spans;
+    std::vector<ProbeInfo> probes;
+    std::vector<std::pair<uint32_t, std::string>> thread_names;
+    {
+        Registry& registry = get_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        spans.assign(registry.retired_spans.begin(), registry.retired_spans.end());
+        for (const ThreadBlock* block : registry.threads) {
+            copy_spans(*block, spans);
+        }
+        probes = registry.probes;
+        thread_names = registry.thread_names;
+    }
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.start_ns < b.start_ns; });
+
+    // Timestamps are microseconds; the fraction keeps nanosecond spans visible
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    int pid = static_cast<int>(getpid());
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& thread : thread_names) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << thread.first
+            << ",\"args\":{\"name\":\"" << escape_json(thread.second) << "\"}}";
+    }
+    for (const Span& span : spans) {
+        if (span.probe >= probes.size()) {
+            continue;
+        }
+        const ProbeInfo& probe = probes[span.probe];
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"" << escape_json(probe.name) << "\",\"cat\":\"" << escape_json(probe.category)
+            << "\",\"ph\":\"X\",\"ts\":" << span.start_ns / 1000.0 << ",\"dur\":" << span.duration_ns / 1000.0
+            << ",\"pid\":" << pid << ",\"tid\":" << span.thread << "}";
+    }
+    out << "\n]}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !(file << out.str())) {
+        error = "Cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace perf
+} // namespace debugger
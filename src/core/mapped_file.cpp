@@ -0,0 +1,102 @@
+#include "mapped_file.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+namespace debugger {
+
+MappedFile::MappedFile() : mapping(nullptr), mapping_size(0) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mapping(other.mapping), mapping_size(other.mapping_size), last_error(std::move(other.last_error)) {
+    other.mapping = nullptr;
+    other.mapping_size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        mapping = other.mapping;
+        mapping_size = other.mapping_size;
+        last_error = std::move(other.last_error);
+        other.mapping = nullptr;
+        other.mapping_size = 0;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    last_error.clear();
+    
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        last_error = "Failed to open file: " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        last_error = "Failed to stat file: " + path;
+        ::close(fd);
+        return false;
+    }
+    
+    if (st.st_size == 0) {
+        // mmap rejects zero-length mappings
+        last_error = "File is empty: " + path;
+        ::close(fd);
+        return false;
+    }
+    
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    
+    if (addr == MAP_FAILED) {
+        last_error = "Failed to map file: " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    
+    mapping = static_cast<const uint8_t*>(addr);
+    mapping_size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping) {
+        munmap(const_cast<uint8_t*>(mapping), mapping_size);
+    }
+    mapping = nullptr;
+    mapping_size = 0;
+}
+
+bool MappedFile::is_open() const {
+    return mapping != nullptr;
+}
+
+ByteView MappedFile::view() const {
+    return ByteView(mapping, mapping_size);
+}
+
+ByteView MappedFile::view(uint64_t offset, uint64_t size) const {
+    return view().subview(static_cast<size_t>(offset), static_cast<size_t>(size));
+}
+
+size_t MappedFile::size() const {
+    return mapping_size;
+}
+
+std::string MappedFile::get_last_error() const {
+    return last_error;
+}
+
+} // namespace debugger 
\ No newline at end of file
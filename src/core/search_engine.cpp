@@ -0,0 +1,523 @@
+#include "search_engine.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <future>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define SEARCH_ENGINE_SSE2 1
+#endif
+
+namespace debugger {
+
+namespace {
+
+constexpr size_t kMinByteChunk = 1024 * 1024;
+constexpr size_t kInstructionChunk = 64 * 1024;
+constexpr size_t kStringChunk = 16 * 1024;
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == ',';
+}
+
+char fold_case(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+std::string fold_case(std::string_view text) {
+    std::string folded(text);
+    std::transform(folded.begin(), folded.end(), folded.begin(), [](char c) { return fold_case(c); });
+    return folded;
+}
+
+// Needle already folded when the search isn't case sensitive
+bool contains(std::string_view haystack, const std::string& needle, bool case_sensitive) {
+    if (needle.empty()) {
+        return true;
+    }
+    if (case_sensitive) {
+        return haystack.find(needle) != std::string_view::npos;
+    }
+    return std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                       [](char a, char b) { return fold_case(a) == b; }) != haystack.end();
+}
+
+// Anchor occurrences in [first, last], each checked against the whole pattern
+void find_anchored(const uint8_t* data, size_t first, size_t last, const BytePattern& pattern,
+                   std::vector<size_t>& matches, size_t max_matches) {
+    const uint8_t* anchor = pattern.get_anchor();
+    const size_t length = pattern.get_anchor_length();
+    const size_t offset = pattern.get_anchor_offset();
+
+    auto check = [&](size_t position) {
+        if (std::memcmp(data + position, anchor, length) == 0 && pattern.matches(data + position - offset)) {
+            matches.push_back(position - offset);
+        }
+        return matches.size() < max_matches;
+    };
+
+    size_t position = first;
+    if (length == 1) {
+        // memchr is already vectorized by the C library
+        while (position <= last) {
+            const void* found = std::memchr(data + position, anchor[0], last - position + 1);
+            if (!found) {
+                return;
+            }
+            position = static_cast<size_t>(static_cast<const uint8_t*>(found) - data);
+            if (!check(position)) {
+                return;
+            }
+            ++position;
+        }
+        return;
+    }
+
+#ifdef SEARCH_ENGINE_SSE2
+    // Candidates have both the first and the last anchor byte in place;
+    // loads of the last byte end at position + length - 1 + 16, inside data
+    const __m128i first_byte = _mm_set1_epi8(static_cast<char>(anchor[0]));
+    const __m128i last_byte = _mm_set1_epi8(static_cast<char>(anchor[length - 1]));
+    while (position + 16 <= last + 1) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position + length - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(head, first_byte), _mm_cmpeq_epi8(tail, last_byte))));
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (!check(position + bit)) {
+                return;
+            }
+            mask &= mask - 1;
+        }
+        position += 16;
+    }
+    for (; position <= last; ++position) {
+        if (data[position] == anchor[0] && data[position + length - 1] == anchor[length - 1] && !check(position)) {
+            return;
+        }
+    }
+#else
+    // Boyer-Moore-Horspool on the anchor
+    size_t shift[256];
+    std::fill(shift, shift + 256, length);
+    for (size_t i = 0; i + 1 < length; ++i) {
+        shift[anchor[i]] = length - 1 - i;
+    }
+    while (position <= last) {
+        uint8_t tail = data[position + length - 1];
+        if (tail == anchor[length - 1] && !check(position)) {
+            return;
+        }
+        position += shift[tail];
+    }
+#endif
+}
+
+} // namespace
+
+bool BytePattern::parse(const std::string& text, std::string& error) {
+    values.clear();
+    masks.clear();
+
+    size_t i = 0;
+    while (i < text.size()) {
+        if (is_space(text[i])) {
+            ++i;
+            continue;
+        }
+        if (text.compare(i, 2, "0x") == 0 || text.compare(i, 2, "0X") == 0) {
+            i += 2;
+            continue;
+        }
+        // A lone "?" stands for a whole byte
+        if (text[i] == '?' && (i + 1 == text.size() || is_space(text[i + 1]))) {
+            values.push_back(0);
+            masks.push_back(0);
+            ++i;
+            continue;
+        }
+        if (i + 1 >= text.size() || is_space(text[i + 1])) {
+            error = "Incomplete byte at position " + std::to_string(i + 1);
+            return false;
+        }
+
+        uint8_t value = 0;
+        uint8_t mask = 0;
+        for (int nibble = 0; nibble < 2; ++nibble) {
+            char c = text[i + static_cast<size_t>(nibble)];
+            int shift = nibble == 0 ? 4 : 0;
+            if (c == '?') {
+                continue;
+            }
+            int digit = hex_value(c);
+            if (digit < 0) {
+                error = std::string("Invalid hex digit '") + c + "' at position " + std::to_string(i + nibble + 1);
+                return false;
+            }
+            value |= static_cast<uint8_t>(digit << shift);
+            mask |= static_cast<uint8_t>(0xf << shift);
+        }
+        values.push_back(value);
+        masks.push_back(mask);
+        i += 2;
+    }
+
+    if (values.empty()) {
+        error = "Empty byte pattern";
+        return false;
+    }
+
+    anchor_offset = 0;
+    anchor_length = 0;
+    for (size_t start = 0; start < masks.size();) {
+        size_t end = start;
+        while (end < masks.size() && masks[end] == 0xff) {
+            ++end;
+        }
+        if (end - start > anchor_length) {
+            anchor_offset = start;
+            anchor_length = end - start;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool BytePattern::matches(const uint8_t* data) const {
+    for (size_t i = 0; i < values.size(); ++i) {
+        if ((data[i] & masks[i]) != values[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void find_pattern(const uint8_t* data, size_t size, size_t begin, size_t end,
+                  const BytePattern& pattern, std::vector<size_t>& matches, size_t max_matches) {
+    const size_t length = pattern.size();
+    if (length == 0 || length > size || begin >= end || matches.size() >= max_matches) {
+        return;
+    }
+    size_t last_start = std::min(end - 1, size - length);
+    if (begin > last_start) {
+        return;
+    }
+
+    if (pattern.get_anchor_length() == 0) {
+        // Nothing fully specified to look for; every position is a candidate
+        for (size_t position = begin; position <= last_start && matches.size() < max_matches; ++position) {
+            if (pattern.matches(data + position)) {
+                matches.push_back(position);
+            }
+        }
+        return;
+    }
+
+    size_t offset = pattern.get_anchor_offset();
+    find_anchored(data, begin + offset, last_start + offset, pattern, matches, max_matches);
+}
+
+void SearchEngine::set_image(std::shared_ptr<const ElfParser> image) {
+    parser = std::move(image);
+}
+
+void SearchEngine::set_instructions(std::shared_ptr<const DisassemblyBuffer> listing) {
+    instructions = std::move(listing);
+}
+
+void SearchEngine::set_strings(std::shared_ptr<const std::vector<SectionStrings>> index) {
+    strings = std::move(index);
+}
+
+bool SearchEngine::has_source(SearchKind kind) const {
+    switch (kind) {
+        case SearchKind::BYTES: return parser != nullptr;
+        case SearchKind::INSTRUCTION: return instructions != nullptr;
+        case SearchKind::STRING: return strings != nullptr && parser != nullptr;
+    }
+    return false;
+}
+
+bool SearchEngine::search(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits,
+                          std::string& error) const {
+    if (!has_source(query.kind)) {
+        error = query.kind == SearchKind::BYTES ? "No binary loaded"
+              : query.kind == SearchKind::INSTRUCTION ? "Disassembly has not finished yet"
+              : "String scanning has not finished yet";
+        return false;
+    }
+    switch (query.kind) {
+        case SearchKind::BYTES: return search_bytes(query, pool, on_hits, error);
+        case SearchKind::INSTRUCTION: return search_instructions(query, pool, on_hits, error);
+        case SearchKind::STRING: return search_strings(query, pool, on_hits, error);
+    }
+    return false;
+}
+
+void SearchEngine::run_chunks(const std::vector<Chunk>& chunks, const ChunkSearch& search_chunk, size_t max_hits,
+                              ThreadPool& pool, const HitCallback& on_hits) const {
+    // Workers skip chunks not yet started once the search is over
+    std::atomic<bool> stop{false};
+    std::vector<std::future<std::vector<SearchHit>>> results;
+    results.reserve(chunks.size());
+    for (const Chunk& chunk : chunks) {
+        results.push_back(pool.submit([&stop, &search_chunk, chunk]() {
+            std::vector<SearchHit> hits;
+            if (!stop.load(std::memory_order_relaxed)) {
+                search_chunk(chunk, hits);
+            }
+            return hits;
+        }));
+    }
+
+    // Delivered in chunk order, so hits arrive sorted within each source
+    size_t delivered = 0;
+    for (auto& result : results) {
+        std::vector<SearchHit> hits = result.get();
+        if (stop || hits.empty()) {
+            continue;
+        }
+        if (hits.size() > max_hits - delivered) {
+            hits.resize(max_hits - delivered);
+        }
+        delivered += hits.size();
+        if (!on_hits(hits) || delivered >= max_hits) {
+            stop = true;
+        }
+    }
+}
+
+bool SearchEngine::search_bytes(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits,
+                                std::string& error) const {
+    BytePattern pattern;
+    if (!pattern.parse(query.text, error)) {
+        return false;
+    }
+
+    const std::vector<Section>& sections = parser->get_sections();
+    size_t total = 0;
+    for (const auto& section : sections) {
+        total += section.data.size();
+    }
+    size_t chunk_size = std::max(kMinByteChunk, total / (pool.get_thread_count() * 4 + 1));
+
+    // Chunks share no bytes: a match starting in one may extend into the next
+    std::vector<Chunk> chunks;
+    for (uint32_t s = 0; s < sections.size(); ++s) {
+        for (size_t begin = 0; begin < sections[s].data.size(); begin += chunk_size) {
+            chunks.push_back({s, begin, std::min(begin + chunk_size, sections[s].data.size())});
+        }
+    }
+
+    size_t max_hits = query.max_hits;
+    run_chunks(chunks, [&](const Chunk& chunk, std::vector<SearchHit>& hits) {
+        const Section& section = sections[chunk.source];
+        std::vector<size_t> matches;
+        find_pattern(section.data.data(), section.data.size(), chunk.begin, chunk.end, pattern, matches, max_hits);
+        hits.reserve(matches.size());
+        for (size_t position : matches) {
+            hits.push_back({section.address != 0 ? section.address + position : 0,
+                            section.file_offset + position,
+                            static_cast<uint32_t>(pattern.size()), chunk.source, 0});
+        }
+    }, max_hits, pool, on_hits);
+    return true;
+}
+
+bool SearchEngine::search_instructions(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits,
+                                       std::string& error) const {
+    std::string_view text = query.text;
+    while (!text.empty() && is_space(text.front())) text.remove_prefix(1);
+    while (!text.empty() && is_space(text.back())) text.remove_suffix(1);
+    if (text.empty()) {
+        error = "Empty instruction query";
+        return false;
+    }
+    size_t split = text.find_first_of(" \t");
+    std::string mnemonic(text.substr(0, split));
+    std::string operands;
+    if (split != std::string_view::npos) {
+        std::string_view rest = text.substr(split);
+        while (!rest.empty() && is_space(rest.front())) rest.remove_prefix(1);
+        operands = query.case_sensitive ? std::string(rest) : fold_case(rest);
+    }
+
+    // Mnemonics are interned, so the mnemonic part is matched once per
+    // distinct mnemonic rather than once per instruction. A trailing "*"
+    // matches a prefix: "j*" for every jump.
+    const DisassemblyBuffer& listing = *instructions;
+    bool prefix = !mnemonic.empty() && mnemonic.back() == '*';
+    if (prefix) {
+        mnemonic.pop_back();
+    }
+    if (!query.case_sensitive) {
+        mnemonic = fold_case(mnemonic);
+    }
+    std::vector<bool> wanted(listing.get_mnemonic_count(), false);
+    bool any = false;
+    for (size_t id = 0; id < wanted.size(); ++id) {
+        std::string name(listing.get_mnemonic_name(static_cast<uint16_t>(id)));
+        if (!query.case_sensitive) {
+            name = fold_case(name);
+        }
+        wanted[id] = prefix ? name.compare(0, mnemonic.size(), mnemonic) == 0 : name == mnemonic;
+        any = any || wanted[id];
+    }
+    if (!any) {
+        return true;
+    }
+
+    std::vector<Chunk> chunks;
+    for (size_t begin = 0; begin < listing.size(); begin += kInstructionChunk) {
+        chunks.push_back({0, begin, std::min(begin + kInstructionChunk, listing.size())});
+    }
+
+    bool case_sensitive = query.case_sensitive;
+    run_chunks(chunks, [&](const Chunk& chunk, std::vector<SearchHit>& hits) {
+        for (size_t i = chunk.begin; i < chunk.end; ++i) {
+            const PackedInstruction& insn = listing[i];
+            if (!wanted[insn.mnemonic_id] || !contains(listing.get_operands(insn), operands, case_sensitive)) {
+                continue;
+            }
+            uint64_t file_offset = parser ? parser->virtual_to_file_offset(insn.address) : ~0ull;
+            hits.push_back({insn.address, file_offset, insn.size, 0, i});
+        }
+    }, query.max_hits, pool, on_hits);
+    return true;
+}
+
+bool SearchEngine::search_strings(const SearchQuery& query, ThreadPool& pool, const HitCallback& on_hits,
+                                  std::string& error) const {
+    if (query.text.empty()) {
+        error = "Empty string query";
+        return false;
+    }
+    std::string needle = query.case_sensitive ? query.text : fold_case(query.text);
+
+    // Records only hold offsets; the text is decoded from the section bytes
+    std::vector<const Section*> owners;
+    std::vector<Chunk> chunks;
+    for (uint32_t s = 0; s < strings->size(); ++s) {
+        const SectionStrings& section_strings = (*strings)[s];
+        const Section* owner = nullptr;
+        for (const auto& section : parser->get_sections()) {
+            if (section.name == section_strings.section_name) {
+                owner = &section;
+                break;
+            }
+        }
+        owners.push_back(owner);
+        if (!owner) {
+            continue;
+        }
+        for (size_t begin = 0; begin < section_strings.records.size(); begin += kStringChunk) {
+            chunks.push_back({s, begin, std::min(begin + kStringChunk, section_strings.records.size())});
+        }
+    }
+
+    bool case_sensitive = query.case_sensitive;
+    run_chunks(chunks, [&](const Chunk& chunk, std::vector<SearchHit>& hits) {
+        const Section& section = *owners[chunk.source];
+        const std::vector<StringRecord>& records = (*strings)[chunk.source].records;
+        for (size_t i = chunk.begin; i < chunk.end; ++i) {
+            const StringRecord& record = records[i];
+            std::string text = StringScanner::to_string(section.data, section.file_offset, record);
+            if (!contains(text, needle, case_sensitive)) {
+                continue;
+            }
+            uint64_t position = record.offset - section.file_offset;
+            hits.push_back({section.address != 0 ? section.address + position : 0, record.offset,
+                            static_cast<uint32_t>(record.byte_size()), chunk.source, i});
+        }
+    }, query.max_hits, pool, on_hits);
+    return true;
+}
+
+const Section* SearchEngine::find_section(uint64_t file_offset) const {
+    if (!parser) {
+        return nullptr;
+    }
+    for (const auto& section : parser->get_sections()) {
+        if (!section.data.empty() && file_offset >= section.file_offset &&
+            file_offset - section.file_offset < section.data.size()) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+std::string SearchEngine::get_section_name(SearchKind kind, const SearchHit& hit) const {
+    switch (kind) {
+        case SearchKind::BYTES:
+            return parser && hit.section < parser->get_sections().size() ? parser->get_sections()[hit.section].name : "";
+        case SearchKind::STRING:
+            return strings && hit.section < strings->size() ? (*strings)[hit.section].section_name : "";
+        case SearchKind::INSTRUCTION: {
+            const Section* section = find_section(hit.file_offset);
+            return section ? section->name : "";
+        }
+    }
+    return "";
+}
+
+std::string SearchEngine::describe(SearchKind kind, const SearchHit& hit) const {
+    constexpr size_t kMaxShownBytes = 32;
+
+    switch (kind) {
+        case SearchKind::BYTES: {
+            if (!parser) {
+                return "";
+            }
+            ByteView bytes = parser->get_file_range(hit.file_offset, std::min<size_t>(hit.length, kMaxShownBytes));
+            static const char digits[] = "0123456789abcdef";
+            std::string text;
+            for (uint8_t byte : bytes) {
+                if (!text.empty()) {
+                    text += ' ';
+                }
+                text += digits[byte >> 4];
+                text += digits[byte & 0xf];
+            }
+            return bytes.size() < hit.length ? text + " ..." : text;
+        }
+        case SearchKind::INSTRUCTION: {
+            if (!instructions || hit.index >= instructions->size()) {
+                return "";
+            }
+            const PackedInstruction& insn = (*instructions)[hit.index];
+            std::string text(instructions->get_mnemonic(insn));
+            std::string_view operands = instructions->get_operands(insn);
+            if (!operands.empty()) {
+                text += ' ';
+                text.append(operands.data(), operands.size());
+            }
+            return text;
+        }
+        case SearchKind::STRING: {
+            if (!strings || !parser || hit.section >= strings->size() || hit.index >= (*strings)[hit.section].records.size()) {
+                return "";
+            }
+            const StringRecord& record = (*strings)[hit.section].records[hit.index];
+            const Section* section = find_section(record.offset);
+            if (!section) {
+                return "";
+            }
+            std::string text = StringScanner::to_string(section->data, section->file_offset, record);
+            return record.encoding == StringEncoding::UTF16LE ? text + " (UTF-16)" : text;
+        }
+    }
+    return "";
+}
+
+} // namespace debugger
@@ -0,0 +1,62 @@
+#include "string_pool.h"
+#include <cstring>
+
+namespace debugger {
+
+StringPool::StringPool(size_t chunk_size)
+    : chunk_size(chunk_size), chunk_used(0), chunk_capacity(0), reserved_bytes(0) {
+}
+
+char* StringPool::allocate(size_t size) {
+    if (chunks.empty() || chunk_capacity - chunk_used < size) {
+        // Oversized strings get a chunk of their own
+        size_t capacity = size > chunk_size ? size : chunk_size;
+        chunks.emplace_back(new char[capacity]);
+        chunk_capacity = capacity;
+        chunk_used = 0;
+        reserved_bytes += capacity;
+    }
+    
+    char* ptr = chunks.back().get() + chunk_used;
+    chunk_used += size;
+    return ptr;
+}
+
+std::string_view StringPool::intern(std::string_view str) {
+    auto it = index.find(str);
+    if (it != index.end()) {
+        return *it;
+    }
+    
+    char* storage = allocate(str.size() + 1);
+    if (!str.empty()) {
+        std::memcpy(storage, str.data(), str.size());
+    }
+    storage[str.size()] = '\0';
+    
+    std::string_view interned(storage, str.size());
+    index.insert(interned);
+    return interned;
+}
+
+bool StringPool::contains(std::string_view str) const {
+    return index.find(str) != index.end();
+}
+
+void StringPool::clear() {
+    index.clear();
+    chunks.clear();
+    chunk_used = 0;
+    chunk_capacity = 0;
+    reserved_bytes = 0;
+}
+
+size_t StringPool::size() const {
+    return index.size();
+}
+
+size_t StringPool::memory_usage() const {
+    return reserved_bytes;
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include "string_scanner.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <future>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define STRING_SCANNER_SSE2 1
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STRING_SCANNER_AVX2 1
+#endif
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define STRING_SCANNER_NEON 1
+#endif
+
+namespace debugger {
+
+namespace {
+
+constexpr size_t kBlockSize = 64;
+constexpr size_t kMinParallelChunk = 1024 * 1024;
+
+// One bit per byte of a 64-byte block
+struct BlockMasks {
+    uint64_t printable;
+    uint64_t zero;
+};
+
+using ClassifyFunction = BlockMasks (*)(const uint8_t* block);
+
+inline bool is_printable(uint8_t byte) {
+    return byte >= 0x20 && byte <= 0x7e;
+}
+
+inline unsigned count_trailing_zeros(uint64_t value) {
+    return static_cast<unsigned>(__builtin_ctzll(value));
+}
+
+// Handles the final partial block too; bits past count stay clear
+BlockMasks classify_scalar(const uint8_t* block, size_t count) {
+    BlockMasks masks{0, 0};
+    for (size_t i = 0; i < count; ++i) {
+        masks.printable |= static_cast<uint64_t>(is_printable(block[i])) << i;
+        masks.zero |= static_cast<uint64_t>(block[i] == 0) << i;
+    }
+    return masks;
+}
+
+#if !defined(STRING_SCANNER_SSE2) && !defined(STRING_SCANNER_NEON)
+// Only the classifier when neither SSE2 nor NEON is available
+BlockMasks classify_scalar_block(const uint8_t* block) {
+    return classify_scalar(block, kBlockSize);
+}
+#endif
+
+#ifdef STRING_SCANNER_SSE2
+BlockMasks classify_sse2(const uint8_t* block) {
+    // Signed compares: bytes >= 0x80 are negative and fail the lower bound
+    const __m128i lower = _mm_set1_epi8(0x1f);
+    const __m128i upper = _mm_set1_epi8(0x7f);
+    const __m128i zero = _mm_setzero_si128();
+    
+    BlockMasks masks{0, 0};
+    for (int lane = 0; lane < 4; ++lane) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+        __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(bytes, lower), _mm_cmplt_epi8(bytes, upper));
+        masks.printable |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(printable))) << (lane * 16);
+        masks.zero |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)))) << (lane * 16);
+    }
+    return masks;
+}
+#endif
+
+#ifdef STRING_SCANNER_AVX2
+__attribute__((target("avx2")))
+BlockMasks classify_avx2(const uint8_t* block) {
+    const __m256i lower = _mm256_set1_epi8(0x1f);
+    const __m256i upper = _mm256_set1_epi8(0x7f);
+    const __m256i zero = _mm256_setzero_si256();
+    
+    BlockMasks masks{0, 0};
+    for (int lane = 0; lane < 2; ++lane) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + lane * 32));
+        __m256i printable = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, lower), _mm256_cmpgt_epi8(upper, bytes));
+        masks.printable |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(printable))) << (lane * 32);
+        masks.zero |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, zero)))) << (lane * 32);
+    }
+    return masks;
+}
+#endif
+
+#ifdef STRING_SCANNER_NEON
+// NEON has no movemask; weight each lane by its bit and add across halves
+inline uint64_t neon_movemask(uint8x16_t lanes) {
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t bits = vandq_u8(lanes, vld1q_u8(weights));
+    return static_cast<uint64_t>(vaddv_u8(vget_low_u8(bits))) |
+           (static_cast<uint64_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+
+BlockMasks classify_neon(const uint8_t* block) {
+    const uint8x16_t lower = vdupq_n_u8(0x20);
+    const uint8x16_t upper = vdupq_n_u8(0x7e);
+    
+    BlockMasks masks{0, 0};
+    for (int lane = 0; lane < 4; ++lane) {
+        uint8x16_t bytes = vld1q_u8(block + lane * 16);
+        uint8x16_t printable = vandq_u8(vcgeq_u8(bytes, lower), vcleq_u8(bytes, upper));
+        masks.printable |= neon_movemask(printable) << (lane * 16);
+        masks.zero |= neon_movemask(vceqzq_u8(bytes)) << (lane * 16);
+    }
+    return masks;
+}
+#endif
+
+struct Classifier {
+    ClassifyFunction function;
+    const char* name;
+};
+
+Classifier select_classifier() {
+#ifdef STRING_SCANNER_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return {classify_avx2, "AVX2"};
+    }
+#endif
+#ifdef STRING_SCANNER_SSE2
+    return {classify_sse2, "SSE2"};
+#elif defined(STRING_SCANNER_NEON)
+    return {classify_neon, "NEON"};
+#else
+    return {classify_scalar_block, "scalar"};
+#endif
+}
+
+const Classifier& get_classifier() {
+    static const Classifier classifier = select_classifier();
+    return classifier;
+}
+
+// Open UTF-16 run for one byte parity
+struct WideRun {
+    bool open = false;
+    bool owned = true;
+    size_t start = 0;
+    size_t next = 0;  // position where the next character would begin
+};
+
+} // namespace
+
+StringScanner::StringScanner(size_t min_length, bool detect_utf16)
+    : min_length(std::max<size_t>(min_length, 1)), detect_utf16(detect_utf16) {
+}
+
+void StringScanner::scan(const uint8_t* data, size_t size, uint64_t base_offset,
+                         std::vector<StringRecord>& out) const {
+    scan_range(data, size, 0, size, base_offset, out);
+}
+
+std::vector<StringRecord> StringScanner::scan(ByteView data, uint64_t base_offset) const {
+    std::vector<StringRecord> records;
+    scan(data.data(), data.size(), base_offset, records);
+    return records;
+}
+
+void StringScanner::scan_range(const uint8_t* data, size_t size, size_t begin, size_t end,
+                               uint64_t base_offset, std::vector<StringRecord>& out) const {
+    // Reports runs that start in [begin, end); a run crossing end is followed
+    // to its conclusion, and one already running at begin belongs to the
+    // chunk before
+    const ClassifyFunction classify = get_classifier().function;
+    const size_t first_record = out.size();
+    
+    auto emit = [&](size_t start, size_t characters, StringEncoding encoding) {
+        if (characters >= min_length) {
+            uint32_t length = static_cast<uint32_t>(std::min<size_t>(characters, UINT32_MAX));
+            out.push_back({base_offset + start, length, encoding});
+        }
+    };
+    auto is_wide_char = [data, size](size_t position) {
+        return position + 1 < size && is_printable(data[position]) && data[position + 1] == 0;
+    };
+    
+    bool ascii_open = false;
+    bool ascii_owned = true;
+    size_t ascii_start = 0;
+    bool skip_ascii_at_begin = begin > 0 && is_printable(data[begin - 1]);
+    
+    WideRun wide[2];
+    size_t wide_continuation[2] = {SIZE_MAX, SIZE_MAX};
+    for (size_t position = begin; position < begin + 2; ++position) {
+        if (position >= 2 && position - 2 < begin && is_wide_char(position - 2)) {
+            wide_continuation[position & 1] = position;
+        }
+    }
+    
+    size_t block = begin;
+    for (; block < size; block += kBlockSize) {
+        size_t count = std::min(kBlockSize, size - block);
+        if (block >= end && !ascii_open && !wide[0].open && !wide[1].open) {
+            break;
+        }
+        
+        BlockMasks masks = count == kBlockSize ? classify(data + block) : classify_scalar(data + block, count);
+        uint64_t printable = masks.printable;
+        
+        // ASCII: alternate between finding the next printable and the next
+        // non-printable bit
+        for (size_t pos = 0; pos < count;) {
+            if (ascii_open) {
+                uint64_t rest = ~printable >> pos;
+                if (rest == 0) {
+                    break; // Run continues into the next block
+                }
+                pos += count_trailing_zeros(rest);
+                if (ascii_owned) {
+                    emit(ascii_start, block + pos - ascii_start, StringEncoding::ASCII);
+                }
+                ascii_open = false;
+            } else {
+                uint64_t rest = printable >> pos;
+                if (rest == 0) {
+                    break;
+                }
+                pos += count_trailing_zeros(rest);
+                if (block + pos >= end) {
+                    break;
+                }
+                ascii_open = true;
+                ascii_start = block + pos;
+                ascii_owned = !(skip_ascii_at_begin && ascii_start == begin);
+            }
+        }
+        
+        if (!detect_utf16) {
+            continue;
+        }
+        
+        // UTF-16LE: a character starts wherever a printable byte is followed
+        // by a zero byte; runs are chains of those two bytes apart
+        uint64_t next_zero = (count == kBlockSize && block + kBlockSize < size && data[block + kBlockSize] == 0) ? 1 : 0;
+        uint64_t wide_chars = printable & ((masks.zero >> 1) | (next_zero << 63));
+        uint64_t valid = count == kBlockSize ? ~0ULL : ((1ULL << count) - 1);
+        
+        for (size_t parity = 0; parity < 2; ++parity) {
+            size_t base_pos = ((block & 1) == parity) ? 0 : 1;
+            uint64_t parity_mask = base_pos == 0 ? 0x5555555555555555ULL : 0xAAAAAAAAAAAAAAAAULL;
+            uint64_t starts = wide_chars & parity_mask;
+            uint64_t breaks = ~wide_chars & parity_mask & valid;
+            WideRun& run = wide[parity];
+            
+            for (size_t pos = base_pos; pos < count;) {
+                if (run.open) {
+                    uint64_t rest = breaks >> pos;
+                    if (rest == 0) {
+                        break;
+                    }
+                    pos += count_trailing_zeros(rest);
+                    if (run.owned) {
+                        emit(run.start, (block + pos - run.start) / 2, StringEncoding::UTF16LE);
+                    }
+                    run.open = false;
+                } else {
+                    uint64_t rest = starts >> pos;
+                    if (rest == 0) {
+                        break;
+                    }
+                    pos += count_trailing_zeros(rest);
+                    if (block + pos >= end) {
+                        break;
+                    }
+                    run.open = true;
+                    run.start = block + pos;
+                    run.owned = run.start != wide_continuation[parity];
+                }
+            }
+            
+            // First position of this parity past the block
+            run.next = block + base_pos + ((count - base_pos + 1) / 2) * 2;
+        }
+    }
+    
+    // Close whatever reached the end of the data
+    if (ascii_open && ascii_owned) {
+        emit(ascii_start, size - ascii_start, StringEncoding::ASCII);
+    }
+    for (const WideRun& run : wide) {
+        if (run.open && run.owned) {
+            emit(run.start, (run.next - run.start) / 2, StringEncoding::UTF16LE);
+        }
+    }
+    
+    // ASCII and UTF-16 runs were emitted as they closed; restore offset order
+    std::sort(out.begin() + first_record, out.end(), [](const StringRecord& a, const StringRecord& b) {
+        return a.offset < b.offset;
+    });
+}
+
+std::vector<std::vector<StringRecord>> StringScanner::scan_regions(const std::vector<ScanRegion>& regions,
+                                                                   ThreadPool& pool,
+                                                                   const CancelCheck& cancelled) const {
+    PERF_SCOPE("StringScanner::scan_regions", "analysis");
+    size_t total = 0;
+    for (const auto& region : regions) {
+        total += region.data.size();
+    }
+    size_t chunk_size = std::max(kMinParallelChunk, total / (pool.get_thread_count() * 4 + 1));
+    
+    // Every chunk of every region is queued at once so small sections do not
+    // serialize behind big ones
+    struct Chunk {
+        size_t region;
+        std::future<std::vector<StringRecord>> records;
+    };
+    std::vector<Chunk> chunks;
+    
+    for (size_t r = 0; r < regions.size(); ++r) {
+        const ScanRegion& region = regions[r];
+        for (size_t begin = 0; begin < region.data.size(); begin += chunk_size) {
+            size_t end = std::min(begin + chunk_size, region.data.size());
+            chunks.push_back({r, pool.submit([this, &region, &cancelled, begin, end]() {
+                std::vector<StringRecord> records;
+                if (cancelled && cancelled()) {
+                    return records;
+                }
+                scan_range(region.data.data(), region.data.size(), begin, end, region.base_offset, records);
+                return records;
+            })});
+        }
+    }
+    
+    // Chunks are in offset order within each region, so concatenation keeps it
+    std::vector<std::vector<StringRecord>> results(regions.size());
+    for (auto& chunk : chunks) {
+        std::vector<StringRecord> records = chunk.records.get();
+        auto& target = results[chunk.region];
+        target.insert(target.end(), records.begin(), records.end());
+    }
+    return results;
+}
+
+std::string StringScanner::to_string(ByteView data, uint64_t base_offset, const StringRecord& record) {
+    if (record.offset < base_offset || record.offset - base_offset + record.byte_size() > data.size()) {
+        return std::string();
+    }
+    
+    const uint8_t* text = data.data() + (record.offset - base_offset);
+    if (record.encoding == StringEncoding::ASCII) {
+        return std::string(reinterpret_cast<const char*>(text), record.length);
+    }
+    
+    std::string result(record.length, '\0');
+    for (size_t i = 0; i < record.length; ++i) {
+        result[i] = static_cast<char>(text[i * 2]);
+    }
+    return result;
+}
+
+const char* StringScanner::get_implementation_name() {
+    return get_classifier().name;
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -1,264 +1,529 @@
+#include "symbol_table.h"
+#include "elf_parser.h"
 #include <string>
-#include <map>
 #include <vector>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <numeric>
+#include <optional>
 #include <iostream>
 
 namespace debugger {
 
-class SymbolTable {
-public:
-    struct SymbolInfo {
-        std::string name;
-        uint64_t address;
-        uint64_t size;
-        std::string type;
-        std::string section;
-        bool is_function;
-        bool is_global;
-    };
+namespace {
 
-    bool load_symbols(const std::string& filename) {
-        clear();
-        
-        // Try to load symbols from different formats
-        if (load_elf_symbols(filename)) {
-            symbol_file = filename;
-            return true;
-        }
-        
-        // Fallback to text symbol file format
-        if (load_text_symbols(filename)) {
-            symbol_file = filename;
-            return true;
+// Hashed trigram buckets; collisions only cost extra candidates to verify
+constexpr uint32_t kTrigramBuckets = 1u << 16;
+// Bound on the backwards walk for nested or overlapping symbols
+constexpr size_t kMaxCoverCandidates = 64;
+
+inline unsigned char fold(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+}
+
+inline uint32_t trigram_bucket(unsigned char a, unsigned char b, unsigned char c) {
+    uint32_t key = (static_cast<uint32_t>(fold(a)) << 16) | (static_cast<uint32_t>(fold(b)) << 8) | fold(c);
+    return (key * 2654435761u) >> 16;
+}
+
+inline uint64_t char_mask(std::string_view text) {
+    uint64_t mask = 0;
+    for (unsigned char c : text) mask |= 1ULL << (fold(c) & 63);
+    return mask;
+}
+
+// Position of needle (already folded) in haystack, ignoring case, or npos
+size_t find_folded(std::string_view haystack, std::string_view needle) {
+    if (needle.empty()) return 0;
+    if (needle.size() > haystack.size()) return std::string_view::npos;
+    unsigned char first = static_cast<unsigned char>(needle[0]);
+    size_t last = haystack.size() - needle.size();
+    for (size_t i = 0; i <= last; ++i) {
+        if (fold(static_cast<unsigned char>(haystack[i])) != first) continue;
+        size_t j = 1;
+        while (j < needle.size() && fold(static_cast<unsigned char>(haystack[i + j])) == static_cast<unsigned char>(needle[j])) ++j;
+        if (j == needle.size()) return i;
+    }
+    return std::string_view::npos;
+}
+
+// Subsequence match of needle (folded) in haystack. Consecutive runs and
+// matches at word starts score higher, long names lower; the score may go
+// negative, so a name that doesn't match at all gets nullopt instead.
+std::optional<int> fuzzy_score(std::string_view haystack, std::string_view needle) {
+    int score = 0;
+    int run = 0;
+    size_t j = 0;
+    for (size_t i = 0; i < haystack.size() && j < needle.size(); ++i) {
+        unsigned char c = fold(static_cast<unsigned char>(haystack[i]));
+        if (c != static_cast<unsigned char>(needle[j])) {
+            run = 0;
+            continue;
         }
-        
-        return false;
+        bool word_start = i == 0 || haystack[i - 1] == '_' || haystack[i - 1] == ':' || haystack[i - 1] == '.' ||
+                          (haystack[i] >= 'A' && haystack[i] <= 'Z' && haystack[i - 1] >= 'a' && haystack[i - 1] <= 'z');
+        score += 1 + run * 4 + (word_start ? 6 : 0);
+        ++run;
+        ++j;
+    }
+    if (j != needle.size()) return std::nullopt;
+    return score * 8 - static_cast<int>(std::min<size_t>(haystack.size(), 400));
+}
+
+} // namespace
+
+SymbolTable::SymbolTable() : built(true) {
+}
+
+bool SymbolTable::load_symbols(const std::string& filename) {
+    clear();
+    
+    // Try to load symbols from different formats
+    if (load_elf_symbols(filename)) {
+        symbol_file = filename;
+        return true;
     }
     
-    std::string lookup_symbol(uint64_t address) {
-        // Direct address lookup
-        auto direct_it = address_to_symbol.find(address);
-        if (direct_it != address_to_symbol.end()) {
-            return direct_it->second;
-        }
-        
-        // Find closest symbol before this address
-        auto it = address_to_symbol.upper_bound(address);
-        if (it != address_to_symbol.begin()) {
-            --it;
-            
-            // Check if address falls within symbol range
-            auto symbol_it = symbol_info.find(it->second);
-            if (symbol_it != symbol_info.end()) {
-                uint64_t symbol_start = it->first;
-                uint64_t symbol_end = symbol_start + symbol_it->second.size;
-                
-                if (address >= symbol_start && address < symbol_end) {
-                    uint64_t offset = address - symbol_start;
-                    if (offset == 0) {
-                        return it->second;
-                    } else {
-                        return it->second + "+" + std::to_string(offset);
-                    }
-                }
+    // Fallback to text symbol file format
+    if (load_text_symbols(filename)) {
+        symbol_file = filename;
+        return true;
+    }
+    
+    return false;
+}
+
+size_t SymbolTable::add_elf_symbols(const ElfParser& elf, uint64_t bias) {
+    size_t added = 0;
+    for (const Symbol& symbol : elf.get_symbols()) {
+        if (symbol.name.empty() || symbol.address == 0 || symbol.is_imported) continue;
+        uint8_t symbol_flags = (symbol.is_function ? FUNCTION : 0) | (symbol.binding != "LOCAL" ? GLOBAL : 0);
+        append(symbol.name, symbol.address + bias, symbol.size, symbol.type, symbol.section_name, symbol_flags);
+        ++added;
+    }
+    return added;
+}
+
+void SymbolTable::add_symbol(const std::string& name, uint64_t address, uint64_t size,
+                             const std::string& type, bool is_function) {
+    append(name, address, size, type, "", (is_function ? FUNCTION : 0) | GLOBAL);
+}
+
+void SymbolTable::append(std::string_view name, uint64_t address, uint64_t size, std::string_view type,
+                         std::string_view section, uint8_t symbol_flags) {
+    names.push_back(strings.intern(name));
+    addresses.push_back(address);
+    sizes.push_back(size);
+    types.push_back(strings.intern(type));
+    sections.push_back(strings.intern(section));
+    flags.push_back(symbol_flags);
+    char_masks.push_back(char_mask(name));
+    built = false;
+}
+
+void SymbolTable::clear() {
+    addresses.clear();
+    sizes.clear();
+    names.clear();
+    types.clear();
+    sections.clear();
+    flags.clear();
+    char_masks.clear();
+    strings.clear();
+    by_name.clear();
+    trigram_offsets.clear();
+    trigram_postings.clear();
+    symbol_file.clear();
+    built = true;
+}
+
+size_t SymbolTable::size() const {
+    return addresses.size();
+}
+
+void SymbolTable::ensure_built() {
+    if (built) return;
+    sort_by_address();
+    build_name_index();
+    build_trigram_index();
+    built = true;
+}
+
+void SymbolTable::sort_by_address() {
+    std::vector<uint32_t> order(addresses.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return addresses[a] < addresses[b]; });
+    
+    // Apply the permutation column by column. The same symbol often comes
+    // from both .symtab and .dynsym; interned names make that a pointer compare.
+    std::vector<uint32_t> kept;
+    kept.reserve(order.size());
+    for (uint32_t index : order) {
+        bool duplicate = false;
+        for (size_t k = kept.size(); k-- > 0 && addresses[kept[k]] == addresses[index];) {
+            if (names[kept[k]].data() == names[index].data()) {
+                duplicate = true;
+                break;
             }
         }
-        
-        return "";
+        if (!duplicate) kept.push_back(index);
     }
     
-    uint64_t lookup_address(const std::string& symbol) {
-        auto it = symbol_to_address.find(symbol);
-        if (it != symbol_to_address.end()) {
-            return it->second;
+    auto permute = [&kept](auto& column) {
+        std::remove_reference_t<decltype(column)> sorted;
+        sorted.reserve(kept.size());
+        for (uint32_t index : kept) sorted.push_back(column[index]);
+        column.swap(sorted);
+    };
+    permute(addresses);
+    permute(sizes);
+    permute(names);
+    permute(types);
+    permute(sections);
+    permute(flags);
+    permute(char_masks);
+}
+
+void SymbolTable::build_name_index() {
+    by_name.resize(names.size());
+    std::iota(by_name.begin(), by_name.end(), 0);
+    std::sort(by_name.begin(), by_name.end(), [this](uint32_t a, uint32_t b) {
+        int order = names[a].data() == names[b].data() ? 0 : names[a].compare(names[b]);
+        return order != 0 ? order < 0 : a < b;
+    });
+}
+
+void SymbolTable::build_trigram_index() {
+    // Two passes over the names: count the postings per bucket, then fill
+    // them in symbol order so every list comes out sorted. A name lists
+    // each bucket once; last_seen says whether this name already did.
+    trigram_offsets.assign(kTrigramBuckets + 1, 0);
+    std::vector<uint32_t> last_seen(kTrigramBuckets, UINT32_MAX);
+    
+    for (uint32_t index = 0; index < names.size(); ++index) {
+        std::string_view name = names[index];
+        for (size_t i = 0; i + 2 < name.size(); ++i) {
+            uint32_t bucket = trigram_bucket(name[i], name[i + 1], name[i + 2]);
+            if (last_seen[bucket] == index) continue;
+            last_seen[bucket] = index;
+            ++trigram_offsets[bucket + 1];
         }
-        
-        // Try partial matching
-        for (const auto& pair : symbol_to_address) {
-            if (pair.first.find(symbol) != std::string::npos) {
-                return pair.second;
-            }
+    }
+    for (uint32_t i = 0; i < kTrigramBuckets; ++i) {
+        trigram_offsets[i + 1] += trigram_offsets[i];
+    }
+    
+    trigram_postings.resize(trigram_offsets[kTrigramBuckets]);
+    std::vector<uint32_t> cursor(trigram_offsets.begin(), trigram_offsets.end() - 1);
+    std::fill(last_seen.begin(), last_seen.end(), UINT32_MAX);
+    for (uint32_t index = 0; index < names.size(); ++index) {
+        std::string_view name = names[index];
+        for (size_t i = 0; i + 2 < name.size(); ++i) {
+            uint32_t bucket = trigram_bucket(name[i], name[i + 1], name[i + 2]);
+            if (last_seen[bucket] == index) continue;
+            last_seen[bucket] = index;
+            trigram_postings[cursor[bucket]++] = index;
         }
-        
-        return 0;
     }
+}
+
+bool SymbolTable::find_symbol(uint64_t address, uint32_t& index, uint64_t& offset) {
+    ensure_built();
     
-    void add_symbol(const std::string& name, uint64_t address, uint64_t size = 0, 
-                   const std::string& type = "", bool is_function = false) {
-        address_to_symbol[address] = name;
-        symbol_to_address[name] = address;
-        
-        SymbolInfo info;
-        info.name = name;
-        info.address = address;
-        info.size = size;
-        info.type = type;
-        info.is_function = is_function;
-        info.is_global = true;
-        
-        symbol_info[name] = info;
+    auto it = std::upper_bound(addresses.begin(), addresses.end(), address);
+    size_t position = static_cast<size_t>(it - addresses.begin());
+    
+    // Several symbols can start at one address; prefer functions, then globals
+    size_t best = SIZE_MAX;
+    for (size_t checked = 0; position > 0 && checked < kMaxCoverCandidates; ++checked) {
+        --position;
+        bool covers = addresses[position] == address || address - addresses[position] < sizes[position];
+        if (best != SIZE_MAX && addresses[position] != addresses[best]) break;
+        if (covers && (best == SIZE_MAX || flags[position] > flags[best])) {
+            best = position;
+        }
     }
+    if (best == SIZE_MAX) return false;
     
-    void clear() {
-        address_to_symbol.clear();
-        symbol_to_address.clear();
-        symbol_info.clear();
-        symbol_file.clear();
+    index = static_cast<uint32_t>(best);
+    offset = address - addresses[best];
+    return true;
+}
+
+std::string SymbolTable::lookup_symbol(uint64_t address) {
+    uint32_t index;
+    uint64_t offset;
+    if (!find_symbol(address, index, offset)) {
+        return "";
     }
     
-    size_t size() const {
-        return symbol_to_address.size();
+    std::string name(names[index]);
+    if (offset != 0) {
+        name += "+" + std::to_string(offset);
+    }
+    return name;
+}
+
+uint32_t SymbolTable::find_by_name(std::string_view name) {
+    ensure_built();
+    auto it = std::lower_bound(by_name.begin(), by_name.end(), name,
+                               [this](uint32_t index, std::string_view value) { return names[index] < value; });
+    return it != by_name.end() && names[*it] == name ? *it : UINT32_MAX;
+}
+
+uint64_t SymbolTable::lookup_address(const std::string& symbol) {
+    uint32_t index = find_by_name(symbol);
+    if (index != UINT32_MAX) {
+        return addresses[index];
     }
     
-    // Advanced symbol operations
-    std::vector<std::string> find_symbols_by_pattern(const std::string& pattern) {
-        std::vector<std::string> matches;
-        
-        for (const auto& pair : symbol_to_address) {
-            if (pair.first.find(pattern) != std::string::npos) {
-                matches.push_back(pair.first);
-            }
+    // Try partial matching
+    std::vector<SearchResult> matches = search(symbol, 1);
+    return matches.empty() ? 0 : addresses[matches[0].index];
+}
+
+bool SymbolTable::has_symbol(const std::string& name) {
+    return find_by_name(name) != UINT32_MAX;
+}
+
+SymbolTable::SymbolInfo SymbolTable::get_symbol_info(const std::string& name) {
+    uint32_t index = find_by_name(name);
+    return index == UINT32_MAX ? SymbolInfo{} : get_symbol(index);
+}
+
+std::string_view SymbolTable::get_name(uint32_t index) const {
+    return names[index];
+}
+
+uint64_t SymbolTable::get_address(uint32_t index) const {
+    return addresses[index];
+}
+
+uint64_t SymbolTable::get_size(uint32_t index) const {
+    return sizes[index];
+}
+
+std::string_view SymbolTable::get_type(uint32_t index) const {
+    return types[index];
+}
+
+bool SymbolTable::is_function(uint32_t index) const {
+    return (flags[index] & FUNCTION) != 0;
+}
+
+SymbolTable::SymbolInfo SymbolTable::get_symbol(uint32_t index) const {
+    return SymbolInfo{std::string(names[index]), addresses[index], sizes[index], std::string(types[index]),
+                      std::string(sections[index]), (flags[index] & FUNCTION) != 0, (flags[index] & GLOBAL) != 0};
+}
+
+std::vector<SymbolTable::SearchResult> SymbolTable::search(std::string_view query, size_t max_results, bool fuzzy) {
+    ensure_built();
+    std::vector<SearchResult> results;
+    if (max_results == 0) return results;
+    
+    if (query.empty()) {
+        for (size_t i = 0; i < by_name.size() && i < max_results; ++i) {
+            results.push_back(SearchResult{by_name[i], 0});
         }
-        
-        return matches;
+        return results;
     }
     
-    std::vector<std::string> get_function_symbols() {
-        std::vector<std::string> functions;
-        
-        for (const auto& pair : symbol_info) {
-            if (pair.second.is_function) {
-                functions.push_back(pair.first);
-            }
+    std::string folded(query);
+    for (char& c : folded) c = static_cast<char>(fold(static_cast<unsigned char>(c)));
+    
+    // Substring hits outrank fuzzy ones: exact, then prefix, then earlier
+    // and shorter matches
+    auto score_substring = [&folded](std::string_view name, size_t position) {
+        int score = 1 << 20;
+        if (position == 0) score += name.size() == folded.size() ? 1 << 19 : 1 << 18;
+        score -= static_cast<int>(std::min<size_t>(position, 1000)) * 64;
+        score -= static_cast<int>(std::min<size_t>(name.size(), 1000));
+        return score;
+    };
+    auto try_substring = [&](uint32_t index) {
+        size_t position = find_folded(names[index], folded);
+        if (position != std::string_view::npos) {
+            results.push_back(SearchResult{index, score_substring(names[index], position)});
         }
-        
-        return functions;
-    }
+    };
     
-    std::vector<SymbolInfo> get_symbols_in_range(uint64_t start_addr, uint64_t end_addr) {
-        std::vector<SymbolInfo> symbols_in_range;
-        
-        auto start_it = address_to_symbol.lower_bound(start_addr);
-        auto end_it = address_to_symbol.upper_bound(end_addr);
-        
-        for (auto it = start_it; it != end_it; ++it) {
-            auto info_it = symbol_info.find(it->second);
-            if (info_it != symbol_info.end()) {
-                symbols_in_range.push_back(info_it->second);
+    // Every name containing the query contains each of its trigrams, so
+    // only the shortest posting list needs checking
+    std::vector<uint8_t> matched;
+    if (folded.size() >= 3) {
+        uint32_t best_bucket = 0;
+        uint32_t best_count = UINT32_MAX;
+        for (size_t i = 0; i + 2 < folded.size(); ++i) {
+            uint32_t bucket = trigram_bucket(folded[i], folded[i + 1], folded[i + 2]);
+            uint32_t count = trigram_offsets[bucket + 1] - trigram_offsets[bucket];
+            if (count < best_count) {
+                best_bucket = bucket;
+                best_count = count;
             }
         }
-        
-        return symbols_in_range;
-    }
-    
-    bool has_symbol(const std::string& name) {
-        return symbol_to_address.find(name) != symbol_to_address.end();
+        for (uint32_t i = trigram_offsets[best_bucket]; i < trigram_offsets[best_bucket + 1]; ++i) {
+            try_substring(trigram_postings[i]);
+        }
+    } else {
+        uint64_t needed = char_mask(folded);
+        for (uint32_t index = 0; index < names.size(); ++index) {
+            if ((char_masks[index] & needed) == needed) try_substring(index);
+        }
     }
     
-    SymbolInfo get_symbol_info(const std::string& name) {
-        auto it = symbol_info.find(name);
-        if (it != symbol_info.end()) {
-            return it->second;
+    if (fuzzy && results.size() < max_results) {
+        matched.assign(names.size(), 0);
+        for (const SearchResult& result : results) matched[result.index] = 1;
+        uint64_t needed = char_mask(folded);
+        for (uint32_t index = 0; index < names.size(); ++index) {
+            if (matched[index] || (char_masks[index] & needed) != needed) continue;
+            std::optional<int> score = fuzzy_score(names[index], folded);
+            if (score) results.push_back(SearchResult{index, *score});
         }
-        return SymbolInfo{};
     }
     
-    std::string get_symbol_file() const {
-        return symbol_file;
+    auto better = [this](const SearchResult& a, const SearchResult& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (names[a.index] != names[b.index]) return names[a.index] < names[b.index];
+        return a.index < b.index;
+    };
+    if (results.size() > max_results) {
+        std::partial_sort(results.begin(), results.begin() + static_cast<std::ptrdiff_t>(max_results), results.end(), better);
+        results.resize(max_results);
+    } else {
+        std::sort(results.begin(), results.end(), better);
+    }
+    return results;
+}
+
+// Advanced symbol operations
+std::vector<std::string> SymbolTable::find_symbols_by_pattern(const std::string& pattern) {
+    std::vector<std::string> matches;
+    for (const SearchResult& result : search(pattern, SIZE_MAX)) {
+        matches.emplace_back(names[result.index]);
     }
+    return matches;
+}
+
+std::vector<std::string> SymbolTable::get_function_symbols() {
+    ensure_built();
+    std::vector<std::string> functions;
+    for (uint32_t index : by_name) {
+        if (flags[index] & FUNCTION) functions.emplace_back(names[index]);
+    }
+    return functions;
+}
+
+std::vector<SymbolTable::SymbolInfo> SymbolTable::get_symbols_in_range(uint64_t start_addr, uint64_t end_addr) {
+    ensure_built();
+    std::vector<SymbolInfo> symbols_in_range;
     
-    // Export symbols to file
-    bool export_symbols(const std::string& filename) {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            return false;
-        }
-        
-        file << "# Symbol table exported from debugger\n";
-        file << "# Format: address name type size\n";
-        
-        for (const auto& pair : symbol_info) {
-            const SymbolInfo& info = pair.second;
-            file << std::hex << "0x" << info.address << " "
-                 << info.name << " "
-                 << info.type << " "
-                 << std::dec << info.size << "\n";
-        }
-        
-        return true;
+    auto first = std::lower_bound(addresses.begin(), addresses.end(), start_addr);
+    auto last = std::upper_bound(first, addresses.end(), end_addr);
+    for (auto it = first; it != last; ++it) {
+        symbols_in_range.push_back(get_symbol(static_cast<uint32_t>(it - addresses.begin())));
+    }
+    return symbols_in_range;
+}
+
+std::string SymbolTable::get_symbol_file() const {
+    return symbol_file;
+}
+
+// Export symbols to file
+bool SymbolTable::export_symbols(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
     }
     
-private:
-    std::map<uint64_t, std::string> address_to_symbol;
-    std::map<std::string, uint64_t> symbol_to_address;
-    std::map<std::string, SymbolInfo> symbol_info;
-    std::string symbol_file;
+    ensure_built();
+    file << "# Symbol table exported from debugger\n";
+    file << "# Format: address name type size\n";
+    
+    for (uint32_t index = 0; index < names.size(); ++index) {
+        file << std::hex << "0x" << addresses[index] << " "
+             << names[index] << " "
+             << types[index] << " "
+             << std::dec << sizes[index] << "\n";
+    }
     
-    bool load_elf_symbols(const std::string& filename) {
-        // This would integrate with ELF parser to extract symbols
-        // For now, return false to use text format
+    return true;
+}
+
+size_t SymbolTable::memory_usage() const {
+    size_t columns = addresses.capacity() * sizeof(uint64_t) + sizes.capacity() * sizeof(uint64_t) +
+                     (names.capacity() + types.capacity() + sections.capacity()) * sizeof(std::string_view) +
+                     flags.capacity() + char_masks.capacity() * sizeof(uint64_t);
+    size_t indexes = (by_name.capacity() + trigram_offsets.capacity() + trigram_postings.capacity()) * sizeof(uint32_t);
+    return strings.memory_usage() + columns + indexes;
+}
+
+bool SymbolTable::load_elf_symbols(const std::string& filename) {
+    ElfParser elf;
+    if (!elf.load_file(filename)) {
         return false;
     }
+    return add_elf_symbols(elf) > 0;
+}
+
+bool SymbolTable::load_text_symbols(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string line;
+    int line_number = 0;
     
-    bool load_text_symbols(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            return false;
+    while (std::getline(file, line)) {
+        line_number++;
+        
+        // Skip comments and empty lines
+        if (line.empty() || line[0] == '#') {
+            continue;
         }
         
-        std::string line;
-        int line_number = 0;
+        std::istringstream iss(line);
+        std::string address_str, name, type;
+        uint64_t size = 0;
         
-        while (std::getline(file, line)) {
-            line_number++;
-            
-            // Skip comments and empty lines
-            if (line.empty() || line[0] == '#') {
-                continue;
-            }
-            
-            std::istringstream iss(line);
-            std::string address_str, name, type;
-            uint64_t size = 0;
-            
-            if (!(iss >> address_str >> name)) {
-                std::cerr << "Warning: Invalid line " << line_number 
-                         << " in symbol file: " << line << std::endl;
-                continue;
-            }
-            
-            // Optional type and size
-            iss >> type >> size;
-            
-            // Parse address
-            uint64_t address = 0;
-            try {
-                if (address_str.substr(0, 2) == "0x" || address_str.substr(0, 2) == "0X") {
-                    address = std::stoull(address_str, nullptr, 16);
-                } else {
-                    address = std::stoull(address_str, nullptr, 10);
-                }
-            } catch (const std::exception& e) {
-                std::cerr << "Warning: Invalid address '" << address_str 
-                         << "' on line " << line_number << std::endl;
-                continue;
+        if (!(iss >> address_str >> name)) {
+            std::cerr << "Warning: Invalid line " << line_number
+                     << " in symbol file: " << line << std::endl;
+            continue;
+        }
+        
+        // Optional type and size
+        iss >> type >> size;
+        
+        // Parse address
+        uint64_t address = 0;
+        try {
+            if (address_str.substr(0, 2) == "0x" || address_str.substr(0, 2) == "0X") {
+                address = std::stoull(address_str, nullptr, 16);
+            } else {
+                address = std::stoull(address_str, nullptr, 10);
             }
-            
-            // Determine if it's a function
-            bool is_function = (type == "FUNC" || type == "function" || 
-                              name.find("_func") != std::string::npos ||
-                              name.find("sub_") == 0);
-            
-            add_symbol(name, address, size, type, is_function);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Invalid address '" << address_str
+                     << "' on line " << line_number << std::endl;
+            continue;
         }
         
-        return size() > 0;
+        // Determine if it's a function
+        bool is_function = (type == "FUNC" || type == "function" ||
+                          name.find("_func") != std::string::npos ||
+                          name.find("sub_") == 0);
+        
+        add_symbol(name, address, size, type, is_function);
     }
-};
+    
+    return size() > 0;
+}
 
 // Static instance for global access
 static SymbolTable global_symbol_table;
@@ -0,0 +1,126 @@
+#include "thread_pool.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <string>
+
+namespace debugger {
+
+namespace {
+
+// Identifies the pool and worker running on the current thread, if any
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t thread_count) : queued_tasks(0), stopping(false) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    worker_queues.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        worker_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    
+    workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_condition.notify_all();
+    
+    // Workers finish whatever is still queued before exiting
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    if (current_pool == this) {
+        WorkerQueue& own = *worker_queues[current_worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        tasks.push_back(std::move(task));
+    }
+    
+    // Count under queue_mutex so a worker about to sleep cannot miss the wakeup
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        ++queued_tasks;
+    }
+    queue_condition.notify_one();
+}
+
+bool ThreadPool::take_task(size_t worker_index, std::function<void()>& task) {
+    // Newest task from our own deque first
+    {
+        WorkerQueue& own = *worker_queues[worker_index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued_tasks;
+            return true;
+        }
+    }
+    
+    // Then external submissions
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (!tasks.empty()) {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            --queued_tasks;
+            return true;
+        }
+    }
+    
+    // Finally steal the oldest task from another worker
+    for (size_t offset = 1; offset < worker_queues.size(); ++offset) {
+        WorkerQueue& victim = *worker_queues[(worker_index + offset) % worker_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued_tasks;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void ThreadPool::worker_loop(size_t worker_index) {
+    current_pool = this;
+    current_worker = worker_index;
+    PERF_THREAD_NAME("Pool worker " + std::to_string(worker_index));
+    
+    for (;;) {
+        std::function<void()> task;
+        if (take_task(worker_index, task)) {
+            task();
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_condition.wait(lock, [this] { return stopping || queued_tasks > 0; });
+        if (stopping && queued_tasks == 0) {
+            return;
+        }
+    }
+}
+
+size_t ThreadPool::get_thread_count() const {
+    return workers.size();
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -1,21 +1,415 @@
-#include "debugger_engine.h"
+#include "breakpoint_condition.h"
+#include "memory_manager.h"
+#include "register_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <sys/user.h>
 
 namespace debugger {
 
-// Breakpoint management stubs
-class BreakpointManager {
+namespace {
+
+// Deepest evaluation stack a condition may need; deeper ones are rejected
+// at compile time so evaluate() can use a fixed array
+static constexpr size_t kMaxStackDepth = 64;
+
+// Load types accepted inside *(T*)
+bool parse_load_type(const std::string& name, uint8_t& width, bool& sign_extend) {
+    static const struct { const char* name; uint8_t width; bool sign_extend; } kTypes[] = {
+        {"u8", 1, false},  {"u16", 2, false},  {"u32", 4, false},  {"u64", 8, false},
+        {"i8", 1, true},   {"i16", 2, true},   {"i32", 4, true},   {"i64", 8, true},
+        {"uint8_t", 1, false}, {"uint16_t", 2, false}, {"uint32_t", 4, false}, {"uint64_t", 8, false},
+        {"int8_t", 1, true},   {"int16_t", 2, true},   {"int32_t", 4, true},   {"int64_t", 8, true},
+    };
+    for (const auto& type : kTypes) {
+        if (name == type.name) {
+            width = type.width;
+            sign_extend = type.sign_extend;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t truncate_value(uint64_t value, uint8_t width, bool sign_extend) {
+    if (width >= 8) return value;
+    unsigned bits = width * 8u;
+    uint64_t mask = (1ull << bits) - 1;
+    value &= mask;
+    if (sign_extend && (value >> (bits - 1)) != 0) {
+        value |= ~mask;
+    }
+    return value;
+}
+
+} // namespace
+
+// Recursive descent over the usual C precedence levels, emitting bytecode
+// as it goes
+class ConditionParser {
 public:
-    static bool addBreakpoint(uint64_t address) {
+    using Op = BreakpointCondition::Op;
+    
+    ConditionParser(const std::string& text, BreakpointCondition& target)
+        : text(text), position(0), depth(0), max_depth(0), nesting(0), target(target) {}
+    
+    bool parse() {
+        if (!parse_binary(0)) return false;
+        skip_space();
+        if (position != text.size()) {
+            return fail("Unexpected '" + text.substr(position, 1) + "'");
+        }
+        if (max_depth > kMaxStackDepth) {
+            return fail("Expression is too deeply nested");
+        }
+        return true;
+    }
+
+private:
+    struct BinaryOperator {
+        const char* token;
+        int precedence;
+        Op op;
+    };
+    
+    const std::string& text;
+    size_t position;
+    size_t depth;
+    size_t max_depth;
+    size_t nesting;  // parse_unary() frames active, one per parenthesis or prefix
+    BreakpointCondition& target;
+    
+    bool fail(const std::string& message) {
+        target.last_error = message + " at column " + std::to_string(position + 1);
+        return false;
+    }
+    
+    void emit(Op op, uint64_t operand = 0, uint8_t width = 0, bool sign_extend = false) {
+        target.code.push_back(BreakpointCondition::Instruction{op, width, sign_extend, operand});
+        
+        // Track the stack depth the code will reach
+        switch (op) {
+            case Op::PUSH_CONST:
+            case Op::PUSH_REGISTER:
+                max_depth = std::max(max_depth, ++depth);
+                break;
+            case Op::LOAD:
+            case Op::NEGATE:
+            case Op::LOGICAL_NOT:
+            case Op::BITWISE_NOT:
+            case Op::TO_BOOL:
+                break;
+            case Op::AND_JUMP:
+            case Op::OR_JUMP:
+                --depth;  // the right-hand side replaces the left when it runs
+                break;
+            default:
+                --depth;
+                break;
+        }
+    }
+    
+    void skip_space() {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+            ++position;
+        }
+    }
+    
+    bool accept(const char* token) {
+        skip_space();
+        size_t length = std::strlen(token);
+        if (text.compare(position, length, token) != 0) {
+            return false;
+        }
+        position += length;
+        return true;
+    }
+    
+    std::string peek_identifier(size_t at) const {
+        size_t end = at;
+        while (end < text.size() && (std::isalnum(static_cast<unsigned char>(text[end])) || text[end] == '_')) {
+            ++end;
+        }
+        return text.substr(at, end - at);
+    }
+    
+    // Longest operator at the cursor with at least the given precedence
+    const BinaryOperator* peek_binary(int min_precedence) {
+        static const BinaryOperator kOperators[] = {
+            {"||", 1, Op::OR_JUMP},       {"&&", 2, Op::AND_JUMP},
+            {"==", 6, Op::EQUAL},         {"!=", 6, Op::NOT_EQUAL},
+            {"<=", 7, Op::LESS_EQUAL},    {">=", 7, Op::GREATER_EQUAL},
+            {"<<", 8, Op::SHIFT_LEFT},    {">>", 8, Op::SHIFT_RIGHT},
+            {"|", 3, Op::BITWISE_OR},     {"^", 4, Op::BITWISE_XOR},    {"&", 5, Op::BITWISE_AND},
+            {"<", 7, Op::LESS},           {">", 7, Op::GREATER},
+            {"+", 9, Op::ADD},            {"-", 9, Op::SUBTRACT},
+            {"*", 10, Op::MULTIPLY},      {"/", 10, Op::DIVIDE},        {"%", 10, Op::MODULO},
+        };
+        skip_space();
+        for (const BinaryOperator& candidate : kOperators) {
+            size_t length = std::strlen(candidate.token);
+            if (text.compare(position, length, candidate.token) == 0) {
+                return candidate.precedence >= min_precedence ? &candidate : nullptr;
+            }
+        }
+        return nullptr;
+    }
+    
+    bool parse_binary(int min_precedence) {
+        if (!parse_unary()) return false;
+        
+        while (const BinaryOperator* binary = peek_binary(min_precedence)) {
+            position += std::strlen(binary->token);
+            
+            if (binary->op == Op::AND_JUMP || binary->op == Op::OR_JUMP) {
+                // Short-circuit: the jump skips the right-hand side
+                size_t jump = target.code.size();
+                emit(binary->op);
+                if (!parse_binary(binary->precedence + 1)) return false;
+                emit(Op::TO_BOOL);
+                target.code[jump].operand = target.code.size();
+                continue;
+            }
+            
+            if (!parse_binary(binary->precedence + 1)) return false;
+            emit(binary->op);
+        }
+        return true;
+    }
+    
+    // Parentheses and prefix operators all recurse through here, so limiting
+    // the frames bounds the parser's own stack use while it is still parsing
+    bool parse_unary() {
+        if (nesting == kMaxStackDepth) {
+            return fail("Expression is too deeply nested");
+        }
+        ++nesting;
+        bool parsed = parse_operand();
+        --nesting;
+        return parsed;
+    }
+    
+    bool parse_operand() {
+        skip_space();
+        if (accept("!")) {
+            if (!parse_unary()) return false;
+            emit(Op::LOGICAL_NOT);
+            return true;
+        }
+        if (accept("~")) {
+            if (!parse_unary()) return false;
+            emit(Op::BITWISE_NOT);
+            return true;
+        }
+        if (accept("-")) {
+            if (!parse_unary()) return false;
+            emit(Op::NEGATE);
+            return true;
+        }
+        if (accept("*")) {
+            return parse_load();
+        }
+        return parse_primary();
+    }
+    
+    bool parse_load() {
+        uint8_t width = 8;
+        bool sign_extend = false;
+        
+        // *(T*)expr, or a plain *expr that reads a u64
+        skip_space();
+        if (position < text.size() && text[position] == '(') {
+            size_t type_start = position + 1;
+            while (type_start < text.size() && std::isspace(static_cast<unsigned char>(text[type_start]))) {
+                ++type_start;
+            }
+            std::string type = peek_identifier(type_start);
+            if (parse_load_type(type, width, sign_extend)) {
+                position = type_start + type.size();
+                if (!accept("*") || !accept(")")) {
+                    return fail("Expected '*)' after load type");
+                }
+            }
+        }
+        
+        if (!parse_unary()) return false;
+        emit(Op::LOAD, 0, width, sign_extend);
         return true;
     }
     
-    static bool removeBreakpoint(uint64_t address) {
+    bool parse_primary() {
+        skip_space();
+        if (position >= text.size()) {
+            return fail("Unexpected end of expression");
+        }
+        
+        if (accept("(")) {
+            if (!parse_binary(0)) return false;
+            if (!accept(")")) return fail("Expected ')'");
+            return true;
+        }
+        
+        char first = text[position];
+        if (std::isdigit(static_cast<unsigned char>(first))) {
+            return parse_number();
+        }
+        
+        std::string name = peek_identifier(position);
+        if (name.empty()) {
+            return fail("Unexpected '" + std::string(1, first) + "'");
+        }
+        const RegisterLayout* reg = find_register_layout(name);
+        if (!reg) {
+            return fail("Unknown register '" + name + "'");
+        }
+        position += name.size();
+        emit(Op::PUSH_REGISTER, reg->offset, reg->width);
         return true;
     }
     
-    static std::vector<uint64_t> getBreakpoints() {
-        return {};
+    bool parse_number() {
+        int base = 10;
+        if (text.compare(position, 2, "0x") == 0 || text.compare(position, 2, "0X") == 0) {
+            base = 16;
+            position += 2;
+        }
+        
+        size_t start = position;
+        uint64_t value = 0;
+        while (position < text.size()) {
+            char c = static_cast<char>(std::tolower(static_cast<unsigned char>(text[position])));
+            int digit = std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+            if (digit < 0 || digit >= base) break;
+            value = value * base + static_cast<uint64_t>(digit);
+            ++position;
+        }
+        if (position == start) {
+            return fail("Expected digits");
+        }
+        
+        emit(Op::PUSH_CONST, value);
+        return true;
     }
 };
 
+BreakpointCondition::BreakpointCondition() {}
+
+bool BreakpointCondition::compile(const std::string& text) {
+    expression = text;
+    code.clear();
+    last_error.clear();
+    
+    ConditionParser parser(expression, *this);
+    if (!parser.parse()) {
+        code.clear();
+        return false;
+    }
+    return true;
+}
+
+bool BreakpointCondition::evaluate(const user_regs_struct& regs, MemoryManager& memory) const {
+    if (code.empty()) {
+        return false;
+    }
+    
+    uint64_t stack[kMaxStackDepth];
+    size_t top = 0;  // number of live entries
+    const uint8_t* register_bytes = reinterpret_cast<const uint8_t*>(&regs);
+    
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const Instruction& instruction = code[pc];
+        uint64_t* operand = top > 0 ? &stack[top - 1] : nullptr;
+        
+        switch (instruction.op) {
+            case Op::PUSH_CONST:
+                stack[top++] = instruction.operand;
+                continue;
+            case Op::PUSH_REGISTER: {
+                uint64_t value = 0;
+                std::memcpy(&value, register_bytes + instruction.operand, sizeof(value));
+                stack[top++] = truncate_value(value, instruction.width, false);
+                continue;
+            }
+            case Op::LOAD: {
+                uint64_t value = 0;
+                if (memory.read(*operand, reinterpret_cast<uint8_t*>(&value), instruction.width) != instruction.width) {
+                    return false;
+                }
+                *operand = truncate_value(value, instruction.width, instruction.sign_extend);
+                continue;
+            }
+            case Op::NEGATE:      *operand = 0 - *operand; continue;
+            case Op::LOGICAL_NOT: *operand = *operand == 0; continue;
+            case Op::BITWISE_NOT: *operand = ~*operand; continue;
+            case Op::TO_BOOL:     *operand = *operand != 0; continue;
+            case Op::AND_JUMP:
+                if (*operand == 0) {
+                    pc = instruction.operand - 1;
+                } else {
+                    --top;
+                }
+                continue;
+            case Op::OR_JUMP:
+                if (*operand != 0) {
+                    *operand = 1;
+                    pc = instruction.operand - 1;
+                } else {
+                    --top;
+                }
+                continue;
+            default:
+                break;
+        }
+        
+        // Binary operators: left operand below, right on top
+        uint64_t right = stack[--top];
+        uint64_t& left = stack[top - 1];
+        int64_t signed_left = static_cast<int64_t>(left);
+        int64_t signed_right = static_cast<int64_t>(right);
+        switch (instruction.op) {
+            case Op::ADD:           left += right; break;
+            case Op::SUBTRACT:      left -= right; break;
+            case Op::MULTIPLY:      left *= right; break;
+            // INT64_MIN / -1 overflows and traps on x86, so -1 wraps by hand
+            case Op::DIVIDE:
+                if (right == 0) return false;
+                left = signed_right == -1 ? 0 - left : static_cast<uint64_t>(signed_left / signed_right);
+                break;
+            case Op::MODULO:
+                if (right == 0) return false;
+                left = signed_right == -1 ? 0 : static_cast<uint64_t>(signed_left % signed_right);
+                break;
+            case Op::SHIFT_LEFT:    left = right < 64 ? left << right : 0; break;
+            case Op::SHIFT_RIGHT:   left = right < 64 ? left >> right : 0; break;
+            case Op::BITWISE_AND:   left &= right; break;
+            case Op::BITWISE_OR:    left |= right; break;
+            case Op::BITWISE_XOR:   left ^= right; break;
+            case Op::EQUAL:         left = left == right; break;
+            case Op::NOT_EQUAL:     left = left != right; break;
+            case Op::LESS:          left = signed_left < signed_right; break;
+            case Op::LESS_EQUAL:    left = signed_left <= signed_right; break;
+            case Op::GREATER:       left = signed_left > signed_right; break;
+            case Op::GREATER_EQUAL: left = signed_left >= signed_right; break;
+            default:
+                return false;
+        }
+    }
+    
+    return top == 1 && stack[0] != 0;
+}
+
+const std::string& BreakpointCondition::get_expression() const {
+    return expression;
+}
+
+std::string BreakpointCondition::get_last_error() const {
+    return last_error;
+}
+
+size_t BreakpointCondition::get_instruction_count() const {
+    return code.size();
+}
+
 } // namespace debugger 
\ No newline at end of file
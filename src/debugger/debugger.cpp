@@ -3,12 +3,19 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <signal.h>
+#include <cerrno>
 #include <iostream>
+#include <algorithm>
 
 namespace debugger {
 
+// Deepest backtrace get_stack_trace() produces
+static constexpr size_t kMaxStackFrames = 256;
+
 DebuggerEngine::DebuggerEngine() 
-    : target_pid(-1), current_state(DebuggerState::NOT_RUNNING), platform_data(nullptr) {
+    : target_pid(-1), current_thread(-1), current_state(DebuggerState::NOT_RUNNING), memory_cache(memory), owns_process(false),
+      unwinder(process_maps), loader_breakpoint(0), loader_hits(0), regions_stale(false), last_stop_time(0),
+      platform_data(nullptr) {
 }
 
 DebuggerEngine::~DebuggerEngine() {
@@ -16,17 +23,27 @@ DebuggerEngine::~DebuggerEngine() {
 }
 
 bool DebuggerEngine::attach_to_process(pid_t pid) {
-    if (ptrace(PTRACE_ATTACH, pid, nullptr, nullptr) == -1) {
+    if (target_pid != -1) {
+        last_error = "Already debugging a process";
+        return false;
+    }
+    
+    // Seizes every thread and returns with the whole group stopped
+    bool attached = false;
+    tracer.execute([&]() { attached = tracer.attach(pid); });
+    if (!attached) {
         last_error = "Failed to attach to process";
         return false;
     }
     
     target_pid = pid;
+    current_thread = pid;
+    owns_process = false;
     current_state = DebuggerState::PAUSED;
-    
-    // Wait for process to stop
-    int status;
-    waitpid(pid, &status, 0);
+    memory.attach(pid);
+    tracer.execute([&]() { attach_process_maps(pid); });
+    memory_cache.clear();
+    register_cache.clear();
     
     return true;
 }
@@ -42,36 +59,38 @@ bool DebuggerEngine::start_process() {
         last_error = "No executable loaded";
         return false;
     }
+    if (target_pid != -1) {
+        last_error = "Already debugging a process";
+        return false;
+    }
     
-    pid_t pid = fork();
-    if (pid == 0) {
-        // Child process
-        ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
-        
-        // Convert args to char* array
-        std::vector<char*> argv;
-        argv.push_back(const_cast<char*>(executable_path.c_str()));
-        for (const auto& arg : program_args) {
-            argv.push_back(const_cast<char*>(arg.c_str()));
-        }
-        argv.push_back(nullptr);
-        
-        execv(executable_path.c_str(), argv.data());
-        exit(1); // If execv fails
-    } else if (pid > 0) {
-        // Parent process
-        target_pid = pid;
-        current_state = DebuggerState::PAUSED;
-        
-        // Wait for child to stop at first instruction
-        int status;
-        waitpid(pid, &status, 0);
-        
-        return true;
-    } else {
-        last_error = "Failed to fork process";
+    // Convert args to char* array before forking; the child may only make
+    // async-signal-safe calls
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(executable_path.c_str()));
+    for (const auto& arg : program_args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    
+    // Stops on the exec, before the first instruction of the new image
+    pid_t pid = -1;
+    tracer.execute([&]() { pid = tracer.spawn(executable_path.c_str(), argv.data()); });
+    if (pid < 0) {
+        last_error = "Failed to start process";
         return false;
     }
+    
+    target_pid = pid;
+    current_thread = pid;
+    owns_process = true;
+    current_state = DebuggerState::PAUSED;
+    memory.attach(pid);
+    tracer.execute([&]() { attach_process_maps(pid); });
+    memory_cache.clear();
+    register_cache.clear();
+    
+    return true;
 }
 
 bool DebuggerEngine::continue_execution() {
@@ -79,8 +98,27 @@ bool DebuggerEngine::continue_execution() {
         last_error = "No process attached";
         return false;
     }
+    if (current_state != DebuggerState::PAUSED) {
+        last_error = "Process is not paused";
+        return false;
+    }
     
-    if (ptrace(PTRACE_CONT, target_pid, nullptr, nullptr) == -1) {
+    // Anything cached during this stop is stale once the target runs, and
+    // register writes have to reach the thread before it does
+    if (!flush_register_cache()) {
+        return false;
+    }
+    memory_cache.invalidate();
+    
+    // Returns as soon as the request is issued; the next stop arrives
+    // through process_pending_events()
+    bool resumed = false;
+    pid_t pid = target_pid;
+    pid_t tid = current_thread;
+    tracer.execute([&]() {
+        resumed = tracer.get_stop_mode() == StopMode::ALL_STOP ? tracer.resume_all(pid) : tracer.resume(tid, PTRACE_CONT);
+    });
+    if (!resumed) {
         last_error = "Failed to continue execution";
         return false;
     }
@@ -94,13 +132,21 @@ bool DebuggerEngine::pause_execution() {
         last_error = "No process attached";
         return false;
     }
+    if (current_state != DebuggerState::RUNNING) {
+        last_error = "Process is not running";
+        return false;
+    }
     
-    if (kill(target_pid, SIGSTOP) == -1) {
+    // Interrupts every thread at once; the state flips to PAUSED when the
+    // last of them has stopped and the stop is reported
+    bool requested = false;
+    pid_t pid = target_pid;
+    tracer.execute([&]() { requested = tracer.interrupt_all(pid); });
+    if (!requested) {
         last_error = "Failed to pause execution";
         return false;
     }
     
-    current_state = DebuggerState::PAUSED;
     return true;
 }
 
@@ -110,13 +156,21 @@ bool DebuggerEngine::stop_execution() {
         return false;
     }
     
-    if (kill(target_pid, SIGKILL) == -1) {
+    bool killed = false;
+    pid_t pid = target_pid;
+    tracer.execute([&]() { killed = tracer.kill_process(pid); });
+    if (!killed) {
         last_error = "Failed to stop execution";
         return false;
     }
     
     current_state = DebuggerState::STOPPED;
     target_pid = -1;
+    current_thread = -1;
+    memory.detach();
+    tracer.execute([&]() { attach_process_maps(-1); });
+    memory_cache.clear();
+    register_cache.clear();
     return true;
 }
 
@@ -125,14 +179,22 @@ bool DebuggerEngine::detach() {
         last_error = "No process attached";
         return false;
     }
-    
-    if (ptrace(PTRACE_DETACH, target_pid, nullptr, nullptr) == -1) {
+    // Threads still running are interrupted first, then released together
+    bool detached = false;
+    pid_t pid = target_pid;
+    tracer.execute([&]() { detached = tracer.detach(pid); });
+    if (!detached) {
         last_error = "Failed to detach from process";
         return false;
     }
     
     target_pid = -1;
+    current_thread = -1;
     current_state = DebuggerState::NOT_RUNNING;
+    memory.detach();
+    tracer.execute([&]() { attach_process_maps(-1); });
+    memory_cache.clear();
+    register_cache.clear();
     return true;
 }
 
@@ -141,19 +203,78 @@ bool DebuggerEngine::step_into() {
         last_error = "No process attached";
         return false;
     }
+    if (current_state != DebuggerState::PAUSED) {
+        last_error = "Process is not paused";
+        return false;
+    }
     
-    if (ptrace(PTRACE_SINGLESTEP, target_pid, nullptr, nullptr) == -1) {
+    if (!flush_register_cache()) {
+        return false;
+    }
+    memory_cache.invalidate();
+    
+    // Completion is reported through the stop callback
+    bool resumed = false;
+    pid_t tid = current_thread;
+    tracer.execute([&]() { resumed = tracer.resume(tid, PTRACE_SINGLESTEP); });
+    if (!resumed) {
         last_error = "Failed to single step";
         return false;
     }
     
-    // Wait for step to complete
-    int status;
-    waitpid(target_pid, &status, 0);
+    current_state = DebuggerState::RUNNING;
+    return true;
+}
+
+void DebuggerEngine::set_stop_mode(StopMode mode) {
+    tracer.execute([&]() { tracer.set_stop_mode(mode); });
+}
+
+StopMode DebuggerEngine::get_stop_mode() {
+    StopMode mode = StopMode::ALL_STOP;
+    tracer.execute([&]() { mode = tracer.get_stop_mode(); });
+    return mode;
+}
+
+std::vector<ThreadInfo> DebuggerEngine::get_threads() {
+    std::vector<ThreadInfo> threads;
+    if (target_pid == -1) return threads;
+    
+    pid_t pid = target_pid;
+    tracer.execute([&]() { threads = tracer.get_threads(pid); });
+    return threads;
+}
+
+bool DebuggerEngine::select_thread(pid_t tid) {
+    bool known = false;
+    bool stopped = false;
+    pid_t pid = target_pid;
+    tracer.execute([&]() {
+        for (const ThreadInfo& thread : tracer.get_threads(pid)) {
+            if (thread.tid == tid) {
+                known = true;
+                stopped = thread.stopped;
+            }
+        }
+    });
+    if (!known) {
+        last_error = "No such thread";
+        return false;
+    }
     
+    // In non-stop mode the selection decides whether we look paused
+    current_thread = tid;
+    if (current_state == DebuggerState::PAUSED || current_state == DebuggerState::RUNNING) {
+        current_state = stopped ? DebuggerState::PAUSED : DebuggerState::RUNNING;
+    }
+    memory_cache.invalidate();
     return true;
 }
 
+pid_t DebuggerEngine::get_current_thread() const {
+    return current_thread;
+}
+
 bool DebuggerEngine::step_over() {
     // For now, implement as single step
     // A proper implementation would check if next instruction is a call
@@ -177,163 +298,788 @@ bool DebuggerEngine::add_breakpoint(uint64_t address, BreakpointType type) {
         return false;
     }
     
+    auto existing = breakpoints.find(address);
+    if (existing != breakpoints.end() && is_hardware(existing->second) != (type == BreakpointType::HARDWARE)) {
+        last_error = "A breakpoint already exists at this address";
+        return false;
+    }
+    
     if (type == BreakpointType::SOFTWARE) {
-        return insert_software_breakpoint(address);
+        if (insert_software_breakpoints({address}, false) == 0) {
+            last_error = "Failed to write breakpoint instruction";
+            return false;
+        }
+        return true;
+    }
+    
+    if (type == BreakpointType::HARDWARE) {
+        Breakpoint bp = {};
+        bp.address = address;
+        bp.type = BreakpointType::HARDWARE;
+        bp.watch_kind = WatchKind::EXECUTE;
+        bp.watch_length = 1;
+        if (!set_hardware_breakpoint(bp, true)) {
+            return false;
+        }
+        breakpoints[address] = bp;
+        return true;
     }
     
-    // Hardware breakpoints not implemented yet
-    last_error = "Hardware breakpoints not implemented";
+    last_error = "Use add_conditional_breakpoint or add_watchpoint for this breakpoint type";
     return false;
 }
 
-bool DebuggerEngine::insert_software_breakpoint(uint64_t address) {
-    // Read original byte
-    errno = 0;
-    long data = ptrace(PTRACE_PEEKTEXT, target_pid, address, nullptr);
-    if (errno != 0) {
-        last_error = "Failed to read memory at breakpoint address";
+bool DebuggerEngine::add_watchpoint(uint64_t address, size_t length, WatchKind kind) {
+    if (target_pid == -1) {
+        last_error = "No process attached";
+        return false;
+    }
+    if (length != 1 && length != 2 && length != 4 && length != 8) {
+        last_error = "Watchpoint length must be 1, 2, 4 or 8 bytes";
+        return false;
+    }
+    if (address % length != 0) {
+        last_error = "Watchpoint address must be aligned to its length";
+        return false;
+    }
+    if (breakpoints.count(address)) {
+        last_error = "A breakpoint already exists at this address";
         return false;
     }
     
-    Breakpoint bp;
+    Breakpoint bp = {};
     bp.address = address;
-    bp.type = BreakpointType::SOFTWARE;
-    bp.enabled = true;
-    bp.original_byte = data & 0xFF;
-    bp.hit_count = 0;
-    
-    // Write INT3 instruction (0xCC)
-    long new_data = (data & ~0xFF) | 0xCC;
-    if (ptrace(PTRACE_POKETEXT, target_pid, address, new_data) == -1) {
-        last_error = "Failed to write breakpoint instruction";
+    bp.type = BreakpointType::WATCHPOINT;
+    bp.watch_kind = kind;
+    bp.watch_length = length;
+    if (!set_hardware_breakpoint(bp, true)) {
         return false;
     }
-    
     breakpoints[address] = bp;
     return true;
 }
 
-bool DebuggerEngine::remove_software_breakpoint(uint64_t address) {
-    auto it = breakpoints.find(address);
-    if (it == breakpoints.end()) {
-        last_error = "Breakpoint not found";
+bool DebuggerEngine::set_hardware_breakpoint(Breakpoint& bp, bool insert) {
+    pid_t pid = target_pid;
+    bool done = false;
+    tracer.execute([&]() {
+        done = insert ? tracer.insert_hardware_breakpoint(pid, bp.address, bp.watch_kind, bp.watch_length)
+                      : tracer.remove_hardware_breakpoint(pid, bp.address, bp.watch_kind);
+    });
+    if (!done) {
+        last_error = insert ? "No free debug register for this breakpoint" : "Failed to clear debug register";
         return false;
     }
     
-    // Restore original byte
-    long data = ptrace(PTRACE_PEEKTEXT, target_pid, address, nullptr);
-    long new_data = (data & ~0xFF) | it->second.original_byte;
-    
-    if (ptrace(PTRACE_POKETEXT, target_pid, address, new_data) == -1) {
-        last_error = "Failed to restore original instruction";
+    bp.enabled = insert;
+    return true;
+}
+
+bool DebuggerEngine::is_hardware(const Breakpoint& bp) const {
+    return bp.type == BreakpointType::HARDWARE || bp.type == BreakpointType::WATCHPOINT;
+}
+
+bool DebuggerEngine::add_tracepoint(uint64_t address) {
+    if (target_pid == -1) {
+        last_error = "No process attached";
         return false;
     }
     
-    breakpoints.erase(it);
+    if (insert_software_breakpoints({address}, true) == 0) {
+        last_error = "Failed to write breakpoint instruction";
+        return false;
+    }
     return true;
 }
 
-std::vector<uint8_t> DebuggerEngine::read_memory(uint64_t address, size_t size) {
-    std::vector<uint8_t> data;
+bool DebuggerEngine::add_conditional_breakpoint(uint64_t address, const std::string& condition) {
+    if (target_pid == -1) {
+        last_error = "No process attached";
+        return false;
+    }
+    
+    // Parsed once here; the tracer only ever runs the bytecode
+    std::shared_ptr<BreakpointCondition> compiled;
+    if (!condition.empty()) {
+        compiled = std::make_shared<BreakpointCondition>();
+        if (!compiled->compile(condition)) {
+            last_error = "Invalid condition: " + compiled->get_last_error();
+            return false;
+        }
+    }
     
+    auto it = breakpoints.find(address);
+    if (it != breakpoints.end() && is_hardware(it->second)) {
+        last_error = "Conditions are only supported on software breakpoints";
+        return false;
+    }
+    if (it == breakpoints.end()) {
+        if (insert_software_breakpoints({address}, false) == 0) {
+            last_error = "Failed to write breakpoint instruction";
+            return false;
+        }
+        it = breakpoints.find(address);
+    }
+    
+    Breakpoint& bp = it->second;
+    bp.type = compiled ? BreakpointType::CONDITIONAL : BreakpointType::SOFTWARE;
+    bp.condition = condition;
+    bp.compiled_condition = compiled;
+    if (bp.enabled) {
+        tracer.execute([&]() { tracer.set_breakpoint_condition(address, compiled); });
+    }
+    return true;
+}
+
+size_t DebuggerEngine::add_breakpoints(const std::vector<uint64_t>& addresses) {
     if (target_pid == -1) {
-        return data;
+        last_error = "No process attached";
+        return 0;
     }
     
-    data.reserve(size);
+    size_t inserted = insert_software_breakpoints(addresses, false);
+    if (inserted < addresses.size()) {
+        last_error = "Failed to write some breakpoint instructions";
+    }
+    return inserted;
+}
+
+size_t DebuggerEngine::insert_software_breakpoints(const std::vector<uint64_t>& addresses, bool tracing) {
+    // The tracer owns the int3s: it saves the original bytes, patches nearby
+    // addresses together, and steps threads off them on resume
+    std::vector<BreakpointStats> inserted;
+    tracer.execute([&]() {
+        tracer.insert_breakpoints(addresses, tracing);
+        inserted = tracer.get_breakpoint_stats();
+    });
+    memory_cache.invalidate();
     
-    for (size_t i = 0; i < size; i += sizeof(long)) {
-        errno = 0;
-        long word = ptrace(PTRACE_PEEKTEXT, target_pid, address + i, nullptr);
-        if (errno != 0) {
-            break;
+    size_t count = 0;
+    std::vector<std::pair<uint64_t, std::shared_ptr<const BreakpointCondition>>> conditions;
+    for (uint64_t address : addresses) {
+        auto stats = std::find_if(inserted.begin(), inserted.end(),
+                                  [address](const BreakpointStats& entry) { return entry.address == address; });
+        if (stats == inserted.end()) {
+            continue;
         }
         
-        // Copy bytes from word
-        for (size_t j = 0; j < sizeof(long) && i + j < size; ++j) {
-            data.push_back((word >> (j * 8)) & 0xFF);
+        Breakpoint& bp = breakpoints[address];
+        bp.address = address;
+        bp.enabled = true;
+        bp.original_byte = stats->original_byte;
+        bp.tracing = tracing;
+        if (bp.compiled_condition) {
+            conditions.emplace_back(address, bp.compiled_condition);  // re-enabled
+        } else {
+            bp.type = BreakpointType::SOFTWARE;
         }
+        ++count;
     }
     
+    if (!conditions.empty()) {
+        tracer.execute([&]() {
+            for (const auto& entry : conditions) {
+                tracer.set_breakpoint_condition(entry.first, entry.second);
+            }
+        });
+    }
+    return count;
+}
+
+size_t DebuggerEngine::remove_software_breakpoints(const std::vector<uint64_t>& addresses) {
+    size_t removed = 0;
+    tracer.execute([&]() { removed = tracer.remove_breakpoints(addresses); });
+    memory_cache.invalidate();
+    return removed;
+}
+
+std::vector<uint8_t> DebuggerEngine::read_memory(uint64_t address, size_t size) {
+    std::vector<uint8_t> data;
+    
+    if (target_pid == -1) {
+        return data;
+    }
+    
+    data.resize(size);
+    data.resize(read_memory_into(address, data.data(), size));
+    
     return data;
 }
 
+size_t DebuggerEngine::read_memory_into(uint64_t address, uint8_t* buffer, size_t size) {
+    if (target_pid == -1) {
+        return 0;
+    }
+    
+    // Only small reads go through the cache, and only while paused; bulk
+    // dumps land straight in the caller's buffer. While paused the cache only
+    // changes on this thread (or on the tracer while this thread waits in
+    // execute()), so hits need no round trip.
+    size_t copied = 0;
+    bool cached = current_state == DebuggerState::PAUSED && size <= MemoryCache::MAX_CACHED_READ;
+    if (cached && memory_cache.read_cached(address, buffer, size, copied)) {
+        return copied;
+    }
+    
+    // The transport falls back to PTRACE_PEEKDATA, which only the tracer
+    // thread may issue. While the target runs its memory can change under
+    // us, so go straight to the transport instead of filling the cache
+    tracer.execute([&]() {
+        copied = cached ? memory_cache.read(address, buffer, size) : memory.read(address, buffer, size);
+    });
+    
+    return copied;
+}
+
 bool DebuggerEngine::write_memory(uint64_t address, const std::vector<uint8_t>& data) {
+    return write_memory(address, data.data(), data.size());
+}
+
+bool DebuggerEngine::write_memory(uint64_t address, const uint8_t* data, size_t size) {
     if (target_pid == -1) {
         last_error = "No process attached";
         return false;
     }
     
-    // Write memory word by word
-    for (size_t i = 0; i < data.size(); i += sizeof(long)) {
-        long word = 0;
-        
-        // Pack bytes into word
-        for (size_t j = 0; j < sizeof(long) && i + j < data.size(); ++j) {
-            word |= static_cast<long>(data[i + j]) << (j * 8);
-        }
-        
-        if (ptrace(PTRACE_POKETEXT, target_pid, address + i, word) == -1) {
-            last_error = "Failed to write memory";
+    bool written = false;
+    tracer.execute([&]() { written = memory_cache.write(address, data, size); });
+    if (!written) {
+        last_error = "Failed to write memory";
+        return false;
+    }
+    
+    return true;
+}
+
+MemoryCacheStats DebuggerEngine::get_memory_cache_stats() const {
+    return memory_cache.get_stats();
+}
+
+void DebuggerEngine::reset_memory_cache_stats() {
+    memory_cache.reset_stats();
+}
+
+std::vector<Register> DebuggerEngine::get_registers() {
+    if (!update_register_cache()) return {};
+    return register_cache.get_registers();
+}
+
+bool DebuggerEngine::set_register(const std::string& name, uint64_t value) {
+    if (target_pid == -1) {
+        last_error = "No process attached";
+        return false;
+    }
+    if (!update_register_cache()) {
+        return false;
+    }
+    
+    // Reaches the thread with the rest of this stop's writes when it resumes
+    if (!register_cache.write(name, value)) {
+        last_error = register_cache.get_last_error();
+        return false;
+    }
+    return true;
+}
+
+uint64_t DebuggerEngine::get_register_value(const std::string& name) {
+    uint64_t value = 0;
+    if (!update_register_cache() || !register_cache.read(name, value)) return 0;
+    return value;
+}
+
+std::vector<uint8_t> DebuggerEngine::get_vector_register(const std::string& name) {
+    std::vector<uint8_t> bytes;
+    if (!update_register_cache()) return bytes;
+    
+    bool read = false;
+    tracer.execute([&]() { read = register_cache.read_vector(name, bytes); });
+    if (!read) {
+        last_error = register_cache.get_last_error();
+        bytes.clear();
+    }
+    return bytes;
+}
+
+uint64_t DebuggerEngine::get_instruction_pointer() {
+    if (!update_register_cache()) return 0;
+    return register_cache.get_program_counter();
+}
+
+uint64_t DebuggerEngine::get_stack_pointer() {
+    if (!update_register_cache()) return 0;
+    return register_cache.get_stack_pointer();
+}
+
+uint64_t DebuggerEngine::get_frame_pointer() {
+    if (!update_register_cache()) return 0;
+    return register_cache.get_frame_pointer();
+}
+
+bool DebuggerEngine::update_register_cache() {
+    if (target_pid == -1 || current_state != DebuggerState::PAUSED) {
+        return false;
+    }
+    if (register_cache.is_valid() && register_cache.get_thread() == current_thread) {
+        return true;
+    }
+    
+    // One GETREGSET for the whole general set; everything else this stop
+    // is served from the snapshot
+    bool loaded = false;
+    pid_t tid = current_thread;
+    tracer.execute([&]() { loaded = register_cache.load(tid); });
+    if (!loaded) {
+        last_error = register_cache.get_last_error();
+    }
+    return loaded;
+}
+
+bool DebuggerEngine::flush_register_cache() {
+    // Writes stay cached if they can't be applied, so a retry resends them
+    if (register_cache.is_dirty()) {
+        bool flushed = false;
+        tracer.execute([&]() { flushed = register_cache.flush(); });
+        if (!flushed) {
+            last_error = register_cache.get_last_error();
             return false;
         }
     }
+    register_cache.invalidate();
+    return true;
+}
+
+std::vector<StackFrame> DebuggerEngine::get_stack_trace() {
+    std::vector<StackFrame> trace;
+    if (!update_register_cache()) return trace;
+    
+    // Stack reads go through the memory cache, so a second trace in the same
+    // stop (or the memory view) doesn't go back to the tracee
+    UnwindRegisters start = StackUnwinder::registers_from(register_cache.get_general());
+    StackReader read = [this](uint64_t address, uint8_t* buffer, size_t size) {
+        return memory_cache.read(address, buffer, size);
+    };
+    tracer.execute([&]() {
+        sync_process_maps();
+        for (const UnwindFrame& frame : unwinder.unwind(start, read, kMaxStackFrames)) {
+            StackFrame entry;
+            entry.return_address = frame.pc;
+            entry.frame_pointer = frame.frame_pointer;
+            entry.stack_pointer = frame.stack_pointer;
+            entry.function_name = process_maps.get_function_name(frame.pc);
+            trace.push_back(entry);
+        }
+    });
+    return trace;
+}
+
+std::vector<uint64_t> DebuggerEngine::get_stack_data(size_t frame_count) {
+    std::vector<uint64_t> pcs;
+    if (!update_register_cache()) return pcs;
     
+    UnwindRegisters start = StackUnwinder::registers_from(register_cache.get_general());
+    StackReader read = [this](uint64_t address, uint8_t* buffer, size_t size) {
+        return memory_cache.read(address, buffer, size);
+    };
+    std::vector<UnwindFrame> frames(frame_count);
+    tracer.execute([&]() {
+        sync_process_maps();
+        frames.resize(unwinder.unwind(start, read, frames.data(), frame_count));
+    });
+    
+    pcs.reserve(frames.size());
+    for (const UnwindFrame& frame : frames) pcs.push_back(frame.pc);
+    return pcs;
+}
+
+UnwinderStats DebuggerEngine::get_unwinder_stats() {
+    UnwinderStats stats{};
+    tracer.execute([&]() { stats = unwinder.get_stats(); });
+    return stats;
+}
+
+bool DebuggerEngine::start_profiling(unsigned frequency_hz) {
+    if (target_pid == -1) {
+        last_error = "No process attached";
+        return false;
+    }
+    if (frequency_hz == 0) {
+        last_error = "Sampling frequency must be positive";
+        return false;
+    }
+    
+    // Each sample is unwound as it arrives, so only pcs are kept and the
+    // kernel's stack copy can be dropped straight away
+    bool started = false;
+    pid_t pid = target_pid;
+    tracer.execute([&]() {
+        profiler.clear();
+        started = tracer.start_sampling(pid, frequency_hz, [this](pid_t, const UnwindRegisters& regs, const StackReader& read) {
+            UnwindFrame frames[kMaxStackFrames];
+            profiler.add_sample(frames, unwinder.unwind(regs, read, frames, kMaxStackFrames));
+        });
+    });
+    if (!started) {
+        last_error = "Failed to start sampling";
+        return false;
+    }
     return true;
 }
 
-uint64_t DebuggerEngine::get_instruction_pointer() {
-    if (target_pid == -1) return 0;
+void DebuggerEngine::stop_profiling() {
+    tracer.execute([&]() {
+        tracer.stop_sampling();
+        resolve_profile_names();
+    });
+}
+
+bool DebuggerEngine::is_profiling() {
+    bool sampling = false;
+    tracer.execute([&]() { sampling = tracer.is_sampling(); });
+    return sampling;
+}
+
+ProfileSummary DebuggerEngine::get_profile() {
+    ProfileSummary summary{};
+    tracer.execute([&]() {
+        resolve_profile_names();
+        summary = profiler.summarize();
+        SamplingStats stats = tracer.get_sampling_stats();
+        summary.lost_samples = stats.lost;
+        summary.mode = stats.mode;
+        summary.stop_time = stats.stop_time;
+    });
+    return summary;
+}
+
+bool DebuggerEngine::export_folded_stacks(const std::string& path) {
+    bool exported = false;
+    tracer.execute([&]() {
+        resolve_profile_names();
+        exported = profiler.export_folded(path);
+    });
+    if (!exported) {
+        last_error = "Failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+void DebuggerEngine::attach_process_maps(pid_t pid) {
+    if (pid == -1) {
+        process_maps.detach();
+        loader_breakpoint = 0;
+        return;
+    }
+    
+    // The kernel maps the dynamic linker along with the executable, so its
+    // r_brk hook (called around every library load and unload) can be
+    // watched from the very first stop. Statically linked targets have none.
+    process_maps.attach(pid);
+    loader_breakpoint = 0;
+    for (const LoadedModule& module : process_maps.get_modules()) {
+        std::string file_name = module.path.substr(module.path.rfind('/') + 1);
+        if (file_name.compare(0, 3, "ld-") != 0 && file_name.compare(0, 5, "ld.so") != 0) continue;
+        
+        uint64_t hook = process_maps.resolve_symbol(file_name + "!_dl_debug_state");
+        if (hook != 0 && tracer.insert_breakpoints({hook}, true) == 1) {
+            loader_breakpoint = hook;
+            loader_hits = 0;
+        }
+        break;
+    }
+}
+
+void DebuggerEngine::sync_process_maps() {
+    if (loader_breakpoint != 0) {
+        uint64_t hits = tracer.get_breakpoint_hits(loader_breakpoint);
+        if (hits != loader_hits) {
+            loader_hits = hits;
+            process_maps.invalidate_modules();
+        }
+    }
+    if (regions_stale) {
+        regions_stale = false;
+        process_maps.invalidate_regions();
+    }
+}
+
+void DebuggerEngine::resolve_profile_names() {
+    sync_process_maps();
+    profiler.resolve_names([this](uint64_t pc) { return process_maps.get_function_name(pc); });
+}
+
+void DebuggerEngine::set_event_notifier(std::function<void()> notifier) {
+    tracer.set_event_notifier(std::move(notifier));
+}
+
+void DebuggerEngine::process_pending_events() {
+    tracer.acknowledge_events();
+    
+    TraceEvent event;
+    while (tracer.pop_event(event)) {
+        handle_event(event);
+    }
+}
+
+void DebuggerEngine::handle_event(const TraceEvent& event) {
+    // Left over from a session that has since been stopped or detached
+    if (event.pid != target_pid) {
+        return;
+    }
+    
+    // A new stop. In non-stop mode the thread we were showing may still be
+    // stopped with writes pending, so apply them before moving on
+    flush_register_cache();
+    regions_stale = true;
+    if (event.type != TraceEventType::EXITED && event.type != TraceEventType::KILLED) {
+        current_thread = event.tid;
+        last_stop_time = event.timestamp_ns;
+    }
     
-    // This is architecture-specific
-    // For x86-64, RIP is at offset 128 in user_regs_struct
-    errno = 0;
-    long rip = ptrace(PTRACE_PEEKUSER, target_pid, 8 * 16, nullptr); // RIP offset
-    if (errno != 0) return 0;
+    switch (event.type) {
+        case TraceEventType::BREAKPOINT:
+            current_state = DebuggerState::PAUSED;
+            if (!handle_breakpoint(event.address) && signal_callback) {
+                // Not one of ours, e.g. an int3 compiled into the program
+                signal_callback(SIGTRAP);
+            }
+            break;
+        case TraceEventType::WATCHPOINT:
+            current_state = DebuggerState::PAUSED;
+            if (watchpoint_callback) watchpoint_callback(event.address, event.value);
+            break;
+        case TraceEventType::STEP:
+        case TraceEventType::INTERRUPT:
+            current_state = DebuggerState::PAUSED;
+            if (stop_callback) stop_callback(event.address);
+            break;
+        case TraceEventType::SIGNAL:
+            current_state = DebuggerState::PAUSED;
+            if (signal_callback) signal_callback(event.value);
+            break;
+        case TraceEventType::EXEC:
+            // The old image is gone, and with it every inserted breakpoint
+            current_state = DebuggerState::PAUSED;
+            breakpoints.clear();
+            memory.attach(target_pid);
+            tracer.execute([&]() {
+                // Samples from the old image can only be named now
+                resolve_profile_names();
+                attach_process_maps(event.pid);
+            });
+            memory_cache.clear();
+            register_cache.clear();
+            if (stop_callback) stop_callback(event.address);
+            break;
+        case TraceEventType::EXITED:
+        case TraceEventType::KILLED:
+            current_state = DebuggerState::STOPPED;
+            target_pid = -1;
+            current_thread = -1;
+            memory.detach();
+            tracer.execute([&]() {
+                resolve_profile_names();
+                attach_process_maps(-1);
+            });
+            memory_cache.clear();
+            register_cache.clear();
+            // Shell convention: 128 + signal for a process killed by a signal
+            if (exit_callback) exit_callback(event.type == TraceEventType::EXITED ? event.value : 128 + event.value);
+            break;
+    }
+}
+
+bool DebuggerEngine::handle_breakpoint(uint64_t address) {
+    auto it = breakpoints.find(address);
+    if (it == breakpoints.end()) {
+        return false;
+    }
     
-    return static_cast<uint64_t>(rip);
+    if (breakpoint_callback) breakpoint_callback(address);
+    return true;
 }
 
 // Stub implementations for remaining methods
-bool DebuggerEngine::add_conditional_breakpoint(uint64_t, const std::string&) { return false; }
-bool DebuggerEngine::remove_breakpoint(uint64_t address) { return remove_software_breakpoint(address); }
-bool DebuggerEngine::enable_breakpoint(uint64_t) { return false; }
-bool DebuggerEngine::disable_breakpoint(uint64_t) { return false; }
-std::vector<Breakpoint> DebuggerEngine::get_breakpoints() const { 
+
+bool DebuggerEngine::remove_breakpoint(uint64_t address) {
+    auto it = breakpoints.find(address);
+    if (it == breakpoints.end()) {
+        last_error = "Breakpoint not found";
+        return false;
+    }
+    
+    // A disabled breakpoint is already out of the tracee
+    if (it->second.enabled && is_hardware(it->second)) {
+        if (!set_hardware_breakpoint(it->second, false)) return false;
+    } else if (it->second.enabled && remove_software_breakpoints({address}) == 0) {
+        last_error = "Failed to restore original instruction";
+        return false;
+    }
+    
+    breakpoints.erase(it);
+    return true;
+}
+
+size_t DebuggerEngine::remove_breakpoints(const std::vector<uint64_t>& addresses) {
+    std::vector<uint64_t> enabled;
+    size_t removed = 0;
+    for (uint64_t address : addresses) {
+        auto it = breakpoints.find(address);
+        if (it == breakpoints.end()) continue;
+        if (it->second.enabled && is_hardware(it->second)) {
+            set_hardware_breakpoint(it->second, false);
+        } else if (it->second.enabled) {
+            enabled.push_back(address);
+        }
+        breakpoints.erase(it);
+        ++removed;
+    }
+    
+    remove_software_breakpoints(enabled);
+    return removed;
+}
+
+bool DebuggerEngine::enable_breakpoint(uint64_t address) {
+    auto it = breakpoints.find(address);
+    if (it == breakpoints.end()) {
+        last_error = "Breakpoint not found";
+        return false;
+    }
+    if (it->second.enabled) {
+        return true;
+    }
+    
+    if (is_hardware(it->second)) {
+        return set_hardware_breakpoint(it->second, true);
+    }
+    if (insert_software_breakpoints({address}, it->second.tracing) == 0) {
+        last_error = "Failed to write breakpoint instruction";
+        return false;
+    }
+    return true;
+}
+
+bool DebuggerEngine::disable_breakpoint(uint64_t address) {
+    auto it = breakpoints.find(address);
+    if (it == breakpoints.end()) {
+        last_error = "Breakpoint not found";
+        return false;
+    }
+    if (!it->second.enabled) {
+        return true;
+    }
+    
+    if (is_hardware(it->second)) {
+        return set_hardware_breakpoint(it->second, false);
+    }
+    if (remove_software_breakpoints({address}) == 0) {
+        last_error = "Failed to restore original instruction";
+        return false;
+    }
+    it->second.enabled = false;
+    return true;
+}
+
+std::vector<Breakpoint> DebuggerEngine::get_breakpoints() { 
+    // Hits are counted on the tracer thread, which never stops to tell us
+    std::vector<BreakpointStats> stats;
+    std::vector<HardwareBreakpointInfo> hardware;
+    tracer.execute([&]() {
+        stats = tracer.get_breakpoint_stats();
+        hardware = tracer.get_hardware_breakpoints();
+    });
+    
     std::vector<Breakpoint> result;
     for (const auto& pair : breakpoints) {
         result.push_back(pair.second);
+        if (is_hardware(pair.second)) {
+            for (const auto& entry : hardware) {
+                if (entry.address == pair.first && entry.kind == pair.second.watch_kind) {
+                    result.back().hit_count = entry.hit_count;
+                }
+            }
+            continue;
+        }
+        for (const auto& entry : stats) {
+            if (entry.address == pair.first) {
+                result.back().hit_count = entry.hit_count;
+                result.back().hit_latency = entry.latency;
+                break;
+            }
+        }
     }
     return result;
 }
+
+void DebuggerEngine::reset_breakpoint_stats() {
+    tracer.execute([&]() { tracer.reset_breakpoint_stats(); });
+}
 bool DebuggerEngine::is_breakpoint_hit(uint64_t address) const { 
     return breakpoints.find(address) != breakpoints.end();
 }
-std::vector<MemoryRegion> DebuggerEngine::get_memory_regions() { return {}; }
+std::vector<MemoryRegion> DebuggerEngine::get_memory_regions() {
+    std::vector<MemoryRegion> result;
+    if (target_pid == -1) return result;
+    
+    tracer.execute([&]() {
+        sync_process_maps();
+        const std::vector<MapEntry>& regions = process_maps.get_regions();
+        result.reserve(regions.size());
+        for (const MapEntry& entry : regions) {
+            result.push_back(MemoryRegion{entry.start, entry.end, entry.permissions, entry.path, {}});
+        }
+    });
+    return result;
+}
 bool DebuggerEngine::set_memory_protection(uint64_t, size_t, const std::string&) { return false; }
-std::vector<Register> DebuggerEngine::get_registers() { return {}; }
-bool DebuggerEngine::set_register(const std::string&, uint64_t) { return false; }
-uint64_t DebuggerEngine::get_register_value(const std::string&) { return 0; }
-uint64_t DebuggerEngine::get_stack_pointer() { return 0; }
-uint64_t DebuggerEngine::get_frame_pointer() { return 0; }
-std::vector<StackFrame> DebuggerEngine::get_stack_trace() { return {}; }
-std::vector<uint64_t> DebuggerEngine::get_stack_data(size_t) { return {}; }
 DebuggerState DebuggerEngine::get_state() const { return current_state; }
 pid_t DebuggerEngine::get_process_id() const { return target_pid; }
 std::string DebuggerEngine::get_last_error() const { return last_error; }
+uint64_t DebuggerEngine::get_last_stop_time() const { return last_stop_time; }
 void DebuggerEngine::set_breakpoint_callback(std::function<void(uint64_t)> callback) { breakpoint_callback = callback; }
+void DebuggerEngine::set_watchpoint_callback(std::function<void(uint64_t, uint64_t)> callback) { watchpoint_callback = callback; }
+void DebuggerEngine::set_stop_callback(std::function<void(uint64_t)> callback) { stop_callback = callback; }
 void DebuggerEngine::set_signal_callback(std::function<void(int)> callback) { signal_callback = callback; }
 void DebuggerEngine::set_exit_callback(std::function<void(int)> callback) { exit_callback = callback; }
 bool DebuggerEngine::is_process_running() const { return target_pid != -1; }
-std::string DebuggerEngine::get_current_function_name(uint64_t) { return ""; }
-uint64_t DebuggerEngine::resolve_symbol(const std::string&) { return 0; }
-std::vector<std::string> DebuggerEngine::get_loaded_modules() { return {}; }
+std::string DebuggerEngine::get_current_function_name(uint64_t address) {
+    if (target_pid == -1) return "";
+    if (address == 0) address = get_instruction_pointer();
+    
+    std::string name;
+    tracer.execute([&]() {
+        sync_process_maps();
+        name = process_maps.get_function_name(address);
+    });
+    return name;
+}
+uint64_t DebuggerEngine::resolve_symbol(const std::string& symbol_name) {
+    if (target_pid == -1) return 0;
+    
+    uint64_t address = 0;
+    tracer.execute([&]() {
+        sync_process_maps();
+        address = process_maps.resolve_symbol(symbol_name);
+    });
+    return address;
+}
+std::vector<std::string> DebuggerEngine::get_loaded_modules() {
+    std::vector<std::string> paths;
+    if (target_pid == -1) return paths;
+    
+    tracer.execute([&]() {
+        sync_process_maps();
+        for (const LoadedModule& module : process_maps.get_modules()) paths.push_back(module.path);
+    });
+    return paths;
+}
 bool DebuggerEngine::setup_debugging() { return true; }
-bool DebuggerEngine::cleanup_debugging() { return true; }
-bool DebuggerEngine::wait_for_signal() { return true; }
-bool DebuggerEngine::handle_breakpoint(uint64_t) { return true; }
-bool DebuggerEngine::evaluate_condition(const std::string&) { return true; }
-void DebuggerEngine::update_register_cache() {}
+bool DebuggerEngine::cleanup_debugging() {
+    if (target_pid == -1) return true;
+    // Processes we started go down with the session; attached ones are let go
+    if (owns_process) return stop_execution();
+    return detach();
+}
 bool DebuggerEngine::is_valid_address(uint64_t) { return true; }
 std::string DebuggerEngine::get_protection_string(int) { return ""; }
 
@@ -1,21 +1,589 @@
-#include "debugger_engine.h"
+#include "memory_manager.h"
+#include "ptrace_call.h"
+#include <sys/ptrace.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 
 namespace debugger {
 
-// Memory management stubs
-class MemoryManager {
-public:
-    static std::vector<uint8_t> readMemory(uint64_t address, size_t size) {
-        return {};
+namespace {
+
+constexpr uint64_t kPageSize = 4096;
+
+// process_vm_readv accepts at most IOV_MAX remote segments per call
+#ifdef IOV_MAX
+constexpr size_t kMaxRemoteSegments = IOV_MAX;
+#else
+constexpr size_t kMaxRemoteSegments = 1024;
+#endif
+
+// Split [address, address + size) into page-bounded remote segments so a
+// partial transfer stops exactly at the first inaccessible page
+size_t build_remote_segments(uint64_t address, size_t size, std::vector<iovec>& segments) {
+    segments.clear();
+    size_t covered = 0;
+    
+    while (covered < size && segments.size() < kMaxRemoteSegments) {
+        uint64_t current = address + covered;
+        size_t chunk = static_cast<size_t>(kPageSize - (current & (kPageSize - 1)));
+        chunk = std::min(chunk, size - covered);
+        
+        iovec segment;
+        segment.iov_base = reinterpret_cast<void*>(current);
+        segment.iov_len = chunk;
+        segments.push_back(segment);
+        
+        covered += chunk;
+    }
+    
+    return covered;
+}
+
+} // namespace
+
+MemoryManager::MemoryManager()
+    : target_pid(-1), proc_mem_fd(-1), process_vm_read_available(true),
+      process_vm_write_available(true), proc_mem_available(true),
+      proc_mem_writable(true) {
+}
+
+MemoryManager::~MemoryManager() {
+    detach();
+}
+
+void MemoryManager::attach(pid_t pid) {
+    detach();
+    target_pid = pid;
+    process_vm_read_available = true;
+    process_vm_write_available = true;
+    proc_mem_available = true;
+    proc_mem_writable = true;
+}
+
+void MemoryManager::detach() {
+    close_proc_mem();
+    target_pid = -1;
+}
+
+bool MemoryManager::is_attached() const {
+    return target_pid != -1;
+}
+
+size_t MemoryManager::read(uint64_t address, uint8_t* buffer, size_t size) {
+    if (target_pid == -1 || !buffer || size == 0) {
+        return 0;
+    }
+    
+    PERF_SCOPE("Tracee memory read", "memory");
+    size_t done = 0;
+    
+    if (process_vm_read_available) {
+        done = read_process_vm(address, buffer, size);
+        if (done == size) {
+            return done;
+        }
+    }
+    
+    // process_vm_readv honours the tracee's page protections; /proc/<pid>/mem
+    // does not for an attached tracer, so retry the rest of the range there
+    if (proc_mem_available) {
+        done += read_proc_mem(address + done, buffer + done, size - done);
+        if (done == size) {
+            return done;
+        }
+    }
+    
+    done += read_ptrace(address + done, buffer + done, size - done);
+    return done;
+}
+
+bool MemoryManager::write(uint64_t address, const uint8_t* data, size_t size) {
+    if (target_pid == -1 || !data) {
+        return false;
+    }
+    
+    if (size == 0) {
+        return true;
+    }
+    
+    size_t done = 0;
+    
+    // process_vm_writev honours page protections, so writes into read-only
+    // text (breakpoints, patches) fall through to /proc/<pid>/mem
+    if (process_vm_write_available) {
+        done = write_process_vm(address, data, size);
+        if (done == size) {
+            return true;
+        }
+    }
+    
+    if (proc_mem_available && proc_mem_writable) {
+        done += write_proc_mem(address + done, data + done, size - done);
+        if (done == size) {
+            return true;
+        }
+    }
+    
+    done += write_ptrace(address + done, data + done, size - done);
+    return done == size;
+}
+
+bool MemoryManager::write_code(uint64_t address, const uint8_t* data, size_t size) {
+    if (target_pid == -1 || !data) {
+        return false;
+    }
+    
+    size_t done = 0;
+    if (proc_mem_available && proc_mem_writable) {
+        done = write_proc_mem(address, data, size);
+        if (done == size) {
+            return true;
+        }
+    }
+    
+    done += write_ptrace(address + done, data + done, size - done);
+    return done == size;
+}
+
+size_t MemoryManager::read_process_vm(uint64_t address, uint8_t* buffer, size_t size) {
+    std::vector<iovec> remote;
+    size_t done = 0;
+    
+    while (done < size) {
+        size_t batch = build_remote_segments(address + done, size - done, remote);
+        
+        iovec local;
+        local.iov_base = buffer + done;
+        local.iov_len = batch;
+        
+        ssize_t result = process_vm_readv(target_pid, &local, 1, remote.data(), remote.size(), 0);
+        if (result < 0) {
+            // ENOSYS (old kernel) and EPERM (restricted ptrace scope) will not
+            // change for this target, so stop trying
+            if (errno == ENOSYS || errno == EPERM) {
+                process_vm_read_available = false;
+            }
+            break;
+        }
+        
+        done += static_cast<size_t>(result);
+        if (static_cast<size_t>(result) < batch) {
+            break;
+        }
+    }
+    
+    return done;
+}
+
+size_t MemoryManager::write_process_vm(uint64_t address, const uint8_t* data, size_t size) {
+    std::vector<iovec> remote;
+    size_t done = 0;
+    
+    while (done < size) {
+        size_t batch = build_remote_segments(address + done, size - done, remote);
+        
+        iovec local;
+        local.iov_base = const_cast<uint8_t*>(data + done);
+        local.iov_len = batch;
+        
+        ssize_t result = process_vm_writev(target_pid, &local, 1, remote.data(), remote.size(), 0);
+        if (result < 0) {
+            if (errno == ENOSYS || errno == EPERM) {
+                process_vm_write_available = false;
+            }
+            break;
+        }
+        
+        done += static_cast<size_t>(result);
+        if (static_cast<size_t>(result) < batch) {
+            break;
+        }
+    }
+    
+    return done;
+}
+
+bool MemoryManager::open_proc_mem() {
+    if (proc_mem_fd != -1) {
+        return true;
+    }
+    
+    std::string path = "/proc/" + std::to_string(target_pid) + "/mem";
+    proc_mem_fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (proc_mem_fd == -1) {
+        proc_mem_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        proc_mem_writable = false;
+    }
+    
+    if (proc_mem_fd == -1) {
+        proc_mem_available = false;
+        return false;
+    }
+    
+    return true;
+}
+
+void MemoryManager::close_proc_mem() {
+    if (proc_mem_fd != -1) {
+        close(proc_mem_fd);
+        proc_mem_fd = -1;
+    }
+}
+
+size_t MemoryManager::read_proc_mem(uint64_t address, uint8_t* buffer, size_t size) {
+    if (!open_proc_mem()) {
+        return 0;
+    }
+    
+    size_t done = 0;
+    while (done < size) {
+        ssize_t result = pread(proc_mem_fd, buffer + done, size - done,
+                               static_cast<off_t>(address + done));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(result);
+    }
+    
+    return done;
+}
+
+size_t MemoryManager::write_proc_mem(uint64_t address, const uint8_t* data, size_t size) {
+    if (!open_proc_mem()) {
+        return 0;
+    }
+    
+    size_t done = 0;
+    while (done < size) {
+        ssize_t result = pwrite(proc_mem_fd, data + done, size - done,
+                                static_cast<off_t>(address + done));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EBADF || errno == EACCES || errno == EPERM)) {
+            // Descriptor was opened read-only or the kernel forbids writes
+            proc_mem_writable = false;
+            break;
+        }
+        if (result <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(result);
+    }
+    
+    return done;
+}
+
+size_t MemoryManager::read_ptrace(uint64_t address, uint8_t* buffer, size_t size) {
+    size_t done = 0;
+    
+    while (done < size) {
+        uint64_t current = address + done;
+        uint64_t aligned = current & ~static_cast<uint64_t>(sizeof(long) - 1);
+        size_t skip = static_cast<size_t>(current - aligned);
+        
+        errno = 0;
+        long word = timed_ptrace(PTRACE_PEEKDATA, target_pid, aligned, nullptr);
+        if (errno != 0) {
+            break;
+        }
+        
+        size_t chunk = std::min(sizeof(long) - skip, size - done);
+        std::memcpy(buffer + done, reinterpret_cast<uint8_t*>(&word) + skip, chunk);
+        done += chunk;
+    }
+    
+    return done;
+}
+
+size_t MemoryManager::write_ptrace(uint64_t address, const uint8_t* data, size_t size) {
+    size_t done = 0;
+    
+    while (done < size) {
+        uint64_t current = address + done;
+        uint64_t aligned = current & ~static_cast<uint64_t>(sizeof(long) - 1);
+        size_t skip = static_cast<size_t>(current - aligned);
+        size_t chunk = std::min(sizeof(long) - skip, size - done);
+        
+        long word = 0;
+        if (skip != 0 || chunk != sizeof(long)) {
+            // Partial word: merge with the bytes already in the tracee
+            errno = 0;
+            word = timed_ptrace(PTRACE_PEEKDATA, target_pid, aligned, nullptr);
+            if (errno != 0) {
+                break;
+            }
+        }
+        
+        std::memcpy(reinterpret_cast<uint8_t*>(&word) + skip, data + done, chunk);
+        if (timed_ptrace(PTRACE_POKEDATA, target_pid, aligned, word) == -1) {
+            break;
+        }
+        done += chunk;
+    }
+    
+    return done;
+}
+
+MemoryTransport MemoryManager::get_read_transport() const {
+    if (process_vm_read_available) return MemoryTransport::PROCESS_VM;
+    if (proc_mem_available) return MemoryTransport::PROC_MEM;
+    return MemoryTransport::PTRACE;
+}
+
+MemoryTransport MemoryManager::get_write_transport() const {
+    if (process_vm_write_available) return MemoryTransport::PROCESS_VM;
+    if (proc_mem_available && proc_mem_writable) return MemoryTransport::PROC_MEM;
+    return MemoryTransport::PTRACE;
+}
+
+std::string MemoryManager::get_transport_name(MemoryTransport transport) const {
+    switch (transport) {
+        case MemoryTransport::PROCESS_VM: return "process_vm";
+        case MemoryTransport::PROC_MEM: return "/proc/pid/mem";
+        case MemoryTransport::PTRACE: return "ptrace";
+        default: return "unknown";
+    }
+}
+
+MemoryCache::MemoryCache(MemoryManager& transport, size_t max_pages)
+    : transport(transport), max_pages(max_pages), current_epoch(1), use_clock(0), stats{} {
+}
+
+MemoryCache::Page* MemoryCache::find_fresh_page(uint64_t page_address) {
+    auto it = pages.find(page_address);
+    if (it == pages.end() || it->second.epoch != current_epoch) {
+        return nullptr;
+    }
+    it->second.last_use = use_clock;
+    return &it->second;
+}
+
+void MemoryCache::make_room(size_t page_count) {
+    if (pages.size() + page_count <= max_pages) {
+        return;
+    }
+    
+    // Stale lines from earlier stops are recycled in place; only drop them
+    // wholesale once the cache would outgrow its budget
+    for (auto it = pages.begin(); it != pages.end();) {
+        if (it->second.epoch != current_epoch) {
+            it = pages.erase(it);
+            stats.evictions++;
+        } else {
+            ++it;
+        }
+    }
+    if (pages.size() + page_count <= max_pages) {
+        return;
+    }
+    
+    // Then the least recently used lines of this stop, down to three quarters
+    // of the budget so a long stop doesn't pay for this on every miss. Lines
+    // the current read already touched are kept for its copy_out().
+    std::vector<std::pair<uint64_t, uint64_t>> candidates;  // last_use, address
+    candidates.reserve(pages.size());
+    for (const auto& entry : pages) {
+        if (entry.second.last_use != use_clock) {
+            candidates.emplace_back(entry.second.last_use, entry.first);
+        }
+    }
+    size_t target = max_pages - max_pages / 4;
+    size_t excess = pages.size() + page_count > target ? pages.size() + page_count - target : 0;
+    excess = std::min(excess, candidates.size());
+    std::nth_element(candidates.begin(), candidates.begin() + excess, candidates.end());
+    for (size_t i = 0; i < excess; ++i) {
+        pages.erase(candidates[i].second);
+    }
+    stats.evictions += excess;
+}
+
+void MemoryCache::store_page(uint64_t page_address, const uint8_t* data, size_t valid_bytes) {
+    Page& page = pages[page_address];
+    page.epoch = current_epoch;
+    page.last_use = use_clock;
+    page.valid_bytes = static_cast<uint32_t>(valid_bytes);
+    std::memcpy(page.bytes.data(), data, valid_bytes);
+}
+
+void MemoryCache::fill_pages(uint64_t first_page, size_t page_count) {
+    make_room(page_count);
+    
+    size_t size = page_count * PAGE_SIZE;
+    fill_buffer.resize(size);
+    size_t got = transport.read(first_page, fill_buffer.data(), size);
+    
+    stats.transfers++;
+    stats.bytes_fetched += got;
+    
+    // The transfer stops at the first unreadable byte, so only the pages up
+    // to and including the one it stopped in are known. A short page read on
+    // its own is really unreadable past valid_bytes; remembering that lets
+    // repeated probes of an unmapped address cost nothing for the rest of
+    // the stop.
+    size_t known = std::min(page_count, got / PAGE_SIZE + 1);
+    for (size_t i = 0; i < known; ++i) {
+        size_t offset = i * PAGE_SIZE;
+        store_page(first_page + offset, fill_buffer.data() + offset,
+                   got > offset ? std::min<size_t>(PAGE_SIZE, got - offset) : 0);
+    }
+    
+    // Mapped pages can follow a hole, so fetch the rest one at a time
+    for (size_t i = known; i < page_count; ++i) {
+        uint64_t page_address = first_page + i * PAGE_SIZE;
+        size_t page_got = transport.read(page_address, fill_buffer.data(), PAGE_SIZE);
+        stats.transfers++;
+        stats.bytes_fetched += page_got;
+        store_page(page_address, fill_buffer.data(), page_got);
+    }
+}
+
+size_t MemoryCache::read(uint64_t address, uint8_t* buffer, size_t size) {
+    if (!buffer || size == 0) {
+        return 0;
+    }
+    
+    use_clock++;
+    uint64_t first_page = address & ~(PAGE_SIZE - 1);
+    uint64_t last_page = (address + size - 1) & ~(PAGE_SIZE - 1);
+    
+    // Fetch every missing page of the request, one transfer per missing run
+    uint64_t run_start = 0;
+    size_t run_length = 0;
+    for (uint64_t page = first_page; ; page += PAGE_SIZE) {
+        bool missing = find_fresh_page(page) == nullptr;
+        if (missing) {
+            stats.misses++;
+            PERF_COUNT("Memory cache misses", "memory", 1);
+            if (run_length == 0) {
+                run_start = page;
+            }
+            run_length++;
+        } else {
+            stats.hits++;
+            PERF_COUNT("Memory cache hits", "memory", 1);
+        }
+        
+        if ((!missing || page == last_page) && run_length > 0) {
+            fill_pages(run_start, run_length);
+            run_length = 0;
+        }
+        
+        if (page == last_page) {
+            break;
+        }
     }
     
-    static bool writeMemory(uint64_t address, const std::vector<uint8_t>& data) {
+    return copy_out(address, buffer, size);
+}
+
+bool MemoryCache::read_cached(uint64_t address, uint8_t* buffer, size_t size, size_t& copied) {
+    copied = 0;
+    if (!buffer || size == 0) {
         return true;
     }
     
-    static std::vector<MemoryRegion> getMemoryMap() {
-        return {};
+    use_clock++;
+    // Pages after a partly readable one are never copied, so they need not
+    // be cached either
+    uint64_t last_page = (address + size - 1) & ~(PAGE_SIZE - 1);
+    uint64_t page_hits = 0;
+    for (uint64_t page = address & ~(PAGE_SIZE - 1); ; page += PAGE_SIZE) {
+        const Page* cached = find_fresh_page(page);
+        if (!cached) {
+            return false;
+        }
+        page_hits++;
+        if (cached->valid_bytes < PAGE_SIZE || page == last_page) {
+            break;
+        }
+    }
+    
+    stats.hits += page_hits;
+    PERF_COUNT("Memory cache hits", "memory", page_hits);
+    copied = copy_out(address, buffer, size);
+    return true;
+}
+
+// Copies out of the cache lines, stopping at the first unreadable byte
+size_t MemoryCache::copy_out(uint64_t address, uint8_t* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        uint64_t current = address + done;
+        uint64_t page_address = current & ~(PAGE_SIZE - 1);
+        size_t offset = static_cast<size_t>(current - page_address);
+        
+        Page* page = find_fresh_page(page_address);
+        if (!page || page->valid_bytes <= offset) {
+            break;
+        }
+        
+        size_t chunk = std::min<size_t>(page->valid_bytes - offset, size - done);
+        std::memcpy(buffer + done, page->bytes.data() + offset, chunk);
+        done += chunk;
+        
+        if (page->valid_bytes < PAGE_SIZE) {
+            break;
+        }
+    }
+    
+    return done;
+}
+
+bool MemoryCache::write(uint64_t address, const uint8_t* data, size_t size) {
+    bool ok = transport.write(address, data, size);
+    
+    size_t done = 0;
+    while (done < size) {
+        uint64_t current = address + done;
+        uint64_t page_address = current & ~(PAGE_SIZE - 1);
+        size_t offset = static_cast<size_t>(current - page_address);
+        size_t chunk = std::min<size_t>(PAGE_SIZE - offset, size - done);
+        
+        auto it = pages.find(page_address);
+        if (it != pages.end()) {
+            if (ok && it->second.epoch == current_epoch && it->second.valid_bytes >= offset + chunk) {
+                // Write through so the next read sees the new bytes
+                std::memcpy(it->second.bytes.data() + offset, data + done, chunk);
+            } else {
+                // Partially failed or partially valid: refetch on next read
+                pages.erase(it);
+            }
+        }
+        
+        done += chunk;
     }
-};
+    
+    return ok;
+}
+
+void MemoryCache::invalidate() {
+    current_epoch++;
+    stats.invalidations++;
+}
+
+void MemoryCache::clear() {
+    pages.clear();
+    current_epoch++;
+}
+
+MemoryCacheStats MemoryCache::get_stats() const {
+    MemoryCacheStats result = stats;
+    result.cached_pages = pages.size();
+    return result;
+}
+
+void MemoryCache::reset_stats() {
+    stats = MemoryCacheStats{};
+}
 
 } // namespace debugger 
\ No newline at end of file
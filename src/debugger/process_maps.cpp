@@ -0,0 +1,252 @@
+#include "process_maps.h"
+#include "elf_parser.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace debugger {
+
+// How often lookups that miss every module may reread the maps of a target
+// that keeps running, e.g. while it is being sampled
+static constexpr std::chrono::milliseconds kMissRefreshInterval(250);
+
+ProcessMaps::ProcessMaps()
+    : target_pid(-1), modules_stale(true), regions_stale(true), generation(0) {
+}
+
+ProcessMaps::~ProcessMaps() = default;
+
+void ProcessMaps::attach(pid_t pid) {
+    target_pid = pid;
+    regions.clear();
+    modules.clear();
+    modules_stale = true;
+    regions_stale = true;
+    ++generation;
+    
+    executable_path.clear();
+    if (pid != -1) {
+        char path[4096];
+        ssize_t length = readlink(("/proc/" + std::to_string(pid) + "/exe").c_str(), path, sizeof(path) - 1);
+        if (length > 0) executable_path.assign(path, static_cast<size_t>(length));
+    }
+}
+
+void ProcessMaps::detach() {
+    attach(-1);
+}
+
+bool ProcessMaps::refresh() {
+    modules_stale = false;
+    regions_stale = false;
+    last_refresh = std::chrono::steady_clock::now();
+    if (target_pid == -1) {
+        regions.clear();
+        modules.clear();
+        return false;
+    }
+    
+    FILE* maps = std::fopen(("/proc/" + std::to_string(target_pid) + "/maps").c_str(), "re");
+    if (!maps) {
+        return false;
+    }
+    
+    // Modules keep their parsed images across the rebuild
+    std::vector<LoadedModule> previous;
+    previous.swap(modules);
+    regions.clear();
+    
+    char line[4096 + 128];
+    std::unordered_map<std::string, uint32_t> module_index;
+    while (std::fgets(line, sizeof(line), maps)) {
+        MapEntry entry{};
+        int path_start = 0;
+        if (std::sscanf(line, "%" SCNx64 "-%" SCNx64 " %4s %" SCNx64 " %*s %*s %n",
+                        &entry.start, &entry.end, entry.permissions, &entry.offset, &path_start) < 4) {
+            continue;
+        }
+        entry.module = NO_MODULE;
+        if (path_start > 0) {
+            entry.path = line + path_start;
+            while (!entry.path.empty() && (entry.path.back() == '\n' || entry.path.back() == ' ')) entry.path.pop_back();
+        }
+        regions.push_back(std::move(entry));
+    }
+    std::fclose(maps);
+    
+    // A file becomes a module once any of its mappings is executable; the
+    // module then covers every mapping of it, data included
+    for (const MapEntry& entry : regions) {
+        if (entry.permissions[2] == 'x' && !entry.path.empty() && entry.path[0] == '/') {
+            module_index.emplace(entry.path, NO_MODULE);
+        }
+    }
+    for (MapEntry& entry : regions) {
+        auto found = module_index.find(entry.path);
+        if (found == module_index.end()) continue;
+        if (found->second == NO_MODULE) {
+            found->second = static_cast<uint32_t>(modules.size());
+            modules.push_back(LoadedModule{entry.path, entry.start, entry.end, entry.start, entry.offset, 0, nullptr});
+        }
+        LoadedModule& module = modules[found->second];
+        module.end = std::max(module.end, entry.end);
+        entry.module = found->second;
+    }
+    
+    bool changed = previous.size() != modules.size();
+    for (size_t i = 0; i < modules.size(); ++i) {
+        LoadedModule& module = modules[i];
+        if (!changed && (previous[i].path != module.path || previous[i].start != module.start)) {
+            changed = true;
+        }
+        
+        // Reparse only when the file on disk changed since we last saw it
+        struct stat info;
+        if (stat(module.path.c_str(), &info) != 0) continue;
+        CachedImage& image = images[module.path];
+        if (image.device != info.st_dev || image.inode != info.st_ino || image.modified != info.st_mtime) {
+            image = CachedImage{info.st_dev, info.st_ino, info.st_mtime, false, nullptr};
+        }
+        if (image.parsed && image.elf) {
+            module.elf = image.elf;
+            uint64_t link_address = module.elf->file_to_virtual_offset(module.first_offset);
+            module.bias = link_address == ~0ULL ? 0 : module.first_mapping - link_address;
+        }
+    }
+    if (changed) {
+        ++generation;
+    }
+    return true;
+}
+
+void ProcessMaps::invalidate_modules() {
+    modules_stale = true;
+}
+
+void ProcessMaps::invalidate_regions() {
+    regions_stale = true;
+}
+
+uint64_t ProcessMaps::get_generation() const {
+    return generation;
+}
+
+void ProcessMaps::ensure_current(bool need_regions) {
+    if (modules_stale || (need_regions && regions_stale)) {
+        refresh();
+    }
+}
+
+const std::vector<MapEntry>& ProcessMaps::get_regions() {
+    ensure_current(true);
+    return regions;
+}
+
+const std::vector<LoadedModule>& ProcessMaps::get_modules() {
+    ensure_current(false);
+    return modules;
+}
+
+const MapEntry* ProcessMaps::find_region(uint64_t address) {
+    ensure_current(true);
+    auto it = std::upper_bound(regions.begin(), regions.end(), address,
+                               [](uint64_t value, const MapEntry& entry) { return value < entry.start; });
+    if (it == regions.begin()) return nullptr;
+    --it;
+    return address < it->end ? &*it : nullptr;
+}
+
+const LoadedModule* ProcessMaps::lookup_module(uint64_t address) const {
+    auto it = std::upper_bound(modules.begin(), modules.end(), address,
+                               [](uint64_t value, const LoadedModule& module) { return value < module.start; });
+    if (it == modules.begin()) return nullptr;
+    --it;
+    return address < it->end ? &*it : nullptr;
+}
+
+const LoadedModule* ProcessMaps::find_module(uint64_t address) {
+    ensure_current(false);
+    const LoadedModule* module = lookup_module(address);
+    if (!module && target_pid != -1 &&
+        (regions_stale || std::chrono::steady_clock::now() - last_refresh >= kMissRefreshInterval)) {
+        // Probably something dlopen()ed since the last look. Code that is in
+        // no file ([vdso], JIT output) keeps missing, hence the limit.
+        refresh();
+        module = lookup_module(address);
+    }
+    if (module && !module->elf) {
+        load_module(static_cast<size_t>(module - modules.data()));
+    }
+    return module;
+}
+
+bool ProcessMaps::load_module(size_t index) {
+    LoadedModule& module = modules[index];
+    auto it = images.find(module.path);
+    if (it == images.end()) {
+        return false;
+    }
+    
+    CachedImage& image = it->second;
+    if (!image.parsed) {
+        image.parsed = true;
+        auto elf = std::make_shared<ElfParser>();
+        if (elf->load_file(module.path)) {
+            image.elf = std::move(elf);
+        }
+    }
+    if (!image.elf) {
+        return false;
+    }
+    
+    module.elf = image.elf;
+    uint64_t link_address = module.elf->file_to_virtual_offset(module.first_offset);
+    module.bias = link_address == ~0ULL ? 0 : module.first_mapping - link_address;
+    return true;
+}
+
+std::string ProcessMaps::get_function_name(uint64_t address) {
+    const LoadedModule* module = find_module(address);
+    if (!module || !module->elf) return "";
+    return module->elf->get_function_name(address - module->bias);
+}
+
+uint64_t ProcessMaps::resolve_symbol(const std::string& name) {
+    ensure_current(false);
+    
+    std::string file_name;
+    std::string symbol_name = name;
+    size_t separator = name.find('!');
+    if (separator != std::string::npos) {
+        file_name = name.substr(0, separator);
+        symbol_name = name.substr(separator + 1);
+    }
+    
+    // The executable first, so its definitions win over same-named library ones
+    std::vector<size_t> order;
+    for (size_t i = 0; i < modules.size(); ++i) {
+        if (!file_name.empty()) {
+            size_t slash = modules[i].path.rfind('/');
+            if (modules[i].path.compare(slash + 1, std::string::npos, file_name) != 0) continue;
+        }
+        if (modules[i].path == executable_path) {
+            order.insert(order.begin(), i);
+        } else {
+            order.push_back(i);
+        }
+    }
+    
+    for (size_t index : order) {
+        if (!modules[index].elf && !load_module(index)) continue;
+        Symbol symbol = modules[index].elf->find_symbol(symbol_name);
+        if (symbol.address != 0 && !symbol.is_imported) {
+            return symbol.address + modules[index].bias;
+        }
+    }
+    return 0;
+}
+
+} // namespace debugger 
\ No newline at end of file
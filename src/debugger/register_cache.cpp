@@ -0,0 +1,291 @@
+#include "register_cache.h"
+#include "ptrace_call.h"
+#include <sys/ptrace.h>
+#include <sys/user.h>
+#include <sys/uio.h>
+#include <elf.h>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+namespace debugger {
+
+namespace {
+
+#if defined(__x86_64__)
+#define REGISTER(name, field, width, listed) {name, offsetof(struct user_regs_struct, field), width, listed}
+static const RegisterLayout kRegisters[] = {
+    REGISTER("rax", rax, 8, true), REGISTER("rbx", rbx, 8, true), REGISTER("rcx", rcx, 8, true),
+    REGISTER("rdx", rdx, 8, true), REGISTER("rsi", rsi, 8, true), REGISTER("rdi", rdi, 8, true),
+    REGISTER("rsp", rsp, 8, true), REGISTER("rbp", rbp, 8, true),
+    REGISTER("r8", r8, 8, true),   REGISTER("r9", r9, 8, true),   REGISTER("r10", r10, 8, true),
+    REGISTER("r11", r11, 8, true), REGISTER("r12", r12, 8, true), REGISTER("r13", r13, 8, true),
+    REGISTER("r14", r14, 8, true), REGISTER("r15", r15, 8, true),
+    REGISTER("rip", rip, 8, true), REGISTER("rflags", eflags, 8, true),
+    REGISTER("cs", cs, 8, true), REGISTER("ds", ds, 8, true), REGISTER("es", es, 8, true),
+    REGISTER("fs", fs, 8, true), REGISTER("gs", gs, 8, true), REGISTER("ss", ss, 8, true),
+    REGISTER("fs_base", fs_base, 8, true), REGISTER("gs_base", gs_base, 8, true),
+    REGISTER("eflags", eflags, 8, false), REGISTER("orig_rax", orig_rax, 8, false),
+    REGISTER("eax", rax, 4, false), REGISTER("ebx", rbx, 4, false), REGISTER("ecx", rcx, 4, false),
+    REGISTER("edx", rdx, 4, false), REGISTER("esi", rsi, 4, false), REGISTER("edi", rdi, 4, false),
+    REGISTER("ebp", rbp, 4, false), REGISTER("esp", rsp, 4, false),
+    REGISTER("r8d", r8, 4, false),   REGISTER("r9d", r9, 4, false),   REGISTER("r10d", r10, 4, false),
+    REGISTER("r11d", r11, 4, false), REGISTER("r12d", r12, 4, false), REGISTER("r13d", r13, 4, false),
+    REGISTER("r14d", r14, 4, false), REGISTER("r15d", r15, 4, false),
+    REGISTER("pc", rip, 8, false), REGISTER("sp", rsp, 8, false), REGISTER("fp", rbp, 8, false),
+};
+#undef REGISTER
+static constexpr size_t kProgramCounter = offsetof(struct user_regs_struct, rip);
+static constexpr size_t kStackPointer = offsetof(struct user_regs_struct, rsp);
+static constexpr size_t kFramePointer = offsetof(struct user_regs_struct, rbp);
+
+typedef struct user_fpregs_struct VectorState;
+static constexpr size_t kVectorOffset = offsetof(VectorState, xmm_space);
+static constexpr const char* kVectorPrefix = "xmm";
+static constexpr unsigned kVectorCount = 16;
+#elif defined(__aarch64__)
+#define REGISTER(index) {"x" #index, offsetof(struct user_regs_struct, regs) + index * 8, 8, true}, \
+                        {"w" #index, offsetof(struct user_regs_struct, regs) + index * 8, 4, false}
+static const RegisterLayout kRegisters[] = {
+    REGISTER(0),  REGISTER(1),  REGISTER(2),  REGISTER(3),  REGISTER(4),
+    REGISTER(5),  REGISTER(6),  REGISTER(7),  REGISTER(8),  REGISTER(9),
+    REGISTER(10), REGISTER(11), REGISTER(12), REGISTER(13), REGISTER(14),
+    REGISTER(15), REGISTER(16), REGISTER(17), REGISTER(18), REGISTER(19),
+    REGISTER(20), REGISTER(21), REGISTER(22), REGISTER(23), REGISTER(24),
+    REGISTER(25), REGISTER(26), REGISTER(27), REGISTER(28), REGISTER(29),
+    REGISTER(30),
+    {"sp", offsetof(struct user_regs_struct, sp), 8, true},
+    {"pc", offsetof(struct user_regs_struct, pc), 8, true},
+    {"pstate", offsetof(struct user_regs_struct, pstate), 8, true},
+    {"fp", offsetof(struct user_regs_struct, regs) + 29 * 8, 8, false},
+    {"lr", offsetof(struct user_regs_struct, regs) + 30 * 8, 8, false},
+};
+#undef REGISTER
+static constexpr size_t kProgramCounter = offsetof(struct user_regs_struct, pc);
+static constexpr size_t kStackPointer = offsetof(struct user_regs_struct, sp);
+static constexpr size_t kFramePointer = offsetof(struct user_regs_struct, regs) + 29 * 8;
+
+typedef struct user_fpsimd_struct VectorState;
+static constexpr size_t kVectorOffset = offsetof(VectorState, vregs);
+static constexpr const char* kVectorPrefix = "v";
+static constexpr unsigned kVectorCount = 32;
+#endif
+
+static constexpr size_t kVectorWidth = 16;
+
+bool equals_ignoring_case(const std::string& text, const char* name) {
+    size_t length = std::strlen(name);
+    if (text.size() != length) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(text[i])) != name[i]) return false;
+    }
+    return true;
+}
+
+std::string to_upper(const char* name) {
+    std::string upper(name);
+    for (char& c : upper) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return upper;
+}
+
+// "xmm3" -> 3 on x86_64, "v17" -> 17 on aarch64
+bool parse_vector_index(const std::string& name, unsigned& index) {
+    size_t prefix = std::strlen(kVectorPrefix);
+    if (name.size() <= prefix || name.size() > prefix + 2) return false;
+    for (size_t i = 0; i < prefix; ++i) {
+        if (std::tolower(static_cast<unsigned char>(name[i])) != kVectorPrefix[i]) return false;
+    }
+    for (size_t i = prefix; i < name.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) return false;
+    }
+    index = static_cast<unsigned>(std::strtoul(name.c_str() + prefix, nullptr, 10));
+    return index < kVectorCount;
+}
+
+} // namespace
+
+const RegisterLayout* find_register_layout(const std::string& name) {
+    for (const RegisterLayout& reg : kRegisters) {
+        if (equals_ignoring_case(name, reg.name)) return &reg;
+    }
+    return nullptr;
+}
+
+RegisterCache::RegisterCache()
+    : thread(-1), valid(false), dirty(false), vector_valid(false), general(new user_regs_struct()) {
+}
+
+RegisterCache::~RegisterCache() = default;
+
+bool RegisterCache::load(pid_t tid) {
+    if (valid && thread == tid) {
+        return true;
+    }
+    // Switching threads mid-stop: the old one keeps whatever was written
+    if (valid && dirty) {
+        flush();
+    }
+    if (valid) {
+        invalidate();
+    }
+    
+    struct iovec vector = {general.get(), sizeof(*general)};
+    if (timed_ptrace(PTRACE_GETREGSET, tid, NT_PRSTATUS, &vector) == -1) {
+        last_error = "Failed to read registers";
+        return false;
+    }
+    
+    thread = tid;
+    valid = true;
+    dirty = false;
+    vector_valid = false;
+    return true;
+}
+
+bool RegisterCache::flush() {
+    if (!valid || !dirty) {
+        return true;
+    }
+    
+    struct iovec vector = {general.get(), sizeof(*general)};
+    if (timed_ptrace(PTRACE_SETREGSET, thread, NT_PRSTATUS, &vector) == -1) {
+        last_error = "Failed to write registers";
+        return false;
+    }
+    dirty = false;
+    return true;
+}
+
+void RegisterCache::invalidate() {
+    if (valid) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(general.get());
+        previous[thread].assign(bytes, bytes + sizeof(*general));
+    }
+    valid = false;
+    dirty = false;
+    vector_valid = false;
+}
+
+void RegisterCache::clear() {
+    invalidate();
+    previous.clear();
+    thread = -1;
+}
+
+bool RegisterCache::is_valid() const {
+    return valid;
+}
+
+bool RegisterCache::is_dirty() const {
+    return dirty;
+}
+
+pid_t RegisterCache::get_thread() const {
+    return thread;
+}
+
+bool RegisterCache::read(const std::string& name, uint64_t& value) const {
+    const RegisterLayout* reg = find_register_layout(name);
+    if (!valid || !reg) {
+        return false;
+    }
+    value = read_field(reg->offset, reg->width);
+    return true;
+}
+
+bool RegisterCache::write(const std::string& name, uint64_t value) {
+    const RegisterLayout* reg = find_register_layout(name);
+    if (!reg) {
+        last_error = "Unknown register '" + name + "'";
+        return false;
+    }
+    if (!valid) {
+        last_error = "Registers are not loaded";
+        return false;
+    }
+    
+    // Narrow names replace only their low bytes
+    std::memcpy(reinterpret_cast<uint8_t*>(general.get()) + reg->offset, &value, reg->width);
+    dirty = true;
+    return true;
+}
+
+uint64_t RegisterCache::get_program_counter() const {
+    return valid ? read_field(kProgramCounter, 8) : 0;
+}
+
+uint64_t RegisterCache::get_stack_pointer() const {
+    return valid ? read_field(kStackPointer, 8) : 0;
+}
+
+uint64_t RegisterCache::get_frame_pointer() const {
+    return valid ? read_field(kFramePointer, 8) : 0;
+}
+
+std::vector<Register> RegisterCache::get_registers() const {
+    std::vector<Register> registers;
+    if (!valid) {
+        return registers;
+    }
+    
+    auto before = previous.find(thread);
+    for (const RegisterLayout& reg : kRegisters) {
+        if (!reg.listed) continue;
+        
+        Register entry;
+        entry.name = to_upper(reg.name);
+        entry.value = read_field(reg.offset, reg.width);
+        entry.size = reg.width;
+        entry.modified = false;
+        if (before != previous.end()) {
+            uint64_t old_value = 0;
+            std::memcpy(&old_value, before->second.data() + reg.offset, reg.width);
+            entry.modified = old_value != entry.value;
+        }
+        registers.push_back(entry);
+    }
+    return registers;
+}
+
+const user_regs_struct& RegisterCache::get_general() const {
+    return *general;
+}
+
+bool RegisterCache::read_vector(const std::string& name, std::vector<uint8_t>& bytes) {
+    unsigned index = 0;
+    if (!parse_vector_index(name, index)) {
+        last_error = "Unknown vector register '" + name + "'";
+        return false;
+    }
+    if (!valid) {
+        last_error = "Registers are not loaded";
+        return false;
+    }
+    
+    if (!vector_valid) {
+        vector_state.assign(sizeof(VectorState), 0);
+        struct iovec vector = {vector_state.data(), vector_state.size()};
+        if (timed_ptrace(PTRACE_GETREGSET, thread, NT_PRFPREG, &vector) == -1) {
+            last_error = "Failed to read vector registers";
+            return false;
+        }
+        vector_valid = true;
+    }
+    
+    const uint8_t* first = vector_state.data() + kVectorOffset + index * kVectorWidth;
+    bytes.assign(first, first + kVectorWidth);
+    return true;
+}
+
+const std::string& RegisterCache::get_last_error() const {
+    return last_error;
+}
+
+uint64_t RegisterCache::read_field(size_t offset, uint8_t width) const {
+    uint64_t value = 0;
+    std::memcpy(&value, reinterpret_cast<const uint8_t*>(general.get()) + offset, width);
+    return value;
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "sampling_profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+namespace debugger {
+
+SamplingProfiler::SamplingProfiler() : samples(0) {
+}
+
+size_t SamplingProfiler::StackHash::operator()(const std::vector<uint64_t>& stack) const {
+    // FNV-1a over the pcs; stacks differ mostly in their low bits
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint64_t pc : stack) {
+        hash ^= pc;
+        hash *= 0x100000001b3ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+void SamplingProfiler::clear() {
+    samples = 0;
+    address_samples.clear();
+    stacks.clear();
+    names.clear();
+}
+
+void SamplingProfiler::add_sample(const UnwindFrame* frames, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    ++samples;
+    ++address_samples[frames[0].pc];
+    
+    scratch.clear();
+    scratch.push_back(frames[0].pc);
+    for (size_t i = 1; i < count; ++i) {
+        scratch.push_back(frames[i].pc - 1);
+    }
+    auto it = stacks.find(scratch);
+    if (it != stacks.end()) {
+        ++it->second;
+        return;
+    }
+    if (stacks.size() >= MAX_STACKS) {
+        scratch.resize(1);
+    }
+    ++stacks[scratch];
+}
+
+uint64_t SamplingProfiler::get_sample_count() const {
+    return samples;
+}
+
+void SamplingProfiler::resolve_names(const Symbolizer& symbolize) {
+    for (const auto& entry : stacks) {
+        for (uint64_t pc : entry.first) {
+            if (names.count(pc)) continue;
+            names.emplace(pc, symbolize(pc));
+        }
+    }
+}
+
+const std::string& SamplingProfiler::get_name(uint64_t pc) const {
+    static const std::string unknown = "[unknown]";
+    auto it = names.find(pc);
+    return it == names.end() || it->second.empty() ? unknown : it->second;
+}
+
+ProfileSummary SamplingProfiler::summarize() const {
+    ProfileSummary summary{};
+    summary.samples = samples;
+    summary.address_samples = address_samples;
+    
+    std::unordered_map<std::string, FunctionProfile> functions;
+    std::unordered_map<std::string, uint64_t> hottest_count;
+    
+    for (const auto& entry : address_samples) {
+        const std::string& name = get_name(entry.first);
+        FunctionProfile& function = functions[name];
+        function.self_samples += entry.second;
+        uint64_t& hottest = hottest_count[name];
+        if (entry.second > hottest) {
+            hottest = entry.second;
+            function.hottest_address = entry.first;
+        }
+    }
+    
+    // A recursive function counts once per sample towards its total
+    std::unordered_set<FunctionProfile*> seen;
+    for (const auto& entry : stacks) {
+        seen.clear();
+        for (uint64_t pc : entry.first) {
+            FunctionProfile* function = &functions[get_name(pc)];
+            if (seen.insert(function).second) {
+                function->total_samples += entry.second;
+            }
+        }
+    }
+    
+    summary.functions.reserve(functions.size());
+    for (auto& entry : functions) {
+        entry.second.name = entry.first;
+        summary.functions.push_back(std::move(entry.second));
+    }
+    std::sort(summary.functions.begin(), summary.functions.end(),
+              [](const FunctionProfile& a, const FunctionProfile& b) {
+                  if (a.self_samples != b.self_samples) return a.self_samples > b.self_samples;
+                  return a.total_samples > b.total_samples;
+              });
+    return summary;
+}
+
+bool SamplingProfiler::export_folded(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    
+    // Identical symbolized stacks (different pcs in the same functions) fold together
+    std::unordered_map<std::string, uint64_t> folded;
+    std::string line;
+    for (const auto& entry : stacks) {
+        line.clear();
+        for (size_t i = entry.first.size(); i-- > 0;) {
+            line += get_name(entry.first[i]);
+            if (i != 0) line += ';';
+        }
+        folded[line] += entry.second;
+    }
+    
+    for (const auto& entry : folded) {
+        out << entry.first << ' ' << entry.second << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,836 @@
+#include "stack_unwinder.h"
+#include "elf_parser.h"
+#include "process_maps.h"
+#include "register_cache.h"
+#include <sys/user.h>
+#include <algorithm>
+#include <cstring>
+
+namespace debugger {
+
+namespace {
+
+#if defined(__aarch64__)
+constexpr unsigned kFramePointerColumn = 29;
+constexpr unsigned kStackPointerColumn = 31;
+constexpr unsigned kReturnAddressColumn = 30;
+static const char* const kColumnNames[UnwindRegisters::COUNT] = {
+    "x0",  "x1",  "x2",  "x3",  "x4",  "x5",  "x6",  "x7",  "x8",  "x9",  "x10",
+    "x11", "x12", "x13", "x14", "x15", "x16", "x17", "x18", "x19", "x20", "x21",
+    "x22", "x23", "x24", "x25", "x26", "x27", "x28", "x29", "x30", "sp",  "pc",
+};
+#else
+constexpr unsigned kFramePointerColumn = 6;
+constexpr unsigned kStackPointerColumn = 7;
+constexpr unsigned kReturnAddressColumn = 16;
+static const char* const kColumnNames[UnwindRegisters::COUNT] = {
+    "rax", "rdx", "rcx", "rbx", "rsi", "rdi", "rbp", "rsp", "r8",
+    "r9",  "r10", "r11", "r12", "r13", "r14", "r15", "rip",
+};
+#endif
+
+// Decoded rows kept per module before the cache starts over
+constexpr size_t kMaxCachedRows = 4096;
+// DW_CFA_remember_state nesting we are willing to track
+constexpr size_t kMaxRememberDepth = 8;
+// Bound on DWARF expression work, so a malformed loop can't hang a unwind
+constexpr size_t kMaxExpressionSteps = 256;
+constexpr size_t kMaxExpressionStack = 64;
+
+constexpr uint8_t kEncodingOmit = 0xff;
+
+enum class RuleKind : uint8_t {
+    SAME_VALUE,
+    UNDEFINED,
+    OFFSET,          // saved at CFA + offset
+    VAL_OFFSET,      // value is CFA + offset
+    REGISTER,        // saved in another register
+    EXPRESSION,      // saved at the address the expression computes
+    VAL_EXPRESSION   // value is what the expression computes
+};
+
+struct RegisterRule {
+    RuleKind kind;
+    uint8_t reg;
+    int64_t offset;
+    const uint8_t* expression;  // Points into the module's mapping
+    uint32_t expression_length;
+};
+
+struct Cie {
+    uint64_t code_alignment;
+    int64_t data_alignment;
+    uint64_t return_address_column;
+    uint8_t fde_encoding;
+    bool has_augmentation_data;
+    bool signal_frame;
+    const uint8_t* instructions;
+    const uint8_t* instructions_end;
+};
+
+struct FdeEntry {
+    uint64_t pc_begin;  // link-time
+    uint32_t offset;    // into .eh_frame
+};
+
+// Little-endian cursor over a CFI section. Pointer encodings that are
+// relative to the section need its link-time address.
+struct Cursor {
+    const uint8_t* p;
+    const uint8_t* end;
+    const uint8_t* section;
+    uint64_t section_address;
+    
+    bool read(void* out, size_t size) {
+        if (static_cast<size_t>(end - p) < size) return false;
+        std::memcpy(out, p, size);
+        p += size;
+        return true;
+    }
+    
+    template <typename T>
+    bool value(T& out) {
+        return read(&out, sizeof(out));
+    }
+    
+    bool uleb(uint64_t& out) {
+        out = 0;
+        for (unsigned shift = 0; p < end; shift += 7) {
+            uint8_t byte = *p++;
+            if (shift < 64) out |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+    
+    bool sleb(int64_t& out) {
+        uint64_t result = 0;
+        unsigned shift = 0;
+        uint8_t byte = 0;
+        do {
+            if (p >= end) return false;
+            byte = *p++;
+            if (shift < 64) result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        if (shift < 64 && (byte & 0x40)) result |= ~0ULL << shift;
+        out = static_cast<int64_t>(result);
+        return true;
+    }
+    
+    // DW_EH_PE_* pointer. Indirect pointers are returned undereferenced,
+    // which is only good enough for skipping them (the personality routine).
+    bool encoded(uint8_t encoding, uint64_t& out) {
+        if (encoding == kEncodingOmit) return false;
+        uint64_t position = section_address + static_cast<uint64_t>(p - section);
+        uint64_t result = 0;
+        switch (encoding & 0x0f) {
+            case 0x00: case 0x04: { uint64_t v; if (!value(v)) return false; result = v; break; }
+            case 0x01: if (!uleb(result)) return false; break;
+            case 0x02: { uint16_t v; if (!value(v)) return false; result = v; break; }
+            case 0x03: { uint32_t v; if (!value(v)) return false; result = v; break; }
+            case 0x09: { int64_t v; if (!sleb(v)) return false; result = static_cast<uint64_t>(v); break; }
+            case 0x0a: { int16_t v; if (!value(v)) return false; result = static_cast<uint64_t>(static_cast<int64_t>(v)); break; }
+            case 0x0b: { int32_t v; if (!value(v)) return false; result = static_cast<uint64_t>(static_cast<int64_t>(v)); break; }
+            case 0x0c: { int64_t v; if (!value(v)) return false; result = static_cast<uint64_t>(v); break; }
+            default: return false;
+        }
+        switch (encoding & 0x70) {
+            case 0x00: break;
+            case 0x10: result += position; break;         // pcrel
+            case 0x30: result += section_address; break;  // datarel, only used by .eh_frame_hdr
+            default: return false;
+        }
+        out = result;
+        return true;
+    }
+};
+
+// Small direct-mapped cache of stack chunks for one unwind, so walking a
+// deep stack costs a few bulk reads rather than one per saved word
+class StackWindow {
+public:
+    explicit StackWindow(const StackReader& read) : read(read) {
+        for (Chunk& chunk : chunks) chunk.valid_bytes = kInvalid;
+    }
+    
+    bool read_word(uint64_t address, uint64_t& value) {
+        uint64_t base = address & ~(kChunkSize - 1);
+        size_t offset = static_cast<size_t>(address - base);
+        if (offset + sizeof(value) > kChunkSize) {
+            return read(address, reinterpret_cast<uint8_t*>(&value), sizeof(value)) == sizeof(value);
+        }
+        
+        Chunk& chunk = chunks[(base / kChunkSize) % kChunkCount];
+        if (chunk.valid_bytes == kInvalid || chunk.base != base) {
+            chunk.base = base;
+            chunk.valid_bytes = read(base, chunk.bytes, kChunkSize);
+        }
+        if (offset + sizeof(value) > chunk.valid_bytes) return false;
+        std::memcpy(&value, chunk.bytes + offset, sizeof(value));
+        return true;
+    }
+
+private:
+    static constexpr uint64_t kChunkSize = 1024;
+    static constexpr size_t kChunkCount = 8;
+    static constexpr size_t kInvalid = ~static_cast<size_t>(0);
+    
+    struct Chunk {
+        uint64_t base;
+        size_t valid_bytes;
+        uint8_t bytes[kChunkSize];
+    };
+    
+    const StackReader& read;
+    Chunk chunks[kChunkCount];
+};
+
+bool is_valid(const UnwindRegisters& regs, unsigned column) {
+    return column < UnwindRegisters::COUNT && (regs.valid & (1ULL << column));
+}
+
+void set_register(UnwindRegisters& regs, unsigned column, uint64_t value) {
+    regs.values[column] = value;
+    regs.valid |= 1ULL << column;
+}
+
+// DWARF expression as used by CFI: signal frames and PLT entries
+bool evaluate_expression(const uint8_t* code, size_t length, const UnwindRegisters& regs, StackWindow& stack,
+                         const uint64_t* initial, uint64_t& result) {
+    uint64_t values[kMaxExpressionStack];
+    size_t top = 0;
+    if (initial) values[top++] = *initial;
+    
+    Cursor cursor{code, code + length, code, 0};
+    for (size_t steps = 0; cursor.p < cursor.end; ++steps) {
+        if (steps >= kMaxExpressionSteps || top + 1 >= kMaxExpressionStack) return false;
+        uint8_t op = *cursor.p++;
+        
+        if (op >= 0x30 && op <= 0x4f) {  // DW_OP_lit0..31
+            values[top++] = op - 0x30;
+            continue;
+        }
+        if (op >= 0x50 && op <= 0x6f) {  // DW_OP_reg0..31 names a register, not a value
+            return false;
+        }
+        if ((op >= 0x70 && op <= 0x8f) || op == 0x92) {  // DW_OP_breg0..31, DW_OP_bregx
+            uint64_t column = op - 0x70;
+            if (op == 0x92 && !cursor.uleb(column)) return false;
+            int64_t offset = 0;
+            if (!cursor.sleb(offset) || !is_valid(regs, static_cast<unsigned>(column))) return false;
+            values[top++] = regs.values[column] + static_cast<uint64_t>(offset);
+            continue;
+        }
+        
+        uint64_t a = top > 0 ? values[top - 1] : 0;
+        uint64_t b = top > 1 ? values[top - 2] : 0;
+        switch (op) {
+            case 0x08: { uint8_t v; if (!cursor.value(v)) return false; values[top++] = v; break; }
+            case 0x09: { int8_t v; if (!cursor.value(v)) return false; values[top++] = static_cast<uint64_t>(static_cast<int64_t>(v)); break; }
+            case 0x0a: { uint16_t v; if (!cursor.value(v)) return false; values[top++] = v; break; }
+            case 0x0b: { int16_t v; if (!cursor.value(v)) return false; values[top++] = static_cast<uint64_t>(static_cast<int64_t>(v)); break; }
+            case 0x0c: { uint32_t v; if (!cursor.value(v)) return false; values[top++] = v; break; }
+            case 0x0d: { int32_t v; if (!cursor.value(v)) return false; values[top++] = static_cast<uint64_t>(static_cast<int64_t>(v)); break; }
+            case 0x0e: case 0x0f: { uint64_t v; if (!cursor.value(v)) return false; values[top++] = v; break; }
+            case 0x10: { uint64_t v; if (!cursor.uleb(v)) return false; values[top++] = v; break; }
+            case 0x11: { int64_t v; if (!cursor.sleb(v)) return false; values[top++] = static_cast<uint64_t>(v); break; }
+            case 0x06: {  // DW_OP_deref
+                if (top < 1 || !stack.read_word(a, values[top - 1])) return false;
+                break;
+            }
+            case 0x12: if (top < 1) return false; values[top++] = a; break;              // dup
+            case 0x13: if (top < 1) return false; --top; break;                          // drop
+            case 0x14: if (top < 2) return false; values[top++] = b; break;              // over
+            case 0x16: if (top < 2) return false; values[top - 1] = b; values[top - 2] = a; break;  // swap
+            case 0x1f: if (top < 1) return false; values[top - 1] = 0 - a; break;        // neg
+            case 0x20: if (top < 1) return false; values[top - 1] = ~a; break;           // not
+            case 0x23: {  // plus_uconst
+                uint64_t v;
+                if (top < 1 || !cursor.uleb(v)) return false;
+                values[top - 1] = a + v;
+                break;
+            }
+            case 0x1a: case 0x1c: case 0x1e: case 0x21: case 0x22: case 0x24: case 0x25:
+            case 0x26: case 0x27: case 0x29: case 0x2a: case 0x2b: case 0x2c: case 0x2d: case 0x2e: {
+                if (top < 2) return false;
+                int64_t sa = static_cast<int64_t>(a), sb = static_cast<int64_t>(b);
+                uint64_t r = 0;
+                switch (op) {
+                    case 0x1a: r = b & a; break;
+                    case 0x1c: r = b - a; break;
+                    case 0x1e: r = b * a; break;
+                    case 0x21: r = b | a; break;
+                    case 0x22: r = b + a; break;
+                    case 0x24: r = a < 64 ? b << a : 0; break;
+                    case 0x25: r = a < 64 ? b >> a : 0; break;
+                    case 0x26: r = static_cast<uint64_t>(a < 64 ? sb >> a : (sb < 0 ? -1 : 0)); break;
+                    case 0x27: r = b ^ a; break;
+                    case 0x29: r = sb == sa; break;
+                    case 0x2a: r = sb >= sa; break;
+                    case 0x2b: r = sb > sa; break;
+                    case 0x2c: r = sb <= sa; break;
+                    case 0x2d: r = sb < sa; break;
+                    case 0x2e: r = sb != sa; break;
+                }
+                --top;
+                values[top - 1] = r;
+                break;
+            }
+            case 0x2f: case 0x28: {  // skip, bra
+                int16_t offset;
+                if (!cursor.value(offset)) return false;
+                bool taken = true;
+                if (op == 0x28) {
+                    if (top < 1) return false;
+                    taken = values[--top] != 0;
+                }
+                if (taken) {
+                    const uint8_t* target = cursor.p + offset;
+                    if (target < code || target > cursor.end) return false;
+                    cursor.p = target;
+                }
+                break;
+            }
+            case 0x96:  // nop
+                break;
+            default:
+                return false;
+        }
+    }
+    
+    if (top == 0) return false;
+    result = values[top - 1];
+    return true;
+}
+
+} // namespace
+
+struct UnwindRow {
+    bool cfa_is_expression;
+    uint8_t cfa_register;
+    int64_t cfa_offset;
+    const uint8_t* cfa_expression;
+    uint32_t cfa_expression_length;
+    bool signal_frame;
+    uint8_t return_address_column;
+    RegisterRule rules[UnwindRegisters::COUNT];
+};
+
+// One executable file: its mapping, FDE index, and the rows decoded so far
+struct ModuleUnwindInfo {
+    std::shared_ptr<const ElfParser> elf;
+    const uint8_t* eh_frame = nullptr;
+    size_t eh_frame_size = 0;
+    uint64_t eh_frame_address = 0;
+    std::vector<FdeEntry> index;
+    std::unordered_map<uint32_t, Cie> cies;
+    // Link-time pc -> row; a row with return_address_column past COUNT
+    // records that the pc has no usable CFI
+    std::unordered_map<uint64_t, UnwindRow> rows;
+    
+    void load(std::shared_ptr<const ElfParser> image);
+    bool find_row(uint64_t pc, UnwindRow& row, UnwinderStats& stats);
+
+private:
+    void build_index_from_header(ByteView header, uint64_t header_address);
+    void build_index_from_scan();
+    const Cie* get_cie(uint32_t offset);
+    bool decode_row(uint64_t pc, UnwindRow& row);
+    bool execute(const uint8_t* code, const uint8_t* end, const Cie& cie, uint64_t location, uint64_t target,
+                 UnwindRow& row, const UnwindRow* initial);
+    
+    Cursor cursor_at(uint32_t offset) const {
+        return Cursor{eh_frame + offset, eh_frame + eh_frame_size, eh_frame, eh_frame_address};
+    }
+    // Reads an entry's length and CIE id/pointer; body ends at `end`
+    bool read_entry(uint32_t offset, Cursor& cursor, uint32_t& id, uint32_t& id_offset) const {
+        cursor = cursor_at(offset);
+        uint32_t length;
+        if (!cursor.value(length) || length == 0 || length == 0xffffffff) return false;  // no 64-bit DWARF in .eh_frame
+        if (length > static_cast<size_t>(cursor.end - cursor.p)) return false;
+        cursor.end = cursor.p + length;
+        id_offset = static_cast<uint32_t>(cursor.p - eh_frame);
+        return cursor.value(id);
+    }
+};
+
+void ModuleUnwindInfo::load(std::shared_ptr<const ElfParser> image) {
+    elf = std::move(image);
+    
+    Section section = elf->get_section(".eh_frame");
+    if (section.data.empty()) return;  // unwinds through here use frame pointers
+    eh_frame = section.data.data();
+    eh_frame_size = section.data.size();
+    eh_frame_address = section.address;
+    
+    Section header = elf->get_section(".eh_frame_hdr");
+    if (!header.data.empty()) {
+        build_index_from_header(header.data, header.address);
+    }
+    if (index.empty()) {
+        build_index_from_scan();
+    }
+    if (!std::is_sorted(index.begin(), index.end(),
+                        [](const FdeEntry& a, const FdeEntry& b) { return a.pc_begin < b.pc_begin; })) {
+        std::sort(index.begin(), index.end(),
+                  [](const FdeEntry& a, const FdeEntry& b) { return a.pc_begin < b.pc_begin; });
+    }
+}
+
+void ModuleUnwindInfo::build_index_from_header(ByteView header, uint64_t header_address) {
+    // The linker's sorted (initial location, FDE address) table
+    Cursor cursor{header.data(), header.data() + header.size(), header.data(), header_address};
+    uint8_t version, frame_encoding, count_encoding, table_encoding;
+    if (!cursor.value(version) || version != 1 || !cursor.value(frame_encoding) ||
+        !cursor.value(count_encoding) || !cursor.value(table_encoding)) {
+        return;
+    }
+    uint64_t frame_pointer, count;
+    if (!cursor.encoded(frame_encoding, frame_pointer) || !cursor.encoded(count_encoding, count)) {
+        return;
+    }
+    
+    index.reserve(static_cast<size_t>(std::min<uint64_t>(count, header.size() / 8)));
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t location, fde_address;
+        if (!cursor.encoded(table_encoding, location) || !cursor.encoded(table_encoding, fde_address)) {
+            break;
+        }
+        if (fde_address < eh_frame_address || fde_address - eh_frame_address >= eh_frame_size) continue;
+        index.push_back(FdeEntry{location, static_cast<uint32_t>(fde_address - eh_frame_address)});
+    }
+}
+
+void ModuleUnwindInfo::build_index_from_scan() {
+    uint32_t offset = 0;
+    while (offset + 8 <= eh_frame_size) {
+        Cursor entry;
+        uint32_t id, id_offset;
+        if (!read_entry(offset, entry, id, id_offset)) break;
+        uint32_t next = static_cast<uint32_t>(entry.end - eh_frame);
+        
+        if (id != 0 && id <= id_offset) {
+            const Cie* cie = get_cie(id_offset - id);
+            uint64_t pc_begin;
+            if (cie && entry.encoded(cie->fde_encoding, pc_begin)) {
+                index.push_back(FdeEntry{pc_begin, offset});
+            }
+        }
+        offset = next;
+    }
+}
+
+const Cie* ModuleUnwindInfo::get_cie(uint32_t offset) {
+    auto cached = cies.find(offset);
+    if (cached != cies.end()) return &cached->second;
+    
+    Cursor cursor;
+    uint32_t id, id_offset;
+    if (!read_entry(offset, cursor, id, id_offset) || id != 0) return nullptr;
+    
+    uint8_t version;
+    if (!cursor.value(version)) return nullptr;
+    const char* augmentation = reinterpret_cast<const char*>(cursor.p);
+    size_t augmentation_length = strnlen(augmentation, static_cast<size_t>(cursor.end - cursor.p));
+    if (augmentation_length == static_cast<size_t>(cursor.end - cursor.p)) return nullptr;
+    cursor.p += augmentation_length + 1;
+    if (std::strstr(augmentation, "eh")) return nullptr;  // pre-3.0 GCC layout
+    
+    Cie cie{};
+    if (!cursor.uleb(cie.code_alignment) || !cursor.sleb(cie.data_alignment)) return nullptr;
+    if (version == 1) {
+        uint8_t column;
+        if (!cursor.value(column)) return nullptr;
+        cie.return_address_column = column;
+    } else if (!cursor.uleb(cie.return_address_column)) {
+        return nullptr;
+    }
+    
+    if (augmentation[0] == 'z') {
+        uint64_t length;
+        if (!cursor.uleb(length) || length > static_cast<uint64_t>(cursor.end - cursor.p)) return nullptr;
+        const uint8_t* data_end = cursor.p + length;
+        cie.has_augmentation_data = true;
+        for (const char* c = augmentation + 1; *c; ++c) {
+            uint8_t encoding;
+            uint64_t ignored;
+            if (*c == 'R') {
+                if (!cursor.value(cie.fde_encoding)) return nullptr;
+            } else if (*c == 'P') {
+                if (!cursor.value(encoding) || !cursor.encoded(encoding & 0x7f, ignored)) return nullptr;
+            } else if (*c == 'L') {
+                if (!cursor.value(encoding)) return nullptr;
+            } else if (*c == 'S') {
+                cie.signal_frame = true;
+            } else if (*c != 'B' && *c != 'G') {
+                break;  // Unknown; the length lets us skip the rest
+            }
+        }
+        cursor.p = data_end;
+    }
+    
+    cie.instructions = cursor.p;
+    cie.instructions_end = cursor.end;
+    return &cies.emplace(offset, cie).first->second;
+}
+
+bool ModuleUnwindInfo::find_row(uint64_t pc, UnwindRow& row, UnwinderStats& stats) {
+    auto cached = rows.find(pc);
+    if (cached != rows.end()) {
+        ++stats.row_cache_hits;
+        row = cached->second;
+        return row.return_address_column < UnwindRegisters::COUNT;
+    }
+    
+    ++stats.row_cache_misses;
+    bool found = decode_row(pc, row);
+    if (!found) {
+        row.return_address_column = UnwindRegisters::COUNT;
+    }
+    if (rows.size() >= kMaxCachedRows) {
+        rows.clear();
+    }
+    rows.emplace(pc, row);
+    return found;
+}
+
+bool ModuleUnwindInfo::decode_row(uint64_t pc, UnwindRow& row) {
+    auto it = std::upper_bound(index.begin(), index.end(), pc,
+                               [](uint64_t value, const FdeEntry& entry) { return value < entry.pc_begin; });
+    if (it == index.begin()) return false;
+    --it;
+    
+    Cursor cursor;
+    uint32_t id, id_offset;
+    if (!read_entry(it->offset, cursor, id, id_offset) || id == 0 || id > id_offset) return false;
+    const Cie* cie = get_cie(id_offset - id);
+    if (!cie || cie->return_address_column >= UnwindRegisters::COUNT) return false;
+    
+    uint64_t pc_begin, pc_range;
+    if (!cursor.encoded(cie->fde_encoding, pc_begin) || !cursor.encoded(cie->fde_encoding & 0x0f, pc_range)) {
+        return false;
+    }
+    if (pc < pc_begin || pc - pc_begin >= pc_range) return false;
+    if (cie->has_augmentation_data) {
+        uint64_t length;
+        if (!cursor.uleb(length) || length > static_cast<uint64_t>(cursor.end - cursor.p)) return false;
+        cursor.p += length;
+    }
+    
+    row = UnwindRow{};
+    row.cfa_register = kStackPointerColumn;
+    row.signal_frame = cie->signal_frame;
+    row.return_address_column = static_cast<uint8_t>(cie->return_address_column);
+    if (!execute(cie->instructions, cie->instructions_end, *cie, pc_begin, ~0ULL, row, nullptr)) return false;
+    UnwindRow initial = row;
+    return execute(cursor.p, cursor.end, *cie, pc_begin, pc, row, &initial);
+}
+
+bool ModuleUnwindInfo::execute(const uint8_t* code, const uint8_t* end, const Cie& cie, uint64_t location,
+                               uint64_t target, UnwindRow& row, const UnwindRow* initial) {
+    UnwindRow remembered[kMaxRememberDepth];
+    size_t depth = 0;
+    Cursor cursor{code, end, eh_frame, eh_frame_address};
+    
+    auto set_rule = [&row](uint64_t column, RuleKind kind, int64_t offset) {
+        if (column < UnwindRegisters::COUNT) {
+            row.rules[column] = RegisterRule{kind, 0, offset, nullptr, 0};
+        }
+    };
+    auto restore_rule = [&row, initial](uint64_t column) {
+        if (column < UnwindRegisters::COUNT) {
+            row.rules[column] = initial ? initial->rules[column] : RegisterRule{};
+        }
+    };
+    // Rows apply from their location up to the next advance past target
+    auto advance = [&](uint64_t delta) {
+        location += delta * cie.code_alignment;
+        return location <= target;
+    };
+    
+    while (cursor.p < cursor.end) {
+        uint8_t op = *cursor.p++;
+        uint64_t column = 0, value = 0;
+        int64_t offset = 0;
+        
+        switch (op & 0xc0) {
+            case 0x40:  // DW_CFA_advance_loc
+                if (!advance(op & 0x3f)) return true;
+                continue;
+            case 0x80:  // DW_CFA_offset
+                if (!cursor.uleb(value)) return false;
+                set_rule(op & 0x3f, RuleKind::OFFSET, static_cast<int64_t>(value) * cie.data_alignment);
+                continue;
+            case 0xc0:  // DW_CFA_restore
+                restore_rule(op & 0x3f);
+                continue;
+        }
+        
+        switch (op) {
+            case 0x00:  // nop
+                break;
+            case 0x01:  // set_loc
+                if (!cursor.encoded(cie.fde_encoding, value)) return false;
+                location = value;
+                if (location > target) return true;
+                break;
+            case 0x02: { uint8_t delta; if (!cursor.value(delta)) return false; if (!advance(delta)) return true; break; }
+            case 0x03: { uint16_t delta; if (!cursor.value(delta)) return false; if (!advance(delta)) return true; break; }
+            case 0x04: { uint32_t delta; if (!cursor.value(delta)) return false; if (!advance(delta)) return true; break; }
+            case 0x05:  // offset_extended
+                if (!cursor.uleb(column) || !cursor.uleb(value)) return false;
+                set_rule(column, RuleKind::OFFSET, static_cast<int64_t>(value) * cie.data_alignment);
+                break;
+            case 0x06:  // restore_extended
+                if (!cursor.uleb(column)) return false;
+                restore_rule(column);
+                break;
+            case 0x07:  // undefined
+                if (!cursor.uleb(column)) return false;
+                set_rule(column, RuleKind::UNDEFINED, 0);
+                break;
+            case 0x08:  // same_value
+                if (!cursor.uleb(column)) return false;
+                set_rule(column, RuleKind::SAME_VALUE, 0);
+                break;
+            case 0x09:  // register
+                if (!cursor.uleb(column) || !cursor.uleb(value)) return false;
+                if (value >= UnwindRegisters::COUNT) return false;
+                set_rule(column, RuleKind::REGISTER, 0);
+                if (column < UnwindRegisters::COUNT) row.rules[column].reg = static_cast<uint8_t>(value);
+                break;
+            case 0x0a:  // remember_state
+                if (depth == kMaxRememberDepth) return false;
+                remembered[depth++] = row;
+                break;
+            case 0x0b:  // restore_state
+                if (depth == 0) return false;
+                row = remembered[--depth];
+                break;
+            case 0x0c:  // def_cfa
+                if (!cursor.uleb(column) || !cursor.uleb(value)) return false;
+                row.cfa_is_expression = false;
+                row.cfa_register = static_cast<uint8_t>(column);
+                row.cfa_offset = static_cast<int64_t>(value);
+                break;
+            case 0x0d:  // def_cfa_register
+                if (!cursor.uleb(column)) return false;
+                row.cfa_is_expression = false;
+                row.cfa_register = static_cast<uint8_t>(column);
+                break;
+            case 0x0e:  // def_cfa_offset
+                if (!cursor.uleb(value)) return false;
+                row.cfa_offset = static_cast<int64_t>(value);
+                break;
+            case 0x0f:  // def_cfa_expression
+                if (!cursor.uleb(value) || value > static_cast<uint64_t>(cursor.end - cursor.p)) return false;
+                row.cfa_is_expression = true;
+                row.cfa_expression = cursor.p;
+                row.cfa_expression_length = static_cast<uint32_t>(value);
+                cursor.p += value;
+                break;
+            case 0x10:    // expression
+            case 0x16: {  // val_expression
+                if (!cursor.uleb(column) || !cursor.uleb(value)) return false;
+                if (value > static_cast<uint64_t>(cursor.end - cursor.p)) return false;
+                if (column < UnwindRegisters::COUNT) {
+                    RuleKind kind = op == 0x10 ? RuleKind::EXPRESSION : RuleKind::VAL_EXPRESSION;
+                    row.rules[column] = RegisterRule{kind, 0, 0, cursor.p, static_cast<uint32_t>(value)};
+                }
+                cursor.p += value;
+                break;
+            }
+            case 0x11:  // offset_extended_sf
+                if (!cursor.uleb(column) || !cursor.sleb(offset)) return false;
+                set_rule(column, RuleKind::OFFSET, offset * cie.data_alignment);
+                break;
+            case 0x12:  // def_cfa_sf
+                if (!cursor.uleb(column) || !cursor.sleb(offset)) return false;
+                row.cfa_is_expression = false;
+                row.cfa_register = static_cast<uint8_t>(column);
+                row.cfa_offset = offset * cie.data_alignment;
+                break;
+            case 0x13:  // def_cfa_offset_sf
+                if (!cursor.sleb(offset)) return false;
+                row.cfa_offset = offset * cie.data_alignment;
+                break;
+            case 0x14:  // val_offset
+                if (!cursor.uleb(column) || !cursor.uleb(value)) return false;
+                set_rule(column, RuleKind::VAL_OFFSET, static_cast<int64_t>(value) * cie.data_alignment);
+                break;
+            case 0x15:  // val_offset_sf
+                if (!cursor.uleb(column) || !cursor.sleb(offset)) return false;
+                set_rule(column, RuleKind::VAL_OFFSET, offset * cie.data_alignment);
+                break;
+            case 0x2d:  // AArch64 negate_ra_state; return addresses are stripped instead
+                break;
+            case 0x2e:  // GNU_args_size
+                if (!cursor.uleb(value)) return false;
+                break;
+            case 0x2f:  // GNU_negative_offset_extended
+                if (!cursor.uleb(column) || !cursor.uleb(value)) return false;
+                set_rule(column, RuleKind::OFFSET, -static_cast<int64_t>(value) * cie.data_alignment);
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+StackUnwinder::StackUnwinder(ProcessMaps& maps) : maps(maps), maps_generation(0), stats{} {
+}
+
+StackUnwinder::~StackUnwinder() = default;
+
+ModuleUnwindInfo* StackUnwinder::get_unwind_info(const LoadedModule& module) {
+    if (!module.elf) return nullptr;
+    
+    if (maps_generation != maps.get_generation()) {
+        // Drop what belongs to images the maps have let go of
+        maps_generation = maps.get_generation();
+        for (auto it = unwind_info.begin(); it != unwind_info.end();) {
+            it = it->second->elf.use_count() == 1 ? unwind_info.erase(it) : std::next(it);
+        }
+        stats.modules = maps.get_modules().size();
+    }
+    
+    std::shared_ptr<ModuleUnwindInfo>& info = unwind_info[module.elf.get()];
+    if (!info) {
+        info = std::make_shared<ModuleUnwindInfo>();
+        info->load(module.elf);
+    }
+    return info.get();
+}
+
+UnwindRegisters StackUnwinder::registers_from(const user_regs_struct& regs) {
+    UnwindRegisters result{};
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&regs);
+    for (unsigned column = 0; column < UnwindRegisters::COUNT; ++column) {
+        const RegisterLayout* layout = find_register_layout(kColumnNames[column]);
+        if (!layout) continue;
+        std::memcpy(&result.values[column], bytes + layout->offset, sizeof(uint64_t));
+        result.valid |= 1ULL << column;
+    }
+    const RegisterLayout* pc = find_register_layout("pc");
+    std::memcpy(&result.pc, bytes + pc->offset, sizeof(result.pc));
+    return result;
+}
+
+size_t StackUnwinder::unwind(const UnwindRegisters& start, const StackReader& read, UnwindFrame* frames,
+                             size_t max_frames) {
+    ++stats.unwinds;
+    
+    StackWindow stack(read);
+    UnwindRegisters regs = start;
+    bool from_cfi = true;
+    bool caller = false;  // return addresses point after the call, so look up pc - 1
+    size_t count = 0;
+    
+    while (count < max_frames && regs.pc != 0) {
+        frames[count++] = UnwindFrame{regs.pc, regs.values[kStackPointerColumn], regs.values[kFramePointerColumn],
+                                      from_cfi};
+        
+        const LoadedModule* module = maps.find_module(regs.pc);
+        ModuleUnwindInfo* info = module ? get_unwind_info(*module) : nullptr;
+        
+        UnwindRow row;
+        uint64_t lookup = caller ? regs.pc - 1 : regs.pc;
+        UnwindRegisters next = regs;
+        uint64_t sp = regs.values[kStackPointerColumn];
+        
+        if (info && info->find_row(lookup - module->bias, row, stats)) {
+            uint64_t cfa = 0;
+            if (row.cfa_is_expression) {
+                if (!evaluate_expression(row.cfa_expression, row.cfa_expression_length, regs, stack, nullptr, cfa)) break;
+            } else {
+                if (!is_valid(regs, row.cfa_register)) break;
+                cfa = regs.values[row.cfa_register] + static_cast<uint64_t>(row.cfa_offset);
+            }
+            
+            for (unsigned column = 0; column < UnwindRegisters::COUNT; ++column) {
+                const RegisterRule& rule = row.rules[column];
+                uint64_t value = 0;
+                bool known = true;
+                switch (rule.kind) {
+                    case RuleKind::SAME_VALUE:
+                        continue;
+                    case RuleKind::UNDEFINED:
+                        known = false;
+                        break;
+                    case RuleKind::OFFSET:
+                        known = stack.read_word(cfa + static_cast<uint64_t>(rule.offset), value);
+                        break;
+                    case RuleKind::VAL_OFFSET:
+                        value = cfa + static_cast<uint64_t>(rule.offset);
+                        break;
+                    case RuleKind::REGISTER:
+                        known = is_valid(regs, rule.reg);
+                        value = regs.values[rule.reg];
+                        break;
+                    case RuleKind::EXPRESSION:
+                        known = evaluate_expression(rule.expression, rule.expression_length, regs, stack, &cfa, value) &&
+                                stack.read_word(value, value);
+                        break;
+                    case RuleKind::VAL_EXPRESSION:
+                        known = evaluate_expression(rule.expression, rule.expression_length, regs, stack, &cfa, value);
+                        break;
+                }
+                if (known) {
+                    set_register(next, column, value);
+                } else {
+                    next.valid &= ~(1ULL << column);
+                }
+            }
+            
+            // An undefined return address marks the outermost frame
+            if (!is_valid(next, row.return_address_column)) break;
+            next.pc = next.values[row.return_address_column];
+            set_register(next, kStackPointerColumn, cfa);
+            if (cfa <= sp && !row.signal_frame) break;
+            caller = !row.signal_frame;
+            from_cfi = true;
+            ++stats.cfi_frames;
+        } else {
+            // No CFI: trust the frame-pointer chain
+            if (!is_valid(regs, kFramePointerColumn)) break;
+            uint64_t fp = regs.values[kFramePointerColumn];
+            uint64_t saved_fp, return_address;
+            if (fp < sp || (fp & 7) != 0 || !stack.read_word(fp, saved_fp) || !stack.read_word(fp + 8, return_address)) {
+                break;
+            }
+            set_register(next, kFramePointerColumn, saved_fp);
+            set_register(next, kStackPointerColumn, fp + 16);
+            set_register(next, kReturnAddressColumn, return_address);
+            next.pc = return_address;
+            caller = true;
+            from_cfi = false;
+            ++stats.frame_pointer_frames;
+        }
+
+#if defined(__aarch64__)
+        next.pc &= (1ULL << 48) - 1;  // Drop pointer-authentication bits
+#endif
+        regs = next;
+    }
+    return count;
+}
+
+std::vector<UnwindFrame> StackUnwinder::unwind(const UnwindRegisters& start, const StackReader& read, size_t max_frames) {
+    std::vector<UnwindFrame> frames(max_frames);
+    frames.resize(unwind(start, read, frames.data(), max_frames));
+    return frames;
+}
+
+UnwinderStats StackUnwinder::get_stats() const {
+    return stats;
+}
+
+void StackUnwinder::reset_stats() {
+    size_t module_count = stats.modules;
+    stats = UnwinderStats{};
+    stats.modules = module_count;
+}
+
+} // namespace debugger 
\ No newline at end of file
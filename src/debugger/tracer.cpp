@@ -0,0 +1,1778 @@
+#include "tracer.h"
+#include "ptrace_call.h"
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/user.h>
+#include <sys/uio.h>
+#include <linux/perf_event.h>
+#include <elf.h>
+#if defined(__aarch64__)
+#include <asm/ptrace.h>
+#endif
+#include <poll.h>
+#include <dirent.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sched.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <string>
+#include <utility>
+
+namespace debugger {
+
+namespace {
+
+// Distance from the reported program counter back to a software breakpoint:
+// int3 traps after executing, brk traps with the pc still on the instruction
+#if defined(__x86_64__)
+static constexpr uint64_t kSoftwareBreakpointPcOffset = 1;
+#else
+static constexpr uint64_t kSoftwareBreakpointPcOffset = 0;
+#endif
+
+static constexpr uint8_t kInt3 = 0xCC;
+
+// Breakpoints closer together than this are patched with one read-modify-
+// write of the span between them, up to kBreakpointClusterSpan bytes
+static constexpr uint64_t kBreakpointClusterGap = 256;
+static constexpr uint64_t kBreakpointClusterSpan = 64 * 1024;
+
+// How long the tracer waits on a single step off a breakpoint before
+// going back to its event loop
+static constexpr uint64_t kStepOverSpinNs = 200 * 1000;
+
+#if defined(__x86_64__)
+static constexpr size_t kDebugRegisterSlots = 4;
+static constexpr int kDebugStatusRegister = 6;
+static constexpr int kDebugControlRegister = 7;
+#endif
+
+// perf sampling: each thread's ring holds this many data pages, and gets
+// this much of the stack above sp copied with every sample. The rings are
+// drained on a timer with enough headroom for a few kHz.
+static constexpr size_t kPerfRingPages = 16;
+static constexpr uint32_t kPerfStackBytes = 4096;
+static constexpr uint64_t kPerfDrainIntervalNs = 4 * 1000 * 1000;
+
+// perf_regs order in a sample, and the DWARF column each one lands in
+#if defined(__x86_64__)
+static constexpr uint64_t kPerfRegisterMask = 0x1ffULL | (0xffULL << 16);  // ax..ip, r8..r15
+static constexpr unsigned kPerfRegisterColumns[] = {0, 3, 2, 1, 4, 5, 6, 7, 16, 8, 9, 10, 11, 12, 13, 14, 15};
+static constexpr size_t kPerfProgramCounter = 8;
+static constexpr size_t kPerfStackPointer = 7;
+#elif defined(__aarch64__)
+static constexpr uint64_t kPerfRegisterMask = (1ULL << 33) - 1;  // x0..x30, sp, pc
+static constexpr unsigned kPerfRegisterColumns[] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16,
+    17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+};
+static constexpr size_t kPerfProgramCounter = 32;
+static constexpr size_t kPerfStackPointer = 31;
+#endif
+
+// Follow new threads and report exec/exit; EXITKILL is added for processes
+// we start ourselves
+static constexpr unsigned long kTraceOptions = PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXEC | PTRACE_O_TRACEEXIT;
+
+// The handler below may run on any thread, so it only bumps the eventfd of
+// every live Tracer; each one then reaps just its own tracees. A fixed array
+// of atomics keeps registration lock-free and async-signal-safe.
+constexpr size_t kMaxChildNotifiers = 16;
+std::atomic<int> child_notify_fds[kMaxChildNotifiers];
+struct sigaction previous_sigchld_action;
+std::once_flag sigchld_handler_installed;
+
+void on_sigchld(int signal, siginfo_t* info, void* context) {
+    int saved_errno = errno;
+    for (const auto& slot : child_notify_fds) {
+        int fd = slot.load(std::memory_order_relaxed);
+        if (fd != -1) {
+            uint64_t one = 1;
+            ssize_t ignored = write(fd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+    errno = saved_errno;
+    
+    // Keep whoever installed a handler before us (QProcess, for one) working
+    if (previous_sigchld_action.sa_flags & SA_SIGINFO) {
+        if (previous_sigchld_action.sa_sigaction) {
+            previous_sigchld_action.sa_sigaction(signal, info, context);
+        }
+    } else if (previous_sigchld_action.sa_handler != SIG_DFL && previous_sigchld_action.sa_handler != SIG_IGN) {
+        previous_sigchld_action.sa_handler(signal);
+    }
+}
+
+void install_sigchld_handler() {
+    for (auto& slot : child_notify_fds) {
+        slot.store(-1);
+    }
+    
+    struct sigaction action = {};
+    action.sa_sigaction = on_sigchld;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;  // no SA_NOCLDSTOP: ptrace stops must notify
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGCHLD, &action, &previous_sigchld_action);
+}
+
+// Returns the slot taken, or -1 when there are more Tracers than slots
+int register_child_notifier(int fd) {
+    for (size_t i = 0; i < kMaxChildNotifiers; ++i) {
+        int expected = -1;
+        if (child_notify_fds[i].compare_exchange_strong(expected, fd)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void bump_counter(int fd) {
+    uint64_t one = 1;
+    while (write(fd, &one, sizeof(one)) == -1 && errno == EINTR) {
+    }
+}
+
+void drain_counter(int fd) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) == -1 && errno == EINTR) {
+    }
+}
+
+uint64_t monotonic_now_ns() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+uint64_t read_program_counter(pid_t tid) {
+#if defined(__x86_64__)
+    errno = 0;
+    long pc = timed_ptrace(PTRACE_PEEKUSER, tid, offsetof(struct user_regs_struct, rip), nullptr);
+    return errno == 0 ? static_cast<uint64_t>(pc) : 0;
+#elif defined(__aarch64__)
+    struct user_regs_struct regs;
+    struct iovec vector = {&regs, sizeof(regs)};
+    if (timed_ptrace(PTRACE_GETREGSET, tid, NT_PRSTATUS, &vector) == -1) return 0;
+    return regs.pc;
+#else
+    (void)tid;
+    return 0;
+#endif
+}
+
+bool read_registers(pid_t tid, struct user_regs_struct& regs) {
+#if defined(__x86_64__)
+    return timed_ptrace(PTRACE_GETREGS, tid, nullptr, &regs) != -1;
+#else
+    struct iovec vector = {&regs, sizeof(regs)};
+    return timed_ptrace(PTRACE_GETREGSET, tid, NT_PRSTATUS, &vector) != -1;
+#endif
+}
+
+bool write_program_counter(pid_t tid, uint64_t pc) {
+#if defined(__x86_64__)
+    return timed_ptrace(PTRACE_POKEUSER, tid, offsetof(struct user_regs_struct, rip), pc) != -1;
+#elif defined(__aarch64__)
+    struct user_regs_struct regs;
+    struct iovec vector = {&regs, sizeof(regs)};
+    if (timed_ptrace(PTRACE_GETREGSET, tid, NT_PRSTATUS, &vector) == -1) return false;
+    regs.pc = pc;
+    return timed_ptrace(PTRACE_SETREGSET, tid, NT_PRSTATUS, &vector) != -1;
+#else
+    (void)tid;
+    (void)pc;
+    return false;
+#endif
+}
+
+#if defined(__x86_64__)
+uint64_t debug_register_offset(int index) {
+    return offsetof(struct user, u_debugreg) + index * sizeof(unsigned long);
+}
+#endif
+
+// Hardware slots of the bank a kind of breakpoint draws from: x86-64 has
+// one bank of four, arm64 separate breakpoint and watchpoint banks whose
+// size the kernel reports
+size_t hardware_slot_capacity(pid_t tid, WatchKind kind) {
+#if defined(__x86_64__)
+    (void)tid;
+    (void)kind;
+    return kDebugRegisterSlots;
+#elif defined(__aarch64__)
+    struct user_hwdebug_state state = {};
+    struct iovec vector = {&state, sizeof(state)};
+    int regset = kind == WatchKind::EXECUTE ? NT_ARM_HW_BREAK : NT_ARM_HW_WATCH;
+    if (timed_ptrace(PTRACE_GETREGSET, tid, regset, &vector) == -1) return 0;
+    return state.dbg_info & 0xff;
+#else
+    (void)tid;
+    (void)kind;
+    return 0;
+#endif
+}
+
+bool same_hardware_bank(WatchKind a, WatchKind b) {
+#if defined(__aarch64__)
+    return (a == WatchKind::EXECUTE) == (b == WatchKind::EXECUTE);
+#else
+    (void)a;
+    (void)b;
+    return true;
+#endif
+}
+
+// Hardware hits that fault before the instruction completes and so fire
+// again on resume unless stepped past with the slots disabled. x86 sets
+// RF on return for instruction breakpoints and reports data watchpoints
+// after the access; arm64 reports both before.
+#if defined(__aarch64__)
+static constexpr bool kHardwareHitsRepeat = true;
+#else
+static constexpr bool kHardwareHitsRepeat = false;
+#endif
+
+// Asynchronous signals that say nothing about the code being debugged;
+// they are handed straight back to the tracee instead of stopping the UI
+bool is_pass_through_signal(int signal) {
+    switch (signal) {
+        case SIGCHLD:
+        case SIGWINCH:
+        case SIGALRM:
+        case SIGVTALRM:
+        case SIGPROF:
+        case SIGURG:
+        case SIGIO:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_group_stop_signal(int signal) {
+    return signal == SIGSTOP || signal == SIGTSTP || signal == SIGTTIN || signal == SIGTTOU;
+}
+
+// Blocking waitpid on one tracee that retries on EINTR
+bool wait_for_tracee(pid_t tid, int& status, int flags) {
+    for (;;) {
+        if (waitpid(tid, &status, flags) != -1) return true;
+        if (errno != EINTR) return false;
+    }
+}
+
+// Thread IDs currently listed under /proc/<pid>/task
+std::vector<pid_t> list_threads(pid_t pid) {
+    std::vector<pid_t> tids;
+    std::string path = "/proc/" + std::to_string(pid) + "/task";
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return tids;
+    
+    while (dirent* entry = readdir(dir)) {
+        pid_t tid = static_cast<pid_t>(std::strtol(entry->d_name, nullptr, 10));
+        if (tid > 0) tids.push_back(tid);
+    }
+    closedir(dir);
+    return tids;
+}
+
+} // namespace
+
+uint32_t get_ptrace_probe(int request) {
+    static const std::pair<int, const char*> kRequests[] = {
+        {PTRACE_PEEKDATA, "ptrace PEEKDATA"}, {PTRACE_POKEDATA, "ptrace POKEDATA"},
+        {PTRACE_PEEKUSER, "ptrace PEEKUSER"}, {PTRACE_POKEUSER, "ptrace POKEUSER"},
+        {PTRACE_GETREGSET, "ptrace GETREGSET"}, {PTRACE_SETREGSET, "ptrace SETREGSET"},
+        {PTRACE_CONT, "ptrace CONT"}, {PTRACE_SINGLESTEP, "ptrace SINGLESTEP"},
+        {PTRACE_INTERRUPT, "ptrace INTERRUPT"}, {PTRACE_GETSIGINFO, "ptrace GETSIGINFO"},
+        {PTRACE_GETEVENTMSG, "ptrace GETEVENTMSG"}, {PTRACE_SEIZE, "ptrace SEIZE"},
+        {PTRACE_DETACH, "ptrace DETACH"},
+#if defined(__x86_64__)
+        {PTRACE_GETREGS, "ptrace GETREGS"},
+#endif
+    };
+    static const std::vector<uint32_t> probes = [] {
+        std::vector<uint32_t> ids;
+        for (const auto& entry : kRequests) {
+            ids.push_back(perf::register_probe(entry.second, "ptrace", perf::ProbeKind::TIMER));
+        }
+        ids.push_back(perf::register_probe("ptrace (other)", "ptrace", perf::ProbeKind::TIMER));
+        return ids;
+    }();
+    
+    for (size_t i = 0; i < sizeof(kRequests) / sizeof(kRequests[0]); ++i) {
+        if (kRequests[i].first == request) {
+            return probes[i];
+        }
+    }
+    return probes.back();
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKETS && (ns >> (bucket + 1)) != 0) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+    ++count;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+}
+
+uint64_t LatencyHistogram::get_percentile_ns(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    
+    uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += buckets[bucket];
+        if (seen > target) {
+            return std::min<uint64_t>(max_ns, (2ull << bucket) - 1);
+        }
+    }
+    return max_ns;
+}
+
+TraceEventQueue::TraceEventQueue() : slots{}, head(0), tail(0) {
+}
+
+bool TraceEventQueue::push(const TraceEvent& event) {
+    size_t current_tail = tail.load(std::memory_order_relaxed);
+    if (current_tail - head.load(std::memory_order_acquire) == CAPACITY) {
+        return false;
+    }
+    
+    slots[current_tail % CAPACITY] = event;
+    tail.store(current_tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool TraceEventQueue::pop(TraceEvent& event) {
+    size_t current_head = head.load(std::memory_order_relaxed);
+    if (current_head == tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    
+    event = slots[current_head % CAPACITY];
+    head.store(current_head + 1, std::memory_order_release);
+    return true;
+}
+
+Tracer::Tracer()
+    : command_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      child_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      child_slot(-1),
+      timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)),
+      stopping(false), stop_mode(StopMode::ALL_STOP), stopping_world(false), pause_pid(0),
+      step_overs_in_flight(0), events_published(0), sampling_pid(0), sampling_frequency(0),
+      sampling_round(false), sampling_stats{}, notify_pending(false) {
+    std::call_once(sigchld_handler_installed, install_sigchld_handler);
+    child_slot = register_child_notifier(child_fd);
+    
+    thread = std::thread([this] { thread_main(); });
+}
+
+Tracer::~Tracer() {
+    stopping.store(true);
+    bump_counter(command_fd);
+    thread.join();
+    
+    if (child_slot != -1) {
+        child_notify_fds[child_slot].store(-1);
+    }
+    for (const PerfStream& stream : perf_streams) {
+        munmap(stream.ring, stream.ring_size);
+        close(stream.fd);
+    }
+    close(command_fd);
+    close(child_fd);
+    close(timer_fd);
+}
+
+void Tracer::execute(const std::function<void()>& task) {
+    if (is_tracer_thread()) {
+        task();
+        return;
+    }
+    
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        commands.push_back([&task, &done]() {
+            task();
+            done.set_value();
+        });
+    }
+    bump_counter(command_fd);
+    finished.wait();
+}
+
+bool Tracer::is_tracer_thread() const {
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+pid_t Tracer::spawn(const char* path, char* const argv[]) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Hold still until the parent has seized us, then exec
+        raise(SIGSTOP);
+        execv(path, argv);
+        _exit(127);
+    }
+    if (pid < 0) {
+        return -1;
+    }
+    
+    int status = 0;
+    if (!wait_for_tracee(pid, status, WUNTRACED) || !WIFSTOPPED(status) ||
+        timed_ptrace(PTRACE_SEIZE, pid, nullptr, kTraceOptions | PTRACE_O_EXITKILL) == -1) {
+        kill(pid, SIGKILL);
+        wait_for_tracee(pid, status, __WALL);
+        return -1;
+    }
+    tracees[pid] = TraceeState{pid, true, false, false, false, 0, 0, 0, 0, false};
+    
+    // End the job-control stop, or threads created later would start out
+    // group-stopped. Whatever the seize and the SIGCONT report on the way is
+    // run straight through until execv stops on the new image.
+    kill(pid, SIGCONT);
+    for (;;) {
+        if (!wait_for_tracee(pid, status, __WALL) || WIFEXITED(status) || WIFSIGNALED(status)) {
+            tracees.erase(pid);
+            return -1;
+        }
+        if ((status >> 16) == PTRACE_EVENT_EXEC) {
+            break;
+        }
+        timed_ptrace(PTRACE_CONT, pid, nullptr, nullptr);
+    }
+    
+    tracees[pid].running = false;
+    memory.attach(pid);
+    return pid;
+}
+
+bool Tracer::attach(pid_t pid) {
+    // Threads can be created while the task list is being walked, so keep
+    // going until a pass seizes nothing new. Threads spawned by an already
+    // seized thread are picked up through PTRACE_O_TRACECLONE.
+    bool seized_any = true;
+    while (seized_any) {
+        seized_any = false;
+        for (pid_t tid : list_threads(pid)) {
+            if (tracees.count(tid)) continue;
+            if (timed_ptrace(PTRACE_SEIZE, tid, nullptr, kTraceOptions) == 0) {
+                tracees[tid] = TraceeState{pid, true, false, false, false, 0, 0, 0, 0, false};
+                seized_any = true;
+            }
+        }
+    }
+    
+    if (!tracees.count(pid)) {
+        detach(pid);
+        return false;
+    }
+    
+    memory.attach(pid);
+    stop_world();
+    wait_for_world_stop();
+    return true;
+}
+
+bool Tracer::detach(pid_t pid) {
+    // Released threads must not run into our int3s
+    std::vector<uint64_t> addresses;
+    for (const auto& entry : breakpoints) {
+        addresses.push_back(entry.first);
+    }
+    patch_breakpoints(addresses, false);
+    breakpoints.clear();
+    bool clear_debug_registers = !hardware_breakpoints.empty();
+    hardware_breakpoints.clear();
+    
+    bool detached_all = true;
+    for (auto it = tracees.begin(); it != tracees.end();) {
+        pid_t tid = it->first;
+        TraceeState& tracee = it->second;
+        if (tracee.pid != pid) {
+            ++it;
+            continue;
+        }
+        
+        // PTRACE_DETACH needs the thread in a ptrace-stop. A thread parked
+        // on a breakpoint already has its pc rewound onto the restored byte.
+        if (tracee.running && !tracee.exiting) {
+            int status = 0;
+            timed_ptrace(PTRACE_INTERRUPT, tid, nullptr, nullptr);
+            if (wait_for_tracee(tid, status, __WALL) && WIFSTOPPED(status) && (status >> 16) == 0 &&
+                WSTOPSIG(status) != SIGTRAP) {
+                tracee.pending_signal = WSTOPSIG(status);
+            }
+        }
+        if (clear_debug_registers) {
+            write_debug_registers(tid, false);
+        }
+        if (timed_ptrace(PTRACE_DETACH, tid, nullptr, tracee.pending_signal) == -1 && errno != ESRCH) {
+            detached_all = false;
+        }
+        it = tracees.erase(it);
+    }
+    
+    held_events.clear();
+    step_overs_in_flight = 0;
+    memory.detach();
+    return detached_all;
+}
+
+bool Tracer::kill_process(pid_t pid) {
+    // ESRCH: it already exited and was reaped, the exit event is queued
+    if (kill(pid, SIGKILL) == -1) {
+        forget_process(pid);
+        return errno == ESRCH;
+    }
+    
+    // Traced threads linger as zombies until reaped, and the leader's exit
+    // is only reported once the rest of the group is gone. Reap them all
+    // here so no exit event is reported for a session that is already over.
+    for (;;) {
+        bool remaining = false;
+        for (const auto& entry : tracees) {
+            if (entry.second.pid == pid) {
+                remaining = true;
+                break;
+            }
+        }
+        if (!remaining) break;
+        
+        siginfo_t info = {};
+        if (waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | __WALL | __WNOTHREAD) == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (info.si_code == CLD_TRAPPED) {
+            // An exit stop can still be reported on the way down
+            timed_ptrace(PTRACE_CONT, info.si_pid, nullptr, nullptr);
+        } else {
+            tracees.erase(info.si_pid);
+        }
+    }
+    
+    forget_process(pid);
+    return true;
+}
+
+void Tracer::set_stop_mode(StopMode mode) {
+    stop_mode = mode;
+}
+
+StopMode Tracer::get_stop_mode() const {
+    return stop_mode;
+}
+
+std::vector<ThreadInfo> Tracer::get_threads(pid_t pid) const {
+    std::vector<ThreadInfo> threads;
+    for (const auto& entry : tracees) {
+        if (entry.second.pid == pid) {
+            threads.push_back(ThreadInfo{entry.first, !entry.second.running, entry.second.exiting});
+        }
+    }
+    return threads;
+}
+
+bool Tracer::is_stopped(pid_t tid) const {
+    auto it = tracees.find(tid);
+    return it != tracees.end() && !it->second.running;
+}
+
+bool Tracer::resume(pid_t tid, int request) {
+    auto it = tracees.find(tid);
+    if (it == tracees.end() || it->second.running) {
+        return false;
+    }
+    
+    TraceeState& tracee = it->second;
+    if (tracee.breakpoint_address != 0 && breakpoints.count(tracee.breakpoint_address)) {
+        return start_step_over(tid, tracee, request);
+    }
+    tracee.breakpoint_address = 0;
+    
+    if (tracee.hardware_hit) {
+        // Registers are per thread, so unlike a software breakpoint no
+        // sibling can slip past while this one steps
+        tracee.hardware_hit = false;
+        if (write_debug_registers(tid, true) && timed_ptrace(PTRACE_SINGLESTEP, tid, nullptr, tracee.pending_signal) != -1) {
+            tracee.pending_signal = 0;
+            tracee.stepping = true;
+            tracee.running = true;
+            tracee.hardware_step = true;
+            tracee.step_over_request = request;
+            return true;
+        }
+        write_debug_registers(tid, false);
+    }
+    
+    if (timed_ptrace(static_cast<__ptrace_request>(request), tid, nullptr, tracee.pending_signal) == -1) {
+        return false;
+    }
+    
+    tracee.pending_signal = 0;
+    tracee.stepping = request == PTRACE_SINGLESTEP;
+    tracee.running = true;
+    return true;
+}
+
+bool Tracer::resume_all(pid_t pid) {
+    // Threads parked on a breakpoint step off it first, and the rest hold
+    // until those steps are done so none of them can run through an
+    // instruction whose int3 is lifted
+    bool stepping_over = false;
+    for (auto& entry : tracees) {
+        TraceeState& tracee = entry.second;
+        if (tracee.pid == pid && !tracee.running && !tracee.exiting && tracee.breakpoint_address != 0 &&
+            breakpoints.count(tracee.breakpoint_address)) {
+            stepping_over |= start_step_over(entry.first, tracee, PTRACE_CONT);
+        }
+    }
+    
+    bool resumed = stepping_over;
+    for (auto& entry : tracees) {
+        TraceeState& tracee = entry.second;
+        if (tracee.pid == pid && !tracee.running && !tracee.exiting) {
+            if (stepping_over) {
+                tracee.resume_deferred = true;
+            } else {
+                resumed |= resume(entry.first, PTRACE_CONT);
+            }
+        }
+    }
+    return resumed;
+}
+
+size_t Tracer::insert_breakpoints(const std::vector<uint64_t>& addresses, bool tracing) {
+    size_t inserted = 0;
+    std::vector<uint64_t> fresh;
+    for (uint64_t address : addresses) {
+        auto it = breakpoints.find(address);
+        if (it != breakpoints.end()) {
+            it->second.tracing = tracing;
+            ++inserted;
+        } else {
+            breakpoints[address] = SoftwareBreakpoint{0, tracing, 0, {}, 0, nullptr};
+            fresh.push_back(address);
+        }
+    }
+    
+    return inserted + patch_breakpoints(std::move(fresh), true);
+}
+
+size_t Tracer::remove_breakpoints(const std::vector<uint64_t>& addresses) {
+    std::vector<uint64_t> present;
+    for (uint64_t address : addresses) {
+        if (breakpoints.count(address)) present.push_back(address);
+    }
+    
+    // The saved bytes go back without re-reading anything; a thread halfway
+    // through stepping off one of these simply isn't re-armed
+    size_t removed = patch_breakpoints(present, false);
+    for (uint64_t address : present) {
+        breakpoints.erase(address);
+    }
+    return removed;
+}
+
+bool Tracer::set_breakpoint_condition(uint64_t address, std::shared_ptr<const BreakpointCondition> condition) {
+    auto it = breakpoints.find(address);
+    if (it == breakpoints.end()) {
+        return false;
+    }
+    it->second.condition = std::move(condition);
+    return true;
+}
+
+std::vector<BreakpointStats> Tracer::get_breakpoint_stats() const {
+    std::vector<BreakpointStats> stats;
+    stats.reserve(breakpoints.size());
+    for (const auto& entry : breakpoints) {
+        const SoftwareBreakpoint& bp = entry.second;
+        stats.push_back(BreakpointStats{entry.first, bp.original_byte, bp.tracing, bp.hit_count, bp.latency});
+    }
+    return stats;
+}
+
+uint64_t Tracer::get_breakpoint_hits(uint64_t address) const {
+    auto it = breakpoints.find(address);
+    return it == breakpoints.end() ? 0 : it->second.hit_count;
+}
+
+void Tracer::reset_breakpoint_stats() {
+    for (auto& entry : breakpoints) {
+        entry.second.hit_count = 0;
+        entry.second.latency = LatencyHistogram{};
+    }
+    for (HardwareBreakpointInfo& hardware : hardware_breakpoints) {
+        hardware.hit_count = 0;
+    }
+}
+
+bool Tracer::insert_hardware_breakpoint(pid_t pid, uint64_t address, WatchKind kind, size_t length) {
+    if (kind == WatchKind::EXECUTE) {
+        length = 1;
+    } else if ((length != 1 && length != 2 && length != 4 && length != 8) || address % length != 0) {
+        return false;
+    }
+    
+    // Freed slots keep their place (length 0) so x86 slot numbers, which is
+    // how DR6 names a hit, stay put for threads not yet rewritten
+    size_t used = 0;
+    HardwareBreakpointInfo* free_slot = nullptr;
+    for (HardwareBreakpointInfo& hardware : hardware_breakpoints) {
+        if (hardware.length == 0) {
+            if (!free_slot) free_slot = &hardware;
+            continue;
+        }
+        if (hardware.address == address && hardware.kind == kind) {
+            return hardware.length == length;
+        }
+        if (same_hardware_bank(hardware.kind, kind)) ++used;
+    }
+    if (used >= hardware_slot_capacity(pid, kind)) {
+        return false;
+    }
+    
+    HardwareBreakpointInfo inserted = {address, kind, static_cast<uint8_t>(length), 0};
+    if (free_slot) {
+        *free_slot = inserted;
+    } else {
+        hardware_breakpoints.push_back(inserted);
+    }
+    update_debug_registers(pid);
+    return true;
+}
+
+bool Tracer::remove_hardware_breakpoint(pid_t pid, uint64_t address, WatchKind kind) {
+    for (HardwareBreakpointInfo& hardware : hardware_breakpoints) {
+        if (hardware.length != 0 && hardware.address == address && hardware.kind == kind) {
+            hardware = HardwareBreakpointInfo{0, WatchKind::EXECUTE, 0, 0};
+            update_debug_registers(pid);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<HardwareBreakpointInfo> Tracer::get_hardware_breakpoints() const {
+    std::vector<HardwareBreakpointInfo> result;
+    for (const HardwareBreakpointInfo& hardware : hardware_breakpoints) {
+        if (hardware.length != 0) result.push_back(hardware);
+    }
+    return result;
+}
+
+bool Tracer::interrupt_all(pid_t pid) {
+    if (!tracees.count(pid)) {
+        return false;
+    }
+    
+    pause_pid = pid;
+    stop_world();
+    complete_world_stop();  // nothing may have been running
+    return true;
+}
+
+void Tracer::set_event_notifier(std::function<void()> notifier) {
+    execute([this, &notifier]() { event_notifier = std::move(notifier); });
+}
+
+void Tracer::acknowledge_events() {
+    // Cleared before the consumer drains, so anything pushed from here on
+    // triggers another notification
+    notify_pending.store(false);
+}
+
+bool Tracer::pop_event(TraceEvent& event) {
+    return events.pop(event);
+}
+
+void Tracer::thread_main() {
+    PERF_THREAD_NAME("Tracer");
+    pollfd fds[3] = {{command_fd, POLLIN, 0}, {child_fd, POLLIN, 0}, {timer_fd, POLLIN, 0}};
+    // Without a notifier slot, stops are only noticed by polling for them
+    int poll_timeout_ms = child_slot != -1 ? -1 : 10;
+    
+    while (!stopping.load()) {
+        if (poll(fds, 3, poll_timeout_ms) == -1) {
+            continue;  // EINTR
+        }
+        
+        // Drain the SIGCHLD counter before reaping so a stop that lands
+        // while we reap re-arms the poll instead of being lost
+        if (fds[1].revents & POLLIN) {
+            drain_counter(child_fd);
+        }
+        if (fds[0].revents & POLLIN) {
+            drain_counter(command_fd);
+            run_commands();
+        }
+        
+        reap_children();
+        
+        if (fds[2].revents & POLLIN) {
+            uint64_t expirations = 0;
+            if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations) && sampling_pid != 0) {
+                if (sampling_stats.mode == SamplingMode::PERF_EVENT) {
+                    for (PerfStream& stream : perf_streams) drain_perf_stream(stream);
+                } else {
+                    // Ticks missed while we were busy are samples not taken
+                    sampling_stats.lost += expirations - 1;
+                    sample_by_interrupt();
+                }
+            }
+        }
+    }
+    
+    // Nobody may be left waiting in execute()
+    run_commands();
+}
+
+void Tracer::run_commands() {
+    std::deque<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        pending.swap(commands);
+    }
+    
+    for (auto& command : pending) {
+        command();
+    }
+}
+
+void Tracer::reap_children() {
+    while (reap_one(WNOHANG)) {
+    }
+}
+
+bool Tracer::reap_one(int flags, pid_t tid) {
+    siginfo_t info = {};
+    // __WNOTHREAD limits this to tracees of this thread, so children the
+    // rest of the application spawned are left for their owners
+    idtype_t which = tid != 0 ? P_PID : P_ALL;
+    for (;;) {
+        if (waitid(which, static_cast<id_t>(tid), &info, WEXITED | WSTOPPED | __WALL | __WNOTHREAD | flags) != -1) break;
+        if (errno != EINTR) return false;  // ECHILD: nothing traced
+    }
+    if (info.si_pid == 0) {
+        return false;
+    }
+    
+    uint64_t timestamp_ns = monotonic_now_ns();
+    if (info.si_code == CLD_TRAPPED || info.si_code == CLD_STOPPED) {
+        handle_stop(info.si_pid, info.si_status, timestamp_ns);
+    } else if (info.si_code == CLD_EXITED || info.si_code == CLD_KILLED || info.si_code == CLD_DUMPED) {
+        handle_exit(info, timestamp_ns);
+    }
+    
+    complete_world_stop();
+    return true;
+}
+
+void Tracer::handle_stop(pid_t tid, int status, uint64_t timestamp_ns) {
+    auto found = tracees.find(tid);
+    if (found == tracees.end()) {
+        // A new thread's first stop can be reaped before its creator
+        // reports the clone, which is when it learns its thread group
+        found = tracees.emplace(tid, TraceeState{0, true, false, false, false, 0, 0, 0, 0, false}).first;
+        found->second.debug_registers_stale = !hardware_breakpoints.empty();
+    }
+    TraceeState& tracee = found->second;
+    tracee.running = false;
+    
+    int signal = status & 0xff;
+    int ptrace_event = (status >> 8) & 0xff;
+    
+    if (tracee.hardware_step) {
+        // Stepped past a hardware hit with the slots off; turn them back on
+        tracee.hardware_step = false;
+        tracee.debug_registers_stale = false;
+        write_debug_registers(tid, false);
+        
+        bool stepped = ptrace_event == 0 && signal == SIGTRAP;
+        if (stepped && tracee.step_over_request != PTRACE_SINGLESTEP) {
+            tracee.stepping = false;
+            if (!stopping_world) {
+                resume_quietly(tid, tracee);
+            }
+            return;
+        }
+        if (!stepped) {
+            // Stopped before the instruction ran; it has to be stepped past again
+            tracee.stepping = tracee.step_over_request == PTRACE_SINGLESTEP;
+            tracee.hardware_hit = true;
+        }
+    }
+    if (tracee.debug_registers_stale) {
+        tracee.debug_registers_stale = false;
+        write_debug_registers(tid, false);
+    }
+    
+    if (tracee.step_over_address != 0 && finish_step_over(tid, tracee, signal, ptrace_event)) {
+        return;
+    }
+    
+    bool stepping = tracee.stepping;
+    tracee.stepping = false;
+    
+    TraceEvent event = {};
+    event.pid = tracee.pid;
+    event.tid = tid;
+    event.value = signal;
+    event.timestamp_ns = timestamp_ns;
+    
+    switch (ptrace_event) {
+        case PTRACE_EVENT_CLONE: {
+            unsigned long new_tid = 0;
+            timed_ptrace(PTRACE_GETEVENTMSG, tid, nullptr, &new_tid);
+            auto child = tracees.emplace(static_cast<pid_t>(new_tid), TraceeState{tracee.pid, true, false, false, false, 0, 0, 0, 0, false});
+            child.first->second.pid = tracee.pid;
+            if (child.second) {
+                // Debug registers aren't inherited; they go in at its first stop
+                child.first->second.debug_registers_stale = !hardware_breakpoints.empty();
+            }
+            if (sampling_pid == tracee.pid && sampling_stats.mode == SamplingMode::PERF_EVENT) {
+                open_perf_stream(static_cast<pid_t>(new_tid));  // unsampled if the kernel refuses
+            }
+            if (!stopping_world) {
+                resume_quietly(tid, tracee);
+            }
+            return;
+        }
+        case PTRACE_EVENT_EXEC: {
+            // The kernel has already disposed of every other thread, and
+            // the one that called execve now carries the leader's tid
+            for (auto it = tracees.begin(); it != tracees.end();) {
+                it = (it->second.pid == tracee.pid && it->first != tid) ? tracees.erase(it) : std::next(it);
+            }
+            tracee = TraceeState{tracee.pid, false, false, false, false, 0, 0, 0, 0, false};
+            if (sampling_pid == tracee.pid) {
+                stop_sampling();  // addresses from the old image mean nothing now
+            }
+            breakpoints.clear();
+            hardware_breakpoints.clear();  // the kernel flushes them on exec
+            step_overs_in_flight = 0;
+            memory.attach(tid);  // the old /proc/<pid>/mem belongs to the old image
+            event.type = TraceEventType::EXEC;
+            event.address = read_program_counter(tid);
+            report(event);
+            return;
+        }
+        case PTRACE_EVENT_EXIT:
+            // Nothing to inspect on the way out; let it finish exiting
+            tracee.exiting = true;
+            timed_ptrace(PTRACE_CONT, tid, nullptr, nullptr);
+            return;
+        case PTRACE_EVENT_STOP:
+            if (is_group_stop_signal(signal)) {
+                event.type = TraceEventType::SIGNAL;
+                event.address = read_program_counter(tid);
+                report(event);
+            } else {
+                // PTRACE_INTERRUPT, or a new thread's first stop. Either
+                // keeps it down while the group is being stopped, and is
+                // otherwise a leftover to run straight through.
+                tracee.interrupt_requested = false;
+                if (!stopping_world) {
+                    resume_quietly(tid, tracee);
+                }
+            }
+            return;
+        default:
+            break;
+    }
+    
+    event.address = read_program_counter(tid);
+    
+    if (signal == SIGTRAP) {
+        siginfo_t trap = {};
+        timed_ptrace(PTRACE_GETSIGINFO, tid, nullptr, &trap);
+        
+        if (trap.si_code == SI_KERNEL || (trap.si_code == TRAP_BRKPT && !stepping)) {
+            event.type = TraceEventType::BREAKPOINT;
+            event.address -= kSoftwareBreakpointPcOffset;
+            if (handle_breakpoint_trap(tid, tracee, event, timestamp_ns)) {
+                return;
+            }
+        } else if (trap.si_code == TRAP_HWBKPT) {
+            handle_hardware_trap(tid, tracee, event, trap);
+        } else if (stepping || trap.si_code == TRAP_TRACE) {
+            event.type = TraceEventType::STEP;
+        } else {
+            // Raised by the program itself; let it see the signal on resume
+            event.type = TraceEventType::SIGNAL;
+            tracee.pending_signal = SIGTRAP;
+        }
+    } else if (is_pass_through_signal(signal)) {
+        // Resume with the signal as if we were not here, keeping a step going
+        int request = stepping ? PTRACE_SINGLESTEP : PTRACE_CONT;
+        if (timed_ptrace(static_cast<__ptrace_request>(request), tid, nullptr, signal) != -1) {
+            tracee.stepping = stepping;
+            tracee.running = true;
+            return;
+        }
+        event.type = TraceEventType::SIGNAL;
+        tracee.pending_signal = signal;
+    } else {
+        event.type = TraceEventType::SIGNAL;
+        tracee.pending_signal = signal;
+    }
+    
+    report(event);
+}
+
+void Tracer::handle_exit(const siginfo_t& info, uint64_t timestamp_ns) {
+    pid_t tid = info.si_pid;
+    auto it = tracees.find(tid);
+    if (it == tracees.end()) {
+        return;  // a thread already dropped, e.g. by an exec in a sibling
+    }
+    pid_t pid = it->second.pid;
+    uint64_t step_over_address = it->second.step_over_address;
+    tracees.erase(it);
+    close_perf_stream(tid);
+    
+    // Died halfway off a breakpoint; put the int3 back for everyone else
+    if (step_over_address != 0) {
+        end_step_over(step_over_address);
+        if (--step_overs_in_flight == 0) {
+            resume_deferred();
+        }
+    }
+    
+    // Other threads leave quietly; the leader is reported last, once the
+    // whole group is gone
+    if (tid != pid) {
+        return;
+    }
+    
+    forget_process(pid);
+    TraceEvent event = {};
+    event.type = info.si_code == CLD_EXITED ? TraceEventType::EXITED : TraceEventType::KILLED;
+    event.pid = pid;
+    event.tid = tid;
+    event.value = info.si_status;
+    event.timestamp_ns = timestamp_ns;
+    publish(event);
+}
+
+void Tracer::report(const TraceEvent& event) {
+    if (stop_mode == StopMode::NON_STOP) {
+        publish(event);
+        return;
+    }
+    
+    held_events.push_back(event);
+    stop_world();
+}
+
+void Tracer::resume_quietly(pid_t tid, TraceeState& tracee) {
+    if (timed_ptrace(PTRACE_CONT, tid, nullptr, nullptr) != -1) {
+        tracee.running = true;
+    }
+}
+
+bool Tracer::start_step_over(pid_t tid, TraceeState& tracee, int request) {
+    uint64_t address = tracee.breakpoint_address;
+    tracee.breakpoint_address = 0;
+    
+    SoftwareBreakpoint& bp = breakpoints[address];
+    if (bp.threads_stepping == 0 && !memory.write_code(address, &bp.original_byte, 1)) {
+        return false;
+    }
+    ++bp.threads_stepping;
+    if (timed_ptrace(PTRACE_SINGLESTEP, tid, nullptr, tracee.pending_signal) == -1) {
+        end_step_over(address);
+        tracee.breakpoint_address = address;
+        return false;
+    }
+    
+    // In non-stop mode, or for a tracing breakpoint, other threads keep
+    // running and can pass this address unnoticed during the one step
+    tracee.pending_signal = 0;
+    tracee.stepping = true;
+    tracee.running = true;
+    tracee.step_over_address = address;
+    tracee.step_over_request = request;
+    ++step_overs_in_flight;
+    return true;
+}
+
+bool Tracer::finish_step_over(pid_t tid, TraceeState& tracee, int signal, int ptrace_event) {
+    // A leftover PTRACE_INTERRUPT can land before the step has executed
+    // anything; take the step again rather than re-arming under it
+    if (ptrace_event == PTRACE_EVENT_STOP && !is_group_stop_signal(signal) && !stopping_world) {
+        tracee.interrupt_requested = false;
+        if (timed_ptrace(PTRACE_SINGLESTEP, tid, nullptr, nullptr) != -1) {
+            tracee.running = true;
+            tracee.stepping = true;
+            return true;
+        }
+    }
+    
+    uint64_t address = tracee.step_over_address;
+    tracee.step_over_address = 0;
+    --step_overs_in_flight;
+    end_step_over(address);
+    
+    bool stepped = false;
+    if (ptrace_event == 0 && signal == SIGTRAP) {
+        siginfo_t trap = {};
+        timed_ptrace(PTRACE_GETSIGINFO, tid, nullptr, &trap);
+        stepped = trap.si_code > 0 && trap.si_code != SI_KERNEL;
+    }
+    
+    if (!stepped) {
+        // Stopped for something else first; if the instruction never ran
+        // the next resume has to step off the breakpoint again
+        if (read_program_counter(tid) == address) {
+            tracee.breakpoint_address = address;
+        }
+        tracee.stepping = tracee.step_over_request == PTRACE_SINGLESTEP;
+        if (step_overs_in_flight == 0) {
+            resume_deferred();
+        }
+        return false;
+    }
+    
+    if (tracee.step_over_request == PTRACE_SINGLESTEP) {
+        if (step_overs_in_flight == 0) resume_deferred();
+        return false;  // reported as the STEP it was asked to be
+    }
+    
+    tracee.stepping = false;
+    if (stopping_world) {
+        return true;  // part of the group being stopped, stays down
+    }
+    
+    resume_quietly(tid, tracee);
+    if (step_overs_in_flight == 0) {
+        resume_deferred();
+    }
+    return true;
+}
+
+void Tracer::end_step_over(uint64_t address) {
+    // Threads stepping off the same breakpoint share the lifted byte
+    auto it = breakpoints.find(address);
+    if (it != breakpoints.end() && --it->second.threads_stepping == 0) {
+        memory.write_code(address, &kInt3, 1);
+    }
+}
+
+void Tracer::resume_deferred() {
+    for (auto& entry : tracees) {
+        if (entry.second.resume_deferred) {
+            entry.second.resume_deferred = false;
+            if (!stopping_world) resume(entry.first, PTRACE_CONT);
+        }
+    }
+}
+
+bool Tracer::handle_breakpoint_trap(pid_t tid, TraceeState& tracee, TraceEvent& event, uint64_t timestamp_ns) {
+    auto it = breakpoints.find(event.address);
+    if (it == breakpoints.end()) {
+        return false;  // an int3 of the program's own, nothing to rewind
+    }
+    
+    // Back onto the breakpoint, so resuming executes the real instruction
+    SoftwareBreakpoint& bp = it->second;
+    if (kSoftwareBreakpointPcOffset != 0) {
+        write_program_counter(tid, event.address);
+    }
+    tracee.breakpoint_address = event.address;
+    
+    // One register fetch, then the compiled condition; the pc it sees is
+    // the breakpoint's own address
+    bool matched = true;
+    if (bp.condition) {
+        struct user_regs_struct regs = {};
+        matched = read_registers(tid, regs);
+        if (matched) {
+#if defined(__x86_64__)
+            regs.rip = event.address;
+#elif defined(__aarch64__)
+            regs.pc = event.address;
+#endif
+            matched = bp.condition->evaluate(regs, memory);
+        }
+    }
+    if (matched) {
+        ++bp.hit_count;
+    }
+    
+    if (bp.tracing || !matched) {
+        // Counted and gone; while the group is being stopped it stays
+        // parked and steps off with everyone else
+        if (stopping_world) {
+            bp.latency.record(monotonic_now_ns() - timestamp_ns);
+            return true;
+        }
+        if (!start_step_over(tid, tracee, PTRACE_CONT)) {
+            return false;
+        }
+        bp.latency.record(monotonic_now_ns() - timestamp_ns);
+        await_step_over(tid);  // may drop bp and tracee
+        return true;
+    }
+    
+    report(event);
+    bp.latency.record(monotonic_now_ns() - timestamp_ns);
+    return true;
+}
+
+void Tracer::await_step_over(pid_t tid) {
+    // Until the step is reaped the byte stays lifted and sibling threads run
+    // straight through it, so spin briefly for that one stop instead of
+    // leaving it to the next poll round. Never block: the instruction may
+    // be a system call that doesn't return.
+    uint64_t deadline = monotonic_now_ns() + kStepOverSpinNs;
+    do {
+        if (reap_one(WNOHANG, tid)) return;
+        sched_yield();
+    } while (monotonic_now_ns() < deadline);
+}
+
+size_t Tracer::patch_breakpoints(std::vector<uint64_t> addresses, bool arm) {
+    // Arming saves the byte it replaces into the (existing) entry and drops
+    // entries it could not patch; disarming writes the saved byte back
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+    
+    size_t patched = 0;
+    std::vector<uint8_t> span;
+    for (size_t first = 0; first < addresses.size();) {
+        uint64_t start = addresses[first];
+        size_t last = first;
+        while (last + 1 < addresses.size() && addresses[last + 1] - addresses[last] <= kBreakpointClusterGap &&
+               addresses[last + 1] - start < kBreakpointClusterSpan) {
+            ++last;
+        }
+        
+        // Only addresses inside the readable prefix can be patched
+        span.resize(addresses[last] - start + 1);
+        size_t readable = memory.read(start, span.data(), span.size());
+        size_t end = first;
+        while (end <= last && addresses[end] - start < readable) {
+            uint8_t& byte = span[addresses[end] - start];
+            SoftwareBreakpoint& bp = breakpoints[addresses[end]];
+            if (arm) {
+                bp.original_byte = byte;
+                byte = kInt3;
+            } else {
+                byte = bp.original_byte;
+            }
+            ++end;
+        }
+        
+        bool written = end > first && memory.write_code(start, span.data(), addresses[end - 1] - start + 1);
+        if (written) {
+            patched += end - first;
+        }
+        if (arm) {
+            for (size_t i = written ? end : first; i <= last; ++i) {
+                breakpoints.erase(addresses[i]);
+            }
+        }
+        first = last + 1;
+    }
+    return patched;
+}
+
+bool Tracer::write_debug_registers(pid_t tid, bool suspended) {
+#if defined(__x86_64__)
+    // Disable first so the kernel never validates a new address against an
+    // old length, then addresses, then the new control word
+    if (timed_ptrace(PTRACE_POKEUSER, tid, debug_register_offset(kDebugControlRegister), 0) == -1) {
+        return false;
+    }
+    if (suspended) {
+        return true;
+    }
+    
+    uint64_t control = 0;
+    for (size_t slot = 0; slot < hardware_breakpoints.size() && slot < kDebugRegisterSlots; ++slot) {
+        const HardwareBreakpointInfo& hardware = hardware_breakpoints[slot];
+        if (hardware.length == 0) continue;
+        if (timed_ptrace(PTRACE_POKEUSER, tid, debug_register_offset(static_cast<int>(slot)), hardware.address) == -1) {
+            return false;
+        }
+        
+        // R/W: 00 execute, 01 write, 11 read/write. LEN: 00 1, 01 2, 11 4, 10 8 bytes.
+        uint64_t access = hardware.kind == WatchKind::EXECUTE ? 0 : hardware.kind == WatchKind::WRITE ? 1 : 3;
+        uint64_t length = hardware.length == 2 ? 1 : hardware.length == 4 ? 3 : hardware.length == 8 ? 2 : 0;
+        control |= (1ull << (slot * 2)) | (access << (16 + slot * 4)) | (length << (18 + slot * 4));
+    }
+    return control == 0 || timed_ptrace(PTRACE_POKEUSER, tid, debug_register_offset(kDebugControlRegister), control) != -1;
+#elif defined(__aarch64__)
+    for (int regset : {NT_ARM_HW_BREAK, NT_ARM_HW_WATCH}) {
+        WatchKind bank = regset == NT_ARM_HW_BREAK ? WatchKind::EXECUTE : WatchKind::WRITE;
+        size_t capacity = hardware_slot_capacity(tid, bank);
+        if (capacity == 0) continue;
+        
+        // Every slot of the bank is written, so freed ones are cleared
+        struct user_hwdebug_state state = {};
+        size_t slot = 0;
+        for (const HardwareBreakpointInfo& hardware : hardware_breakpoints) {
+            if (suspended || hardware.length == 0 || !same_hardware_bank(hardware.kind, bank) || slot >= capacity) {
+                continue;
+            }
+            
+            // Enabled, EL0 only; BAS selects the bytes within the aligned
+            // doubleword (all four of an A64 instruction), LSC the access
+            uint32_t control = 1u | (2u << 1);
+            uint64_t aligned = hardware.address & ~7ull;
+            if (hardware.kind == WatchKind::EXECUTE) {
+                aligned = hardware.address & ~3ull;
+                control |= 0xfu << 5;
+            } else {
+                uint32_t byte_select = ((1u << hardware.length) - 1) << (hardware.address & 7);
+                control |= (byte_select & 0xff) << 5;
+                control |= (hardware.kind == WatchKind::WRITE ? 2u : 3u) << 3;
+            }
+            state.dbg_regs[slot].addr = aligned;
+            state.dbg_regs[slot].ctrl = control;
+            ++slot;
+        }
+        
+        struct iovec vector = {&state, offsetof(struct user_hwdebug_state, dbg_regs) + capacity * sizeof(state.dbg_regs[0])};
+        if (timed_ptrace(PTRACE_SETREGSET, tid, regset, &vector) == -1) {
+            return false;
+        }
+    }
+    return true;
+#else
+    (void)tid;
+    (void)suspended;
+    return hardware_breakpoints.empty();
+#endif
+}
+
+void Tracer::update_debug_registers(pid_t pid) {
+    // Stopped threads are rewritten now; running ones are interrupted and
+    // rewritten at that stop, then carry on
+    for (auto& entry : tracees) {
+        TraceeState& tracee = entry.second;
+        if (tracee.pid != pid || tracee.exiting) {
+            continue;
+        }
+        if (!tracee.running) {
+            tracee.debug_registers_stale = false;
+            write_debug_registers(entry.first, tracee.hardware_step);
+            continue;
+        }
+        
+        tracee.debug_registers_stale = true;
+        if (!tracee.interrupt_requested && timed_ptrace(PTRACE_INTERRUPT, entry.first, nullptr, nullptr) != -1) {
+            tracee.interrupt_requested = true;
+        }
+    }
+}
+
+void Tracer::handle_hardware_trap(pid_t tid, TraceeState& tracee, TraceEvent& event, const siginfo_t& trap) {
+    event.type = TraceEventType::BREAKPOINT;
+    HardwareBreakpointInfo* hit = nullptr;
+
+#if defined(__x86_64__)
+    // DR6 names the slot; it is sticky, so clear it for the next hit
+    (void)trap;
+    errno = 0;
+    long status = timed_ptrace(PTRACE_PEEKUSER, tid, debug_register_offset(kDebugStatusRegister), nullptr);
+    if (errno == 0) {
+        timed_ptrace(PTRACE_POKEUSER, tid, debug_register_offset(kDebugStatusRegister), 0);
+        for (size_t slot = 0; slot < hardware_breakpoints.size() && slot < kDebugRegisterSlots; ++slot) {
+            if ((status & (1l << slot)) && hardware_breakpoints[slot].length != 0) {
+                hit = &hardware_breakpoints[slot];
+                break;
+            }
+        }
+    }
+#else
+    // The fault address: the pc for a breakpoint, somewhere in the
+    // watched doubleword for a watchpoint
+    uint64_t fault = reinterpret_cast<uint64_t>(trap.si_addr);
+    for (HardwareBreakpointInfo& hardware : hardware_breakpoints) {
+        if (hardware.length == 0) continue;
+        bool matches = hardware.kind == WatchKind::EXECUTE ? fault == hardware.address
+                                                           : (fault & ~7ull) == (hardware.address & ~7ull);
+        if (matches) {
+            hit = &hardware;
+            break;
+        }
+    }
+#endif
+
+    if (!hit) {
+        return;  // not ours; reported as a plain breakpoint at the pc
+    }
+    ++hit->hit_count;
+    tracee.hardware_hit = kHardwareHitsRepeat;
+    if (hit->kind != WatchKind::EXECUTE) {
+        event.type = TraceEventType::WATCHPOINT;
+        event.value = event.address;
+        event.address = hit->address;
+    }
+}
+
+void Tracer::stop_world() {
+    // Nothing deferred is resumed once the group is coming down anyway
+    for (auto& entry : tracees) {
+        entry.second.resume_deferred = false;
+    }
+    
+    // A single pass: every request is issued before any stop is waited for
+    for (auto& entry : tracees) {
+        TraceeState& tracee = entry.second;
+        if (tracee.running && !tracee.exiting && !tracee.interrupt_requested) {
+            if (timed_ptrace(PTRACE_INTERRUPT, entry.first, nullptr, nullptr) != -1) {
+                tracee.interrupt_requested = true;
+            }
+        }
+    }
+    stopping_world = true;
+}
+
+void Tracer::wait_for_world_stop() {
+    complete_world_stop();
+    while (stopping_world && reap_one(0)) {
+    }
+}
+
+void Tracer::complete_world_stop() {
+    if (!stopping_world) {
+        return;
+    }
+    for (const auto& entry : tracees) {
+        if (entry.second.running && !entry.second.exiting) return;
+    }
+    
+    stopping_world = false;
+    bool published = !held_events.empty();
+    for (const TraceEvent& event : held_events) {
+        publish(event);
+    }
+    held_events.clear();
+    
+    // A pause that raced with a real stop is satisfied by that stop
+    if (pause_pid != 0 && !published && tracees.count(pause_pid)) {
+        TraceEvent event = {};
+        event.type = TraceEventType::INTERRUPT;
+        event.pid = pause_pid;
+        event.tid = pause_pid;
+        event.address = read_program_counter(pause_pid);
+        event.timestamp_ns = monotonic_now_ns();
+        publish(event);
+    }
+    pause_pid = 0;
+}
+
+void Tracer::forget_process(pid_t pid) {
+    if (sampling_pid == pid) {
+        stop_sampling();
+    }
+    for (auto it = tracees.begin(); it != tracees.end();) {
+        it = it->second.pid == pid ? tracees.erase(it) : std::next(it);
+    }
+    breakpoints.clear();
+    hardware_breakpoints.clear();
+    step_overs_in_flight = 0;
+    memory.detach();
+    held_events.erase(std::remove_if(held_events.begin(), held_events.end(),
+                                     [pid](const TraceEvent& event) { return event.pid == pid; }),
+                      held_events.end());
+}
+
+void Tracer::publish(const TraceEvent& event) {
+    ++events_published;
+    if (sampling_round) {
+        sampling_reported.push_back(event.tid);
+    }
+    
+    // A full ring means the consumer has stalled; the tracee simply stays
+    // stopped until there is room again
+    while (!events.push(event)) {
+        if (stopping.load()) return;
+        std::this_thread::yield();
+    }
+    
+    if (!notify_pending.exchange(true) && event_notifier) {
+        event_notifier();
+    }
+}
+
+bool Tracer::start_sampling(pid_t pid, unsigned frequency_hz, SampleHandler handler) {
+    if (!tracees.count(pid) || frequency_hz == 0) {
+        return false;
+    }
+    stop_sampling();
+    
+    sampling_pid = pid;
+    sampling_frequency = frequency_hz;
+    sample_handler = std::move(handler);
+    sampling_stats = SamplingStats{};
+    sampling_stats.mode = SamplingMode::PERF_EVENT;
+    
+    // All threads or none: a profile that silently misses some is worse
+    // than the slower fallback
+    for (const auto& entry : tracees) {
+        if (entry.second.pid != pid || entry.second.exiting) continue;
+        if (!open_perf_stream(entry.first)) {
+            sampling_stats.mode = SamplingMode::INTERRUPT;
+            break;
+        }
+    }
+    if (sampling_stats.mode == SamplingMode::INTERRUPT) {
+        for (const PerfStream& stream : perf_streams) {
+            munmap(stream.ring, stream.ring_size);
+            close(stream.fd);
+        }
+        perf_streams.clear();
+    }
+    
+    uint64_t interval_ns = sampling_stats.mode == SamplingMode::PERF_EVENT ? kPerfDrainIntervalNs
+                                                                           : 1000000000ULL / frequency_hz;
+    itimerspec timer = {};
+    timer.it_interval.tv_sec = static_cast<time_t>(interval_ns / 1000000000ULL);
+    timer.it_interval.tv_nsec = static_cast<long>(interval_ns % 1000000000ULL);
+    timer.it_value = timer.it_interval;
+    timerfd_settime(timer_fd, 0, &timer, nullptr);
+    return true;
+}
+
+void Tracer::stop_sampling() {
+    if (sampling_pid == 0) {
+        return;
+    }
+    
+    itimerspec disarmed = {};
+    timerfd_settime(timer_fd, 0, &disarmed, nullptr);
+    
+    // Whatever is still in the rings counts
+    while (!perf_streams.empty()) {
+        close_perf_stream(perf_streams.back().tid);
+    }
+    sampling_pid = 0;
+    sample_handler = nullptr;
+}
+
+bool Tracer::is_sampling() const {
+    return sampling_pid != 0;
+}
+
+SamplingStats Tracer::get_sampling_stats() const {
+    return sampling_stats;
+}
+
+bool Tracer::open_perf_stream(pid_t tid) {
+#if defined(__x86_64__) || defined(__aarch64__)
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_TASK_CLOCK;  // only advances while the thread runs
+    attr.freq = 1;
+    attr.sample_freq = sampling_frequency;
+    attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_TIME | PERF_SAMPLE_REGS_USER | PERF_SAMPLE_STACK_USER;
+    attr.sample_regs_user = kPerfRegisterMask;
+    attr.sample_stack_user = kPerfStackBytes;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    
+    int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (fd == -1) {
+        return false;
+    }
+    
+    size_t ring_size = (kPerfRingPages + 1) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* ring = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    
+    perf_streams.push_back(PerfStream{tid, fd, static_cast<uint8_t*>(ring), ring_size});
+    return true;
+#else
+    (void)tid;
+    return false;
+#endif
+}
+
+void Tracer::close_perf_stream(pid_t tid) {
+    auto it = std::find_if(perf_streams.begin(), perf_streams.end(),
+                           [tid](const PerfStream& stream) { return stream.tid == tid; });
+    if (it == perf_streams.end()) {
+        return;
+    }
+    
+    drain_perf_stream(*it);
+    munmap(it->ring, it->ring_size);
+    close(it->fd);
+    perf_streams.erase(it);
+}
+
+void Tracer::drain_perf_stream(PerfStream& stream) {
+#if defined(__x86_64__) || defined(__aarch64__)
+    auto* control = reinterpret_cast<perf_event_mmap_page*>(stream.ring);
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const uint8_t* data = stream.ring + page_size;
+    uint64_t data_size = stream.ring_size - page_size;
+    
+    uint64_t head = __atomic_load_n(&control->data_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = control->data_tail;
+    
+    while (tail + sizeof(perf_event_header) <= head) {
+        // Records wrap at the end of the ring; reassemble those that do
+        perf_event_header header;
+        uint64_t start = tail % data_size;
+        size_t first = static_cast<size_t>(std::min<uint64_t>(sizeof(header), data_size - start));
+        std::memcpy(&header, data + start, first);
+        std::memcpy(reinterpret_cast<uint8_t*>(&header) + first, data, sizeof(header) - first);
+        if (header.size < sizeof(header) || tail + header.size > head) break;
+        
+        const uint8_t* record = data + start;
+        if (start + header.size > data_size) {
+            perf_record.resize(header.size);
+            size_t before_wrap = static_cast<size_t>(data_size - start);
+            std::memcpy(perf_record.data(), data + start, before_wrap);
+            std::memcpy(perf_record.data() + before_wrap, data, header.size - before_wrap);
+            record = perf_record.data();
+        }
+        tail += header.size;
+        
+        if (header.type == PERF_RECORD_LOST && header.size >= sizeof(header) + 16) {
+            uint64_t lost;
+            std::memcpy(&lost, record + sizeof(header) + 8, sizeof(lost));
+            sampling_stats.lost += lost;
+            continue;
+        }
+        if (header.type != PERF_RECORD_SAMPLE || !sample_handler) continue;
+        
+        // pid/tid, time, regs_user {abi, regs[]}, stack_user {size, data[], dyn_size}
+        const uint8_t* cursor = record + sizeof(header);
+        const uint8_t* end = record + header.size;
+        constexpr size_t kRegisterCount = sizeof(kPerfRegisterColumns) / sizeof(kPerfRegisterColumns[0]);
+        if (end - cursor < static_cast<ptrdiff_t>(24)) continue;
+        uint32_t sample_tid;
+        std::memcpy(&sample_tid, cursor + 4, sizeof(sample_tid));
+        uint64_t abi;
+        std::memcpy(&abi, cursor + 16, sizeof(abi));
+        cursor += 24;
+        if (abi == PERF_SAMPLE_REGS_ABI_NONE || end - cursor < static_cast<ptrdiff_t>(kRegisterCount * 8 + 8)) {
+            continue;  // no user context, e.g. a sample taken during exit
+        }
+        
+        uint64_t perf_registers[kRegisterCount];
+        std::memcpy(perf_registers, cursor, sizeof(perf_registers));
+        cursor += sizeof(perf_registers);
+        UnwindRegisters regs = {};
+        for (size_t i = 0; i < kRegisterCount; ++i) {
+            regs.values[kPerfRegisterColumns[i]] = perf_registers[i];
+            regs.valid |= 1ULL << kPerfRegisterColumns[i];
+        }
+        regs.pc = perf_registers[kPerfProgramCounter];
+        
+        uint64_t stack_size;
+        std::memcpy(&stack_size, cursor, sizeof(stack_size));
+        cursor += 8;
+        const uint8_t* stack = cursor;
+        uint64_t stack_valid = 0;
+        if (stack_size != 0 && static_cast<uint64_t>(end - cursor) >= stack_size + 8) {
+            std::memcpy(&stack_valid, cursor + stack_size, sizeof(stack_valid));
+            stack_valid = std::min(stack_valid, stack_size);
+        }
+        
+        // Outer frames beyond the copy are read live; they rarely change
+        // under a running callee
+        uint64_t sp = perf_registers[kPerfStackPointer];
+        StackReader read = [this, stack, stack_valid, sp](uint64_t address, uint8_t* buffer, size_t size) -> size_t {
+            if (address >= sp && address - sp + size <= stack_valid) {
+                std::memcpy(buffer, stack + (address - sp), size);
+                return size;
+            }
+            return memory.read(address, buffer, size);
+        };
+        ++sampling_stats.samples;
+        sample_handler(static_cast<pid_t>(sample_tid), regs, read);
+    }
+    
+    __atomic_store_n(&control->data_tail, tail, __ATOMIC_RELEASE);
+#else
+    (void)stream;
+#endif
+}
+
+void Tracer::sample_by_interrupt() {
+    // Only while the target runs undisturbed; a stop of any other kind
+    // already has the world down for its own reasons
+    if (stopping_world || step_overs_in_flight != 0 || !tracees.count(sampling_pid)) {
+        return;
+    }
+    std::vector<pid_t> sampled;
+    for (const auto& entry : tracees) {
+        const TraceeState& tracee = entry.second;
+        if (tracee.pid == sampling_pid && tracee.running && !tracee.exiting && !tracee.stepping) {
+            sampled.push_back(entry.first);
+        }
+    }
+    if (sampled.empty()) {
+        return;
+    }
+    
+    uint64_t started = monotonic_now_ns();
+    uint64_t published = events_published;
+    sampling_round = true;
+    sampling_reported.clear();
+    stop_world();
+    wait_for_world_stop();
+    sampling_round = false;
+    
+    StackReader read = [this](uint64_t address, uint8_t* buffer, size_t size) {
+        return memory.read(address, buffer, size);
+    };
+    for (pid_t tid : sampled) {
+        auto it = tracees.find(tid);
+        struct user_regs_struct regs;
+        if (it == tracees.end() || it->second.running || !read_registers(tid, regs)) continue;
+        ++sampling_stats.samples;
+        sample_handler(tid, StackUnwinder::registers_from(regs), read);
+    }
+    
+    // A real stop that landed during the round is what the user sees; in
+    // all-stop mode it keeps everything down, in non-stop just its thread
+    if (events_published == published) {
+        if (stop_mode == StopMode::ALL_STOP) {
+            resume_all(sampling_pid);
+        } else {
+            for (pid_t tid : sampled) resume(tid, PTRACE_CONT);
+        }
+    } else if (stop_mode == StopMode::NON_STOP) {
+        for (pid_t tid : sampled) {
+            if (std::find(sampling_reported.begin(), sampling_reported.end(), tid) == sampling_reported.end()) {
+                resume(tid, PTRACE_CONT);
+            }
+        }
+    }
+    sampling_stats.stop_time.record(monotonic_now_ns() - started);
+}
+
+} // namespace debugger 
\ No newline at end of file
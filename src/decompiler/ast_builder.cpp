@@ -1,17 +1,1418 @@
 #include "decompiler.h"
+#include "decompiler_ir.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
 
 namespace debugger {
 
-// AST builder stubs for decompiler
-class ASTBuilder {
+namespace {
+
+constexpr uint32_t NONE = UINT32_MAX;
+
+// C precedence levels, tighter binding first
+enum Precedence {
+    ATOM = 0,
+    UNARY = 2,
+    MULTIPLICATIVE = 3,
+    ADDITIVE = 4,
+    SHIFT = 5,
+    RELATIONAL = 6,
+    EQUALITY = 7,
+    BIT_AND = 8,
+    BIT_XOR = 9,
+    BIT_OR = 10,
+    LOGICAL_AND = 11,
+    LOGICAL_OR = 12,
+    CONDITIONAL = 13
+};
+
+struct Expr {
+    std::string text;
+    int precedence = ATOM;
+};
+
+std::string operand_text(const Expr& expr, int parent, bool right = false) {
+    bool parenthesize = right ? expr.precedence >= parent && expr.precedence != ATOM : expr.precedence > parent;
+    return parenthesize ? "(" + expr.text + ")" : expr.text;
+}
+
+const char* int_type(uint8_t width, bool is_signed = true) {
+    switch (width) {
+        case 1: return is_signed ? "int8_t" : "uint8_t";
+        case 2: return is_signed ? "int16_t" : "uint16_t";
+        case 4: return is_signed ? "int32_t" : "uint32_t";
+        default: return is_signed ? "int64_t" : "uint64_t";
+    }
+}
+
+std::string format_constant(uint64_t value, uint8_t width) {
+    uint64_t mask = width >= 8 || width == 0 ? ~0ull : (1ull << (width * 8)) - 1;
+    value &= mask;
+    uint64_t sign = width >= 8 || width == 0 ? 1ull << 63 : 1ull << (width * 8 - 1);
+    bool negative = (value & sign) != 0 && ((~value + 1) & mask) < 0x10000;
+    uint64_t magnitude = negative ? (~value + 1) & mask : value;
+    
+    char buffer[32];
+    if (magnitude < 10) {
+        std::snprintf(buffer, sizeof(buffer), "%s%llu", negative ? "-" : "", static_cast<unsigned long long>(magnitude));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%s0x%llx", negative ? "-" : "", static_cast<unsigned long long>(magnitude));
+    }
+    return buffer;
+}
+
+bool is_identifier(const std::string& text) {
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    });
+}
+
+std::string stack_name(int64_t offset) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), offset < 0 ? "local_%llx" : "arg_%llx",
+                  static_cast<unsigned long long>(offset < 0 ? -offset : offset));
+    return buffer;
+}
+
+std::string label_name(uint64_t address) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "label_%llx", static_cast<unsigned long long>(address));
+    return buffer;
+}
+
+std::string quote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Flags as the condition codes read them, for flags the lifter couldn't
+// tie to a comparison
+const char* flag_formula(IrCondition condition) {
+    switch (condition) {
+        case IrCondition::EQ: return "ZF";
+        case IrCondition::NE: return "!ZF";
+        case IrCondition::LT: return "SF != OF";
+        case IrCondition::GE: return "SF == OF";
+        case IrCondition::LE: return "ZF || SF != OF";
+        case IrCondition::GT: return "!ZF && SF == OF";
+        case IrCondition::BELOW: return "CF";
+        case IrCondition::ABOVE_EQ: return "!CF";
+        case IrCondition::BELOW_EQ: return "CF || ZF";
+        case IrCondition::ABOVE: return "!CF && !ZF";
+        case IrCondition::SIGN: return "SF";
+        case IrCondition::NOT_SIGN: return "!SF";
+        case IrCondition::OVERFLOW: return "OF";
+        case IrCondition::NOT_OVERFLOW: return "!OF";
+        case IrCondition::PARITY: return "PF";
+        case IrCondition::NOT_PARITY: return "!PF";
+        case IrCondition::NONE: break;
+    }
+    return "1";
+}
+
+int flag_formula_precedence(IrCondition condition) {
+    switch (condition) {
+        case IrCondition::LE:
+        case IrCondition::BELOW_EQ: return LOGICAL_OR;
+        case IrCondition::GT:
+        case IrCondition::ABOVE: return LOGICAL_AND;
+        case IrCondition::LT:
+        case IrCondition::GE: return EQUALITY;
+        case IrCondition::EQ:
+        case IrCondition::BELOW:
+        case IrCondition::SIGN:
+        case IrCondition::OVERFLOW:
+        case IrCondition::PARITY: return ATOM;
+        default: return UNARY;
+    }
+}
+
+struct AstNode {
+    enum Kind : uint8_t { BLOCK, IF, WHILE, DO_WHILE, BREAK, CONTINUE, GOTO };
+    
+    Kind kind;
+    uint32_t block = NONE;  // BLOCK, GOTO target, the (first) block IF/WHILE/DO_WHILE test
+    bool copy = false;      // BLOCK repeating one emitted elsewhere
+    Expr condition;
+    Expr negated;
+    bool pure = true;  // the test can be dropped if neither branch does anything
+    std::vector<AstNode> body;
+    std::vector<AstNode> orelse;
+};
+
+AstNode make_node(AstNode::Kind kind, uint32_t block = NONE) {
+    AstNode node;
+    node.kind = kind;
+    node.block = block;
+    return node;
+}
+
+void invert(AstNode& node) {
+    std::swap(node.condition, node.negated);
+}
+
+// Takes the test of `from`, negated or not
+void take_test(AstNode& node, const AstNode& from, bool negate) {
+    node.block = from.block;
+    node.condition = negate ? from.negated : from.condition;
+    node.negated = negate ? from.condition : from.negated;
+}
+
+Expr logical(const char* op, int precedence, const Expr& left, const Expr& right) {
+    Expr expr;
+    expr.text = operand_text(left, precedence) + " " + op + " " + operand_text(right, precedence);
+    expr.precedence = precedence;
+    return expr;
+}
+
+bool ends_in_jump(const std::vector<AstNode>& nodes, const IrFunction& ir) {
+    if (nodes.empty()) {
+        return false;
+    }
+    const AstNode& last = nodes.back();
+    switch (last.kind) {
+        case AstNode::BREAK:
+        case AstNode::CONTINUE:
+        case AstNode::GOTO:
+            return true;
+        case AstNode::BLOCK:
+            return ir.blocks[last.block].successors.empty();
+        case AstNode::IF:
+            return !last.orelse.empty() && ends_in_jump(last.body, ir) && ends_in_jump(last.orelse, ir);
+        default:
+            return false;
+    }
+}
+
+// A continue inside a do-while would jump to the test instead of the top
+bool has_continue(const std::vector<AstNode>& nodes) {
+    for (const AstNode& node : nodes) {
+        if (node.kind == AstNode::CONTINUE) {
+            return true;
+        }
+        if (node.kind == AstNode::IF && (has_continue(node.body) || has_continue(node.orelse))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+class CodeGenerator {
 public:
-    static std::string buildAST(const std::vector<Instruction>& instructions) {
-        return "// AST not implemented yet";
+    CodeGenerator(const IrFunction& ir, const CodeGenOptions& options)
+        : ir(ir), options(options)
+    {
+    }
+    
+    GeneratedCode run() {
+        analyze_uses();
+        std::vector<uint32_t> order = reverse_postorder();
+        code.resize(ir.blocks.size());
+        flag_sources.resize(ir.variables.size());
+        used_webs.assign(ir.webs.size(), false);
+        for (uint32_t b : order) {
+            generate_block(b);
+        }
+        
+        std::vector<AstNode> root = structure(order);
+        simplify(root);
+        
+        GeneratedCode result;
+        result.return_type = return_type();
+        result.signature = signature(result.return_type);
+        
+        std::string statements;
+        print(root, 1, statements, result.control_flows);
+        const std::string fall_off = "\n    return;\n";
+        if (statements.size() > fall_off.size() &&
+            statements.compare(statements.size() - fall_off.size(), fall_off.size(), fall_off) == 0) {
+            statements.resize(statements.size() - fall_off.size() + 1);
+        }
+        result.body = "{\n" + declarations() + statements + "}\n";
+        return result;
+    }
+
+private:
+    struct Site {
+        uint32_t block;
+        uint32_t index;
+    };
+    
+    // Reads and memory dependence of an expression under construction
+    struct Collect {
+        std::vector<uint32_t> reads;  // webs read by name
+        bool memory = false;
+        std::string binary_operator;   // set when the expression is a binary operation
+        std::string left_name;
+        Expr right;
+    };
+    
+    struct Pending {
+        uint32_t var;
+        Expr expr;
+        std::vector<uint32_t> reads;
+        bool memory;
+        bool is_load;
+        Expr address;
+        uint8_t width;
+    };
+    
+    struct FlagSource {
+        IrOp op = IrOp::UNDEF;
+        Expr left;
+        Expr right;
+        uint8_t width = 0;
+        bool memory = false;
+    };
+    
+    struct BlockCode {
+        std::vector<std::string> lines;
+        Expr condition;
+        Expr negated;
+        bool pure_condition = true;  // no folded call or load to keep
+    };
+    
+    struct Loop {
+        uint32_t header;
+        std::vector<bool> body;
+        uint32_t follow;
+    };
+    
+    const IrFunction& ir;
+    const CodeGenOptions& options;
+    std::vector<Site> definition;
+    std::vector<uint32_t> use_count;
+    std::vector<uint32_t> use_block;
+    std::vector<bool> phi_used;
+    std::vector<Pending> pending;  // current block, in definition order
+    std::vector<FlagSource> flag_sources;
+    std::vector<BlockCode> code;
+    std::vector<bool> used_webs;
+    std::map<int64_t, uint8_t> frame_slots;  // stack addressed through memory, offset -> width
+    
+    // Structuring state
+    std::vector<uint32_t> position;
+    std::vector<Loop> loops;
+    std::vector<uint32_t> loop_at;  // header block -> index into loops
+    std::vector<uint32_t> post_dominator;
+    std::vector<bool> emitted;
+    std::vector<bool> goto_target;
+    std::vector<uint32_t> absorbed_into;  // block whose if tests this block's condition too
+    
+    void analyze_uses() {
+        definition.assign(ir.variables.size(), {NONE, NONE});
+        use_count.assign(ir.variables.size(), 0);
+        use_block.assign(ir.variables.size(), NONE);
+        phi_used.assign(ir.variables.size(), false);
+        for (uint32_t b = 0; b < ir.blocks.size(); ++b) {
+            const std::vector<IrInstruction>& instructions = ir.blocks[b].instructions;
+            for (uint32_t i = 0; i < instructions.size(); ++i) {
+                const IrInstruction& instruction = instructions[i];
+                if (instruction.dest != IrInstruction::NO_VAR) {
+                    definition[instruction.dest] = {b, i};
+                }
+                ir.for_each_use(instruction, [&](const IrValue& value) {
+                    if (value.kind != IrValue::VAR) {
+                        return;
+                    }
+                    ++use_count[value.var];
+                    use_block[value.var] = b;
+                    if (instruction.op == IrOp::PHI) {
+                        phi_used[value.var] = true;
+                    }
+                });
+            }
+        }
+    }
+    
+    std::vector<uint32_t> reverse_postorder() {
+        std::vector<uint32_t> order;
+        std::vector<bool> seen(ir.blocks.size(), false);
+        std::vector<std::pair<uint32_t, size_t>> stack{{0, 0}};
+        seen[0] = true;
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            const std::vector<uint32_t>& successors = ir.blocks[top.first].successors;
+            if (top.second < successors.size()) {
+                uint32_t successor = successors[top.second++];
+                if (!seen[successor]) {
+                    seen[successor] = true;
+                    stack.emplace_back(successor, 0);
+                }
+            } else {
+                order.push_back(top.first);
+                stack.pop_back();
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        position.assign(ir.blocks.size(), NONE);
+        for (uint32_t i = 0; i < order.size(); ++i) {
+            position[order[i]] = i;
+        }
+        return order;
+    }
+    
+    // Expressions
+    
+    const std::string& name_of(uint32_t var) {
+        uint32_t web = ir.variables[var].web;
+        used_webs[web] = true;
+        return ir.webs[web].name;
+    }
+    
+    bool inlineable(uint32_t var, uint32_t block) const {
+        if (var == IrInstruction::NO_VAR || use_count[var] != 1 || phi_used[var] || use_block[var] != block) {
+            return false;
+        }
+        IrLocation::Kind kind = ir.locations[ir.variables[var].location].kind;
+        return kind != IrLocation::STACK && kind != IrLocation::FLAGS;
+    }
+    
+    Pending* find_pending(uint32_t var) {
+        for (Pending& entry : pending) {
+            if (entry.var == var) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+    
+    void take_pending(uint32_t var, Collect& collect, Expr& expr) {
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (pending[i].var == var) {
+                expr = std::move(pending[i].expr);
+                collect.reads.insert(collect.reads.end(), pending[i].reads.begin(), pending[i].reads.end());
+                collect.memory |= pending[i].memory;
+                pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+                return;
+            }
+        }
+    }
+    
+    Expr value(const IrValue& operand, Collect& collect) {
+        Expr expr;
+        switch (operand.kind) {
+            case IrValue::CONST:
+                expr.text = format_constant(operand.constant, operand.width);
+                expr.precedence = expr.text[0] == '-' ? UNARY : ATOM;
+                return expr;
+            case IrValue::FRAME: {
+                int64_t offset = static_cast<int64_t>(operand.constant);
+                note_frame_slot(offset, 8);
+                expr.text = "&" + stack_name(offset);
+                expr.precedence = UNARY;
+                return expr;
+            }
+            case IrValue::TLS:
+                expr.text = "__tls(" + format_constant(operand.constant, 8) + ")";
+                return expr;
+            case IrValue::VAR:
+                break;
+            default:
+                expr.text = "0";
+                return expr;
+        }
+        
+        if (find_pending(operand.var)) {
+            take_pending(operand.var, collect, expr);
+            return expr;
+        }
+        const IrVariable& variable = ir.variables[operand.var];
+        collect.reads.push_back(variable.web);
+        expr.text = name_of(operand.var);
+        if (operand.width && operand.width < variable.width) {
+            expr.text = std::string("(") + int_type(operand.width) + ")" + expr.text;
+            expr.precedence = UNARY;
+        }
+        return expr;
+    }
+    
+    void note_frame_slot(int64_t offset, uint8_t width) {
+        uint8_t& slot = frame_slots[offset];
+        slot = std::max(slot, width);
     }
     
-    static std::string convertToC(const std::string& ast) {
-        return ast;
+    // *(T*)address, naming stack slots and thread-segment reads
+    Expr dereference(const IrValue& address, uint8_t width, bool is_signed, Collect& collect) {
+        Expr expr;
+        if (address.kind == IrValue::FRAME) {
+            int64_t offset = static_cast<int64_t>(address.constant);
+            note_frame_slot(offset, width);
+            expr.text = stack_name(offset);
+            return expr;
+        }
+        if (address.kind == IrValue::TLS) {
+            expr.text = std::string("*(") + int_type(width, is_signed) + "*)__tls(" + format_constant(address.constant, 8) + ")";
+            expr.precedence = UNARY;
+            return expr;
+        }
+        Expr pointer = value(address, collect);
+        expr.text = std::string("*(") + int_type(width, is_signed) + "*)" + operand_text(pointer, UNARY);
+        expr.precedence = UNARY;
+        collect.memory = true;
+        return expr;
+    }
+    
+    Expr binary(const char* op, int precedence, const IrInstruction& instruction, Collect& collect, bool unsigned_left = false) {
+        Expr left = value(instruction.operands[0], collect);
+        Expr right = value(instruction.operands[1], collect);
+        if (unsigned_left) {
+            left.text = std::string("(") + int_type(instruction.width, false) + ")" + operand_text(left, UNARY);
+            left.precedence = UNARY;
+        } else if (instruction.operands[0].kind == IrValue::VAR && left.precedence == ATOM) {
+            collect.binary_operator = op;
+            collect.left_name = left.text;
+            collect.right = right;
+        }
+        Expr expr;
+        expr.text = operand_text(left, precedence) + " " + op + " " + operand_text(right, precedence, true);
+        expr.precedence = precedence;
+        return expr;
+    }
+    
+    Expr condition(const IrValue& flags, IrCondition code, Collect& collect) {
+        Expr expr;
+        const FlagSource* source = flags.kind == IrValue::VAR ? &flag_sources[flags.var] : nullptr;
+        if (!source || source->op == IrOp::UNDEF) {
+            expr.text = flag_formula(code);
+            expr.precedence = flag_formula_precedence(code);
+            return expr;
+        }
+        
+        const Expr& left = source->left;
+        const Expr& right = source->right;
+        const char* op = nullptr;
+        bool is_unsigned = false;
+        switch (code) {
+            case IrCondition::EQ: op = "=="; break;
+            case IrCondition::NE: op = "!="; break;
+            case IrCondition::LT: op = "<"; break;
+            case IrCondition::LE: op = "<="; break;
+            case IrCondition::GT: op = ">"; break;
+            case IrCondition::GE: op = ">="; break;
+            case IrCondition::BELOW: op = "<"; is_unsigned = true; break;
+            case IrCondition::BELOW_EQ: op = "<="; is_unsigned = true; break;
+            case IrCondition::ABOVE: op = ">"; is_unsigned = true; break;
+            case IrCondition::ABOVE_EQ: op = ">="; is_unsigned = true; break;
+            case IrCondition::SIGN: op = "<"; break;
+            case IrCondition::NOT_SIGN: op = ">="; break;
+            default: break;
+        }
+        if (!op) {
+            expr.text = flag_formula(code);
+            expr.precedence = flag_formula_precedence(code);
+            return expr;
+        }
+        int precedence = op[0] == '=' || op[0] == '!' ? EQUALITY : RELATIONAL;
+        bool sign_test = code == IrCondition::SIGN || code == IrCondition::NOT_SIGN;
+        
+        std::string lhs;
+        std::string rhs;
+        if (source->op == IrOp::TEST) {
+            // test a, a compares a with zero; test a, b masks first
+            if (left.text == right.text) {
+                lhs = left.text;
+                if (is_unsigned) {
+                    // CF is clear after test: below never holds, above means nonzero
+                    op = code == IrCondition::BELOW || code == IrCondition::ABOVE ? "!=" : "==";
+                    if (code == IrCondition::BELOW) {
+                        expr.text = "0";
+                        return expr;
+                    }
+                    if (code == IrCondition::ABOVE_EQ) {
+                        expr.text = "1";
+                        return expr;
+                    }
+                    precedence = EQUALITY;
+                    is_unsigned = false;
+                }
+                lhs = operand_text(left, precedence);
+            } else {
+                lhs = operand_text(left, BIT_AND) + " & " + operand_text(right, BIT_AND, true);
+                lhs = "(" + lhs + ")";
+                if (code != IrCondition::EQ && code != IrCondition::NE && !sign_test) {
+                    expr.text = flag_formula(code);
+                    expr.precedence = flag_formula_precedence(code);
+                    return expr;
+                }
+            }
+            rhs = "0";
+        } else if (sign_test) {
+            lhs = "(" + operand_text(left, ADDITIVE) + " - " + operand_text(right, ADDITIVE, true) + ")";
+            rhs = "0";
+        } else if (is_unsigned) {
+            lhs = std::string("(") + int_type(source->width, false) + ")" + operand_text(left, UNARY);
+            rhs = operand_text(right, precedence, true);
+        } else {
+            lhs = operand_text(left, precedence);
+            rhs = operand_text(right, precedence, true);
+        }
+        (void)collect;
+        expr.text = lhs + " " + op + " " + rhs;
+        expr.precedence = precedence;
+        return expr;
+    }
+    
+    Expr call(const IrInstruction& instruction, Collect& collect) {
+        Expr target;
+        const IrValue& callee = instruction.operands[0];
+        if (callee.kind == IrValue::CONST && options.function_name) {
+            target.text = options.function_name(callee.constant);
+        } else {
+            Expr pointer = value(callee, collect);
+            target.text = "((int64_t (*)())" + operand_text(pointer, UNARY) + ")";
+        }
+        
+        std::string arguments;
+        for (uint32_t i = 0; i < instruction.extra_count; ++i) {
+            if (i) {
+                arguments += ", ";
+            }
+            arguments += value(ir.extra_operands[instruction.extra_first + i], collect).text;
+        }
+        collect.memory = true;
+        Expr expr;
+        expr.text = target.text + "(" + arguments + ")";
+        return expr;
+    }
+    
+    Expr expression(const IrInstruction& instruction, Collect& collect) {
+        switch (instruction.op) {
+            case IrOp::COPY: return value(instruction.operands[0], collect);
+            case IrOp::ADD: return binary("+", ADDITIVE, instruction, collect);
+            case IrOp::SUB: return binary("-", ADDITIVE, instruction, collect);
+            case IrOp::MUL: return binary("*", MULTIPLICATIVE, instruction, collect);
+            case IrOp::DIV: return binary("/", MULTIPLICATIVE, instruction, collect);
+            case IrOp::MOD: return binary("%", MULTIPLICATIVE, instruction, collect);
+            case IrOp::UDIV: return binary("/", MULTIPLICATIVE, instruction, collect, true);
+            case IrOp::UMOD: return binary("%", MULTIPLICATIVE, instruction, collect, true);
+            case IrOp::AND: return binary("&", BIT_AND, instruction, collect);
+            case IrOp::OR: return binary("|", BIT_OR, instruction, collect);
+            case IrOp::XOR: return binary("^", BIT_XOR, instruction, collect);
+            case IrOp::SHL: return binary("<<", SHIFT, instruction, collect);
+            case IrOp::SHR: return binary(">>", SHIFT, instruction, collect, true);
+            case IrOp::SAR: return binary(">>", SHIFT, instruction, collect);
+            case IrOp::NEG:
+            case IrOp::NOT: {
+                Expr operand = value(instruction.operands[0], collect);
+                Expr expr;
+                expr.text = std::string(instruction.op == IrOp::NEG ? "-" : "~") + operand_text(operand, UNARY);
+                expr.precedence = UNARY;
+                return expr;
+            }
+            case IrOp::SEXT:
+            case IrOp::ZEXT: {
+                bool is_signed = instruction.op == IrOp::SEXT;
+                const IrValue& source = instruction.operands[0];
+                if (source.kind == IrValue::VAR) {
+                    Pending* entry = find_pending(source.var);
+                    if (entry && entry->is_load) {
+                        // Load straight through a pointer of the right signedness
+                        Expr address = entry->address;
+                        uint8_t width = entry->width;
+                        Expr discarded;
+                        take_pending(source.var, collect, discarded);
+                        Expr expr;
+                        expr.text = std::string("*(") + int_type(width, is_signed) + "*)" + operand_text(address, UNARY);
+                        expr.precedence = UNARY;
+                        return expr;
+                    }
+                }
+                Expr operand = value(source, collect);
+                std::string truncation = std::string("(") + int_type(instruction.source_width) + ")";
+                if (operand.text.compare(0, truncation.size(), truncation) == 0 &&
+                    is_identifier(operand.text.substr(truncation.size()))) {
+                    operand.text.erase(0, truncation.size());
+                    operand.precedence = ATOM;
+                }
+                Expr expr;
+                expr.text = std::string("(") + int_type(instruction.source_width, is_signed) + ")" + operand_text(operand, UNARY);
+                expr.precedence = UNARY;
+                return expr;
+            }
+            case IrOp::LOAD:
+                return dereference(instruction.operands[0], instruction.width, true, collect);
+            case IrOp::SETCC:
+                return condition(instruction.operands[0], instruction.condition, collect);
+            case IrOp::SELECT: {
+                Expr test = condition(instruction.operands[0], instruction.condition, collect);
+                Expr a = value(instruction.operands[1], collect);
+                Expr b = value(instruction.operands[2], collect);
+                Expr expr;
+                expr.text = operand_text(test, CONDITIONAL) + " ? " + operand_text(a, CONDITIONAL) + " : " +
+                            operand_text(b, CONDITIONAL, true);
+                expr.precedence = CONDITIONAL;
+                return expr;
+            }
+            case IrOp::CALL:
+                return call(instruction, collect);
+            case IrOp::ASM: {
+                Expr expr;
+                expr.text = "__asm(" + quote(ir.asm_text[instruction.text]) + ")";
+                return expr;
+            }
+            default: {
+                Expr expr;
+                expr.text = "0";
+                return expr;
+            }
+        }
+    }
+    
+    // Statements
+    
+    void materialize(BlockCode& block, Pending& entry) {
+        block.lines.push_back(name_of(entry.var) + " = " + entry.expr.text + ";");
+    }
+    
+    // Folded expressions must be evaluated before anything overwrites what
+    // they read; memory reads also stay ahead of stores and calls
+    void emit_statement(BlockCode& block, std::string line, uint32_t assigned_web, bool side_effect) {
+        for (size_t i = 0; i < pending.size();) {
+            Pending& entry = pending[i];
+            bool clobbered = (side_effect && entry.memory) ||
+                             (assigned_web != NONE &&
+                              std::find(entry.reads.begin(), entry.reads.end(), assigned_web) != entry.reads.end());
+            if (clobbered) {
+                materialize(block, entry);
+                pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
+        }
+        block.lines.push_back(std::move(line));
+    }
+    
+    void assign(BlockCode& block, uint32_t var, const Expr& expr, const Collect& collect, bool side_effect) {
+        const std::string& name = name_of(var);
+        std::string line;
+        if (!collect.binary_operator.empty() && collect.left_name == name) {
+            if (collect.right.text == "1" && (collect.binary_operator == "+" || collect.binary_operator == "-")) {
+                line = name + collect.binary_operator + collect.binary_operator + ";";
+            } else {
+                line = name + " " + collect.binary_operator + "= " + collect.right.text + ";";
+            }
+        } else {
+            line = name + " = " + expr.text + ";";
+        }
+        emit_statement(block, std::move(line), ir.variables[var].web, side_effect);
+    }
+    
+    void generate_block(uint32_t b) {
+        BlockCode& block = code[b];
+        pending.clear();
+        
+        for (const IrInstruction& instruction : ir.blocks[b].instructions) {
+            Collect collect;
+            switch (instruction.op) {
+                case IrOp::PHI:
+                case IrOp::UNDEF:
+                case IrOp::JUMP:
+                    break;
+                
+                case IrOp::CMP:
+                case IrOp::TEST: {
+                    FlagSource& source = flag_sources[instruction.dest];
+                    source.op = instruction.op;
+                    source.left = value(instruction.operands[0], collect);
+                    source.right = value(instruction.operands[1], collect);
+                    source.width = instruction.width;
+                    source.memory = collect.memory;
+                    break;
+                }
+                
+                case IrOp::BRANCH:
+                    if (instruction.condition == IrCondition::NONE) {
+                        block.condition.text = "__cond(" + quote(ir.asm_text[instruction.text]) + ")";
+                        block.negated.text = "!" + block.condition.text;
+                        block.negated.precedence = UNARY;
+                    } else {
+                        block.condition = condition(instruction.operands[0], instruction.condition, collect);
+                        block.negated = condition(instruction.operands[0], negate_condition(instruction.condition), collect);
+                        block.pure_condition = instruction.operands[0].kind != IrValue::VAR ||
+                                               !flag_sources[instruction.operands[0].var].memory;
+                    }
+                    break;
+                
+                case IrOp::RETURN: {
+                    std::string line = "return;";
+                    if (instruction.operand_count) {
+                        line = "return " + value(instruction.operands[0], collect).text + ";";
+                    }
+                    emit_statement(block, std::move(line), NONE, true);
+                    break;
+                }
+                
+                case IrOp::INDIRECT_JUMP: {
+                    Expr target = value(instruction.operands[0], collect);
+                    emit_statement(block, "goto *" + operand_text(target, UNARY) + ";", NONE, true);
+                    break;
+                }
+                
+                case IrOp::STORE: {
+                    Expr stored = value(instruction.operands[1], collect);
+                    Expr target = dereference(instruction.operands[0], instruction.width, true, collect);
+                    emit_statement(block, target.text + " = " + stored.text + ";", NONE, true);
+                    break;
+                }
+                
+                case IrOp::CALL:
+                case IrOp::ASM: {
+                    Expr expr = expression(instruction, collect);
+                    if (instruction.dest == IrInstruction::NO_VAR) {
+                        emit_statement(block, expr.text + ";", NONE, true);
+                    } else if (instruction.op == IrOp::CALL && inlineable(instruction.dest, b)) {
+                        pending.push_back({instruction.dest, expr, collect.reads, true, false, Expr(), instruction.width});
+                    } else {
+                        emit_statement(block, name_of(instruction.dest) + " = " + expr.text + ";",
+                                       ir.variables[instruction.dest].web, true);
+                    }
+                    break;
+                }
+                
+                default: {
+                    if (instruction.dest == IrInstruction::NO_VAR) {
+                        break;
+                    }
+                    Expr address;
+                    bool is_load = instruction.op == IrOp::LOAD;
+                    if (is_load && instruction.operands[0].kind != IrValue::FRAME &&
+                        instruction.operands[0].kind != IrValue::TLS) {
+                        // Kept apart so an extension can pick the pointer type
+                        address = value(instruction.operands[0], collect);
+                        collect.memory = true;
+                    }
+                    Expr expr;
+                    if (!address.text.empty()) {
+                        expr.text = std::string("*(") + int_type(instruction.width) + "*)" + operand_text(address, UNARY);
+                        expr.precedence = UNARY;
+                    } else {
+                        expr = expression(instruction, collect);
+                    }
+                    if (inlineable(instruction.dest, b)) {
+                        pending.push_back({instruction.dest, expr, collect.reads, collect.memory,
+                                           !address.text.empty(), address, instruction.width});
+                    } else {
+                        assign(block, instruction.dest, expr, collect, false);
+                    }
+                    break;
+                }
+            }
+        }
+        
+        for (Pending& entry : pending) {
+            materialize(block, entry);
+        }
+        pending.clear();
+    }
+    
+    // Structuring
+    
+    bool dominates(uint32_t a, uint32_t b) const {
+        while (b != NONE) {
+            if (a == b) {
+                return true;
+            }
+            b = ir.blocks[b].immediate_dominator;
+        }
+        return false;
+    }
+    
+    void find_loops(const std::vector<uint32_t>& order) {
+        const size_t n = ir.blocks.size();
+        loop_at.assign(n, NONE);
+        for (uint32_t header : order) {
+            std::vector<uint32_t> latches;
+            for (uint32_t p : ir.blocks[header].predecessors) {
+                if (position[p] != NONE && dominates(header, p)) {
+                    latches.push_back(p);
+                }
+            }
+            if (latches.empty()) {
+                continue;
+            }
+            
+            Loop loop;
+            loop.header = header;
+            loop.body.assign(n, false);
+            loop.body[header] = true;
+            std::vector<uint32_t> worklist;
+            for (uint32_t latch : latches) {
+                if (!loop.body[latch]) {
+                    loop.body[latch] = true;
+                    worklist.push_back(latch);
+                }
+            }
+            while (!worklist.empty()) {
+                uint32_t b = worklist.back();
+                worklist.pop_back();
+                for (uint32_t p : ir.blocks[b].predecessors) {
+                    if (!loop.body[p] && position[p] != NONE) {
+                        loop.body[p] = true;
+                        worklist.push_back(p);
+                    }
+                }
+            }
+            
+            // Where the loop continues: the header's exit for while loops,
+            // then a latch's exit for do-while loops, then any exit
+            loop.follow = NONE;
+            auto exit_of = [&](uint32_t b) {
+                for (uint32_t s : ir.blocks[b].successors) {
+                    if (!loop.body[s]) {
+                        return s;
+                    }
+                }
+                return NONE;
+            };
+            loop.follow = exit_of(header);
+            for (size_t i = 0; loop.follow == NONE && i < latches.size(); ++i) {
+                loop.follow = exit_of(latches[i]);
+            }
+            for (size_t i = 0; loop.follow == NONE && i < order.size(); ++i) {
+                if (loop.body[order[i]]) {
+                    loop.follow = exit_of(order[i]);
+                }
+            }
+            
+            // Exits only the loop can reach (early returns and the like)
+            // belong to its body rather than becoming gotos
+            bool grew = true;
+            while (grew) {
+                grew = false;
+                for (uint32_t b : order) {
+                    if (loop.body[b] || b == loop.follow || ir.blocks[b].predecessors.empty()) {
+                        continue;
+                    }
+                    bool inside = std::all_of(ir.blocks[b].predecessors.begin(), ir.blocks[b].predecessors.end(),
+                                              [&loop](uint32_t p) { return loop.body[p]; });
+                    if (inside) {
+                        loop.body[b] = true;
+                        grew = true;
+                    }
+                }
+            }
+            
+            loop_at[header] = static_cast<uint32_t>(loops.size());
+            loops.push_back(std::move(loop));
+        }
+    }
+    
+    // Immediate post-dominators over the reverse CFG, with a virtual exit
+    // after every block that leaves the function
+    void find_post_dominators() {
+        const uint32_t n = static_cast<uint32_t>(ir.blocks.size());
+        const uint32_t exit = n;
+        std::vector<std::vector<uint32_t>> reverse_successors(n + 1);
+        for (uint32_t b = 0; b < n; ++b) {
+            if (position[b] == NONE) {
+                continue;
+            }
+            if (ir.blocks[b].successors.empty()) {
+                reverse_successors[exit].push_back(b);
+            }
+            for (uint32_t p : ir.blocks[b].predecessors) {
+                if (position[p] != NONE) {
+                    reverse_successors[b].push_back(p);
+                }
+            }
+        }
+        
+        std::vector<uint32_t> order;
+        std::vector<bool> seen(n + 1, false);
+        std::vector<std::pair<uint32_t, size_t>> stack{{exit, 0}};
+        seen[exit] = true;
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            if (top.second < reverse_successors[top.first].size()) {
+                uint32_t next = reverse_successors[top.first][top.second++];
+                if (!seen[next]) {
+                    seen[next] = true;
+                    stack.emplace_back(next, 0);
+                }
+            } else {
+                order.push_back(top.first);
+                stack.pop_back();
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        std::vector<uint32_t> rank(n + 1, NONE);
+        for (uint32_t i = 0; i < order.size(); ++i) {
+            rank[order[i]] = i;
+        }
+        
+        std::vector<uint32_t> ipdom(n + 1, NONE);
+        ipdom[exit] = exit;
+        auto intersect = [&](uint32_t a, uint32_t b) {
+            while (a != b) {
+                while (rank[a] > rank[b]) a = ipdom[a];
+                while (rank[b] > rank[a]) b = ipdom[b];
+            }
+            return a;
+        };
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = 1; i < order.size(); ++i) {
+                uint32_t b = order[i];
+                uint32_t candidate = NONE;
+                // Predecessors in the reverse graph are the CFG successors
+                const std::vector<uint32_t>& successors = ir.blocks[b].successors;
+                if (successors.empty()) {
+                    candidate = exit;
+                }
+                for (uint32_t s : successors) {
+                    if (ipdom[s] == NONE) {
+                        continue;
+                    }
+                    candidate = candidate == NONE ? s : intersect(s, candidate);
+                }
+                if (candidate != ipdom[b]) {
+                    ipdom[b] = candidate;
+                    changed = true;
+                }
+            }
+        }
+        
+        post_dominator.assign(n, NONE);
+        for (uint32_t b = 0; b < n; ++b) {
+            post_dominator[b] = ipdom[b] == exit ? NONE : ipdom[b];
+        }
+    }
+    
+    // A shared return is shorter repeated than jumped to
+    bool is_small_return(uint32_t b) const {
+        return ir.blocks[b].successors.empty() && code[b].lines.size() <= 2;
+    }
+
+    AstNode copy_of(uint32_t b) const {
+        AstNode node = make_node(AstNode::BLOCK, b);
+        node.copy = true;
+        return node;
+    }
+
+    void add_goto(uint32_t target, std::vector<AstNode>& out) {
+        goto_target[target] = true;
+        out.push_back(make_node(AstNode::GOTO, target));
+    }
+    
+    // One side of an if: where it starts, the block testing it, and the
+    // block both sides fall into afterwards
+    struct Arm {
+        uint32_t entry;
+        uint32_t parent;
+        uint32_t* join;
+    };
+
+    // Blocks an arm doesn't dominate are reached from elsewhere too; the arm
+    // ends there and the code continues after the if
+    bool owned_by(const Arm& arm, uint32_t b) const {
+        if (b != arm.entry) {
+            return dominates(arm.entry, b);
+        }
+        const std::vector<uint32_t>& predecessors = ir.blocks[b].predecessors;
+        return std::all_of(predecessors.begin(), predecessors.end(), [this, &arm](uint32_t p) {
+            return p == arm.parent || absorbed_into[p] == arm.parent;
+        });
+    }
+
+    // if (a) { if (b) X } else Y with nothing but the test in b's block
+    // becomes if (a && b) X, and likewise for ||
+    void combine_conditions(AstNode& node, const Loop* loop, uint32_t& taken, uint32_t& fall) {
+        const uint32_t b = node.block;
+        auto plain_test = [&](uint32_t t) {
+            const IrBlock& block = ir.blocks[t];
+            return code[t].lines.empty() && block.successors.size() == 2 && block.predecessors.size() == 1 &&
+                   !emitted[t] && loop_at[t] == NONE && (!loop || (t != loop->header && loop->body[t]));
+        };
+        for (;;) {
+            if (plain_test(taken)) {
+                const std::vector<uint32_t>& next = ir.blocks[taken].successors;
+                if (next[1] == fall || next[0] == fall) {
+                    bool positive = next[1] == fall;
+                    const Expr& test = positive ? code[taken].condition : code[taken].negated;
+                    const Expr& test_negated = positive ? code[taken].negated : code[taken].condition;
+                    node.condition = logical("&&", LOGICAL_AND, node.condition, test);
+                    node.negated = logical("||", LOGICAL_OR, node.negated, test_negated);
+                    node.pure = node.pure && code[taken].pure_condition;
+                    emitted[taken] = true;
+                    absorbed_into[taken] = b;
+                    taken = positive ? next[0] : next[1];
+                    continue;
+                }
+            }
+            if (plain_test(fall)) {
+                const std::vector<uint32_t>& next = ir.blocks[fall].successors;
+                if (next[0] == taken || next[1] == taken) {
+                    bool positive = next[0] == taken;
+                    const Expr& test = positive ? code[fall].condition : code[fall].negated;
+                    const Expr& test_negated = positive ? code[fall].negated : code[fall].condition;
+                    node.condition = logical("||", LOGICAL_OR, node.condition, test);
+                    node.negated = logical("&&", LOGICAL_AND, node.negated, test_negated);
+                    node.pure = node.pure && code[fall].pure_condition;
+                    emitted[fall] = true;
+                    absorbed_into[fall] = b;
+                    fall = positive ? next[1] : next[0];
+                    continue;
+                }
+            }
+            return;
+        }
+    }
+    
+    void emit_region(uint32_t b, uint32_t stop, const Loop* loop, std::vector<AstNode>& out,
+                     bool entering = false, const Arm* arm = nullptr) {
+        while (b != NONE && b != stop) {
+            if (loop) {
+                if (b == loop->header && !entering) {
+                    out.push_back(make_node(AstNode::CONTINUE));
+                    return;
+                }
+                if (!loop->body[b]) {
+                    if (b == loop->follow) {
+                        out.push_back(make_node(AstNode::BREAK));
+                    } else if (is_small_return(b)) {
+                        out.push_back(copy_of(b));
+                    } else {
+                        add_goto(b, out);
+                    }
+                    return;
+                }
+            }
+            if (emitted[b]) {
+                if (is_small_return(b)) {
+                    out.push_back(copy_of(b));
+                } else {
+                    add_goto(b, out);
+                }
+                return;
+            }
+            if (arm && arm->join && !owned_by(*arm, b)) {
+                if (*arm->join == NONE || *arm->join == b) {
+                    *arm->join = b;
+                } else if (is_small_return(b)) {
+                    out.push_back(copy_of(b));
+                } else {
+                    add_goto(b, out);
+                }
+                return;
+            }
+            if (loop_at[b] != NONE && !(loop && loop->header == b)) {
+                const Loop& inner = loops[loop_at[b]];
+                AstNode node = make_node(AstNode::WHILE);
+                emit_region(b, NONE, &inner, node.body, true);
+                out.push_back(std::move(node));
+                b = inner.follow;
+                continue;
+            }
+            entering = false;
+            
+            emitted[b] = true;
+            out.push_back(make_node(AstNode::BLOCK, b));
+            const std::vector<uint32_t>& successors = ir.blocks[b].successors;
+            if (successors.empty()) {
+                return;
+            }
+            if (successors.size() == 1 || successors[0] == successors[1]) {
+                b = successors[0];
+                continue;
+            }
+            
+            uint32_t merge = post_dominator[b];
+            if (loop && merge != NONE && !loop->body[merge]) {
+                merge = NONE;
+            }
+            uint32_t taken = successors[0];
+            uint32_t fall = successors[1];
+            AstNode node = make_node(AstNode::IF, b);
+            node.condition = code[b].condition;
+            node.negated = code[b].negated;
+            node.pure = code[b].pure_condition;
+            combine_conditions(node, loop, taken, fall);
+            bool negate = false;
+            bool fall_returns = ir.blocks[fall].successors.empty() && !emitted[fall];
+            bool taken_returns = ir.blocks[taken].successors.empty();
+            // Inside a loop the arm leaving it goes first: if (...) break;
+            auto leaves = [loop](uint32_t target) { return loop && (target == loop->header || !loop->body[target]); };
+            if (taken == merge || (merge == NONE && fall_returns && !taken_returns) ||
+                (merge == NONE && leaves(fall) && !leaves(taken))) {
+                std::swap(taken, fall);
+                negate = true;
+            }
+            
+            if (negate) {
+                invert(node);
+            }
+            uint32_t join = NONE;
+            Arm then_arm{taken, b, merge == NONE ? &join : nullptr};
+            emit_region(taken, merge, loop, node.body, false, &then_arm);
+            if (fall != join) {
+                if (join == NONE && ends_in_jump(node.body, ir)) {
+                    // The then-branch never falls through: no else needed
+                    out.push_back(std::move(node));
+                    b = fall;
+                    continue;
+                }
+                Arm else_arm{fall, b, merge == NONE ? &join : nullptr};
+                emit_region(fall, merge, loop, node.orelse, false, &else_arm);
+            }
+            if (node.body.empty() && !node.orelse.empty()) {
+                node.body.swap(node.orelse);
+                invert(node);
+            }
+            if (!node.body.empty()) {
+                out.push_back(std::move(node));
+            }
+            b = merge != NONE ? merge : join;
+            if (b == NONE) {
+                return;
+            }
+        }
+    }
+    
+    std::vector<AstNode> structure(const std::vector<uint32_t>& order) {
+        find_loops(order);
+        find_post_dominators();
+        emitted.assign(ir.blocks.size(), false);
+        goto_target.assign(ir.blocks.size(), false);
+        absorbed_into.assign(ir.blocks.size(), NONE);
+        
+        std::vector<AstNode> root;
+        emit_region(0, NONE, nullptr, root);
+        
+        // Blocks only reachable by goto land after the structured code
+        bool more = true;
+        while (more) {
+            more = false;
+            for (uint32_t b : order) {
+                if (!emitted[b] && goto_target[b]) {
+                    emit_region(b, NONE, nullptr, root);
+                    more = true;
+                }
+            }
+        }
+        return root;
+    }
+    
+    bool block_is_empty(uint32_t b) const {
+        return code[b].lines.empty() && !goto_target[b];
+    }
+    
+    bool prints_nothing(const std::vector<AstNode>& nodes) const {
+        return std::all_of(nodes.begin(), nodes.end(), [this](const AstNode& node) {
+            return node.kind == AstNode::BLOCK && code[node.block].lines.empty() && (node.copy || !goto_target[node.block]);
+        });
+    }
+    
+    void simplify(std::vector<AstNode>& nodes) {
+        for (AstNode& node : nodes) {
+            simplify(node.body);
+            simplify(node.orelse);
+            if (node.kind == AstNode::IF) {
+                if (prints_nothing(node.orelse)) {
+                    node.orelse.clear();
+                    if (prints_nothing(node.body) && node.pure) {
+                        node.body.clear();
+                    }
+                } else if (prints_nothing(node.body)) {
+                    node.body.swap(node.orelse);
+                    node.orelse.clear();
+                    invert(node);
+                }
+            }
+            if (node.kind != AstNode::WHILE || node.block != NONE) {
+                continue;
+            }
+            std::vector<AstNode>& body = node.body;
+            
+            // while (1) { if (!c) break; ... } -> while (c) { ... }
+            if (body.size() >= 2 && body[0].kind == AstNode::BLOCK && block_is_empty(body[0].block) &&
+                body[1].kind == AstNode::IF && body[1].block == body[0].block) {
+                AstNode& test = body[1];
+                bool break_first = test.body.size() == 1 && test.body[0].kind == AstNode::BREAK;
+                bool break_else = test.orelse.size() == 1 && test.orelse[0].kind == AstNode::BREAK;
+                if (break_first && test.orelse.empty()) {
+                    take_test(node, test, true);
+                    body.erase(body.begin(), body.begin() + 2);
+                } else if (break_else) {
+                    take_test(node, test, false);
+                    std::vector<AstNode> inner = std::move(test.body);
+                    body.erase(body.begin(), body.begin() + 2);
+                    body.insert(body.begin(), std::make_move_iterator(inner.begin()), std::make_move_iterator(inner.end()));
+                }
+            }
+            
+            // do { ... } while (c): the body ends testing whether to go round again
+            if (node.block == NONE && body.size() >= 2) {
+                AstNode& last = body.back();
+                AstNode& test = body[body.size() - 2];
+                if (test.kind == AstNode::IF && test.orelse.empty() && test.body.size() == 1 &&
+                    (last.kind == AstNode::BREAK || last.kind == AstNode::CONTINUE)) {
+                    AstNode::Kind inside = test.body[0].kind;
+                    bool repeat_if_true = inside == AstNode::CONTINUE && last.kind == AstNode::BREAK;
+                    bool exit_if_true = inside == AstNode::BREAK && last.kind == AstNode::CONTINUE;
+                    std::vector<AstNode> rest(body.begin(), body.end() - 2);
+                    if ((repeat_if_true || exit_if_true) && !has_continue(rest)) {
+                        node.kind = AstNode::DO_WHILE;
+                        take_test(node, test, !repeat_if_true);
+                        body = std::move(rest);
+                    }
+                }
+            }
+            
+            if (!body.empty() && body.back().kind == AstNode::CONTINUE) {
+                body.pop_back();
+            }
+        }
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [](const AstNode& node) {
+            return node.kind == AstNode::IF && node.body.empty() && node.orelse.empty();
+        }), nodes.end());
+    }
+    
+    // Output
+    
+    const Expr& condition_of(const AstNode& node) const {
+        return node.condition;
+    }
+    
+    void print(const std::vector<AstNode>& nodes, int depth, std::string& out, std::vector<ControlFlow>& flows) {
+        std::string indent(static_cast<size_t>(depth) * 4, ' ');
+        for (const AstNode& node : nodes) {
+            switch (node.kind) {
+                case AstNode::BLOCK:
+                    if (goto_target[node.block] && !node.copy) {
+                        out += indent.substr(0, indent.size() - 2) + label_name(ir.blocks[node.block].address) + ":\n";
+                    }
+                    for (const std::string& line : code[node.block].lines) {
+                        out += indent + line + "\n";
+                    }
+                    break;
+                case AstNode::IF: {
+                    flows.push_back(make_flow(ControlFlow::IF_ELSE, node));
+                    out += indent + "if (" + condition_of(node).text + ") {\n";
+                    print(node.body, depth + 1, out, flows);
+                    const std::vector<AstNode>* orelse = &node.orelse;
+                    while (orelse->size() == 1 && (*orelse)[0].kind == AstNode::IF) {
+                        const AstNode& chained = (*orelse)[0];
+                        flows.push_back(make_flow(ControlFlow::IF_ELSE, chained));
+                        out += indent + "} else if (" + condition_of(chained).text + ") {\n";
+                        print(chained.body, depth + 1, out, flows);
+                        orelse = &chained.orelse;
+                    }
+                    if (!orelse->empty()) {
+                        out += indent + "} else {\n";
+                        print(*orelse, depth + 1, out, flows);
+                    }
+                    out += indent + "}\n";
+                    break;
+                }
+                case AstNode::WHILE:
+                    if (node.block != NONE) {
+                        flows.push_back(make_flow(ControlFlow::WHILE_LOOP, node));
+                    }
+                    out += indent + "while (" + (node.block == NONE ? std::string("1") : condition_of(node).text) + ") {\n";
+                    print(node.body, depth + 1, out, flows);
+                    out += indent + "}\n";
+                    break;
+                case AstNode::DO_WHILE:
+                    flows.push_back(make_flow(ControlFlow::WHILE_LOOP, node));
+                    out += indent + "do {\n";
+                    print(node.body, depth + 1, out, flows);
+                    out += indent + "} while (" + condition_of(node).text + ");\n";
+                    break;
+                case AstNode::BREAK:
+                    out += indent + "break;\n";
+                    break;
+                case AstNode::CONTINUE:
+                    out += indent + "continue;\n";
+                    break;
+                case AstNode::GOTO:
+                    out += indent + "goto " + label_name(ir.blocks[node.block].address) + ";\n";
+                    break;
+            }
+        }
+    }
+    
+    ControlFlow make_flow(ControlFlow::Type type, const AstNode& node) const {
+        ControlFlow flow;
+        flow.type = type;
+        flow.start_address = ir.blocks[node.block].address;
+        flow.end_address = flow.start_address;
+        for (const IrInstruction& instruction : ir.blocks[node.block].instructions) {
+            flow.end_address = std::max(flow.end_address, instruction.address);
+        }
+        flow.condition = condition_of(node).text;
+        return flow;
+    }
+    
+    std::string return_type() const {
+        uint8_t width = 0;
+        for (const IrBlock& block : ir.blocks) {
+            for (const IrInstruction& instruction : block.instructions) {
+                if (instruction.op != IrOp::RETURN || instruction.operand_count == 0) {
+                    continue;
+                }
+                const IrValue& returned = instruction.operands[0];
+                uint8_t size = returned.kind == IrValue::VAR ? ir.variables[returned.var].width : returned.width;
+                width = std::max<uint8_t>(width, std::min<uint8_t>(size ? size : 8, returned.width ? returned.width : 8));
+            }
+        }
+        return width == 0 ? "void" : int_type(width);
+    }
+    
+    std::string signature(const std::string& type) const {
+        int count = 0;
+        std::vector<const IrWeb*> parameters(6, nullptr);
+        for (uint32_t w = 0; w < ir.webs.size(); ++w) {
+            const IrWeb& web = ir.webs[w];
+            if (web.parameter >= 0 && web.parameter < 6 && used_webs[w]) {
+                parameters[static_cast<size_t>(web.parameter)] = &web;
+                count = std::max(count, web.parameter + 1);
+            }
+        }
+        std::string text = type + " " + options.name + "(";
+        for (int i = 0; i < count; ++i) {
+            if (i) {
+                text += ", ";
+            }
+            const IrWeb* web = parameters[static_cast<size_t>(i)];
+            text += std::string(int_type(web ? web->width : 8)) + " a" + std::to_string(i + 1);
+        }
+        return text + (count == 0 ? "void)" : ")");
+    }
+    
+    std::string declarations() const {
+        std::string text;
+        std::vector<bool> declared_slot(ir.webs.size(), false);
+        for (uint32_t w = 0; w < ir.webs.size(); ++w) {
+            const IrWeb& web = ir.webs[w];
+            if (!used_webs[w] || web.parameter >= 0 || web.name == "flags") {
+                continue;
+            }
+            text += std::string("    ") + int_type(web.width) + " " + web.name + ";\n";
+        }
+        for (const auto& slot : frame_slots) {
+            text += std::string("    ") + int_type(slot.second) + " " + stack_name(slot.first) + ";\n";
+        }
+        if (!text.empty()) {
+            text += "\n";
+        }
+        return text;
     }
 };
 
+} // namespace
+
+GeneratedCode generate_code(const IrFunction& ir, const CodeGenOptions& options) {
+    CodeGenerator generator(ir, options);
+    return generator.run();
+}
+
 } // namespace debugger 
\ No newline at end of file
@@ -1,150 +1,248 @@
 #include "decompiler.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <sstream>
 
 namespace debugger {
 
 Decompiler::Decompiler(Architecture arch) 
     : current_arch(arch), comments_enabled(true), variable_naming_style("v") {
-    initialize_register_mappings();
     initialize_reserved_keywords();
 }
 
-DecompiledFunction Decompiler::decompile_function(const Function& function) {
+DecompiledFunction Decompiler::decompile_function(const Function& function, const DisassemblyBuffer& instructions) const {
+    PERF_SCOPE("Decompiler::decompile_function", "decompiler");
     DecompiledFunction result;
-    result.name = function.name;
-    result.return_type = "int"; // Default
+    result.name = sanitize_variable_name(function.name);
+    result.return_type = "void";
     result.start_address = function.start_address;
     result.end_address = function.end_address;
     
-    // Basic implementation - convert each instruction to pseudo-C
-    std::ostringstream code;
-    code << result.return_type << " " << result.name << "() {\n";
-    
-    for (const auto& insn : function.instructions) {
-        code << "    // " << insn.mnemonic << " " << insn.operands << "\n";
-        std::string c_line = decompile_single_instruction(insn);
-        if (!c_line.empty()) {
-            code << "    " << c_line << ";\n";
-        }
+    IrFunction ir;
+    if (!lift_function(function, instructions, current_arch, ir)) {
+        result.full_code = get_caller_comment(function.start_address) + "void " + result.name + "(void);\n";
+        result.tokens = tokenize(result.full_code, {});
+        return result;
     }
+    build_ssa(ir);
+    propagate_constants(ir);
+    eliminate_dead_code(ir);
+    assign_names(ir, variable_naming_style);
     
-    code << "}\n";
-    result.full_code = code.str();
+    CodeGenOptions options;
+    options.name = result.name;
+    options.function_name = [this](uint64_t address) { return get_function_name(address); };
+    GeneratedCode code = generate_code(ir, options);
     
-    return result;
-}
-
-std::string Decompiler::decompile_instruction_block(const std::vector<Instruction>& instructions) {
-    std::ostringstream result;
-    for (const auto& insn : instructions) {
-        std::string line = decompile_single_instruction(insn);
-        if (!line.empty()) {
-            result << line << ";\n";
+    result.return_type = code.return_type;
+    result.control_flows = std::move(code.control_flows);
+    for (const IrWeb& web : ir.webs) {
+        if (web.name == "flags") {
+            continue;
         }
+        Variable variable;
+        variable.name = web.name;
+        variable.type = type_of_width(web.width);
+        variable.address = 0;
+        variable.size = web.width;
+        variable.is_parameter = web.parameter >= 0;
+        variable.is_local = !variable.is_parameter;
+        if (web.stack) {
+            variable.comment = "stack";
+        }
+        (variable.is_parameter ? result.parameters : result.local_variables).push_back(std::move(variable));
     }
-    return result.str();
-}
-
-std::string Decompiler::decompile_single_instruction(const Instruction& instruction) {
-    const std::string& mnemonic = instruction.mnemonic;
-    const std::string& operands = instruction.operands;
+    std::sort(result.parameters.begin(), result.parameters.end(),
+              [](const Variable& a, const Variable& b) { return a.name.size() != b.name.size() ? a.name.size() < b.name.size() : a.name < b.name; });
     
-    // Basic x86/x64 instruction patterns
-    if (mnemonic == "mov") {
-        return convert_mov_instruction(operands);
-    } else if (mnemonic == "add") {
-        return convert_arithmetic_instruction("+=", operands);
-    } else if (mnemonic == "sub") {
-        return convert_arithmetic_instruction("-=", operands);
-    } else if (mnemonic == "call") {
-        return convert_call_instruction(operands);
-    } else if (mnemonic == "ret") {
-        return "return";
-    } else if (mnemonic == "push") {
-        return "/* push " + operands + " */";
-    } else if (mnemonic == "pop") {
-        return "/* pop " + operands + " */";
+    result.full_code = get_caller_comment(function.start_address) + code.signature + "\n" + code.body;
+    std::unordered_set<std::string> variables;
+    for (const IrWeb& web : ir.webs) {
+        variables.insert(web.name);
     }
-    
-    // Default: comment out unknown instructions
-    return "/* " + mnemonic + " " + operands + " */";
+    result.tokens = tokenize(result.full_code, variables);
+    return result;
 }
 
-std::string Decompiler::convert_mov_instruction(const std::string& operands) {
-    // Parse "dest, src" format
-    size_t comma_pos = operands.find(',');
-    if (comma_pos == std::string::npos) return "";
-    
-    std::string dest = operands.substr(0, comma_pos);
-    std::string src = operands.substr(comma_pos + 1);
-    
-    // Trim whitespace
-    dest.erase(0, dest.find_first_not_of(" \t"));
-    dest.erase(dest.find_last_not_of(" \t") + 1);
-    src.erase(0, src.find_first_not_of(" \t"));
-    src.erase(src.find_last_not_of(" \t") + 1);
-    
-    return convert_operand_to_c(dest) + " = " + convert_operand_to_c(src);
+DecompiledFunction Decompiler::decompile_function(const Function& function) const {
+    // Blocks index the buffer the function was found in, which this
+    // overload doesn't have; leaders are recomputed instead
+    DisassemblyBuffer instructions;
+    instructions.reserve(function.instructions.size());
+    for (const auto& insn : function.instructions) {
+        instructions.append(insn);
+    }
+    Function copy;
+    copy.start_address = function.start_address;
+    copy.end_address = function.end_address;
+    copy.name = function.name;
+    copy.first_instruction = 0;
+    copy.instruction_count = instructions.size();
+    return decompile_function(copy, instructions);
 }
 
-std::string Decompiler::convert_arithmetic_instruction(const std::string& op, const std::string& operands) {
-    size_t comma_pos = operands.find(',');
-    if (comma_pos == std::string::npos) return "";
+uint64_t Decompiler::hash_function(const Function& function, const DisassemblyBuffer& instructions) const {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+    };
+    auto mix_string = [&mix](const std::string& text) {
+        mix(text.data(), text.size());
+        mix("", 1);
+    };
     
-    std::string dest = operands.substr(0, comma_pos);
-    std::string src = operands.substr(comma_pos + 1);
+    uint8_t arch = static_cast<uint8_t>(current_arch);
+    mix(&arch, 1);
+    mix(&comments_enabled, 1);
+    mix_string(variable_naming_style);
+    mix(&function.start_address, sizeof(function.start_address));
+    mix(&function.end_address, sizeof(function.end_address));
+    mix_string(function.name);
     
-    dest.erase(0, dest.find_first_not_of(" \t"));
-    dest.erase(dest.find_last_not_of(" \t") + 1);
-    src.erase(0, src.find_first_not_of(" \t"));
-    src.erase(src.find_last_not_of(" \t") + 1);
+    auto mix_range = [&](size_t first, size_t count) {
+        size_t last = std::min(first + count, instructions.size());
+        for (size_t i = first; i < last; ++i) {
+            const PackedInstruction& insn = instructions[i];
+            mix(&insn.address, sizeof(insn.address));
+            mix(insn.bytes, insn.size);
+            if (insn.has_target() && (insn.is_call() || insn.target_address < function.start_address ||
+                                      insn.target_address >= function.end_address)) {
+                mix_string(get_function_name(insn.target_address));
+            }
+        }
+    };
+    if (function.blocks.empty()) {
+        mix_range(function.first_instruction, function.instruction_count);
+    } else {
+        for (const auto& block : function.blocks) {
+            mix_range(block.first_instruction, block.instruction_count);
+        }
+    }
     
-    return convert_operand_to_c(dest) + " " + op + " " + convert_operand_to_c(src);
+    if (comments_enabled && xref_index) {
+        for (uint64_t caller : xref_index->get_callers(function.start_address)) {
+            mix(&caller, sizeof(caller));
+        }
+    }
+    return hash;
 }
 
-std::string Decompiler::convert_call_instruction(const std::string& operands) {
-    std::string target = operands;
-    target.erase(0, target.find_first_not_of(" \t"));
-    target.erase(target.find_last_not_of(" \t") + 1);
-    
-    return convert_operand_to_c(target) + "()";
+std::string Decompiler::get_function_name(uint64_t address) const {
+    if (functions) {
+        auto it = std::lower_bound(functions->begin(), functions->end(), address,
+                                   [](const Function& function, uint64_t value) { return function.start_address < value; });
+        if (it != functions->end() && it->start_address == address && !it->name.empty()) {
+            // puts@plt, memcpy@GLIBC_2.14 -> the plain name
+            size_t version = it->name.find('@');
+            return sanitize_variable_name(version == 0 || version == std::string::npos ? it->name : it->name.substr(0, version));
+        }
+    }
+    std::ostringstream name;
+    name << "sub_" << std::hex << address;
+    return name.str();
 }
 
-std::string Decompiler::convert_operand_to_c(const std::string& operand) {
-    // Handle immediate values
-    if (operand.find("0x") == 0) {
-        return operand; // Keep hex literals as-is
+std::string Decompiler::get_caller_comment(uint64_t address) const {
+    if (!comments_enabled || !xref_index) {
+        return "";
     }
-    
-    // Handle memory references [reg+offset]
-    if (operand.find('[') != std::string::npos) {
-        return "*(" + get_register_name(operand) + ")";
+    std::vector<uint64_t> callers = xref_index->get_callers(address);
+    if (callers.empty()) {
+        return "";
     }
-    
-    // Handle registers
-    return get_register_name(operand);
+    std::ostringstream code;
+    code << "// Called from " << callers.size() << " site(s):";
+    for (size_t i = 0; i < callers.size() && i < 8; ++i) {
+        code << " 0x" << std::hex << callers[i] << std::dec;
+    }
+    code << (callers.size() > 8 ? " ...\n" : "\n");
+    return code.str();
 }
 
-std::string Decompiler::get_register_name(const std::string& reg) {
-    // Basic register mapping
-    if (reg == "rax" || reg == "eax") return "var_a";
-    if (reg == "rbx" || reg == "ebx") return "var_b";
-    if (reg == "rcx" || reg == "ecx") return "var_c";
-    if (reg == "rdx" || reg == "edx") return "var_d";
-    if (reg == "rsi" || reg == "esi") return "var_si";
-    if (reg == "rdi" || reg == "edi") return "var_di";
-    if (reg == "rbp" || reg == "ebp") return "frame_ptr";
-    if (reg == "rsp" || reg == "esp") return "stack_ptr";
+// The generator's output is a small, regular subset of C, so one forward
+// pass classifies it; identifiers are told apart by what the decompiler
+// named them rather than by their spelling
+std::vector<CodeToken> Decompiler::tokenize(const std::string& code, const std::unordered_set<std::string>& variables) const {
+    static const std::unordered_set<std::string> types = {
+        "void", "char", "int", "int8_t", "int16_t", "int32_t", "int64_t",
+        "uint8_t", "uint16_t", "uint32_t", "uint64_t"
+    };
+    auto is_word = [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    };
+    auto add = [](std::vector<CodeToken>& tokens, size_t offset, size_t length, CodeToken::Kind kind) {
+        tokens.push_back({static_cast<uint32_t>(offset), static_cast<uint32_t>(length), kind});
+    };
     
-    return "var_" + reg;
+    std::vector<CodeToken> tokens;
+    tokens.reserve(code.size() / 4);
+    bool after_goto = false;
+    size_t i = 0;
+    while (i < code.size()) {
+        char c = code[i];
+        size_t start = i;
+        if (c == '/' && i + 1 < code.size() && code[i + 1] == '/') {
+            i = std::min(code.find('\n', i), code.size());
+            add(tokens, start, i - start, CodeToken::COMMENT);
+        } else if (c == '"') {
+            for (++i; i < code.size() && code[i] != '"' && code[i] != '\n'; ++i) {
+                if (code[i] == '\\' && i + 1 < code.size()) {
+                    ++i;
+                }
+            }
+            i = std::min(i + 1, code.size());
+            add(tokens, start, i - start, CodeToken::STRING);
+        } else if (c >= '0' && c <= '9') {
+            while (i < code.size() && is_word(code[i])) {
+                ++i;
+            }
+            add(tokens, start, i - start, CodeToken::NUMBER);
+        } else if (is_word(c)) {
+            while (i < code.size() && is_word(code[i])) {
+                ++i;
+            }
+            std::string word = code.substr(start, i - start);
+            size_t next = i;
+            while (next < code.size() && code[next] == ' ') {
+                ++next;
+            }
+            char follower = next < code.size() ? code[next] : '\0';
+            bool was_goto = after_goto;
+            after_goto = word == "goto";
+            if (types.count(word)) {
+                add(tokens, start, i - start, CodeToken::TYPE);
+            } else if (reserved_keywords.count(word) || word == "do" || word == "goto") {
+                add(tokens, start, i - start, CodeToken::KEYWORD);
+            } else if (was_goto || (follower == ':' && (next + 1 >= code.size() || code[next + 1] == '\n'))) {
+                add(tokens, start, i - start, CodeToken::LABEL);
+            } else if (follower == '(') {
+                add(tokens, start, i - start, CodeToken::FUNCTION);
+            } else if (variables.count(word) || word.compare(0, 6, "local_") == 0 || word.compare(0, 4, "arg_") == 0) {
+                add(tokens, start, i - start, CodeToken::VARIABLE);
+            }
+        } else {
+            ++i;
+        }
+    }
+    return tokens;
 }
 
-void Decompiler::initialize_register_mappings() {
-    // Initialize x86/x64 register mappings
-    register_mappings[0] = "var_a";  // RAX/EAX
-    register_mappings[1] = "var_c";  // RCX/ECX
-    register_mappings[2] = "var_d";  // RDX/EDX
-    register_mappings[3] = "var_b";  // RBX/EBX
+VariableType Decompiler::type_of_width(uint8_t width) {
+    switch (width) {
+        case 1: return VariableType::INT8;
+        case 2: return VariableType::INT16;
+        case 4: return VariableType::INT32;
+        case 8: return VariableType::INT64;
+        default: return VariableType::UNKNOWN;
+    }
 }
 
 void Decompiler::initialize_reserved_keywords() {
@@ -155,8 +253,105 @@ void Decompiler::initialize_reserved_keywords() {
     };
 }
 
+std::vector<BasicBlock> Decompiler::analyze_basic_blocks(const Function& function) {
+    std::vector<BasicBlock> blocks;
+    const auto& instructions = function.instructions;
+    
+    if (instructions.empty()) {
+        return blocks;
+    }
+    
+    // Leaders: the first instruction, every branch target inside the
+    // function and every instruction following a branch or return
+    std::map<uint64_t, size_t> index_of;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        index_of[instructions[i].address] = i;
+    }
+    
+    std::vector<bool> is_leader(instructions.size(), false);
+    is_leader[0] = true;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        const auto& insn = instructions[i];
+        if (insn.is_jump || insn.is_return) {
+            if (i + 1 < instructions.size()) {
+                is_leader[i + 1] = true;
+            }
+            auto target = index_of.find(insn.target_address);
+            if (insn.is_jump && target != index_of.end()) {
+                is_leader[target->second] = true;
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        if (is_leader[i]) {
+            BasicBlock block;
+            block.start_address = instructions[i].address;
+            blocks.push_back(block);
+        }
+        blocks.back().instructions.push_back(instructions[i]);
+    }
+    
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        BasicBlock& block = blocks[b];
+        const Instruction& tail = block.instructions.back();
+        block.end_address = tail.address + tail.size;
+        
+        if (tail.is_jump && index_of.count(tail.target_address)) {
+            block.successors.push_back(tail.target_address);
+        }
+        bool unconditional = tail.mnemonic == "jmp" || tail.mnemonic == "b" || tail.mnemonic == "br";
+        if (!tail.is_return && !unconditional && b + 1 < blocks.size()) {
+            block.successors.push_back(blocks[b + 1].start_address);
+        }
+    }
+    
+    link_predecessors(blocks);
+    return blocks;
+}
+
+std::vector<BasicBlock> Decompiler::analyze_basic_blocks(const Function& function, const DisassemblyBuffer& instructions) {
+    if (function.blocks.empty()) {
+        return analyze_basic_blocks(function);
+    }
+    
+    // Recursive-descent analysis already found the blocks; materialize them
+    std::vector<BasicBlock> blocks;
+    blocks.reserve(function.blocks.size());
+    for (const auto& range : function.blocks) {
+        BasicBlock block;
+        block.start_address = range.start_address;
+        block.end_address = range.end_address;
+        block.successors = range.successors;
+        size_t last = std::min(range.first_instruction + range.instruction_count, instructions.size());
+        for (size_t i = range.first_instruction; i < last; ++i) {
+            block.instructions.push_back(instructions.to_instruction(i));
+        }
+        blocks.push_back(std::move(block));
+    }
+    
+    link_predecessors(blocks);
+    return blocks;
+}
+
+void Decompiler::link_predecessors(std::vector<BasicBlock>& blocks) {
+    std::map<uint64_t, BasicBlock*> by_start;
+    for (auto& block : blocks) {
+        block.predecessors.clear();
+        by_start[block.start_address] = &block;
+    }
+    
+    for (const auto& block : blocks) {
+        for (uint64_t successor : block.successors) {
+            auto it = by_start.find(successor);
+            if (it != by_start.end()) {
+                it->second->predecessors.push_back(block.start_address);
+            }
+        }
+    }
+}
+
 // Stub implementations for remaining methods
-std::vector<BasicBlock> Decompiler::analyze_basic_blocks(const Function&) { return {}; }
 std::vector<ControlFlow> Decompiler::analyze_control_flow(const std::vector<BasicBlock>&) { return {}; }
 std::vector<Variable> Decompiler::analyze_variables(const Function&) { return {}; }
 VariableType Decompiler::infer_variable_type(const std::string&, const std::vector<Instruction>&) { return VariableType::UNKNOWN; }
@@ -170,17 +365,126 @@ std::string Decompiler::generate_control_flow_code(const ControlFlow&) { return
 void Decompiler::set_architecture(Architecture arch) { current_arch = arch; }
 void Decompiler::enable_comments(bool enable) { comments_enabled = enable; }
 void Decompiler::set_variable_naming_style(const std::string& style) { variable_naming_style = style; }
-std::string Decompiler::sanitize_variable_name(const std::string& name) { return name; }
-std::string Decompiler::generate_unique_variable_name(const std::string& base) { return base + "_1"; }
-bool Decompiler::is_arithmetic_instruction(const std::string& mnemonic) { 
-    return mnemonic == "add" || mnemonic == "sub" || mnemonic == "mul" || mnemonic == "div"; 
+void Decompiler::set_xref_index(std::shared_ptr<const XrefIndex> index) { xref_index = std::move(index); }
+void Decompiler::set_functions(std::shared_ptr<const std::vector<Function>> list) { functions = std::move(list); }
+
+// Symbol names such as "operator new" or "foo@plt" as C identifiers
+std::string Decompiler::sanitize_variable_name(const std::string& name) const {
+    std::string result;
+    result.reserve(name.size() + 1);
+    for (char c : name) {
+        bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        result += valid ? c : '_';
+    }
+    if (result.empty() || (result[0] >= '0' && result[0] <= '9')) {
+        result.insert(result.begin(), '_');
+    }
+    if (reserved_keywords.count(result)) {
+        result += '_';
+    }
+    return result;
+}
+
+DecompilationCache::DecompilationCache(size_t capacity)
+    : capacity(std::max<size_t>(capacity, 2)) {
 }
-bool Decompiler::is_comparison_instruction(const std::string& mnemonic) { 
-    return mnemonic == "cmp" || mnemonic == "test"; 
+
+DecompilationCache::Entry DecompilationCache::find(uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = current.find(hash);
+    if (it != current.end()) {
+        return it->second;
+    }
+    auto old = previous.find(hash);
+    if (old == previous.end()) {
+        return nullptr;
+    }
+    Entry function = old->second;
+    previous.erase(old);
+    insert_locked(hash, function);
+    return function;
 }
-bool Decompiler::is_memory_access(const std::string& mnemonic) { 
-    return mnemonic == "mov" || mnemonic == "lea"; 
+
+void DecompilationCache::insert(uint64_t hash, Entry function) {
+    std::lock_guard<std::mutex> lock(mutex);
+    insert_locked(hash, std::move(function));
 }
-std::string Decompiler::convert_condition_to_c(const std::string& condition) { return condition; }
 
+void DecompilationCache::insert_locked(uint64_t hash, Entry function) {
+    if (current.size() >= capacity / 2 && !current.count(hash)) {
+        previous = std::move(current);
+        current.clear();
+    }
+    current[hash] = std::move(function);
+}
+
+DecompilationCache::Entry DecompilationCache::get(const Decompiler& decompiler, const Function& function,
+                                                  const DisassemblyBuffer& instructions) {
+    uint64_t hash = decompiler.hash_function(function, instructions);
+    Entry cached = find(hash);
+    if (cached) {
+        return cached;
+    }
+    // Not under the lock: two threads may race on one function, harmlessly
+    Entry decompiled = std::make_shared<const DecompiledFunction>(decompiler.decompile_function(function, instructions));
+    insert(hash, decompiled);
+    return decompiled;
+}
+
+bool DecompilationCache::decompile_all(const Decompiler& decompiler, const std::vector<Function>& functions,
+                                       const DisassemblyBuffer& instructions, ThreadPool& pool,
+                                       const ProgressCallback& progress) {
+    const size_t total = functions.size();
+    if (total == 0) {
+        return true;
+    }
+    
+    // Room for every function next to what is already cached, or a large
+    // binary would rotate its own early results out before the run ends
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = std::max(capacity, 2 * (current.size() + previous.size() + total));
+    }
+    
+    // Several chunks per worker so one huge function doesn't leave the
+    // others idle at the end
+    size_t chunk = std::max<size_t>(1, total / (pool.get_thread_count() * 8));
+    std::atomic<size_t> done{0};
+    std::atomic<bool> stop{false};
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(total / chunk + 1);
+    for (size_t first = 0; first < total; first += chunk) {
+        size_t last = std::min(first + chunk, total);
+        tasks.push_back(pool.submit([&, first, last]() {
+            for (size_t i = first; i < last && !stop.load(std::memory_order_relaxed); ++i) {
+                get(decompiler, functions[i], instructions);
+                done.fetch_add(1, std::memory_order_relaxed);
+            }
+        }));
+    }
+    
+    for (auto& task : tasks) {
+        while (task.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+            if (progress && !stop && !progress(done.load(std::memory_order_relaxed), total)) {
+                stop = true;
+            }
+        }
+        task.get();
+    }
+    if (progress && !stop && !progress(total, total)) {
+        stop = true;
+    }
+    return !stop;
+}
+
+size_t DecompilationCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current.size() + previous.size();
+}
+
+void DecompilationCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    current.clear();
+    previous.clear();
+}
 } // namespace debugger 
\ No newline at end of file
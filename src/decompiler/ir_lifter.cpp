@@ -0,0 +1,1351 @@
+#include "decompiler_ir.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+namespace debugger {
+
+IrValue IrValue::make_var(uint32_t var, uint8_t width) {
+    IrValue value;
+    value.kind = VAR;
+    value.var = var;
+    value.width = width;
+    return value;
+}
+
+IrValue IrValue::make_const(uint64_t constant, uint8_t width) {
+    IrValue value;
+    value.kind = CONST;
+    value.constant = constant;
+    value.width = width;
+    return value;
+}
+
+IrValue IrValue::make_frame(int64_t offset) {
+    IrValue value;
+    value.kind = FRAME;
+    value.constant = static_cast<uint64_t>(offset);
+    value.width = 8;
+    return value;
+}
+
+IrValue IrValue::make_tls(uint64_t offset) {
+    IrValue value;
+    value.kind = TLS;
+    value.constant = offset;
+    value.width = 8;
+    return value;
+}
+
+IrCondition negate_condition(IrCondition condition) {
+    switch (condition) {
+        case IrCondition::EQ: return IrCondition::NE;
+        case IrCondition::NE: return IrCondition::EQ;
+        case IrCondition::LT: return IrCondition::GE;
+        case IrCondition::GE: return IrCondition::LT;
+        case IrCondition::LE: return IrCondition::GT;
+        case IrCondition::GT: return IrCondition::LE;
+        case IrCondition::BELOW: return IrCondition::ABOVE_EQ;
+        case IrCondition::ABOVE_EQ: return IrCondition::BELOW;
+        case IrCondition::BELOW_EQ: return IrCondition::ABOVE;
+        case IrCondition::ABOVE: return IrCondition::BELOW_EQ;
+        case IrCondition::SIGN: return IrCondition::NOT_SIGN;
+        case IrCondition::NOT_SIGN: return IrCondition::SIGN;
+        case IrCondition::OVERFLOW: return IrCondition::NOT_OVERFLOW;
+        case IrCondition::NOT_OVERFLOW: return IrCondition::OVERFLOW;
+        case IrCondition::PARITY: return IrCondition::NOT_PARITY;
+        case IrCondition::NOT_PARITY: return IrCondition::PARITY;
+        case IrCondition::NONE: break;
+    }
+    return IrCondition::NONE;
+}
+
+namespace {
+
+// Locations 0-15 are the general registers in encoding order, 16 the flags
+constexpr uint32_t kFlags = 16;
+constexpr uint8_t kRax = 0;
+constexpr uint8_t kRcx = 1;
+constexpr uint8_t kRdx = 2;
+constexpr uint8_t kRsp = 4;
+constexpr uint8_t kRbp = 5;
+constexpr uint8_t kRegisterCount = 16;
+
+const char* const kRegisterNames64[kRegisterCount] = {
+    "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+    "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+};
+const char* const kRegisterNames32[8] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
+const char* const kRegisterNames16[8] = {"ax", "cx", "dx", "bx", "sp", "bp", "si", "di"};
+const char* const kRegisterNames8[8] = {"al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil"};
+
+// System V: rdi, rsi, rdx, rcx, r8, r9
+const uint8_t kArgumentRegisters[6] = {7, 6, 2, 1, 8, 9};
+// Clobbered by a call besides rax, which carries the result
+const uint8_t kCallerSaved[] = {1, 2, 6, 7, 8, 9, 10, 11};
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool starts_with(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool parse_number(std::string_view text, int64_t& value) {
+    bool negative = false;
+    if (!text.empty() && text.front() == '-') {
+        negative = true;
+        text.remove_prefix(1);
+    }
+    if (text.empty()) {
+        return false;
+    }
+    
+    uint64_t result = 0;
+    if (starts_with(text, "0x")) {
+        text.remove_prefix(2);
+        if (text.empty()) {
+            return false;
+        }
+        for (char c : text) {
+            int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+            else return false;
+            result = result * 16 + static_cast<uint64_t>(digit);
+        }
+    } else {
+        for (char c : text) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            result = result * 10 + static_cast<uint64_t>(c - '0');
+        }
+    }
+    value = negative ? -static_cast<int64_t>(result) : static_cast<int64_t>(result);
+    return true;
+}
+
+// High-byte registers (ah, bh...) are left out and make an instruction ASM
+bool parse_register(std::string_view text, uint8_t& location, uint8_t& width) {
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (text == kRegisterNames64[i]) { location = i; width = 8; return true; }
+        if (text == kRegisterNames32[i]) { location = i; width = 4; return true; }
+        if (text == kRegisterNames16[i]) { location = i; width = 2; return true; }
+        if (text == kRegisterNames8[i]) { location = i; width = 1; return true; }
+    }
+    
+    // r8-r15 with their d/w/b forms
+    if (text.size() < 2 || text[0] != 'r' || text[1] < '0' || text[1] > '9') {
+        return false;
+    }
+    size_t digits = 1;
+    while (1 + digits < text.size() && text[1 + digits] >= '0' && text[1 + digits] <= '9') {
+        ++digits;
+    }
+    int64_t number = 0;
+    if (!parse_number(text.substr(1, digits), number) || number < 8 || number > 15) {
+        return false;
+    }
+    std::string_view suffix = text.substr(1 + digits);
+    location = static_cast<uint8_t>(number);
+    if (suffix.empty()) width = 8;
+    else if (suffix == "d") width = 4;
+    else if (suffix == "w") width = 2;
+    else if (suffix == "b") width = 1;
+    else return false;
+    return true;
+}
+
+uint8_t parse_size(std::string_view word) {
+    if (word == "byte") return 1;
+    if (word == "word") return 2;
+    if (word == "dword") return 4;
+    if (word == "qword") return 8;
+    if (word == "tbyte") return 10;
+    if (word == "xmmword") return 16;
+    if (word == "ymmword") return 32;
+    return 0;
+}
+
+struct Operand {
+    enum Kind : uint8_t { NONE, REGISTER, IMMEDIATE, MEMORY, OTHER };
+    
+    Kind kind = NONE;
+    uint8_t width = 0;
+    uint8_t reg = 0;    // REGISTER
+    int base = -1;      // MEMORY
+    int index = -1;
+    uint8_t scale = 1;
+    bool rip = false;
+    bool tls = false;
+    int64_t value = 0;  // immediate, or the displacement
+};
+
+Operand parse_memory(std::string_view text) {
+    Operand operand;
+    operand.kind = Operand::OTHER;
+    
+    size_t open = text.find('[');
+    size_t close = text.rfind(']');
+    if (open == std::string_view::npos || close == std::string_view::npos || close < open) {
+        return operand;
+    }
+    std::string_view prefix = trim(text.substr(0, open));
+    if (prefix.size() >= 3 && prefix[prefix.size() - 1] == ':') {
+        std::string_view segment = prefix.substr(prefix.size() - 3, 2);
+        operand.tls = segment == "fs" || segment == "gs";
+        prefix = trim(prefix.substr(0, prefix.size() - 3));
+    }
+    size_t space = prefix.find(' ');
+    if (space != std::string_view::npos) {
+        operand.width = parse_size(prefix.substr(0, space));
+    }
+    
+    // Terms joined by + and -: base, index*scale and one displacement
+    std::string_view inner = text.substr(open + 1, close - open - 1);
+    bool negative = false;
+    while (!(inner = trim(inner)).empty()) {
+        size_t end = inner.find(' ');
+        std::string_view term = inner.substr(0, end);
+        inner = end == std::string_view::npos ? std::string_view() : inner.substr(end);
+        
+        if (term == "+" || term == "-") {
+            negative = term == "-";
+            continue;
+        }
+        
+        uint8_t location = 0;
+        uint8_t width = 0;
+        int64_t number = 0;
+        size_t star = term.find('*');
+        if (star != std::string_view::npos) {
+            if (!parse_register(term.substr(0, star), location, width) ||
+                !parse_number(term.substr(star + 1), number)) {
+                return operand;
+            }
+            operand.index = location;
+            operand.scale = static_cast<uint8_t>(number);
+        } else if (term == "rip" || term == "eip") {
+            operand.rip = true;
+        } else if (parse_register(term, location, width)) {
+            if (operand.base < 0) {
+                operand.base = location;
+            } else {
+                operand.index = location;
+            }
+        } else if (parse_number(term, number)) {
+            operand.value += negative ? -number : number;
+        } else {
+            return operand;
+        }
+        negative = false;
+    }
+    
+    operand.kind = Operand::MEMORY;
+    return operand;
+}
+
+Operand parse_operand(std::string_view text) {
+    text = trim(text);
+    Operand operand;
+    if (text.empty()) {
+        return operand;
+    }
+    if (text.find('[') != std::string_view::npos) {
+        return parse_memory(text);
+    }
+    if (parse_register(text, operand.reg, operand.width)) {
+        operand.kind = Operand::REGISTER;
+        return operand;
+    }
+    if (parse_number(text, operand.value)) {
+        operand.kind = Operand::IMMEDIATE;
+        return operand;
+    }
+    operand.kind = Operand::OTHER;
+    return operand;
+}
+
+size_t split_operands(std::string_view text, Operand* operands, size_t max_operands) {
+    size_t count = 0;
+    while (!trim(text).empty() && count < max_operands) {
+        size_t comma = text.find(',');
+        operands[count++] = parse_operand(text.substr(0, comma));
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        text.remove_prefix(comma + 1);
+    }
+    return count;
+}
+
+IrCondition parse_condition(std::string_view code) {
+    if (code == "e" || code == "z") return IrCondition::EQ;
+    if (code == "ne" || code == "nz") return IrCondition::NE;
+    if (code == "l" || code == "nge") return IrCondition::LT;
+    if (code == "le" || code == "ng") return IrCondition::LE;
+    if (code == "g" || code == "nle") return IrCondition::GT;
+    if (code == "ge" || code == "nl") return IrCondition::GE;
+    if (code == "b" || code == "c" || code == "nae") return IrCondition::BELOW;
+    if (code == "be" || code == "na") return IrCondition::BELOW_EQ;
+    if (code == "a" || code == "nbe") return IrCondition::ABOVE;
+    if (code == "ae" || code == "nb" || code == "nc") return IrCondition::ABOVE_EQ;
+    if (code == "s") return IrCondition::SIGN;
+    if (code == "ns") return IrCondition::NOT_SIGN;
+    if (code == "o") return IrCondition::OVERFLOW;
+    if (code == "no") return IrCondition::NOT_OVERFLOW;
+    if (code == "p" || code == "pe") return IrCondition::PARITY;
+    if (code == "np" || code == "po") return IrCondition::NOT_PARITY;
+    return IrCondition::NONE;
+}
+
+bool is_unconditional_jump(std::string_view mnemonic) {
+    return mnemonic == "jmp" || mnemonic == "ljmp" || mnemonic == "b" || mnemonic == "br" || mnemonic == "bx";
+}
+
+// Blocks by leaders for functions found without recursive descent
+std::vector<FunctionBlock> split_blocks(const Function& function, const DisassemblyBuffer& instructions) {
+    std::vector<FunctionBlock> blocks;
+    size_t first = function.first_instruction;
+    size_t last = std::min(first + function.instruction_count, instructions.size());
+    if (first >= last) {
+        return blocks;
+    }
+    
+    std::vector<bool> leader(last - first, false);
+    leader[0] = true;
+    for (size_t i = first; i < last; ++i) {
+        const PackedInstruction& insn = instructions[i];
+        if (!insn.is_jump() && !insn.is_return()) {
+            continue;
+        }
+        if (i + 1 < last) {
+            leader[i + 1 - first] = true;
+        }
+        if (insn.is_jump() && insn.has_target()) {
+            size_t target = instructions.find_index(insn.target_address);
+            if (target != DisassemblyBuffer::npos && target >= first && target < last) {
+                leader[target - first] = true;
+            }
+        }
+    }
+    
+    for (size_t i = first; i < last; ++i) {
+        if (leader[i - first]) {
+            FunctionBlock block;
+            block.start_address = instructions[i].address;
+            block.end_address = block.start_address;
+            block.first_instruction = i;
+            block.instruction_count = 0;
+            blocks.push_back(block);
+        }
+        FunctionBlock& block = blocks.back();
+        ++block.instruction_count;
+        block.end_address = instructions[i].address + instructions[i].size;
+    }
+    
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        FunctionBlock& block = blocks[b];
+        const PackedInstruction& tail = instructions[block.first_instruction + block.instruction_count - 1];
+        if (tail.is_jump() && tail.has_target()) {
+            size_t target = instructions.find_index(tail.target_address);
+            if (target != DisassemblyBuffer::npos && target >= first && target < last) {
+                block.successors.push_back(tail.target_address);
+            }
+        }
+        if (!tail.is_return() && !is_unconditional_jump(instructions.get_mnemonic(tail)) && b + 1 < blocks.size()) {
+            block.successors.push_back(blocks[b + 1].start_address);
+        }
+    }
+    return blocks;
+}
+
+// Stack pointer (and frame pointer, once set up) relative to the stack
+// pointer on entry, where the return address lives
+struct FrameState {
+    int64_t sp = 0;
+    int64_t bp = 0;
+    bool bp_valid = false;
+};
+
+class X86Lifter {
+public:
+    X86Lifter(IrFunction& ir, const DisassemblyBuffer& instructions, bool wide,
+              const std::unordered_map<uint64_t, uint32_t>& block_index)
+        : ir(ir), instructions(instructions), wide(wide), word(wide ? 8 : 4)
+        , block_index(block_index), frame_pointer(false), promote_stack(true), defined_since_call(0)
+    {
+        for (uint8_t i = 0; i < kRegisterCount; ++i) {
+            IrLocation location;
+            location.kind = IrLocation::REGISTER;
+            location.width = word;
+            location.parameter = -1;
+            location.frame_offset = 0;
+            location.name = wide || i >= 8 ? kRegisterNames64[i] : kRegisterNames32[i];
+            ir.locations.push_back(location);
+        }
+        if (wide) {
+            for (int8_t i = 0; i < 6; ++i) {
+                ir.locations[kArgumentRegisters[i]].parameter = i;
+            }
+        }
+        IrLocation flags;
+        flags.kind = IrLocation::FLAGS;
+        flags.width = 1;
+        flags.parameter = -1;
+        flags.frame_offset = 0;
+        flags.name = "flags";
+        ir.locations.push_back(flags);
+        ir.return_location = kRax;
+    }
+    
+    // rbp is a frame pointer only in functions that set it up; stack slots
+    // become variables unless the function takes the address of its frame
+    void scan(const std::vector<FunctionBlock>& blocks) {
+        for (const FunctionBlock& range : blocks) {
+            for (size_t i = range.first_instruction; i < range.first_instruction + range.instruction_count; ++i) {
+                std::string_view mnemonic = instructions.get_mnemonic(instructions[i]);
+                Operand operands[3];
+                size_t count = split_operands(instructions.get_operands(instructions[i]), operands, 3);
+                if (mnemonic == "mov" && count == 2 && operands[0].kind == Operand::REGISTER &&
+                    operands[0].reg == kRbp && operands[1].kind == Operand::REGISTER && operands[1].reg == kRsp) {
+                    frame_pointer = true;
+                }
+            }
+        }
+        for (const FunctionBlock& range : blocks) {
+            for (size_t i = range.first_instruction; i < range.first_instruction + range.instruction_count; ++i) {
+                std::string_view mnemonic = instructions.get_mnemonic(instructions[i]);
+                Operand operands[3];
+                size_t count = split_operands(instructions.get_operands(instructions[i]), operands, 3);
+                if (is_frame_bookkeeping(mnemonic, operands, count)) {
+                    continue;
+                }
+                for (size_t j = 0; j < count; ++j) {
+                    bool frame_register = operands[j].kind == Operand::REGISTER && is_frame_register(operands[j].reg);
+                    bool frame_address = mnemonic == "lea" && operands[j].kind == Operand::MEMORY &&
+                                         operands[j].base >= 0 && is_frame_register(static_cast<uint8_t>(operands[j].base));
+                    bool indexed_frame = operands[j].kind == Operand::MEMORY && operands[j].index >= 0 &&
+                                         operands[j].base >= 0 && is_frame_register(static_cast<uint8_t>(operands[j].base));
+                    if (frame_register || frame_address || indexed_frame) {
+                        promote_stack = false;
+                    }
+                }
+            }
+        }
+    }
+    
+    void lift_block(const FunctionBlock& range, uint32_t block, FrameState& frame) {
+        current = block;
+        defined_since_call = 0;
+        state = frame;
+        size_t last = range.first_instruction + range.instruction_count;
+        for (size_t i = range.first_instruction; i < last; ++i) {
+            lift_instruction(i);
+        }
+        
+        IrBlock& out = ir.blocks[current];
+        bool terminated = !out.instructions.empty() && is_terminator(out.instructions.back().op);
+        if (!terminated) {
+            // Falls into the next block, or off the end of what was decoded
+            uint64_t next = range.end_address;
+            auto it = block_index.find(next);
+            if (it != block_index.end()) {
+                IrInstruction jump = make(IrOp::JUMP, 0);
+                jump.address = instructions[last - 1].address;
+                emit(jump);
+                out.successors.push_back(it->second);
+            }
+        }
+        frame = state;
+    }
+    
+    // Body of the block standing in for a jump out of the function
+    void lift_tail_call(uint32_t block, uint64_t target) {
+        current = block;
+        IrInstruction call = make(IrOp::CALL, word);
+        call.address = target;
+        call.operands[0] = IrValue::make_const(target, word);
+        call.operand_count = 1;
+        call.dest = kRax;
+        emit(call);
+        emit_return(target);
+    }
+
+private:
+    IrFunction& ir;
+    const DisassemblyBuffer& instructions;
+    bool wide;
+    uint8_t word;
+    const std::unordered_map<uint64_t, uint32_t>& block_index;
+    bool frame_pointer;
+    bool promote_stack;
+    std::unordered_map<int64_t, uint32_t> slots;  // frame offset -> location
+    
+    // Lifting state for the current block
+    uint32_t current = 0;
+    uint64_t address = 0;
+    uint64_t next_address = 0;
+    FrameState state;
+    uint32_t written = IrInstruction::NO_VAR;  // what the last write() defined
+    uint32_t defined_since_call;  // bit per register location
+    
+    static bool is_terminator(IrOp op) {
+        return op == IrOp::BRANCH || op == IrOp::JUMP || op == IrOp::INDIRECT_JUMP || op == IrOp::RETURN;
+    }
+    
+    bool is_frame_register(uint8_t reg) const {
+        return reg == kRsp || (reg == kRbp && frame_pointer);
+    }
+    
+    bool is_frame_bookkeeping(std::string_view mnemonic, const Operand* operands, size_t count) const {
+        if (mnemonic == "push" || mnemonic == "pop" || mnemonic == "leave" || mnemonic == "ret" ||
+            mnemonic == "call" || mnemonic == "enter") {
+            return true;
+        }
+        if (count != 2 || operands[0].kind != Operand::REGISTER || !is_frame_register(operands[0].reg)) {
+            return false;
+        }
+        if (mnemonic == "sub" || mnemonic == "add" || mnemonic == "and") {
+            return operands[1].kind == Operand::IMMEDIATE;
+        }
+        if (mnemonic == "mov") {
+            return operands[1].kind == Operand::REGISTER && is_frame_register(operands[1].reg);
+        }
+        if (mnemonic == "lea") {
+            return operands[1].kind == Operand::MEMORY && operands[1].base >= 0 && operands[1].index < 0 &&
+                   is_frame_register(static_cast<uint8_t>(operands[1].base));
+        }
+        return false;
+    }
+    
+    IrInstruction make(IrOp op, uint8_t width) const {
+        IrInstruction instruction;
+        instruction.op = op;
+        instruction.width = width;
+        instruction.address = address;
+        return instruction;
+    }
+    
+    void emit(const IrInstruction& instruction) {
+        if (instruction.dest < kRegisterCount) {
+            defined_since_call |= 1u << instruction.dest;
+        }
+        ir.blocks[current].instructions.push_back(instruction);
+    }
+    
+    uint32_t new_temporary(uint8_t width) {
+        IrLocation location;
+        location.kind = IrLocation::TEMPORARY;
+        location.width = width;
+        location.parameter = -1;
+        location.frame_offset = 0;
+        ir.locations.push_back(location);
+        return static_cast<uint32_t>(ir.locations.size() - 1);
+    }
+    
+    uint32_t stack_slot(int64_t offset, uint8_t width) {
+        auto it = slots.find(offset);
+        if (it != slots.end()) {
+            IrLocation& location = ir.locations[it->second];
+            location.width = std::max(location.width, width);
+            return it->second;
+        }
+        IrLocation location;
+        location.kind = IrLocation::STACK;
+        location.width = width;
+        location.parameter = -1;
+        location.frame_offset = offset;
+        ir.locations.push_back(location);
+        uint32_t id = static_cast<uint32_t>(ir.locations.size() - 1);
+        slots.emplace(offset, id);
+        return id;
+    }
+    
+    uint32_t emit_value(IrOp op, uint8_t width, IrValue a, IrValue b = IrValue()) {
+        IrInstruction instruction = make(op, width);
+        instruction.operands[0] = a;
+        instruction.operands[1] = b;
+        instruction.operand_count = b.kind == IrValue::NONE ? 1 : 2;
+        instruction.dest = new_temporary(width);
+        emit(instruction);
+        return instruction.dest;
+    }
+    
+    bool frame_offset_of(const Operand& operand, int64_t& offset) const {
+        if (operand.kind != Operand::MEMORY || operand.base < 0 || operand.index >= 0 || operand.tls ||
+            !is_frame_register(static_cast<uint8_t>(operand.base))) {
+            return false;
+        }
+        if (operand.base == kRbp && !state.bp_valid) {
+            return false;
+        }
+        offset = (operand.base == kRsp ? state.sp : state.bp) + operand.value;
+        return true;
+    }
+    
+    IrValue read_register(uint8_t reg, uint8_t width) {
+        if (reg == kRsp) {
+            return IrValue::make_frame(state.sp);
+        }
+        if (reg == kRbp && frame_pointer && state.bp_valid) {
+            return IrValue::make_frame(state.bp);
+        }
+        return IrValue::make_var(reg, width);
+    }
+    
+    // Address a memory operand refers to; false for forms that aren't modelled
+    bool address_of(const Operand& operand, IrValue& result) {
+        if (operand.kind != Operand::MEMORY) {
+            return false;
+        }
+        if (operand.tls) {
+            if (operand.base >= 0 || operand.index >= 0) {
+                return false;
+            }
+            result = IrValue::make_tls(static_cast<uint64_t>(operand.value));
+            return true;
+        }
+        if (operand.rip) {
+            result = IrValue::make_const(next_address + static_cast<uint64_t>(operand.value), word);
+            return true;
+        }
+        
+        int64_t offset = 0;
+        if (frame_offset_of(operand, offset)) {
+            result = IrValue::make_frame(offset);
+            return true;
+        }
+        
+        IrValue base;
+        if (operand.base >= 0) {
+            base = read_register(static_cast<uint8_t>(operand.base), word);
+        }
+        if (operand.index >= 0) {
+            IrValue index = read_register(static_cast<uint8_t>(operand.index), word);
+            if (operand.scale > 1) {
+                index = IrValue::make_var(emit_value(IrOp::MUL, word, index, IrValue::make_const(operand.scale, word)), word);
+            }
+            base = base.kind == IrValue::NONE ? index : IrValue::make_var(emit_value(IrOp::ADD, word, base, index), word);
+        }
+        if (base.kind == IrValue::NONE) {
+            result = IrValue::make_const(static_cast<uint64_t>(operand.value), word);
+            return true;
+        }
+        if (operand.value != 0) {
+            IrOp op = operand.value < 0 ? IrOp::SUB : IrOp::ADD;
+            uint64_t magnitude = static_cast<uint64_t>(operand.value < 0 ? -operand.value : operand.value);
+            base = IrValue::make_var(emit_value(op, word, base, IrValue::make_const(magnitude, word)), word);
+        }
+        result = base;
+        return true;
+    }
+    
+    bool read(const Operand& operand, uint8_t width, IrValue& result) {
+        switch (operand.kind) {
+            case Operand::REGISTER:
+                result = read_register(operand.reg, operand.width);
+                return true;
+            case Operand::IMMEDIATE:
+                result = IrValue::make_const(static_cast<uint64_t>(operand.value), width);
+                return true;
+            case Operand::MEMORY: {
+                uint8_t size = operand.width ? operand.width : width;
+                int64_t offset = 0;
+                if (promote_stack && frame_offset_of(operand, offset)) {
+                    result = IrValue::make_var(stack_slot(offset, size), size);
+                    return true;
+                }
+                IrValue address_value;
+                if (!address_of(operand, address_value)) {
+                    return false;
+                }
+                result = IrValue::make_var(emit_value(IrOp::LOAD, size, address_value), size);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+    
+    // Gives the value instruction its destination: the register, a promoted
+    // slot, or a temporary that is then stored
+    bool write(const Operand& operand, IrInstruction value) {
+        written = IrInstruction::NO_VAR;
+        if (operand.kind == Operand::REGISTER) {
+            if (is_frame_register(operand.reg)) {
+                return true;  // stack bookkeeping the lifter tracks itself
+            }
+            value.dest = operand.reg;
+            written = value.dest;
+            emit(value);
+            return true;
+        }
+        if (operand.kind != Operand::MEMORY) {
+            return false;
+        }
+        
+        int64_t offset = 0;
+        if (promote_stack && frame_offset_of(operand, offset)) {
+            value.dest = stack_slot(offset, value.width);
+            written = value.dest;
+            emit(value);
+            return true;
+        }
+        IrValue address_value;
+        if (!address_of(operand, address_value)) {
+            return false;
+        }
+        value.dest = new_temporary(value.width);
+        written = value.dest;
+        emit(value);
+        IrInstruction store = make(IrOp::STORE, value.width);
+        store.operands[0] = address_value;
+        store.operands[1] = IrValue::make_var(value.dest, value.width);
+        store.operand_count = 2;
+        emit(store);
+        return true;
+    }
+    
+    void set_flags(IrOp op, IrValue a, IrValue b, uint8_t width) {
+        IrInstruction flags = make(op, width);
+        flags.operands[0] = a;
+        flags.operands[1] = b;
+        flags.operand_count = 2;
+        flags.dest = kFlags;
+        emit(flags);
+    }
+    
+    void clobber(uint32_t location) {
+        IrInstruction undef = make(IrOp::UNDEF, ir.locations[location].width);
+        undef.dest = location;
+        emit(undef);
+    }
+    
+    void emit_return(uint64_t at) {
+        IrInstruction ret = make(IrOp::RETURN, word);
+        ret.address = at;
+        ret.operands[0] = IrValue::make_var(kRax, word);
+        ret.operand_count = 1;
+        emit(ret);
+    }
+    
+    void emit_call(IrValue target) {
+        IrInstruction call = make(IrOp::CALL, word);
+        call.operands[0] = target;
+        call.operand_count = 1;
+        
+        // Arguments: the leading argument registers set since the last call
+        call.extra_first = static_cast<uint32_t>(ir.extra_operands.size());
+        if (wide) {
+            for (uint8_t reg : kArgumentRegisters) {
+                if (!(defined_since_call & (1u << reg))) {
+                    break;
+                }
+                ir.extra_operands.push_back(IrValue::make_var(reg, word));
+                ++call.extra_count;
+            }
+        }
+        call.dest = kRax;
+        emit(call);
+        for (uint8_t reg : kCallerSaved) {
+            clobber(reg);
+        }
+        clobber(kFlags);
+        defined_since_call = 0;
+    }
+    
+    void emit_asm(std::string_view mnemonic, std::string_view operand_text, const Operand* operands, size_t count) {
+        IrInstruction instruction = make(IrOp::ASM, word);
+        instruction.text = static_cast<uint32_t>(ir.asm_text.size());
+        std::string text(mnemonic);
+        if (!operand_text.empty()) {
+            text += ' ';
+            text.append(operand_text.data(), operand_text.size());
+        }
+        ir.asm_text.push_back(std::move(text));
+        
+        // Reads every register it names; instructions with implicit operands
+        // (string ops, syscall...) read them all
+        uint32_t reads = 0;
+        bool implicit = count == 0 || starts_with(mnemonic, "rep") || starts_with(mnemonic, "stos") ||
+                        starts_with(mnemonic, "movs") || starts_with(mnemonic, "cmps") ||
+                        starts_with(mnemonic, "scas") || starts_with(mnemonic, "lods");
+        for (size_t i = 0; i < count; ++i) {
+            if (operands[i].kind == Operand::REGISTER) reads |= 1u << operands[i].reg;
+            if (operands[i].base >= 0) reads |= 1u << operands[i].base;
+            if (operands[i].index >= 0) reads |= 1u << operands[i].index;
+        }
+        if (implicit) {
+            reads = (1u << kRegisterCount) - 1;
+        }
+        instruction.extra_first = static_cast<uint32_t>(ir.extra_operands.size());
+        for (uint8_t reg = 0; reg < kRegisterCount; ++reg) {
+            if ((reads & (1u << reg)) && !is_frame_register(reg)) {
+                ir.extra_operands.push_back(IrValue::make_var(reg, word));
+                ++instruction.extra_count;
+            }
+        }
+        
+        if (count > 0 && operands[0].kind == Operand::REGISTER && !is_frame_register(operands[0].reg)) {
+            instruction.dest = operands[0].reg;
+        } else if (mnemonic == "syscall" || mnemonic == "rdtsc" || mnemonic == "cpuid") {
+            instruction.dest = kRax;
+        }
+        emit(instruction);
+        clobber(kFlags);
+    }
+    
+    void lift_instruction(size_t index) {
+        const PackedInstruction& insn = instructions[index];
+        address = insn.address;
+        next_address = insn.address + insn.size;
+        std::string_view mnemonic = instructions.get_mnemonic(insn);
+        std::string_view operand_text = instructions.get_operands(insn);
+        Operand operands[3];
+        size_t count = split_operands(operand_text, operands, 3);
+        
+        if (!lift_known(insn, mnemonic, operands, count)) {
+            emit_asm(mnemonic, operand_text, operands, count);
+        }
+    }
+    
+    uint8_t operand_width(const Operand* operands, size_t count) const {
+        for (size_t i = 0; i < count; ++i) {
+            if (operands[i].kind == Operand::REGISTER || (operands[i].kind == Operand::MEMORY && operands[i].width)) {
+                return operands[i].width;
+            }
+        }
+        return word;
+    }
+    
+    bool lift_known(const PackedInstruction& insn, std::string_view mnemonic, const Operand* operands, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (operands[i].kind == Operand::OTHER) {
+                return false;
+            }
+        }
+        uint8_t width = operand_width(operands, count);
+        
+        if (mnemonic == "nop" || mnemonic == "endbr64" || mnemonic == "endbr32" || mnemonic == "pause") {
+            return true;
+        }
+        
+        // Stack bookkeeping
+        if (mnemonic == "push") {
+            state.sp -= count == 1 && operands[0].kind == Operand::REGISTER ? operands[0].width : word;
+            return true;
+        }
+        if (mnemonic == "pop") {
+            state.sp += word;
+            if (count == 1 && operands[0].kind == Operand::REGISTER) {
+                if (operands[0].reg == kRbp && frame_pointer) {
+                    state.bp_valid = false;
+                } else if (!is_frame_register(operands[0].reg)) {
+                    clobber(operands[0].reg);
+                }
+            }
+            return true;
+        }
+        if (mnemonic == "leave") {
+            if (state.bp_valid) {
+                state.sp = state.bp + word;
+            }
+            state.bp_valid = false;
+            return true;
+        }
+        if (count == 2 && operands[0].kind == Operand::REGISTER && is_frame_register(operands[0].reg)) {
+            return lift_frame_update(mnemonic, operands);
+        }
+        
+        // Control flow
+        if (mnemonic == "ret" || mnemonic == "retq") {
+            emit_return(address);
+            return true;
+        }
+        if (mnemonic == "call") {
+            IrValue target;
+            if (insn.has_target()) {
+                target = IrValue::make_const(insn.target_address, word);
+            } else if (count != 1 || !read(operands[0], word, target)) {
+                return false;
+            }
+            emit_call(target);
+            return true;
+        }
+        if (mnemonic == "jmp") {
+            return lift_jump(insn, operands, count);
+        }
+        if (mnemonic.size() > 1 && mnemonic[0] == 'j') {
+            IrCondition condition = parse_condition(mnemonic.substr(1));
+            if (condition == IrCondition::NONE || !insn.has_target()) {
+                return false;
+            }
+            return lift_branch(insn, condition, IrValue::make_var(kFlags, 1));
+        }
+        
+        // Data movement
+        if ((mnemonic == "mov" || mnemonic == "movabs") && count == 2) {
+            IrValue source;
+            if (!read(operands[1], width, source)) {
+                return false;
+            }
+            IrInstruction copy = make(IrOp::COPY, width);
+            copy.operands[0] = source;
+            copy.operand_count = 1;
+            return write(operands[0], copy);
+        }
+        if ((mnemonic == "movzx" || mnemonic == "movsx" || mnemonic == "movsxd") && count == 2) {
+            uint8_t source_width = operands[1].width;
+            IrValue source;
+            if (source_width == 0 || !read(operands[1], source_width, source)) {
+                return false;
+            }
+            IrInstruction extend = make(mnemonic == "movzx" ? IrOp::ZEXT : IrOp::SEXT, operands[0].width);
+            extend.source_width = source_width;
+            extend.operands[0] = source;
+            extend.operand_count = 1;
+            return write(operands[0], extend);
+        }
+        if (mnemonic == "lea" && count == 2) {
+            IrValue address_value;
+            if (!address_of(operands[1], address_value)) {
+                return false;
+            }
+            IrInstruction copy = make(IrOp::COPY, operands[0].width);
+            copy.operands[0] = address_value;
+            copy.operand_count = 1;
+            return write(operands[0], copy);
+        }
+        if (mnemonic == "cdqe" || mnemonic == "cwde" || mnemonic == "cbw") {
+            uint8_t to = mnemonic == "cdqe" ? 8 : mnemonic == "cwde" ? 4 : 2;
+            IrInstruction extend = make(IrOp::SEXT, to);
+            extend.source_width = to / 2;
+            extend.operands[0] = IrValue::make_var(kRax, to / 2);
+            extend.operand_count = 1;
+            extend.dest = kRax;
+            emit(extend);
+            return true;
+        }
+        if (mnemonic == "cqo" || mnemonic == "cdq" || mnemonic == "cwd") {
+            uint8_t size = mnemonic == "cqo" ? 8 : mnemonic == "cdq" ? 4 : 2;
+            IrInstruction sign = make(IrOp::SAR, size);
+            sign.operands[0] = IrValue::make_var(kRax, size);
+            sign.operands[1] = IrValue::make_const(size * 8 - 1, 1);
+            sign.operand_count = 2;
+            sign.dest = kRdx;
+            emit(sign);
+            return true;
+        }
+        if (starts_with(mnemonic, "set") && count == 1) {
+            IrCondition condition = parse_condition(mnemonic.substr(3));
+            if (condition == IrCondition::NONE) {
+                return false;
+            }
+            IrInstruction set = make(IrOp::SETCC, 1);
+            set.condition = condition;
+            set.operands[0] = IrValue::make_var(kFlags, 1);
+            set.operand_count = 1;
+            return write(operands[0], set);
+        }
+        if (starts_with(mnemonic, "cmov") && count == 2) {
+            IrCondition condition = parse_condition(mnemonic.substr(4));
+            IrValue source;
+            IrValue original;
+            if (condition == IrCondition::NONE || !read(operands[1], width, source) || !read(operands[0], width, original)) {
+                return false;
+            }
+            IrInstruction select = make(IrOp::SELECT, width);
+            select.condition = condition;
+            select.operands[0] = IrValue::make_var(kFlags, 1);
+            select.operands[1] = source;
+            select.operands[2] = original;
+            select.operand_count = 3;
+            return write(operands[0], select);
+        }
+        
+        // Arithmetic
+        if ((mnemonic == "cmp" || mnemonic == "test") && count == 2) {
+            IrValue a;
+            IrValue b;
+            if (!read(operands[0], width, a) || !read(operands[1], width, b)) {
+                return false;
+            }
+            set_flags(mnemonic == "cmp" ? IrOp::CMP : IrOp::TEST, a, b, width);
+            return true;
+        }
+        if ((mnemonic == "xor" || mnemonic == "sub") && count == 2 && operands[0].kind == Operand::REGISTER &&
+            operands[1].kind == Operand::REGISTER && operands[0].reg == operands[1].reg) {
+            // Zeroing idiom
+            IrInstruction zero = make(IrOp::COPY, width);
+            zero.operands[0] = IrValue::make_const(0, width);
+            zero.operand_count = 1;
+            write(operands[0], zero);
+            clobber(kFlags);
+            return true;
+        }
+        IrOp binary = IrOp::UNDEF;
+        if (mnemonic == "add") binary = IrOp::ADD;
+        else if (mnemonic == "sub") binary = IrOp::SUB;
+        else if (mnemonic == "and") binary = IrOp::AND;
+        else if (mnemonic == "or") binary = IrOp::OR;
+        else if (mnemonic == "xor") binary = IrOp::XOR;
+        else if (mnemonic == "shl" || mnemonic == "sal") binary = IrOp::SHL;
+        else if (mnemonic == "shr") binary = IrOp::SHR;
+        else if (mnemonic == "sar") binary = IrOp::SAR;
+        else if (mnemonic == "imul" && count >= 2) binary = IrOp::MUL;
+        if (binary != IrOp::UNDEF && (count == 2 || (count == 3 && binary == IrOp::MUL) ||
+                                      (count == 1 && (binary == IrOp::SHL || binary == IrOp::SHR || binary == IrOp::SAR)))) {
+            IrValue a;
+            IrValue b;
+            const Operand& left = count == 3 ? operands[1] : operands[0];
+            if (!read(left, width, a)) {
+                return false;
+            }
+            if (count == 1) {
+                b = IrValue::make_const(1, 1);  // shift by one
+            } else if (!read(operands[count - 1], width, b)) {
+                return false;
+            }
+            IrInstruction value = make(binary, width);
+            value.operands[0] = a;
+            value.operands[1] = b;
+            value.operand_count = 2;
+            if (!write(operands[0], value)) {
+                return false;
+            }
+            lift_result_flags(binary, a, b, width);
+            return true;
+        }
+        if ((mnemonic == "inc" || mnemonic == "dec") && count == 1) {
+            IrValue a;
+            if (!read(operands[0], width, a)) {
+                return false;
+            }
+            IrOp op = mnemonic == "inc" ? IrOp::ADD : IrOp::SUB;
+            IrInstruction value = make(op, width);
+            value.operands[0] = a;
+            value.operands[1] = IrValue::make_const(1, width);
+            value.operand_count = 2;
+            if (!write(operands[0], value)) {
+                return false;
+            }
+            lift_result_flags(op, a, value.operands[1], width);
+            return true;
+        }
+        if ((mnemonic == "neg" || mnemonic == "not") && count == 1) {
+            IrValue a;
+            if (!read(operands[0], width, a)) {
+                return false;
+            }
+            IrInstruction value = make(mnemonic == "neg" ? IrOp::NEG : IrOp::NOT, width);
+            value.operands[0] = a;
+            value.operand_count = 1;
+            if (!write(operands[0], value)) {
+                return false;
+            }
+            clobber(kFlags);
+            return true;
+        }
+        if ((mnemonic == "div" || mnemonic == "idiv" || mnemonic == "mul") && count == 1) {
+            return lift_widening(mnemonic, operands[0], width);
+        }
+        
+        return false;
+    }
+    
+    bool lift_frame_update(std::string_view mnemonic, const Operand* operands) {
+        const Operand& target = operands[0];
+        const Operand& source = operands[1];
+        int64_t* value = target.reg == kRsp ? &state.sp : &state.bp;
+        if (target.reg == kRbp && !state.bp_valid && mnemonic != "mov" && mnemonic != "lea") {
+            return true;
+        }
+        
+        if (mnemonic == "sub" && source.kind == Operand::IMMEDIATE) {
+            *value -= source.value;
+        } else if (mnemonic == "add" && source.kind == Operand::IMMEDIATE) {
+            *value += source.value;
+        } else if (mnemonic == "mov" && source.kind == Operand::REGISTER && is_frame_register(source.reg)) {
+            if (source.reg == kRsp) {
+                *value = state.sp;
+                if (target.reg == kRbp) {
+                    state.bp_valid = true;
+                }
+            } else if (state.bp_valid) {
+                *value = state.bp;
+            }
+        } else if (mnemonic == "lea") {
+            int64_t offset = 0;
+            if (frame_offset_of(source, offset)) {
+                *value = offset;
+                if (target.reg == kRbp) {
+                    state.bp_valid = true;
+                }
+            }
+        }
+        // Anything else (and rsp, -16 for alignment, ...) leaves the
+        // offsets as they were; frame accesses go through rbp by then
+        return true;
+    }
+    
+    // Flags after an arithmetic result: compares against the operands for
+    // subtraction, against zero otherwise
+    void lift_result_flags(IrOp op, IrValue a, IrValue b, uint8_t width) {
+        if (op == IrOp::SUB) {
+            set_flags(IrOp::CMP, a, b, width);
+            return;
+        }
+        uint32_t result = written;
+        if (result == IrInstruction::NO_VAR) {
+            clobber(kFlags);
+            return;
+        }
+        IrValue result_value = IrValue::make_var(result, width);
+        set_flags(IrOp::TEST, result_value, result_value, width);
+    }
+    
+    // div/idiv/mul on rdx:rax; the high half of the dividend is ignored
+    bool lift_widening(std::string_view mnemonic, const Operand& operand, uint8_t width) {
+        IrValue divisor;
+        if (!read(operand, width, divisor)) {
+            return false;
+        }
+        IrValue dividend = IrValue::make_var(emit_value(IrOp::COPY, width, IrValue::make_var(kRax, width)), width);
+        
+        if (mnemonic == "mul") {
+            IrInstruction product = make(IrOp::MUL, width);
+            product.operands[0] = dividend;
+            product.operands[1] = divisor;
+            product.operand_count = 2;
+            product.dest = kRax;
+            emit(product);
+            clobber(kRdx);
+        } else {
+            bool is_signed = mnemonic == "idiv";
+            IrInstruction quotient = make(is_signed ? IrOp::DIV : IrOp::UDIV, width);
+            quotient.operands[0] = dividend;
+            quotient.operands[1] = divisor;
+            quotient.operand_count = 2;
+            quotient.dest = kRax;
+            emit(quotient);
+            IrInstruction remainder = quotient;
+            remainder.op = is_signed ? IrOp::MOD : IrOp::UMOD;
+            remainder.dest = kRdx;
+            emit(remainder);
+        }
+        clobber(kFlags);
+        return true;
+    }
+    
+    bool lift_jump(const PackedInstruction& insn, const Operand* operands, size_t count) {
+        if (insn.has_target()) {
+            auto it = block_index.find(insn.target_address);
+            if (it != block_index.end()) {
+                emit(make(IrOp::JUMP, 0));
+                ir.blocks[current].successors.push_back(it->second);
+            } else {
+                // Tail call
+                emit_call(IrValue::make_const(insn.target_address, word));
+                emit_return(address);
+            }
+            return true;
+        }
+        
+        IrValue target;
+        if (count != 1 || !read(operands[0], word, target)) {
+            return false;
+        }
+        IrInstruction jump = make(IrOp::INDIRECT_JUMP, word);
+        jump.operands[0] = target;
+        jump.operand_count = 1;
+        emit(jump);
+        return true;
+    }
+    
+    bool lift_branch(const PackedInstruction& insn, IrCondition condition, IrValue flags) {
+        auto taken = block_index.find(insn.target_address);
+        auto fall = block_index.find(insn.address + insn.size);
+        if (taken == block_index.end() || fall == block_index.end()) {
+            return false;
+        }
+        IrInstruction branch = make(IrOp::BRANCH, 0);
+        branch.condition = condition;
+        branch.operands[0] = flags;
+        branch.operand_count = 1;
+        emit(branch);
+        ir.blocks[current].successors.push_back(taken->second);
+        ir.blocks[current].successors.push_back(fall->second);
+        return true;
+    }
+};
+
+// Architectures without a lifter: every instruction is an ASM statement and
+// conditional branches keep their text as the condition
+void lift_opaque_block(IrFunction& ir, const DisassemblyBuffer& instructions, const FunctionBlock& range,
+                       uint32_t block, const std::unordered_map<uint64_t, uint32_t>& block_index) {
+    IrBlock& out = ir.blocks[block];
+    size_t last = range.first_instruction + range.instruction_count;
+    for (size_t i = range.first_instruction; i < last; ++i) {
+        const PackedInstruction& insn = instructions[i];
+        std::string_view mnemonic = instructions.get_mnemonic(insn);
+        std::string_view operands = instructions.get_operands(insn);
+        std::string text(mnemonic);
+        if (!operands.empty()) {
+            text += ' ';
+            text.append(operands.data(), operands.size());
+        }
+        
+        IrInstruction instruction;
+        instruction.address = insn.address;
+        instruction.text = static_cast<uint32_t>(ir.asm_text.size());
+        bool last_instruction = i + 1 == last;
+        if (insn.is_return()) {
+            instruction.op = IrOp::RETURN;
+        } else if (insn.is_call() && insn.has_target()) {
+            instruction.op = IrOp::CALL;
+            instruction.operands[0] = IrValue::make_const(insn.target_address, 8);
+            instruction.operand_count = 1;
+        } else if (last_instruction && insn.is_jump() && insn.has_target()) {
+            auto taken = block_index.find(insn.target_address);
+            auto fall = block_index.find(insn.address + insn.size);
+            if (is_unconditional_jump(mnemonic)) {
+                instruction.op = taken != block_index.end() ? IrOp::JUMP : IrOp::ASM;
+                if (taken != block_index.end()) {
+                    out.successors.push_back(taken->second);
+                }
+            } else if (taken != block_index.end() && fall != block_index.end()) {
+                instruction.op = IrOp::BRANCH;
+                out.successors.push_back(taken->second);
+                out.successors.push_back(fall->second);
+            } else {
+                instruction.op = IrOp::ASM;
+            }
+        } else {
+            instruction.op = IrOp::ASM;
+        }
+        ir.asm_text.push_back(std::move(text));
+        out.instructions.push_back(instruction);
+    }
+    
+    bool terminated = !out.instructions.empty() && !out.successors.empty();
+    if (!terminated && !out.instructions.empty() && out.instructions.back().op != IrOp::RETURN) {
+        auto it = block_index.find(range.end_address);
+        if (it != block_index.end()) {
+            IrInstruction jump;
+            jump.op = IrOp::JUMP;
+            jump.address = out.instructions.back().address;
+            out.instructions.push_back(jump);
+            out.successors.push_back(it->second);
+        }
+    }
+}
+
+} // namespace
+
+bool lift_function(const Function& function, const DisassemblyBuffer& instructions,
+                   Architecture arch, IrFunction& ir) {
+    ir = IrFunction();
+    ir.address = function.start_address;
+    
+    std::vector<FunctionBlock> ranges = function.blocks.empty() ? split_blocks(function, instructions) : function.blocks;
+    if (ranges.empty()) {
+        return false;
+    }
+    
+    // The entry block goes first; the rest stay in address order
+    auto entry = std::find_if(ranges.begin(), ranges.end(), [&function](const FunctionBlock& block) {
+        return block.start_address == function.start_address;
+    });
+    if (entry == ranges.end()) {
+        return false;
+    }
+    std::rotate(ranges.begin(), entry, entry + 1);
+    
+    std::unordered_map<uint64_t, uint32_t> block_index;
+    block_index.reserve(ranges.size() * 2);
+    for (const FunctionBlock& range : ranges) {
+        block_index.emplace(range.start_address, static_cast<uint32_t>(ir.blocks.size()));
+        IrBlock block;
+        block.address = range.start_address;
+        ir.blocks.push_back(std::move(block));
+    }
+    
+    bool x86 = arch == Architecture::X86 || arch == Architecture::X86_64;
+    
+    // Conditional jumps out of the function (conditional tail calls) get a
+    // block of their own holding the call
+    std::vector<std::pair<uint32_t, uint64_t>> tail_blocks;
+    if (x86) {
+        for (const FunctionBlock& range : ranges) {
+            const PackedInstruction& tail = instructions[range.first_instruction + range.instruction_count - 1];
+            if (tail.is_jump() && tail.has_target() && !is_unconditional_jump(instructions.get_mnemonic(tail)) &&
+                !block_index.count(tail.target_address)) {
+                uint32_t index = static_cast<uint32_t>(ir.blocks.size());
+                block_index.emplace(tail.target_address, index);
+                IrBlock block;
+                block.address = tail.target_address;
+                ir.blocks.push_back(std::move(block));
+                tail_blocks.emplace_back(index, tail.target_address);
+            }
+        }
+    }
+    
+    if (!x86) {
+        for (size_t b = 0; b < ranges.size(); ++b) {
+            lift_opaque_block(ir, instructions, ranges[b], static_cast<uint32_t>(b), block_index);
+        }
+    } else {
+        X86Lifter lifter(ir, instructions, arch == Architecture::X86_64, block_index);
+        lifter.scan(ranges);
+        
+        // Frame offsets flow from each block into the successors lifted after it
+        std::vector<FrameState> entry_state(ir.blocks.size());
+        std::vector<bool> seen(ir.blocks.size(), false);
+        std::vector<uint32_t> worklist{0};
+        seen[0] = true;
+        while (!worklist.empty()) {
+            uint32_t b = worklist.back();
+            worklist.pop_back();
+            FrameState frame = entry_state[b];
+            lifter.lift_block(ranges[b], b, frame);
+            for (uint32_t successor : ir.blocks[b].successors) {
+                if (!seen[successor]) {
+                    seen[successor] = true;
+                    entry_state[successor] = frame;
+                    if (successor < ranges.size()) {
+                        worklist.push_back(successor);
+                    }
+                }
+            }
+        }
+        for (size_t b = 0; b < ranges.size(); ++b) {
+            if (!seen[b]) {
+                FrameState frame;
+                lifter.lift_block(ranges[b], static_cast<uint32_t>(b), frame);
+            }
+        }
+        for (const auto& tail : tail_blocks) {
+            lifter.lift_tail_call(tail.first, tail.second);
+        }
+    }
+    
+    for (uint32_t b = 0; b < ir.blocks.size(); ++b) {
+        for (uint32_t successor : ir.blocks[b].successors) {
+            ir.blocks[successor].predecessors.push_back(b);
+        }
+    }
+    return true;
+}
+
+} // namespace debugger 
\ No newline at end of file
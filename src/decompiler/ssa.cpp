@@ -0,0 +1,675 @@
+#include "decompiler_ir.h"
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <unordered_map>
+
+namespace debugger {
+
+namespace {
+
+constexpr uint32_t NONE = UINT32_MAX;
+
+bool is_side_effect(IrOp op) {
+    switch (op) {
+        case IrOp::STORE:
+        case IrOp::CALL:
+        case IrOp::ASM:
+        case IrOp::BRANCH:
+        case IrOp::JUMP:
+        case IrOp::INDIRECT_JUMP:
+        case IrOp::RETURN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint64_t width_mask(uint8_t width) {
+    return width >= 8 || width == 0 ? ~0ull : (1ull << (width * 8)) - 1;
+}
+
+int64_t sign_extend(uint64_t value, uint8_t width) {
+    if (width >= 8 || width == 0) {
+        return static_cast<int64_t>(value);
+    }
+    uint64_t sign = 1ull << (width * 8 - 1);
+    value &= width_mask(width);
+    return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+// Drops blocks the entry can't reach so every block has a dominator
+void remove_unreachable(IrFunction& ir) {
+    std::vector<bool> reachable(ir.blocks.size(), false);
+    std::vector<uint32_t> worklist{0};
+    reachable[0] = true;
+    while (!worklist.empty()) {
+        uint32_t b = worklist.back();
+        worklist.pop_back();
+        for (uint32_t successor : ir.blocks[b].successors) {
+            if (!reachable[successor]) {
+                reachable[successor] = true;
+                worklist.push_back(successor);
+            }
+        }
+    }
+    if (std::find(reachable.begin(), reachable.end(), false) == reachable.end()) {
+        return;
+    }
+    
+    std::vector<uint32_t> remap(ir.blocks.size(), NONE);
+    std::vector<IrBlock> kept;
+    for (uint32_t b = 0; b < ir.blocks.size(); ++b) {
+        if (reachable[b]) {
+            remap[b] = static_cast<uint32_t>(kept.size());
+            kept.push_back(std::move(ir.blocks[b]));
+        }
+    }
+    for (IrBlock& block : kept) {
+        for (uint32_t& successor : block.successors) {
+            successor = remap[successor];
+        }
+        block.predecessors.erase(std::remove_if(block.predecessors.begin(), block.predecessors.end(),
+                                                [&remap](uint32_t p) { return remap[p] == NONE; }),
+                                 block.predecessors.end());
+        for (uint32_t& predecessor : block.predecessors) {
+            predecessor = remap[predecessor];
+        }
+    }
+    ir.blocks = std::move(kept);
+}
+
+std::vector<uint32_t> reverse_postorder(const IrFunction& ir) {
+    std::vector<uint32_t> order;
+    std::vector<uint8_t> state(ir.blocks.size(), 0);  // 0 new, 1 on stack, 2 done
+    std::vector<std::pair<uint32_t, size_t>> stack{{0, 0}};
+    state[0] = 1;
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        const IrBlock& block = ir.blocks[top.first];
+        if (top.second < block.successors.size()) {
+            uint32_t successor = block.successors[top.second++];
+            if (state[successor] == 0) {
+                state[successor] = 1;
+                stack.emplace_back(successor, 0);
+            }
+        } else {
+            state[top.first] = 2;
+            order.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Cooper, Harvey and Kennedy's iterative algorithm over reverse postorder
+void compute_dominators(IrFunction& ir, const std::vector<uint32_t>& order) {
+    std::vector<uint32_t> position(ir.blocks.size(), NONE);
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        position[order[i]] = i;
+    }
+    std::vector<uint32_t> idom(ir.blocks.size(), NONE);
+    idom[0] = 0;
+    
+    auto intersect = [&](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (position[a] > position[b]) a = idom[a];
+            while (position[b] > position[a]) b = idom[b];
+        }
+        return a;
+    };
+    
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < order.size(); ++i) {
+            uint32_t b = order[i];
+            uint32_t candidate = NONE;
+            for (uint32_t predecessor : ir.blocks[b].predecessors) {
+                if (idom[predecessor] == NONE) {
+                    continue;
+                }
+                candidate = candidate == NONE ? predecessor : intersect(predecessor, candidate);
+            }
+            if (candidate != idom[b]) {
+                idom[b] = candidate;
+                changed = true;
+            }
+        }
+    }
+    
+    for (uint32_t b = 0; b < ir.blocks.size(); ++b) {
+        ir.blocks[b].immediate_dominator = b == 0 ? NONE : idom[b];
+    }
+}
+
+} // namespace
+
+void build_ssa(IrFunction& ir) {
+    if (ir.in_ssa || ir.blocks.empty()) {
+        return;
+    }
+    remove_unreachable(ir);
+    std::vector<uint32_t> order = reverse_postorder(ir);
+    compute_dominators(ir, order);
+    const size_t block_count = ir.blocks.size();
+    const size_t location_count = ir.locations.size();
+    
+    // Dominance frontiers
+    std::vector<std::vector<uint32_t>> frontier(block_count);
+    for (uint32_t b = 0; b < block_count; ++b) {
+        const IrBlock& block = ir.blocks[b];
+        if (block.predecessors.size() < 2) {
+            continue;
+        }
+        for (uint32_t predecessor : block.predecessors) {
+            uint32_t runner = predecessor;
+            while (runner != block.immediate_dominator && runner != NONE) {
+                std::vector<uint32_t>& entries = frontier[runner];
+                if (entries.empty() || entries.back() != b) {
+                    entries.push_back(b);
+                }
+                runner = ir.blocks[runner].immediate_dominator;
+            }
+        }
+    }
+    
+    // Locations read before being written in some block are the only ones
+    // that can need a phi (semi-pruned SSA); temporaries never do
+    std::vector<bool> global(location_count, false);
+    std::vector<std::vector<uint32_t>> def_blocks(location_count);
+    std::vector<uint32_t> defined_in(location_count, NONE);
+    for (uint32_t b = 0; b < block_count; ++b) {
+        for (const IrInstruction& instruction : ir.blocks[b].instructions) {
+            ir.for_each_use(instruction, [&](const IrValue& value) {
+                if (value.kind == IrValue::VAR && defined_in[value.var] != b) {
+                    global[value.var] = true;
+                }
+            });
+            if (instruction.dest != IrInstruction::NO_VAR) {
+                if (defined_in[instruction.dest] != b) {
+                    defined_in[instruction.dest] = b;
+                    def_blocks[instruction.dest].push_back(b);
+                }
+            }
+        }
+    }
+    
+    // Phi placement at the iterated dominance frontier
+    std::vector<std::vector<uint32_t>> phi_locations(block_count);
+    std::vector<uint32_t> has_phi(block_count, NONE);
+    std::vector<uint32_t> queued(block_count, NONE);
+    for (uint32_t location = 0; location < location_count; ++location) {
+        if (!global[location] || ir.locations[location].kind == IrLocation::TEMPORARY) {
+            continue;
+        }
+        std::vector<uint32_t> worklist = def_blocks[location];
+        for (uint32_t b : worklist) {
+            queued[b] = location;
+        }
+        while (!worklist.empty()) {
+            uint32_t b = worklist.back();
+            worklist.pop_back();
+            for (uint32_t target : frontier[b]) {
+                if (has_phi[target] == location) {
+                    continue;
+                }
+                has_phi[target] = location;
+                phi_locations[target].push_back(location);
+                if (queued[target] != location) {
+                    queued[target] = location;
+                    worklist.push_back(target);
+                }
+            }
+        }
+    }
+    for (uint32_t b = 0; b < block_count; ++b) {
+        IrBlock& block = ir.blocks[b];
+        std::vector<IrInstruction> phis;
+        for (uint32_t location : phi_locations[b]) {
+            IrInstruction phi;
+            phi.op = IrOp::PHI;
+            phi.width = ir.locations[location].width;
+            phi.dest = location;
+            phi.address = block.address;
+            phi.extra_first = static_cast<uint32_t>(ir.extra_operands.size());
+            phi.extra_count = static_cast<uint32_t>(block.predecessors.size());
+            ir.extra_operands.resize(ir.extra_operands.size() + block.predecessors.size(),
+                                     IrValue::make_var(location, phi.width));
+            phis.push_back(phi);
+        }
+        block.instructions.insert(block.instructions.begin(), phis.begin(), phis.end());
+    }
+    
+    // Renaming over the dominator tree
+    std::vector<std::vector<uint32_t>> children(block_count);
+    for (uint32_t b = 1; b < block_count; ++b) {
+        if (ir.blocks[b].immediate_dominator != NONE) {
+            children[ir.blocks[b].immediate_dominator].push_back(b);
+        }
+    }
+    
+    ir.variables.clear();
+    std::vector<std::vector<uint32_t>> stacks(location_count);
+    std::vector<uint32_t> entry_value(location_count, NONE);
+    auto current = [&](uint32_t location, uint8_t width) {
+        std::vector<uint32_t>& stack = stacks[location];
+        if (!stack.empty()) {
+            return stack.back();
+        }
+        if (entry_value[location] == NONE) {
+            entry_value[location] = static_cast<uint32_t>(ir.variables.size());
+            ir.variables.push_back({location, IrVariable::ENTRY, 0, width});
+        }
+        IrVariable& variable = ir.variables[entry_value[location]];
+        variable.width = std::max(variable.width, width);
+        return entry_value[location];
+    };
+    
+    std::vector<std::vector<uint32_t>> pushed(block_count);
+    std::vector<std::pair<uint32_t, bool>> walk{{0, false}};
+    while (!walk.empty()) {
+        auto [b, leaving] = walk.back();
+        walk.pop_back();
+        if (leaving) {
+            for (uint32_t location : pushed[b]) {
+                stacks[location].pop_back();
+            }
+            continue;
+        }
+        
+        IrBlock& block = ir.blocks[b];
+        size_t phi_count = phi_locations[b].size();
+        for (size_t i = 0; i < block.instructions.size(); ++i) {
+            IrInstruction& instruction = block.instructions[i];
+            if (i >= phi_count) {
+                ir.for_each_use(instruction, [&](IrValue& value) {
+                    if (value.kind == IrValue::VAR) {
+                        value.var = current(value.var, value.width);
+                    }
+                });
+            }
+            if (instruction.dest != IrInstruction::NO_VAR) {
+                uint32_t location = instruction.dest;
+                uint32_t variable = static_cast<uint32_t>(ir.variables.size());
+                ir.variables.push_back({location, b, 0, instruction.width});
+                stacks[location].push_back(variable);
+                pushed[b].push_back(location);
+                instruction.dest = variable;
+            }
+        }
+        
+        for (uint32_t successor : block.successors) {
+            IrBlock& target = ir.blocks[successor];
+            for (size_t j = 0; j < target.predecessors.size(); ++j) {
+                if (target.predecessors[j] != b) {
+                    continue;
+                }
+                for (size_t p = 0; p < phi_locations[successor].size(); ++p) {
+                    uint32_t location = phi_locations[successor][p];
+                    IrValue& incoming = ir.extra_operands[target.instructions[p].extra_first + j];
+                    incoming = IrValue::make_var(current(location, incoming.width), incoming.width);
+                }
+            }
+        }
+        
+        walk.emplace_back(b, true);
+        for (auto child = children[b].rbegin(); child != children[b].rend(); ++child) {
+            walk.emplace_back(*child, false);
+        }
+    }
+    
+    // A phi is as wide as the widest value flowing into it, so a loop over
+    // a 32-bit register stays 32-bit
+    std::vector<std::pair<uint32_t, uint32_t>> phi_sites;
+    for (uint32_t b = 0; b < block_count; ++b) {
+        for (uint32_t p = 0; p < phi_locations[b].size(); ++p) {
+            uint32_t dest = ir.blocks[b].instructions[p].dest;
+            ir.variables[dest].width = 0;
+            phi_sites.emplace_back(b, p);
+        }
+    }
+    bool widened = true;
+    while (widened) {
+        widened = false;
+        for (const auto& site : phi_sites) {
+            const IrInstruction& phi = ir.blocks[site.first].instructions[site.second];
+            uint8_t width = 0;
+            for (uint32_t i = 0; i < phi.extra_count; ++i) {
+                const IrValue& incoming = ir.extra_operands[phi.extra_first + i];
+                width = std::max(width, std::min(incoming.width, ir.variables[incoming.var].width));
+            }
+            if (width > ir.variables[phi.dest].width) {
+                ir.variables[phi.dest].width = width;
+                widened = true;
+            }
+        }
+    }
+    for (const auto& site : phi_sites) {
+        IrInstruction& phi = ir.blocks[site.first].instructions[site.second];
+        if (ir.variables[phi.dest].width == 0) {
+            ir.variables[phi.dest].width = phi.width;
+        }
+        phi.width = ir.variables[phi.dest].width;
+    }
+    
+    ir.in_ssa = true;
+}
+
+size_t propagate_constants(IrFunction& ir) {
+    std::vector<bool> known(ir.variables.size(), false);
+    std::vector<uint64_t> value(ir.variables.size(), 0);
+    size_t rewritten = 0;
+    
+    auto fold = [](IrOp op, uint64_t a, uint64_t b, uint8_t width, uint64_t& result) {
+        uint64_t mask = width_mask(width);
+        switch (op) {
+            case IrOp::ADD: result = a + b; break;
+            case IrOp::SUB: result = a - b; break;
+            case IrOp::MUL: result = a * b; break;
+            case IrOp::AND: result = a & b; break;
+            case IrOp::OR: result = a | b; break;
+            case IrOp::XOR: result = a ^ b; break;
+            case IrOp::SHL: result = b < 64 ? a << b : 0; break;
+            case IrOp::SHR: result = b < 64 ? (a & mask) >> b : 0; break;
+            case IrOp::SAR: result = static_cast<uint64_t>(sign_extend(a, width) >> std::min<uint64_t>(b, 63)); break;
+            case IrOp::DIV:
+            case IrOp::MOD: {
+                int64_t x = sign_extend(a, width);
+                int64_t y = sign_extend(b, width);
+                if (y == 0 || (y == -1 && x == INT64_MIN)) {
+                    return false;
+                }
+                result = static_cast<uint64_t>(op == IrOp::DIV ? x / y : x % y);
+                break;
+            }
+            case IrOp::UDIV: if (b == 0) return false; result = (a & mask) / (b & mask); break;
+            case IrOp::UMOD: if (b == 0) return false; result = (a & mask) % (b & mask); break;
+            default: return false;
+        }
+        result &= mask;
+        return true;
+    };
+    
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (IrBlock& block : ir.blocks) {
+            for (IrInstruction& instruction : block.instructions) {
+                if (instruction.op == IrOp::PHI) {
+                    // Constant when every incoming value is the same constant;
+                    // the operands stay variables so webs keep their shape
+                    if (known[instruction.dest] || instruction.extra_count == 0) {
+                        continue;
+                    }
+                    bool same = true;
+                    uint64_t first = 0;
+                    for (uint32_t i = 0; i < instruction.extra_count && same; ++i) {
+                        const IrValue& incoming = ir.extra_operands[instruction.extra_first + i];
+                        if (incoming.kind != IrValue::VAR || !known[incoming.var]) {
+                            same = false;
+                        } else if (i == 0) {
+                            first = value[incoming.var];
+                        } else {
+                            same = value[incoming.var] == first;
+                        }
+                    }
+                    if (same) {
+                        known[instruction.dest] = true;
+                        value[instruction.dest] = first;
+                        changed = true;
+                    }
+                    continue;
+                }
+                
+                ir.for_each_use(instruction, [&](IrValue& operand) {
+                    if (operand.kind == IrValue::VAR && known[operand.var]) {
+                        // The definition's width, so 32-bit constants read
+                        // through the full register keep their sign
+                        uint8_t width = std::min(operand.width, ir.variables[operand.var].width);
+                        operand = IrValue::make_const(value[operand.var] & width_mask(width), width);
+                        ++rewritten;
+                        changed = true;
+                    }
+                });
+                
+                if (instruction.dest == IrInstruction::NO_VAR || known[instruction.dest]) {
+                    continue;
+                }
+                const IrValue& a = instruction.operands[0];
+                const IrValue& b = instruction.operands[1];
+                uint64_t result = 0;
+                bool folded = false;
+                if (instruction.op == IrOp::COPY && a.is_const()) {
+                    result = a.constant & width_mask(instruction.width);
+                    folded = true;
+                } else if ((instruction.op == IrOp::ZEXT || instruction.op == IrOp::SEXT) && a.is_const()) {
+                    result = instruction.op == IrOp::ZEXT
+                                 ? a.constant & width_mask(instruction.source_width)
+                                 : static_cast<uint64_t>(sign_extend(a.constant, instruction.source_width));
+                    result &= width_mask(instruction.width);
+                    folded = true;
+                } else if (instruction.operand_count == 2 && a.is_const() && b.is_const()) {
+                    folded = fold(instruction.op, a.constant, b.constant, instruction.width, result);
+                }
+                if (folded) {
+                    known[instruction.dest] = true;
+                    value[instruction.dest] = result;
+                    instruction.op = IrOp::COPY;
+                    instruction.operands[0] = IrValue::make_const(result, instruction.width);
+                    instruction.operand_count = 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return rewritten;
+}
+
+size_t eliminate_dead_code(IrFunction& ir) {
+    struct Site {
+        uint32_t block;
+        uint32_t index;
+    };
+    std::vector<Site> definition(ir.variables.size(), {NONE, NONE});
+    for (uint32_t b = 0; b < ir.blocks.size(); ++b) {
+        const std::vector<IrInstruction>& instructions = ir.blocks[b].instructions;
+        for (uint32_t i = 0; i < instructions.size(); ++i) {
+            if (instructions[i].dest != IrInstruction::NO_VAR) {
+                definition[instructions[i].dest] = {b, i};
+            }
+        }
+    }
+    
+    // A return only carries a value when something set the return register
+    // on every path to it; the entry value or a clobber reaching any return
+    // (through phis too) makes the function void
+    std::vector<uint8_t> state(ir.variables.size(), 0);  // 1 visiting, 2 set, 3 unset
+    std::function<bool(uint32_t)> is_set = [&](uint32_t var) {
+        if (state[var]) {
+            return state[var] != 3;
+        }
+        state[var] = 1;
+        const Site& site = definition[var];
+        bool set = site.block != NONE;
+        if (set) {
+            const IrInstruction& instruction = ir.blocks[site.block].instructions[site.index];
+            if (instruction.op == IrOp::UNDEF) {
+                set = false;
+            } else if (instruction.op == IrOp::PHI) {
+                for (uint32_t i = 0; i < instruction.extra_count && set; ++i) {
+                    const IrValue& incoming = ir.extra_operands[instruction.extra_first + i];
+                    set = incoming.kind != IrValue::VAR || is_set(incoming.var);
+                }
+            }
+        }
+        state[var] = set ? 2 : 3;
+        return set;
+    };
+    bool returns_value = true;
+    for (const IrBlock& block : ir.blocks) {
+        for (const IrInstruction& instruction : block.instructions) {
+            if (instruction.op == IrOp::RETURN && instruction.operand_count &&
+                instruction.operands[0].kind == IrValue::VAR && !is_set(instruction.operands[0].var)) {
+                returns_value = false;
+            }
+        }
+    }
+    if (!returns_value) {
+        for (IrBlock& block : ir.blocks) {
+            for (IrInstruction& instruction : block.instructions) {
+                if (instruction.op == IrOp::RETURN) {
+                    instruction.operand_count = 0;
+                }
+            }
+        }
+    }
+    
+    std::vector<bool> live(ir.variables.size(), false);
+    std::vector<uint32_t> worklist;
+    auto mark_uses = [&](const IrInstruction& instruction) {
+        ir.for_each_use(instruction, [&](const IrValue& value) {
+            if (value.kind == IrValue::VAR && !live[value.var]) {
+                live[value.var] = true;
+                worklist.push_back(value.var);
+            }
+        });
+    };
+    for (const IrBlock& block : ir.blocks) {
+        for (const IrInstruction& instruction : block.instructions) {
+            if (is_side_effect(instruction.op)) {
+                mark_uses(instruction);
+            }
+        }
+    }
+    while (!worklist.empty()) {
+        uint32_t variable = worklist.back();
+        worklist.pop_back();
+        const Site& site = definition[variable];
+        if (site.block != NONE) {
+            mark_uses(ir.blocks[site.block].instructions[site.index]);
+        }
+    }
+    
+    size_t removed = 0;
+    for (IrBlock& block : ir.blocks) {
+        std::vector<IrInstruction>& instructions = block.instructions;
+        size_t kept = 0;
+        for (size_t i = 0; i < instructions.size(); ++i) {
+            IrInstruction& instruction = instructions[i];
+            bool dead_value = instruction.dest != IrInstruction::NO_VAR && !live[instruction.dest];
+            if (is_side_effect(instruction.op)) {
+                if (dead_value) {
+                    instruction.dest = IrInstruction::NO_VAR;
+                }
+            } else if (dead_value || instruction.dest == IrInstruction::NO_VAR) {
+                ++removed;
+                continue;
+            }
+            if (kept != i) {
+                instructions[kept] = instruction;
+            }
+            ++kept;
+        }
+        instructions.resize(kept);
+    }
+    return removed;
+}
+
+void assign_names(IrFunction& ir, const std::string& prefix) {
+    const size_t count = ir.variables.size();
+    std::vector<uint32_t> parent(count);
+    for (uint32_t v = 0; v < count; ++v) {
+        parent[v] = v;
+    }
+    auto find = [&parent](uint32_t v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+    
+    // Phi operands are versions of the phi's own location, so a web never
+    // holds two values that are live at once
+    std::vector<bool> present(count, false);
+    for (const IrBlock& block : ir.blocks) {
+        for (const IrInstruction& instruction : block.instructions) {
+            if (instruction.dest != IrInstruction::NO_VAR) {
+                present[instruction.dest] = true;
+            }
+            ir.for_each_use(instruction, [&](const IrValue& value) {
+                if (value.kind == IrValue::VAR) {
+                    present[value.var] = true;
+                    if (instruction.op == IrOp::PHI) {
+                        parent[find(value.var)] = find(instruction.dest);
+                    }
+                }
+            });
+        }
+    }
+    
+    ir.webs.clear();
+    std::vector<uint32_t> web_of_root(count, NONE);
+    std::unordered_map<uint32_t, uint32_t> stack_webs;  // location -> web
+    uint32_t next_number = 1;
+    
+    // Arguments first so they keep their names whatever order the code uses them in
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t v = 0; v < count; ++v) {
+        if (present[v] && ir.variables[v].block == IrVariable::ENTRY) {
+            order.push_back(v);
+        }
+    }
+    for (uint32_t v = 0; v < count; ++v) {
+        if (present[v] && ir.variables[v].block != IrVariable::ENTRY) {
+            order.push_back(v);
+        }
+    }
+    
+    for (uint32_t v : order) {
+        uint32_t root = find(v);
+        IrVariable& variable = ir.variables[v];
+        const IrLocation& location = ir.locations[variable.location];
+        if (web_of_root[root] == NONE) {
+            if (location.kind == IrLocation::STACK) {
+                auto it = stack_webs.find(variable.location);
+                if (it != stack_webs.end()) {
+                    web_of_root[root] = it->second;
+                }
+            }
+        }
+        if (web_of_root[root] == NONE) {
+            IrWeb web;
+            web.width = variable.width;
+            web.parameter = -1;
+            web.stack = location.kind == IrLocation::STACK;
+            char name[32];
+            if (web.stack) {
+                int64_t offset = location.frame_offset;
+                std::snprintf(name, sizeof(name), offset < 0 ? "local_%llx" : "arg_%llx",
+                              static_cast<unsigned long long>(offset < 0 ? -offset : offset));
+                web.name = name;
+                stack_webs.emplace(variable.location, static_cast<uint32_t>(ir.webs.size()));
+            } else if (variable.block == IrVariable::ENTRY && location.parameter >= 0) {
+                web.parameter = location.parameter;
+                web.name = "a" + std::to_string(location.parameter + 1);
+            } else if (variable.block == IrVariable::ENTRY && location.kind != IrLocation::TEMPORARY) {
+                web.name = location.name;
+            } else if (location.kind == IrLocation::FLAGS) {
+                web.name = "flags";
+            } else {
+                web.name = prefix + std::to_string(next_number++);
+            }
+            web_of_root[root] = static_cast<uint32_t>(ir.webs.size());
+            ir.webs.push_back(web);
+        }
+        variable.web = web_of_root[root];
+        IrWeb& web = ir.webs[variable.web];
+        web.width = std::max(web.width, variable.width);
+    }
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -1,11 +1,26 @@
 #include "disassembler.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include "string_scanner.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cctype>
+#include <cstdio>
+#include <set>
+#include <mutex>
+#include <condition_variable>
 
 namespace debugger {
 
+// Placeholder for functions without a symbol, in hex like the decompiler's
+static std::string get_default_function_name(uint64_t address) {
+    char name[24];
+    std::snprintf(name, sizeof(name), "sub_%llx", static_cast<unsigned long long>(address));
+    return name;
+}
+
 Disassembler::Disassembler(Architecture arch) 
     : cs_handle(0), current_arch(Architecture::UNKNOWN), initialized(false) {
     initialize(arch);
@@ -79,19 +94,23 @@ std::vector<Instruction> Disassembler::disassemble(const uint8_t* data, size_t s
         return instructions;
     }
     
-    cs_insn* insn;
-    size_t count = cs_disasm(cs_handle, data, size, base_address, 0, &insn);
+    // Decode into a single reused cs_insn rather than letting cs_disasm
+    // allocate an array for the whole input
+    cs_insn* insn = cs_malloc(cs_handle);
+    if (!insn) {
+        return instructions;
+    }
+    
+    const uint8_t* code = data;
+    size_t remaining = size;
+    uint64_t address = base_address;
     
-    if (count > 0) {
-        instructions.reserve(count);
-        
-        for (size_t i = 0; i < count; i++) {
-            instructions.push_back(convert_cs_instruction(&insn[i]));
-        }
-        
-        cs_free(insn, count);
+    while (cs_disasm_iter(cs_handle, &code, &remaining, &address, insn)) {
+        instructions.push_back(convert_cs_instruction(insn));
     }
     
+    cs_free(insn, 1);
+    
     return instructions;
 }
 
@@ -109,6 +128,318 @@ std::vector<Instruction> Disassembler::disassemble_range(const uint8_t* data, si
     return filtered_instructions;
 }
 
+size_t Disassembler::disassemble_into(const uint8_t* data, size_t size, uint64_t base_address,
+                                      DisassemblyBuffer& buffer) {
+    return disassemble_stream(data, size, base_address, buffer, nullptr);
+}
+
+size_t Disassembler::disassemble_stream(const uint8_t* data, size_t size, uint64_t base_address,
+                                        DisassemblyBuffer& buffer, const DisassemblyBatchCallback& on_batch,
+                                        size_t batch_size) {
+    PERF_SCOPE("Disassembler::disassemble_stream", "disassembly");
+    if (!initialized || !data || size == 0) {
+        return 0;
+    }
+    
+    cs_insn* insn = cs_malloc(cs_handle);
+    if (!insn) {
+        return 0;
+    }
+    
+    if (batch_size == 0) {
+        batch_size = DEFAULT_BATCH_SIZE;
+    }
+    
+    // Average instruction is around four bytes; growing past this is cheap
+    buffer.reserve(buffer.size() + size / 4 + 1);
+    
+    const uint8_t* code = data;
+    size_t remaining = size;
+    uint64_t address = base_address;
+    size_t alignment = get_instruction_alignment();
+    size_t first_index = buffer.size();
+    size_t batch_start = first_index;
+    bool stopped = false;
+    
+    while (remaining > 0 && !stopped) {
+        if (cs_disasm_iter(cs_handle, &code, &remaining, &address, insn)) {
+            uint64_t target = 0;
+            uint64_t immediate = 0;
+            uint8_t flags = classify_cs_instruction(insn, target, immediate);
+            buffer.append(insn->address, insn->bytes, insn->size,
+                          insn->mnemonic, insn->op_str, flags, target, immediate);
+        } else {
+            // cs_disasm_iter leaves the cursor on the bad bytes; step over them
+            size_t skip = std::min(alignment, remaining);
+            char operands[8 * 6];
+            size_t length = 0;
+            for (size_t i = 0; i < skip; ++i) {
+                length += std::snprintf(operands + length, sizeof(operands) - length,
+                                        i ? ", 0x%02x" : "0x%02x", code[i]);
+            }
+            buffer.append(address, code, skip, ".byte", std::string_view(operands, length), 0, 0);
+            code += skip;
+            remaining -= skip;
+            address += skip;
+        }
+        
+        if (on_batch && buffer.size() - batch_start >= batch_size) {
+            stopped = !on_batch(buffer, batch_start, buffer.size() - batch_start);
+            batch_start = buffer.size();
+        }
+    }
+    
+    // Flush the final partial batch
+    if (on_batch && !stopped && buffer.size() > batch_start) {
+        on_batch(buffer, batch_start, buffer.size() - batch_start);
+    }
+    
+    cs_free(insn, 1);
+    
+    return buffer.size() - first_index;
+}
+
+size_t Disassembler::disassemble_parallel(const uint8_t* data, size_t size, uint64_t base_address,
+                                          const std::vector<uint64_t>& split_hints,
+                                          ThreadPool& pool, DisassemblyBuffer& buffer,
+                                          const CancelCheck& cancelled) {
+    PERF_SCOPE("Disassembler::disassemble_parallel", "disassembly");
+    // Chunks below this size are not worth a thread hop
+    constexpr size_t kMinChunkSize = 64 * 1024;
+    // How far a chunk may decode into its neighbour while looking for a
+    // shared instruction boundary; x86 typically agrees within a few insns
+    constexpr size_t kResyncWindow = 4096;
+    
+    if (!initialized || !data || size == 0) {
+        return 0;
+    }
+    
+    size_t chunk_target = std::max<size_t>(pool.get_thread_count() * 4, 1);
+    size_t chunk_size = std::max(kMinChunkSize, size / chunk_target + 1);
+    if (chunk_size >= size) {
+        return disassemble_into(data, size, base_address, buffer);
+    }
+    
+    std::vector<uint64_t> hints(split_hints.begin(), split_hints.end());
+    std::sort(hints.begin(), hints.end());
+    
+    // Pick chunk boundaries: the first hint at or after each ideal split
+    // point if it is close enough, otherwise the ideal point itself
+    size_t alignment = get_instruction_alignment();
+    struct Chunk {
+        size_t start;
+        size_t end;
+        bool exact_end;  // end is a known instruction boundary
+    };
+    std::vector<Chunk> chunks;
+    size_t start = 0;
+    while (start < size) {
+        size_t ideal = start + chunk_size;
+        if (ideal >= size) {
+            chunks.push_back({start, size, true});
+            break;
+        }
+        
+        size_t end = ideal;
+        bool exact = alignment > 1; // Fixed-width ISAs resync trivially
+        auto hint = std::lower_bound(hints.begin(), hints.end(), base_address + ideal);
+        if (hint != hints.end() && *hint - base_address < ideal + chunk_size / 2 && *hint - base_address < size) {
+            end = static_cast<size_t>(*hint - base_address);
+            exact = true;
+        }
+        end -= end % alignment;
+        if (end <= start) {
+            end = std::min(size, start + chunk_size);
+        }
+        
+        chunks.push_back({start, end, exact || end == size});
+        start = end;
+    }
+    
+    // Decode every chunk on its own Capstone handle, checking for
+    // cancellation between batches
+    Architecture arch = current_arch;
+    DisassemblyBatchCallback keep_going = [&cancelled](const DisassemblyBuffer&, size_t, size_t) {
+        return !(cancelled && cancelled());
+    };
+    std::vector<DisassemblyBuffer> results(chunks.size());
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        pending.push_back(pool.submit([&, i] {
+            const Chunk& chunk = chunks[i];
+            size_t end = chunk.exact_end ? chunk.end : std::min(size, chunk.end + kResyncWindow);
+            Disassembler worker(arch);
+            worker.disassemble_stream(data + chunk.start, end - chunk.start, base_address + chunk.start,
+                                      results[i], keep_going);
+        }));
+    }
+    for (auto& future : pending) {
+        future.get();
+    }
+    if (cancelled && cancelled()) {
+        return 0;
+    }
+    
+    // Stitch in address order. A chunk that decoded past its end keeps
+    // going until it reaches an address the next chunk also decoded; from
+    // there on the next chunk takes over.
+    size_t first_index = buffer.size();
+    buffer.reserve(first_index + size / 4 + 1);
+    uint64_t cursor = base_address;
+    
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        DisassemblyBuffer& result = results[i];
+        uint64_t chunk_end = base_address + chunks[i].end;
+        
+        auto begin_it = std::lower_bound(result.begin(), result.end(), cursor,
+                                         [](const PackedInstruction& insn, uint64_t value) {
+                                             return insn.address < value;
+                                         });
+        size_t index = static_cast<size_t>(begin_it - result.begin());
+        size_t take_from = index;
+        
+        while (index < result.size() && result[index].address < chunk_end) {
+            index++;
+        }
+        
+        if (!chunks[i].exact_end && i + 1 < chunks.size()) {
+            const DisassemblyBuffer& next = results[i + 1];
+            while (index < result.size() && next.find_index(result[index].address) == DisassemblyBuffer::npos) {
+                index++;
+            }
+        }
+        
+        buffer.append_range(result, take_from, index - take_from);
+        
+        if (index < result.size()) {
+            cursor = result[index].address;   // Synchronised with the next chunk here
+        } else if (index > take_from) {
+            cursor = result[index - 1].address + result[index - 1].size;
+        } else {
+            cursor = chunk_end;
+        }
+        
+        // Release the chunk as soon as it has been merged
+        result = DisassemblyBuffer();
+    }
+    
+    return buffer.size() - first_index;
+}
+
+size_t Disassembler::get_instruction_alignment() const {
+    switch (current_arch) {
+        case Architecture::ARM:
+        case Architecture::ARM64:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+uint8_t Disassembler::classify_cs_instruction(const cs_insn* insn, uint64_t& target_address, uint64_t& immediate) const {
+    uint8_t flags = 0;
+    target_address = 0;
+    immediate = 0;
+    
+    if (!insn->detail) {
+        return flags;
+    }
+    
+    const cs_detail* detail = insn->detail;
+    
+    // Check for control flow instructions
+    for (int i = 0; i < detail->groups_count; i++) {
+        switch (detail->groups[i]) {
+            case CS_GRP_JUMP:
+                flags |= INSN_JUMP;
+                break;
+            case CS_GRP_CALL:
+                flags |= INSN_CALL;
+                break;
+            case CS_GRP_RET:
+                flags |= INSN_RETURN;
+                break;
+        }
+    }
+    
+    bool is_branch = (flags & (INSN_JUMP | INSN_CALL)) != 0;
+    
+    // Read immediates straight from the detail operands. For branches the
+    // destination is the last immediate (cbz/tbz carry a register or bit
+    // number first); any other immediate is recorded as a constant.
+    auto record = [&](uint64_t value, bool is_last_imm) {
+        if (is_branch && is_last_imm) {
+            target_address = value;
+            flags |= INSN_HAS_TARGET;
+        } else if (!(flags & INSN_HAS_IMMEDIATE)) {
+            immediate = value;
+            flags |= INSN_HAS_IMMEDIATE;
+        }
+    };
+    
+    switch (current_arch) {
+        case Architecture::X86:
+        case Architecture::X86_64: {
+            const cs_x86& x86 = detail->x86;
+            int last_imm = -1;
+            for (int i = 0; i < x86.op_count; i++) {
+                if (x86.operands[i].type == X86_OP_IMM) last_imm = i;
+            }
+            for (int i = 0; i < x86.op_count; i++) {
+                if (x86.operands[i].type == X86_OP_IMM) {
+                    record(static_cast<uint64_t>(x86.operands[i].imm), i == last_imm);
+                }
+            }
+            // RIP-relative memory operands resolve to an absolute data address
+            for (int i = 0; i < x86.op_count && !(flags & INSN_HAS_IMMEDIATE); i++) {
+                const cs_x86_op& op = x86.operands[i];
+                if (op.type == X86_OP_MEM && op.mem.base == X86_REG_RIP && op.mem.index == X86_REG_INVALID) {
+                    immediate = insn->address + insn->size + static_cast<uint64_t>(op.mem.disp);
+                    flags |= INSN_HAS_IMMEDIATE;
+                }
+            }
+            break;
+        }
+        case Architecture::ARM64: {
+            const cs_arm64& arm64 = detail->arm64;
+            int last_imm = -1;
+            for (int i = 0; i < arm64.op_count; i++) {
+                if (arm64.operands[i].type == ARM64_OP_IMM) last_imm = i;
+            }
+            for (int i = 0; i < arm64.op_count; i++) {
+                if (arm64.operands[i].type == ARM64_OP_IMM) {
+                    record(static_cast<uint64_t>(arm64.operands[i].imm), i == last_imm);
+                }
+            }
+            break;
+        }
+        case Architecture::ARM: {
+            const cs_arm& arm = detail->arm;
+            int last_imm = -1;
+            for (int i = 0; i < arm.op_count; i++) {
+                if (arm.operands[i].type == ARM_OP_IMM) last_imm = i;
+            }
+            for (int i = 0; i < arm.op_count; i++) {
+                if (arm.operands[i].type == ARM_OP_IMM) {
+                    // ARM immediates are 32-bit; keep addresses unsigned
+                    record(static_cast<uint32_t>(arm.operands[i].imm), i == last_imm);
+                }
+            }
+            break;
+        }
+        default:
+            // No operand decoder for this architecture; fall back to the text
+            if (is_branch) {
+                target_address = parse_target_address(insn->op_str);
+                if (target_address != 0) flags |= INSN_HAS_TARGET;
+            }
+            break;
+    }
+    
+    return flags;
+}
+
 Instruction Disassembler::convert_cs_instruction(const cs_insn* insn) const {
     Instruction instruction;
     
@@ -122,66 +453,46 @@ Instruction Disassembler::convert_cs_instruction(const cs_insn* insn) const {
     std::copy(insn->bytes, insn->bytes + insn->size, instruction.bytes.begin());
     
     // Analyze instruction type
-    instruction.is_jump = false;
-    instruction.is_call = false;
-    instruction.is_return = false;
-    instruction.target_address = 0;
-    
-    if (insn->detail) {
-        // Check for control flow instructions
-        for (int i = 0; i < insn->detail->groups_count; i++) {
-            uint8_t group = insn->detail->groups[i];
-            
-            switch (group) {
-                case CS_GRP_JUMP:
-                    instruction.is_jump = true;
-                    break;
-                case CS_GRP_CALL:
-                    instruction.is_call = true;
-                    break;
-                case CS_GRP_RET:
-                    instruction.is_return = true;
-                    break;
-            }
-        }
-        
-        // Extract target address for jumps and calls
-        if (instruction.is_jump || instruction.is_call) {
-            instruction.target_address = extract_target_address(instruction);
-        }
-    }
+    uint64_t target = 0;
+    uint64_t immediate = 0;
+    uint8_t flags = classify_cs_instruction(insn, target, immediate);
+    instruction.is_jump = (flags & INSN_JUMP) != 0;
+    instruction.is_call = (flags & INSN_CALL) != 0;
+    instruction.is_return = (flags & INSN_RETURN) != 0;
+    instruction.target_address = target;
+    instruction.immediate = immediate;
+    instruction.has_immediate = (flags & INSN_HAS_IMMEDIATE) != 0;
     
     return instruction;
 }
 
 uint64_t Disassembler::extract_target_address(const Instruction& insn) const {
+    return parse_target_address(insn.operands);
+}
+
+uint64_t Disassembler::parse_target_address(std::string_view operands) const {
     // Simple implementation - extract address from operand string
     // This is a basic approach; a more sophisticated implementation would
     // parse the operands properly using Capstone's detail information
     
-    std::string operands = insn.operands;
-    if (operands.find("0x") != std::string::npos) {
-        size_t pos = operands.find("0x");
-        std::string hex_str = operands.substr(pos + 2);
-        
-        // Find end of hex number
-        size_t end_pos = 0;
-        while (end_pos < hex_str.length() && 
-               std::isxdigit(hex_str[end_pos])) {
-            end_pos++;
-        }
-        
-        if (end_pos > 0) {
-            hex_str = hex_str.substr(0, end_pos);
-            try {
-                return std::stoull(hex_str, nullptr, 16);
-            } catch (...) {
-                return 0;
-            }
+    size_t pos = operands.find("0x");
+    if (pos == std::string_view::npos) {
+        return 0;
+    }
+    
+    // Accumulate the hex digits directly; no temporary strings needed
+    uint64_t value = 0;
+    size_t digits = 0;
+    for (size_t i = pos + 2; i < operands.size() && std::isxdigit(static_cast<unsigned char>(operands[i])); ++i) {
+        char c = operands[i];
+        uint64_t nibble = (c <= '9') ? c - '0' : (std::tolower(c) - 'a' + 10);
+        if (++digits > 16) {
+            return 0; // Does not fit in 64 bits
         }
+        value = (value << 4) | nibble;
     }
     
-    return 0;
+    return value;
 }
 
 std::vector<Function> Disassembler::analyze_functions(const std::vector<Instruction>& instructions) {
@@ -201,12 +512,14 @@ std::vector<Function> Disassembler::analyze_functions(const std::vector<Instruct
         if (!in_function && is_function_start(insn)) {
             current_function = Function();
             current_function.start_address = insn.address;
-            current_function.name = "sub_" + std::to_string(insn.address);
+            current_function.name = get_default_function_name(insn.address);
+            current_function.first_instruction = i;
             in_function = true;
         }
         
         if (in_function) {
             current_function.instructions.push_back(insn);
+            current_function.instruction_count++;
             
             // Check if this is a function end
             if (is_function_end(insn)) {
@@ -226,10 +539,233 @@ std::vector<Function> Disassembler::analyze_functions(const std::vector<Instruct
     return functions;
 }
 
+std::vector<Function> Disassembler::analyze_functions(const DisassemblyBuffer& instructions,
+                                                      const std::vector<uint64_t>& entry_points,
+                                                      ThreadPool* pool, const CancelCheck& cancelled) {
+    PERF_SCOPE("Disassembler::analyze_functions", "analysis");
+    std::vector<Function> functions;
+    
+    if (instructions.empty()) {
+        return functions;
+    }
+    
+    // Jumps to a known start are tail calls, not edges inside the function
+    std::unordered_set<uint64_t> known_starts(entry_points.begin(), entry_points.end());
+    
+    std::vector<uint64_t> seeds = entry_points;
+    if (seeds.empty()) {
+        for (const auto& insn : instructions) {
+            if (is_function_start(instructions.get_mnemonic(insn), instructions.get_operands(insn))) {
+                seeds.push_back(insn.address);
+            }
+        }
+        if (seeds.empty()) {
+            seeds.push_back(instructions[0].address);
+        }
+    }
+    
+    std::mutex state_mutex;
+    std::condition_variable state_changed;
+    std::unordered_set<uint64_t> claimed;
+    std::vector<size_t> worklist;  // Serial mode only
+    size_t pending = 0;
+    
+    // Caller holds state_mutex
+    std::function<void(size_t)> trace_one;
+    auto schedule = [&](uint64_t address) {
+        if (!claimed.insert(address).second) {
+            return;
+        }
+        size_t index = instructions.find_index(address);
+        if (index == DisassemblyBuffer::npos) {
+            return;
+        }
+        ++pending;
+        if (pool) {
+            pool->submit([&trace_one, index]() { trace_one(index); });
+        } else {
+            worklist.push_back(index);
+        }
+    };
+    
+    trace_one = [&](size_t index) {
+        // Queued work still has to drain, but is skipped once cancelled
+        if (cancelled && cancelled()) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (--pending == 0) {
+                state_changed.notify_all();
+            }
+            return;
+        }
+        
+        std::vector<uint64_t> call_targets;
+        Function function = trace_function(instructions, index, known_starts, call_targets);
+        
+        std::lock_guard<std::mutex> lock(state_mutex);
+        functions.push_back(std::move(function));
+        for (uint64_t target : call_targets) {
+            schedule(target);
+        }
+        if (--pending == 0) {
+            state_changed.notify_all();
+        }
+    };
+    
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        for (uint64_t seed : seeds) {
+            schedule(seed);
+        }
+    }
+    
+    if (pool) {
+        std::unique_lock<std::mutex> lock(state_mutex);
+        state_changed.wait(lock, [&pending] { return pending == 0; });
+    } else {
+        while (!worklist.empty()) {
+            size_t index = worklist.back();
+            worklist.pop_back();
+            trace_one(index);
+        }
+    }
+    
+    std::sort(functions.begin(), functions.end(), [](const Function& a, const Function& b) {
+        return a.start_address < b.start_address;
+    });
+    
+    return functions;
+}
+
+Function Disassembler::trace_function(const DisassemblyBuffer& instructions, size_t start_index,
+                                      const std::unordered_set<uint64_t>& known_starts,
+                                      std::vector<uint64_t>& call_targets) const {
+    const uint64_t start_address = instructions[start_index].address;
+    
+    auto is_decoded = [&instructions](size_t index) {
+        return instructions.get_mnemonic(instructions[index]) != ".byte";
+    };
+    auto falls_into_next = [&instructions, &is_decoded](size_t index) {
+        const auto& insn = instructions[index];
+        return index + 1 < instructions.size() &&
+               instructions[index + 1].address == insn.address + insn.size &&
+               is_decoded(index + 1);
+    };
+    
+    // Explore: walk each leader forward until control leaves the straight line
+    std::set<size_t> leaders{start_index};
+    std::unordered_set<size_t> visited;
+    std::vector<size_t> worklist{start_index};
+    
+    while (!worklist.empty()) {
+        size_t i = worklist.back();
+        worklist.pop_back();
+        
+        while (is_decoded(i) && visited.insert(i).second) {
+            const auto& insn = instructions[i];
+            
+            if (insn.is_call() && insn.has_target()) {
+                call_targets.push_back(insn.target_address);
+            }
+            
+            if (insn.is_jump() && insn.has_target() &&
+                (insn.target_address == start_address || !known_starts.count(insn.target_address))) {
+                size_t target = instructions.find_index(insn.target_address);
+                if (target != DisassemblyBuffer::npos && leaders.insert(target).second) {
+                    worklist.push_back(target);
+                }
+            }
+            
+            if (!has_fallthrough(insn, instructions.get_mnemonic(insn)) || !falls_into_next(i)) {
+                break;
+            }
+            
+            if (insn.is_jump()) {
+                // Conditional branch: the fall-through path starts a new block
+                if (leaders.insert(i + 1).second) {
+                    worklist.push_back(i + 1);
+                }
+                break;
+            }
+            
+            ++i;
+        }
+    }
+    
+    // Cut the visited instructions into blocks at every leader
+    Function function;
+    function.start_address = start_address;
+    function.end_address = start_address;
+    function.name = get_default_function_name(start_address);
+    
+    size_t lowest = start_index;
+    size_t highest = start_index;
+    
+    for (size_t leader : leaders) {
+        if (!visited.count(leader)) {
+            continue;
+        }
+        
+        size_t last = leader;
+        for (;;) {
+            const auto& insn = instructions[last];
+            if (insn.is_jump() || !has_fallthrough(insn, instructions.get_mnemonic(insn)) ||
+                !falls_into_next(last) || !visited.count(last + 1) || leaders.count(last + 1)) {
+                break;
+            }
+            ++last;
+        }
+        
+        const auto& tail = instructions[last];
+        FunctionBlock block;
+        block.start_address = instructions[leader].address;
+        block.end_address = tail.address + tail.size;
+        block.first_instruction = leader;
+        block.instruction_count = last + 1 - leader;
+        
+        if (tail.is_jump() && tail.has_target()) {
+            size_t target = instructions.find_index(tail.target_address);
+            if (target != DisassemblyBuffer::npos && leaders.count(target) && visited.count(target)) {
+                block.successors.push_back(tail.target_address);
+            }
+        }
+        if (has_fallthrough(tail, instructions.get_mnemonic(tail)) && falls_into_next(last) &&
+            visited.count(last + 1)) {
+            block.successors.push_back(instructions[last + 1].address);
+        }
+        
+        lowest = std::min(lowest, leader);
+        highest = std::max(highest, last);
+        function.end_address = std::max(function.end_address, block.end_address);
+        function.blocks.push_back(std::move(block));
+    }
+    
+    // Blocks may lie before the entry (e.g. loop heads placed above it)
+    function.first_instruction = lowest;
+    function.instruction_count = highest + 1 - lowest;
+    
+    return function;
+}
+
+bool Disassembler::has_fallthrough(const PackedInstruction& insn, std::string_view mnemonic) const {
+    if (insn.is_return()) {
+        return false;
+    }
+    
+    if (current_arch == Architecture::X86 || current_arch == Architecture::X86_64) {
+        return mnemonic != "jmp" && mnemonic != "ljmp" && mnemonic != "hlt" && mnemonic != "ud2";
+    } else if (current_arch == Architecture::ARM64) {
+        return mnemonic != "b" && mnemonic != "br" && mnemonic != "brk";
+    } else if (current_arch == Architecture::ARM) {
+        return mnemonic != "b" && mnemonic != "bx" && mnemonic != "udf";
+    }
+    
+    return !insn.is_jump();
+}
+
 Function Disassembler::analyze_function(const std::vector<Instruction>& instructions, uint64_t start_address) {
     Function function;
     function.start_address = start_address;
-    function.name = "sub_" + std::to_string(start_address);
+    function.name = get_default_function_name(start_address);
     
     bool found_start = false;
     for (const auto& insn : instructions) {
@@ -255,21 +791,24 @@ Function Disassembler::analyze_function(const std::vector<Instruction>& instruct
 }
 
 bool Disassembler::is_function_start(const Instruction& insn) const {
+    return is_function_start(insn.mnemonic, insn.operands);
+}
+
+bool Disassembler::is_function_start(std::string_view mnemonic, std::string_view operands) const {
     // Basic heuristics for function detection
-    const std::string& mnemonic = insn.mnemonic;
     
     // x86/x64 function prologue patterns
     if (current_arch == Architecture::X86 || current_arch == Architecture::X86_64) {
-        return (mnemonic == "push" && insn.operands.find("bp") != std::string::npos) ||
-               (mnemonic == "push" && insn.operands.find("rbp") != std::string::npos) ||
-               (mnemonic == "sub" && insn.operands.find("sp") != std::string::npos);
+        return (mnemonic == "push" && operands.find("bp") != std::string_view::npos) ||
+               (mnemonic == "push" && operands.find("rbp") != std::string_view::npos) ||
+               (mnemonic == "sub" && operands.find("sp") != std::string_view::npos);
     }
     
     // ARM function patterns
     if (current_arch == Architecture::ARM || current_arch == Architecture::ARM64) {
         return (mnemonic == "push" || mnemonic == "stp") &&
-               (insn.operands.find("lr") != std::string::npos || 
-                insn.operands.find("x30") != std::string::npos);
+               (operands.find("lr") != std::string_view::npos || 
+                operands.find("x30") != std::string_view::npos);
     }
     
     return false;
@@ -292,51 +831,60 @@ std::vector<uint64_t> Disassembler::find_cross_references(uint64_t address,
     return xrefs;
 }
 
-std::vector<std::string> Disassembler::extract_strings(const uint8_t* data, size_t size) {
-    std::vector<std::string> strings;
-    std::string current_string;
+std::vector<uint64_t> Disassembler::find_cross_references(uint64_t address, const DisassemblyBuffer& instructions) {
+    std::vector<uint64_t> xrefs;
     
-    for (size_t i = 0; i < size; i++) {
-        if (std::isprint(data[i]) && data[i] != 0) {
-            current_string += static_cast<char>(data[i]);
-        } else {
-            if (current_string.length() >= 4) {  // Minimum string length
-                strings.push_back(current_string);
-            }
-            current_string.clear();
+    for (const auto& insn : instructions) {
+        if ((insn.flags & (INSN_JUMP | INSN_CALL)) && insn.target_address == address) {
+            xrefs.push_back(insn.address);
         }
     }
     
+    return xrefs;
+}
+
+std::vector<std::string> Disassembler::extract_strings(const uint8_t* data, size_t size) {
+    PERF_SCOPE("Disassembler::extract_strings", "analysis");
+    StringScanner scanner;
+    std::vector<StringRecord> records;
+    scanner.scan(data, size, 0, records);
+    
+    std::vector<std::string> strings;
+    strings.reserve(records.size());
+    for (const auto& record : records) {
+        strings.push_back(StringScanner::to_string(ByteView(data, size), 0, record));
+    }
+    
     return strings;
 }
 
 std::vector<uint64_t> Disassembler::find_constants(const std::vector<Instruction>& instructions) {
     std::vector<uint64_t> constants;
+    std::unordered_set<uint64_t> seen;
     
+    // Immediates were decoded from Capstone's operand detail at disassembly time
     for (const auto& insn : instructions) {
-        // Look for immediate values in operands
-        std::string operands = insn.operands;
-        size_t pos = operands.find("0x");
-        
-        while (pos != std::string::npos) {
-            size_t end_pos = pos + 2;
-            while (end_pos < operands.length() && std::isxdigit(operands[end_pos])) {
-                end_pos++;
-            }
-            
-            if (end_pos > pos + 2) {
-                std::string hex_str = operands.substr(pos + 2, end_pos - pos - 2);
-                try {
-                    uint64_t value = std::stoull(hex_str, nullptr, 16);
-                    if (std::find(constants.begin(), constants.end(), value) == constants.end()) {
-                        constants.push_back(value);
-                    }
-                } catch (...) {
-                    // Ignore invalid hex values
-                }
-            }
-            
-            pos = operands.find("0x", end_pos);
+        if (insn.has_immediate && seen.insert(insn.immediate).second) {
+            constants.push_back(insn.immediate);
+        }
+        if (insn.target_address != 0 && seen.insert(insn.target_address).second) {
+            constants.push_back(insn.target_address);
+        }
+    }
+    
+    return constants;
+}
+
+std::vector<uint64_t> Disassembler::find_constants(const DisassemblyBuffer& instructions) {
+    std::vector<uint64_t> constants;
+    std::unordered_set<uint64_t> seen;
+    
+    for (const auto& insn : instructions) {
+        if (insn.has_immediate() && seen.insert(insn.immediate).second) {
+            constants.push_back(insn.immediate);
+        }
+        if (insn.has_target() && seen.insert(insn.target_address).second) {
+            constants.push_back(insn.target_address);
         }
     }
     
@@ -0,0 +1,156 @@
+#include "disassembler.h"
+#include <algorithm>
+#include <cstring>
+
+namespace debugger {
+
+void DisassemblyBuffer::clear() {
+    instructions.clear();
+    operand_text.clear();
+    mnemonics.clear();
+    mnemonic_ids.clear();
+}
+
+void DisassemblyBuffer::reserve(size_t instruction_count, size_t operand_bytes) {
+    instructions.reserve(instruction_count);
+    // Roughly 16 bytes of operand text per instruction when not told otherwise
+    operand_text.reserve(operand_bytes ? operand_bytes : instruction_count * 16);
+}
+
+void DisassemblyBuffer::assign(std::vector<PackedInstruction> records, std::vector<char> text,
+                               std::vector<std::string> names) {
+    instructions = std::move(records);
+    operand_text = std::move(text);
+    mnemonics = std::move(names);
+    
+    mnemonic_ids.clear();
+    for (size_t i = 0; i < mnemonics.size(); ++i) {
+        mnemonic_ids.emplace(mnemonics[i], static_cast<uint16_t>(i));
+    }
+}
+
+uint16_t DisassemblyBuffer::intern_mnemonic(std::string_view mnemonic) {
+    // Mnemonics fit the small-string buffer, so the key costs no allocation
+    std::string key(mnemonic);
+    auto it = mnemonic_ids.find(key);
+    if (it != mnemonic_ids.end()) {
+        return it->second;
+    }
+    
+    uint16_t id = static_cast<uint16_t>(mnemonics.size());
+    mnemonics.push_back(key);
+    mnemonic_ids.emplace(std::move(key), id);
+    return id;
+}
+
+void DisassemblyBuffer::append(uint64_t address, const uint8_t* bytes, size_t size,
+                               std::string_view mnemonic, std::string_view operands,
+                               uint8_t flags, uint64_t target_address, uint64_t immediate) {
+    PackedInstruction insn;
+    insn.address = address;
+    insn.target_address = target_address;
+    insn.immediate = immediate;
+    insn.operands_offset = operand_text.size();
+    insn.operands_length = static_cast<uint16_t>(std::min<size_t>(operands.size(), UINT16_MAX));
+    insn.mnemonic_id = intern_mnemonic(mnemonic);
+    insn.size = static_cast<uint8_t>(std::min<size_t>(size, sizeof(insn.bytes)));
+    insn.flags = flags;
+    
+    std::memset(insn.bytes, 0, sizeof(insn.bytes));
+    if (bytes) {
+        std::memcpy(insn.bytes, bytes, insn.size);
+    }
+    
+    operand_text.insert(operand_text.end(), operands.begin(), operands.begin() + insn.operands_length);
+    instructions.push_back(insn);
+}
+
+void DisassemblyBuffer::append(const Instruction& instruction) {
+    uint8_t flags = 0;
+    if (instruction.is_jump) flags |= INSN_JUMP;
+    if (instruction.is_call) flags |= INSN_CALL;
+    if (instruction.is_return) flags |= INSN_RETURN;
+    if (instruction.target_address != 0) flags |= INSN_HAS_TARGET;
+    if (instruction.has_immediate) flags |= INSN_HAS_IMMEDIATE;
+    
+    append(instruction.address, instruction.bytes.data(), instruction.bytes.size(),
+           instruction.mnemonic, instruction.operands, flags, instruction.target_address,
+           instruction.immediate);
+}
+
+void DisassemblyBuffer::append_range(const DisassemblyBuffer& source, size_t first, size_t count) {
+    size_t last = std::min(first + count, source.size());
+    if (first >= last) return;
+    
+    // Map the source's mnemonic ids into ours once per call
+    std::vector<uint16_t> remap(source.mnemonics.size());
+    for (size_t i = 0; i < source.mnemonics.size(); ++i) {
+        remap[i] = intern_mnemonic(source.mnemonics[i]);
+    }
+    
+    instructions.reserve(instructions.size() + (last - first));
+    for (size_t i = first; i < last; ++i) {
+        PackedInstruction insn = source.instructions[i];
+        std::string_view operands = source.get_operands(insn);
+        insn.operands_offset = operand_text.size();
+        insn.mnemonic_id = remap[insn.mnemonic_id];
+        operand_text.insert(operand_text.end(), operands.begin(), operands.end());
+        instructions.push_back(insn);
+    }
+}
+
+std::string_view DisassemblyBuffer::get_mnemonic(const PackedInstruction& insn) const {
+    return mnemonics[insn.mnemonic_id];
+}
+
+std::string_view DisassemblyBuffer::get_operands(const PackedInstruction& insn) const {
+    return std::string_view(operand_text.data() + insn.operands_offset, insn.operands_length);
+}
+
+size_t DisassemblyBuffer::find_index(uint64_t address) const {
+    auto it = std::lower_bound(instructions.begin(), instructions.end(), address,
+                               [](const PackedInstruction& insn, uint64_t value) {
+                                   return insn.address < value;
+                               });
+    if (it == instructions.end() || it->address != address) {
+        return npos;
+    }
+    return static_cast<size_t>(it - instructions.begin());
+}
+
+Instruction DisassemblyBuffer::to_instruction(size_t index) const {
+    const PackedInstruction& insn = instructions[index];
+    
+    Instruction instruction;
+    instruction.address = insn.address;
+    instruction.mnemonic = std::string(get_mnemonic(insn));
+    instruction.operands = std::string(get_operands(insn));
+    instruction.bytes.assign(insn.bytes, insn.bytes + insn.size);
+    instruction.size = insn.size;
+    instruction.is_jump = insn.is_jump();
+    instruction.is_call = insn.is_call();
+    instruction.is_return = insn.is_return();
+    instruction.target_address = insn.target_address;
+    instruction.immediate = insn.immediate;
+    instruction.has_immediate = insn.has_immediate();
+    return instruction;
+}
+
+std::vector<Instruction> DisassemblyBuffer::to_instructions() const {
+    std::vector<Instruction> result;
+    result.reserve(instructions.size());
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        result.push_back(to_instruction(i));
+    }
+    return result;
+}
+
+size_t DisassemblyBuffer::memory_usage() const {
+    size_t total = instructions.capacity() * sizeof(PackedInstruction) + operand_text.capacity();
+    for (const auto& mnemonic : mnemonics) {
+        total += sizeof(std::string) + mnemonic.capacity();
+    }
+    return total;
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "elf_parser.h"
+#include "instrumentation.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
-#include <fstream>
+#include <cstring>
+#include <unordered_map>
+#include <elf.h>
 
 namespace debugger {
 
@@ -11,26 +14,30 @@ ElfParser::ElfParser() : loaded(false), info_cached(false) {
 }
 
 bool ElfParser::load_file(const std::string& filename) {
+    PERF_SCOPE("ElfParser::load_file", "elf");
     this->filename = filename;
     loaded = false;
     info_cached = false;
     last_error.clear();
+    cached_info = ElfInfo{};
+    section_headers.clear();
+    load_segments.clear();
+    symbols_by_name.clear();
+    strings.clear();
     
-    // Open file and read ELF header
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        last_error = "Failed to open file: " + filename;
+    // Map the whole file once; all later parsing reads straight from it
+    if (!file.open(filename)) {
+        last_error = file.get_last_error();
         return false;
     }
     
-    // Read ELF header (basic validation)
-    char elf_header[64];
-    file.read(elf_header, 64);
-    
-    if (file.gcount() < 16 || 
-        elf_header[0] != 0x7f || elf_header[1] != 'E' || 
-        elf_header[2] != 'L' || elf_header[3] != 'F') {
+    // Basic ELF header validation
+    ByteView header = file.view(0, 64);
+    if (header.size() < EI_NIDENT || 
+        header[0] != 0x7f || header[1] != 'E' || 
+        header[2] != 'L' || header[3] != 'F') {
         last_error = "Not a valid ELF file";
+        file.close();
         return false;
     }
     
@@ -40,178 +47,137 @@ bool ElfParser::load_file(const std::string& filename) {
     return true;
 }
 
+uint16_t ElfParser::read_u16(uint64_t offset) const {
+    ByteView bytes = file.view(offset, sizeof(uint16_t));
+    if (bytes.size() < sizeof(uint16_t)) return 0;
+    uint16_t value;
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return cached_info.is_little_endian ? value : __builtin_bswap16(value);
+}
+
+uint32_t ElfParser::read_u32(uint64_t offset) const {
+    ByteView bytes = file.view(offset, sizeof(uint32_t));
+    if (bytes.size() < sizeof(uint32_t)) return 0;
+    uint32_t value;
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return cached_info.is_little_endian ? value : __builtin_bswap32(value);
+}
+
+uint64_t ElfParser::read_u64(uint64_t offset) const {
+    ByteView bytes = file.view(offset, sizeof(uint64_t));
+    if (bytes.size() < sizeof(uint64_t)) return 0;
+    uint64_t value;
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return cached_info.is_little_endian ? value : __builtin_bswap64(value);
+}
+
 void ElfParser::cache_elf_info() {
     if (!loaded) return;
     
     cached_info.filename = filename;
     
-    // Read ELF header to get basic info
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) return;
-    
-    char header[64];
-    file.read(header, 64);
+    // Classify only a complete e_ident; a shorter file has no class or data
+    // byte to read
+    ByteView header = file.view(0, 64);
+    if (header.size() < EI_NIDENT) return;
     
     // Check 32-bit vs 64-bit
-    cached_info.is_64bit = (header[4] == 2); // EI_CLASS = ELFCLASS64
-    cached_info.is_little_endian = (header[5] == 1); // EI_DATA = ELFDATA2LSB
+    cached_info.is_64bit = (header[EI_CLASS] == ELFCLASS64);
+    cached_info.is_little_endian = (header[EI_DATA] == ELFDATA2LSB);
     
-    // Set architecture based on file
-    if (cached_info.is_64bit) {
-        cached_info.architecture = Architecture::X86_64;
-        cached_info.machine_type = "x86-64";
-    } else {
-        cached_info.architecture = Architecture::X86;
-        cached_info.machine_type = "i386";
+    // Set architecture from e_machine
+    uint16_t machine = read_u16(18);
+    cached_info.architecture = elf_machine_to_architecture(machine);
+    switch (cached_info.architecture) {
+        case Architecture::X86: cached_info.machine_type = "i386"; break;
+        case Architecture::X86_64: cached_info.machine_type = "x86-64"; break;
+        case Architecture::ARM: cached_info.machine_type = "ARM"; break;
+        case Architecture::ARM64: cached_info.machine_type = "AArch64"; break;
+        default: cached_info.machine_type = "unknown (" + std::to_string(machine) + ")"; break;
     }
     
-    // Read entry point (different offsets for 32/64-bit)
-    uint64_t entry_offset = cached_info.is_64bit ? 24 : 24;
-    file.seekg(entry_offset);
-    
-    if (cached_info.is_64bit) {
-        uint64_t entry;
-        file.read(reinterpret_cast<char*>(&entry), 8);
-        cached_info.entry_point = cached_info.is_little_endian ? entry : __builtin_bswap64(entry);
-    } else {
-        uint32_t entry;
-        file.read(reinterpret_cast<char*>(&entry), 4);
-        cached_info.entry_point = cached_info.is_little_endian ? entry : __builtin_bswap32(entry);
-    }
+    // Read entry point (e_entry is at offset 24 for both classes)
+    cached_info.entry_point = cached_info.is_64bit ? read_u64(24) : read_u32(24);
     
     std::stringstream ss;
     ss << "0x" << std::hex << cached_info.entry_point;
     cached_info.entry_point_hex = ss.str();
     
-    cached_info.file_type = "Executable";
+    switch (read_u16(16)) {
+        case 1: cached_info.file_type = "Relocatable"; break;
+        case 2: cached_info.file_type = "Executable"; break;
+        case 3: cached_info.file_type = "Shared object"; break;
+        case 4: cached_info.file_type = "Core"; break;
+        default: cached_info.file_type = "Unknown"; break;
+    }
     
-    // Read program headers to find text segment
+    parse_sections();
     parse_program_headers();
     
-    // Create basic symbol for main
-    Symbol main_symbol;
-    main_symbol.name = "main";
-    main_symbol.address = cached_info.entry_point;
-    main_symbol.size = 100;
-    main_symbol.type = "FUNC";
-    main_symbol.binding = "GLOBAL";
-    main_symbol.section_name = ".text";
-    main_symbol.is_function = true;
-    main_symbol.is_imported = false;
-    main_symbol.is_exported = true;
-    
-    cached_info.symbols.push_back(main_symbol);
+    parse_symbols();
+    parse_dynamic();
+    parse_imports_exports();
+    build_symbol_index();
     
     info_cached = true;
 }
 
 void ElfParser::parse_program_headers() {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) return;
-    
-    char header[64];
-    file.read(header, 64);
-    
     // Get program header table offset and entry size
     uint64_t ph_offset, ph_size, ph_count;
     
     if (cached_info.is_64bit) {
-        ph_offset = *reinterpret_cast<uint64_t*>(&header[32]);
-        ph_size = *reinterpret_cast<uint16_t*>(&header[54]);
-        ph_count = *reinterpret_cast<uint16_t*>(&header[56]);
-        
-        if (!cached_info.is_little_endian) {
-            ph_offset = __builtin_bswap64(ph_offset);
-            ph_size = __builtin_bswap16(ph_size);
-            ph_count = __builtin_bswap16(ph_count);
-        }
+        ph_offset = read_u64(32);
+        ph_size = read_u16(54);
+        ph_count = read_u16(56);
     } else {
-        ph_offset = *reinterpret_cast<uint32_t*>(&header[28]);
-        ph_size = *reinterpret_cast<uint16_t*>(&header[42]);
-        ph_count = *reinterpret_cast<uint16_t*>(&header[44]);
-        
-        if (!cached_info.is_little_endian) {
-            ph_offset = __builtin_bswap32(ph_offset);
-            ph_size = __builtin_bswap16(ph_size);
-            ph_count = __builtin_bswap16(ph_count);
-        }
+        ph_offset = read_u32(28);
+        ph_size = read_u16(42);
+        ph_count = read_u16(44);
     }
     
-    // Find executable segment (PT_LOAD with PF_X)
-    file.seekg(ph_offset);
+    uint64_t min_entry_size = cached_info.is_64bit ? 56 : 32;
+    if (ph_size < min_entry_size) return;
     
-    for (uint16_t i = 0; i < ph_count && i < 16; ++i) { // Limit to reasonable number
+    // Without a section header table, fall back to the executable segment
+    bool need_code_segment = cached_info.sections.empty();
+    
+    for (uint64_t i = 0; i < ph_count; ++i) {
+        uint64_t entry = ph_offset + i * ph_size;
+        if (file.view(entry, ph_size).size() < ph_size) {
+            break; // Table runs past the end of the file
+        }
+        
+        uint32_t p_type = read_u32(entry);
+        uint32_t p_flags;
+        uint64_t p_offset, p_vaddr, p_filesz;
+        
         if (cached_info.is_64bit) {
-            struct {
-                uint32_t p_type;
-                uint32_t p_flags;
-                uint64_t p_offset;
-                uint64_t p_vaddr;
-                uint64_t p_paddr;
-                uint64_t p_filesz;
-                uint64_t p_memsz;
-                uint64_t p_align;
-            } phdr;
-            
-            file.read(reinterpret_cast<char*>(&phdr), sizeof(phdr));
-            
-            if (!cached_info.is_little_endian) {
-                phdr.p_type = __builtin_bswap32(phdr.p_type);
-                phdr.p_flags = __builtin_bswap32(phdr.p_flags);
-                phdr.p_offset = __builtin_bswap64(phdr.p_offset);
-                phdr.p_vaddr = __builtin_bswap64(phdr.p_vaddr);
-                phdr.p_filesz = __builtin_bswap64(phdr.p_filesz);
-            }
-            
-            // PT_LOAD = 1, PF_X = 1
-            if (phdr.p_type == 1 && (phdr.p_flags & 1)) {
-                read_code_segment(phdr.p_offset, phdr.p_vaddr, phdr.p_filesz);
-                break;
-            }
+            p_flags = read_u32(entry + 4);
+            p_offset = read_u64(entry + 8);
+            p_vaddr = read_u64(entry + 16);
+            p_filesz = read_u64(entry + 32);
         } else {
-            struct {
-                uint32_t p_type;
-                uint32_t p_offset;
-                uint32_t p_vaddr;
-                uint32_t p_paddr;
-                uint32_t p_filesz;
-                uint32_t p_memsz;
-                uint32_t p_flags;
-                uint32_t p_align;
-            } phdr;
-            
-            file.read(reinterpret_cast<char*>(&phdr), sizeof(phdr));
-            
-            if (!cached_info.is_little_endian) {
-                phdr.p_type = __builtin_bswap32(phdr.p_type);
-                phdr.p_offset = __builtin_bswap32(phdr.p_offset);
-                phdr.p_vaddr = __builtin_bswap32(phdr.p_vaddr);
-                phdr.p_filesz = __builtin_bswap32(phdr.p_filesz);
-                phdr.p_flags = __builtin_bswap32(phdr.p_flags);
-            }
-            
-            // PT_LOAD = 1, PF_X = 1
-            if (phdr.p_type == 1 && (phdr.p_flags & 1)) {
-                read_code_segment(phdr.p_offset, phdr.p_vaddr, phdr.p_filesz);
-                break;
-            }
+            p_offset = read_u32(entry + 4);
+            p_vaddr = read_u32(entry + 8);
+            p_filesz = read_u32(entry + 16);
+            p_flags = read_u32(entry + 24);
+        }
+        
+        // PT_LOAD = 1, PF_X = 1
+        if (p_type != 1) continue;
+        load_segments.push_back(LoadSegment{p_offset, p_vaddr, p_filesz, p_flags});
+        if (need_code_segment && (p_flags & 1)) {
+            read_code_segment(p_offset, p_vaddr, p_filesz);
+            need_code_segment = false;
         }
     }
 }
 
 void ElfParser::read_code_segment(uint64_t file_offset, uint64_t vaddr, uint64_t size) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) return;
-    
-    // Limit size to reasonable amount (1MB max)
-    size = std::min(size, static_cast<uint64_t>(1024 * 1024));
-    
-    file.seekg(file_offset);
-    
     Section text_section;
     text_section.name = ".text";
     text_section.address = vaddr;
-    text_section.size = size;
     text_section.file_offset = file_offset;
     text_section.type = "PROGBITS";
     text_section.flags = "AX";
@@ -219,35 +185,441 @@ void ElfParser::read_code_segment(uint64_t file_offset, uint64_t vaddr, uint64_t
     text_section.is_writable = false;
     text_section.is_readable = true;
     
-    // Read actual binary data
-    text_section.data.resize(size);
-    file.read(reinterpret_cast<char*>(text_section.data.data()), size);
-    
-    // Store the actual read size
-    text_section.data.resize(file.gcount());
-    text_section.size = file.gcount();
+    // Reference the segment in place; the view is clamped to the file size
+    text_section.data = file.view(file_offset, size);
+    text_section.size = text_section.data.size();
     
     cached_info.sections.push_back(text_section);
 }
 
-ElfInfo ElfParser::get_elf_info() const {
+const ElfInfo& ElfParser::get_elf_info() const {
     return cached_info;
 }
 
-std::vector<Section> ElfParser::get_sections() const {
+const std::vector<Section>& ElfParser::get_sections() const {
     return cached_info.sections;
 }
 
 void ElfParser::parse_sections() {
-    // Stub implementation
+    uint64_t sh_offset, sh_size, sh_count, sh_strndx;
+    
+    if (cached_info.is_64bit) {
+        sh_offset = read_u64(40);
+        sh_size = read_u16(58);
+        sh_count = read_u16(60);
+        sh_strndx = read_u16(62);
+    } else {
+        sh_offset = read_u32(32);
+        sh_size = read_u16(46);
+        sh_count = read_u16(48);
+        sh_strndx = read_u16(50);
+    }
+    
+    uint64_t min_entry_size = cached_info.is_64bit ? 64 : 40;
+    if (sh_offset == 0 || sh_size < min_entry_size) return;
+    
+    // Huge tables keep the real count and string table index in section 0
+    if (sh_count == 0) {
+        sh_count = cached_info.is_64bit ? read_u64(sh_offset + 32) : read_u32(sh_offset + 20);
+    }
+    if (sh_strndx == 0xffff) { // SHN_XINDEX
+        sh_strndx = cached_info.is_64bit ? read_u32(sh_offset + 40) : read_u32(sh_offset + 24);
+    }
+    
+    // Reject counts the file cannot possibly hold, dividing rather than
+    // multiplying so a crafted count cannot wrap past the check
+    uint64_t file_size = file.size();
+    if (sh_offset > file_size || sh_count > (file_size - sh_offset) / sh_size) return;
+    
+    section_headers.reserve(sh_count);
+    for (uint64_t i = 0; i < sh_count; ++i) {
+        uint64_t entry = sh_offset + i * sh_size;
+        SectionHeader sh;
+        
+        sh.name = read_u32(entry);
+        sh.type = read_u32(entry + 4);
+        if (cached_info.is_64bit) {
+            sh.flags = read_u64(entry + 8);
+            sh.address = read_u64(entry + 16);
+            sh.offset = read_u64(entry + 24);
+            sh.size = read_u64(entry + 32);
+            sh.link = read_u32(entry + 40);
+            sh.info = read_u32(entry + 44);
+            sh.entry_size = read_u64(entry + 56);
+        } else {
+            sh.flags = read_u32(entry + 8);
+            sh.address = read_u32(entry + 12);
+            sh.offset = read_u32(entry + 16);
+            sh.size = read_u32(entry + 20);
+            sh.link = read_u32(entry + 24);
+            sh.info = read_u32(entry + 28);
+            sh.entry_size = read_u32(entry + 36);
+        }
+        
+        section_headers.push_back(sh);
+    }
+    
+    uint64_t strtab_offset = sh_strndx < section_headers.size() ? section_headers[sh_strndx].offset : 0;
+    
+    cached_info.sections.reserve(section_headers.size());
+    for (const auto& sh : section_headers) {
+        Section section;
+        section.name = std::string(get_string_at(strtab_offset + sh.name));
+        section.address = sh.address;
+        section.size = sh.size;
+        section.file_offset = sh.offset;
+        section.type = get_section_type_string(sh.type);
+        section.flags = get_section_flags_string(sh.flags);
+        section.is_executable = is_section_executable(sh.flags);
+        section.is_writable = is_section_writable(sh.flags);
+        section.is_readable = is_section_readable(sh.flags);
+        
+        // SHT_NOBITS (.bss and friends) occupies no file space
+        if (sh.type != 8) {
+            section.data = file.view(sh.offset, sh.size);
+        }
+        
+        cached_info.sections.push_back(section);
+    }
+}
+
+bool ElfParser::read_symbol(const SectionHeader& table, size_t index, RawSymbol& symbol) const {
+    uint64_t entry_size = cached_info.is_64bit ? 24 : 16;
+    uint64_t entry = table.offset + index * entry_size;
+    if (file.view(entry, entry_size).size() < entry_size) return false;
+    
+    symbol.name = read_u32(entry);
+    if (cached_info.is_64bit) {
+        symbol.info = file.view()[entry + 4];
+        symbol.other = file.view()[entry + 5];
+        symbol.section_index = read_u16(entry + 6);
+        symbol.value = read_u64(entry + 8);
+        symbol.size = read_u64(entry + 16);
+    } else {
+        symbol.value = read_u32(entry + 4);
+        symbol.size = read_u32(entry + 8);
+        symbol.info = file.view()[entry + 12];
+        symbol.other = file.view()[entry + 13];
+        symbol.section_index = read_u16(entry + 14);
+    }
+    return true;
+}
+
+std::string_view ElfParser::read_string(size_t strtab_index, uint32_t offset) const {
+    if (strtab_index >= section_headers.size()) return std::string_view();
+    const SectionHeader& strtab = section_headers[strtab_index];
+    if (offset >= strtab.size) return std::string_view();
+    return get_string_at(strtab.offset + offset);
+}
+
+int ElfParser::find_section_index(const std::string& name) const {
+    for (size_t i = 0; i < cached_info.sections.size(); ++i) {
+        if (cached_info.sections[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+std::string_view ElfParser::get_section_name(uint16_t section_index) {
+    switch (section_index) {
+        case 0: return std::string_view();           // SHN_UNDEF
+        case 0xfff1: return "ABS";                   // SHN_ABS
+        case 0xfff2: return "COMMON";                // SHN_COMMON
+        default: break;
+    }
+    if (section_index >= cached_info.sections.size()) return std::string_view();
+    return strings.intern(cached_info.sections[section_index].name);
 }
 
 void ElfParser::parse_symbols() {
-    // Stub implementation
+    for (size_t i = 0; i < section_headers.size(); ++i) {
+        // SHT_SYMTAB = 2, SHT_DYNSYM = 11
+        if (section_headers[i].type == 2) {
+            parse_symbol_table(i, false);
+        } else if (section_headers[i].type == 11) {
+            parse_symbol_table(i, true);
+        }
+    }
+}
+
+void ElfParser::parse_symbol_table(size_t section_index, bool is_dynamic) {
+    const SectionHeader& table = section_headers[section_index];
+    uint64_t entry_size = cached_info.is_64bit ? 24 : 16;
+    uint64_t count = table.size / entry_size;
+    
+    cached_info.symbols.reserve(cached_info.symbols.size() + count);
+    
+    // Entry 0 is always the null symbol
+    for (uint64_t i = 1; i < count; ++i) {
+        RawSymbol raw;
+        if (!read_symbol(table, i, raw)) break;
+        
+        unsigned char type = raw.info & 0xf;
+        unsigned char binding = raw.info >> 4;
+        
+        // Section and file symbols only describe the object layout
+        if (type == 3 || type == 4) continue;
+        
+        std::string_view name = read_string(table.link, raw.name);
+        if (!is_dynamic) {
+            // .symtab spells versioned symbols "name@VERSION"; drop the suffix
+            // so they merge with their .dynsym twins
+            name = name.substr(0, name.find('@'));
+        }
+        if (name.empty()) continue;
+        
+        bool is_defined = raw.section_index != 0;
+        unsigned char visibility = raw.other & 0x3;
+        
+        Symbol symbol;
+        symbol.name = strings.intern(name);
+        symbol.address = is_defined ? raw.value : 0;
+        symbol.size = raw.size;
+        symbol.type = get_symbol_type_string(type);
+        symbol.binding = get_symbol_binding_string(binding);
+        symbol.section_name = get_section_name(raw.section_index);
+        symbol.is_function = (type == 2 || type == 10); // STT_FUNC, STT_GNU_IFUNC
+        symbol.is_imported = !is_defined;
+        // Only dynamic symbols with default or protected visibility are visible to other modules
+        symbol.is_exported = is_dynamic && is_defined && binding != 0 && (visibility == 0 || visibility == 3);
+        
+        cached_info.symbols.push_back(symbol);
+    }
+}
+
+void ElfParser::parse_dynamic() {
+    for (const auto& sh : section_headers) {
+        if (sh.type != 6) continue; // SHT_DYNAMIC
+        
+        uint64_t entry_size = cached_info.is_64bit ? 16 : 8;
+        uint64_t count = sh.size / entry_size;
+        
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t entry = sh.offset + i * entry_size;
+            uint64_t tag = cached_info.is_64bit ? read_u64(entry) : read_u32(entry);
+            uint64_t value = cached_info.is_64bit ? read_u64(entry + 8) : read_u32(entry + 4);
+            
+            if (tag == 0) break; // DT_NULL
+            
+            std::string_view str = read_string(sh.link, static_cast<uint32_t>(value));
+            switch (tag) {
+                case 1: // DT_NEEDED
+                    cached_info.libraries.emplace_back(str);
+                    break;
+                case 14: // DT_SONAME
+                    cached_info.metadata["soname"] = std::string(str);
+                    break;
+                case 15: // DT_RPATH
+                    cached_info.metadata["rpath"] = std::string(str);
+                    break;
+                case 29: // DT_RUNPATH
+                    cached_info.metadata["runpath"] = std::string(str);
+                    break;
+                default:
+                    break;
+            }
+        }
+        break;
+    }
 }
 
 void ElfParser::parse_imports_exports() {
-    // Stub implementation
+    // Map symbol version indices to the library that provides them
+    // (.gnu.version = SHT_GNU_versym, .gnu.version_r = SHT_GNU_verneed)
+    int versym_index = -1;
+    std::unordered_map<uint16_t, std::string> version_libraries;
+    for (size_t i = 0; i < section_headers.size(); ++i) {
+        const SectionHeader& sh = section_headers[i];
+        if (sh.type == 0x6fffffff) {
+            versym_index = static_cast<int>(i);
+        } else if (sh.type == 0x6ffffffe) {
+            uint64_t need = sh.offset;
+            for (uint32_t n = 0; n < sh.info; ++n) {
+                uint16_t aux_count = read_u16(need + 2);
+                std::string_view library = read_string(sh.link, read_u32(need + 4));
+                uint64_t aux = need + read_u32(need + 8);
+                for (uint16_t a = 0; a < aux_count; ++a) {
+                    version_libraries[read_u16(aux + 6) & 0x7fff] = std::string(library);
+                    uint32_t next_aux = read_u32(aux + 12);
+                    if (next_aux == 0) break;
+                    aux += next_aux;
+                }
+                uint32_t next = read_u32(need + 12);
+                if (next == 0) break;
+                need += next;
+            }
+        }
+    }
+    
+    auto library_for = [&](uint64_t symbol_index) -> std::string {
+        if (versym_index >= 0) {
+            uint16_t version = read_u16(section_headers[versym_index].offset + symbol_index * 2) & 0x7fff;
+            auto it = version_libraries.find(version);
+            if (it != version_libraries.end()) return it->second;
+        }
+        return cached_info.libraries.size() == 1 ? cached_info.libraries.front() : std::string();
+    };
+    
+    // Locate PLT stubs so imported functions get a callable address
+    int plt_sec = find_section_index(".plt.sec");
+    int plt = find_section_index(".plt");
+    bool lazy_plt_layout = cached_info.architecture == Architecture::X86 ||
+                           cached_info.architecture == Architecture::X86_64 ||
+                           cached_info.architecture == Architecture::ARM64;
+    
+    std::unordered_map<std::string_view, size_t> import_by_name;
+    
+    for (size_t s = 0; s < section_headers.size(); ++s) {
+        const SectionHeader& sh = section_headers[s];
+        
+        // SHT_RELA = 4, SHT_REL = 9; only relocations against the dynamic symbol table matter here
+        if ((sh.type != 4 && sh.type != 9) || sh.link >= section_headers.size()) continue;
+        const SectionHeader& symtab = section_headers[sh.link];
+        if (symtab.type != 11) continue;
+        
+        bool is_rela = sh.type == 4;
+        uint64_t entry_size = cached_info.is_64bit ? (is_rela ? 24 : 16) : (is_rela ? 12 : 8);
+        uint64_t count = sh.size / entry_size;
+        bool is_plt = cached_info.sections[s].name == ".rela.plt" || cached_info.sections[s].name == ".rel.plt";
+        
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t entry = sh.offset + i * entry_size;
+            uint64_t r_offset = cached_info.is_64bit ? read_u64(entry) : read_u32(entry);
+            uint64_t r_info = cached_info.is_64bit ? read_u64(entry + 8) : read_u32(entry + 4);
+            uint64_t symbol_index = cached_info.is_64bit ? (r_info >> 32) : (r_info >> 8);
+            if (symbol_index == 0) continue;
+            
+            RawSymbol raw;
+            if (!read_symbol(symtab, symbol_index, raw) || raw.section_index != 0) continue;
+            
+            std::string_view symbol_name = read_string(symtab.link, raw.name);
+            if (symbol_name.empty()) continue;
+            symbol_name = strings.intern(symbol_name);
+            
+            uint64_t address = r_offset;
+            if (is_plt && lazy_plt_layout) {
+                if (plt_sec >= 0) {
+                    address = cached_info.sections[plt_sec].address + i * 16;
+                } else if (plt >= 0) {
+                    // PLT0 is one entry on x86 and two on AArch64
+                    uint64_t header = cached_info.architecture == Architecture::ARM64 ? 32 : 16;
+                    address = cached_info.sections[plt].address + header + i * 16;
+                }
+                
+                Symbol stub;
+                stub.name = strings.intern(std::string(symbol_name) + "@plt");
+                stub.address = address;
+                stub.size = 16;
+                stub.type = "FUNC";
+                stub.binding = "GLOBAL";
+                stub.section_name = strings.intern(plt_sec >= 0 ? ".plt.sec" : ".plt");
+                stub.is_function = true;
+                stub.is_imported = true;
+                stub.is_exported = false;
+                cached_info.symbols.push_back(stub);
+            }
+            
+            auto existing = import_by_name.find(symbol_name);
+            if (existing != import_by_name.end()) {
+                // Prefer the PLT stub over a GOT slot for functions that have both
+                if (is_plt) cached_info.imports[existing->second].address = address;
+                continue;
+            }
+            
+            Import import;
+            import.name = std::string(symbol_name);
+            import.library = library_for(symbol_index);
+            import.address = address;
+            import.type = std::string(is_plt ? std::string_view("FUNC") : get_symbol_type_string(raw.info & 0xf));
+            import_by_name[symbol_name] = cached_info.imports.size();
+            cached_info.imports.push_back(import);
+        }
+    }
+    
+    // Undefined dynamic symbols nobody relocates against (e.g. weak hooks)
+    for (const auto& symbol : cached_info.symbols) {
+        if (!symbol.is_imported || symbol.address != 0 || import_by_name.count(symbol.name)) continue;
+        
+        Import import;
+        import.name = std::string(symbol.name);
+        import.address = 0;
+        import.type = std::string(symbol.type);
+        import_by_name[symbol.name] = cached_info.imports.size();
+        cached_info.imports.push_back(import);
+    }
+    
+    for (const auto& symbol : cached_info.symbols) {
+        if (!symbol.is_exported) continue;
+        if (!symbol.is_function && symbol.type != "OBJECT" && symbol.type != "TLS") continue;
+        
+        Export export_item;
+        export_item.name = std::string(symbol.name);
+        export_item.address = symbol.address;
+        export_item.type = std::string(symbol.type);
+        cached_info.exports.push_back(export_item);
+    }
+}
+
+void ElfParser::build_symbol_index() {
+    auto& symbols = cached_info.symbols;
+    
+    // Stripped binaries still get a named entry point
+    bool entry_covered = false;
+    for (const auto& symbol : symbols) {
+        if (symbol.is_function && symbol.address <= cached_info.entry_point &&
+            cached_info.entry_point < symbol.address + std::max<uint64_t>(symbol.size, 1)) {
+            entry_covered = true;
+            break;
+        }
+    }
+    if (!entry_covered && cached_info.entry_point != 0) {
+        Symbol entry_symbol;
+        entry_symbol.name = strings.intern("_start");
+        entry_symbol.address = cached_info.entry_point;
+        entry_symbol.size = 0;
+        entry_symbol.type = "FUNC";
+        entry_symbol.binding = "GLOBAL";
+        entry_symbol.section_name = strings.intern(".text");
+        entry_symbol.is_function = true;
+        entry_symbol.is_imported = false;
+        entry_symbol.is_exported = false;
+        symbols.push_back(entry_symbol);
+    }
+    
+    // Sort by address; within an address the best match for a lookup
+    // (a function, then the largest) sorts last, since lookups walk backwards.
+    // Names are interned, so the data pointer groups duplicates.
+    std::sort(symbols.begin(), symbols.end(), [](const Symbol& a, const Symbol& b) {
+        if (a.address != b.address) return a.address < b.address;
+        if (a.is_function != b.is_function) return b.is_function;
+        if (a.size != b.size) return a.size < b.size;
+        return a.name.data() < b.name.data();
+    });
+    
+    // .symtab and .dynsym usually list the same symbol twice
+    size_t out = 0;
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        if (out > 0 && symbols[out - 1].address == symbols[i].address &&
+            symbols[out - 1].name.data() == symbols[i].name.data() &&
+            symbols[out - 1].size == symbols[i].size &&
+            symbols[out - 1].is_function == symbols[i].is_function) {
+            symbols[out - 1].is_exported |= symbols[i].is_exported;
+            continue;
+        }
+        symbols[out++] = symbols[i];
+    }
+    symbols.resize(out);
+    symbols.shrink_to_fit();
+    
+    symbols_by_name.resize(symbols.size());
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        symbols_by_name[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(symbols_by_name.begin(), symbols_by_name.end(), [&symbols](uint32_t a, uint32_t b) {
+        if (symbols[a].name != symbols[b].name) return symbols[a].name < symbols[b].name;
+        return a < b;
+    });
 }
 
 Section ElfParser::get_section(const std::string& name) const {
@@ -260,8 +632,17 @@ Section ElfParser::get_section(const std::string& name) const {
 }
 
 std::vector<uint8_t> ElfParser::get_section_data(const std::string& name) const {
-    Section section = get_section(name);
-    return section.data;
+    ByteView view = get_section_view(name);
+    return std::vector<uint8_t>(view.begin(), view.end());
+}
+
+ByteView ElfParser::get_section_view(const std::string& name) const {
+    for (const auto& section : cached_info.sections) {
+        if (section.name == name) {
+            return section.data;
+        }
+    }
+    return ByteView();
 }
 
 bool ElfParser::has_section(const std::string& name) const {
@@ -273,14 +654,32 @@ bool ElfParser::has_section(const std::string& name) const {
     return false;
 }
 
-std::vector<Symbol> ElfParser::get_symbols() const {
+ByteView ElfParser::get_file_view() const {
+    return file.view();
+}
+
+ByteView ElfParser::get_file_range(uint64_t file_offset, uint64_t size) const {
+    return file.view(file_offset, size);
+}
+
+std::string_view ElfParser::get_string_at(uint64_t file_offset) const {
+    // NUL-terminated string stored in the file, e.g. a string table entry
+    ByteView rest = file.view().subview(static_cast<size_t>(file_offset), SIZE_MAX);
+    if (rest.empty()) return std::string_view();
+    const void* terminator = std::memchr(rest.data(), 0, rest.size());
+    size_t length = terminator ? static_cast<const uint8_t*>(terminator) - rest.data() : rest.size();
+    return rest.subview(0, length).as_string_view();
+}
+
+const std::vector<Symbol>& ElfParser::get_symbols() const {
     return cached_info.symbols;
 }
 
 std::vector<Symbol> ElfParser::get_functions() const {
     std::vector<Symbol> functions;
     for (const auto& symbol : cached_info.symbols) {
-        if (symbol.is_function) {
+        // Undefined imports have no address to show or disassemble
+        if (symbol.is_function && symbol.address != 0) {
             functions.push_back(symbol);
         }
     }
@@ -288,18 +687,36 @@ std::vector<Symbol> ElfParser::get_functions() const {
 }
 
 Symbol ElfParser::find_symbol(const std::string& name) const {
-    for (const auto& symbol : cached_info.symbols) {
-        if (symbol.name == name) {
-            return symbol;
-        }
+    const auto& symbols = cached_info.symbols;
+    std::string_view key(name);
+    auto it = std::lower_bound(symbols_by_name.begin(), symbols_by_name.end(), key,
+                               [&symbols](uint32_t index, std::string_view value) {
+                                   return symbols[index].name < value;
+                               });
+    if (it != symbols_by_name.end() && symbols[*it].name == key) {
+        return symbols[*it];
     }
     return Symbol{}; // Return empty symbol if not found
 }
 
 Symbol ElfParser::find_symbol_by_address(uint64_t address) const {
-    for (const auto& symbol : cached_info.symbols) {
-        if (symbol.address <= address && address < symbol.address + symbol.size) {
-            return symbol;
+    // Bound the backwards walk so nested or overlapping symbols stay cheap
+    constexpr size_t kMaxCandidates = 64;
+    
+    const auto& symbols = cached_info.symbols;
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), address,
+                               [](uint64_t value, const Symbol& symbol) {
+                                   return value < symbol.address;
+                               });
+    
+    for (size_t checked = 0; it != symbols.begin() && checked < kMaxCandidates; ++checked) {
+        --it;
+        if (it->address == 0) break; // Undefined (imported) symbols
+        
+        // Zero-sized symbols only cover their own address
+        uint64_t size = std::max<uint64_t>(it->size, 1);
+        if (address < it->address + size) {
+            return *it;
         }
     }
     return Symbol{}; // Return empty symbol if not found
@@ -308,16 +725,16 @@ Symbol ElfParser::find_symbol_by_address(uint64_t address) const {
 std::string ElfParser::get_function_name(uint64_t address) const {
     Symbol symbol = find_symbol_by_address(address);
     if (!symbol.name.empty() && symbol.is_function) {
-        return symbol.name;
+        return std::string(symbol.name);
     }
     return "";
 }
 
-std::vector<Import> ElfParser::get_imports() const {
+const std::vector<Import>& ElfParser::get_imports() const {
     return cached_info.imports;
 }
 
-std::vector<Export> ElfParser::get_exports() const {
+const std::vector<Export>& ElfParser::get_exports() const {
     return cached_info.exports;
 }
 
@@ -326,8 +743,13 @@ Architecture ElfParser::detect_architecture() const {
 }
 
 Architecture ElfParser::elf_machine_to_architecture(uint16_t machine) const {
-    // Stub - always return x86_64 for now
-    return Architecture::X86_64;
+    switch (machine) {
+        case 3: return Architecture::X86;       // EM_386
+        case 62: return Architecture::X86_64;   // EM_X86_64
+        case 40: return Architecture::ARM;      // EM_ARM
+        case 183: return Architecture::ARM64;   // EM_AARCH64
+        default: return Architecture::UNKNOWN;
+    }
 }
 
 bool ElfParser::is_64bit() const {
@@ -350,53 +772,117 @@ std::vector<uint8_t> ElfParser::get_code_section_data() const {
     return get_section_data(".text");
 }
 
+ByteView ElfParser::get_code_section_view() const {
+    return get_section_view(".text");
+}
+
 uint64_t ElfParser::get_entry_point() const {
     return cached_info.entry_point;
 }
 
 uint64_t ElfParser::virtual_to_file_offset(uint64_t virtual_address) const {
-    // Simple stub implementation
-    return virtual_address - 0x400000;
+    constexpr uint64_t kPageMask = 4095;
+    for (const LoadSegment& segment : load_segments) {
+        uint64_t start = segment.address & ~kPageMask;
+        uint64_t end = segment.address + segment.file_size;
+        if (virtual_address >= start && virtual_address < end) {
+            return virtual_address - segment.address + segment.offset;
+        }
+    }
+    return ~0ULL;
 }
 
 uint64_t ElfParser::file_to_virtual_offset(uint64_t file_offset) const {
-    // Simple stub implementation
-    return file_offset + 0x400000;
+    constexpr uint64_t kPageMask = 4095;
+    for (const LoadSegment& segment : load_segments) {
+        uint64_t start = segment.offset & ~kPageMask;
+        uint64_t end = segment.offset + segment.file_size;
+        if (file_offset >= start && file_offset < end) {
+            return file_offset - segment.offset + segment.address;
+        }
+    }
+    return ~0ULL;
 }
 
 std::string ElfParser::get_section_type_string(uint32_t type) const {
-    return "PROGBITS"; // Stub
+    switch (type) {
+        case 0: return "NULL";
+        case 1: return "PROGBITS";
+        case 2: return "SYMTAB";
+        case 3: return "STRTAB";
+        case 4: return "RELA";
+        case 5: return "HASH";
+        case 6: return "DYNAMIC";
+        case 7: return "NOTE";
+        case 8: return "NOBITS";
+        case 9: return "REL";
+        case 11: return "DYNSYM";
+        case 14: return "INIT_ARRAY";
+        case 15: return "FINI_ARRAY";
+        case 16: return "PREINIT_ARRAY";
+        case 17: return "GROUP";
+        case 18: return "SYMTAB_SHNDX";
+        case 0x6ffffff6: return "GNU_HASH";
+        case 0x6ffffffd: return "VERDEF";
+        case 0x6ffffffe: return "VERNEED";
+        case 0x6fffffff: return "VERSYM";
+        default: return "UNKNOWN";
+    }
 }
 
 std::string ElfParser::get_section_flags_string(uint64_t flags) const {
-    return "AX"; // Stub
-}
-
-std::string ElfParser::get_symbol_type_string(unsigned char type) const {
-    return "FUNC"; // Stub
+    std::string result;
+    if (flags & 0x1) result += 'W';   // SHF_WRITE
+    if (flags & 0x2) result += 'A';   // SHF_ALLOC
+    if (flags & 0x4) result += 'X';   // SHF_EXECINSTR
+    if (flags & 0x10) result += 'M';  // SHF_MERGE
+    if (flags & 0x20) result += 'S';  // SHF_STRINGS
+    if (flags & 0x40) result += 'I';  // SHF_INFO_LINK
+    if (flags & 0x400) result += 'T'; // SHF_TLS
+    return result;
+}
+
+std::string_view ElfParser::get_symbol_type_string(unsigned char type) const {
+    switch (type) {
+        case 0: return "NOTYPE";
+        case 1: return "OBJECT";
+        case 2: return "FUNC";
+        case 3: return "SECTION";
+        case 4: return "FILE";
+        case 5: return "COMMON";
+        case 6: return "TLS";
+        case 10: return "IFUNC";
+        default: return "UNKNOWN";
+    }
 }
 
-std::string ElfParser::get_symbol_binding_string(unsigned char binding) const {
-    return "GLOBAL"; // Stub
+std::string_view ElfParser::get_symbol_binding_string(unsigned char binding) const {
+    switch (binding) {
+        case 0: return "LOCAL";
+        case 1: return "GLOBAL";
+        case 2: return "WEAK";
+        case 10: return "UNIQUE";
+        default: return "UNKNOWN";
+    }
 }
 
-bool ElfParser::is_section_executable(uint32_t flags) const {
-    return true; // Stub
+bool ElfParser::is_section_executable(uint64_t flags) const {
+    return (flags & 0x4) != 0; // SHF_EXECINSTR
 }
 
-bool ElfParser::is_section_writable(uint32_t flags) const {
-    return false; // Stub
+bool ElfParser::is_section_writable(uint64_t flags) const {
+    return (flags & 0x1) != 0; // SHF_WRITE
 }
 
-bool ElfParser::is_section_readable(uint32_t flags) const {
-    return true; // Stub
+bool ElfParser::is_section_readable(uint64_t flags) const {
+    return (flags & 0x2) != 0; // SHF_ALLOC
 }
 
 std::map<uint64_t, std::string> ElfParser::build_address_to_symbol_map() const {
     std::map<uint64_t, std::string> address_map;
     for (const auto& symbol : cached_info.symbols) {
         if (symbol.address != 0) {
-            address_map[symbol.address] = symbol.name;
+            address_map[symbol.address] = std::string(symbol.name);
         }
     }
     return address_map;
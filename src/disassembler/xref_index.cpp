@@ -0,0 +1,146 @@
+#include "xref_index.h"
+#include "instrumentation.h"
+#include "disassembler.h"
+#include <algorithm>
+
+namespace debugger {
+
+namespace {
+
+bool xref_less(const Xref& a, const Xref& b) {
+    return a.target != b.target ? a.target < b.target : a.source < b.source;
+}
+
+} // namespace
+
+bool XrefIndex::build(const DisassemblyBuffer& instructions,
+                      const std::vector<AddressRange>& ranges, const CancelCheck& cancelled) {
+    PERF_SCOPE("XrefIndex::build", "analysis");
+    // Instructions collected between cancellation checks
+    constexpr size_t kCollectSlice = 1 << 20;
+    
+    data_ranges = ranges;
+    std::sort(data_ranges.begin(), data_ranges.end());
+    
+    references.clear();
+    for (size_t first = 0; first < instructions.size(); first += kCollectSlice) {
+        if (cancelled && cancelled()) {
+            clear();
+            return false;
+        }
+        collect(instructions, first, kCollectSlice, references);
+    }
+    std::sort(references.begin(), references.end(), xref_less);
+    rebuild_offsets();
+    return true;
+}
+
+void XrefIndex::assign(std::vector<Xref> sorted_references, std::vector<AddressRange> ranges) {
+    references = std::move(sorted_references);
+    data_ranges = std::move(ranges);
+    rebuild_offsets();
+}
+
+void XrefIndex::update_range(uint64_t start, uint64_t end,
+                             const DisassemblyBuffer& instructions, size_t first, size_t count) {
+    references.erase(std::remove_if(references.begin(), references.end(),
+                                    [start, end](const Xref& xref) {
+                                        return xref.source >= start && xref.source < end;
+                                    }),
+                     references.end());
+    
+    // Only the new references need sorting; merge them into the existing run
+    std::vector<Xref> added;
+    collect(instructions, first, count, added);
+    std::sort(added.begin(), added.end(), xref_less);
+    
+    size_t middle = references.size();
+    references.insert(references.end(), added.begin(), added.end());
+    std::inplace_merge(references.begin(), references.begin() + middle, references.end(), xref_less);
+    rebuild_offsets();
+}
+
+void XrefIndex::clear() {
+    references.clear();
+    targets.clear();
+    offsets.clear();
+    data_ranges.clear();
+}
+
+void XrefIndex::collect(const DisassemblyBuffer& instructions, size_t first, size_t count,
+                        std::vector<Xref>& out) const {
+    size_t last = std::min(first + count, instructions.size());
+    for (size_t i = first; i < last; ++i) {
+        const PackedInstruction& insn = instructions[i];
+        
+        if (insn.has_target() && (insn.is_call() || insn.is_jump())) {
+            out.push_back({insn.target_address, insn.address, insn.is_call() ? XrefType::CALL : XrefType::JUMP});
+        }
+        if (insn.has_immediate() && is_data_address(insn.immediate)) {
+            out.push_back({insn.immediate, insn.address, XrefType::DATA});
+        }
+    }
+}
+
+bool XrefIndex::is_data_address(uint64_t address) const {
+    auto it = std::upper_bound(data_ranges.begin(), data_ranges.end(), address,
+                               [](uint64_t value, const AddressRange& range) {
+                                   return value < range.first;
+                               });
+    if (it == data_ranges.begin()) {
+        return false;
+    }
+    --it;
+    return address < it->second;
+}
+
+void XrefIndex::rebuild_offsets() {
+    targets.clear();
+    offsets.clear();
+    
+    for (size_t i = 0; i < references.size(); ++i) {
+        if (targets.empty() || targets.back() != references[i].target) {
+            targets.push_back(references[i].target);
+            offsets.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    offsets.push_back(static_cast<uint32_t>(references.size()));
+}
+
+XrefRange XrefIndex::get_references_to(uint64_t target) const {
+    auto it = std::lower_bound(targets.begin(), targets.end(), target);
+    if (it == targets.end() || *it != target) {
+        return {nullptr, nullptr};
+    }
+    
+    size_t slot = static_cast<size_t>(it - targets.begin());
+    const Xref* base = references.data();
+    return {base + offsets[slot], base + offsets[slot + 1]};
+}
+
+std::vector<uint64_t> XrefIndex::get_callers(uint64_t target) const {
+    std::vector<uint64_t> callers;
+    for (const Xref& xref : get_references_to(target)) {
+        if (xref.type == XrefType::CALL) {
+            callers.push_back(xref.source);
+        }
+    }
+    return callers;
+}
+
+size_t XrefIndex::size() const {
+    return references.size();
+}
+
+size_t XrefIndex::target_count() const {
+    return targets.size();
+}
+
+size_t XrefIndex::memory_usage() const {
+    return references.capacity() * sizeof(Xref) +
+           targets.capacity() * sizeof(uint64_t) +
+           offsets.capacity() * sizeof(uint32_t) +
+           data_ranges.capacity() * sizeof(AddressRange);
+}
+
+} // namespace debugger 
\ No newline at end of file
@@ -0,0 +1,406 @@
+#include "analysis_pipeline.h"
+#include "instrumentation.h"
+#include <QtCore/QMetaObject>
+#include <algorithm>
+
+namespace debugger {
+
+// Code sections at least this large are disassembled in parallel; smaller
+// ones are streamed so the first screen of the listing shows up right away
+static constexpr size_t kParallelDisassemblyThreshold = 4 * 1024 * 1024;
+
+AnalysisPipeline::AnalysisPipeline(ThreadPool& pool, QObject* parent)
+    : QObject(parent)
+    , pool(pool)
+    , cancel_requested(false)
+    , decompile_all(false)
+    , decompilations(std::make_shared<DecompilationCache>())
+    , stage_start_ns(0)
+    , current_run(0)
+    , running(false)
+    , completed_stages(0)
+{
+}
+
+AnalysisPipeline::~AnalysisPipeline() {
+    join_driver();
+}
+
+void AnalysisPipeline::start(const QString& filename) {
+    clear();
+    
+    running = true;
+    cancel_requested = false;
+    driver = std::thread(&AnalysisPipeline::run, this, current_run, filename.toStdString(), cache_directory, decompile_all);
+}
+
+void AnalysisPipeline::cancel() {
+    join_driver();
+    
+    // Anything the old run queued before it stopped is now stale
+    ++current_run;
+    if (running) {
+        running = false;
+        emit analysis_finished(true);
+    }
+}
+
+void AnalysisPipeline::clear() {
+    cancel();
+    results = AnalysisResults();
+    completed_stages = 0;
+}
+
+bool AnalysisPipeline::is_running() const {
+    return running;
+}
+
+void AnalysisPipeline::set_cache_directory(const QString& directory) {
+    cache_directory = directory.toStdString();
+}
+
+void AnalysisPipeline::set_decompile_all(bool enable) {
+    decompile_all = enable;
+}
+
+const AnalysisResults& AnalysisPipeline::get_results() const {
+    return results;
+}
+
+bool AnalysisPipeline::is_stage_complete(AnalysisStage stage) const {
+    return (completed_stages & (1u << static_cast<int>(stage))) != 0;
+}
+
+QString AnalysisPipeline::get_stage_name(AnalysisStage stage) {
+    switch (stage) {
+        case AnalysisStage::LOAD: return "Loading";
+        case AnalysisStage::DISASSEMBLE: return "Disassembling";
+        case AnalysisStage::FUNCTIONS: return "Discovering functions";
+        case AnalysisStage::XREFS: return "Indexing cross references";
+        case AnalysisStage::STRINGS: return "Scanning strings";
+        case AnalysisStage::DECOMPILE: return "Decompiling";
+        case AnalysisStage::DECOMPILE_ALL: return "Decompiling all functions";
+    }
+    return "Analyzing";
+}
+
+void AnalysisPipeline::join_driver() {
+    if (driver.joinable()) {
+        cancel_requested = true;
+        driver.join();
+    }
+}
+
+bool AnalysisPipeline::is_cancelled() const {
+    return cancel_requested.load(std::memory_order_relaxed);
+}
+
+void AnalysisPipeline::post(uint64_t run_id, std::function<void()> action) {
+    QMetaObject::invokeMethod(this, [this, run_id, action = std::move(action)]() {
+        if (run_id == current_run) {
+            action();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void AnalysisPipeline::begin_stage(uint64_t run_id, AnalysisStage stage) {
+    stage_start_ns = perf::now_ns();
+    post(run_id, [this, stage]() {
+        emit stage_started(stage);
+    });
+}
+
+void AnalysisPipeline::report_progress(uint64_t run_id, AnalysisStage stage, int percent) {
+    post(run_id, [this, stage, percent]() {
+        emit stage_progress(stage, percent);
+    });
+}
+
+void AnalysisPipeline::publish(uint64_t run_id, AnalysisStage stage, std::function<void(AnalysisResults&)> store) {
+    if constexpr (perf::is_compiled_in()) {
+        // Stages are few and run once per file, so the name lookup is cheap
+        uint64_t end_ns = perf::now_ns();
+        uint32_t probe = perf::register_probe("Analysis: " + get_stage_name(stage).toStdString(), "analysis",
+                                              perf::ProbeKind::TIMER);
+        perf::record_time(probe, stage_start_ns, end_ns - stage_start_ns);
+    }
+    post(run_id, [this, stage, store = std::move(store)]() {
+        store(results);
+        completed_stages |= 1u << static_cast<int>(stage);
+        emit stage_finished(stage);
+    });
+}
+
+void AnalysisPipeline::fail(uint64_t run_id, const QString& message) {
+    post(run_id, [this, message]() {
+        emit analysis_failed(message);
+    });
+    finish(run_id, false);
+}
+
+void AnalysisPipeline::finish(uint64_t run_id, bool cancelled) {
+    post(run_id, [this, cancelled]() {
+        running = false;
+        emit analysis_finished(cancelled);
+    });
+}
+
+void AnalysisPipeline::run(uint64_t run_id, std::string filename, std::string database_directory,
+                           bool decompile_everything) {
+    PERF_THREAD_NAME("Analysis");
+    // The long stages poll this between chunks so cancel() joins promptly
+    CancelCheck cancelled = [this]() { return is_cancelled(); };
+    
+    // Load
+    begin_stage(run_id, AnalysisStage::LOAD);
+    auto parser = std::make_shared<ElfParser>();
+    if (!parser->load_file(filename)) {
+        fail(run_id, QString("Failed to load ELF file: %1").arg(QString::fromStdString(parser->get_last_error())));
+        return;
+    }
+    
+    Architecture architecture = parser->detect_architecture();
+    publish(run_id, AnalysisStage::LOAD, [parser, architecture](AnalysisResults& results) {
+        results.elf_parser = parser;
+        results.architecture = architecture;
+    });
+    if (is_cancelled()) {
+        finish(run_id, true);
+        return;
+    }
+    
+    // Results from an earlier session are found by the binary's content hash.
+    // Only the header is read here; each stage below loads its own chunks.
+    AnalysisDatabase database;
+    ByteView file_view = parser->get_file_view();
+    uint64_t content_hash = 0;
+    std::string database_path;
+    if (!database_directory.empty()) {
+        content_hash = AnalysisDatabase::compute_content_hash(file_view, &pool, cancelled);
+        if (is_cancelled()) {
+            finish(run_id, true);
+            return;
+        }
+        database_path = AnalysisDatabase::get_database_path(database_directory, content_hash);
+        database.open(database_path, content_hash, file_view.size());
+    }
+    
+    // Stages that index into the listing are only reused along with it
+    bool reuse_listing = database.is_open();
+    auto mark_cached = [this, run_id](AnalysisStage stage) {
+        post(run_id, [this, stage]() {
+            results.cached_stages |= 1u << static_cast<int>(stage);
+        });
+    };
+    
+    // Disassemble. The section view points straight into the file mapping,
+    // so nothing is copied
+    Disassembler disassembler;
+    if (!disassembler.initialize(architecture)) {
+        fail(run_id, "Failed to initialize disassembler for detected architecture");
+        return;
+    }
+    
+    begin_stage(run_id, AnalysisStage::DISASSEMBLE);
+    Section code_section = parser->get_section(".text");
+    auto disassembly = std::make_shared<DisassemblyBuffer>();
+    bool disassembly_cached = reuse_listing && database.load_disassembly(*disassembly);
+    if (disassembly_cached) {
+        mark_cached(AnalysisStage::DISASSEMBLE);
+    } else if (code_section.data.size() >= kParallelDisassemblyThreshold) {
+        // Large sections are split at function starts and decoded on all cores
+        std::vector<uint64_t> split_hints;
+        for (const auto& symbol : parser->get_symbols()) {
+            if (symbol.is_function && symbol.address >= code_section.address &&
+                symbol.address < code_section.address + code_section.size) {
+                split_hints.push_back(symbol.address);
+            }
+        }
+        
+        disassembler.disassemble_parallel(code_section.data.data(), code_section.data.size(),
+                                          code_section.address, split_hints, pool, *disassembly, cancelled);
+    } else if (!code_section.data.empty()) {
+        // The views only ever see copies of each batch; this buffer keeps
+        // growing underneath them
+        int last_percent = -1;
+        disassembler.disassemble_stream(code_section.data.data(), code_section.data.size(),
+                                        code_section.address, *disassembly,
+                                        [&](const DisassemblyBuffer& buffer, size_t first, size_t count) {
+            auto batch = std::make_shared<DisassemblyBuffer>();
+            batch->append_range(buffer, first, count);
+            post(run_id, [this, batch]() {
+                emit instructions_decoded(batch);
+            });
+            
+            const PackedInstruction& last = buffer[first + count - 1];
+            int percent = static_cast<int>((last.address + last.size - code_section.address) * 100 /
+                                           code_section.data.size());
+            if (percent != last_percent) {
+                last_percent = percent;
+                report_progress(run_id, AnalysisStage::DISASSEMBLE, percent);
+            }
+            return !is_cancelled();
+        });
+    }
+    if (is_cancelled()) {
+        finish(run_id, true);
+        return;
+    }
+    publish(run_id, AnalysisStage::DISASSEMBLE, [disassembly](AnalysisResults& results) {
+        results.disassembly = disassembly;
+    });
+    reuse_listing = disassembly_cached;
+    
+    // Function discovery: recursive descent seeded with the entry point and
+    // every function symbol
+    begin_stage(run_id, AnalysisStage::FUNCTIONS);
+    auto functions = std::make_shared<std::vector<Function>>();
+    bool functions_cached = reuse_listing && database.load_functions(*functions);
+    if (functions_cached) {
+        mark_cached(AnalysisStage::FUNCTIONS);
+    } else if (!disassembly->empty()) {
+        std::vector<uint64_t> entry_points;
+        entry_points.push_back(parser->get_entry_point());
+        for (const auto& symbol : parser->get_symbols()) {
+            if (symbol.is_function && symbol.address != 0) {
+                entry_points.push_back(symbol.address);
+            }
+        }
+        
+        *functions = disassembler.analyze_functions(*disassembly, entry_points, &pool, cancelled);
+        for (auto& function : *functions) {
+            Symbol symbol = parser->find_symbol_by_address(function.start_address);
+            if (symbol.address == function.start_address && !symbol.name.empty()) {
+                function.name = std::string(symbol.name);
+            }
+        }
+    }
+    if (is_cancelled()) {
+        finish(run_id, true);
+        return;
+    }
+    publish(run_id, AnalysisStage::FUNCTIONS, [functions](AnalysisResults& results) {
+        results.functions = functions;
+    });
+    
+    // Cross references: one pass over the listing; queries never rescan it
+    begin_stage(run_id, AnalysisStage::XREFS);
+    auto xref_index = std::make_shared<XrefIndex>();
+    bool xrefs_cached = reuse_listing && database.load_xref_index(*xref_index);
+    if (xrefs_cached) {
+        mark_cached(AnalysisStage::XREFS);
+    } else {
+        std::vector<XrefIndex::AddressRange> data_ranges;
+        for (const auto& section : parser->get_sections()) {
+            if (section.address != 0 && section.size != 0) {
+                data_ranges.emplace_back(section.address, section.address + section.size);
+            }
+        }
+        xref_index->build(*disassembly, data_ranges, cancelled);
+    }
+    if (is_cancelled()) {
+        finish(run_id, true);
+        return;
+    }
+    publish(run_id, AnalysisStage::XREFS, [xref_index](AnalysisResults& results) {
+        results.xref_index = xref_index;
+    });
+    
+    // Strings: sections are scanned in chunks across the pool; offsets are
+    // file offsets so records can be decoded straight from the mapping
+    begin_stage(run_id, AnalysisStage::STRINGS);
+    auto strings = std::make_shared<std::vector<SectionStrings>>();
+    bool strings_cached = database.is_open() && database.load_strings(*strings);
+    if (strings_cached) {
+        mark_cached(AnalysisStage::STRINGS);
+    } else {
+        std::vector<ScanRegion> regions;
+        for (const auto& section : parser->get_sections()) {
+            if ((section.name == ".text" || section.name == ".rodata" || section.name == ".data") &&
+                !section.data.empty()) {
+                regions.push_back({section.data, section.file_offset});
+                strings->push_back({section.name, {}});
+            }
+        }
+        if (!regions.empty()) {
+            StringScanner scanner;
+            std::vector<std::vector<StringRecord>> records = scanner.scan_regions(regions, pool, cancelled);
+            for (size_t i = 0; i < records.size(); ++i) {
+                (*strings)[i].records = std::move(records[i]);
+            }
+        }
+    }
+    if (is_cancelled()) {
+        finish(run_id, true);
+        return;
+    }
+    publish(run_id, AnalysisStage::STRINGS, [strings](AnalysisResults& results) {
+        results.strings = strings;
+    });
+    
+    // Write back whatever had to be computed before the long decompile;
+    // save() skips chunks whose bytes match what is already on disk
+    if (!database_path.empty() && !is_cancelled() &&
+        !(disassembly_cached && functions_cached && xrefs_cached && strings_cached)) {
+        if (!disassembly_cached) database.store_disassembly(*disassembly);
+        if (!functions_cached) database.store_functions(*functions);
+        if (!xrefs_cached) database.store_xref_index(*xref_index);
+        if (!strings_cached) database.store_strings(*strings);
+        database.save(database_path, content_hash, file_view.size());
+    }
+    
+    // Decompile the function the user is most likely to start from
+    begin_stage(run_id, AnalysisStage::DECOMPILE);
+    uint64_t entry_address = parser->get_entry_point();
+    Symbol main_symbol = parser->find_symbol("main");
+    if (main_symbol.address != 0) {
+        entry_address = main_symbol.address;
+    }
+    
+    auto decompiler = std::make_shared<Decompiler>(architecture);
+    decompiler->set_xref_index(xref_index);
+    decompiler->set_functions(functions);
+    std::shared_ptr<DecompilationCache> cache = decompilations;
+    
+    DecompilationCache::Entry entry_function;
+    auto function = std::find_if(functions->begin(), functions->end(), [entry_address](const Function& f) {
+        return f.start_address == entry_address;
+    });
+    if (function != functions->end()) {
+        entry_function = cache->get(*decompiler, *function, *disassembly);
+    }
+    publish(run_id, AnalysisStage::DECOMPILE, [entry_function, decompiler, cache](AnalysisResults& results) {
+        results.entry_function = entry_function;
+        results.decompiler = decompiler;
+        results.decompilations = cache;
+    });
+    if (is_cancelled()) {
+        finish(run_id, true);
+        return;
+    }
+    
+    // Then everything else, so selecting any function later is a cache hit.
+    // Otherwise the views decompile what they show.
+    if (decompile_everything) {
+        begin_stage(run_id, AnalysisStage::DECOMPILE_ALL);
+        int last_percent = -1;
+        bool decompiled = cache->decompile_all(*decompiler, *functions, *disassembly, pool,
+                                               [&](size_t done, size_t total) {
+            int percent = static_cast<int>(done * 100 / total);
+            if (percent != last_percent) {
+                last_percent = percent;
+                report_progress(run_id, AnalysisStage::DECOMPILE_ALL, percent);
+            }
+            return !is_cancelled();
+        });
+        if (!decompiled) {
+            finish(run_id, true);
+            return;
+        }
+        publish(run_id, AnalysisStage::DECOMPILE_ALL, [](AnalysisResults&) {});
+    }
+    
+    finish(run_id, is_cancelled());
+}
+
+} // namespace debugger 
\ No newline at end of file
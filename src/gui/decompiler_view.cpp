@@ -1,105 +1,76 @@
 #include "main_window.h"
+#include "instrumentation.h"
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QApplication>
-#include <QtCore/QRegularExpression>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMetaObject>
+#include <QtCore/QPointer>
 #include <QtGui/QTextCharFormat>
 #include <QtGui/QSyntaxHighlighter>
 #include <QtGui/QTextDocument>
 #include <QtGui/QContextMenuEvent>
 #include <QtGui/QClipboard>
+#include <algorithm>
 
 namespace debugger {
 
-class CppSyntaxHighlighter : public QSyntaxHighlighter {
+// Colors the text from the decompiler's token stream. QSyntaxHighlighter
+// only asks for blocks whose text changed, and each block costs a binary
+// search plus its own tokens.
+class TokenHighlighter : public QSyntaxHighlighter {
 public:
-    explicit CppSyntaxHighlighter(QTextDocument* parent = nullptr) : QSyntaxHighlighter(parent) {
-        setup_highlighting_rules();
+    explicit TokenHighlighter(QTextDocument* parent = nullptr) : QSyntaxHighlighter(parent) {
+        formats[CodeToken::KEYWORD].setForeground(QColor(86, 156, 214));
+        formats[CodeToken::KEYWORD].setFontWeight(QFont::Bold);
+        formats[CodeToken::TYPE].setForeground(QColor(78, 201, 176));
+        formats[CodeToken::FUNCTION].setForeground(QColor(220, 220, 170));
+        formats[CodeToken::FUNCTION].setFontWeight(QFont::Bold);
+        formats[CodeToken::VARIABLE].setForeground(QColor(156, 220, 254));
+        formats[CodeToken::NUMBER].setForeground(QColor(181, 206, 168));
+        formats[CodeToken::STRING].setForeground(QColor(214, 157, 133));
+        formats[CodeToken::COMMENT].setForeground(QColor(106, 153, 85));
+        formats[CodeToken::COMMENT].setFontItalic(true);
+        formats[CodeToken::LABEL].setForeground(QColor(197, 134, 192));
+    }
+    
+    // Takes effect for text set afterwards
+    void set_function(std::shared_ptr<const DecompiledFunction> decompiled) {
+        function = std::move(decompiled);
+        // Token offsets are bytes; they only line up with document
+        // positions when the text is ASCII, which generated code is
+        usable = function && std::all_of(function->full_code.begin(), function->full_code.end(),
+                                         [](char c) { return (c & 0x80) == 0; });
     }
 
 private:
     void highlightBlock(const QString& text) override {
-        foreach (const HighlightingRule& rule, highlighting_rules) {
-            QRegularExpressionMatchIterator match_iterator = rule.pattern.globalMatch(text);
-            while (match_iterator.hasNext()) {
-                QRegularExpressionMatch match = match_iterator.next();
-                setFormat(match.capturedStart(), match.capturedLength(), rule.format);
-            }
+        if (!usable) {
+            return;
         }
-    }
-
-    void setup_highlighting_rules() {
-        HighlightingRule rule;
-
-        // Keywords
-        keyword_format.setForeground(QColor(86, 156, 214));
-        keyword_format.setFontWeight(QFont::Bold);
-        QStringList keywords;
-        keywords << "\\bint\\b" << "\\bchar\\b" << "\\bshort\\b" << "\\blong\\b"
-                << "\\bunsigned\\b" << "\\bsigned\\b" << "\\bfloat\\b" << "\\bdouble\\b"
-                << "\\bvoid\\b" << "\\bif\\b" << "\\belse\\b" << "\\bwhile\\b"
-                << "\\bfor\\b" << "\\breturn\\b" << "\\bstruct\\b" << "\\bunion\\b"
-                << "\\benum\\b" << "\\btypedef\\b" << "\\bstatic\\b" << "\\bconst\\b";
-
-        foreach (const QString& pattern, keywords) {
-            rule.pattern = QRegularExpression(pattern);
-            rule.format = keyword_format;
-            highlighting_rules.append(rule);
+        uint32_t start = static_cast<uint32_t>(currentBlock().position());
+        uint32_t end = start + static_cast<uint32_t>(text.length());
+        const std::vector<CodeToken>& tokens = function->tokens;
+        auto it = std::lower_bound(tokens.begin(), tokens.end(), start,
+                                   [](const CodeToken& token, uint32_t offset) { return token.offset < offset; });
+        for (; it != tokens.end() && it->offset < end; ++it) {
+            setFormat(static_cast<int>(it->offset - start), static_cast<int>(it->length), formats[it->kind]);
         }
-
-        // Function calls
-        function_format.setForeground(QColor(220, 220, 170));
-        function_format.setFontWeight(QFont::Bold);
-        rule.pattern = QRegularExpression("\\b[A-Za-z_][A-Za-z0-9_]*(?=\\()");
-        rule.format = function_format;
-        highlighting_rules.append(rule);
-
-        // Numbers
-        number_format.setForeground(QColor(181, 206, 168));
-        rule.pattern = QRegularExpression("\\b0[xX][0-9A-Fa-f]+\\b|\\b\\d+\\b");
-        rule.format = number_format;
-        highlighting_rules.append(rule);
-
-        // Strings
-        string_format.setForeground(QColor(214, 157, 133));
-        rule.pattern = QRegularExpression("\".*\"");
-        rule.format = string_format;
-        highlighting_rules.append(rule);
-
-        // Comments
-        comment_format.setForeground(QColor(106, 153, 85));
-        comment_format.setFontItalic(true);
-        rule.pattern = QRegularExpression("//[^\n]*");
-        rule.format = comment_format;
-        highlighting_rules.append(rule);
-
-        // Multi-line comments
-        rule.pattern = QRegularExpression("/\\*.*\\*/");
-        rule.format = comment_format;
-        highlighting_rules.append(rule);
-
-        // Variable names
-        variable_format.setForeground(QColor(156, 220, 254));
-        rule.pattern = QRegularExpression("\\b[a-z_][a-z0-9_]*\\b");
-        rule.format = variable_format;
-        highlighting_rules.append(rule);
     }
-
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
-    QVector<HighlightingRule> highlighting_rules;
-
-    QTextCharFormat keyword_format;
-    QTextCharFormat function_format;
-    QTextCharFormat comment_format;
-    QTextCharFormat string_format;
-    QTextCharFormat number_format;
-    QTextCharFormat variable_format;
+    
+    std::shared_ptr<const DecompiledFunction> function;
+    bool usable = false;
+    QTextCharFormat formats[CodeToken::LABEL + 1];
 };
 
-DecompilerView::DecompilerView(QWidget* parent) : QTextEdit(parent) {
+// Callees queued behind each function shown
+static constexpr size_t kMaxPrefetchedCallees = 32;
+
+DecompilerView::DecompilerView(QWidget* parent)
+    : QTextEdit(parent)
+    , pool(nullptr)
+    , focus_generation(std::make_shared<std::atomic<uint64_t>>(0))
+{
     // Set monospace font
     QFont font("Consolas", 10);
     font.setStyleHint(QFont::Monospace);
@@ -116,13 +87,15 @@ DecompilerView::DecompilerView(QWidget* parent) : QTextEdit(parent) {
 }
 
 void DecompilerView::set_decompiled_code(const std::string& code) {
-    QString q_code = QString::fromStdString(code);
-    setPlainText(q_code);
-    
-    // Apply syntax highlighting
-    if (syntax_highlighter) {
-        syntax_highlighter->rehighlight();
-    }
+    // Plain text carries no tokens, so it stays unhighlighted
+    syntax_highlighter->set_function(nullptr);
+    setPlainText(QString::fromStdString(code));
+}
+
+void DecompilerView::set_decompiled_function(std::shared_ptr<const DecompiledFunction> function) {
+    PERF_SCOPE("Show decompiled function", "ui");
+    syntax_highlighter->set_function(function);
+    setPlainText(QString::fromStdString(function->full_code));
 }
 
 void DecompilerView::clear_code() {
@@ -131,10 +104,11 @@ void DecompilerView::clear_code() {
 }
 
 void DecompilerView::setup_syntax_highlighting() {
-    syntax_highlighter = new CppSyntaxHighlighter(document());
+    syntax_highlighter = new TokenHighlighter(document());
 }
 
 void DecompilerView::append_decompiled_function(const std::string& function_code) {
+    syntax_highlighter->set_function(nullptr);
     if (!toPlainText().isEmpty()) {
         append("\n\n"); // Add separation between functions
     }
@@ -216,6 +190,7 @@ void DecompilerView::add_analysis_comment(const std::string& comment) {
     }
     
     current_text += QString("/* Analysis: %1 */").arg(QString::fromStdString(comment));
+    syntax_highlighter->set_function(nullptr);
     setPlainText(current_text);
     
     // Move cursor to end
@@ -246,4 +221,102 @@ void DecompilerView::find_text(const QString& text) {
     }
 }
 
+void DecompilerView::set_source(std::shared_ptr<const Decompiler> source_decompiler,
+                                std::shared_ptr<DecompilationCache> source_cache,
+                                std::shared_ptr<const std::vector<Function>> source_functions,
+                                std::shared_ptr<const DisassemblyBuffer> source_instructions, ThreadPool* source_pool) {
+    ++*focus_generation;
+    decompiler = std::move(source_decompiler);
+    cache = std::move(source_cache);
+    functions = std::move(source_functions);
+    instructions = std::move(source_instructions);
+    pool = source_pool;
+}
+
+void DecompilerView::clear_source() {
+    set_source(nullptr, nullptr, nullptr, nullptr, nullptr);
+}
+
+const Function* DecompilerView::find_function(uint64_t address) const {
+    if (!functions) {
+        return nullptr;
+    }
+    auto it = std::lower_bound(functions->begin(), functions->end(), address,
+                               [](const Function& function, uint64_t value) { return function.start_address < value; });
+    return it != functions->end() && it->start_address == address ? &*it : nullptr;
+}
+
+bool DecompilerView::show_function(uint64_t address) {
+    const Function* function = find_function(address);
+    if (!function || !decompiler || !cache || !instructions) {
+        return false;
+    }
+    uint64_t generation = ++*focus_generation;
+    
+    DecompilationCache::Entry cached = cache->find(decompiler->hash_function(*function, *instructions));
+    if (cached || !pool) {
+        set_decompiled_function(cached ? cached : cache->get(*decompiler, *function, *instructions));
+        prefetch_callees(*function, generation);
+        return true;
+    }
+    
+    set_decompiled_code("// Decompiling " + function->name + "...\n");
+    // The task holds the source alive; the view may be gone by the time it
+    // finishes, so the result is delivered through the application object
+    QPointer<DecompilerView> view(this);
+    auto source_decompiler = decompiler;
+    auto source_cache = cache;
+    auto source_functions = functions;
+    auto source_instructions = instructions;
+    pool->submit([view, generation, function, source_decompiler, source_cache, source_functions, source_instructions]() {
+        DecompilationCache::Entry decompiled = source_cache->get(*source_decompiler, *function, *source_instructions);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [view, generation, function, decompiled, source_functions]() {
+            if (view && view->focus_generation->load() == generation) {
+                view->set_decompiled_function(decompiled);
+                view->prefetch_callees(*function, generation);
+            }
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+void DecompilerView::prefetch_callees(const Function& function, uint64_t generation) {
+    if (!pool) {
+        return;
+    }
+    
+    std::vector<const Function*> callees;
+    auto collect = [&](size_t first, size_t count) {
+        size_t last = std::min(first + count, instructions->size());
+        for (size_t i = first; i < last && callees.size() < kMaxPrefetchedCallees; ++i) {
+            const PackedInstruction& insn = (*instructions)[i];
+            const Function* callee = insn.is_call() && insn.has_target() ? find_function(insn.target_address) : nullptr;
+            if (callee && callee != &function && std::find(callees.begin(), callees.end(), callee) == callees.end()) {
+                callees.push_back(callee);
+            }
+        }
+    };
+    if (function.blocks.empty()) {
+        collect(function.first_instruction, function.instruction_count);
+    } else {
+        for (const auto& block : function.blocks) {
+            collect(block.first_instruction, block.instruction_count);
+        }
+    }
+    
+    // Hashing happens on the worker too; a hit there costs next to nothing
+    auto current = focus_generation;
+    auto source_decompiler = decompiler;
+    auto source_cache = cache;
+    auto source_functions = functions;
+    auto source_instructions = instructions;
+    for (const Function* callee : callees) {
+        pool->submit([current, generation, callee, source_decompiler, source_cache, source_functions, source_instructions]() {
+            if (current->load(std::memory_order_relaxed) == generation) {
+                source_cache->get(*source_decompiler, *callee, *source_instructions);
+            }
+        });
+    }
+}
+
 } // namespace debugger 
\ No newline at end of file
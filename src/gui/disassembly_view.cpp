@@ -1,36 +1,42 @@
 #include "main_window.h"
+#include "instrumentation.h"
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QScrollBar>
-#include <QtGui/QTextCursor>
-#include <QtCore/QRegularExpression>
 #include <QtGui/QTextCharFormat>
 #include <QtGui/QPainter>
 #include <QtGui/QFontMetrics>
 #include <QtGui/QMouseEvent>
+#include <QtGui/QKeyEvent>
 #include <QtGui/QContextMenuEvent>
 #include <QtGui/QClipboard>
-#include <QtGui/QTextBlock>
+#include <algorithm>
 
 namespace debugger {
 
-// Disassembly view implementation (basic stubs)
-// The implementation is already included in main_window.cpp
+// Title, separator and a blank line precede the first instruction row
+static constexpr int kHeaderRows = 3;
+// Widest row we expect (address, bytes, mnemonic, operands, annotation)
+static constexpr int kMaxLineColumns = 140;
 
 DisassemblyView::DisassemblyView(QWidget* parent) 
-    : QTextEdit(parent), highlighted_address(0), current_line(-1) {
+    : QAbstractScrollArea(parent), loaded_count(0), loading(false), highlighted_address(0),
+      heat_total(0), heat_max(0), current_line(-1), row_height(1), char_width(1) {
     
     // Set monospace font for consistent formatting
     QFont font("Consolas", 10);
     font.setStyleHint(QFont::Monospace);
     setFont(font);
+    row_height = std::max(1, fontMetrics().height());
+    char_width = std::max(1, fontMetrics().horizontalAdvance(QLatin1Char('0')));
     
-    // Configure text edit properties
-    setReadOnly(true);
-    setLineWrapMode(QTextEdit::NoWrap);
+    // Configure scrolling; the vertical bar scrolls whole rows
+    setFocusPolicy(Qt::StrongFocus);
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    verticalScrollBar()->setSingleStep(1);
+    horizontalScrollBar()->setSingleStep(char_width);
     
     // Enable syntax highlighting
     setup_syntax_highlighting();
@@ -38,136 +44,408 @@ DisassemblyView::DisassemblyView(QWidget* parent)
     // Set up line number area
     line_number_area = new LineNumberArea(this);
     
-    // Connect signals for line number updates
-    connect(this, &QTextEdit::textChanged, this, &DisassemblyView::update_line_number_area_width);
     connect(verticalScrollBar(), &QScrollBar::valueChanged, [this]() {
         line_number_area->update();
     });
-    connect(this, &QTextEdit::cursorPositionChanged, this, &DisassemblyView::highlight_current_line);
     
     update_line_number_area_width();
-    highlight_current_line();
+    update_scroll_range();
 }
 
 void DisassemblyView::set_instructions(const std::vector<Instruction>& instructions) {
-    current_instructions = instructions;
+    auto buffer = std::make_shared<DisassemblyBuffer>();
+    buffer->reserve(instructions.size());
+    for (const auto& insn : instructions) {
+        buffer->append(insn);
+    }
+    set_instructions(std::shared_ptr<const DisassemblyBuffer>(std::move(buffer)));
+}
+
+void DisassemblyView::set_instructions(std::shared_ptr<const DisassemblyBuffer> instructions) {
+    begin_instructions(std::move(instructions));
+    append_instructions(0, current_instructions->size());
+    end_instructions();
+}
+
+void DisassemblyView::set_xref_index(std::shared_ptr<const XrefIndex> index) {
+    xref_index = std::move(index);
+}
+
+void DisassemblyView::begin_instructions(std::shared_ptr<const DisassemblyBuffer> instructions) {
+    current_instructions = std::move(instructions);
+    if (!current_instructions) {
+        current_instructions = std::make_shared<DisassemblyBuffer>();
+    }
     
-    // Build instruction lookup map for fast address-to-line mapping
-    address_to_line.clear();
-    line_to_address.clear();
+    loaded_count = 0;
+    loading = true;
+    current_line = -1;
+    verticalScrollBar()->setValue(0);
+    update_scroll_range();
+    viewport()->update();
+}
+
+void DisassemblyView::append_instructions(size_t first, size_t count) {
+    if (!current_instructions) return;
     
-    QString content;
-    content.reserve(instructions.size() * 80); // Estimate average line length
+    // Rows are drawn from the buffer on demand; only the row count changes
+    size_t last = std::min(first + count, current_instructions->size());
+    if (last <= loaded_count) return;
     
-    // Header
-    content += QString("Disassembly View - %1 instructions loaded\n")
-               .arg(instructions.size());
-    content += QString("=====================================\n\n");
+    loaded_count = last;
+    update_scroll_range();
     
-    int line_number = 3; // Start after header
+    // Repaint only if the new rows can be on screen
+    int first_visible = verticalScrollBar()->value();
+    if (static_cast<int>(first) + kHeaderRows <= first_visible + visible_row_count()) {
+        viewport()->update();
+    }
+}
+
+void DisassemblyView::end_instructions(std::shared_ptr<const DisassemblyBuffer> final_instructions) {
+    if (final_instructions) {
+        current_instructions = std::move(final_instructions);
+    }
+    loading = false;
+    if (current_instructions) {
+        loaded_count = current_instructions->size();
+    }
+    update_scroll_range();
+    viewport()->update();
+}
+
+void DisassemblyView::clear() {
+    current_instructions.reset();
+    xref_index.reset();
+    loaded_count = 0;
+    loading = false;
+    current_line = -1;
+    highlighted_address = 0;
+    heat.clear();
+    heat_total = 0;
+    heat_max = 0;
+    update_scroll_range();
+    viewport()->update();
+}
+
+int DisassemblyView::row_count() const {
+    return current_instructions ? kHeaderRows + static_cast<int>(loaded_count) : 0;
+}
+
+int DisassemblyView::visible_row_count() const {
+    return std::max(1, viewport()->height() / row_height);
+}
+
+int DisassemblyView::row_at(const QPoint& pos) const {
+    int row = verticalScrollBar()->value() + pos.y() / row_height;
+    return row >= 0 && row < row_count() ? row : -1;
+}
+
+int DisassemblyView::address_to_line(uint64_t address) const {
+    if (!current_instructions) return -1;
     
-    for (size_t i = 0; i < instructions.size(); ++i) {
-        const auto& insn = instructions[i];
-        
-        // Map address to line number
-        address_to_line[insn.address] = line_number;
-        line_to_address[line_number] = insn.address;
-        
-        // Format instruction bytes
-        QString bytes_str;
-        for (size_t j = 0; j < insn.bytes.size() && j < 8; ++j) {
-            bytes_str += QString("%1 ").arg(insn.bytes[j], 2, 16, QChar('0')).toUpper();
-        }
-        bytes_str = bytes_str.leftJustified(24); // Pad to consistent width
-        
-        // Format the instruction line
-        QString line = QString("%1:  %2 %3 %4")
-                      .arg(insn.address, 16, 16, QChar('0'))
-                      .arg(bytes_str)
-                      .arg(QString::fromStdString(insn.mnemonic).leftJustified(8))
-                      .arg(QString::fromStdString(insn.operands));
-        
-        // Add instruction type annotations
-        if (insn.is_call) {
-            line += QString("    ; CALL -> 0x%1").arg(insn.target_address, 0, 16);
-        } else if (insn.is_jump) {
-            line += QString("    ; JMP -> 0x%1").arg(insn.target_address, 0, 16);
-        } else if (insn.is_return) {
-            line += "    ; RETURN";
-        }
-        
-        content += line + "\n";
-        line_number++;
+    size_t index = current_instructions->find_index(address);
+    if (index == DisassemblyBuffer::npos || index >= loaded_count) return -1;
+    return kHeaderRows + static_cast<int>(index);
+}
+
+bool DisassemblyView::line_to_address(int line, uint64_t& address) const {
+    if (!current_instructions || line < kHeaderRows) return false;
+    
+    size_t index = static_cast<size_t>(line - kHeaderRows);
+    if (index >= loaded_count) return false;
+    address = (*current_instructions)[index].address;
+    return true;
+}
+
+void DisassemblyView::update_scroll_range() {
+    int rows = row_count();
+    verticalScrollBar()->setRange(0, std::max(0, rows - visible_row_count()));
+    verticalScrollBar()->setPageStep(visible_row_count());
+    
+    int width = kMaxLineColumns * char_width;
+    horizontalScrollBar()->setRange(0, std::max(0, width - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    
+    // The gutter grows with the number of digits in the last row number
+    if (line_number_area->width() != line_number_area_width()) {
+        update_line_number_area_width();
+    }
+    line_number_area->update();
+}
+
+void DisassemblyView::scroll_to_row(int row) {
+    int first = verticalScrollBar()->value();
+    int visible = visible_row_count();
+    if (row < first || row >= first + visible) {
+        verticalScrollBar()->setValue(row - visible / 2);
+    }
+}
+
+QString DisassemblyView::format_header_line(int row) const {
+    switch (row) {
+        case 0:
+            return loading ? QString("Disassembly View - loading...")
+                           : QString("Disassembly View - %1 instructions loaded").arg(loaded_count);
+        case 1:
+            return QString("=====================================");
+        default:
+            return QString();
+    }
+}
+
+QString DisassemblyView::format_row(int row) const {
+    uint64_t address = 0;
+    if (line_to_address(row, address)) {
+        return format_instruction_line((*current_instructions)[static_cast<size_t>(row - kHeaderRows)]);
     }
+    return format_header_line(row);
+}
+
+QString DisassemblyView::format_instruction_line(const PackedInstruction& insn) const {
+    const DisassemblyBuffer& buffer = *current_instructions;
     
-    setPlainText(content);
+    // Format instruction bytes
+    QString bytes_str;
+    for (size_t j = 0; j < insn.size && j < 8; ++j) {
+        bytes_str += QString("%1 ").arg(insn.bytes[j], 2, 16, QChar('0')).toUpper();
+    }
+    bytes_str = bytes_str.leftJustified(24); // Pad to consistent width
+    
+    std::string_view mnemonic = buffer.get_mnemonic(insn);
+    std::string_view operands = buffer.get_operands(insn);
+    
+    // Format the instruction line
+    QString line = QString("%1:  %2 %3 %4")
+                  .arg(insn.address, 16, 16, QChar('0'))
+                  .arg(bytes_str)
+                  .arg(QString::fromLatin1(mnemonic.data(), static_cast<int>(mnemonic.size())).leftJustified(8))
+                  .arg(QString::fromLatin1(operands.data(), static_cast<int>(operands.size())));
+    
+    // Add instruction type annotations
+    if (insn.is_call()) {
+        line += QString("    ; CALL -> 0x%1").arg(insn.target_address, 0, 16);
+    } else if (insn.is_jump()) {
+        line += QString("    ; JMP -> 0x%1").arg(insn.target_address, 0, 16);
+    } else if (insn.is_return()) {
+        line += "    ; RETURN";
+    }
     
-    // Apply syntax highlighting
-    apply_syntax_highlighting();
+    return line;
+}
+
+void DisassemblyView::paintEvent(QPaintEvent*) {
+    PERF_SCOPE("Paint disassembly view", "ui");
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), palette().color(QPalette::Base));
     
-    // Update line number area
-    update_line_number_area_width();
+    int first = verticalScrollBar()->value();
+    int last = std::min(row_count(), first + visible_row_count() + 1);
+    int x = -horizontalScrollBar()->value();
+    
+    for (int row = first; row < last; ++row) {
+        draw_row(painter, row, (row - first) * row_height, x);
+    }
+}
+
+void DisassemblyView::draw_row(QPainter& painter, int row, int y, int x) {
+    QRect row_rect(0, y, viewport()->width(), row_height);
+    uint64_t address = 0;
+    bool is_instruction = line_to_address(row, address);
+    
+    uint64_t samples = 0;
+    if (is_instruction && !heat.empty()) {
+        auto it = heat.find(address);
+        if (it != heat.end()) samples = it->second;
+    }
+    
+    if (is_instruction && highlighted_address != 0 && address == highlighted_address) {
+        painter.fillRect(row_rect, QColor(Qt::cyan).lighter(160));
+    } else if (row == current_line) {
+        painter.fillRect(row_rect, palette().color(QPalette::Highlight).darker(150));
+    } else if (samples != 0) {
+        // Faint for the odd sample, solid red for the hottest address
+        int alpha = 40 + static_cast<int>(180 * samples / heat_max);
+        painter.fillRect(row_rect, QColor(220, 40, 20, alpha));
+    }
+    
+    QFont base_font = font();
+    int baseline = y + fontMetrics().ascent();
+    
+    if (!is_instruction) {
+        painter.setFont(base_font);
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(x, baseline, format_header_line(row));
+        return;
+    }
+    
+    const DisassemblyBuffer& buffer = *current_instructions;
+    const PackedInstruction& insn = buffer[static_cast<size_t>(row - kHeaderRows)];
+    
+    // Same column layout as format_instruction_line(), one colour per field
+    QString bytes_str;
+    for (size_t j = 0; j < insn.size && j < 8; ++j) {
+        bytes_str += QString("%1 ").arg(insn.bytes[j], 2, 16, QChar('0')).toUpper();
+    }
+    
+    std::string_view mnemonic = buffer.get_mnemonic(insn);
+    std::string_view operands = buffer.get_operands(insn);
+    QString comment;
+    if (insn.is_call()) {
+        comment = QString("; CALL -> 0x%1").arg(insn.target_address, 0, 16);
+    } else if (insn.is_jump()) {
+        comment = QString("; JMP -> 0x%1").arg(insn.target_address, 0, 16);
+    } else if (insn.is_return()) {
+        comment = "; RETURN";
+    }
+    if (samples != 0) {
+        QString share = QString("; %1% (%2)").arg(100.0 * samples / heat_total, 0, 'f', 1).arg(samples);
+        comment = comment.isEmpty() ? share : comment + "  " + share;
+    }
+    
+    const QTextCharFormat& mnemonic_style = insn.is_call() ? call_format :
+                                            insn.is_jump() ? jump_format : mnemonic_format;
+    QString mnemonic_text = QString::fromLatin1(mnemonic.data(), static_cast<int>(mnemonic.size()));
+    QString operand_text = QString::fromLatin1(operands.data(), static_cast<int>(operands.size()));
+    int operand_column = 44 + std::max(8, mnemonic_text.size()) + 1;
+    
+    struct Field {
+        int column;
+        QString text;
+        const QTextCharFormat* format;
+    };
+    const Field fields[] = {
+        {0, QString("%1:").arg(insn.address, 16, 16, QChar('0')), &address_format},
+        {19, bytes_str, &bytes_format},
+        {44, mnemonic_text, &mnemonic_style},
+        {operand_column, operand_text, &operand_format},
+        {operand_column + operand_text.size() + 4, comment, &comment_format},
+    };
+    
+    for (const Field& field : fields) {
+        if (field.text.isEmpty()) continue;
+        
+        QFont field_font = base_font;
+        field_font.setBold(field.format->fontWeight() >= QFont::Bold);
+        field_font.setItalic(field.format->fontItalic());
+        painter.setFont(field_font);
+        painter.setPen(field.format->foreground().color());
+        painter.drawText(x + field.column * char_width, baseline, field.text);
+    }
 }
 
 void DisassemblyView::highlight_instruction(uint64_t address) {
     highlighted_address = address;
     
-    auto it = address_to_line.find(address);
-    if (it != address_to_line.end()) {
-        int line_num = it->second;
-        
-        // Move cursor to the line
-        QTextCursor cursor = textCursor();
-        cursor.movePosition(QTextCursor::Start);
-        cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, line_num - 1);
-        setTextCursor(cursor);
-        
-        // Ensure the line is visible
-        ensureCursorVisible();
-        
-        // Highlight the line
-        current_line = line_num;
-        highlight_current_line();
+    int line = address_to_line(address);
+    if (line >= 0) {
+        current_line = line;
+        scroll_to_row(line);
     }
+    highlight_current_line();
 }
 
 void DisassemblyView::clear_highlight() {
     highlighted_address = 0;
     current_line = -1;
+    viewport()->update();
+}
+
+void DisassemblyView::set_heat(std::unordered_map<uint64_t, uint64_t> address_samples, uint64_t total_samples) {
+    heat = std::move(address_samples);
+    heat_total = std::max<uint64_t>(total_samples, 1);
+    heat_max = 1;
+    for (const auto& entry : heat) {
+        heat_max = std::max(heat_max, entry.second);
+    }
+    viewport()->update();
+}
+
+void DisassemblyView::clear_heat() {
+    heat.clear();
+    heat_total = 0;
+    heat_max = 0;
+    viewport()->update();
+}
+
+bool DisassemblyView::find_text(const QString& text) {
+    int rows = row_count();
+    if (rows == 0 || text.isEmpty()) return false;
+    
+    for (int step = 1; step <= rows; ++step) {
+        int row = (std::max(current_line, -1) + step) % rows;
+        if (format_row(row).contains(text, Qt::CaseInsensitive)) {
+            current_line = row;
+            scroll_to_row(row);
+            highlight_current_line();
+            return true;
+        }
+    }
+    return false;
+}
+
+void DisassemblyView::mousePressEvent(QMouseEvent* event) {
+    QAbstractScrollArea::mousePressEvent(event);
     
-    // Clear extra selections (highlighting)
-    QList<QTextEdit::ExtraSelection> selections;
-    setExtraSelections(selections);
+    current_line = row_at(event->pos());
+    highlight_current_line();
 }
 
 void DisassemblyView::mouseDoubleClickEvent(QMouseEvent* event) {
-    QTextEdit::mouseDoubleClickEvent(event);
+    QAbstractScrollArea::mouseDoubleClickEvent(event);
     
-    // Get the line that was double-clicked
-    QTextCursor cursor = cursorForPosition(event->pos());
-    int line_number = cursor.blockNumber() + 1;
-    
-    // Find address for this line
-    auto it = line_to_address.find(line_number);
-    if (it != line_to_address.end()) {
-        uint64_t address = it->second;
-        
+    // Find address for the row that was double-clicked
+    uint64_t address = 0;
+    if (line_to_address(row_at(event->pos()), address)) {
         // Emit signal for navigation (you can connect this in MainWindow)
         emit address_double_clicked(address);
     }
 }
 
+void DisassemblyView::keyPressEvent(QKeyEvent* event) {
+    int rows = row_count();
+    int line = current_line;
+    
+    switch (event->key()) {
+        case Qt::Key_Up:       line -= 1; break;
+        case Qt::Key_Down:     line += 1; break;
+        case Qt::Key_PageUp:   line -= visible_row_count(); break;
+        case Qt::Key_PageDown: line += visible_row_count(); break;
+        case Qt::Key_Home:     line = 0; break;
+        case Qt::Key_End:      line = rows - 1; break;
+        default:
+            if (event->matches(QKeySequence::Copy) && current_line >= 0) {
+                QApplication::clipboard()->setText(format_row(current_line));
+                return;
+            }
+            QAbstractScrollArea::keyPressEvent(event);
+            return;
+    }
+    
+    if (rows == 0) return;
+    current_line = std::max(0, std::min(line, rows - 1));
+    scroll_to_row(current_line);
+    highlight_current_line();
+}
+
 void DisassemblyView::contextMenuEvent(QContextMenuEvent* event) {
-    QMenu* menu = createStandardContextMenu();
+    QMenu* menu = new QMenu(this);
     
-    // Get the line under cursor
-    QTextCursor cursor = cursorForPosition(event->pos());
-    int line_number = cursor.blockNumber() + 1;
+    // Get the row under the pointer
+    int line = row_at(event->pos());
+    if (line >= 0) {
+        current_line = line;
+        viewport()->update();
+    }
     
-    auto it = line_to_address.find(line_number);
-    if (it != line_to_address.end()) {
-        uint64_t address = it->second;
-        
+    QAction* copy_line = menu->addAction("Copy Line");
+    copy_line->setEnabled(line >= 0);
+    connect(copy_line, &QAction::triggered, [this, line] {
+        QApplication::clipboard()->setText(format_row(line));
+    });
+    
+    uint64_t address = 0;
+    if (line_to_address(line, address)) {
         menu->addSeparator();
         
         // Add breakpoint action
@@ -188,20 +466,42 @@ void DisassemblyView::contextMenuEvent(QContextMenuEvent* event) {
         });
         
         // Add analysis actions for calls/jumps
-        for (const auto& insn : current_instructions) {
-            if (insn.address == address) {
-                if (insn.is_call || insn.is_jump) {
-                    QAction* follow_action = menu->addAction(
-                        QString("Follow %1 (0x%2)")
-                        .arg(insn.is_call ? "Call" : "Jump")
-                        .arg(insn.target_address, 0, 16)
-                    );
-                    connect(follow_action, &QAction::triggered, [this, insn] {
-                        emit address_double_clicked(insn.target_address);
-                    });
-                }
+        size_t index = current_instructions ? current_instructions->find_index(address) : DisassemblyBuffer::npos;
+        if (index != DisassemblyBuffer::npos) {
+            const PackedInstruction& insn = (*current_instructions)[index];
+            if (insn.is_call() || insn.is_jump()) {
+                uint64_t target = insn.target_address;
+                QAction* follow_action = menu->addAction(
+                    QString("Follow %1 (0x%2)")
+                    .arg(insn.is_call() ? "Call" : "Jump")
+                    .arg(target, 0, 16)
+                );
+                connect(follow_action, &QAction::triggered, [this, target] {
+                    emit address_double_clicked(target);
+                });
+            }
+        }
+        
+        // References to this address come straight from the prebuilt index
+        XrefRange xrefs = xref_index ? xref_index->get_references_to(address) : XrefRange{nullptr, nullptr};
+        QMenu* xref_menu = menu->addMenu(QString("Cross References (%1)").arg(xrefs.size()));
+        xref_menu->setEnabled(!xrefs.empty());
+        
+        constexpr size_t kMaxListedXrefs = 64;
+        size_t listed = 0;
+        for (const Xref& xref : xrefs) {
+            if (listed++ == kMaxListedXrefs) {
+                xref_menu->addAction(QString("... %1 more").arg(xrefs.size() - kMaxListedXrefs))->setEnabled(false);
                 break;
             }
+            
+            const char* kind = xref.type == XrefType::CALL ? "call" :
+                               xref.type == XrefType::JUMP ? "jump" : "data";
+            uint64_t source = xref.source;
+            QAction* xref_action = xref_menu->addAction(QString("0x%1 (%2)").arg(source, 0, 16).arg(kind));
+            connect(xref_action, &QAction::triggered, [this, source] {
+                emit address_double_clicked(source);
+            });
         }
     }
     
@@ -230,101 +530,23 @@ void DisassemblyView::setup_syntax_highlighting() {
     jump_format.setFontWeight(QFont::Bold);
 }
 
-void DisassemblyView::apply_syntax_highlighting() {
-    QTextDocument* doc = document();
-    QTextCursor cursor(doc);
-    
-    // Regular expressions for different parts
-    QRegularExpression address_regex("^([0-9A-Fa-f]{16}):");
-    QRegularExpression bytes_regex(":\\s+([0-9A-Fa-f\\s]+)\\s+");
-    QRegularExpression mnemonic_regex("\\s+([a-zA-Z][a-zA-Z0-9]*)\\s+");
-    QRegularExpression comment_regex(";.*$");
-    QRegularExpression call_regex("\\b(call|CALL)\\b");
-    QRegularExpression jump_regex("\\b(j[a-zA-Z]+|JMP|JZ|JNZ|JE|JNE)\\b");
-    
-    cursor.movePosition(QTextCursor::Start);
-    
-    while (!cursor.atEnd()) {
-        cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-        QString line_text = cursor.selectedText();
-        
-        // Reset formatting for this line
-        QTextCharFormat default_format;
-        cursor.setCharFormat(default_format);
-        
-        // Apply highlighting based on patterns
-        apply_format_to_matches(cursor, line_text, address_regex, address_format);
-        apply_format_to_matches(cursor, line_text, bytes_regex, bytes_format);
-        apply_format_to_matches(cursor, line_text, call_regex, call_format);
-        apply_format_to_matches(cursor, line_text, jump_regex, jump_format);
-        apply_format_to_matches(cursor, line_text, comment_regex, comment_format);
-        
-        cursor.movePosition(QTextCursor::NextBlock);
-    }
-}
-
-void DisassemblyView::apply_format_to_matches(QTextCursor& cursor, const QString& text, 
-                                            const QRegularExpression& regex, 
-                                            const QTextCharFormat& format) {
-    QRegularExpressionMatchIterator matches = regex.globalMatch(text);
-    
-    while (matches.hasNext()) {
-        QRegularExpressionMatch match = matches.next();
-        
-        QTextCursor format_cursor = cursor;
-        format_cursor.movePosition(QTextCursor::StartOfLine);
-        format_cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, match.capturedStart());
-        format_cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, match.capturedLength());
-        
-        format_cursor.setCharFormat(format);
-    }
-}
-
 void DisassemblyView::highlight_current_line() {
-    QList<QTextEdit::ExtraSelection> selections;
-    
-    if (!isReadOnly()) {
-        QTextEdit::ExtraSelection selection;
-        
-        QColor line_color = QColor(Qt::yellow).lighter(160);
-        selection.format.setBackground(line_color);
-        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-        selection.cursor = textCursor();
-        selection.cursor.clearSelection();
-        
-        selections.append(selection);
-    }
-    
-    // Highlight the instruction at highlighted_address
-    if (highlighted_address != 0) {
-        auto it = address_to_line.find(highlighted_address);
-        if (it != address_to_line.end()) {
-            QTextEdit::ExtraSelection highlight_selection;
-            
-            QColor highlight_color = QColor(Qt::cyan).lighter(160);
-            highlight_selection.format.setBackground(highlight_color);
-            highlight_selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-            
-            // Position cursor at the highlighted line
-            QTextCursor highlight_cursor = textCursor();
-            highlight_cursor.movePosition(QTextCursor::Start);
-            highlight_cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, it->second - 1);
-            highlight_selection.cursor = highlight_cursor;
-            
-            selections.append(highlight_selection);
-        }
-    }
-    
-    setExtraSelections(selections);
+    // Selection and breakpoint/PC highlights are drawn by paintEvent()
+    viewport()->update();
+    line_number_area->update();
 }
 
 void DisassemblyView::update_line_number_area_width() {
-    setViewportMargins(line_number_area_width(), 0, 0, 0);
+    int width = line_number_area_width();
+    setViewportMargins(width, 0, 0, 0);
+    
+    QRect cr = contentsRect();
+    line_number_area->setGeometry(QRect(cr.left(), cr.top(), width, cr.height()));
 }
 
 int DisassemblyView::line_number_area_width() {
     int digits = 1;
-    int max_line = qMax(1, document()->blockCount());
+    int max_line = std::max(1, row_count());
     while (max_line >= 10) {
         max_line /= 10;
         ++digits;
@@ -338,27 +560,39 @@ void DisassemblyView::line_number_area_paint_event(QPaintEvent* event) {
     QPainter painter(line_number_area);
     painter.fillRect(event->rect(), QColor(240, 240, 240));
     
-    // Simple line number painting - just draw numbers based on visible area
-    int line_height = fontMetrics().height();
-    int lines_in_view = event->rect().height() / line_height;
+    // Numbers follow the scroll position, one per visible row
+    int first = verticalScrollBar()->value();
+    int last = std::min(row_count(), first + visible_row_count() + 1);
     
-    for (int i = 0; i < lines_in_view + 1; ++i) {
-        int y = i * line_height;
-        if (y >= event->rect().top() && y <= event->rect().bottom()) {
-            QString number = QString::number(i + 1);
-            painter.setPen(Qt::black);
+    painter.setPen(Qt::black);
+    for (int row = first; row < last; ++row) {
+        int y = (row - first) * row_height;
+        if (y + row_height >= event->rect().top() && y <= event->rect().bottom()) {
             painter.drawText(0, y, line_number_area->width(), 
-                           line_height, Qt::AlignRight, number);
+                           row_height, Qt::AlignRight, QString::number(row + 1));
         }
     }
 }
 
+void DisassemblyView::changeEvent(QEvent* event) {
+    QAbstractScrollArea::changeEvent(event);
+    
+    // Style sheets may replace the font after construction
+    if (event->type() == QEvent::FontChange) {
+        row_height = std::max(1, fontMetrics().height());
+        char_width = std::max(1, fontMetrics().horizontalAdvance(QLatin1Char('0')));
+        horizontalScrollBar()->setSingleStep(char_width);
+        update_line_number_area_width();
+        update_scroll_range();
+        viewport()->update();
+    }
+}
+
 void DisassemblyView::resizeEvent(QResizeEvent* event) {
-    QTextEdit::resizeEvent(event);
+    QAbstractScrollArea::resizeEvent(event);
     
-    QRect cr = contentsRect();
-    line_number_area->setGeometry(QRect(cr.left(), cr.top(), 
-                                      line_number_area_width(), cr.height()));
+    update_line_number_area_width();
+    update_scroll_range();
 }
 
 // LineNumberArea implementation
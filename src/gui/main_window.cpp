@@ -1,4 +1,5 @@
 #include "main_window.h"
+#include "instrumentation.h"
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
@@ -18,21 +19,38 @@
 #include <QtCore/QStandardPaths>
 #include <QtCore/QSettings>
 #include <QtCore/QDateTime>
+#include <QtCore/QStringList>
 #include <QtCore/QDebug>
+#include <algorithm>
+#include <cstring>
 
 namespace debugger {
 
+// Span of tracee memory the memory view can scroll through without re-anchoring
+static constexpr uint64_t kMemoryWindowSize = 64 * 1024;
+
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , current_architecture(Architecture::UNKNOWN)
     , current_debug_state(DebuggerState::NOT_RUNNING)
     , current_address(0)
 {
+    PERF_THREAD_NAME("GUI");
+    
     // Initialize core components
     disassembler = std::make_unique<Disassembler>();
     decompiler = std::make_unique<Decompiler>();
     debugger_engine = std::make_unique<DebuggerEngine>();
-    elf_parser = std::make_unique<ElfParser>();
+    elf_parser = std::make_shared<ElfParser>();
+    symbol_table = std::make_unique<SymbolTable>();
+    thread_pool = std::make_unique<ThreadPool>();
+    analysis_pipeline = new AnalysisPipeline(*thread_pool, this);
+    
+    // Analysis results are cached per binary so reopening skips the work
+    QString cache_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/analysis";
+    if (QDir().mkpath(cache_directory)) {
+        analysis_pipeline->set_cache_directory(cache_directory);
+    }
     
     // Setup UI
     setup_ui();
@@ -56,6 +74,15 @@ MainWindow::MainWindow(QWidget* parent)
 }
 
 MainWindow::~MainWindow() {
+    // Join the tracer thread before the window it notifies goes away
+    debugger_engine.reset();
+    
+    // The pipeline is deleted with the other children, after thread_pool is
+    // gone; stop its driver thread while the pool still exists
+    analysis_pipeline->disconnect(this);
+    analysis_pipeline->cancel();
+    // Likewise a search still running on the pool
+    search_view->clear();
     save_settings();
 }
 
@@ -96,7 +123,7 @@ void MainWindow::apply_dark_theme() {
             background-color: #4a90e2;
         }
         
-        QTextEdit {
+        QTextEdit, debugger--DisassemblyView {
             background-color: #1e1e1e;
             color: #d4d4d4;
             border: 1px solid #555555;
@@ -262,7 +289,7 @@ void MainWindow::setup_ui() {
 }
 
 void MainWindow::setup_left_panel(QSplitter* parent) {
-    QTabWidget* left_tabs = new QTabWidget();
+    left_tabs = new QTabWidget();
     
     // Functions tree
     functions_tree = new QTreeWidget();
@@ -270,11 +297,22 @@ void MainWindow::setup_left_panel(QSplitter* parent) {
     functions_tree->setAlternatingRowColors(true);
     left_tabs->addTab(functions_tree, "Functions");
     
-    // Symbols tree  
+    // Symbols tree, filtered through the symbol index as you type
+    QWidget* symbols_widget = new QWidget();
+    QVBoxLayout* symbols_layout = new QVBoxLayout(symbols_widget);
+    symbols_layout->setContentsMargins(0, 0, 0, 0);
+    symbols_filter = new QLineEdit();
+    symbols_filter->setPlaceholderText("Filter symbols (substring, or letters in order)");
+    symbols_filter->setClearButtonEnabled(true);
     symbols_tree = new QTreeWidget();
     symbols_tree->setHeaderLabel("Symbols");
     symbols_tree->setAlternatingRowColors(true);
-    left_tabs->addTab(symbols_tree, "Symbols");
+    symbols_layout->addWidget(symbols_filter);
+    symbols_layout->addWidget(symbols_tree);
+    left_tabs->addTab(symbols_widget, "Symbols");
+    symbols_filter_timer = new QTimer(this);
+    symbols_filter_timer->setSingleShot(true);
+    symbols_filter_timer->setInterval(120);
     
     // Sections table
     sections_table = new QTableWidget();
@@ -285,9 +323,17 @@ void MainWindow::setup_left_panel(QSplitter* parent) {
     sections_table->setSelectionBehavior(QAbstractItemView::SelectRows);
     left_tabs->addTab(sections_table, "Sections");
     
-    // Strings view
-    strings_view = new QTextEdit();
-    strings_view->setReadOnly(true);
+    // Strings view; rows are formatted only while on screen
+    strings_model = new StringsModel(this);
+    strings_view = new QTableView();
+    strings_view->setModel(strings_model);
+    strings_view->setAlternatingRowColors(true);
+    strings_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    strings_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    strings_view->verticalHeader()->setVisible(false);
+    strings_view->verticalHeader()->setDefaultSectionSize(18);
+    strings_view->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    strings_view->horizontalHeader()->setStretchLastSection(true);
     left_tabs->addTab(strings_view, "Strings");
     
     parent->addWidget(left_tabs);
@@ -339,20 +385,39 @@ void MainWindow::setup_right_panel(QSplitter* parent) {
     
     right_layout->addWidget(debug_controls);
     
-    QTabWidget* right_tabs = new QTabWidget();
+    right_tabs = new QTabWidget();
     
     // Registers view
     registers_view = new RegistersView();
     right_tabs->addTab(registers_view, "Registers");
     
+    // Performance view
+    performance_view = new PerformanceView();
+    right_tabs->addTab(performance_view, "Performance");
+    
     // Memory view
     memory_view = new MemoryView();
+    // Pages are pulled on demand through the engine's per-stop cache
+    memory_view->set_memory_reader([this](uint64_t address, uint8_t* buffer, size_t size) {
+        return debugger_engine->read_memory_into(address, buffer, size);
+    });
     right_tabs->addTab(memory_view, "Memory");
     
     // Breakpoints view
     breakpoint_view = new BreakpointView();
     right_tabs->addTab(breakpoint_view, "Breakpoints");
     
+    // Profiler view
+    profiler_view = new ProfilerView();
+    right_tabs->addTab(profiler_view, "Profile");
+    profile_refresh_timer = new QTimer(this);
+    profile_refresh_timer->setInterval(500);
+    
+    // Search view
+    search_view = new SearchView();
+    search_view->set_thread_pool(thread_pool.get());
+    right_tabs->addTab(search_view, "Search");
+    
     // Log view
     log_view = new QTextEdit();
     log_view->setReadOnly(true);
@@ -396,12 +461,42 @@ void MainWindow::setup_menus() {
     step_over_action->setShortcut(QKeySequence("F10"));
     connect(step_over_action, &QAction::triggered, this, &MainWindow::on_action_step_over_triggered);
     
+    debug_menu->addSeparator();
+    
+    QAction* watchpoint_action = debug_menu->addAction("Add &Watchpoint...");
+    connect(watchpoint_action, &QAction::triggered, this, &MainWindow::on_action_add_watchpoint_triggered);
+    
+    // All-stop halts every thread on any stop; non-stop halts only the one that stopped
+    QAction* non_stop_action = debug_menu->addAction("&Non-Stop Mode");
+    non_stop_action->setCheckable(true);
+    connect(non_stop_action, &QAction::toggled, this, [this](bool checked) {
+        debugger_engine->set_stop_mode(checked ? StopMode::NON_STOP : StopMode::ALL_STOP);
+        log_message(checked ? "Non-stop mode: only the stopping thread is halted" : "All-stop mode: every thread is halted on a stop");
+    });
+    
     // Tools menu
     QMenu* tools_menu = menu_bar->addMenu("&Tools");
     
+    QAction* find_action = tools_menu->addAction("&Find...");
+    find_action->setShortcut(QKeySequence::Find);
+    connect(find_action, &QAction::triggered, this, &MainWindow::on_action_find_triggered);
+    
     QAction* analyze_action = tools_menu->addAction("&Analyze Functions");
     connect(analyze_action, &QAction::triggered, this, &MainWindow::on_action_analyze_functions_triggered);
     
+    // Off: functions are decompiled as they are viewed, plus their callees
+    QAction* decompile_all_action = tools_menu->addAction("&Decompile All Functions");
+    decompile_all_action->setCheckable(true);
+    connect(decompile_all_action, &QAction::toggled, this, [this](bool checked) {
+        analysis_pipeline->set_decompile_all(checked);
+        log_message(checked ? "Every function will be decompiled when a binary is opened"
+                            : "Functions will be decompiled as they are viewed");
+    });
+    
+    cancel_analysis_action = tools_menu->addAction("&Cancel Analysis");
+    cancel_analysis_action->setEnabled(false);
+    connect(cancel_analysis_action, &QAction::triggered, this, &MainWindow::on_action_cancel_analysis_triggered);
+    
     // Help menu
     QMenu* help_menu = menu_bar->addMenu("&Help");
     QAction* about_action = help_menu->addAction("&About");
@@ -422,8 +517,13 @@ void MainWindow::setup_status_bar() {
     status_label = new QLabel("Ready");
     architecture_label = new QLabel("");
     debug_state_label = new QLabel("Not Running");
+    analysis_progress = new QProgressBar();
+    analysis_progress->setRange(0, 100);
+    analysis_progress->setMaximumWidth(240);
+    analysis_progress->hide();
     
     statusBar()->addWidget(status_label);
+    statusBar()->addPermanentWidget(analysis_progress);
     statusBar()->addPermanentWidget(architecture_label);
     statusBar()->addPermanentWidget(debug_state_label);
 }
@@ -469,6 +569,37 @@ void MainWindow::connect_signals() {
             }
         }
     });
+    
+    connect(symbols_filter, &QLineEdit::textChanged, [this]() { symbols_filter_timer->start(); });
+    connect(symbols_filter_timer, &QTimer::timeout, this, &MainWindow::filter_symbols_tree);
+    
+    // Pipeline notifications arrive already queued onto the GUI thread
+    connect(analysis_pipeline, &AnalysisPipeline::stage_started, this, &MainWindow::on_analysis_stage_started);
+    connect(analysis_pipeline, &AnalysisPipeline::stage_progress, this, &MainWindow::on_analysis_stage_progress);
+    connect(analysis_pipeline, &AnalysisPipeline::stage_finished, this, &MainWindow::on_analysis_stage_finished);
+    connect(analysis_pipeline, &AnalysisPipeline::instructions_decoded, this, &MainWindow::on_instructions_decoded);
+    connect(analysis_pipeline, &AnalysisPipeline::analysis_failed, this, &MainWindow::on_analysis_failed);
+    connect(analysis_pipeline, &AnalysisPipeline::analysis_finished, this, &MainWindow::on_analysis_finished);
+    
+    connect(breakpoint_view, &BreakpointView::breakpoint_condition_requested,
+            this, &MainWindow::on_breakpoint_condition_requested);
+    
+    connect(profiler_view, &ProfilerView::profiling_toggled, this, &MainWindow::on_profiling_toggled);
+    connect(profiler_view, &ProfilerView::export_requested, this, &MainWindow::on_profile_export_requested);
+    connect(profiler_view, &ProfilerView::navigate_to_address_requested, this, &MainWindow::navigate_to_address);
+    connect(search_view, &SearchView::navigate_to_address_requested, this, &MainWindow::navigate_to_address);
+    connect(profile_refresh_timer, &QTimer::timeout, this, &MainWindow::refresh_profile);
+    
+    // Debugger stops are reaped on the tracer thread; have it queue a drain
+    // onto the GUI thread, where the callbacks below then run
+    debugger_engine->set_breakpoint_callback([this](uint64_t address) { on_breakpoint_hit(address); });
+    debugger_engine->set_watchpoint_callback([this](uint64_t address, uint64_t pc) { on_watchpoint_hit(address, pc); });
+    debugger_engine->set_stop_callback([this](uint64_t address) { on_process_stopped(address); });
+    debugger_engine->set_signal_callback([this](int signal) { on_process_signaled(signal); });
+    debugger_engine->set_exit_callback([this](int status) { on_process_exited(status); });
+    debugger_engine->set_event_notifier([this]() {
+        QMetaObject::invokeMethod(this, [this]() { debugger_engine->process_pending_events(); }, Qt::QueuedConnection);
+    });
 }
 
 bool MainWindow::open_file(const QString& filename) {
@@ -476,60 +607,47 @@ bool MainWindow::open_file(const QString& filename) {
         return false;
     }
     
-    log_message(QString("Opening file: %1").arg(filename));
-    
-    // Try to load the ELF file
-    if (!elf_parser->load_file(filename.toStdString())) {
-        show_error(QString("Failed to load ELF file: %1").arg(QString::fromStdString(elf_parser->get_last_error())));
+    if (!QFileInfo(filename).isReadable()) {
+        show_error(QString("Cannot read file: %1").arg(filename));
         return false;
     }
     
-    current_filename = filename;
-    current_architecture = elf_parser->detect_architecture();
-    
-    // Initialize disassembler with detected architecture
-    if (!disassembler->initialize(current_architecture)) {
-        show_error("Failed to initialize disassembler for detected architecture");
-        return false;
+    if (!current_filename.isEmpty()) {
+        close_file();
     }
     
-    // Initialize decompiler
-    decompiler->set_architecture(current_architecture);
+    log_message(QString("Opening file: %1").arg(filename));
     
-    // Update UI
+    // Parsing and analysis run in the background; each stage fills in its
+    // views as it finishes
+    current_filename = filename;
     update_title();
-    update_status();
-    populate_sections_table();
-    populate_functions_tree();
-    populate_symbols_tree();
-    populate_strings_view();
-    
-    // Disassemble and display code section
-    std::vector<uint8_t> code_data = elf_parser->get_code_section_data();
-    if (!code_data.empty()) {
-        uint64_t entry_point = elf_parser->get_entry_point();
-        std::vector<Instruction> instructions = disassembler->disassemble(
-            code_data.data(), code_data.size(), entry_point);
-        disassembly_view->set_instructions(instructions);
-        
-        log_message(QString("Disassembled %1 instructions").arg(instructions.size()));
-    }
-    
-    log_message("File loaded successfully");
+    analysis_pipeline->start(filename);
     return true;
 }
 
 void MainWindow::close_file() {
+    analysis_pipeline->clear();
+    
     current_filename.clear();
     current_architecture = Architecture::UNKNOWN;
     
+    elf_parser = std::make_shared<ElfParser>();
+    code_disassembly.reset();
+    streamed_disassembly.reset();
+    xref_index.reset();
+    decompiler->set_xref_index(nullptr);
+    
     // Clear views
     disassembly_view->clear();
+    decompiler_view->clear_source();
     decompiler_view->clear_code();
+    search_view->clear();
     functions_tree->clear();
     symbols_tree->clear();
+    symbol_table->clear();
     sections_table->setRowCount(0);
-    strings_view->clear();
+    strings_model->clear();
     
     update_title();
     update_status();
@@ -654,11 +772,8 @@ void MainWindow::on_action_pause_triggered() {
     
     log_message("Pausing execution...");
     if (debugger_engine->pause_execution()) {
-        current_debug_state = DebuggerState::PAUSED;
-        debug_state_label->setText("Paused");
-        update_debug_controls();
-        refresh_views();
-        log_message("Execution paused");
+        // The views refresh once the stop is reported
+        log_message("Pause requested");
     } else {
         log_message("ERROR: Failed to pause execution");
         QMessageBox::critical(this, "Pause Error", 
@@ -682,7 +797,9 @@ void MainWindow::on_action_stop_triggered() {
             
             // Clear debug-specific views
             registers_view->set_registers({});
-            memory_view->set_memory_data(0, {});
+            memory_view->set_memory_window(0, 0);
+            profile_refresh_timer->stop();
+            profiler_view->set_profiling(false);
             
             log_message("Debug session stopped");
         } else {
@@ -702,12 +819,9 @@ void MainWindow::on_action_step_into_triggered() {
     
     log_message("Stepping into...");
     if (debugger_engine->step_into()) {
-        log_message("Step completed");
-        refresh_views();
-        
-        // Update current address
-        current_address = debugger_engine->get_instruction_pointer();
-        highlight_current_instruction(current_address);
+        // Completion arrives through on_process_stopped()
+        current_debug_state = DebuggerState::RUNNING;
+        update_debug_controls();
     } else {
         log_message("ERROR: Step failed");
         QMessageBox::warning(this, "Step Error", "Failed to step: " + QString::fromStdString(debugger_engine->get_last_error()));
@@ -722,12 +836,9 @@ void MainWindow::on_action_step_over_triggered() {
     
     log_message("Stepping over...");
     if (debugger_engine->step_over()) {
-        log_message("Step over completed");
-        refresh_views();
-        
-        // Update current address
-        current_address = debugger_engine->get_instruction_pointer();
-        highlight_current_instruction(current_address);
+        // Completion arrives through on_process_stopped()
+        current_debug_state = DebuggerState::RUNNING;
+        update_debug_controls();
     } else {
         log_message("ERROR: Step over failed");
         QMessageBox::warning(this, "Step Error", "Failed to step over: " + QString::fromStdString(debugger_engine->get_last_error()));
@@ -742,12 +853,9 @@ void MainWindow::on_action_step_out_triggered() {
     
     log_message("Stepping out of function...");
     if (debugger_engine->step_out()) {
-        log_message("Step out completed");
-        refresh_views();
-        
-        // Update current address
-        current_address = debugger_engine->get_instruction_pointer();
-        highlight_current_instruction(current_address);
+        // Completion arrives through on_process_stopped()
+        current_debug_state = DebuggerState::RUNNING;
+        update_debug_controls();
     } else {
         log_message("ERROR: Step out failed");
         QMessageBox::warning(this, "Step Error", 
@@ -776,10 +884,8 @@ void MainWindow::on_action_go_to_address_triggered() {
             
             // If debugging, also try to read memory at that address
             if (current_debug_state == DebuggerState::PAUSED) {
-                std::vector<uint8_t> memory = debugger_engine->read_memory(address, 256);
-                if (!memory.empty()) {
-                    memory_view->set_memory_data(address, memory);
-                }
+                memory_view->set_memory_window(address, kMemoryWindowSize);
+                memory_view->navigate_to_address(address);
             }
         } else {
             QMessageBox::warning(this, "Invalid Address", 
@@ -789,46 +895,11 @@ void MainWindow::on_action_go_to_address_triggered() {
 }
 
 void MainWindow::on_action_find_triggered() {
-    bool ok;
-    QString search_text = QInputDialog::getText(this, "Find", 
-                                              "Enter text to search for:", 
-                                              QLineEdit::Normal, "", &ok);
-    
-    if (ok && !search_text.isEmpty()) {
-        log_message(QString("Searching for: %1").arg(search_text));
-        
-        // Get the current active tab/view and search in it
-        QTabWidget* center_tabs = dynamic_cast<QTabWidget*>(disassembly_view->parent());
-        if (center_tabs) {
-            int current_tab = center_tabs->currentIndex();
-            
-            if (current_tab == 0) { // Disassembly view
-                QTextDocument* doc = disassembly_view->document();
-                QTextCursor cursor = doc->find(search_text, disassembly_view->textCursor());
-                
-                if (!cursor.isNull()) {
-                    disassembly_view->setTextCursor(cursor);
-                    disassembly_view->ensureCursorVisible();
-                    log_message("Found text in disassembly view");
-                } else {
-                    QMessageBox::information(this, "Find", "Text not found in disassembly view.");
-                    log_message("Text not found in disassembly view");
-                }
-            } else if (current_tab == 1) { // Decompiler view
-                QTextDocument* doc = decompiler_view->document();
-                QTextCursor cursor = doc->find(search_text, decompiler_view->textCursor());
-                
-                if (!cursor.isNull()) {
-                    decompiler_view->setTextCursor(cursor);
-                    decompiler_view->ensureCursorVisible();
-                    log_message("Found text in decompiler view");
-                } else {
-                    QMessageBox::information(this, "Find", "Text not found in decompiler view.");
-                    log_message("Text not found in decompiler view");
-                }
-            }
-        }
-    }
+    // Searches run over the whole binary in the search panel rather than
+    // over whatever text the views have rendered
+    QString selection = decompiler_view->hasFocus() ? decompiler_view->get_selected_text() : QString();
+    right_tabs->setCurrentWidget(search_view);
+    search_view->focus_query(selection);
 }
 
 void MainWindow::on_action_toggle_breakpoint_triggered() {
@@ -896,38 +967,74 @@ void MainWindow::on_action_toggle_breakpoint_triggered() {
     breakpoint_view->set_breakpoints(debugger_engine->get_breakpoints());
 }
 
+void MainWindow::on_action_add_watchpoint_triggered() {
+    if (!debugger_engine->is_process_running()) {
+        QMessageBox::information(this, "Add Watchpoint", "Start or attach to a process first.");
+        return;
+    }
+    
+    bool ok;
+    QString address_text = QInputDialog::getText(this, "Add Watchpoint",
+                                                 "Enter address to watch (hex format):",
+                                                 QLineEdit::Normal, "", &ok);
+    if (!ok || address_text.isEmpty()) {
+        return;
+    }
+    if (address_text.startsWith("0x", Qt::CaseInsensitive)) {
+        address_text.remove(0, 2);
+    }
+    uint64_t address = address_text.toULongLong(&ok, 16);
+    if (!ok) {
+        QMessageBox::warning(this, "Invalid Address", "Please enter a valid hexadecimal address.");
+        return;
+    }
+    
+    // Length and access go in the debug registers; x86 can't watch reads alone
+    const QStringList lengths = {"1", "2", "4", "8"};
+    QString length = QInputDialog::getItem(this, "Add Watchpoint", "Bytes to watch:", lengths, 3, false, &ok);
+    if (!ok) {
+        return;
+    }
+    const QStringList accesses = {"Write", "Read/Write"};
+    QString access = QInputDialog::getItem(this, "Add Watchpoint", "Stop on:", accesses, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    WatchKind kind = access == "Write" ? WatchKind::WRITE : WatchKind::READ_WRITE;
+    if (debugger_engine->add_watchpoint(address, length.toULongLong(), kind)) {
+        log_message(QString("Watching %1 bytes at 0x%2").arg(length).arg(address, 0, 16));
+    } else {
+        QMessageBox::critical(this, "Watchpoint Error",
+                              "Failed to add watchpoint: " + QString::fromStdString(debugger_engine->get_last_error()));
+    }
+    breakpoint_view->set_breakpoints(debugger_engine->get_breakpoints());
+}
+
 void MainWindow::on_action_analyze_functions_triggered() {
     if (!elf_parser->is_valid_elf()) {
         QMessageBox::warning(this, "No File", "Please load a binary file first.");
         return;
     }
     
-    log_message("Analyzing functions...");
+    // Functions were discovered by the pipeline when the file was opened
+    const AnalysisResults& results = analysis_pipeline->get_results();
+    if (!results.functions) {
+        log_message("Function discovery has not finished yet");
+        return;
+    }
     
-    // Get disassembled instructions
-    std::vector<uint8_t> code_data = elf_parser->get_code_section_data();
-    if (!code_data.empty()) {
-        uint64_t entry_point = elf_parser->get_entry_point();
-        std::vector<Instruction> instructions = disassembler->disassemble(
-            code_data.data(), code_data.size(), entry_point);
-        
-        // Analyze functions
-        std::vector<Function> functions = disassembler->analyze_functions(instructions);
-        
-        log_message(QString("Found %1 functions").arg(functions.size()));
-        
-        // Display results
-        QString result = QString("Function Analysis Results:\n\n");
-        for (const auto& func : functions) {
-            result += QString("Function: %1\n").arg(QString::fromStdString(func.name));
-            result += QString("  Start: 0x%1\n").arg(func.start_address, 0, 16);
-            result += QString("  End: 0x%1\n").arg(func.end_address, 0, 16);
-            result += QString("  Instructions: %1\n\n").arg(func.instructions.size());
-        }
-        
-        // Show in a new dialog or update decompiler view
-        decompiler_view->setPlainText(result);
+    // The functions tree already lists them; a text dump of every function
+    // doesn't scale to large binaries
+    size_t blocks = 0;
+    size_t instructions = 0;
+    for (const auto& func : *results.functions) {
+        blocks += func.blocks.size();
+        instructions += func.instruction_count;
     }
+    log_message(QString("Found %1 functions, %2 basic blocks, %3 instructions")
+                    .arg(results.functions->size()).arg(blocks).arg(instructions));
+    left_tabs->setCurrentWidget(functions_tree);
 }
 
 void MainWindow::on_action_show_strings_triggered() {
@@ -936,58 +1043,24 @@ void MainWindow::on_action_show_strings_triggered() {
         return;
     }
     
-    log_message("Extracting strings from binary...");
-    
-    // Extract strings from different sections
-    QString strings_content = "=== STRINGS ANALYSIS ===\n\n";
-    
-    // Get strings from code section
-    std::vector<uint8_t> code_data = elf_parser->get_code_section_data();
-    if (!code_data.empty()) {
-        std::vector<std::string> code_strings = disassembler->extract_strings(code_data.data(), code_data.size());
-        
-        strings_content += QString("Code Section Strings (%1 found):\n").arg(code_strings.size());
-        strings_content += "-----------------------------------\n";
-        
-        for (size_t i = 0; i < code_strings.size(); ++i) {
-            strings_content += QString("[%1] %2\n").arg(i + 1).arg(QString::fromStdString(code_strings[i]));
-        }
-        strings_content += "\n";
-    }
-    
-    // Get strings from data sections
-    std::vector<Section> sections = elf_parser->get_sections();
-    for (const auto& section : sections) {
-        if (section.name == ".rodata" || section.name == ".data" || section.name == ".bss") {
-            if (!section.data.empty()) {
-                std::vector<std::string> section_strings = disassembler->extract_strings(
-                    section.data.data(), section.data.size());
-                
-                if (!section_strings.empty()) {
-                    strings_content += QString("%1 Section Strings (%2 found):\n")
-                                     .arg(QString::fromStdString(section.name))
-                                     .arg(section_strings.size());
-                    strings_content += "-----------------------------------\n";
-                    
-                    for (size_t i = 0; i < section_strings.size(); ++i) {
-                        strings_content += QString("[%1] %2\n").arg(i + 1).arg(QString::fromStdString(section_strings[i]));
-                    }
-                    strings_content += "\n";
-                }
-            }
-        }
+    const AnalysisResults& results = analysis_pipeline->get_results();
+    if (!results.strings) {
+        log_message("String scan has not finished yet");
+        return;
     }
     
-    // Update the strings view
-    strings_view->setPlainText(strings_content);
-    
-    // Switch to the strings tab
-    QTabWidget* left_tabs = dynamic_cast<QTabWidget*>(strings_view->parent());
-    if (left_tabs) {
-        left_tabs->setCurrentWidget(strings_view);
+    // Records were collected by the pipeline and are already in the view
+    size_t total = 0;
+    for (const auto& section : *results.strings) {
+        if (!section.records.empty()) {
+            log_message(QString("%1: %2 strings").arg(QString::fromStdString(section.section_name))
+                                                   .arg(section.records.size()));
+            total += section.records.size();
+        }
     }
+    left_tabs->setCurrentWidget(strings_view);
     
-    log_message("String extraction completed");
+    log_message(QString("String extraction completed - %1 strings found").arg(total));
 }
 
 void MainWindow::on_action_show_imports_triggered() {
@@ -998,7 +1071,7 @@ void MainWindow::on_action_show_imports_triggered() {
     
     log_message("Analyzing imports...");
     
-    std::vector<Import> imports = elf_parser->get_imports();
+    const std::vector<Import>& imports = elf_parser->get_imports();
     
     QString imports_content = "=== IMPORTS ANALYSIS ===\n\n";
     imports_content += QString("Total imports found: %1\n\n").arg(imports.size());
@@ -1049,7 +1122,7 @@ void MainWindow::on_action_show_exports_triggered() {
     
     log_message("Analyzing exports...");
     
-    std::vector<Export> exports = elf_parser->get_exports();
+    const std::vector<Export>& exports = elf_parser->get_exports();
     
     QString exports_content = "=== EXPORTS ANALYSIS ===\n\n";
     exports_content += QString("Total exports found: %1\n\n").arg(exports.size());
@@ -1092,6 +1165,149 @@ void MainWindow::on_action_show_exports_triggered() {
     log_message(QString("Exports analysis completed - %1 exports found").arg(exports.size()));
 }
 
+void MainWindow::on_action_cancel_analysis_triggered() {
+    if (analysis_pipeline->is_running()) {
+        analysis_pipeline->cancel();
+    }
+}
+
+void MainWindow::on_analysis_stage_started(AnalysisStage stage) {
+    cancel_analysis_action->setEnabled(true);
+    analysis_progress->setValue(0);
+    analysis_progress->setFormat(AnalysisPipeline::get_stage_name(stage) + "... %p%");
+    analysis_progress->show();
+}
+
+void MainWindow::on_analysis_stage_progress(AnalysisStage, int percent) {
+    analysis_progress->setValue(percent);
+}
+
+void MainWindow::on_analysis_stage_finished(AnalysisStage stage) {
+    const AnalysisResults& results = analysis_pipeline->get_results();
+    analysis_progress->setValue(100);
+    
+    switch (stage) {
+        case AnalysisStage::LOAD:
+            elf_parser = results.elf_parser;
+            current_architecture = results.architecture;
+            
+            // The GUI-side disassembler only formats and answers queries
+            if (!disassembler->initialize(current_architecture)) {
+                log_message("Failed to initialize disassembler for detected architecture");
+            }
+            decompiler->set_architecture(current_architecture);
+            search_view->set_image(elf_parser);
+            
+            update_title();
+            update_status();
+            populate_sections_table();
+            populate_functions_tree();
+            populate_symbols_tree();
+            break;
+        
+        case AnalysisStage::DISASSEMBLE:
+            code_disassembly = results.disassembly;
+            if (streamed_disassembly) {
+                disassembly_view->end_instructions(code_disassembly);
+                streamed_disassembly.reset();
+            } else {
+                disassembly_view->set_instructions(code_disassembly);
+            }
+            search_view->set_instructions(code_disassembly);
+            log_message(QString("Disassembled %1 instructions").arg(code_disassembly->size()));
+            break;
+        
+        case AnalysisStage::FUNCTIONS:
+            populate_functions_tree();
+            log_message(QString("Found %1 functions").arg(results.functions->size()));
+            break;
+        
+        case AnalysisStage::XREFS:
+            xref_index = results.xref_index;
+            disassembly_view->set_xref_index(xref_index);
+            decompiler->set_xref_index(xref_index);
+            log_message(QString("Indexed %1 cross references").arg(xref_index->size()));
+            break;
+        
+        case AnalysisStage::STRINGS: {
+            size_t total = 0;
+            for (const auto& section : *results.strings) {
+                total += section.records.size();
+            }
+            populate_strings_view();
+            search_view->set_strings(results.strings);
+            log_message(QString("Found %1 strings (%2 scanner)").arg(total).arg(StringScanner::get_implementation_name()));
+            break;
+        }
+        
+        case AnalysisStage::DECOMPILE:
+            decompiler_view->set_source(results.decompiler, results.decompilations, results.functions,
+                                        code_disassembly, thread_pool.get());
+            if (results.entry_function) {
+                decompiler_view->set_decompiled_function(results.entry_function);
+            }
+            break;
+        
+        case AnalysisStage::DECOMPILE_ALL:
+            log_message(QString("Decompiled %1 functions").arg(results.functions->size()));
+            break;
+    }
+}
+
+void MainWindow::on_instructions_decoded(std::shared_ptr<const DisassemblyBuffer> batch) {
+    // The view reads from a GUI-side copy while the worker's buffer grows
+    if (!streamed_disassembly) {
+        streamed_disassembly = std::make_shared<DisassemblyBuffer>();
+        disassembly_view->begin_instructions(streamed_disassembly);
+    }
+    
+    size_t first = streamed_disassembly->size();
+    streamed_disassembly->append_range(*batch, 0, batch->size());
+    disassembly_view->append_instructions(first, batch->size());
+}
+
+void MainWindow::on_analysis_failed(const QString& message) {
+    show_error(message);
+    
+    // A failed load leaves nothing to show
+    if (!analysis_pipeline->is_stage_complete(AnalysisStage::LOAD)) {
+        current_filename.clear();
+        update_title();
+        update_status();
+    }
+}
+
+void MainWindow::on_analysis_finished(bool cancelled) {
+    analysis_progress->hide();
+    cancel_analysis_action->setEnabled(false);
+    
+    if (cancelled) {
+        // Keep whatever was published; a half-streamed listing is finished as is
+        if (streamed_disassembly) {
+            disassembly_view->end_instructions();
+        }
+        log_message("Analysis cancelled");
+    } else if (analysis_pipeline->is_stage_complete(AnalysisStage::LOAD)) {
+        uint32_t cached = analysis_pipeline->get_results().cached_stages;
+        if (cached != 0) {
+            static const std::pair<AnalysisStage, const char*> kCachedNames[] = {
+                {AnalysisStage::DISASSEMBLE, "disassembly"},
+                {AnalysisStage::FUNCTIONS, "functions"},
+                {AnalysisStage::XREFS, "cross references"},
+                {AnalysisStage::STRINGS, "strings"},
+            };
+            QStringList stages;
+            for (const auto& entry : kCachedNames) {
+                if (cached & (1u << static_cast<int>(entry.first))) {
+                    stages << entry.second;
+                }
+            }
+            log_message("Reused from analysis cache: " + stages.join(", "));
+        }
+        log_message("File loaded successfully");
+    }
+}
+
 void MainWindow::update_debug_state() {
     // Get current debugger state
     DebuggerState state = debugger_engine->get_state();
@@ -1127,12 +1343,106 @@ void MainWindow::update_debug_state() {
         current_address = debugger_engine->get_instruction_pointer();
         highlight_current_instruction(current_address);
         
+        // From the tracer reaping the stop to the views holding its state
+        uint64_t stop_time = debugger_engine->get_last_stop_time();
+        if (stop_time != 0) {
+            PERF_RECORD_SINCE("Stop to UI", "ui", stop_time);
+        }
+        
         log_message(QString("Debug state updated - current address: 0x%1").arg(current_address, 0, 16));
     }
 }
 
 void MainWindow::on_breakpoint_hit(uint64_t address) {
-    log_message(QString("Breakpoint hit at 0x%1").arg(address, 0, 16));
+    log_message(QString("Breakpoint hit at 0x%1 (thread %2)").arg(address, 0, 16).arg(debugger_engine->get_current_thread()));
+    update_debug_state();
+}
+
+void MainWindow::on_watchpoint_hit(uint64_t address, uint64_t pc) {
+    log_message(QString("Watchpoint on 0x%1 hit at 0x%2 (thread %3)")
+                .arg(address, 0, 16).arg(pc, 0, 16).arg(debugger_engine->get_current_thread()));
+    update_debug_state();
+}
+
+void MainWindow::on_process_stopped(uint64_t address) {
+    log_message(QString("Stopped at 0x%1 (thread %2)").arg(address, 0, 16).arg(debugger_engine->get_current_thread()));
+    update_debug_state();
+}
+
+void MainWindow::on_process_signaled(int signal) {
+    log_message(QString("Thread %1 received signal %2 (%3)").arg(debugger_engine->get_current_thread()).arg(signal).arg(strsignal(signal)));
+    update_debug_state();
+}
+
+void MainWindow::on_breakpoint_condition_requested(uint64_t address, const QString& condition) {
+    if (!debugger_engine->add_conditional_breakpoint(address, condition.toStdString())) {
+        QMessageBox::warning(this, "Breakpoint Condition",
+                             QString::fromStdString(debugger_engine->get_last_error()));
+        return;
+    }
+    
+    if (condition.isEmpty()) {
+        log_message(QString("Breakpoint at 0x%1 is unconditional").arg(address, 0, 16));
+    } else {
+        log_message(QString("Breakpoint at 0x%1 stops when %2").arg(address, 0, 16).arg(condition));
+    }
+    breakpoint_view->set_breakpoints(debugger_engine->get_breakpoints());
+}
+
+void MainWindow::on_process_exited(int status) {
+    log_message(QString("Process exited with status %1").arg(status));
+    update_debug_state();
+    
+    // The engine named the samples before the image went away
+    if (profile_refresh_timer->isActive()) {
+        profile_refresh_timer->stop();
+        refresh_profile();
+        profiler_view->set_profiling(false);
+    }
+    
+    // Clear debug-specific views
+    registers_view->set_registers({});
+    memory_view->set_memory_window(0, 0);
+}
+
+void MainWindow::on_profiling_toggled(bool enabled, unsigned frequency_hz) {
+    if (!enabled) {
+        debugger_engine->stop_profiling();
+        profile_refresh_timer->stop();
+        refresh_profile();
+        profiler_view->set_profiling(false);
+        log_message("Profiling stopped");
+        return;
+    }
+    
+    if (!debugger_engine->start_profiling(frequency_hz)) {
+        show_error(QString("Failed to start profiling: %1").arg(QString::fromStdString(debugger_engine->get_last_error())));
+        return;
+    }
+    disassembly_view->clear_heat();
+    profiler_view->set_profiling(true);
+    profile_refresh_timer->start();
+    log_message(QString("Profiling at %1 Hz").arg(frequency_hz));
+}
+
+void MainWindow::on_profile_export_requested() {
+    QString path = QFileDialog::getSaveFileName(this, "Export Folded Stacks", "profile.folded",
+                                                "Folded stacks (*.folded *.txt);;All Files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    if (debugger_engine->export_folded_stacks(path.toStdString())) {
+        log_message(QString("Exported folded stacks to %1").arg(path));
+    } else {
+        show_error(QString::fromStdString(debugger_engine->get_last_error()));
+    }
+}
+
+void MainWindow::refresh_profile() {
+    ProfileSummary profile = debugger_engine->get_profile();
+    profiler_view->set_profile(profile);
+    disassembly_view->set_heat(std::move(profile.address_samples), profile.samples);
 }
 
 void MainWindow::on_function_selected(uint64_t address) {
@@ -1148,20 +1458,23 @@ void MainWindow::refresh_views() {
     if (current_debug_state != DebuggerState::PAUSED) {
         return;
     }
+    PERF_SCOPE("Refresh debug views", "ui");
     
     try {
         // Update registers view
         std::vector<Register> registers = debugger_engine->get_registers();
         registers_view->set_registers(registers);
         
-        // Update memory view - show memory around current instruction pointer
+        // Update memory view - keep a window around the instruction pointer and
+        // only re-read (and repaint changes in) the rows that are on screen
         uint64_t ip = debugger_engine->get_instruction_pointer();
         if (ip != 0) {
-            // Read 512 bytes around the current instruction pointer
-            uint64_t start_addr = (ip >= 256) ? ip - 256 : 0;
-            std::vector<uint8_t> memory = debugger_engine->read_memory(start_addr, 512);
-            if (!memory.empty()) {
-                memory_view->set_memory_data(start_addr, memory);
+            uint64_t start_addr = (ip >= kMemoryWindowSize / 2) ? ip - kMemoryWindowSize / 2 : 0;
+            if (!memory_view->is_address_in_window(ip)) {
+                memory_view->set_memory_window(start_addr, kMemoryWindowSize);
+                memory_view->navigate_to_address(ip);
+            } else {
+                memory_view->update_display();
             }
         }
         
@@ -1202,15 +1515,29 @@ void MainWindow::populate_functions_tree() {
     functions_tree->clear();
     
     if (elf_parser->is_valid_elf()) {
-        std::vector<Symbol> functions = elf_parser->get_functions();
-        for (const auto& func : functions) {
-            QTreeWidgetItem* item = new QTreeWidgetItem();
-            item->setText(0, QString::fromStdString(func.name));
-            item->setToolTip(0, QString("Address: 0x%1, Size: %2 bytes").arg(func.address, 0, 16).arg(func.size));
-            functions_tree->addTopLevelItem(item);
+        // Discovered functions replace the symbol list once they are available
+        const AnalysisResults& results = analysis_pipeline->get_results();
+        if (results.functions) {
+            for (const auto& func : *results.functions) {
+                QTreeWidgetItem* item = new QTreeWidgetItem();
+                item->setText(0, QString::fromStdString(func.name));
+                item->setToolTip(0, QString("Address: 0x%1, Size: %2 bytes, Blocks: %3")
+                                        .arg(func.start_address, 0, 16)
+                                        .arg(func.end_address - func.start_address)
+                                        .arg(func.blocks.size()));
+                functions_tree->addTopLevelItem(item);
+            }
+        } else {
+            std::vector<Symbol> functions = elf_parser->get_functions();
+            for (const auto& func : functions) {
+                QTreeWidgetItem* item = new QTreeWidgetItem();
+                item->setText(0, QString::fromUtf8(func.name.data(), static_cast<int>(func.name.size())));
+                item->setToolTip(0, QString("Address: 0x%1, Size: %2 bytes").arg(func.address, 0, 16).arg(func.size));
+                functions_tree->addTopLevelItem(item);
+            }
         }
         
-        if (functions.empty()) {
+        if (functions_tree->topLevelItemCount() == 0) {
             QTreeWidgetItem* item = new QTreeWidgetItem();
             item->setText(0, "No functions found");
             functions_tree->addTopLevelItem(item);
@@ -1219,24 +1546,48 @@ void MainWindow::populate_functions_tree() {
 }
 
 void MainWindow::populate_symbols_tree() {
+    symbol_table->clear();
+    if (elf_parser->is_valid_elf()) {
+        symbol_table->add_elf_symbols(*elf_parser);
+    }
+    filter_symbols_tree();
+}
+
+void MainWindow::filter_symbols_tree() {
+    // Only the best matches become items; the tree itself doesn't scale to
+    // every symbol of a large binary
+    constexpr size_t kMaxListedSymbols = 5000;
+    
+    symbols_tree->setUpdatesEnabled(false);
     symbols_tree->clear();
     
-    if (elf_parser->is_valid_elf()) {
-        std::vector<Symbol> symbols = elf_parser->get_symbols();
-        for (const auto& symbol : symbols) {
-            QTreeWidgetItem* item = new QTreeWidgetItem();
-            item->setText(0, QString::fromStdString(symbol.name));
-            item->setToolTip(0, QString("Type: %1, Address: 0x%2").arg(QString::fromStdString(symbol.type)).arg(symbol.address, 0, 16));
-            symbols_tree->addTopLevelItem(item);
-        }
+    std::string query = symbols_filter->text().trimmed().toStdString();
+    std::vector<SymbolTable::SearchResult> matches = symbol_table->search(query, kMaxListedSymbols, true);
+    QList<QTreeWidgetItem*> items;
+    items.reserve(static_cast<int>(matches.size()));
+    for (const SymbolTable::SearchResult& match : matches) {
+        std::string_view name = symbol_table->get_name(match.index);
+        std::string_view type = symbol_table->get_type(match.index);
+        QTreeWidgetItem* item = new QTreeWidgetItem();
+        item->setText(0, QString::fromUtf8(name.data(), static_cast<int>(name.size())));
+        item->setToolTip(0, QString("Type: %1, Address: 0x%2").arg(QString::fromLatin1(type.data(), static_cast<int>(type.size()))).arg(symbol_table->get_address(match.index), 0, 16));
+        items.append(item);
+    }
+    if (matches.size() == kMaxListedSymbols) {
+        QTreeWidgetItem* more = new QTreeWidgetItem();
+        more->setText(0, QString("... first %1 of %2 symbols shown; refine the filter").arg(kMaxListedSymbols).arg(symbol_table->size()));
+        more->setFlags(Qt::NoItemFlags);
+        items.append(more);
     }
+    symbols_tree->addTopLevelItems(items);
+    symbols_tree->setUpdatesEnabled(true);
 }
 
 void MainWindow::populate_sections_table() {
     sections_table->setRowCount(0);
     
     if (elf_parser->is_valid_elf()) {
-        std::vector<Section> sections = elf_parser->get_sections();
+        const std::vector<Section>& sections = elf_parser->get_sections();
         sections_table->setRowCount(sections.size());
         
         for (size_t i = 0; i < sections.size(); ++i) {
@@ -1252,20 +1603,7 @@ void MainWindow::populate_sections_table() {
 }
 
 void MainWindow::populate_strings_view() {
-    strings_view->clear();
-    
-    if (elf_parser->is_valid_elf()) {
-        std::vector<uint8_t> code_data = elf_parser->get_code_section_data();
-        if (!code_data.empty()) {
-            std::vector<std::string> strings = disassembler->extract_strings(code_data.data(), code_data.size());
-            
-            QString content;
-            for (const auto& str : strings) {
-                content += QString::fromStdString(str) + "\n";
-            }
-            strings_view->setPlainText(content);
-        }
-    }
+    strings_model->reset(elf_parser, analysis_pipeline->get_results().strings);
 }
 
 void MainWindow::log_message(const QString& message) {
@@ -1290,10 +1628,12 @@ bool MainWindow::confirm_action(const QString& message) {
 void MainWindow::navigate_to_address(uint64_t address) {
     current_address = address;
     disassembly_view->highlight_instruction(address);
+    decompiler_view->show_function(address);
     log_message(QString("Navigated to address 0x%1").arg(address, 0, 16));
 }
 
 void MainWindow::highlight_current_instruction(uint64_t address) {
+    PERF_SCOPE("Highlight current instruction", "ui");
     disassembly_view->highlight_instruction(address);
 }
 
@@ -1,264 +1,510 @@
 #include "main_window.h"
+#include "instrumentation.h"
 #include <QtWidgets/QHeaderView>
-#include <QtWidgets/QTableWidgetItem>
+#include <QtWidgets/QLineEdit>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QInputDialog>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QScrollBar>
 #include <QtGui/QFont>
+#include <QtGui/QFontMetrics>
 #include <QtGui/QContextMenuEvent>
 #include <QtGui/QClipboard>
+#include <QtGui/QRegularExpressionValidator>
 #include <QtCore/QStringList>
+#include <algorithm>
+#include <cctype>
 
 namespace debugger {
 
-MemoryView::MemoryView(QWidget* parent) 
-    : QTableWidget(parent), base_address(0), bytes_per_row(16) {
-    setup_table();
+// MemoryModel implementation
+
+MemoryModel::MemoryModel(QObject* parent)
+    : QAbstractTableModel(parent), snapshot_address(0), base_address(0), window_size(0),
+      highlight_start(1), highlight_end(0) {
 }
 
-void MemoryView::setup_table() {
-    // Set up columns: Address + 16 hex bytes + ASCII
-    setColumnCount(18); // Address + 16 bytes + ASCII
-    
-    QStringList headers;
-    headers << "Address";
-    
-    // Hex byte columns
-    for (int i = 0; i < bytes_per_row; ++i) {
-        headers << QString("%1").arg(i, 2, 16, QChar('0')).toUpper();
+void MemoryModel::set_reader(MemoryReader memory_reader) {
+    beginResetModel();
+    reader = std::move(memory_reader);
+    snapshot.clear();
+    pages.clear();
+    endResetModel();
+}
+
+void MemoryModel::set_window(uint64_t address, uint64_t size) {
+    // Rows start on 16-byte boundaries so they never straddle a page
+    uint64_t aligned = address & ~static_cast<uint64_t>(BYTES_PER_ROW - 1);
+    
+    beginResetModel();
+    base_address = aligned;
+    window_size = size == 0 ? 0 : size + (address - aligned);
+    pages.clear();
+    endResetModel();
+}
+
+void MemoryModel::set_snapshot(uint64_t address, const std::vector<uint8_t>& data) {
+    // Same window: keep the pages so refresh() can diff against them
+    bool same_window = !reader && address == snapshot_address && data.size() == snapshot.size();
+    snapshot = data;
+    snapshot_address = address;
+    
+    if (same_window) {
+        refresh(0, rowCount() - 1);
+        return;
     }
-    
-    // ASCII column
-    headers << "ASCII";
-    
-    setHorizontalHeaderLabels(headers);
-    
-    // Configure table properties
-    setAlternatingRowColors(true);
-    setSelectionBehavior(QAbstractItemView::SelectItems);
-    setSelectionMode(QAbstractItemView::ExtendedSelection);
-    
-    // Set monospace font
-    QFont mono_font("Consolas", 10);
-    mono_font.setStyleHint(QFont::Monospace);
-    setFont(mono_font);
-    
-    // Configure column widths
-    horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents); // Address
-    
-    // Hex columns - fixed width
-    for (int i = 1; i <= bytes_per_row; ++i) {
-        horizontalHeader()->setSectionResizeMode(i, QHeaderView::Fixed);
-        setColumnWidth(i, 30);
+    set_window(address, data.size());
+}
+
+size_t MemoryModel::fetch(uint64_t address, uint8_t* buffer, size_t size) const {
+    if (reader) {
+        return reader(address, buffer, size);
     }
     
-    // ASCII column
-    horizontalHeader()->setSectionResizeMode(17, QHeaderView::ResizeToContents);
-    
-    verticalHeader()->setVisible(false);
-    
-    // Enable editing for hex bytes
-    setEditTriggers(QAbstractItemView::DoubleClicked);
+    // Snapshot mode: bytes outside the snapshot read as unavailable
+    if (address < snapshot_address || address - snapshot_address >= snapshot.size()) {
+        return 0;
+    }
+    size_t offset = static_cast<size_t>(address - snapshot_address);
+    size_t count = std::min(size, snapshot.size() - offset);
+    std::copy(snapshot.begin() + offset, snapshot.begin() + offset + count, buffer);
+    return count;
+}
+
+MemoryModel::Page* MemoryModel::find_page(uint64_t address) const {
+    uint64_t page_address = address & ~(PAGE_SIZE - 1);
+    auto it = pages.find(page_address);
+    if (it != pages.end()) {
+        return &it->second;
+    }
     
-    // Connect item changed signal for memory editing
-    connect(this, &QTableWidget::itemChanged, this, &MemoryView::on_item_changed);
+    // One transfer per page; through the engine this is served by the stop cache
+    Page& page = pages[page_address];
+    uint64_t read_start = std::max(page_address, base_address);
+    size_t skip = static_cast<size_t>(read_start - page_address);
+    size_t read = fetch(read_start, page.bytes.data() + skip, PAGE_SIZE - skip);
+    page.valid_bytes = static_cast<uint32_t>(read == 0 ? 0 : skip + read);
+    return &page;
 }
 
-void MemoryView::set_memory_data(uint64_t start_address, const std::vector<uint8_t>& data) {
-    base_address = start_address;
-    memory_data = data;
-    update_display();
+bool MemoryModel::read_byte(uint64_t address, uint8_t& value) const {
+    if (!contains(address)) {
+        return false;
+    }
+    
+    const Page* page = find_page(address);
+    size_t offset = static_cast<size_t>(address & (PAGE_SIZE - 1));
+    if (offset >= page->valid_bytes) {
+        return false;
+    }
+    value = page->bytes[offset];
+    return true;
 }
 
-void MemoryView::update_display() {
-    if (memory_data.empty()) {
-        setRowCount(0);
+void MemoryModel::refresh(int first_row, int last_row) {
+    if (window_size == 0) {
+        return;
+    }
+    
+    first_row = std::max(first_row, 0);
+    last_row = std::min(last_row, rowCount() - 1);
+    if (first_row > last_row) {
+        pages.clear();
         return;
     }
     
-    // Calculate number of rows needed
-    int rows = (memory_data.size() + bytes_per_row - 1) / bytes_per_row;
-    setRowCount(rows);
+    uint64_t first_page = (base_address + static_cast<uint64_t>(first_row) * BYTES_PER_ROW) & ~(PAGE_SIZE - 1);
+    uint64_t last_page = (base_address + static_cast<uint64_t>(last_row) * BYTES_PER_ROW + BYTES_PER_ROW - 1) & ~(PAGE_SIZE - 1);
+    
+    // Pages scrolled out of view are dropped and fetched fresh when shown again
+    for (auto it = pages.begin(); it != pages.end();) {
+        if (it->first < first_page || it->first > last_page) {
+            it = pages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    std::vector<int> dirty_rows;
+    std::array<uint8_t, PAGE_SIZE> fresh;
     
-    for (int row = 0; row < rows; ++row) {
-        uint64_t row_address = base_address + (row * bytes_per_row);
+    for (auto& entry : pages) {
+        uint64_t page_address = entry.first;
+        Page& page = entry.second;
         
-        // Address column
-        QTableWidgetItem* addr_item = new QTableWidgetItem(
-            QString("0x%1").arg(row_address, 16, 16, QChar('0')).toUpper()
-        );
-        addr_item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-        addr_item->setBackground(QColor(240, 240, 240));
-        setItem(row, 0, addr_item);
+        uint64_t read_start = std::max(page_address, base_address);
+        size_t skip = static_cast<size_t>(read_start - page_address);
+        size_t read = fetch(read_start, fresh.data() + skip, PAGE_SIZE - skip);
+        uint32_t valid = static_cast<uint32_t>(read == 0 ? 0 : skip + read);
         
-        // Hex byte columns and build ASCII string
-        QString ascii_str;
-        for (int col = 0; col < bytes_per_row; ++col) {
-            int data_index = row * bytes_per_row + col;
-            
-            if (data_index < static_cast<int>(memory_data.size())) {
-                uint8_t byte_value = memory_data[data_index];
-                
-                // Hex representation
-                QTableWidgetItem* hex_item = new QTableWidgetItem(
-                    QString("%1").arg(byte_value, 2, 16, QChar('0')).toUpper()
-                );
-                hex_item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable);
-                hex_item->setTextAlignment(Qt::AlignCenter);
-                
-                // Color code based on value
-                if (byte_value == 0x00) {
-                    hex_item->setForeground(QColor(128, 128, 128)); // Gray for null bytes
-                } else if (byte_value == 0xFF) {
-                    hex_item->setForeground(QColor(255, 0, 0)); // Red for 0xFF
-                } else if (std::isprint(byte_value)) {
-                    hex_item->setForeground(QColor(0, 128, 0)); // Green for printable
-                }
-                
-                setItem(row, col + 1, hex_item);
-                
-                // ASCII representation
-                if (std::isprint(byte_value) && byte_value >= 32) {
-                    ascii_str += static_cast<char>(byte_value);
-                } else {
-                    ascii_str += '.';
+        // Compare 16-byte rows; a row repaints if its bytes, readability or
+        // last highlight changed
+        for (size_t offset = skip; offset < PAGE_SIZE; offset += BYTES_PER_ROW) {
+            bool row_dirty = false;
+            for (size_t i = offset; i < offset + BYTES_PER_ROW; ++i) {
+                bool was_valid = i < page.valid_bytes;
+                bool is_valid = i < valid;
+                bool differs = was_valid && is_valid && page.bytes[i] != fresh[i];
+                if (differs || was_valid != is_valid || page.changed[i] || page.edited[i]) {
+                    row_dirty = true;
                 }
-            } else {
-                // Empty cell for data beyond available
-                QTableWidgetItem* empty_item = new QTableWidgetItem("");
-                empty_item->setFlags(Qt::ItemIsEnabled);
-                empty_item->setBackground(QColor(245, 245, 245));
-                setItem(row, col + 1, empty_item);
-                ascii_str += ' ';
+                page.changed[i] = differs;
+            }
+            
+            uint64_t row_address = page_address + offset;
+            if (row_dirty && contains(row_address)) {
+                dirty_rows.push_back(static_cast<int>((row_address - base_address) / BYTES_PER_ROW));
             }
         }
         
-        // ASCII column
-        QTableWidgetItem* ascii_item = new QTableWidgetItem(ascii_str);
-        ascii_item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-        ascii_item->setFont(mono_font);
-        setItem(row, 17, ascii_item);
+        page.edited.reset();
+        std::copy(fresh.begin() + skip, fresh.begin() + std::max<size_t>(valid, skip), page.bytes.begin() + skip);
+        page.valid_bytes = valid;
     }
     
-    resizeColumnsToContents();
-}
-
-void MemoryView::refresh_memory(uint64_t address, size_t size) {
-    // Emit signal to request memory refresh from debugger
-    emit memory_refresh_requested(address, size);
+    emit_rows_changed(dirty_rows);
 }
 
-void MemoryView::navigate_to_address(uint64_t address) {
-    // Find the row containing this address
-    if (address < base_address) {
-        // Address is before current view
-        emit memory_refresh_requested(address, memory_data.size());
+void MemoryModel::emit_rows_changed(const std::vector<int>& rows) {
+    if (rows.empty()) {
         return;
     }
     
+    // Coalesce into contiguous runs so the view repaints as few rects as possible
+    std::vector<int> sorted = rows;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    
+    size_t run_start = 0;
+    for (size_t i = 1; i <= sorted.size(); ++i) {
+        if (i == sorted.size() || sorted[i] != sorted[i - 1] + 1) {
+            emit dataChanged(index(sorted[run_start], 0), index(sorted[i - 1], ASCII_COLUMN));
+            run_start = i;
+        }
+    }
+}
+
+void MemoryModel::set_highlight_range(uint64_t start_addr, uint64_t end_addr) {
+    // Repaint the rows covered by the old and the new range
+    std::vector<int> rows;
+    auto add_rows = [this, &rows](uint64_t start, uint64_t end) {
+        if (end < start || window_size == 0) return;
+        uint64_t first = std::max(start, base_address);
+        uint64_t last = std::min(end, base_address + window_size - 1);
+        for (uint64_t row = (first - base_address) / BYTES_PER_ROW;
+             first <= last && row <= (last - base_address) / BYTES_PER_ROW; ++row) {
+            rows.push_back(static_cast<int>(row));
+        }
+    };
+    
+    add_rows(highlight_start, highlight_end);
+    highlight_start = start_addr;
+    highlight_end = end_addr;
+    add_rows(highlight_start, highlight_end);
+    
+    emit_rows_changed(rows);
+}
+
+uint64_t MemoryModel::get_base_address() const {
+    return base_address;
+}
+
+uint64_t MemoryModel::get_window_size() const {
+    return window_size;
+}
+
+bool MemoryModel::contains(uint64_t address) const {
+    return address >= base_address && address - base_address < window_size;
+}
+
+uint64_t MemoryModel::address_at(const QModelIndex& index) const {
+    int column = std::max(index.column() - 1, 0);
+    return base_address + static_cast<uint64_t>(index.row()) * BYTES_PER_ROW + static_cast<uint64_t>(std::min(column, BYTES_PER_ROW - 1));
+}
+
+QModelIndex MemoryModel::index_of(uint64_t address) const {
+    if (!contains(address)) {
+        return QModelIndex();
+    }
     uint64_t offset = address - base_address;
-    if (offset >= memory_data.size()) {
-        // Address is after current view
-        emit memory_refresh_requested(address, memory_data.size());
-        return;
+    return index(static_cast<int>(offset / BYTES_PER_ROW), static_cast<int>(offset % BYTES_PER_ROW) + 1);
+}
+
+int MemoryModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return static_cast<int>((window_size + BYTES_PER_ROW - 1) / BYTES_PER_ROW);
+}
+
+int MemoryModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ASCII_COLUMN + 1; // Address + 16 bytes + ASCII
+}
+
+QString MemoryModel::format_ascii(int row) const {
+    QString ascii_str;
+    uint64_t row_address = base_address + static_cast<uint64_t>(row) * BYTES_PER_ROW;
+    
+    for (int col = 0; col < BYTES_PER_ROW; ++col) {
+        uint8_t byte_value = 0;
+        if (!contains(row_address + col)) {
+            ascii_str += ' ';
+        } else if (read_byte(row_address + col, byte_value) && std::isprint(byte_value) && byte_value >= 32) {
+            ascii_str += static_cast<char>(byte_value);
+        } else {
+            ascii_str += '.';
+        }
+    }
+    return ascii_str;
+}
+
+QVariant MemoryModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
     }
     
-    // Calculate row and column
-    int row = offset / bytes_per_row;
-    int col = (offset % bytes_per_row) + 1; // +1 for address column
+    int row = index.row();
+    int col = index.column();
+    uint64_t row_address = base_address + static_cast<uint64_t>(row) * BYTES_PER_ROW;
     
-    // Select and scroll to the byte
-    setCurrentCell(row, col);
-    scrollToItem(item(row, col));
+    if (col == 0) {
+        if (role == Qt::DisplayRole) {
+            return QString("0x%1").arg(row_address, 16, 16, QChar('0')).toUpper();
+        }
+        if (role == Qt::BackgroundRole) {
+            return QColor(240, 240, 240);
+        }
+        return QVariant();
+    }
     
-    // Highlight the target byte
-    QTableWidgetItem* target_item = item(row, col);
-    if (target_item) {
-        target_item->setBackground(QColor(255, 255, 0, 150)); // Light yellow highlight
+    if (col == ASCII_COLUMN) {
+        return role == Qt::DisplayRole ? QVariant(format_ascii(row)) : QVariant();
+    }
+    
+    uint64_t address = row_address + static_cast<uint64_t>(col - 1);
+    if (!contains(address)) {
+        return role == Qt::BackgroundRole ? QVariant(QColor(245, 245, 245)) : QVariant();
+    }
+    
+    uint8_t byte_value = 0;
+    bool readable = read_byte(address, byte_value);
+    
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+            return readable ? QString("%1").arg(byte_value, 2, 16, QChar('0')).toUpper() : QString("??");
+        case Qt::TextAlignmentRole:
+            return static_cast<int>(Qt::AlignCenter);
+        case Qt::ForegroundRole:
+            // Color code based on value
+            if (!readable || byte_value == 0x00) {
+                return QColor(128, 128, 128); // Gray for null / unreadable bytes
+            } else if (byte_value == 0xFF) {
+                return QColor(255, 0, 0); // Red for 0xFF
+            } else if (std::isprint(byte_value)) {
+                return QColor(0, 128, 0); // Green for printable
+            }
+            return QVariant();
+        case Qt::BackgroundRole: {
+            const Page* page = find_page(address);
+            size_t offset = static_cast<size_t>(address & (PAGE_SIZE - 1));
+            if (page->edited[offset]) {
+                return QColor(255, 200, 200, 100); // Light red for modified
+            }
+            if (page->changed[offset]) {
+                return QColor(255, 140, 0, 140); // Orange for changed since last stop
+            }
+            if (address >= highlight_start && address <= highlight_end) {
+                return QColor(255, 255, 0, 100); // Light yellow
+            }
+            return QVariant();
+        }
+        default:
+            return QVariant();
     }
 }
 
-void MemoryView::on_item_changed(QTableWidgetItem* item) {
-    // Handle memory editing
-    if (!item || item->column() == 0 || item->column() == 17) {
-        return; // Don't edit address or ASCII columns
+QVariant MemoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
     }
     
-    int row = item->row();
-    int col = item->column();
-    int data_index = row * bytes_per_row + (col - 1);
+    if (section == 0) return QString("Address");
+    if (section == ASCII_COLUMN) return QString("ASCII");
+    return QString("%1").arg(section - 1, 2, 16, QChar('0')).toUpper();
+}
+
+Qt::ItemFlags MemoryModel::flags(const QModelIndex& index) const {
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
     
-    if (data_index >= static_cast<int>(memory_data.size())) {
-        return;
+    Qt::ItemFlags item_flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (index.column() >= 1 && index.column() <= BYTES_PER_ROW) {
+        uint8_t byte_value = 0;
+        if (read_byte(address_at(index), byte_value)) {
+            item_flags |= Qt::ItemIsEditable;
+        }
+    }
+    return item_flags;
+}
+
+bool MemoryModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (role != Qt::EditRole || index.column() < 1 || index.column() > BYTES_PER_ROW) {
+        return false;
     }
     
     // Validate hex input
-    QString text = item->text().trimmed();
+    QString text = value.toString().trimmed();
     bool ok;
-    uint8_t new_value = text.toUInt(&ok, 16);
+    uint new_value = text.toUInt(&ok, 16);
+    if (!ok || text.length() > 2 || new_value > 0xFF) {
+        return false;
+    }
     
-    if (!ok || text.length() > 2) {
-        // Invalid input - revert
-        uint8_t old_value = memory_data[data_index];
-        item->setText(QString("%1").arg(old_value, 2, 16, QChar('0')).toUpper());
-        QMessageBox::warning(this, "Invalid Input", "Please enter a valid hex byte (00-FF)");
-        return;
+    uint64_t address = address_at(index);
+    uint8_t old_value = 0;
+    if (!read_byte(address, old_value)) {
+        return false;
     }
     
-    // Update memory data
-    memory_data[data_index] = new_value;
+    Page* page = find_page(address);
+    size_t offset = static_cast<size_t>(address & (PAGE_SIZE - 1));
+    page->bytes[offset] = static_cast<uint8_t>(new_value);
+    page->edited[offset] = true;
     
-    // Update ASCII column
-    update_ascii_for_row(row);
+    emit dataChanged(this->index(index.row(), 0), this->index(index.row(), ASCII_COLUMN));
+    emit byte_edited(address, static_cast<uint8_t>(new_value));
+    return true;
+}
+
+// HexByteDelegate implementation
+
+QWidget* HexByteDelegate::createEditor(QWidget* parent, const QStyleOptionViewItem&,
+                                       const QModelIndex&) const {
+    QLineEdit* editor = new QLineEdit(parent);
+    editor->setValidator(new QRegularExpressionValidator(QRegularExpression("[0-9A-Fa-f]{1,2}"), editor));
+    editor->setAlignment(Qt::AlignCenter);
+    return editor;
+}
+
+// MemoryView implementation
+
+MemoryView::MemoryView(QWidget* parent) 
+    : QTableView(parent), memory_model(new MemoryModel(this)), has_reader(false) {
+    setModel(memory_model);
+    setup_table();
+}
+
+void MemoryView::setup_table() {
+    // Configure table properties
+    setAlternatingRowColors(true);
+    setSelectionBehavior(QAbstractItemView::SelectItems);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    
+    // Set monospace font
+    mono_font = QFont("Consolas", 10);
+    mono_font.setStyleHint(QFont::Monospace);
+    setFont(mono_font);
+    
+    // Fixed geometry: nothing is measured per update
+    QFontMetrics metrics(mono_font);
+    int char_width = metrics.horizontalAdvance(QLatin1Char('0'));
+    horizontalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    setColumnWidth(0, char_width * 20);
+    for (int i = 1; i <= MemoryModel::BYTES_PER_ROW; ++i) {
+        setColumnWidth(i, 30);
+    }
+    setColumnWidth(MemoryModel::ASCII_COLUMN, char_width * (MemoryModel::BYTES_PER_ROW + 2));
     
-    // Emit signal for actual memory writing
-    uint64_t address = base_address + data_index;
-    emit memory_write_requested(address, new_value);
+    verticalHeader()->setVisible(false);
+    verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    verticalHeader()->setDefaultSectionSize(metrics.height() + 4);
     
-    // Mark as modified
-    item->setBackground(QColor(255, 200, 200, 100)); // Light red for modified
+    // Enable editing for hex bytes
+    setEditTriggers(QAbstractItemView::DoubleClicked);
+    HexByteDelegate* delegate = new HexByteDelegate(this);
+    for (int i = 1; i <= MemoryModel::BYTES_PER_ROW; ++i) {
+        setItemDelegateForColumn(i, delegate);
+    }
+    
+    // Forward edits for actual memory writing
+    connect(memory_model, &MemoryModel::byte_edited, this, &MemoryView::memory_write_requested);
 }
 
-void MemoryView::update_ascii_for_row(int row) {
-    QString ascii_str;
-    
-    for (int col = 0; col < bytes_per_row; ++col) {
-        int data_index = row * bytes_per_row + col;
-        
-        if (data_index < static_cast<int>(memory_data.size())) {
-            uint8_t byte_value = memory_data[data_index];
-            
-            if (std::isprint(byte_value) && byte_value >= 32) {
-                ascii_str += static_cast<char>(byte_value);
-            } else {
-                ascii_str += '.';
-            }
-        } else {
-            ascii_str += ' ';
+void MemoryView::set_memory_reader(MemoryReader reader) {
+    has_reader = static_cast<bool>(reader);
+    memory_model->set_reader(std::move(reader));
+}
+
+void MemoryView::set_memory_window(uint64_t address, uint64_t size) {
+    if (address == memory_model->get_base_address() && size == memory_model->get_window_size()) {
+        update_display();
+        return;
+    }
+    PERF_SCOPE("Refresh memory view", "ui");
+    memory_model->set_window(address, size);
+}
+
+bool MemoryView::is_address_in_window(uint64_t address) const {
+    return memory_model->contains(address);
+}
+
+void MemoryView::set_memory_data(uint64_t start_address, const std::vector<uint8_t>& data) {
+    memory_model->set_snapshot(start_address, data);
+}
+
+void MemoryView::update_display() {
+    PERF_SCOPE("Refresh memory view", "ui");
+    // Only the rows on screen are re-read and compared
+    int first_row = rowAt(0);
+    int last_row = rowAt(viewport()->height() - 1);
+    if (first_row < 0) first_row = 0;
+    if (last_row < 0) last_row = memory_model->rowCount() - 1;
+    memory_model->refresh(first_row, last_row);
+}
+
+void MemoryView::refresh_memory(uint64_t address, size_t size) {
+    // Emit signal to request memory refresh from debugger
+    emit memory_refresh_requested(address, size);
+}
+
+void MemoryView::navigate_to_address(uint64_t address) {
+    uint64_t window = memory_model->get_window_size();
+    if (!memory_model->contains(address)) {
+        if (!has_reader) {
+            // Address is outside the current view
+            emit memory_refresh_requested(address, window);
+            return;
         }
+        // Re-center the window; pages are fetched as rows come into view
+        uint64_t base = address & ~static_cast<uint64_t>(MemoryModel::BYTES_PER_ROW - 1);
+        base = base >= window / 2 ? base - window / 2 : 0;
+        memory_model->set_window(base, window);
     }
     
-    QTableWidgetItem* ascii_item = item(row, 17);
-    if (ascii_item) {
-        ascii_item->setText(ascii_str);
-    }
+    // Select and scroll to the byte
+    QModelIndex target = memory_model->index_of(address);
+    setCurrentIndex(target);
+    scrollTo(target, QAbstractItemView::PositionAtCenter);
+    
+    // Highlight the target byte
+    memory_model->set_highlight_range(address, address);
 }
 
 void MemoryView::contextMenuEvent(QContextMenuEvent* event) {
-    QTableWidgetItem* clicked_item = itemAt(event->pos());
-    if (!clicked_item) {
+    QModelIndex clicked = indexAt(event->pos());
+    if (!clicked.isValid()) {
         return;
     }
     
-    int row = clicked_item->row();
-    int col = clicked_item->column();
+    int row = clicked.row();
+    int col = clicked.column();
     
     QMenu menu(this);
     
     // Get address for this position
-    uint64_t row_address = base_address + (row * bytes_per_row);
+    uint64_t row_address = memory_model->get_base_address() + static_cast<uint64_t>(row) * MemoryModel::BYTES_PER_ROW;
     
     if (col == 0) {
         // Address column context menu
@@ -271,15 +517,11 @@ void MemoryView::contextMenuEvent(QContextMenuEvent* event) {
         QAction* goto_address = menu.addAction("Go to Address...");
         connect(goto_address, &QAction::triggered, this, &MemoryView::show_go_to_dialog);
         
-    } else if (col >= 1 && col <= bytes_per_row) {
+    } else if (col >= 1 && col <= MemoryModel::BYTES_PER_ROW) {
         // Hex byte column context menu
         uint64_t byte_address = row_address + (col - 1);
         uint8_t byte_value = 0;
-        
-        int data_index = row * bytes_per_row + (col - 1);
-        if (data_index < static_cast<int>(memory_data.size())) {
-            byte_value = memory_data[data_index];
-        }
+        memory_model->read_byte(byte_address, byte_value);
         
         QAction* copy_byte = menu.addAction(QString("Copy Byte (0x%1)")
                                           .arg(byte_value, 2, 16, QChar('0')).toUpper());
@@ -296,8 +538,9 @@ void MemoryView::contextMenuEvent(QContextMenuEvent* event) {
         menu.addSeparator();
         
         QAction* edit_byte = menu.addAction("Edit Byte...");
-        connect(edit_byte, &QAction::triggered, [this, clicked_item] {
-            edit(indexFromItem(clicked_item));
+        edit_byte->setEnabled(memory_model->flags(clicked).testFlag(Qt::ItemIsEditable));
+        connect(edit_byte, &QAction::triggered, [this, clicked] {
+            edit(clicked);
         });
         
         QAction* set_breakpoint = menu.addAction("Set Breakpoint on Access");
@@ -305,11 +548,12 @@ void MemoryView::contextMenuEvent(QContextMenuEvent* event) {
             emit breakpoint_requested(byte_address);
         });
         
-    } else if (col == 17) {
+    } else if (col == MemoryModel::ASCII_COLUMN) {
         // ASCII column context menu
+        QString ascii = memory_model->data(clicked).toString();
         QAction* copy_ascii = menu.addAction("Copy ASCII");
-        connect(copy_ascii, &QAction::triggered, [clicked_item] {
-            QApplication::clipboard()->setText(clicked_item->text());
+        connect(copy_ascii, &QAction::triggered, [ascii] {
+            QApplication::clipboard()->setText(ascii);
         });
     }
     
@@ -318,7 +562,11 @@ void MemoryView::contextMenuEvent(QContextMenuEvent* event) {
     // General actions
     QAction* refresh = menu.addAction("Refresh");
     connect(refresh, &QAction::triggered, [this] {
-        refresh_memory(base_address, memory_data.size());
+        if (has_reader) {
+            update_display();
+        } else {
+            refresh_memory(memory_model->get_base_address(), memory_model->get_window_size());
+        }
     });
     
     QAction* export_action = menu.addAction("Export Memory...");
@@ -352,15 +600,18 @@ void MemoryView::show_go_to_dialog() {
 std::vector<uint8_t> MemoryView::get_selected_bytes() {
     std::vector<uint8_t> selected_bytes;
     
-    QList<QTableWidgetItem*> selected_items = selectedItems();
-    for (QTableWidgetItem* item : selected_items) {
-        int col = item->column();
-        if (col >= 1 && col <= bytes_per_row) {
-            int row = item->row();
-            int data_index = row * bytes_per_row + (col - 1);
-            
-            if (data_index < static_cast<int>(memory_data.size())) {
-                selected_bytes.push_back(memory_data[data_index]);
+    // Selection order is arbitrary; return bytes in address order
+    QModelIndexList selected = selectionModel()->selectedIndexes();
+    std::sort(selected.begin(), selected.end(), [](const QModelIndex& a, const QModelIndex& b) {
+        return a.row() != b.row() ? a.row() < b.row() : a.column() < b.column();
+    });
+    
+    for (const QModelIndex& index : selected) {
+        int col = index.column();
+        if (col >= 1 && col <= MemoryModel::BYTES_PER_ROW) {
+            uint8_t byte_value = 0;
+            if (memory_model->read_byte(memory_model->address_at(index), byte_value)) {
+                selected_bytes.push_back(byte_value);
             }
         }
     }
@@ -369,31 +620,7 @@ std::vector<uint8_t> MemoryView::get_selected_bytes() {
 }
 
 void MemoryView::highlight_address_range(uint64_t start_addr, uint64_t end_addr) {
-    // Clear previous highlights
-    for (int row = 0; row < rowCount(); ++row) {
-        for (int col = 1; col <= bytes_per_row; ++col) {
-            QTableWidgetItem* item_ptr = item(row, col);
-            if (item_ptr) {
-                item_ptr->setBackground(QBrush());
-            }
-        }
-    }
-    
-    // Apply new highlights
-    for (uint64_t addr = start_addr; addr <= end_addr; ++addr) {
-        if (addr < base_address || addr >= base_address + memory_data.size()) {
-            continue;
-        }
-        
-        uint64_t offset = addr - base_address;
-        int row = offset / bytes_per_row;
-        int col = (offset % bytes_per_row) + 1;
-        
-        QTableWidgetItem* item_ptr = item(row, col);
-        if (item_ptr) {
-            item_ptr->setBackground(QColor(255, 255, 0, 100)); // Light yellow
-        }
-    }
+    memory_model->set_highlight_range(start_addr, end_addr);
 }
 
 } // namespace debugger 
\ No newline at end of file
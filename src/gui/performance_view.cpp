@@ -0,0 +1,152 @@
+#include "main_window.h"
+#include "instrumentation.h"
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QMessageBox>
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QTableWidgetItem>
+#include <QtGui/QFont>
+#include <QtCore/QStringList>
+
+namespace debugger {
+
+PerformanceView::PerformanceView(QWidget* parent) : QWidget(parent), last_refresh_ns(0) {
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QWidget* controls = new QWidget();
+    QHBoxLayout* controls_layout = new QHBoxLayout(controls);
+    controls_layout->setContentsMargins(0, 0, 0, 0);
+
+    reset_button = new QPushButton("Reset");
+    reset_button->setToolTip("Start the totals from zero");
+    export_button = new QPushButton("Export Trace...");
+    export_button->setToolTip("Write recent spans as Chrome trace JSON, for chrome://tracing or Perfetto");
+    controls_layout->addWidget(reset_button);
+    controls_layout->addWidget(export_button);
+    controls_layout->addStretch();
+    layout->addWidget(controls);
+
+    summary_label = new QLabel();
+    summary_label->setWordWrap(true);
+    layout->addWidget(summary_label);
+
+    probes_table = new QTableWidget();
+    probes_table->setColumnCount(7);
+    probes_table->setHorizontalHeaderLabels({"Probe", "Category", "Calls", "Calls/s", "Total ms", "Avg us", "Max us"});
+    probes_table->setAlternatingRowColors(true);
+    probes_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    probes_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    probes_table->verticalHeader()->setVisible(false);
+    probes_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int column = 1; column < 7; ++column) {
+        probes_table->horizontalHeader()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+    }
+
+    QFont mono_font("Consolas", 10);
+    mono_font.setStyleHint(QFont::Monospace);
+    probes_table->setFont(mono_font);
+    layout->addWidget(probes_table);
+
+    refresh_timer = new QTimer(this);
+    refresh_timer->setInterval(1000);
+
+    if (!perf::is_compiled_in()) {
+        summary_label->setText("Instrumentation is compiled out. Configure with -DENABLE_INSTRUMENTATION=ON to record timers and counters.");
+        reset_button->setEnabled(false);
+        export_button->setEnabled(false);
+        return;
+    }
+
+    connect(refresh_timer, &QTimer::timeout, this, &PerformanceView::refresh);
+    connect(reset_button, &QPushButton::clicked, [this]() {
+        perf::reset();
+        last_counts.clear();
+        refresh();
+    });
+    connect(export_button, &QPushButton::clicked, this, &PerformanceView::export_trace);
+}
+
+void PerformanceView::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    if (perf::is_compiled_in()) {
+        refresh();
+        refresh_timer->start();
+    }
+}
+
+void PerformanceView::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    refresh_timer->stop();
+}
+
+void PerformanceView::refresh() {
+    std::vector<perf::ProbeStats> stats = perf::snapshot();
+    uint64_t now = perf::now_ns();
+    double elapsed_s = last_refresh_ns != 0 ? (now - last_refresh_ns) / 1e9 : 0.0;
+    last_refresh_ns = now;
+
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    const perf::ProbeStats* stop_to_ui = nullptr;
+
+    probes_table->setRowCount(static_cast<int>(stats.size()));
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const perf::ProbeStats& probe = stats[i];
+        int row = static_cast<int>(i);
+
+        // Counters add a page count per call, so their totals are the pages
+        if (probe.name == "Memory cache hits") cache_hits = probe.total;
+        if (probe.name == "Memory cache misses") cache_misses = probe.total;
+        if (probe.name == "Stop to UI") stop_to_ui = &probe;
+
+        // Calls since the previous refresh; the first one has nothing to compare with
+        uint64_t& last_count = last_counts[probe.name];
+        QString rate = elapsed_s > 0 && probe.count >= last_count
+                       ? QString::number((probe.count - last_count) / elapsed_s, 'f', 1) : QString("-");
+        last_count = probe.count;
+
+        bool timer = probe.kind == perf::ProbeKind::TIMER;
+        const QString cells[] = {
+            QString::fromStdString(probe.name),
+            QString::fromStdString(probe.category),
+            QString::number(probe.count),
+            rate,
+            timer ? QString::number(probe.total / 1e6, 'f', 3) : QString::number(probe.total),
+            timer && probe.count > 0 ? QString::number(probe.total / 1e3 / probe.count, 'f', 2) : QString("-"),
+            timer ? QString::number(probe.max / 1e3, 'f', 2) : QString("-"),
+        };
+        for (int column = 0; column < 7; ++column) {
+            QTableWidgetItem* item = new QTableWidgetItem(cells[column]);
+            if (column >= 2) item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            probes_table->setItem(row, column, item);
+        }
+    }
+
+    QStringList summary;
+    if (stop_to_ui && stop_to_ui->count > 0) {
+        summary << QString("Stop to UI avg %1 us, max %2 us")
+                   .arg(stop_to_ui->total / 1e3 / stop_to_ui->count, 0, 'f', 1)
+                   .arg(stop_to_ui->max / 1e3, 0, 'f', 1);
+    }
+    if (cache_hits + cache_misses > 0) {
+        summary << QString("memory cache hit rate %1%")
+                   .arg(100.0 * cache_hits / (cache_hits + cache_misses), 0, 'f', 1);
+    }
+    summary_label->setText(summary.isEmpty() ? QString("Nothing recorded yet") : summary.join(", "));
+}
+
+void PerformanceView::export_trace() {
+    QString filename = QFileDialog::getSaveFileName(this, "Export Trace", "trace.json",
+                                                    "Chrome Trace (*.json);;All Files (*)");
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    std::string error;
+    if (!perf::export_chrome_trace(filename.toStdString(), error)) {
+        QMessageBox::warning(this, "Export Trace", QString::fromStdString(error));
+    }
+}
+
+} // namespace debugger
@@ -0,0 +1,114 @@
+#include "main_window.h"
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QTableWidgetItem>
+#include <QtGui/QFont>
+#include <QtCore/QVariant>
+
+namespace debugger {
+
+ProfilerView::ProfilerView(QWidget* parent) : QWidget(parent), profiling(false) {
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    
+    QWidget* controls = new QWidget();
+    QHBoxLayout* controls_layout = new QHBoxLayout(controls);
+    controls_layout->setContentsMargins(0, 0, 0, 0);
+    
+    toggle_button = new QPushButton("Start");
+    toggle_button->setToolTip("Sample the running target");
+    frequency_box = new QSpinBox();
+    frequency_box->setRange(10, 10000);
+    frequency_box->setValue(1000);
+    frequency_box->setSuffix(" Hz");
+    frequency_box->setToolTip("Samples per second per thread");
+    export_button = new QPushButton("Export Folded...");
+    export_button->setToolTip("Write the stacks in folded format, for flame graph tools");
+    export_button->setEnabled(false);
+    status_label = new QLabel("No profile");
+    
+    controls_layout->addWidget(toggle_button);
+    controls_layout->addWidget(frequency_box);
+    controls_layout->addWidget(export_button);
+    controls_layout->addStretch();
+    layout->addWidget(controls);
+    layout->addWidget(status_label);
+    
+    functions_table = new QTableWidget();
+    functions_table->setColumnCount(4);
+    functions_table->setHorizontalHeaderLabels({"Function", "Self", "Self %", "Total %"});
+    functions_table->setAlternatingRowColors(true);
+    functions_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    functions_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    functions_table->verticalHeader()->setVisible(false);
+    functions_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int column = 1; column < 4; ++column) {
+        functions_table->horizontalHeader()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+    }
+    
+    QFont mono_font("Consolas", 10);
+    mono_font.setStyleHint(QFont::Monospace);
+    functions_table->setFont(mono_font);
+    layout->addWidget(functions_table);
+    
+    connect(toggle_button, &QPushButton::clicked, [this]() {
+        emit profiling_toggled(!profiling, static_cast<unsigned>(frequency_box->value()));
+    });
+    connect(export_button, &QPushButton::clicked, this, &ProfilerView::export_requested);
+    connect(functions_table, &QTableWidget::itemDoubleClicked, [this](QTableWidgetItem* item) {
+        QTableWidgetItem* name_item = functions_table->item(item->row(), 0);
+        uint64_t address = name_item ? name_item->data(Qt::UserRole).toULongLong() : 0;
+        if (address != 0) emit navigate_to_address_requested(address);
+    });
+}
+
+void ProfilerView::set_profiling(bool active) {
+    profiling = active;
+    toggle_button->setText(profiling ? "Stop" : "Start");
+    frequency_box->setEnabled(!profiling);
+}
+
+void ProfilerView::set_profile(const ProfileSummary& profile) {
+    QString mode = profile.mode == SamplingMode::PERF_EVENT ? "perf_event" : "interrupt";
+    QString status = QString("%1 samples (%2), %3 lost").arg(profile.samples).arg(mode).arg(profile.lost_samples);
+    if (profile.mode == SamplingMode::INTERRUPT && profile.stop_time.count > 0) {
+        status += QString(", stop p50 %1 us")
+                  .arg(profile.stop_time.get_percentile_ns(0.5) / 1000.0, 0, 'f', 1);
+    }
+    status_label->setText(status);
+    export_button->setEnabled(profile.samples > 0);
+    
+    double total = static_cast<double>(std::max<uint64_t>(profile.samples, 1));
+    functions_table->setRowCount(static_cast<int>(profile.functions.size()));
+    for (size_t i = 0; i < profile.functions.size(); ++i) {
+        const FunctionProfile& function = profile.functions[i];
+        int row = static_cast<int>(i);
+        
+        QTableWidgetItem* name_item = new QTableWidgetItem(QString::fromStdString(function.name));
+        name_item->setData(Qt::UserRole, QVariant::fromValue<qulonglong>(function.hottest_address));
+        if (function.hottest_address != 0) {
+            name_item->setToolTip(QString("Hottest address: 0x%1").arg(function.hottest_address, 0, 16));
+        }
+        functions_table->setItem(row, 0, name_item);
+        
+        const QString cells[] = {
+            QString::number(function.self_samples),
+            QString::number(100.0 * function.self_samples / total, 'f', 1),
+            QString::number(100.0 * function.total_samples / total, 'f', 1),
+        };
+        for (int column = 1; column < 4; ++column) {
+            QTableWidgetItem* item = new QTableWidgetItem(cells[column - 1]);
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            functions_table->setItem(row, column, item);
+        }
+    }
+}
+
+void ProfilerView::clear() {
+    functions_table->setRowCount(0);
+    status_label->setText("No profile");
+    export_button->setEnabled(false);
+    set_profiling(false);
+}
+
+} // namespace debugger 
\ No newline at end of file
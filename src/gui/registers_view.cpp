@@ -1,9 +1,11 @@
 #include "main_window.h"
+#include "instrumentation.h"
 #include <QtWidgets/QHeaderView>
 #include <QtWidgets/QTableWidgetItem>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QInputDialog>
 #include <QtGui/QFont>
 #include <QtGui/QContextMenuEvent>
 #include <QtGui/QClipboard>
@@ -76,6 +78,7 @@ void RegistersView::initialize_default_registers() {
 }
 
 void RegistersView::set_registers(const std::vector<Register>& registers) {
+    PERF_SCOPE("Refresh registers view", "ui");
     // Store previous values for comparison
     std::map<std::string, uint64_t> old_values;
     for (const auto& reg : previous_registers) {
@@ -121,10 +124,11 @@ void RegistersView::set_registers(const std::vector<Register>& registers) {
         QTableWidgetItem* value_item = new QTableWidgetItem(value_str);
         value_item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
         
-        // Highlight modified registers
+        // Highlight registers that changed since this thread last stopped;
+        // the engine tracks that per thread, so switching threads doesn't
+        // light up everything
         auto old_it = old_values.find(reg.name);
-        if (old_it != old_values.end() && old_it->second != reg.value) {
-            // Register value changed - highlight it
+        if (reg.modified && old_it != old_values.end() && old_it->second != reg.value) {
             value_item->setBackground(QColor(255, 255, 0, 100)); // Light yellow
             value_item->setToolTip(QString("Changed from: 0x%1").arg(old_it->second, 16, 16, QChar('0')).toUpper());
         } else if (reg.modified) {
@@ -251,6 +255,8 @@ QString breakpoint_type_to_string(BreakpointType type) {
             return "Hardware";
         case BreakpointType::CONDITIONAL:
             return "Conditional";
+        case BreakpointType::WATCHPOINT:
+            return "Watchpoint";
         default:
             return "Unknown";
     }
@@ -263,8 +269,8 @@ BreakpointView::BreakpointView(QWidget* parent) : QTableWidget(parent) {
 }
 
 void BreakpointView::setup_table() {
-    setColumnCount(4);
-    setHorizontalHeaderLabels({"Address", "Type", "Enabled", "Condition"});
+    setColumnCount(5);
+    setHorizontalHeaderLabels({"Address", "Type", "Enabled", "Hits", "Condition"});
     setAlternatingRowColors(true);
     setSelectionBehavior(QAbstractItemView::SelectRows);
     setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -279,17 +285,19 @@ void BreakpointView::setup_table() {
     horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
     horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
     horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-    horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
+    horizontalHeader()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
+    horizontalHeader()->setSectionResizeMode(4, QHeaderView::Stretch);
     
     verticalHeader()->setVisible(false);
 }
 
 void BreakpointView::setup_columns() {
-    setColumnCount(4);
-    setHorizontalHeaderLabels({"Address", "Type", "Enabled", "Condition"});
+    setColumnCount(5);
+    setHorizontalHeaderLabels({"Address", "Type", "Enabled", "Hits", "Condition"});
 }
 
 void BreakpointView::set_breakpoints(const std::vector<Breakpoint>& breakpoints) {
+    PERF_SCOPE("Refresh breakpoints view", "ui");
     current_breakpoints = breakpoints;
     
     // Clear existing items
@@ -326,10 +334,16 @@ void BreakpointView::set_breakpoints(const std::vector<Breakpoint>& breakpoints)
         }
         setItem(i, 2, enabled_item);
         
+        // Hits
+        QTableWidgetItem* hits_item = new QTableWidgetItem(QString::number(bp.hit_count));
+        hits_item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+        hits_item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        setItem(i, 3, hits_item);
+        
         // Condition
         QTableWidgetItem* condition_item = new QTableWidgetItem(QString::fromStdString(bp.condition));
         condition_item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-        setItem(i, 3, condition_item);
+        setItem(i, 4, condition_item);
         
         // Add tooltip with full information
         QString tooltip = QString("Breakpoint at 0x%1\nType: %2\nEnabled: %3\nHit count: %4")
@@ -338,6 +352,19 @@ void BreakpointView::set_breakpoints(const std::vector<Breakpoint>& breakpoints)
                          .arg(bp.enabled ? "Yes" : "No")
                          .arg(bp.hit_count);
         
+        if (bp.type == BreakpointType::WATCHPOINT) {
+            tooltip += QString("\nWatching %1 bytes on %2")
+                       .arg(bp.watch_length)
+                       .arg(bp.watch_kind == WatchKind::WRITE ? "write" : "read/write");
+        }
+        if (bp.tracing) {
+            tooltip += "\nTracepoint: counts hits without stopping";
+        }
+        if (bp.hit_latency.count > 0) {
+            tooltip += QString("\nHit latency: p50 %1 us, p99 %2 us")
+                       .arg(bp.hit_latency.get_percentile_ns(0.5) / 1000.0, 0, 'f', 1)
+                       .arg(bp.hit_latency.get_percentile_ns(0.99) / 1000.0, 0, 'f', 1);
+        }
         if (!bp.condition.empty()) {
             tooltip += QString("\nCondition: %1").arg(QString::fromStdString(bp.condition));
         }
@@ -399,6 +426,18 @@ void BreakpointView::contextMenuEvent(QContextMenuEvent* event) {
         emit breakpoint_toggle_requested(bp.address);
     });
     
+    // Condition, compiled and checked by the debugger on every hit
+    QAction* set_condition = menu.addAction("Set Condition...");
+    connect(set_condition, &QAction::triggered, [this, bp]() {
+        bool ok = false;
+        QString condition = QInputDialog::getText(this, "Breakpoint Condition",
+                                                  "Stop only when (e.g. rdi == 0x10 && *(u32*)(rsi+8) > 5):",
+                                                  QLineEdit::Normal, QString::fromStdString(bp.condition), &ok);
+        if (ok) {
+            emit breakpoint_condition_requested(bp.address, condition.trimmed());
+        }
+    });
+    
     // Remove breakpoint
     QAction* remove_bp = menu.addAction("Remove Breakpoint");
     connect(remove_bp, &QAction::triggered, [this, bp]() {
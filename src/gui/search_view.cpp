@@ -0,0 +1,252 @@
+#include "main_window.h"
+#include "instrumentation.h"
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMetaObject>
+#include <QtGui/QFont>
+
+namespace debugger {
+
+SearchResultsModel::SearchResultsModel(QObject* parent)
+    : QAbstractTableModel(parent), kind(SearchKind::BYTES) {
+}
+
+void SearchResultsModel::reset(SearchKind search_kind, std::shared_ptr<const SearchEngine> search_engine) {
+    beginResetModel();
+    kind = search_kind;
+    engine = std::move(search_engine);
+    hits.clear();
+    endResetModel();
+}
+
+void SearchResultsModel::append_hits(const std::vector<SearchHit>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+    int first = static_cast<int>(hits.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(batch.size()) - 1);
+    hits.insert(hits.end(), batch.begin(), batch.end());
+    endInsertRows();
+}
+
+const SearchHit* SearchResultsModel::hit_at(int row) const {
+    return row >= 0 && static_cast<size_t>(row) < hits.size() ? &hits[static_cast<size_t>(row)] : nullptr;
+}
+
+int SearchResultsModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(hits.size());
+}
+
+int SearchResultsModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : 3;
+}
+
+QVariant SearchResultsModel::data(const QModelIndex& index, int role) const {
+    const SearchHit* hit = hit_at(index.row());
+    if (!hit || role != Qt::DisplayRole || !engine) {
+        return QVariant();
+    }
+    switch (index.column()) {
+        case 0:
+            // Matches outside the loaded image only have a file position
+            return hit->address != 0 ? QString("0x%1").arg(hit->address, 0, 16)
+                                     : QString("file+0x%1").arg(hit->file_offset, 0, 16);
+        case 1:
+            return QString::fromStdString(engine->get_section_name(kind, *hit));
+        case 2:
+            return QString::fromStdString(engine->describe(kind, *hit));
+    }
+    return QVariant();
+}
+
+QVariant SearchResultsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case 0: return "Address";
+        case 1: return "Section";
+        case 2: return "Match";
+    }
+    return QVariant();
+}
+
+SearchView::SearchView(QWidget* parent)
+    : QWidget(parent)
+    , pool(nullptr)
+    , cancel_requested(false)
+    , current_search(0)
+    , searching(false)
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QWidget* controls = new QWidget();
+    QHBoxLayout* controls_layout = new QHBoxLayout(controls);
+    controls_layout->setContentsMargins(0, 0, 0, 0);
+
+    kind_box = new QComboBox();
+    kind_box->addItem("Bytes", static_cast<int>(SearchKind::BYTES));
+    kind_box->addItem("Instruction", static_cast<int>(SearchKind::INSTRUCTION));
+    kind_box->addItem("String", static_cast<int>(SearchKind::STRING));
+    query_edit = new QLineEdit();
+    case_box = new QCheckBox("Aa");
+    case_box->setToolTip("Case sensitive");
+    search_button = new QPushButton("Search");
+
+    controls_layout->addWidget(kind_box);
+    controls_layout->addWidget(query_edit, 1);
+    controls_layout->addWidget(case_box);
+    controls_layout->addWidget(search_button);
+    layout->addWidget(controls);
+
+    status_label = new QLabel("No search");
+    layout->addWidget(status_label);
+
+    results_model = new SearchResultsModel(this);
+    results_table = new QTableView();
+    results_table->setModel(results_model);
+    results_table->setAlternatingRowColors(true);
+    results_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    results_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    results_table->verticalHeader()->setVisible(false);
+    results_table->verticalHeader()->setDefaultSectionSize(18);
+    results_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
+    results_table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Interactive);
+    results_table->horizontalHeader()->setStretchLastSection(true);
+
+    QFont mono_font("Consolas", 10);
+    mono_font.setStyleHint(QFont::Monospace);
+    results_table->setFont(mono_font);
+    layout->addWidget(results_table);
+
+    auto update_placeholder = [this]() {
+        switch (static_cast<SearchKind>(kind_box->currentData().toInt())) {
+            case SearchKind::BYTES: query_edit->setPlaceholderText("48 8b ?? 0? e8"); break;
+            case SearchKind::INSTRUCTION: query_edit->setPlaceholderText("mnemonic (* for any, j* for prefix) [operand text]"); break;
+            case SearchKind::STRING: query_edit->setPlaceholderText("text contained in a string"); break;
+        }
+        case_box->setEnabled(static_cast<SearchKind>(kind_box->currentData().toInt()) != SearchKind::BYTES);
+    };
+    update_placeholder();
+
+    connect(kind_box, QOverload<int>::of(&QComboBox::currentIndexChanged), this, update_placeholder);
+    connect(query_edit, &QLineEdit::returnPressed, this, &SearchView::start_search);
+    connect(search_button, &QPushButton::clicked, [this]() {
+        if (searching) {
+            stop_search();
+            status_label->setText(QString("Stopped, %1 hits").arg(results_model->rowCount()));
+        } else {
+            start_search();
+        }
+    });
+    connect(results_table, &QTableView::doubleClicked, [this](const QModelIndex& index) {
+        const SearchHit* hit = results_model->hit_at(index.row());
+        if (hit && hit->address != 0) {
+            emit navigate_to_address_requested(hit->address);
+        }
+    });
+}
+
+SearchView::~SearchView() {
+    stop_search();
+}
+
+void SearchView::set_thread_pool(ThreadPool* thread_pool) {
+    pool = thread_pool;
+}
+
+void SearchView::set_image(std::shared_ptr<const ElfParser> parser) {
+    engine.set_image(std::move(parser));
+}
+
+void SearchView::set_instructions(std::shared_ptr<const DisassemblyBuffer> instructions) {
+    engine.set_instructions(std::move(instructions));
+}
+
+void SearchView::set_strings(std::shared_ptr<const std::vector<SectionStrings>> strings) {
+    engine.set_strings(std::move(strings));
+}
+
+void SearchView::clear() {
+    stop_search();
+    engine = SearchEngine();
+    results_model->reset(SearchKind::BYTES, nullptr);
+    status_label->setText("No search");
+}
+
+void SearchView::focus_query(const QString& text) {
+    if (!text.isEmpty()) {
+        query_edit->setText(text);
+    }
+    query_edit->setFocus();
+    query_edit->selectAll();
+}
+
+void SearchView::start_search() {
+    stop_search();
+    if (!pool || query_edit->text().isEmpty()) {
+        return;
+    }
+
+    SearchQuery query;
+    query.kind = static_cast<SearchKind>(kind_box->currentData().toInt());
+    query.text = query_edit->text().toStdString();
+    query.case_sensitive = case_box->isChecked();
+
+    // The search and the model share a snapshot of the sources, so neither
+    // sees a later set_*() halfway through
+    auto snapshot = std::make_shared<const SearchEngine>(engine);
+    results_model->reset(query.kind, snapshot);
+    status_label->setText("Searching...");
+    set_searching(true);
+
+    uint64_t search_id = current_search;
+    cancel_requested = false;
+    search_thread = std::thread([this, snapshot, query, search_id]() {
+        PERF_THREAD_NAME("Search");
+        QElapsedTimer timer;
+        timer.start();
+        std::string error;
+        bool ok = snapshot->search(query, *pool, [this, search_id](const std::vector<SearchHit>& hits) {
+            QMetaObject::invokeMethod(this, [this, search_id, hits]() {
+                if (search_id == current_search) {
+                    results_model->append_hits(hits);
+                    status_label->setText(QString("Searching... %1 hits").arg(results_model->rowCount()));
+                }
+            }, Qt::QueuedConnection);
+            return !cancel_requested.load(std::memory_order_relaxed);
+        }, error);
+
+        qint64 elapsed = timer.elapsed();
+        QMetaObject::invokeMethod(this, [this, search_id, ok, error, elapsed]() {
+            if (search_id != current_search) {
+                return;
+            }
+            set_searching(false);
+            if (!ok) {
+                status_label->setText(QString::fromStdString(error));
+            } else {
+                status_label->setText(QString("%1 hits in %2 ms").arg(results_model->rowCount()).arg(elapsed));
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SearchView::stop_search() {
+    if (search_thread.joinable()) {
+        cancel_requested = true;
+        search_thread.join();
+    }
+    // Batches the old search queued are now stale
+    ++current_search;
+    set_searching(false);
+}
+
+void SearchView::set_searching(bool active) {
+    searching = active;
+    search_button->setText(searching ? "Stop" : "Search");
+}
+
+} // namespace debugger
@@ -0,0 +1,87 @@
+#include "main_window.h"
+#include <algorithm>
+#include <climits>
+
+namespace debugger {
+
+StringsModel::StringsModel(QObject* parent) : QAbstractTableModel(parent) {
+}
+
+void StringsModel::reset(std::shared_ptr<const ElfParser> elf_parser,
+                         std::shared_ptr<const std::vector<SectionStrings>> section_strings) {
+    beginResetModel();
+    parser = std::move(elf_parser);
+    strings = std::move(section_strings);
+    section_rows.clear();
+    if (strings) {
+        size_t rows = 0;
+        section_rows.reserve(strings->size() + 1);
+        for (const auto& section : *strings) {
+            section_rows.push_back(rows);
+            rows += section.records.size();
+        }
+        section_rows.push_back(rows);
+    }
+    endResetModel();
+}
+
+void StringsModel::clear() {
+    reset(nullptr, nullptr);
+}
+
+const StringRecord* StringsModel::record_at(int row, const SectionStrings** section) const {
+    if (row < 0 || section_rows.empty() || static_cast<size_t>(row) >= section_rows.back()) {
+        return nullptr;
+    }
+    // Last section starting at or before the row; empty sections share
+    // their start with the next one and are skipped over
+    auto next = std::upper_bound(section_rows.begin(), section_rows.end(), static_cast<size_t>(row));
+    size_t index = static_cast<size_t>(next - section_rows.begin()) - 1;
+    *section = &(*strings)[index];
+    return &(*section)->records[static_cast<size_t>(row) - section_rows[index]];
+}
+
+int StringsModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid() || section_rows.empty()) {
+        return 0;
+    }
+    return static_cast<int>(std::min<size_t>(section_rows.back(), INT_MAX));
+}
+
+int StringsModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : 4;
+}
+
+QVariant StringsModel::data(const QModelIndex& index, int role) const {
+    const SectionStrings* section = nullptr;
+    const StringRecord* record = record_at(index.row(), &section);
+    if (!record || role != Qt::DisplayRole || !parser) {
+        return QVariant();
+    }
+    switch (index.column()) {
+        case 0:
+            return QString("0x%1").arg(record->offset, 8, 16, QChar('0'));
+        case 1:
+            return record->encoding == StringEncoding::UTF16LE ? "W" : "A";
+        case 2:
+            return QString::fromStdString(section->section_name);
+        case 3:
+            return QString::fromStdString(StringScanner::to_string(parser->get_file_view(), 0, *record));
+    }
+    return QVariant();
+}
+
+QVariant StringsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case 0: return "Offset";
+        case 1: return "Enc";
+        case 2: return "Section";
+        case 3: return "String";
+    }
+    return QVariant();
+}
+
+} // namespace debugger
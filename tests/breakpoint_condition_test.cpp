@@ -0,0 +1,61 @@
+#include "breakpoint_condition.h"
+#include "memory_manager.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sys/user.h>
+
+using namespace debugger;
+
+namespace {
+
+int failures = 0;
+
+// None of these conditions load memory, so an unattached manager will do
+bool evaluate(const char* expression, uint64_t rax) {
+    BreakpointCondition condition;
+    if (!condition.compile(expression)) {
+        std::fprintf(stderr, "FAIL: cannot compile \"%s\": %s\n", expression, condition.get_last_error().c_str());
+        ++failures;
+        return false;
+    }
+    user_regs_struct regs;
+    std::memset(&regs, 0, sizeof(regs));
+    regs.rax = rax;
+    MemoryManager memory;
+    return condition.evaluate(regs, memory);
+}
+
+void check(const char* expression, uint64_t rax, bool expected) {
+    if (evaluate(expression, rax) != expected) {
+        std::fprintf(stderr, "FAIL: \"%s\" with rax=0x%llx should be %s\n", expression,
+                     static_cast<unsigned long long>(rax), expected ? "true" : "false");
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    const uint64_t int64_min = 0x8000000000000000ull;
+
+    // Division by zero makes the condition false rather than trapping
+    check("rax / 0 == 0", 7, false);
+    check("rax % 0 == 0", 7, false);
+
+    // INT64_MIN / -1 overflows; it wraps like the hardware would without trapping
+    check("rax / -1 == rax", int64_min, true);
+    check("rax % -1 == 0", int64_min, true);
+    check("rax / -1 == -7", 7, true);
+    check("rax % -1 == 0", 7, true);
+
+    check("rax / -2 == -3", 7, true);
+    check("rax % -2 == 1", 7, true);
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All breakpoint condition checks passed\n");
+    return 0;
+}
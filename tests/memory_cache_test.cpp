@@ -0,0 +1,74 @@
+#include "memory_manager.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace debugger;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    const size_t page = MemoryCache::PAGE_SIZE;
+
+    // Three pages with a hole in the middle, read from this process itself
+    uint8_t* base = static_cast<uint8_t*>(mmap(nullptr, 3 * page, PROT_READ | PROT_WRITE,
+                                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (base == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+    std::memset(base, 0x11, page);
+    std::memset(base + 2 * page, 0x33, page);
+    munmap(base + page, page);
+    uint64_t address = reinterpret_cast<uint64_t>(base);
+
+    MemoryManager memory;
+    memory.attach(getpid());
+    uint8_t buffer[3 * 4096];
+
+    // A read spanning the hole stops at it, but must not hide the page after it
+    {
+        MemoryCache cache(memory);
+        check(cache.read(address, buffer, 3 * page) == page, "read across the hole stops at it");
+        check(cache.read(address + 2 * page, buffer, 64) == 64, "page after the hole is still readable");
+        check(buffer[0] == 0x33, "page after the hole has its own bytes");
+        check(cache.read(address + page, buffer, 64) == 0, "the hole itself is unreadable");
+    }
+
+    // Once the budget is reached pages of the current stop are evicted, and
+    // what the cache still holds stays correct
+    {
+        MemoryCache cache(memory, 2);
+        for (int round = 0; round < 4; ++round) {
+            check(cache.read(address, buffer, 64) == 64 && buffer[0] == 0x11, "first page after eviction");
+            check(cache.read(address + 2 * page, buffer, 64) == 64 && buffer[0] == 0x33, "last page after eviction");
+            check(cache.read(address + page, buffer, 64) == 0, "hole after eviction");
+        }
+        MemoryCacheStats stats = cache.get_stats();
+        check(stats.cached_pages <= 2, "cache stays within max_pages");
+        check(stats.evictions > 0, "evictions are counted");
+    }
+
+    munmap(base, page);
+    munmap(base + 2 * page, page);
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All memory cache checks passed\n");
+    return 0;
+}